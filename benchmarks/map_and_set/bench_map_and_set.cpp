@@ -0,0 +1,423 @@
+/*
+
+Convenient Containers v1.3.1 - benchmarks/map_and_set/bench_map_and_set.cpp
+
+This file benchmarks CC's map and set against the equivalent C++ STL containers.
+In particular, it measures the metadata scanning used during iteration, which the sparse-iteration tests stress by
+erasing most keys before iterating, and batched lookups via cc_get_n.
+It also compares a map whose fundamental integer keys are stored separately from its elements with an otherwise
+identical map whose keys, being of a struct type, are interleaved with its elements, reporting the tables' sizes too.
+
+License (MIT):
+
+  Copyright (c) 2024 Jackson L. Allan
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+  documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+  Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+  WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#define NDEBUG
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define CC_NO_SHORT_NAMES
+#include "../../cc.h"
+
+// A key type that behaves like unsigned long long but, being a struct, is interleaved with the elements in a map's
+// buckets.
+struct boxed_key
+{
+  unsigned long long val;
+};
+
+#define CC_CMPR boxed_key, { return val_1.val < val_2.val ? -1 : val_1.val > val_2.val; }
+#define CC_HASH boxed_key, { return cc_hash_uint64( val.val ); }
+#include "../../cc.h"
+
+// Returns the size of a map's table, including its header and metadata.
+#define TABLE_SIZE( cntr ) \
+( sizeof( cc_map_hdr_ty ) + cc_cap( cntr ) * ( CC_BUCKET_SIZE( CC_EL_SIZE( *(cntr) ), CC_LAYOUT( *(cntr) ) ) + 2 ) )
+
+int main()
+{
+  constexpr int key_count = 10000000;
+  constexpr int run_count = 10;
+  constexpr int sparse_divisor = 16; // Only one in sparse_divisor keys survives before the sparse-iteration tests.
+  constexpr int batch_size = 256; // Number of keys per cc_get_n call in the batched-lookup tests.
+
+  std::vector<int> keys( key_count );
+  std::iota( keys.begin(), keys.end(), 1 );
+  std::shuffle(
+    keys.begin(),
+    keys.end(),
+    std::default_random_engine( std::chrono::system_clock::now().time_since_epoch().count() )
+  );
+
+  std::chrono::time_point<std::chrono::high_resolution_clock> start;
+  std::chrono::time_point<std::chrono::high_resolution_clock> end;
+  unsigned long long optimization_preventer = 0;
+
+  double total_cc_map_insert_time = 0.0;
+  double total_cc_map_lookup_time = 0.0;
+  double total_cc_map_lookup_nonexisting_time = 0.0;
+  double total_cc_map_batched_lookup_time = 0.0;
+  double total_cc_map_iteration_time = 0.0;
+  double total_cc_map_sparse_iteration_time = 0.0;
+  double total_cc_map_erase_time = 0.0;
+  double total_stl_map_insert_time = 0.0;
+  double total_stl_map_lookup_time = 0.0;
+  double total_stl_map_lookup_nonexisting_time = 0.0;
+  double total_stl_map_iteration_time = 0.0;
+  double total_stl_map_sparse_iteration_time = 0.0;
+  double total_stl_map_erase_time = 0.0;
+  double total_cc_set_insert_time = 0.0;
+  double total_cc_set_lookup_time = 0.0;
+  double total_cc_set_batched_lookup_time = 0.0;
+  double total_cc_set_iteration_time = 0.0;
+  double total_cc_set_sparse_iteration_time = 0.0;
+  double total_stl_set_insert_time = 0.0;
+  double total_stl_set_lookup_time = 0.0;
+  double total_stl_set_iteration_time = 0.0;
+  double total_stl_set_sparse_iteration_time = 0.0;
+  double total_separate_keys_insert_time = 0.0;
+  double total_separate_keys_lookup_time = 0.0;
+  double total_separate_keys_lookup_nonexisting_time = 0.0;
+  double total_interleaved_keys_insert_time = 0.0;
+  double total_interleaved_keys_lookup_time = 0.0;
+  double total_interleaved_keys_lookup_nonexisting_time = 0.0;
+  size_t separate_keys_table_size = 0;
+  size_t interleaved_keys_table_size = 0;
+
+  for( int run = 0; run < run_count; ++run )
+  {
+    std::cout << "Run " << run << '\n';
+
+    // map.
+    {
+      cc_map( int, int ) our_map;
+      cc_init( &our_map );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_map, keys[ i ], 0 );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *cc_key_for( &our_map, cc_get( &our_map, keys[ i ] ) );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += (bool)cc_get( &our_map, -keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_lookup_nonexisting_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; i += batch_size )
+      {
+        int *itrs[ batch_size ];
+        size_t n = key_count - i < batch_size ? key_count - i : batch_size;
+        cc_get_n( &our_map, &keys[ i ], n, itrs );
+        for( size_t j = 0; j < n; ++j )
+          optimization_preventer += *cc_key_for( &our_map, itrs[ j ] );
+      }
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_batched_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      cc_for_each( &our_map, key, el )
+        optimization_preventer += *key;
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_iteration_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        if( i % sparse_divisor )
+          cc_erase( &our_map, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      cc_for_each( &our_map, key, el )
+        optimization_preventer += *key;
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_map_sparse_iteration_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      cc_cleanup( &our_map );
+    }
+
+    // std::unordered_map.
+    {
+      std::unordered_map<int, int> our_map;
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        our_map.insert( { keys[ i ], 0 } );
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += our_map.find( keys[ i ] )->first;
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += our_map.find( -keys[ i ] ) != our_map.end();
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_lookup_nonexisting_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( auto &pair: our_map )
+        optimization_preventer += pair.first;
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_iteration_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        if( i % sparse_divisor )
+          our_map.erase( keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( auto &pair: our_map )
+        optimization_preventer += pair.first;
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_map_sparse_iteration_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+    }
+
+    // set.
+    {
+      cc_set( int ) our_set;
+      cc_init( &our_set );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_set, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_set_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *cc_get( &our_set, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_set_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; i += batch_size )
+      {
+        int *itrs[ batch_size ];
+        size_t n = key_count - i < batch_size ? key_count - i : batch_size;
+        cc_get_n( &our_set, &keys[ i ], n, itrs );
+        for( size_t j = 0; j < n; ++j )
+          optimization_preventer += *itrs[ j ];
+      }
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_set_batched_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      cc_for_each( &our_set, el )
+        optimization_preventer += *el;
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_set_iteration_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      for( size_t i = 0; i < key_count; ++i )
+        if( i % sparse_divisor )
+          cc_erase( &our_set, keys[ i ] );
+
+      start = std::chrono::high_resolution_clock::now();
+      cc_for_each( &our_set, el )
+        optimization_preventer += *el;
+      end = std::chrono::high_resolution_clock::now();
+      total_cc_set_sparse_iteration_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      cc_cleanup( &our_set );
+    }
+
+    // std::unordered_set.
+    {
+      std::unordered_set<int> our_set;
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        our_set.insert( keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_set_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *our_set.find( keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_set_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( int el: our_set )
+        optimization_preventer += el;
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_set_iteration_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      for( size_t i = 0; i < key_count; ++i )
+        if( i % sparse_divisor )
+          our_set.erase( keys[ i ] );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( int el: our_set )
+        optimization_preventer += el;
+      end = std::chrono::high_resolution_clock::now();
+      total_stl_set_sparse_iteration_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+    }
+
+    // map with separately stored keys.
+    {
+      cc_map( unsigned long long, char ) our_map;
+      cc_init( &our_map );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_map, keys[ i ], 0 );
+      end = std::chrono::high_resolution_clock::now();
+      total_separate_keys_insert_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *cc_key_for( &our_map, cc_get( &our_map, keys[ i ] ) );
+      end = std::chrono::high_resolution_clock::now();
+      total_separate_keys_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += (bool)cc_get( &our_map, keys[ i ] + key_count );
+      end = std::chrono::high_resolution_clock::now();
+      total_separate_keys_lookup_nonexisting_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      separate_keys_table_size = TABLE_SIZE( &our_map );
+      cc_cleanup( &our_map );
+    }
+
+    // map with interleaved keys.
+    {
+      cc_map( boxed_key, char ) our_map;
+      cc_init( &our_map );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_map, boxed_key{ (unsigned long long)keys[ i ] }, 0 );
+      end = std::chrono::high_resolution_clock::now();
+      total_interleaved_keys_insert_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer +=
+          cc_key_for( &our_map, cc_get( &our_map, boxed_key{ (unsigned long long)keys[ i ] } ) )->val;
+      end = std::chrono::high_resolution_clock::now();
+      total_interleaved_keys_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += (bool)cc_get( &our_map, boxed_key{ (unsigned long long)keys[ i ] + key_count } );
+      end = std::chrono::high_resolution_clock::now();
+      total_interleaved_keys_lookup_nonexisting_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      interleaved_keys_table_size = TABLE_SIZE( &our_map );
+      cc_cleanup( &our_map );
+    }
+  }
+
+  std::cout << std::setprecision( 3 ) << std::fixed;
+
+  std::cout << "---Insert results---\n";
+  std::cout << "map:                " << total_cc_map_insert_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_insert_time / run_count << "s\n";
+  std::cout << "set:                " << total_cc_set_insert_time / run_count << "s\n";
+  std::cout << "std::unordered_set: " << total_stl_set_insert_time / run_count << "s\n";
+
+  std::cout << "---Lookup existing results---\n";
+  std::cout << "map:                " << total_cc_map_lookup_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_lookup_time / run_count << "s\n";
+  std::cout << "set:                " << total_cc_set_lookup_time / run_count << "s\n";
+  std::cout << "std::unordered_set: " << total_stl_set_lookup_time / run_count << "s\n";
+
+  std::cout << "---Batched lookup existing results---\n";
+  std::cout << "map:                " << total_cc_map_batched_lookup_time / run_count << "s\n";
+  std::cout << "set:                " << total_cc_set_batched_lookup_time / run_count << "s\n";
+
+  std::cout << "---Lookup nonexisting results---\n";
+  std::cout << "map:                " << total_cc_map_lookup_nonexisting_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_lookup_nonexisting_time / run_count << "s\n";
+
+  std::cout << "---Iteration results---\n";
+  std::cout << "map:                " << total_cc_map_iteration_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_iteration_time / run_count << "s\n";
+  std::cout << "set:                " << total_cc_set_iteration_time / run_count << "s\n";
+  std::cout << "std::unordered_set: " << total_stl_set_iteration_time / run_count << "s\n";
+
+  std::cout << "---Sparse iteration results---\n";
+  std::cout << "map:                " << total_cc_map_sparse_iteration_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_sparse_iteration_time / run_count << "s\n";
+  std::cout << "set:                " << total_cc_set_sparse_iteration_time / run_count << "s\n";
+  std::cout << "std::unordered_set: " << total_stl_set_sparse_iteration_time / run_count << "s\n";
+
+  std::cout << "---Erase results---\n";
+  std::cout << "map:                " << total_cc_map_erase_time / run_count << "s\n";
+  std::cout << "std::unordered_map: " << total_stl_map_erase_time / run_count << "s\n";
+
+  std::cout << "---map( unsigned long long, char ) key layout results---\n";
+  std::cout << "Insert, separate keys:                " << total_separate_keys_insert_time / run_count << "s\n";
+  std::cout << "Insert, interleaved keys:             " << total_interleaved_keys_insert_time / run_count << "s\n";
+  std::cout << "Lookup existing, separate keys:       " << total_separate_keys_lookup_time / run_count << "s\n";
+  std::cout << "Lookup existing, interleaved keys:    " << total_interleaved_keys_lookup_time / run_count << "s\n";
+  std::cout << "Lookup nonexisting, separate keys:    " <<
+    total_separate_keys_lookup_nonexisting_time / run_count << "s\n";
+  std::cout << "Lookup nonexisting, interleaved keys: " <<
+    total_interleaved_keys_lookup_nonexisting_time / run_count << "s\n";
+  std::cout << "Table size, separate keys:            " << separate_keys_table_size << " bytes\n";
+  std::cout << "Table size, interleaved keys:         " << interleaved_keys_table_size << " bytes\n";
+
+  std::cout << "Done " << optimization_preventer << '\n';
+}
@@ -2,7 +2,9 @@
 
 Convenient Containers v1.3.1 - benchmarks/omap_and_oset/bench_omap_and_oset.cpp
 
-This file benchmarks CC's ordered map and ordered set against the equivalent C++ STL containers.
+This file benchmarks CC's ordered map, ordered set, B-tree map, and B-tree set against the equivalent C++ STL
+containers.
+To measure pooled node allocation, compile with -DCC_POOL_NODES.
 
 License (MIT):
 
@@ -43,6 +45,7 @@ int main()
 {
   constexpr int key_count = 10000000;
   constexpr int run_count = 10;
+  constexpr int batch_size = 256; // Number of keys per cc_get_n call in the batched-lookup tests.
 
   std::vector<int> keys( key_count );
   std::iota( keys.begin(), keys.end(), 1 );
@@ -52,19 +55,33 @@ int main()
     std::default_random_engine( std::chrono::system_clock::now().time_since_epoch().count() )
   );
 
+  std::vector<int> sorted_keys( key_count );
+  std::iota( sorted_keys.begin(), sorted_keys.end(), 1 );
+  std::vector<int> sorted_els( key_count ); // For the sorted-build tests.
+
   std::chrono::time_point<std::chrono::high_resolution_clock> start;
   std::chrono::time_point<std::chrono::high_resolution_clock> end;
   unsigned long long optimization_preventer = 0;
 
   double total_omap_insert_time = 0.0;
   double total_omap_lookup_time = 0.0;
+  double total_omap_batched_lookup_time = 0.0;
   double total_omap_erase_time = 0.0;
+  double total_omap_sorted_build_time = 0.0;
+  double total_bmap_insert_time = 0.0;
+  double total_bmap_lookup_time = 0.0;
+  double total_bmap_erase_time = 0.0;
   double total_map_insert_time = 0.0;
   double total_map_lookup_time = 0.0;
   double total_map_erase_time = 0.0;
+  double total_map_sorted_build_time = 0.0;
   double total_oset_insert_time = 0.0;
   double total_oset_lookup_time = 0.0;
+  double total_oset_batched_lookup_time = 0.0;
   double total_oset_erase_time = 0.0;
+  double total_bset_insert_time = 0.0;
+  double total_bset_lookup_time = 0.0;
+  double total_bset_erase_time = 0.0;
   double total_set_insert_time = 0.0;
   double total_set_lookup_time = 0.0;
   double total_set_erase_time = 0.0;
@@ -91,6 +108,19 @@ int main()
       end = std::chrono::high_resolution_clock::now();
       total_omap_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
 
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; i += batch_size )
+      {
+        int *itrs[ batch_size ];
+        size_t n = key_count - i < batch_size ? key_count - i : batch_size;
+        cc_get_n( &our_omap, &keys[ i ], n, itrs );
+        for( size_t j = 0; j < n; ++j )
+          optimization_preventer += *cc_key_for( &our_omap, itrs[ j ] );
+      }
+      end = std::chrono::high_resolution_clock::now();
+      total_omap_batched_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
       start = std::chrono::high_resolution_clock::now();
       for( size_t i = 0; i < key_count; ++i )
         cc_erase( &our_omap, keys[ i ] );
@@ -98,6 +128,41 @@ int main()
       total_omap_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
 
       cc_cleanup( &our_omap );
+
+      start = std::chrono::high_resolution_clock::now();
+      cc_init_from_sorted( &our_omap, sorted_keys.data(), sorted_els.data(), key_count );
+      end = std::chrono::high_resolution_clock::now();
+      total_omap_sorted_build_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      optimization_preventer += cc_size( &our_omap );
+      cc_cleanup( &our_omap );
+    }
+
+    // bmap.
+    {
+      cc_bmap( int, int ) our_bmap;
+      cc_init( &our_bmap );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_bmap, keys[ i ], 0 );
+      end = std::chrono::high_resolution_clock::now();
+      total_bmap_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *cc_key_for( &our_bmap, cc_get( &our_bmap, keys[ i ] ) );
+      end = std::chrono::high_resolution_clock::now();
+      total_bmap_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_erase( &our_bmap, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_bmap_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      cc_cleanup( &our_bmap );
     }
 
     // std::map.
@@ -122,6 +187,14 @@ int main()
         our_map.erase( keys[ i ] );
       end = std::chrono::high_resolution_clock::now();
       total_map_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        our_map.emplace_hint( our_map.end(), sorted_keys[ i ], sorted_els[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_map_sorted_build_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      optimization_preventer += our_map.size();
     }
 
     // oset.
@@ -142,6 +215,19 @@ int main()
       end = std::chrono::high_resolution_clock::now();
       total_oset_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
 
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; i += batch_size )
+      {
+        int *itrs[ batch_size ];
+        size_t n = key_count - i < batch_size ? key_count - i : batch_size;
+        cc_get_n( &our_oset, &keys[ i ], n, itrs );
+        for( size_t j = 0; j < n; ++j )
+          optimization_preventer += *itrs[ j ];
+      }
+      end = std::chrono::high_resolution_clock::now();
+      total_oset_batched_lookup_time +=
+        std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
       start = std::chrono::high_resolution_clock::now();
       for( size_t i = 0; i < key_count; ++i )
         cc_erase( &our_oset, keys[ i ] );
@@ -151,6 +237,33 @@ int main()
       cc_cleanup( &our_oset );
     }
 
+    // bset.
+    {
+      cc_bset( int ) our_bset;
+      cc_init( &our_bset );
+      std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_insert( &our_bset, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_bset_insert_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        optimization_preventer += *cc_get( &our_bset, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_bset_lookup_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      for( size_t i = 0; i < key_count; ++i )
+        cc_erase( &our_bset, keys[ i ] );
+      end = std::chrono::high_resolution_clock::now();
+      total_bset_erase_time += std::chrono::duration_cast<std::chrono::duration<double>>( end - start ).count();
+
+      cc_cleanup( &our_bset );
+    }
+
     // std::set.
     {
       std::set<int> our_set;
@@ -180,21 +293,35 @@ int main()
 
   std::cout << "---Insert results---\n";
   std::cout << "omap: " << total_omap_insert_time / run_count << "s\n";
+  std::cout << "bmap: " << total_bmap_insert_time / run_count << "s\n";
   std::cout << "map:  " << total_map_insert_time / run_count << "s\n";
   std::cout << "oset: " << total_oset_insert_time / run_count << "s\n";
+  std::cout << "bset: " << total_bset_insert_time / run_count << "s\n";
   std::cout << "set:  " << total_set_insert_time / run_count << "s\n";
 
   std::cout << "---Lookup results---\n";
   std::cout << "omap: " << total_omap_lookup_time / run_count << "s\n";
+  std::cout << "bmap: " << total_bmap_lookup_time / run_count << "s\n";
   std::cout << "map:  " << total_map_lookup_time / run_count << "s\n";
   std::cout << "oset: " << total_oset_lookup_time / run_count << "s\n";
+  std::cout << "bset: " << total_bset_lookup_time / run_count << "s\n";
   std::cout << "set:  " << total_set_lookup_time / run_count << "s\n";
 
+  std::cout << "---Batched lookup results---\n";
+  std::cout << "omap: " << total_omap_batched_lookup_time / run_count << "s\n";
+  std::cout << "oset: " << total_oset_batched_lookup_time / run_count << "s\n";
+
   std::cout << "---Erase results---\n";
   std::cout << "omap: " << total_omap_erase_time / run_count << "s\n";
+  std::cout << "bmap: " << total_bmap_erase_time / run_count << "s\n";
   std::cout << "map:  " << total_map_erase_time / run_count << "s\n";
   std::cout << "oset: " << total_oset_erase_time / run_count << "s\n";
+  std::cout << "bset: " << total_bset_erase_time / run_count << "s\n";
   std::cout << "set:  " << total_set_erase_time / run_count << "s\n";
 
+  std::cout << "---Sorted build results---\n";
+  std::cout << "omap: " << total_omap_sorted_build_time / run_count << "s\n";
+  std::cout << "map:  " << total_map_sorted_build_time / run_count << "s\n";
+
   std::cout << "Done " << optimization_preventer << '\n';
 }
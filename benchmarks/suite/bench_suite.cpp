@@ -0,0 +1,1179 @@
+/*
+
+Convenient Containers v1.3.1 - benchmarks/suite/bench_suite.cpp
+
+This file benchmarks all six CC containers against the equivalent C++ STL containers across several key types and
+prints the results in a machine-readable format (CSV or JSON) suitable for tracking performance regressions.
+
+Each container is exercised with int, 64-bit integer, string, and 64-byte struct keys (or elements, in the case of
+vectors and lists).
+Maps and sets are measured on insertion, lookup of existing keys, lookup of nonexisting keys, iteration, churn (i.e.
+alternately erasing an existing key and inserting a new one), and erasure.
+Vectors and lists are measured on pushing, iteration, and random access (vectors) or erasure of every second element
+(lists).
+CC string keys are char pointers into storage owned by the benchmark, whereas STL string keys are std::strings.
+
+Usage:
+
+  bench_suite [--keys N] [--runs N] [--warmup N] [--cpu N] [--format csv|json] [--containers LIST]
+    [--key-types LIST] [--baseline FILE] [--threshold PERCENT]
+
+    --keys        Number of keys or elements per test (default 1000000).
+    --runs        Number of times each test is repeated (default 5).
+    --warmup      Number of additional, unrecorded runs of each test that precede the recorded ones (default 1).
+    --cpu         CPU to which to pin the benchmark (default none; Linux only).
+    --format      Output format (default csv).
+    --containers  Comma-separated subset of vec,list,map,set,omap,oset (default all).
+    --key-types   Comma-separated subset of int,u64,string,big (default all).
+    --baseline    CSV output of an earlier run against which to compare the results.
+    --threshold   Minimum slowdown, as a percentage of the baseline mean, that counts as a regression (default 5).
+
+  Progress is reported on stderr, and the results are printed to stdout.
+  Each result reports the minimum, median, and mean time of the runs, the half-width of the 95% confidence interval
+  of the mean, and the median time per operation.
+  On Linux, each result also reports the mean CPU cycles, instructions, and cache misses per operation, counted via
+  perf_event_open, if the kernel permits it (see /proc/sys/kernel/perf_event_paranoid).
+  If a baseline is supplied, a CC result regresses if its mean exceeds the baseline's by more than the threshold and
+  the two confidence intervals do not overlap.
+  The comparison is reported on stderr, and the exit status is 2 if any CC result regressed.
+
+Compile with, e.g., g++ -std=c++11 -O3 bench_suite.cpp.
+To set the maximum load factor of maps, sets, and the STL unordered containers, compile with, e.g.,
+-DBENCH_MAX_LOAD=0.75 (by default, each library uses its own default).
+To measure other compile-time configurations, compile with, e.g., -DCC_POOL_NODES or -DCC_INCREMENTAL_REHASH; these
+flags are recorded in the output.
+CC_SIMD is also recorded, but it only affects B-tree maps and sets with int keys, which this suite does not measure, so
+it does not change any of the results.
+To compare against another container, write an adapter with the same members as the STL adapters below and add a
+corresponding call to BENCH_KEY_TYPE.
+
+License (MIT):
+
+  Copyright (c) 2024 Jackson L. Allan
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+  documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+  persons to whom the Software is furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+  Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+  WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+*/
+
+#define NDEBUG
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define CC_NO_SHORT_NAMES
+#include "../../cc.h"
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                     Key types                                                      */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Struct key that is expensive to copy but cheap to compare and hash.
+struct big_key
+{
+  uint64_t id;
+  char payload[ 56 ];
+
+  bool operator==( const big_key &other ) const { return id == other.id; }
+  bool operator<( const big_key &other ) const { return id < other.id; }
+};
+
+namespace std
+{
+  template<> struct hash<big_key>
+  {
+    size_t operator()( const big_key &key ) const { return std::hash<uint64_t>()( key.id ); }
+  };
+}
+
+#define CC_CMPR big_key, { return val_1.id < val_2.id ? -1 : val_1.id > val_2.id; }
+#define CC_HASH big_key, { return cc_hash_uint64( val.id ); }
+#include "../../cc.h"
+
+#ifdef BENCH_MAX_LOAD
+#define CC_LOAD int, BENCH_MAX_LOAD
+#include "../../cc.h"
+#define CC_LOAD uint64_t, BENCH_MAX_LOAD
+#include "../../cc.h"
+#define CC_LOAD char *, BENCH_MAX_LOAD
+#include "../../cc.h"
+#define CC_LOAD big_key, BENCH_MAX_LOAD
+#include "../../cc.h"
+#endif
+
+// All keys are derived from unique 64-bit IDs.
+// String keys are generated once and then referenced (CC) or copied (STL) as necessary.
+struct key_source
+{
+  std::vector<uint64_t> ids;
+  std::vector<std::string> strings;
+};
+
+static void convert_key( const key_source &src, size_t i, int &key )
+{
+  key = (int)src.ids[ i ];
+}
+
+static void convert_key( const key_source &src, size_t i, uint64_t &key )
+{
+  key = src.ids[ i ] * 0x9E3779B97F4A7C15ull; // Spread the IDs across the full 64-bit range.
+}
+
+static void convert_key( const key_source &src, size_t i, char *&key )
+{
+  key = const_cast<char *>( src.strings[ i ].c_str() );
+}
+
+static void convert_key( const key_source &src, size_t i, std::string &key )
+{
+  key = src.strings[ i ];
+}
+
+static void convert_key( const key_source &src, size_t i, big_key &key )
+{
+  key.id = src.ids[ i ];
+  memset( key.payload, (int)( src.ids[ i ] & 0xFF ), sizeof( key.payload ) );
+}
+
+// Cheap, type-appropriate summaries of keys used to prevent the compiler from optimizing away iteration and lookups.
+static uint64_t checksum( int key ) { return (uint64_t)key; }
+static uint64_t checksum( uint64_t key ) { return key; }
+static uint64_t checksum( const char *key ) { return (unsigned char)key[ 0 ]; }
+static uint64_t checksum( const std::string &key ) { return (unsigned char)key[ 0 ]; }
+static uint64_t checksum( const big_key &key ) { return key.id; }
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                      Adapters                                                      */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Each adapter wraps one container instance behind a uniform interface so that the same test code can drive every
+// implementation.
+// CC's API macros cannot be used with dependent types inside templates, so the CC adapters are generated per key type
+// by macros, while the STL adapters are templates.
+
+static void out_of_memory()
+{
+  std::cerr << "Out of memory\n";
+  exit( 1 );
+}
+
+#define CC_VEC_ADAPTER( name, key_ty_ )                                            \
+struct name                                                                        \
+{                                                                                  \
+  typedef key_ty_ key_ty;                                                          \
+  cc_vec( key_ty ) cntr;                                                           \
+  name() { cc_init( &cntr ); }                                                     \
+  ~name() { cc_cleanup( &cntr ); }                                                 \
+  void push( const key_ty &key ) { if( !cc_push( &cntr, key ) ) out_of_memory(); } \
+  uint64_t iterate()                                                               \
+  {                                                                                \
+    uint64_t sum = 0;                                                              \
+    cc_for_each( &cntr, el )                                                       \
+      sum += checksum( *el );                                                      \
+    return sum;                                                                    \
+  }                                                                                \
+  uint64_t at( size_t i ) { return checksum( *cc_get( &cntr, i ) ); }              \
+  size_t size() { return cc_size( &cntr ); }                                       \
+};                                                                                 \
+
+#define CC_LIST_ADAPTER( name, key_ty_ )                                           \
+struct name                                                                        \
+{                                                                                  \
+  typedef key_ty_ key_ty;                                                          \
+  cc_list( key_ty ) cntr;                                                          \
+  name() { cc_init( &cntr ); }                                                     \
+  ~name() { cc_cleanup( &cntr ); }                                                 \
+  void push( const key_ty &key ) { if( !cc_push( &cntr, key ) ) out_of_memory(); } \
+  uint64_t iterate()                                                               \
+  {                                                                                \
+    uint64_t sum = 0;                                                              \
+    cc_for_each( &cntr, el )                                                       \
+      sum += checksum( *el );                                                      \
+    return sum;                                                                    \
+  }                                                                                \
+  void erase_alternate()                                                           \
+  {                                                                                \
+    for( key_ty *el = cc_first( &cntr ); el != cc_end( &cntr ); )                  \
+    {                                                                              \
+      el = cc_erase( &cntr, el );                                                  \
+      if( el != cc_end( &cntr ) )                                                  \
+        el = cc_next( &cntr, el );                                                 \
+    }                                                                              \
+  }                                                                                \
+  size_t size() { return cc_size( &cntr ); }                                       \
+};                                                                                 \
+
+// Shared by maps and ordered maps.
+#define CC_MAP_ADAPTER( name, cntr_ty, key_ty_ )                                          \
+struct name                                                                               \
+{                                                                                         \
+  typedef key_ty_ key_ty;                                                                 \
+  cntr_ty( key_ty, uint64_t ) cntr;                                                       \
+  name() { cc_init( &cntr ); }                                                            \
+  ~name() { cc_cleanup( &cntr ); }                                                        \
+  void insert( const key_ty &key ) { if( !cc_insert( &cntr, key, 1 ) ) out_of_memory(); } \
+  uint64_t find( const key_ty &key ) { return (bool)cc_get( &cntr, key ); }               \
+  void erase( const key_ty &key ) { cc_erase( &cntr, key ); }                             \
+  uint64_t iterate()                                                                      \
+  {                                                                                       \
+    uint64_t sum = 0;                                                                     \
+    cc_for_each( &cntr, key, el )                                                         \
+      sum += checksum( *key ) + *el;                                                      \
+    return sum;                                                                           \
+  }                                                                                       \
+  size_t size() { return cc_size( &cntr ); }                                              \
+};                                                                                        \
+
+// Shared by sets and ordered sets.
+#define CC_SET_ADAPTER( name, cntr_ty, key_ty_ )                                       \
+struct name                                                                            \
+{                                                                                      \
+  typedef key_ty_ key_ty;                                                              \
+  cntr_ty( key_ty ) cntr;                                                              \
+  name() { cc_init( &cntr ); }                                                         \
+  ~name() { cc_cleanup( &cntr ); }                                                     \
+  void insert( const key_ty &key ) { if( !cc_insert( &cntr, key ) ) out_of_memory(); } \
+  uint64_t find( const key_ty &key ) { return (bool)cc_get( &cntr, key ); }            \
+  void erase( const key_ty &key ) { cc_erase( &cntr, key ); }                          \
+  uint64_t iterate()                                                                   \
+  {                                                                                    \
+    uint64_t sum = 0;                                                                  \
+    cc_for_each( &cntr, el )                                                           \
+      sum += checksum( *el );                                                          \
+    return sum;                                                                        \
+  }                                                                                    \
+  size_t size() { return cc_size( &cntr ); }                                           \
+};                                                                                     \
+
+#define CC_ADAPTERS( suffix, key_ty )                       \
+CC_VEC_ADAPTER( cc_vec_adapter_##suffix, key_ty )           \
+CC_LIST_ADAPTER( cc_list_adapter_##suffix, key_ty )         \
+CC_MAP_ADAPTER( cc_map_adapter_##suffix, cc_map, key_ty )   \
+CC_SET_ADAPTER( cc_set_adapter_##suffix, cc_set, key_ty )   \
+CC_MAP_ADAPTER( cc_omap_adapter_##suffix, cc_omap, key_ty ) \
+CC_SET_ADAPTER( cc_oset_adapter_##suffix, cc_oset, key_ty ) \
+
+CC_ADAPTERS( int, int )
+CC_ADAPTERS( u64, uint64_t )
+CC_ADAPTERS( string, char * )
+CC_ADAPTERS( big, big_key )
+
+template<typename key_ty_> struct stl_vector_adapter
+{
+  typedef key_ty_ key_ty;
+  std::vector<key_ty> cntr;
+  void push( const key_ty &key ) { cntr.push_back( key ); }
+  uint64_t iterate()
+  {
+    uint64_t sum = 0;
+    for( const key_ty &el: cntr )
+      sum += checksum( el );
+    return sum;
+  }
+  uint64_t at( size_t i ) { return checksum( cntr[ i ] ); }
+  size_t size() { return cntr.size(); }
+};
+
+template<typename key_ty_> struct stl_list_adapter
+{
+  typedef key_ty_ key_ty;
+  std::list<key_ty> cntr;
+  void push( const key_ty &key ) { cntr.push_back( key ); }
+  uint64_t iterate()
+  {
+    uint64_t sum = 0;
+    for( const key_ty &el: cntr )
+      sum += checksum( el );
+    return sum;
+  }
+  void erase_alternate()
+  {
+    for( auto itr = cntr.begin(); itr != cntr.end(); )
+    {
+      itr = cntr.erase( itr );
+      if( itr != cntr.end() )
+        ++itr;
+    }
+  }
+  size_t size() { return cntr.size(); }
+};
+
+// Sets the maximum load factor of unordered containers if BENCH_MAX_LOAD is defined.
+template<typename cntr_ty> static void set_max_load( cntr_ty &cntr )
+{
+#ifdef BENCH_MAX_LOAD
+  cntr.max_load_factor( BENCH_MAX_LOAD );
+#else
+  (void)cntr;
+#endif
+}
+
+template<typename key_ty_, typename cntr_ty_> struct stl_map_adapter
+{
+  typedef key_ty_ key_ty;
+  cntr_ty_ cntr;
+  void insert( const key_ty &key ) { cntr.insert( { key, 1 } ); }
+  uint64_t find( const key_ty &key ) { return cntr.find( key ) != cntr.end(); }
+  void erase( const key_ty &key ) { cntr.erase( key ); }
+  uint64_t iterate()
+  {
+    uint64_t sum = 0;
+    for( const auto &pair: cntr )
+      sum += checksum( pair.first ) + pair.second;
+    return sum;
+  }
+  size_t size() { return cntr.size(); }
+};
+
+template<typename key_ty_, typename cntr_ty_> struct stl_set_adapter
+{
+  typedef key_ty_ key_ty;
+  cntr_ty_ cntr;
+  void insert( const key_ty &key ) { cntr.insert( key ); }
+  uint64_t find( const key_ty &key ) { return cntr.find( key ) != cntr.end(); }
+  void erase( const key_ty &key ) { cntr.erase( key ); }
+  uint64_t iterate()
+  {
+    uint64_t sum = 0;
+    for( const key_ty &el: cntr )
+      sum += checksum( el );
+    return sum;
+  }
+  size_t size() { return cntr.size(); }
+};
+
+template<typename key_ty> struct stl_unordered_map_adapter:
+  stl_map_adapter<key_ty, std::unordered_map<key_ty, uint64_t>>
+{
+  stl_unordered_map_adapter() { set_max_load( this->cntr ); }
+};
+
+template<typename key_ty> struct stl_unordered_set_adapter: stl_set_adapter<key_ty, std::unordered_set<key_ty>>
+{
+  stl_unordered_set_adapter() { set_max_load( this->cntr ); }
+};
+
+template<typename key_ty> struct stl_ordered_map_adapter: stl_map_adapter<key_ty, std::map<key_ty, uint64_t>>
+{
+};
+
+template<typename key_ty> struct stl_ordered_set_adapter: stl_set_adapter<key_ty, std::set<key_ty>>
+{
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                    Measurement                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Hardware counters, which are read together as a group led by the cycle counter.
+enum { CYCLES, INSTRUCTIONS, CACHE_MISSES, COUNTER_COUNT };
+
+static const char *const counter_names[ COUNTER_COUNT ] = { "cycles", "instructions", "cache_misses" };
+
+static int counter_fds[ COUNTER_COUNT ] = { -1, -1, -1 };
+
+static bool counters_available()
+{
+  return counter_fds[ 0 ] >= 0;
+}
+
+// Opens the hardware counters for the calling thread, if the platform and kernel permit it.
+// If any counter cannot be opened, none are used.
+static void open_counters()
+{
+#ifdef __linux__
+  static const uint64_t configs[ COUNTER_COUNT ] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES
+  };
+
+  for( int i = 0; i < COUNTER_COUNT; ++i )
+  {
+    perf_event_attr attr;
+    memset( &attr, 0, sizeof( attr ) );
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof( attr );
+    attr.config = configs[ i ];
+    attr.disabled = i == 0; // The group starts and stops with its leader.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    counter_fds[ i ] = (int)syscall( SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : counter_fds[ 0 ], 0 );
+    if( counter_fds[ i ] < 0 )
+    {
+      while( i-- )
+      {
+        close( counter_fds[ i ] );
+        counter_fds[ i ] = -1;
+      }
+
+      return;
+    }
+  }
+#endif
+}
+
+static void start_counters()
+{
+#ifdef __linux__
+  if( counters_available() )
+  {
+    ioctl( counter_fds[ 0 ], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+    ioctl( counter_fds[ 0 ], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+  }
+#endif
+}
+
+// Stops the counters and stores their counts since start_counters in counts, or zeros if they are unavailable.
+static void stop_counters( uint64_t *counts )
+{
+  memset( counts, 0, sizeof( uint64_t ) * COUNTER_COUNT );
+
+#ifdef __linux__
+  if( counters_available() )
+  {
+    ioctl( counter_fds[ 0 ], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+
+    struct
+    {
+      uint64_t nr;
+      uint64_t values[ COUNTER_COUNT ];
+    } group;
+
+    if( read( counter_fds[ 0 ], &group, sizeof( group ) ) == (ssize_t)sizeof( group ) )
+      memcpy( counts, group.values, sizeof( group.values ) );
+  }
+#endif
+}
+
+// Pins the calling thread to the specified CPU so that it is not migrated between cores mid-test.
+// Returns false if unsuccessful or unsupported.
+static bool pin_to_cpu( int cpu )
+{
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu, &set );
+  return sched_setaffinity( 0, sizeof( set ), &set ) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+// The time and hardware counts of one run of a test.
+struct sample
+{
+  double time;
+  uint64_t counts[ COUNTER_COUNT ];
+};
+
+// Measures the code executed between calls to begin and end.
+struct meter
+{
+  bench_clock::time_point start;
+
+  void begin()
+  {
+    start_counters();
+    start = bench_clock::now();
+  }
+
+  sample end()
+  {
+    sample smp;
+    smp.time = std::chrono::duration_cast<std::chrono::duration<double>>( bench_clock::now() - start ).count();
+    stop_counters( smp.counts );
+    return smp;
+  }
+};
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                       Tests                                                        */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Identifies the container, implementation, and key type of a test.
+struct labels
+{
+  const char *cntr;
+  const char *impl;
+  const char *key_type;
+};
+
+struct result
+{
+  labels lbls;
+  std::string operation;
+  size_t ops;
+  std::vector<sample> samples;
+};
+
+struct config
+{
+  size_t key_count = 1000000;
+  size_t run_count = 5;
+  size_t warmup_count = 1;
+  int cpu = -1;
+  bool json = false;
+  std::vector<std::string> containers = { "vec", "list", "map", "set", "omap", "oset" };
+  std::vector<std::string> key_types = { "int", "u64", "string", "big" };
+  std::string baseline;
+  double threshold = 5.0;
+};
+
+static uint64_t optimization_preventer = 0;
+
+// Adds a sample to the result with the specified labels and operation, creating the result if necessary.
+static void record(
+  std::vector<result> &results,
+  const labels &lbls,
+  const char *operation,
+  size_t ops,
+  const sample &smp
+)
+{
+  for( result &res: results )
+    if(
+      res.lbls.cntr == lbls.cntr &&
+      res.lbls.impl == lbls.impl &&
+      res.lbls.key_type == lbls.key_type &&
+      res.operation == operation
+    )
+    {
+      res.samples.push_back( smp );
+      return;
+    }
+
+  results.push_back( result{ lbls, operation, ops, std::vector<sample>( 1, smp ) } );
+}
+
+// Returns the results vector to which the specified run should record its samples.
+// Warm-up runs record theirs in a scratch vector that is discarded.
+static std::vector<result> &results_for_run( std::vector<result> &results, size_t run, const config &cfg )
+{
+  static std::vector<result> discarded;
+  discarded.clear();
+  return run < cfg.warmup_count ? discarded : results;
+}
+
+template<typename key_ty> static std::vector<key_ty> convert_keys( const key_source &src, size_t begin, size_t end )
+{
+  std::vector<key_ty> keys( end - begin );
+  for( size_t i = begin; i < end; ++i )
+    convert_key( src, i, keys[ i - begin ] );
+
+  return keys;
+}
+
+// Pushing and iteration, which are common to vectors and lists.
+template<typename adapter> static void bench_push_and_iterate(
+  adapter &cntr,
+  const labels &lbls,
+  const std::vector<typename adapter::key_ty> &els,
+  std::vector<result> &results
+)
+{
+  meter mtr;
+  mtr.begin();
+  for( size_t i = 0; i < els.size(); ++i )
+    cntr.push( els[ i ] );
+  record( results, lbls, "push", els.size(), mtr.end() );
+
+  mtr.begin();
+  optimization_preventer += cntr.iterate();
+  record( results, lbls, "iterate", els.size(), mtr.end() );
+}
+
+template<typename adapter> static void bench_vec(
+  const labels &lbls,
+  const key_source &src,
+  const config &cfg,
+  std::vector<result> &results
+)
+{
+  std::vector<typename adapter::key_ty> els = convert_keys<typename adapter::key_ty>( src, 0, cfg.key_count );
+
+  std::vector<size_t> indices( cfg.key_count );
+  std::iota( indices.begin(), indices.end(), 0 );
+  std::shuffle( indices.begin(), indices.end(), std::default_random_engine( 0 ) );
+
+  for( size_t run = 0; run < cfg.warmup_count + cfg.run_count; ++run )
+  {
+    std::vector<result> &run_results = results_for_run( results, run, cfg );
+    adapter *cntr = new adapter;
+    bench_push_and_iterate( *cntr, lbls, els, run_results );
+
+    meter mtr;
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+      optimization_preventer += cntr->at( indices[ i ] );
+    record( run_results, lbls, "random_access", cfg.key_count, mtr.end() );
+
+    delete cntr;
+  }
+}
+
+template<typename adapter> static void bench_list(
+  const labels &lbls,
+  const key_source &src,
+  const config &cfg,
+  std::vector<result> &results
+)
+{
+  std::vector<typename adapter::key_ty> els = convert_keys<typename adapter::key_ty>( src, 0, cfg.key_count );
+
+  for( size_t run = 0; run < cfg.warmup_count + cfg.run_count; ++run )
+  {
+    std::vector<result> &run_results = results_for_run( results, run, cfg );
+    adapter *cntr = new adapter;
+    bench_push_and_iterate( *cntr, lbls, els, run_results );
+
+    meter mtr;
+    mtr.begin();
+    cntr->erase_alternate();
+    record( run_results, lbls, "erase_alternate", cfg.key_count - cfg.key_count / 2, mtr.end() );
+    optimization_preventer += cntr->size();
+
+    delete cntr;
+  }
+}
+
+// Maps, sets, ordered maps, and ordered sets.
+// The first half of the key source supplies the keys that are inserted, and the second half supplies the nonexisting
+// keys used by the lookup and churn tests.
+template<typename adapter> static void bench_associative(
+  const labels &lbls,
+  const key_source &src,
+  const config &cfg,
+  std::vector<result> &results
+)
+{
+  std::vector<typename adapter::key_ty> keys = convert_keys<typename adapter::key_ty>( src, 0, cfg.key_count );
+  std::vector<typename adapter::key_ty> other_keys =
+    convert_keys<typename adapter::key_ty>( src, cfg.key_count, cfg.key_count * 2 );
+
+  for( size_t run = 0; run < cfg.warmup_count + cfg.run_count; ++run )
+  {
+    std::vector<result> &run_results = results_for_run( results, run, cfg );
+    adapter *cntr = new adapter;
+
+    meter mtr;
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+      cntr->insert( keys[ i ] );
+    record( run_results, lbls, "insert", cfg.key_count, mtr.end() );
+
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+      optimization_preventer += cntr->find( keys[ i ] );
+    record( run_results, lbls, "lookup_existing", cfg.key_count, mtr.end() );
+
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+      optimization_preventer += cntr->find( other_keys[ i ] );
+    record( run_results, lbls, "lookup_nonexisting", cfg.key_count, mtr.end() );
+
+    mtr.begin();
+    optimization_preventer += cntr->iterate();
+    record( run_results, lbls, "iterate", cfg.key_count, mtr.end() );
+
+    // Replace every key with a nonexisting one, one at a time, so that the size stays constant.
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+    {
+      cntr->erase( keys[ i ] );
+      cntr->insert( other_keys[ i ] );
+    }
+    record( run_results, lbls, "churn", cfg.key_count, mtr.end() );
+
+    mtr.begin();
+    for( size_t i = 0; i < cfg.key_count; ++i )
+      cntr->erase( other_keys[ i ] );
+    record( run_results, lbls, "erase", cfg.key_count, mtr.end() );
+    optimization_preventer += cntr->size();
+
+    delete cntr;
+  }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                       Output                                                       */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Compile-time options that affect the results.
+static std::string options()
+{
+  std::string opts;
+  // CC_SIMD only affects the comparison of int keys in B-tree maps and sets, not the containers measured here, but it
+  // is recorded so that results from builds with and without it are not compared with each other.
+#ifdef CC_SIMD
+  opts += " CC_SIMD";
+#endif
+#ifdef CC_POOL_NODES
+  opts += " CC_POOL_NODES";
+#endif
+#ifdef CC_INCREMENTAL_REHASH
+  opts += " CC_INCREMENTAL_REHASH";
+#endif
+#ifdef BENCH_MAX_LOAD
+  opts += " BENCH_MAX_LOAD=" + std::to_string( (double)BENCH_MAX_LOAD );
+#endif
+  return opts.empty() ? opts : opts.substr( 1 );
+}
+
+struct summary
+{
+  double min;
+  double median;
+  double mean;
+  double ci95; // Half-width of the 95% confidence interval of the mean.
+  double ns_per_op;
+  double counts_per_op[ COUNTER_COUNT ];
+};
+
+// Returns the two-sided 95% critical value of Student's t-distribution with the specified degrees of freedom.
+static double t_critical_95( size_t degrees_of_freedom )
+{
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+
+  if( degrees_of_freedom <= sizeof( table ) / sizeof( *table ) )
+    return table[ degrees_of_freedom - 1 ];
+
+  return 1.960;
+}
+
+static summary summarize( const result &res )
+{
+  std::vector<double> times;
+  for( const sample &smp: res.samples )
+    times.push_back( smp.time );
+  std::sort( times.begin(), times.end() );
+
+  summary sum;
+  sum.min = times.front();
+  sum.median = times.size() % 2 ? times[ times.size() / 2 ] :
+    ( times[ times.size() / 2 - 1 ] + times[ times.size() / 2 ] ) / 2.0;
+  sum.mean = std::accumulate( times.begin(), times.end(), 0.0 ) / (double)times.size();
+
+  // A single run gives no estimate of the variance, so its confidence interval is empty.
+  sum.ci95 = 0.0;
+  if( times.size() > 1 )
+  {
+    double squares = 0.0;
+    for( double time: times )
+      squares += ( time - sum.mean ) * ( time - sum.mean );
+
+    double std_dev = sqrt( squares / (double)( times.size() - 1 ) );
+    sum.ci95 = t_critical_95( times.size() - 1 ) * std_dev / sqrt( (double)times.size() );
+  }
+
+  sum.ns_per_op = res.ops ? sum.median * 1e9 / (double)res.ops : 0.0;
+
+  for( int i = 0; i < COUNTER_COUNT; ++i )
+  {
+    double total = 0.0;
+    for( const sample &smp: res.samples )
+      total += (double)smp.counts[ i ];
+
+    sum.counts_per_op[ i ] = res.ops ? total / (double)res.samples.size() / (double)res.ops : 0.0;
+  }
+
+  return sum;
+}
+
+static void print_csv( const std::vector<result> &results, const config &cfg )
+{
+  printf( "container,implementation,key_type,operation,key_count,runs,options,min_s,median_s,mean_s,ci95_s,ns_per_op" );
+  for( int i = 0; i < COUNTER_COUNT; ++i )
+    printf( ",%s_per_op", counter_names[ i ] );
+  printf( "\n" );
+
+  for( const result &res: results )
+  {
+    summary sum = summarize( res );
+    printf(
+      "%s,%s,%s,%s,%zu,%zu,%s,%.6f,%.6f,%.6f,%.6f,%.2f",
+      res.lbls.cntr,
+      res.lbls.impl,
+      res.lbls.key_type,
+      res.operation.c_str(),
+      cfg.key_count,
+      res.samples.size(),
+      options().c_str(),
+      sum.min,
+      sum.median,
+      sum.mean,
+      sum.ci95,
+      sum.ns_per_op
+    );
+
+    // Unavailable counts are left empty.
+    for( int i = 0; i < COUNTER_COUNT; ++i )
+      if( counters_available() )
+        printf( ",%.2f", sum.counts_per_op[ i ] );
+      else
+        printf( "," );
+
+    printf( "\n" );
+  }
+}
+
+static void print_json( const std::vector<result> &results, const config &cfg )
+{
+  printf(
+    "{\n  \"key_count\": %zu,\n  \"runs\": %zu,\n  \"warmup_runs\": %zu,\n  \"options\": \"%s\",\n"
+    "  \"counters\": %s,\n  \"results\": [\n",
+    cfg.key_count,
+    cfg.run_count,
+    cfg.warmup_count,
+    options().c_str(),
+    counters_available() ? "true" : "false"
+  );
+
+  for( size_t i = 0; i < results.size(); ++i )
+  {
+    summary sum = summarize( results[ i ] );
+    printf(
+      "    { \"container\": \"%s\", \"implementation\": \"%s\", \"key_type\": \"%s\", \"operation\": \"%s\", "
+      "\"min_s\": %.6f, \"median_s\": %.6f, \"mean_s\": %.6f, \"ci95_s\": %.6f, \"ns_per_op\": %.2f",
+      results[ i ].lbls.cntr,
+      results[ i ].lbls.impl,
+      results[ i ].lbls.key_type,
+      results[ i ].operation.c_str(),
+      sum.min,
+      sum.median,
+      sum.mean,
+      sum.ci95,
+      sum.ns_per_op
+    );
+
+    // Unavailable counts are null.
+    for( int j = 0; j < COUNTER_COUNT; ++j )
+      if( counters_available() )
+        printf( ", \"%s_per_op\": %.2f", counter_names[ j ], sum.counts_per_op[ j ] );
+      else
+        printf( ", \"%s_per_op\": null", counter_names[ j ] );
+
+    printf( " }%s\n", i + 1 < results.size() ? "," : "" );
+  }
+
+  printf( "  ]\n}\n" );
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                Baseline comparison                                                 */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static std::vector<std::string> split( const std::string &list );
+
+// The mean time and confidence interval of a result in a baseline file, keyed by its labels and operation.
+struct baseline_entry
+{
+  std::string id;
+  size_t key_count;
+  std::string options;
+  double mean;
+  double ci95;
+};
+
+static std::string result_id( const char *cntr, const char *impl, const char *key_type, const std::string &operation )
+{
+  return std::string( cntr ) + '/' + impl + '/' + key_type + '/' + operation;
+}
+
+// Reads the CSV output of an earlier run.
+// Returns false if the file cannot be read or lacks the necessary columns.
+static bool read_baseline( const std::string &path, std::vector<baseline_entry> &entries )
+{
+  std::ifstream file( path.c_str() );
+  std::string line;
+  if( !std::getline( file, line ) )
+    return false;
+
+  std::vector<std::string> header = split( line );
+  const char *const names[] = {
+    "container", "implementation", "key_type", "operation", "key_count", "options", "mean_s", "ci95_s"
+  };
+  size_t columns[ sizeof( names ) / sizeof( *names ) ];
+  for( size_t i = 0; i < sizeof( names ) / sizeof( *names ); ++i )
+  {
+    columns[ i ] = std::find( header.begin(), header.end(), names[ i ] ) - header.begin();
+    if( columns[ i ] == header.size() )
+      return false;
+  }
+
+  while( std::getline( file, line ) )
+  {
+    std::vector<std::string> fields = split( line );
+    if( fields.size() != header.size() )
+      continue;
+
+    baseline_entry entry;
+    entry.id = result_id(
+      fields[ columns[ 0 ] ].c_str(),
+      fields[ columns[ 1 ] ].c_str(),
+      fields[ columns[ 2 ] ].c_str(),
+      fields[ columns[ 3 ] ]
+    );
+    entry.key_count = strtoull( fields[ columns[ 4 ] ].c_str(), NULL, 10 );
+    entry.options = fields[ columns[ 5 ] ];
+    entry.mean = strtod( fields[ columns[ 6 ] ].c_str(), NULL );
+    entry.ci95 = strtod( fields[ columns[ 7 ] ].c_str(), NULL );
+    entries.push_back( entry );
+  }
+
+  return true;
+}
+
+// Compares the CC results with the corresponding baseline results and reports the differences on stderr.
+// Returns the number of regressions, or -1 if the baseline cannot be read.
+static int compare_with_baseline( const std::vector<result> &results, const config &cfg )
+{
+  std::vector<baseline_entry> entries;
+  if( !read_baseline( cfg.baseline, entries ) )
+  {
+    std::cerr << "Cannot read baseline " << cfg.baseline << '\n';
+    return -1;
+  }
+
+  int regressions = 0;
+  for( const result &res: results )
+  {
+    if( strcmp( res.lbls.impl, "cc" ) != 0 )
+      continue;
+
+    std::string id = result_id( res.lbls.cntr, res.lbls.impl, res.lbls.key_type, res.operation );
+    const baseline_entry *entry = NULL;
+    for( const baseline_entry &candidate: entries )
+      if( candidate.id == id )
+        entry = &candidate;
+
+    if( !entry || entry->key_count != cfg.key_count )
+    {
+      std::cerr << id << ": no comparable baseline\n";
+      continue;
+    }
+
+    if( entry->options != options() )
+      std::cerr << id << ": baseline options (" << entry->options << ") differ\n";
+
+    summary sum = summarize( res );
+    double change = ( sum.mean - entry->mean ) / entry->mean * 100.0;
+    bool regressed = change > cfg.threshold && sum.mean - sum.ci95 > entry->mean + entry->ci95;
+    regressions += regressed;
+
+    fprintf(
+      stderr,
+      "%s: %.6fs +/- %.6fs vs baseline %.6fs +/- %.6fs (%+.1f%%)%s\n",
+      id.c_str(),
+      sum.mean,
+      sum.ci95,
+      entry->mean,
+      entry->ci95,
+      change,
+      regressed ? " REGRESSION" : ""
+    );
+  }
+
+  std::cerr << regressions << " regression(s)\n";
+  return regressions;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                        Main                                                        */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static std::vector<std::string> split( const std::string &list )
+{
+  std::vector<std::string> items;
+  size_t begin = 0;
+  while( begin <= list.size() )
+  {
+    size_t end = list.find( ',', begin );
+    if( end == std::string::npos )
+      end = list.size();
+
+    items.push_back( list.substr( begin, end - begin ) );
+    begin = end + 1;
+  }
+
+  return items;
+}
+
+static bool contains( const std::vector<std::string> &items, const char *item )
+{
+  return std::find( items.begin(), items.end(), item ) != items.end();
+}
+
+static bool parse_args( int argc, char **argv, config &cfg )
+{
+  for( int i = 1; i < argc; ++i )
+  {
+    std::string arg = argv[ i ];
+    if( i + 1 == argc )
+      return false;
+
+    std::string val = argv[ ++i ];
+    if( arg == "--keys" )
+      cfg.key_count = strtoull( val.c_str(), NULL, 10 );
+    else if( arg == "--runs" )
+      cfg.run_count = strtoull( val.c_str(), NULL, 10 );
+    else if( arg == "--warmup" )
+      cfg.warmup_count = strtoull( val.c_str(), NULL, 10 );
+    else if( arg == "--cpu" )
+      cfg.cpu = atoi( val.c_str() );
+    else if( arg == "--format" && ( val == "csv" || val == "json" ) )
+      cfg.json = val == "json";
+    else if( arg == "--containers" )
+      cfg.containers = split( val );
+    else if( arg == "--key-types" )
+      cfg.key_types = split( val );
+    else if( arg == "--baseline" )
+      cfg.baseline = val;
+    else if( arg == "--threshold" )
+      cfg.threshold = strtod( val.c_str(), NULL );
+    else
+      return false;
+  }
+
+  return cfg.key_count > 0 && cfg.run_count > 0;
+}
+
+// Runs all selected tests for one key type.
+#define BENCH_KEY_TYPE( suffix, stl_key_ty )                                                                      \
+if( contains( cfg.key_types, #suffix ) )                                                                          \
+{                                                                                                                 \
+  if( contains( cfg.containers, "vec" ) )                                                                         \
+  {                                                                                                               \
+    bench_vec<cc_vec_adapter_##suffix>( { "vec", "cc", #suffix }, src, cfg, results );                            \
+    bench_vec<stl_vector_adapter<stl_key_ty>>( { "vec", "std::vector", #suffix }, src, cfg, results );            \
+  }                                                                                                               \
+  if( contains( cfg.containers, "list" ) )                                                                        \
+  {                                                                                                               \
+    bench_list<cc_list_adapter_##suffix>( { "list", "cc", #suffix }, src, cfg, results );                         \
+    bench_list<stl_list_adapter<stl_key_ty>>( { "list", "std::list", #suffix }, src, cfg, results );              \
+  }                                                                                                               \
+  if( contains( cfg.containers, "map" ) )                                                                         \
+  {                                                                                                               \
+    bench_associative<cc_map_adapter_##suffix>( { "map", "cc", #suffix }, src, cfg, results );                    \
+    bench_associative<stl_unordered_map_adapter<stl_key_ty>>(                                                     \
+      { "map", "std::unordered_map", #suffix }, src, cfg, results                                                 \
+    );                                                                                                            \
+  }                                                                                                               \
+  if( contains( cfg.containers, "set" ) )                                                                         \
+  {                                                                                                               \
+    bench_associative<cc_set_adapter_##suffix>( { "set", "cc", #suffix }, src, cfg, results );                    \
+    bench_associative<stl_unordered_set_adapter<stl_key_ty>>(                                                     \
+      { "set", "std::unordered_set", #suffix }, src, cfg, results                                                 \
+    );                                                                                                            \
+  }                                                                                                               \
+  if( contains( cfg.containers, "omap" ) )                                                                        \
+  {                                                                                                               \
+    bench_associative<cc_omap_adapter_##suffix>( { "omap", "cc", #suffix }, src, cfg, results );                  \
+    bench_associative<stl_ordered_map_adapter<stl_key_ty>>( { "omap", "std::map", #suffix }, src, cfg, results ); \
+  }                                                                                                               \
+  if( contains( cfg.containers, "oset" ) )                                                                        \
+  {                                                                                                               \
+    bench_associative<cc_oset_adapter_##suffix>( { "oset", "cc", #suffix }, src, cfg, results );                  \
+    bench_associative<stl_ordered_set_adapter<stl_key_ty>>( { "oset", "std::set", #suffix }, src, cfg, results ); \
+  }                                                                                                               \
+}                                                                                                                 \
+
+int main( int argc, char **argv )
+{
+  config cfg;
+  if( !parse_args( argc, argv, cfg ) )
+  {
+    std::cerr <<
+      "Usage: bench_suite [--keys N] [--runs N] [--warmup N] [--cpu N] [--format csv|json] [--containers LIST]\n"
+      "  [--key-types LIST] [--baseline FILE] [--threshold PERCENT]\n";
+    return 1;
+  }
+
+  if( cfg.cpu >= 0 && !pin_to_cpu( cfg.cpu ) )
+    std::cerr << "Cannot pin to CPU " << cfg.cpu << '\n';
+
+  open_counters();
+  if( !counters_available() )
+    std::cerr << "Hardware counters unavailable\n";
+
+  // Generate twice as many unique IDs as keys so that half can serve as nonexisting keys.
+  key_source src;
+  src.ids.resize( cfg.key_count * 2 );
+  std::iota( src.ids.begin(), src.ids.end(), 1 );
+  std::shuffle( src.ids.begin(), src.ids.end(), std::default_random_engine( 0 ) );
+
+  if( contains( cfg.key_types, "string" ) )
+  {
+    src.strings.reserve( src.ids.size() );
+    for( uint64_t id: src.ids )
+      src.strings.push_back( "bench/key/" + std::to_string( id * 2654435761ull % 1000000007ull ) + "/" +
+        std::to_string( id ) );
+  }
+
+  std::vector<result> results;
+
+  BENCH_KEY_TYPE( int, int )
+  BENCH_KEY_TYPE( u64, uint64_t )
+  BENCH_KEY_TYPE( string, std::string )
+  BENCH_KEY_TYPE( big, big_key )
+
+  if( cfg.json )
+    print_json( results, cfg );
+  else
+    print_csv( results, cfg );
+
+  std::cerr << "Done " << optimization_preventer << '\n';
+
+  if( !cfg.baseline.empty() )
+  {
+    int regressions = compare_with_baseline( results, cfg );
+    if( regressions < 0 )
+      return 1;
+    if( regressions > 0 )
+      return 2;
+  }
+}
@@ -214,6 +214,85 @@ Including the library:
       By default, CC exposes API macros without the "cc_" prefix.
       Define this flag to withhold the unprefixed names.
 
+    #define CC_SIMD
+      By default, B-tree maps and sets with int keys compare a key with the keys in a node one at a time.
+      Define this flag to instead use SSE2 or NEON instructions, if available, to compare four keys at a time.
+
+    #define CC_POOL_NODES
+      By default, lists, ordered maps, and ordered sets allocate memory for each node separately.
+      Define this flag to make each of these containers instead allocate its nodes from its own pool of progressively
+      larger slabs, recycle erased nodes, and free all the slabs at once upon cleanup.
+      This flag changes the layout of container headers, so it must be defined (or not defined) consistently in all
+      files that share containers.
+
+    #define CC_ORDER_STATISTICS
+      By default, nth, rank, and count_range (see "Ordered map" and "Ordered set" below) iterate over the elements, so
+      they take time proportional to the position or count that they find.
+      Define this flag to make each ordered map and ordered set node store the number of nodes in its subtree, so that
+      these calls take logarithmic time.
+      Insertions and erasures then update the counts of all the nodes on the path to the root.
+      This flag changes the layout of ordered map and ordered set nodes, so it must be defined (or not defined)
+      consistently in all files that share ordered maps or ordered sets.
+
+    #define CC_INCREMENTAL_REHASH
+      By default, when a map or set grows, it rehashes all its elements into a new bucket array at once, so a single
+      insertion can take time proportional to the number of elements.
+      Define this flag to instead keep the old bucket array alongside the new one and migrate the elements from a
+      bounded number of its buckets during each subsequent call to insert or get_or_insert, until the old array is
+      empty and can be freed.
+      While a migration is in progress, lookups and erasures are slightly slower because they may need to check both
+      arrays.
+      This flag changes the layout of map and set headers, so it must be defined (or not defined) consistently in all
+      files that share maps or sets.
+
+    #define CC_FLAT_SMALL_MAPS
+      By default, maps and sets hash every key that they look up, insert, or erase.
+      Define this flag to instead make maps and sets with at most 16 buckets store their keys contiguously and find a
+      key by comparing it with each stored key in turn, without calling the hash function.
+      These maps and sets can fill all their buckets, irrespective of the max load factor, before they grow.
+      Once they grow beyond 16 buckets, they switch to hashing transparently, and pointer-iterators behave as usual
+      throughout.
+      This flag changes how small maps and sets store their keys, so it must be defined (or not defined) consistently
+      in all files that share maps or sets.
+
+    #define CC_STATS
+      Define this flag to make vectors, maps, and sets count certain internal events and to enable get_stats (see
+      "Statistics" below).
+      Without it, the statistics code and counters do not exist.
+      This flag changes the layout of vector, map, and set headers, so it must be defined (or not defined) consistently
+      in all files that share these containers.
+
+    #define CC_PARALLEL_REHASH
+      By default, rehashing and cloning a map or set occur on the calling thread.
+      Define this flag to make these operations split the work on large maps and sets (i.e. those with at least 131072
+      buckets) into tasks that run concurrently.
+      When rehashing, each task places the elements whose new home buckets lie in one range of buckets, and the calling
+      thread then places the few elements whose chains would cross from one range into another.
+      The tasks call the hash function concurrently, so it must be safe to call from several threads at once.
+      The tasks never allocate memory.
+      This flag also makes sort split large vectors (i.e. those with at least 131072 elements) that it does not radix
+      sort into ranges that it sorts concurrently, calling the comparison function from several threads at once.
+
+    #define CC_PARALLEL_FOR our_parallel_for
+      If CC_PARALLEL_REHASH is defined, causes the tasks to run via a user-supplied function with the signature
+      void our_parallel_for( void ( *task )( void *ctx, size_t index ), void *ctx, size_t task_count ), which must call
+      task( ctx, index ) once for each index in [ 0, task_count ) - e.g. using the user's own thread pool - and return
+      only once all these calls have returned.
+      Otherwise, the tasks run on threads created for each operation via POSIX threads or, if those are unavailable,
+      C11 threads.
+      If neither is available, the tasks run one after another on the calling thread.
+
+    #define CC_PARALLEL_THREADS 16
+      If CC_PARALLEL_REHASH is defined and CC_PARALLEL_FOR is not, sets the maximum number of threads, including the
+      calling thread, that run the tasks (at most 64).
+      The default is the number of online processors where POSIX threads are available, or 4 otherwise.
+
+    #define CC_VEC_PAGE_SIZE 16384
+    #define CC_VEC_HUGE_PAGE_SIZE 1048576
+      Set the page and huge page sizes, in bytes, to which vectors round the allocations through which they grow (see
+      CC_VEC_GROWTH below).
+      The defaults are 4096 and 2097152.
+
   The following can be defined anywhere and affect all calls to API macros where the definition is visible:
   
     #define CC_REALLOC our_realloc
@@ -222,6 +301,153 @@ Including the library:
     #define CC_FREE our_free
       Causes API macros to use a custom free function rather than the one in the standard library.
 
+Stateful allocators:
+
+  Instead of using the global realloc and free functions, an individual container can route all its memory allocations
+  through a stateful allocator provided via init_with_allocator (see below).
+  The allocator is a struct of the following type:
+
+    typedef struct cc_allocator
+    {
+      void *( *realloc_fn )( void *ctx, void *ptr, size_t size );
+      void ( *free_fn )( void *ctx, void *ptr );
+      void *ctx;
+    } cc_allocator;
+
+  realloc_fn and free_fn must behave like realloc and free, except that they receive ctx as their first argument.
+  free_fn may be NULL if memory obtained from the allocator is only ever released in bulk.
+  In that case, cleanup (and clear) on a list, ordered map, or ordered set only needs to visit every node if the element
+  or key type has a destructor.
+  The allocator must outlive every container that uses it.
+
+  CC also provides an arena (bump) allocator, whose individual frees cost nothing and whose memory is instead released
+  all at once:
+
+    void cc_arena_init( cc_arena *arena )
+
+      Initializes arena for use.
+      The arena allocates its blocks through the custom realloc and free functions (see above) visible at this call.
+      Once initialized, the arena must not be moved.
+      This call cannot fail (it does not allocate memory).
+
+    cc_allocator *cc_arena_allocator( cc_arena *arena )
+
+      Returns a pointer to the arena's allocator for use with init_with_allocator.
+
+    void cc_arena_reset( cc_arena *arena )
+
+      Frees all memory allocated from the arena except for its most recently allocated block, which is reused.
+      Any containers using the arena are abandoned without their destructors being called and must not be used again
+      until they are reinitialized.
+
+    void cc_arena_cleanup( cc_arena *arena )
+
+      Frees all memory allocated from the arena.
+      Any containers using the arena are abandoned in the same manner as in cc_arena_reset.
+
+  Unlike API macros, these identifiers are always prefixed with "cc_".
+
+Snapshots:
+
+  A vector, map, or set can be written to a flat, relocatable snapshot - e.g. for saving to a file - and later loaded
+  from it, either as a copy or as a view that uses the snapshot's memory directly (e.g. a file mapped via mmap).
+  Maps and sets are stored with their buckets and metadata intact, so neither loading nor viewing requires rehashing.
+  A snapshot contains a header, which records the container type, element and key sizes and layout, byte order, width
+  of size_t, and, for maps and sets, whether CC_FLAT_SMALL_MAPS and CC_INCREMENTAL_REHASH were defined, followed by a
+  record for each of the container's bucket or element arrays.
+  Each record begins with a reserved, 128-byte slot.
+  A map or set that is partway through a migration (see CC_INCREMENTAL_REHASH) has two records.
+  Snapshots are only meaningful for element and key types that are trivially copyable and contain no pointers, and
+  they may only be loaded by programs compiled for the same platform with the same hash functions and the same
+  CC_CACHE_HASH, CC_INCREMENTAL_REHASH, and CC_FLAT_SMALL_MAPS settings.
+  Loading checks the header, including these settings (except the hash functions), and the dimensions of the records,
+  but not the records' contents.
+
+    size_t snapshot_size( <vec, map, or set type> *cntr )
+
+      Returns the number of bytes required to store a snapshot of cntr.
+
+    void write_snapshot( <vec, map, or set type> *cntr, void *buf )
+
+      Writes a snapshot of cntr to buf, which must be at least snapshot_size( cntr ) bytes.
+      This call cannot fail.
+
+    bool init_from_snapshot( <vec, map, or set type> *cntr, const void *buf, size_t buf_size )
+
+      Initializes cntr as a copy of the container stored in the snapshot in buf, which is buf_size bytes.
+      Returns true if the operation was successful, or false if the snapshot is invalid or incompatible or a memory
+      allocation failure occurred.
+
+    bool init_view_of_snapshot( <vec, map, or set type> *cntr, void *buf, size_t buf_size )
+
+      Initializes cntr as a view of the container stored in the snapshot in buf, which is buf_size bytes and must be
+      aligned to alignof( max_align_t ).
+      The view stores its headers in the reserved slots of the snapshot's records, so those bytes must be writable
+      (e.g. by mapping the file with MAP_PRIVATE), but this call allocates no memory and copies none of the elements.
+      The view cannot allocate memory, so any operation that requires it to grow or be cloned fails.
+      Calling cleanup on the view releases nothing.
+      Any other modification of the view writes directly to buf.
+      Returns true if the operation was successful, or false if the snapshot is invalid or incompatible or buf is
+      misaligned.
+
+Statistics:
+
+  If CC_STATS is defined, the following function-like macro reports statistics about a vector, map, set, ordered map,
+  ordered set, B-tree map, or B-tree set, e.g. for tuning CC_LOAD:
+
+    void get_stats( <vec, map, set, omap, oset, bmap, or bset type> *cntr, cc_stats *stats )
+
+      Fills in stats, whose members that do not apply to cntr's container type are set to zero.
+      For maps and sets, this call traverses the whole table, so it takes time proportional to the bucket count.
+      For ordered maps and sets, it traverses the whole tree.
+      For B-tree maps and sets, it takes constant time.
+      cc_stats has the following members:
+
+        size_t size                 Number of elements.
+        size_t cap                  Capacity (vectors) or bucket count (maps and sets).
+        size_t reallocs             Number of times the vector's storage has been reallocated.
+        size_t chain_counts[ CC_STATS_CHAIN_LENGTHS ]
+                                    chain_counts[ i ] is the number of chains of keys sharing a home bucket whose
+                                    length is i + 1, except that the last element also counts all longer chains.
+        size_t max_chain_length     Length of the longest chain.
+        size_t max_displacement     Largest quadratic displacement of any key from its home bucket.
+        size_t displacement_limit   The displacement at which the table must grow regardless of its load factor.
+        double avg_probes_hit       Average number of buckets probed by a lookup of an existing key.
+        double avg_probes_miss      Average number of buckets probed by a lookup of a nonexisting key.
+        size_t evictions            Number of keys that insertions have moved out of other keys' home buckets.
+        size_t rehashes             Number of times all the keys have been rehashed into a new table.
+        size_t rehash_retries       Number of times a rehash has had to double the bucket count again because of the
+                                    displacement limit.
+        size_t migrations           Number of incremental migrations begun (see CC_INCREMENTAL_REHASH).
+        size_t height               Height of the ordered or B-tree map's or set's tree.
+
+      A map's or set's counters (i.e. evictions, rehashes, rehash_retries, and migrations) are carried over when it
+      grows and by init_clone, but not by init_from_snapshot or init_view_of_snapshot.
+
+Memory usage:
+
+  The following function-like macro reports the memory occupied by any container, e.g. for finding maps and sets that
+  would benefit from shrink:
+
+    cc_mem_usage memory_usage( <any container type> *cntr )
+
+      Returns the memory occupied by the container, including headers, buckets, metadata, nodes, and alignment
+      padding, but not the bookkeeping of the realloc function or allocator that provided it.
+      The memory of a container initialized via init_with_fixed_buffer or init_view_of_snapshot is counted even though
+      the container did not allocate it.
+      For lists, ordered maps, and ordered sets, this call takes constant time unless CC_POOL_NODES is defined, in which
+      case it takes time proportional to the number of slabs.
+      For B-tree maps and sets, it takes time proportional to the number of slabs.
+      For concurrent maps, it locks each shard in turn, so the result is only a snapshot if other threads are modifying
+      the map.
+      For all other containers, it takes constant time.
+      cc_mem_usage has the following members:
+
+        size_t allocated            Total bytes occupied.
+        size_t payload              Bytes occupied by the elements and keys themselves.
+        size_t overhead             allocated - payload, i.e. the bytes occupied by headers, unused capacity or
+                                    buckets, metadata, node headers, free nodes, and alignment padding.
+
 API:
 
   General notes:
@@ -240,7 +466,8 @@ API:
 
   All containers:
 
-    The following function-like macros operate on all containers:
+    The following function-like macros operate on all containers (except where noted for concurrent maps and rings
+    below):
 
     void init( <any container type> *cntr )
 
@@ -250,6 +477,16 @@ API:
     bool init_clone( <any container type> *cntr, <same container type> *src )
 
       Initializes cntr as a shallow copy of src.
+      If src was initialized via init_with_allocator, then cntr uses the same allocator.
+      Returns true, or false if unsuccessful due to memory allocation failure.
+
+    bool init_with_allocator( <any container type> *cntr, cc_allocator *allocator )
+
+      Initializes cntr for use with a stateful allocator, through which it will make all its memory allocations.
+      Unlike init, this call allocates memory for the container's header (and, in the case of a map or set, for a
+      minimal bucket array) so that the container can store the pointer to the allocator.
+      cntr remains associated with the allocator until cleanup is called, at which point it reverts to the custom or
+      standard realloc and free functions.
       Returns true, or false if unsuccessful due to memory allocation failure.
 
     size_t size( <any container type> *cntr )
@@ -294,6 +531,35 @@ API:
 
       Declares an uninitialized vector named cntr.
 
+    svec( el_ty, n ) buf
+
+      Declares an uninitialized small-vector buffer named buf, which provides inline storage for the header and first n
+      elements of a vector, e.g. as a member of the same struct as the vector.
+
+    void init_with_buffer( vec( el_ty ) *cntr, svec( el_ty, n ) *buf )
+
+      Initializes cntr for use with the inline storage of buf, which gives it an initial capacity of at least n without
+      allocating memory.
+      Once cntr outgrows that storage, it moves to memory allocated via the custom or standard realloc and free
+      functions visible at this call, and buf's storage goes unused.
+      Otherwise, cntr behaves like any other vector, except that buf must not be moved and must outlive cntr and its
+      clones, which share buf's allocator.
+      After cleanup, cntr no longer uses buf.
+      This call cannot fail (it does not allocate memory).
+
+    fvec( el_ty, n ) buf
+
+      Declares an uninitialized fixed-capacity vector buffer named buf, which provides inline storage for the header and
+      exactly n elements of a vector.
+
+    void init_with_fixed_buffer( vec( el_ty ) *cntr, fvec( el_ty, n ) *buf )
+
+      Initializes cntr for use with the inline storage of buf, which gives it a capacity of n.
+      cntr never allocates memory: any API call that would need to grow it beyond n elements fails as though memory
+      allocation had failed, as does init_clone with cntr as the source.
+      Otherwise, cntr behaves like any other vector, except that buf must not be moved and must outlive cntr.
+      This call cannot fail (it does not allocate memory).
+
     size_t cap( vec( el_ty ) *cntr )
 
       Returns the current capacity.
@@ -301,6 +567,7 @@ API:
     bool reserve( vec( el_ty ) *cntr, size_t n )
 
       Ensures that the the capacity is large enough to accommodate n elements.
+      If the capacity is below n, it becomes exactly n, regardless of the element type's growth factor.
       Returns true, or false if unsuccessful due to memory allocation failure.
 
     bool resize( vec( el_ty ) *cntr, size_t n )
@@ -357,8 +624,61 @@ API:
       Returns a pointer-iterator to the last element.
       This call is synonymous with get( cntr, size( cntr ) - 1 ) and assumes that at the vector is not empty.
 
+    void sort( vec( el_ty ) *cntr )
+
+      Sorts the elements in ascending order, as determined by el_ty's comparison function.
+      el_ty must be a type, or alias for a type, for which a comparison function has been defined.
+      Large vectors of fundamental integer types that use the default comparison function are radix sorted via a
+      temporary buffer.
+      Other vectors, or those for which the buffer cannot be allocated (e.g. vectors that use a fixed-capacity
+      buffer), are sorted in place via introsort.
+      This call cannot fail.
+
+    void stable_sort( vec( el_ty ) *cntr )
+
+      Sorts the elements in ascending order, as determined by el_ty's comparison function, while preserving the order
+      of equal elements.
+      The sort uses a temporary buffer the size of the vector.
+      If the buffer cannot be allocated (e.g. because the vector uses a fixed-capacity buffer), the elements are
+      instead merge sorted in place, which is much slower for large vectors.
+      This call cannot fail.
+
+    el_ty *binary_search( vec( el_ty ) *cntr, el_ty el )
+
+      Returns a pointer-iterator to the first element equal to el, or NULL if no such element exists.
+      The vector must be sorted, e.g. by sort or stable_sort.
+
+    size_t unique( vec( el_ty ) *cntr )
+
+      Erases every element that is equal to the element before it, calling the element type's destructor, if it
+      exists, for each erased element.
+      In a sorted vector, this call leaves one element of each value.
+      Returns the number of elements erased.
+
+    size_t filter( vec( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer to the element and ctx, returns false, calling the
+      element type's destructor, if it exists, for each erased element.
+      The order of the remaining elements is preserved.
+      Returns the number of elements erased.
+
+    size_t erase_if( vec( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer to the element and ctx, returns true, calling the
+      element type's destructor, if it exists, for each erased element.
+      The order of the remaining elements is preserved.
+      Returns the number of elements erased.
+
     Notes:
     * Vector pointer-iterators (including end) are invalidated by any API calls that cause memory reallocation.
+    * When push, push_n, insert, or insert_n needs more capacity, the capacity grows from two by the element type's
+      growth factor (see CC_VEC_GROWTH below) until it is large enough.
+      If the resulting allocation would span at least 32 pages, it is then rounded up to whole pages (or, if it would
+      span at least eight huge pages, to whole huge pages), so that no capacity is lost to the unused end of the last
+      page.
+      Allocators such as glibc's serve allocations this large via mmap and can therefore grow them via mremap without
+      copying the elements.
+      Use reserve and shrink to set the capacity exactly.
 
   List (a doubly linked list):
 
@@ -389,6 +709,9 @@ API:
       Returns true, or false if unsuccessful.
       This call only allocates memory, and therefore can only fail, if the list has not had any element inserted,
       pushed, or spliced into it since it was initialized.
+      If CC_POOL_NODES is defined and src is a different list, or if src and cntr do not share the same allocator (see
+      init_with_allocator), then the call instead moves the element into a new node allocated for cntr, so it may fail
+      due to memory allocation failure and it invalidates src_i.
 
     el_ty *last( list( el_ty ) *cntr )
 
@@ -428,6 +751,22 @@ API:
       For types with in-built comparison and hash functions, and for details on how to declare new comparison and hash
       functions, see "Destructor, comparison, and hash functions and custom max load factors" below.
 
+    fmap( key_ty, el_ty, n ) buf
+
+      Declares an uninitialized fixed-capacity map buffer named buf, which provides inline storage for a map with n
+      buckets.
+      n must be a power of two and at least 8 (this requirement is enforced internally such that neglecting it causes a
+      compiler error).
+
+    void init_with_fixed_buffer( map( key_ty, el_ty ) *cntr, fmap( key_ty, el_ty, n ) *buf )
+
+      Initializes cntr for use with the inline storage of buf, which gives it a capacity, i.e. bucket count, of n.
+      cntr never allocates memory: any API call that would need to change its capacity, i.e. rehash it, fails as
+      though memory allocation had failed, as does init_clone with cntr as the source.
+      Hence, cntr can accommodate n multiplied by the max load factor associated with its key type elements.
+      Otherwise, cntr behaves like any other map, except that buf must not be moved and must outlive cntr.
+      This call cannot fail (it does not allocate memory).
+
     size_t cap( map( key_ty, el_ty ) *cntr )
 
       Returns the current capacity, i.e. bucket count.
@@ -450,10 +789,63 @@ API:
       If an element with the same key already exists, the existing element is replaced.
       Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
 
+    bool insert_n( map( key_ty, el_ty ) *cntr, key_ty *keys, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els with the corresponding keys in the array keys.
+      If several keys are equal, only the element with the last of them is kept, and the others are destroyed.
+      If an element with the same key already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure, in which case some of the elements may already
+      have been inserted.
+      For large batches, this call is faster than n separate calls to insert because it reserves capacity for all the
+      elements at once and hashes the keys in batches, prefetching the relevant buckets before any insertion.
+
+    el_ty *insert_with_hash( map( key_ty, el_ty ) *cntr, key_ty key, el_ty el, size_t hash )
+
+      Inserts element el with the specified key, whose hash code, as returned by hash_for, is hash.
+      The key is not hashed, but the existing keys are still hashed if the map must grow and key_ty's hash codes are
+      not cached.
+      If an element with the same key already exists, the existing element is replaced.
+      Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
+
     el_ty *get( map( key_ty, el_ty ) *cntr, key_ty key )
 
       Returns a pointer-iterator to the element with the specified key, or NULL if no such element exists.
 
+    size_t get_n( map( key_ty, el_ty ) *cntr, const key_ty *keys, size_t n, el_ty **itrs )
+
+      Looks up the n keys in the array keys and stores a pointer-iterator to each corresponding element, or NULL if no
+      such element exists, in the array itrs, which must have space for n pointer-iterators.
+      Returns the number of elements found.
+      For large maps, this call is faster than n separate calls to get because it processes the keys in batches,
+      hashing each batch and prefetching the relevant buckets before any lookup, so that the cache misses overlap.
+
+    el_ty *get_with_hash( map( key_ty, el_ty ) *cntr, key_ty key, size_t hash )
+
+      Returns a pointer-iterator to the element with the specified key, whose hash code, as returned by hash_for, is
+      hash, or NULL if no such element exists.
+      The key is not hashed.
+
+    el_ty *get_heterogeneous(
+      map( key_ty, el_ty ) *cntr,
+      void *key,
+      size_t hash,
+      int ( *cmpr )( void *stored_key, void *key )
+    )
+
+      Returns a pointer-iterator to the element whose key is equal to the key, of any type, pointed to by key, or NULL
+      if no such element exists.
+      hash must be the hash code, as returned by hash_for, of the stored key that would be equal to key.
+      cmpr is called with a pointer to a stored key_ty key and the key pointer, and it must return nonzero if the keys
+      are equal.
+      This call allows the lookup of a key held in another form (e.g. a string slice) without the construction of a
+      temporary key_ty key.
+
+    size_t hash_for( map( key_ty, el_ty ) *cntr, key_ty key )
+
+      Returns the hash code of the specified key, as computed by key_ty's hash function.
+      The hash code can be reused in calls to insert_with_hash, get_with_hash, and get_heterogeneous on any map or set
+      with the same key type.
+
     el_ty *get_or_insert( map( key_ty, el_ty ) *cntr, key_ty key, el_ty el )
 
       Inserts element el if no element with the specified key already exist.
@@ -470,12 +862,33 @@ API:
       Erases the element with the specified key, if it exists.
       Returns true if an element was erased, or false if no such element exists.
 
+    size_t erase_n( map( key_ty, el_ty ) *cntr, const key_ty *keys, size_t n )
+
+      Erases the elements with the n keys in the array keys, if they exist.
+      Returns the number of elements erased.
+      For large maps, this call is faster than n separate calls to erase because it hashes the keys in batches,
+      prefetching the relevant buckets before any erasure.
+
     el_ty *erase_itr( map( key_ty, el_ty ) *cntr, el_ty *i )
 
       Erases the element pointed to by pointer-iterator i.
       Returns a pointer-iterator to the next element in the map, or an end pointer-iterator if the erased element was
       the last one.
 
+    size_t erase_if( map( key_ty, el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns true.
+      Returns the number of elements erased.
+      pred can obtain the corresponding key via key_for, given a pointer to the map via ctx.
+      Rather than erasing the elements one by one, this call repairs each chain of buckets in place during a single
+      sweep, so it never calls the hash function.
+
+    size_t filter( map( key_ty, el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns false.
+      Returns the number of elements erased.
+      Like erase_if, this call never calls the hash function.
+
     for_each( map( key_ty, el_ty ) *cntr, key_ptr_name, i_name )
 
       Creates a loop iterating over all elements from first to last, with easy access to the corresponding keys.
@@ -483,6 +896,32 @@ API:
       named i_name.
       It should be followed by the body of the loop.
 
+    el_ty *cursor_first( map( key_ty, el_ty ) *cntr, cc_cursor *cursor )
+
+      Points cursor to the first element and returns a pointer-iterator to it, or an end pointer-iterator if the
+      map is empty.
+      A cursor remembers the bucket to which it points, so cursor_next and cursor_erase do not need to derive the
+      bucket from a pointer-iterator.
+      The cursor is invalidated by any API call that modifies the map, except for
+      cursor_erase on the same cursor.
+
+    el_ty *cursor_next( map( key_ty, el_ty ) *cntr, cc_cursor *cursor )
+
+      Advances cursor to the next element and returns a pointer-iterator to it, or an end pointer-iterator if cursor
+      pointed to the last element.
+
+    el_ty *cursor_erase( map( key_ty, el_ty ) *cntr, cc_cursor *cursor )
+
+      Erases the element to which cursor points and advances cursor to the next element.
+      Returns a pointer-iterator to the next element, or an end pointer-iterator if the erased element was the last
+      one.
+      This call is faster than erase_itr and is suited to sweeping the whole map and erasing some elements.
+
+    for_each_fast( map( key_ty, el_ty ) *cntr, i_name )
+    for_each_fast( map( key_ty, el_ty ) *cntr, key_ptr_name, i_name )
+
+      Equivalent to for_each, except that the loop steps via a hidden cursor.
+
     Notes:
     * Map pointer-iterators (including end) may be invalidated by any API calls that cause memory reallocation.
 
@@ -497,6 +936,22 @@ API:
       For types with in-built comparison and hash functions, and for details on how to declare new comparison and hash
       functions, see "Destructor, comparison, and hash functions and custom max load factors" below.
 
+    fset( el_ty, n ) buf
+
+      Declares an uninitialized fixed-capacity set buffer named buf, which provides inline storage for a set with n
+      buckets.
+      n must be a power of two and at least 8 (this requirement is enforced internally such that neglecting it causes a
+      compiler error).
+
+    void init_with_fixed_buffer( set( el_ty ) *cntr, fset( el_ty, n ) *buf )
+
+      Initializes cntr for use with the inline storage of buf, which gives it a capacity, i.e. bucket count, of n.
+      cntr never allocates memory: any API call that would need to change its capacity, i.e. rehash it, fails as
+      though memory allocation had failed, as does init_clone with cntr as the source.
+      Hence, cntr can accommodate n multiplied by the max load factor associated with its element type elements.
+      Otherwise, cntr behaves like any other set, except that buf must not be moved and must outlive cntr.
+      This call cannot fail (it does not allocate memory).
+
     size_t cap( set( el_ty ) *cntr )
 
       Returns the current capacity, i.e. bucket count.
@@ -519,10 +974,59 @@ API:
       If the element already exists, the existing element is replaced.
       Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
 
+    bool insert_n( set( el_ty ) *cntr, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els.
+      If several elements are equal, only the last of them is kept, and the others are destroyed.
+      If an element already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure, in which case some of the elements may already
+      have been inserted.
+      For large batches, this call is faster than n separate calls to insert because it reserves capacity for all the
+      elements at once and hashes the elements in batches, prefetching the relevant buckets before any insertion.
+
+    el_ty *insert_with_hash( set( el_ty ) *cntr, el_ty el, size_t hash )
+
+      Inserts element el, whose hash code, as returned by hash_for, is hash.
+      The element is not hashed, but the existing elements are still hashed if the set must grow and el_ty's hash codes
+      are not cached.
+      If the element already exists, the existing element is replaced.
+      Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
+
     el_ty *get( set( el_ty ) *cntr, el_ty el )
 
       Returns a pointer-iterator to element el, or NULL if no such element exists.
 
+    size_t get_n( set( el_ty ) *cntr, const el_ty *els, size_t n, el_ty **itrs )
+
+      Looks up the n elements in the array els and stores a pointer-iterator to each corresponding element, or NULL if
+      no such element exists, in the array itrs, which must have space for n pointer-iterators.
+      Returns the number of elements found.
+      For large sets, this call is faster than n separate calls to get because it processes the elements in batches,
+      hashing each batch and prefetching the relevant buckets before any lookup, so that the cache misses overlap.
+
+    el_ty *get_with_hash( set( el_ty ) *cntr, el_ty el, size_t hash )
+
+      Returns a pointer-iterator to element el, whose hash code, as returned by hash_for, is hash, or NULL if no such
+      element exists.
+      The element is not hashed.
+
+    el_ty *get_heterogeneous(
+      set( el_ty ) *cntr,
+      void *el,
+      size_t hash,
+      int ( *cmpr )( void *stored_el, void *el )
+    )
+
+      Returns a pointer-iterator to the element equal to the element, of any type, pointed to by el, or NULL if no such
+      element exists.
+      hash must be the hash code, as returned by hash_for, of the stored element that would be equal to el.
+      cmpr is called with a pointer to a stored el_ty element and the el pointer, and it must return nonzero if the
+      elements are equal.
+
+    size_t hash_for( set( el_ty ) *cntr, el_ty el )
+
+      Returns the hash code of element el, as computed by el_ty's hash function.
+
     el_ty *get_or_insert( set( el_ty ) *cntr, el_ty el )
 
       Inserts element el if it does not already exist.
@@ -535,15 +1039,169 @@ API:
       Erases the element el, if it exists.
       Returns true if an element was erased, or false if no such element exists.
 
+    size_t erase_n( set( el_ty ) *cntr, const el_ty *els, size_t n )
+
+      Erases the n elements in the array els, if they exist.
+      Returns the number of elements erased.
+      For large sets, this call is faster than n separate calls to erase because it hashes the elements in batches,
+      prefetching the relevant buckets before any erasure.
+
     el_ty *erase_itr( set( el_ty ) *cntr, el_ty *i )
 
       Erases the element pointed to by pointer-iterator i.
       Returns a pointer-iterator to the next element in the set, or an end pointer-iterator if the erased element was
       the last one.
 
+    size_t erase_if( set( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns true.
+      Returns the number of elements erased.
+      As for maps, this call never calls the hash function.
+
+    size_t filter( set( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns false.
+      Returns the number of elements erased.
+
+    el_ty *cursor_first( set( el_ty ) *cntr, cc_cursor *cursor )
+
+      Points cursor to the first element and returns a pointer-iterator to it, or an end pointer-iterator if the
+      set is empty.
+      A cursor remembers the bucket to which it points, so cursor_next and cursor_erase do not need to derive the
+      bucket from a pointer-iterator.
+      The cursor is invalidated by any API call that modifies the set, except for
+      cursor_erase on the same cursor.
+
+    el_ty *cursor_next( set( el_ty ) *cntr, cc_cursor *cursor )
+
+      Advances cursor to the next element and returns a pointer-iterator to it, or an end pointer-iterator if cursor
+      pointed to the last element.
+
+    el_ty *cursor_erase( set( el_ty ) *cntr, cc_cursor *cursor )
+
+      Erases the element to which cursor points and advances cursor to the next element.
+      Returns a pointer-iterator to the next element, or an end pointer-iterator if the erased element was the last
+      one.
+      This call is faster than erase_itr and is suited to sweeping the whole set and erasing some elements.
+
+    for_each_fast( set( el_ty ) *cntr, i_name )
+
+      Equivalent to for_each, except that the loop steps via a hidden cursor.
+
     Notes:
     * Set pointer-iterators (including end) may be invalidated by any API calls that cause memory reallocation.
 
+  Concurrent map (an unordered associative container mapping elements to keys that may be accessed by multiple threads
+  at once, implemented as an array of maps, called shards, each guarded by its own reader-writer spinlock):
+
+    cmap( key_ty, el_ty ) cntr
+
+      Declares an uninitialized concurrent map named cntr.
+      key_ty must be a type, or alias for a type, for which comparison and hash functions have been defined (this
+      requirement is enforced internally such that neglecting it causes a compiler error).
+      For types with in-built comparison and hash functions, and for details on how to declare new comparison and hash
+      functions, see "Destructor, comparison, and hash functions and custom max load factors" below.
+
+    bool init_sharded( cmap( key_ty, el_ty ) *cntr, size_t shard_count )
+
+      Initializes cntr for use with the specified number of shards, rounded up to a power of two no greater than 1024.
+      Roughly as many shards as there are threads accessing the map at once, or several times as many, is a good
+      choice.
+      Returns true, or false if unsuccessful due to memory allocation failure.
+
+    bool insert( cmap( key_ty, el_ty ) *cntr, key_ty key, el_ty el )
+
+      Inserts element el with the specified key.
+      If an element with the same key already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure.
+
+    bool get( cmap( key_ty, el_ty ) *cntr, key_ty key, el_ty *out )
+
+      Copies the element with the specified key into the object pointed to by out.
+      Returns true, or false if no such element exists.
+
+    bool get_or_insert( cmap( key_ty, el_ty ) *cntr, key_ty key, el_ty el )
+    bool get_or_insert( cmap( key_ty, el_ty ) *cntr, key_ty key, el_ty el, el_ty *out )
+
+      Inserts element el with the specified key if no element with the same key already exists.
+      If out is specified, the element now associated with the key - i.e. the new element or the existing one - is
+      copied into the object pointed to by it.
+      Returns true, or false in the case of memory allocation failure.
+
+    bool erase( cmap( key_ty, el_ty ) *cntr, key_ty key )
+
+      Erases the element with the specified key, if it exists.
+      Returns true if an element was erased, or false if no such element exists.
+
+    Notes:
+    * Of the macros that operate on all containers, only init, size, clear, and cleanup operate on concurrent maps.
+      After init and cleanup, a concurrent map has no shards, so all insertions fail until init_sharded is called.
+    * Concurrent maps do not support iteration or pointer-iterators, since another thread could invalidate a
+      pointer-iterator at any time.
+      Instead, get and get_or_insert copy elements out while the relevant shard is still locked.
+    * insert, get, get_or_insert, erase, size, and clear may be called by multiple threads at once.
+      init_sharded, init, and cleanup must not be called while other threads are accessing the map.
+      size and clear process one shard at a time, so they do not see a single, consistent state of the map if other
+      threads are modifying it during the call.
+    * Every operation locks only the shard to which the key belongs.
+      Lookups lock the shard in shared mode, so they can proceed in parallel with one another, but not with
+      modifications of the same shard.
+    * Thread safety relies on GCC, Clang, or MSVC atomic intrinsics or, under other compilers, C11 atomics.
+      If none of these are available, declaring a concurrent map causes a compiler error.
+
+  Ring (a fixed-capacity first-in, first-out queue through which one producer thread passes elements to one consumer
+  thread without locks, implemented as a power-of-two-sized circular buffer):
+
+    ring( el_ty ) cntr
+
+      Declares an uninitialized ring named cntr.
+
+    bool init_with_cap( ring( el_ty ) *cntr, size_t cap )
+
+      Initializes cntr for use with a capacity of cap elements, rounded up to a power of two.
+      The capacity never changes thereafter.
+      Returns true, or false if unsuccessful due to memory allocation failure.
+
+    size_t cap( ring( el_ty ) *cntr )
+
+      Returns the current capacity.
+
+    bool push( ring( el_ty ) *cntr, el_ty el )
+
+      Inserts element el at the back of the ring.
+      Returns true, or false if the ring is full.
+
+    bool push_n( ring( el_ty ) *cntr, el_ty *els, size_t n )
+
+      Inserts n elements from array els at the back of the ring, but only if there is room for all of them.
+      Returns true, or false if the ring lacks room for n elements, in which case no elements are inserted.
+
+    bool pop( ring( el_ty ) *cntr, el_ty *out )
+
+      Removes the element at the front of the ring and copies it into the object pointed to by out.
+      The element's destructor is not called.
+      Returns true, or false if the ring is empty.
+
+    size_t pop_n( ring( el_ty ) *cntr, el_ty *out, size_t n )
+
+      Removes up to n elements from the front of the ring and copies them into array out.
+      The elements' destructors are not called.
+      Returns the number of elements removed.
+
+    Notes:
+    * Of the macros that operate on all containers, only init, size, clear, and cleanup operate on rings.
+      After init and cleanup, a ring has a capacity of zero, so all pushes fail until init_with_cap is called.
+    * push and push_n may only be called by the producer, and pop, pop_n, and clear may only be called by the consumer.
+      size and cap may be called by either thread, but the size is only a snapshot if the other thread is active.
+      init_with_cap, init, and cleanup must not be called while either thread is accessing the ring.
+    * Rings do not support iteration or pointer-iterators, since the producer or consumer could overwrite or remove an
+      element at any time.
+    * Each side rereads the other side's position in the ring, which usually incurs a cache miss, only when the ring
+      appears to be full (to the producer) or empty (to the consumer).
+      Hence, push_n and pop_n amortize that cost over a whole batch of elements.
+    * Thread safety relies on GCC, Clang, or MSVC atomic intrinsics or, under other compilers, C11 atomics.
+      If none of these are available, declaring a ring causes a compiler error.
+
   Ordered map (an ordered associative container mapping elements to keys, implemented as a red-black tree):
 
     omap( key_ty, el_ty ) cntr
@@ -560,10 +1218,49 @@ API:
       If an element with the same key already exists, the existing element is replaced.
       Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
 
+    bool insert_n( omap( key_ty, el_ty ) *cntr, key_ty *keys, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els with the corresponding keys in the array keys, which may be in any order.
+      If several keys are equal, only the element with the last of them is kept, and the others are destroyed.
+      If an element with the same key already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure, in which case some of the elements may already
+      have been inserted.
+      If the keys are already in ascending order, this call is equivalent to insert_sorted_n.
+      Otherwise, it sorts the keys first and then, if the ordered map is empty, builds the tree directly, as
+      insert_sorted_n does, or else inserts the elements in ascending order, beginning each search for an insertion
+      point from the previously inserted element rather than the root, so that runs of adjacent keys are inserted
+      quickly.
+
+    bool insert_sorted_n( omap( key_ty, el_ty ) *cntr, key_ty *keys, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els with the corresponding keys in the array keys, which must be in ascending
+      order.
+      If several keys are equal, only the element with the last of them is inserted, and the others are destroyed.
+      If an element with the same key already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure.
+      If the ordered map is empty, this call builds a balanced tree directly in linear time, allocating all the nodes at
+      once if CC_POOL_NODES is defined or the ordered map's allocator has no free_fn (see "Stateful allocators" above),
+      and in the case of memory allocation failure, no elements are inserted or destroyed.
+      Otherwise, it is equivalent to n calls to insert.
+
+    bool init_from_sorted( omap( key_ty, el_ty ) *cntr, key_ty *keys, el_ty *els, size_t n )
+
+      Initializes cntr for use and then calls insert_sorted_n.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case cntr is left as an
+      initialized empty ordered map.
+
     el_ty *get( omap( key_ty, el_ty ) *cntr, key_ty key )
 
       Returns a pointer-iterator to the element with the specified key, or NULL if no such element exists.
 
+    size_t get_n( omap( key_ty, el_ty ) *cntr, const key_ty *keys, size_t n, el_ty **itrs )
+
+      Looks up the n keys in the array keys and stores a pointer-iterator to each corresponding element, or NULL if no
+      such element exists, in the array itrs, which must have space for n pointer-iterators.
+      Returns the number of elements found.
+      For large ordered maps, this call is faster than n separate calls to get because it processes the keys in
+      batches, descending the tree for all keys in a batch in lockstep, so that the cache misses overlap.
+
     el_ty *get_or_insert( omap( key_ty, el_ty ) *cntr, key_ty key, el_ty el )
 
       Inserts element el if no element with the specified key already exists.
@@ -580,12 +1277,62 @@ API:
       Erases the element with the specified key, if it exists.
       Returns true if an element was erased, or false if no such element exists.
 
+    size_t erase_n( omap( key_ty, el_ty ) *cntr, const key_ty *keys, size_t n )
+
+      Erases the elements with the n keys in the array keys, if they exist.
+      Returns the number of elements erased.
+      For large ordered maps, this call is faster than n separate calls to erase because it locates the keys in batches,
+      as get_n does.
+
     el_ty *erase_itr( omap( key_ty, el_ty ) *cntr, el_ty *i )
 
       Erases the element pointed to by pointer-iterator i.
       Returns a pointer-iterator to the next element in the ordered map, or an end pointer-iterator if the erased
       element was the last one.
 
+    el_ty *erase_range( omap( key_ty, el_ty ) *cntr, el_ty *i_first, el_ty *i_end )
+
+      Erases the elements from the one pointed to by pointer-iterator i_first up to, but not including, the one pointed
+      to by pointer-iterator i_end, which may be an end pointer-iterator.
+      Returns i_end.
+      Rather than erasing the elements one by one, this call splits them off the tree and joins the remaining elements
+      back together, so besides destroying the erased elements, it takes polylogarithmic time.
+
+    size_t erase_if( omap( key_ty, el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns true.
+      Returns the number of elements erased.
+      pred can obtain the corresponding key via key_for, given a pointer to the ordered map via ctx.
+      Rather than erasing the elements one by one, this call dismantles the tree and rebuilds it, perfectly balanced,
+      from the remaining elements, so besides calling pred and destroying the erased elements, it takes linear time.
+      Pointer-iterators to the remaining elements remain valid.
+
+    size_t filter( omap( key_ty, el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns false.
+      Returns the number of elements erased.
+      Like erase_if, this call takes linear time.
+
+    bool split_at( omap( key_ty, el_ty ) *cntr, key_ty key, omap( key_ty, el_ty ) *dst )
+
+      Moves the elements with keys greater than or equal to the specified key into the ordered map dst, combining them
+      with dst's elements as join does.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case neither ordered map is
+      changed.
+      If the two ordered maps use the same allocator and CC_POOL_NODES is not defined, the elements are split off the
+      tree without being copied, in polylogarithmic time plus, if CC_ORDER_STATISTICS is not defined, time proportional
+      to the size of the smaller of the two resulting ordered maps.
+      Otherwise, they are copied into newly allocated memory.
+
+    bool join( omap( key_ty, el_ty ) *cntr, omap( key_ty, el_ty ) *src )
+
+      Moves all elements from the ordered map src into the ordered map, replacing any elements with the same keys.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case neither ordered map is
+      changed.
+      If the two ordered maps use the same allocator, CC_POOL_NODES is not defined, and all the keys in one ordered map
+      are less than all the keys in the other, the trees are joined without any elements being copied, in
+      polylogarithmic time.
+
     el_ty *first( omap( key_ty, el_ty ) *cntr, key_ty key )
 
       Returns a pointer-iterator to the first element with a key greater than or equal to the specified key, or an end
@@ -600,6 +1347,25 @@ API:
       Returns a pointer-iterator to the last element with a key less than or equal to the specified key, or an r_end
       pointer-iterator if the ordered map is empty.
 
+    el_ty *nth( omap( key_ty, el_ty ) *cntr, size_t n )
+
+      Returns a pointer-iterator to the element at zero-based position n in key order, or an end pointer-iterator if n
+      is not less than the size.
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates from the first or last
+      element, whichever is nearer.
+
+    size_t rank( omap( key_ty, el_ty ) *cntr, key_ty key )
+
+      Returns the number of elements with keys less than the specified key, i.e. the position at which an element with
+      that key is or would be.
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates from the first element.
+
+    size_t count_range( omap( key_ty, el_ty ) *cntr, key_ty lo, key_ty hi )
+
+      Returns the number of elements with keys greater than or equal to lo and less than or equal to hi, i.e. those
+      from first( cntr, lo ) to last( cntr, hi ).
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates over those elements.
+
     el_ty *prev( omap( key_ty, el_ty ) *cntr, el_ty *i )
 
       Returns a pointer-iterator to the element before the one pointed to by i.
@@ -653,10 +1419,48 @@ API:
       If the element already exists, the existing element is replaced.
       Returns a pointer-iterator to the new element, or NULL in the case of memory allocation failure.
 
+    bool insert_n( oset( el_ty ) *cntr, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els, which may be in any order.
+      If several elements are equal, only the last of them is kept, and the others are destroyed.
+      If an element already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure, in which case some of the elements may already
+      have been inserted.
+      If the elements are already in ascending order, this call is equivalent to insert_sorted_n.
+      Otherwise, it sorts the elements first and then, if the ordered set is empty, builds the tree directly, as
+      insert_sorted_n does, or else inserts the elements in ascending order, beginning each search for an insertion
+      point from the previously inserted element rather than the root, so that runs of adjacent elements are inserted
+      quickly.
+
+    bool insert_sorted_n( oset( el_ty ) *cntr, el_ty *els, size_t n )
+
+      Inserts the n elements in the array els, which must be in ascending order.
+      If several elements are equal, only the last of them is inserted, and the others are destroyed.
+      If an element already exists, the existing element is replaced.
+      Returns true, or false in the case of memory allocation failure.
+      If the ordered set is empty, this call builds a balanced tree directly in linear time, allocating all the nodes at
+      once if CC_POOL_NODES is defined or the ordered set's allocator has no free_fn (see "Stateful allocators" above),
+      and in the case of memory allocation failure, no elements are inserted or destroyed.
+      Otherwise, it is equivalent to n calls to insert.
+
+    bool init_from_sorted( oset( el_ty ) *cntr, el_ty *els, size_t n )
+
+      Initializes cntr for use and then calls insert_sorted_n.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case cntr is left as an
+      initialized empty ordered set.
+
     el_ty *get( oset( el_ty ) *cntr, el_ty el )
 
       Returns a pointer-iterator to element el, or NULL if no such element exists.
 
+    size_t get_n( oset( el_ty ) *cntr, const el_ty *els, size_t n, el_ty **itrs )
+
+      Looks up the n elements in the array els and stores a pointer-iterator to each corresponding element, or NULL if
+      no such element exists, in the array itrs, which must have space for n pointer-iterators.
+      Returns the number of elements found.
+      For large ordered sets, this call is faster than n separate calls to get because it processes the elements in
+      batches, descending the tree for all elements in a batch in lockstep, so that the cache misses overlap.
+
     el_ty *get_or_insert( oset( el_ty ) *cntr, el_ty el )
 
       Inserts element el if it does not already exist.
@@ -669,12 +1473,53 @@ API:
       Erases the element el, if it exists.
       Returns true if an element was erased, or false if no such element exists.
 
+    size_t erase_n( oset( el_ty ) *cntr, const el_ty *els, size_t n )
+
+      Erases the n elements in the array els, if they exist.
+      Returns the number of elements erased.
+      For large ordered sets, this call is faster than n separate calls to erase because it locates the elements in
+      batches, as get_n does.
+
     el_ty *erase_itr( oset( el_ty ) *cntr, el_ty *i )
 
       Erases the element pointed to by pointer-iterator i.
       Returns a pointer-iterator to the next element in the ordered set, or an end pointer-iterator if the erased
       element was the last one.
 
+    el_ty *erase_range( oset( el_ty ) *cntr, el_ty *i_first, el_ty *i_end )
+
+      Erases the elements from the one pointed to by pointer-iterator i_first up to, but not including, the one pointed
+      to by pointer-iterator i_end, which may be an end pointer-iterator.
+      Returns i_end.
+      As for ordered maps, this call takes polylogarithmic time besides destroying the erased elements.
+
+    size_t erase_if( oset( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns true.
+      Returns the number of elements erased.
+      As for ordered maps, this call takes linear time, and pointer-iterators to the remaining elements remain valid.
+
+    size_t filter( oset( el_ty ) *cntr, bool ( *pred )( void *el, void *ctx ), void *ctx )
+
+      Erases every element for which pred, called with a pointer-iterator to the element and ctx, returns false.
+      Returns the number of elements erased.
+
+    bool split_at( oset( el_ty ) *cntr, el_ty el, oset( el_ty ) *dst )
+
+      Moves the elements greater than or equal to el into the ordered set dst, combining them with dst's elements as
+      join does.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case neither ordered set is
+      changed.
+      The conditions under which the elements are moved without being copied are the same as for ordered maps.
+
+    bool join( oset( el_ty ) *cntr, oset( el_ty ) *src )
+
+      Moves all elements from the ordered set src into the ordered set, replacing any equal elements.
+      Returns true, or false if unsuccessful due to memory allocation failure, in which case neither ordered set is
+      changed.
+      The conditions under which the trees are joined without any elements being copied are the same as for ordered
+      maps.
+
     el_ty *first( oset( key_ty, el_ty ) *cntr, el_ty el )
 
       Returns a pointer-iterator to the first element greater than or equal to el, or an end pointer-iterator if no such
@@ -689,6 +1534,24 @@ API:
       Returns a pointer-iterator to the last element less than or equal to el, or an end pointer-iterator if no such
       element exists.
 
+    el_ty *nth( oset( el_ty ) *cntr, size_t n )
+
+      Returns a pointer-iterator to the element at zero-based position n in ascending order, or an end pointer-iterator
+      if n is not less than the size.
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates from the first or last
+      element, whichever is nearer.
+
+    size_t rank( oset( el_ty ) *cntr, el_ty el )
+
+      Returns the number of elements less than el, i.e. the position at which el is or would be.
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates from the first element.
+
+    size_t count_range( oset( el_ty ) *cntr, el_ty lo, el_ty hi )
+
+      Returns the number of elements greater than or equal to lo and less than or equal to hi, i.e. those from
+      first( cntr, lo ) to last( cntr, hi ).
+      This call takes logarithmic time if CC_ORDER_STATISTICS is defined or otherwise iterates over those elements.
+
     el_ty *prev( oset( el_ty ) *cntr, el_ty *i )
 
       Returns a pointer-iterator to the element before the one pointed to by i.
@@ -712,10 +1575,49 @@ API:
     * Ordered set pointer-iterators (including r_end and end) may be invalidated by any API calls that cause memory
       reallocation.
 
+  B-tree map (an ordered associative container mapping elements to keys, implemented as a B-tree):
+
+    bmap( key_ty, el_ty ) cntr
+
+      Declares an uninitialized B-tree map named cntr.
+      key_ty must be a type, or alias for a type, for which a comparison function has been defined (this requirement is
+      enforced internally such that neglecting it causes a compiler error).
+      For types with in-built comparison functions, and for details on how to declare new comparison functions, see
+      "Destructor, comparison, and hash functions and custom max load factors" below.
+
+    B-tree maps support the same API as ordered maps, except insert_n, insert_sorted_n, init_from_sorted, get_n,
+    erase_n, nth, rank, count_range, erase_range, split_at, and join.
+
+    Notes:
+    * Each node of a B-tree map spans a few cache lines and holds many elements, so lookups and iteration incur far
+      fewer cache misses than in an ordered map.
+      In exchange, insertions and erasures move elements within and between nodes.
+    * For keys of fundamental integer types with the default comparison functions, searches within a node compare keys
+      directly, and for int keys, they compare four keys at a time if CC_SIMD is defined.
+    * B-tree map pointer-iterators (excluding r_end and end) may be invalidated by any API calls that insert or erase
+      elements, except for the pointer-iterator returned by the call.
+    * The memory of erased elements is kept for reuse until clear or cleanup is called.
+
+  B-tree set (an ordered associative container for elements without a separate key, implemented as a B-tree):
+
+    bset( el_ty ) cntr
+
+      Declares an uninitialized B-tree set named cntr.
+      el_ty must be a type, or alias for a type, for which a comparison function has been defined (this requirement is
+      enforced internally such that neglecting it causes a compiler error).
+      For types with in-built comparison functions, and for details on how to declare new comparison functions, see
+      "Destructor, comparison, and hash functions and custom max load factors" below.
+
+    B-tree sets support the same API as ordered sets, except insert_n, insert_sorted_n, init_from_sorted, get_n,
+    erase_n, nth, rank, count_range, erase_range, split_at, and join.
+
+    Notes:
+    * The notes on B-tree maps above also apply to B-tree sets.
+
   Destructor, comparison, and hash functions and custom max load factors:
 
-    This part of the API allows the user to define custom destructor, comparison, and hash functions and max load
-    factors for a type.
+    This part of the API allows the user to define custom destructor, comparison, and hash functions, max load
+    factors, and vector growth factors for a type.
     Once these functions are defined, any container using that type for its elements or keys will call them
     automatically.
     Once the max load factor is defined, any map using the type for its keys and any set using the type for its elements
@@ -748,6 +1650,34 @@ API:
       max_load_factor should be a float or double between 0.0 and 1.0.
       The default max load factor is 0.9.
 
+    #define CC_VEC_GROWTH ty, growth_factor
+
+      Defines the factor by which vectors using type ty as their element type grow their capacity.
+      growth_factor should be a float or double above 1.0.
+      The default growth factor is 2.0.
+      Smaller factors, e.g. 1.5, leave less capacity unused in large vectors at the cost of more frequent reallocation.
+
+    #define CC_CACHE_HASH ty
+    #include "cc.h"
+
+      Causes maps using type ty as their key type, and sets using it as their element type, to store each key's hash
+      code alongside the key.
+      Growing the table, erasing via a pointer-iterator, and displacing keys during insertion then reuse the stored hash
+      codes instead of calling the hash function again, and lookups compare stored hash codes before calling the
+      comparison function.
+      This option benefits keys that are expensive to hash or compare (e.g. long strings or large structs), at the cost
+      of sizeof( size_t ) bytes, plus any padding, per bucket.
+
+    typedef struct { char *data; size_t len; } cc_str;
+
+      A string of known length, usable as a key or element type with in-built comparison and hash functions.
+      data need not be NULL-terminated and may contain null bytes.
+      Two cc_str values are equal if they have the same length and bytes, and they are ordered lexicographically by
+      their bytes, with a shorter string ordered before any longer string that it prefixes.
+      Prefer cc_str to char * for string keys whose lengths are already known, as its hash function processes whole
+      words without searching for a terminator.
+      The container only stores the cc_str struct, not a copy of the bytes that data points to.
+
     Trivial example:
 
       typedef struct { int x; } our_type;
@@ -755,19 +1685,22 @@ API:
       #define CC_CMPR our_type, { return val_1.x < val_2.x ? -1 : val_1.x > val_2.x; }
       #define CC_HASH our_type, { return val.x * 2654435761ull; }
       #define CC_LOAD our_type, 0.5
+      #define CC_VEC_GROWTH our_type, 1.5
+      #define CC_CACHE_HASH our_type
       #include "cc.h"
 
     Notes:
     * These functions are inline and have static scope, so you need to either redefine them in each translation unit
       from which they should be called or (preferably) define them in a shared header. For structs or unions, a sensible
       place to define them is immediately after the definition of the struct or union.
-    * Only one destructor, comparison, or hash function or max load factor should be defined by the user for each type.
+    * Only one destructor, comparison, or hash function, max load factor, or growth factor should be defined by the user
+      for each type.
     * Including cc.h in these cases does not include the full header, so you still need to include it separately at the
       top of your files.
     * In-built comparison and hash functions are already defined for the following types: char, unsigned char, signed
-      char, unsigned short, short, unsigned int, int, unsigned long, long, unsigned long long, long long, size_t, and
-      char * (a NULL-terminated string). Defining a comparison or hash function for one of these types will overwrite
-      the in-built function.
+      char, unsigned short, short, unsigned int, int, unsigned long, long, unsigned long long, long long, size_t,
+      char * (a NULL-terminated string), and cc_str. Defining a comparison or hash function for one of these types will
+      overwrite the in-built function.
 
 Version history:
 
@@ -822,7 +1755,8 @@ License (MIT):
 
 */
 
-#if !defined( CC_DTOR ) && !defined( CC_CMPR ) && !defined( CC_HASH ) && !defined( CC_LOAD )/*------------------------*/
+#if !defined( CC_DTOR ) && !defined( CC_CMPR ) && !defined( CC_HASH ) && !defined( CC_LOAD ) && \
+  !defined( CC_VEC_GROWTH ) && !defined( CC_CACHE_HASH )/*-----------------------------------------------------------*/
 /*                                                                                                                    */
 /*                                                REGULAR HEADER MODE                                                 */
 /*                                                                                                                    */
@@ -843,17 +1777,62 @@ License (MIT):
 #ifdef __cplusplus
 #include <type_traits>
 #endif
+// SIMD intrinsics used to search B-tree map and set nodes with int keys (see "B-tree map" below).
+#if defined( CC_SIMD ) && ( defined( __GNUC__ ) || defined( _MSC_VER ) ) && \
+  ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP == 2 ) )
+#define CC_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined( CC_SIMD ) && ( defined( __GNUC__ ) || defined( _MSC_VER ) ) && \
+  ( ( defined( __ARM_NEON ) && defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ ) || \
+  defined( _M_ARM64 ) )
+#define CC_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#if defined( _MSC_VER ) && ( defined( CC_SIMD_SSE2 ) || defined( CC_SIMD_NEON ) || defined( _M_X64 ) || \
+  defined( _M_IX86 ) )
+#include <intrin.h>
+#endif
+// Threads used by the built-in backend for parallel rehashing (see "Parallelism" below).
+#if defined( CC_PARALLEL_REHASH ) && !defined( CC_PARALLEL_FOR ) && ( defined( __unix__ ) || defined( __APPLE__ ) )
+#define CC_PARALLEL_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#elif defined( CC_PARALLEL_REHASH ) && !defined( CC_PARALLEL_FOR ) && !defined( __cplusplus ) && \
+  defined( __STDC_VERSION__ ) && __STDC_VERSION__ >= 201112L && !defined( __STDC_NO_THREADS__ )
+#define CC_PARALLEL_C11_THREADS
+#include <threads.h>
+#endif
 #endif
 
 #ifndef CC_NO_SHORT_NAMES
 #define vec( ... )           CC_MSVC_PP_FIX( cc_vec( __VA_ARGS__ ) )
+#define svec( ... )          CC_MSVC_PP_FIX( cc_svec( __VA_ARGS__ ) )
+#define fvec( ... )          CC_MSVC_PP_FIX( cc_fvec( __VA_ARGS__ ) )
 #define list( ... )          CC_MSVC_PP_FIX( cc_list( __VA_ARGS__ ) )
 #define map( ... )           CC_MSVC_PP_FIX( cc_map( __VA_ARGS__ ) )
+#define fmap( ... )          CC_MSVC_PP_FIX( cc_fmap( __VA_ARGS__ ) )
 #define set( ... )           CC_MSVC_PP_FIX( cc_set( __VA_ARGS__ ) )
+#define fset( ... )          CC_MSVC_PP_FIX( cc_fset( __VA_ARGS__ ) )
 #define omap( ... )          CC_MSVC_PP_FIX( cc_omap( __VA_ARGS__ ) )
 #define oset( ... )          CC_MSVC_PP_FIX( cc_oset( __VA_ARGS__ ) )
+#define cmap( ... )          CC_MSVC_PP_FIX( cc_cmap( __VA_ARGS__ ) )
+#define ring( ... )          CC_MSVC_PP_FIX( cc_ring( __VA_ARGS__ ) )
+#define bmap( ... )          CC_MSVC_PP_FIX( cc_bmap( __VA_ARGS__ ) )
+#define bset( ... )          CC_MSVC_PP_FIX( cc_bset( __VA_ARGS__ ) )
 #define init( ... )          CC_MSVC_PP_FIX( cc_init( __VA_ARGS__ ) )
 #define init_clone( ... )    CC_MSVC_PP_FIX( cc_init_clone( __VA_ARGS__ ) )
+#define init_with_allocator( ... ) CC_MSVC_PP_FIX( cc_init_with_allocator( __VA_ARGS__ ) )
+#define init_with_buffer( ... ) CC_MSVC_PP_FIX( cc_init_with_buffer( __VA_ARGS__ ) )
+#define init_with_fixed_buffer( ... ) CC_MSVC_PP_FIX( cc_init_with_fixed_buffer( __VA_ARGS__ ) )
+#define init_sharded( ... )  CC_MSVC_PP_FIX( cc_init_sharded( __VA_ARGS__ ) )
+#define init_with_cap( ... ) CC_MSVC_PP_FIX( cc_init_with_cap( __VA_ARGS__ ) )
+#define init_from_sorted( ... ) CC_MSVC_PP_FIX( cc_init_from_sorted( __VA_ARGS__ ) )
+#define init_from_snapshot( ... ) CC_MSVC_PP_FIX( cc_init_from_snapshot( __VA_ARGS__ ) )
+#define init_view_of_snapshot( ... ) CC_MSVC_PP_FIX( cc_init_view_of_snapshot( __VA_ARGS__ ) )
+#define get_stats( ... )     CC_MSVC_PP_FIX( cc_get_stats( __VA_ARGS__ ) )
+#define memory_usage( ... )  CC_MSVC_PP_FIX( cc_memory_usage( __VA_ARGS__ ) )
+#define snapshot_size( ... ) CC_MSVC_PP_FIX( cc_snapshot_size( __VA_ARGS__ ) )
+#define write_snapshot( ... ) CC_MSVC_PP_FIX( cc_write_snapshot( __VA_ARGS__ ) )
 #define size( ... )          CC_MSVC_PP_FIX( cc_size( __VA_ARGS__ ) )
 #define cap( ... )           CC_MSVC_PP_FIX( cc_cap( __VA_ARGS__ ) )
 #define reserve( ... )       CC_MSVC_PP_FIX( cc_reserve( __VA_ARGS__ ) )
@@ -861,15 +1840,32 @@ License (MIT):
 #define shrink( ... )        CC_MSVC_PP_FIX( cc_shrink( __VA_ARGS__ ) )
 #define insert( ... )        CC_MSVC_PP_FIX( cc_insert( __VA_ARGS__ ) )
 #define insert_n( ... )      CC_MSVC_PP_FIX( cc_insert_n( __VA_ARGS__ ) )
+#define insert_with_hash( ... ) CC_MSVC_PP_FIX( cc_insert_with_hash( __VA_ARGS__ ) )
+#define insert_sorted_n( ... ) CC_MSVC_PP_FIX( cc_insert_sorted_n( __VA_ARGS__ ) )
 #define get_or_insert( ... ) CC_MSVC_PP_FIX( cc_get_or_insert( __VA_ARGS__ ) )
 #define push( ... )          CC_MSVC_PP_FIX( cc_push( __VA_ARGS__ ) )
 #define push_n( ... )        CC_MSVC_PP_FIX( cc_push_n( __VA_ARGS__ ) )
+#define pop( ... )           CC_MSVC_PP_FIX( cc_pop( __VA_ARGS__ ) )
+#define pop_n( ... )         CC_MSVC_PP_FIX( cc_pop_n( __VA_ARGS__ ) )
 #define splice( ... )        CC_MSVC_PP_FIX( cc_splice( __VA_ARGS__ ) )
+#define sort( ... )          CC_MSVC_PP_FIX( cc_sort( __VA_ARGS__ ) )
+#define stable_sort( ... )   CC_MSVC_PP_FIX( cc_stable_sort( __VA_ARGS__ ) )
+#define binary_search( ... ) CC_MSVC_PP_FIX( cc_binary_search( __VA_ARGS__ ) )
+#define unique( ... )        CC_MSVC_PP_FIX( cc_unique( __VA_ARGS__ ) )
+#define filter( ... )        CC_MSVC_PP_FIX( cc_filter( __VA_ARGS__ ) )
+#define split_at( ... )      CC_MSVC_PP_FIX( cc_split_at( __VA_ARGS__ ) )
+#define join( ... )          CC_MSVC_PP_FIX( cc_join( __VA_ARGS__ ) )
 #define get( ... )           CC_MSVC_PP_FIX( cc_get( __VA_ARGS__ ) )
+#define get_n( ... )         CC_MSVC_PP_FIX( cc_get_n( __VA_ARGS__ ) )
+#define get_with_hash( ... ) CC_MSVC_PP_FIX( cc_get_with_hash( __VA_ARGS__ ) )
+#define get_heterogeneous( ... ) CC_MSVC_PP_FIX( cc_get_heterogeneous( __VA_ARGS__ ) )
+#define hash_for( ... )      CC_MSVC_PP_FIX( cc_hash_for( __VA_ARGS__ ) )
 #define key_for( ... )       CC_MSVC_PP_FIX( cc_key_for( __VA_ARGS__ ) )
 #define erase( ... )         CC_MSVC_PP_FIX( cc_erase( __VA_ARGS__ ) )
 #define erase_n( ... )       CC_MSVC_PP_FIX( cc_erase_n( __VA_ARGS__ ) )
 #define erase_itr( ... )     CC_MSVC_PP_FIX( cc_erase_itr( __VA_ARGS__ ) )
+#define erase_range( ... )   CC_MSVC_PP_FIX( cc_erase_range( __VA_ARGS__ ) )
+#define erase_if( ... )      CC_MSVC_PP_FIX( cc_erase_if( __VA_ARGS__ ) )
 #define clear( ... )         CC_MSVC_PP_FIX( cc_clear( __VA_ARGS__ ) )
 #define cleanup( ... )       CC_MSVC_PP_FIX( cc_cleanup( __VA_ARGS__ ) )
 #define first( ... )         CC_MSVC_PP_FIX( cc_first( __VA_ARGS__ ) )
@@ -878,7 +1874,14 @@ License (MIT):
 #define end( ... )           CC_MSVC_PP_FIX( cc_end( __VA_ARGS__ ) )
 #define next( ... )          CC_MSVC_PP_FIX( cc_next( __VA_ARGS__ ) )
 #define prev( ... )          CC_MSVC_PP_FIX( cc_prev( __VA_ARGS__ ) )
+#define cursor_first( ... )  CC_MSVC_PP_FIX( cc_cursor_first( __VA_ARGS__ ) )
+#define cursor_next( ... )   CC_MSVC_PP_FIX( cc_cursor_next( __VA_ARGS__ ) )
+#define cursor_erase( ... )  CC_MSVC_PP_FIX( cc_cursor_erase( __VA_ARGS__ ) )
+#define nth( ... )           CC_MSVC_PP_FIX( cc_nth( __VA_ARGS__ ) )
+#define rank( ... )          CC_MSVC_PP_FIX( cc_rank( __VA_ARGS__ ) )
+#define count_range( ... )   CC_MSVC_PP_FIX( cc_count_range( __VA_ARGS__ ) )
 #define for_each( ... )      CC_MSVC_PP_FIX( cc_for_each( __VA_ARGS__ ) )
+#define for_each_fast( ... ) CC_MSVC_PP_FIX( cc_for_each_fast( __VA_ARGS__ ) )
 #define r_for_each( ... )    CC_MSVC_PP_FIX( cc_r_for_each( __VA_ARGS__ ) )
 #endif
 
@@ -910,6 +1913,15 @@ License (MIT):
 #define CC_UNLIKELY( xp ) ( xp )
 #endif
 
+// Prefetches the cache line containing the specified address for reading.
+#ifdef __GNUC__
+#define CC_PREFETCH( ptr ) __builtin_prefetch( ptr )
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#define CC_PREFETCH( ptr ) _mm_prefetch( (const char *)( ptr ), _MM_HINT_T0 )
+#else
+#define CC_PREFETCH( ptr ) (void)( ptr )
+#endif
+
 // Marks a point where the program never reaches.
 #ifdef __GNUC__
 #define CC_UNREACHABLE __builtin_unreachable()
@@ -1037,7 +2049,7 @@ CC_CAST_MAYBE_UNUSED(                                               \
 #define CC_FREE_COMMA ,
 #define CC_FREE_FN CC_2ND_ARG( CC_CAT_2( CC_FREE, _COMMA ) free, CC_FREE, )
 
-// Macro used with CC_STATIC_ASSERT to provide type safety in cc_init_clone and cc_splice calls.
+// Macro used with CC_STATIC_ASSERT to provide type safety in cc_init_clone, cc_splice, cc_split_at, and cc_join calls.
 #ifdef __cplusplus
 #define CC_IS_SAME_TY( a, b ) std::is_same<CC_TYPEOF_XP( a ), CC_TYPEOF_XP( b )>::value
 #else
@@ -1078,6 +2090,9 @@ static void *cc_dummy_true_ptr = &cc_dummy_true;
 // Default max load factor for maps and sets.
 #define CC_DEFAULT_LOAD 0.9
 
+// Default growth factor for vectors.
+#define CC_DEFAULT_VEC_GROWTH 2.0
+
 // Types for comparison, hash, destructor, realloc, and free functions.
 // These are only for internal use as user-provided comparison, hash, and destructor functions have different signatures
 // (see above documentation).
@@ -1086,6 +2101,7 @@ typedef size_t ( *cc_hash_fnptr_ty )( void * );
 typedef void ( *cc_dtor_fnptr_ty )( void * );
 typedef void *( *cc_realloc_fnptr_ty )( void *, size_t );
 typedef void ( *cc_free_fnptr_ty )( void * );
+typedef bool ( *cc_pred_fnptr_ty )( void *, void * );
 
 // Container ids to identify container type at compile-time.
 #define CC_VEC  1
@@ -1094,6 +2110,10 @@ typedef void ( *cc_free_fnptr_ty )( void * );
 #define CC_SET  4
 #define CC_OMAP 5
 #define CC_OSET 6
+#define CC_CMAP 7
+#define CC_BMAP 8
+#define CC_BSET 9
+#define CC_RING 10
 
 // Produces the underlying function pointer type for a given element/key type pair.
 #define CC_MAKE_BASE_FNPTR_TY( el_ty, key_ty ) CC_TYPEOF_TY( CC_TYPEOF_TY( el_ty ) (*)( CC_TYPEOF_TY( key_ty )* ) )
@@ -1110,6 +2130,55 @@ typedef void ( *cc_free_fnptr_ty )( void * );
 
 #define cc_vec( el_ty )          CC_MAKE_CNTR_TY( el_ty, size_t, CC_VEC ) // Vector key type is size_t.
 
+// A small-vector buffer is not a container but inline storage for a vector's header and first n elements.
+// The vector's header must immediately precede its elements, which is guaranteed because cc_vec_hdr_ty's size is a
+// multiple of max_align_t's alignment.
+#define cc_svec( el_ty, n ) \
+struct                      \
+{                           \
+  cc_svec_hdr_ty hdr;       \
+  cc_vec_hdr_ty vec_hdr;    \
+  el_ty els[ n ];           \
+}                           \
+
+// Fixed-capacity buffers are not containers but inline storage for a container's header and n elements (or, in the
+// case of maps and sets, buckets), from which that container never moves.
+// Every fixed-capacity buffer names its header cntr_hdr and its array slots so that cc_init_with_fixed_buffer can
+// handle them uniformly.
+// A vector's slot is a struct wrapping a single element, so it has the same size and alignment as the element.
+// A map or set bucket's size depends on the bucket layout, which is not a compile-time constant, so each slot is
+// instead a struct containing the element, key, and a cached hash code, which is at least as large as the bucket that
+// it stands in for.
+#define cc_fvec( el_ty, n )        \
+struct                             \
+{                                  \
+  cc_fixed_buf_hdr_ty hdr;         \
+  cc_vec_hdr_ty cntr_hdr;          \
+  struct { el_ty el; } slots[ n ]; \
+}                                  \
+
+// For maps and sets, n must be a power of two no smaller than CC_MAP_MIN_NONZERO_BUCKET_COUNT.
+#define CC_FIXED_MAP_SLOT_COUNT( n )                                                        \
+( (n) * ( ( (n) & ( (n) - 1 ) ) == 0 && (n) >= CC_MAP_MIN_NONZERO_BUCKET_COUNT ? 1 : -1 ) ) \
+
+#define cc_fmap( key_ty, el_ty, n )                                                    \
+struct                                                                                 \
+{                                                                                      \
+  cc_fixed_buf_hdr_ty hdr;                                                             \
+  cc_map_hdr_ty cntr_hdr;                                                              \
+  struct { el_ty el; key_ty key; size_t hash; } slots[ CC_FIXED_MAP_SLOT_COUNT( n ) ]; \
+  uint16_t metadata[ (n) + CC_MAP_METADATA_EXCESS ];                                   \
+}                                                                                      \
+
+#define cc_fset( el_ty, n )                                                \
+struct                                                                     \
+{                                                                          \
+  cc_fixed_buf_hdr_ty hdr;                                                 \
+  cc_map_hdr_ty cntr_hdr;                                                  \
+  struct { el_ty el; size_t hash; } slots[ CC_FIXED_MAP_SLOT_COUNT( n ) ]; \
+  uint16_t metadata[ (n) + CC_MAP_METADATA_EXCESS ];                       \
+}                                                                          \
+
 #define cc_list( el_ty )         CC_MAKE_CNTR_TY( el_ty, void *, CC_LIST ) // List key is a pointer-iterator.
 
 #define cc_map( key_ty, el_ty )  CC_MAKE_CNTR_TY(                                                          \
@@ -1160,6 +2229,52 @@ typedef void ( *cc_free_fnptr_ty )( void * );
                                    ) ? 1 : -1 )                                                                     \
                                  )                                                                                  \
 
+#define cc_cmap( key_ty, el_ty ) CC_MAKE_CNTR_TY(                                                          \
+                                   el_ty,                                                                  \
+                                   key_ty,                                                                 \
+                                   CC_CMAP * ( (                                                           \
+                                     /* Compiler error if no atomic operations are available. */           \
+                                     CC_CMAP_HAS_ATOMICS &&                                                \
+                                     /* Compiler error if key type lacks comparison and hash functions. */ \
+                                     CC_HAS_CMPR( key_ty ) && CC_HAS_HASH( key_ty ) &&                     \
+                                     /* Compiler error if bucket layout constraints are violated. */       \
+                                     CC_SATISFIES_LAYOUT_CONSTRAINTS( key_ty, el_ty )                      \
+                                   ) ? 1 : -1 )                                                            \
+                                 )                                                                         \
+
+#define cc_bmap( key_ty, el_ty ) CC_MAKE_CNTR_TY(                                                    \
+                                   el_ty,                                                            \
+                                   key_ty,                                                           \
+                                   CC_BMAP * ( (                                                     \
+                                     /* Compiler error if key type lacks a comparison function. */   \
+                                     CC_HAS_CMPR( key_ty ) &&                                        \
+                                     /* Compiler error if bucket layout constraints are violated. */ \
+                                     CC_SATISFIES_LAYOUT_CONSTRAINTS( key_ty, el_ty )                \
+                                   ) ? 1 : -1 )                                                      \
+                                 )                                                                   \
+
+#define cc_bset( el_ty )         CC_MAKE_CNTR_TY(                                                                   \
+                                   /* As bset simply wraps bmap, we use el_ty as both the element and key types. */ \
+                                   /* This allows minimal changes to bmap function arguments to make bsets work. */ \
+                                   el_ty,                                                                           \
+                                   el_ty,                                                                           \
+                                   CC_BSET * ( (                                                                    \
+                                     /* Compiler error if key type lacks a comparison function. */                  \
+                                     CC_HAS_CMPR( el_ty ) &&                                                        \
+                                     /* Compiler error if bucket layout constraints are violated. */                \
+                                     CC_SATISFIES_LAYOUT_CONSTRAINTS( el_ty, el_ty )                                \
+                                   ) ? 1 : -1 )                                                                     \
+                                 )                                                                                  \
+
+#define cc_ring( el_ty )         CC_MAKE_CNTR_TY(                                                         \
+                                   el_ty,                                                                 \
+                                   size_t, /* Ring key type is size_t. */                                 \
+                                   CC_RING * ( (                                                          \
+                                     /* Compiler error if no atomic operations are available. */          \
+                                     CC_RING_HAS_ATOMICS                                                  \
+                                   ) ? 1 : -1 )                                                           \
+                                 )                                                                        \
+
 // Retrieves a container's id (e.g. CC_VEC) from its handle.
 #define CC_CNTR_ID( cntr ) ( sizeof( *cntr ) / sizeof( **cntr ) )
 
@@ -1204,6 +2319,7 @@ CC_TYPEOF_XP(
       CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long long ):          ( long long ){ 0 },          \
       CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_size_t ):    ( size_t ){ 0 },             \
       CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * ):             ( char * ){ 0 },             \
+      CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str ):             ( cc_str ){ 0 },             \
       CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), void * ):             ( void * ){ 0 },             \
       default: (char){ 0 } /* Nothing. */                                                         \
     )                                                                                             \
@@ -1235,6 +2351,31 @@ CC_TYPEOF_XP(
 //   #3 Key.
 //   #4 Key padding to the larger of el_ty and key_ty alignments.
 //
+// However, if the key type is a fundamental integer type using the default comparison function and the above layout
+// would require padding, a map instead stores its elements and keys in two separate arrays, each holding one entry per
+// bucket:
+//   +------------+------------+-----+------------+
+//   |  #1 (0)    |  #1 (1)    | ... |  #1 (n-1)  |
+//   +------------+------------+-----+------------+
+//   |  #2 (0)    |  #2 (1)    | ... |  #2 (n-1)  |
+//   +------------+------------+-----+------------+
+//   #1 Element.
+//   #2 Key.
+// This layout eliminates the padding and places adjacent buckets' keys, which lookups compare, closer together.
+// Because a map's bucket count is always a power of two of at least CC_MAP_MIN_NONZERO_BUCKET_COUNT, the keys array is
+// always suitably aligned.
+//
+// If hash codes are cached for the key type (see CC_CACHE_HASH in the API documentation), the map bucket (and likewise
+// the set bucket) becomes:
+//   +------------+----+------------+----+------------+
+//   |     #1     | #2 |     #3     | #4 |     #5     |
+//   +------------+----+------------+----+------------+
+//   #1 Element.
+//   #2 Element padding to key_ty alignment.
+//   #3 Key.
+//   #4 Key padding such that the bucket size is a multiple of the largest of el_ty, key_ty, and size_t alignments.
+//   #5 Key's hash code (size_t).
+//
 // The layout for an ordered map bucket is:
 //   +------------+----+------------+
 //   |     #1     | #2 |     #3     |
@@ -1251,16 +2392,20 @@ CC_TYPEOF_XP(
 //
 // The layout data passed into a container function is a uint64_t composed of a uint32_t denoting the key size, a
 // uint16_t denoting the padding after the element, and a uint16_t denoting the padding after the key.
+// For ordered maps and sets, the last uint16_t instead denotes the alignment, minus one, of the element and key, which
+// determines the padding that precedes each node's header (see CC_OMAPNODE_HDR_PADDING).
+// The most significant bit of the key size is borrowed to flag whether a hash code follows the key padding, and the
+// next bit is borrowed to flag whether a map stores its keys separately from its elements.
 // The reason that a uint64_t, rather than a struct, is used is that GCC seems to have trouble properly optimizing the
 // passing of the struct - even if only 8 bytes - into some container functions (e.g. cc_map_insert), apparently because
 // it declines to pass by register.
 
 // Macro for ensuring valid layout on container declaration.
-// Since the key size occupies four bytes and the padding values each occupy two bytes, the key size must be <=
-// UINT32_MAX (about 4.3GB) and the alignment of the element and key must be <= UINT16_MAX + 1 (i.e. 65536).
+// Since the key size occupies 30 bits and the padding values each occupy two bytes, the key size must be
+// <= INT32_MAX / 2 (about 1.07GB) and the alignment of the element and key must be <= UINT16_MAX + 1 (i.e. 65536).
 // It unlikely that these constraints would be violated in practice, but we can check anyway.
-#define CC_SATISFIES_LAYOUT_CONSTRAINTS( key_ty, el_ty )                                                        \
-( sizeof( key_ty ) <= UINT32_MAX && alignof( el_ty ) <= UINT16_MAX + 1 && alignof( key_ty ) <= UINT16_MAX + 1 ) \
+#define CC_SATISFIES_LAYOUT_CONSTRAINTS( key_ty, el_ty )                                                           \
+( sizeof( key_ty ) <= INT32_MAX / 2 && alignof( el_ty ) <= UINT16_MAX + 1 && alignof( key_ty ) <= UINT16_MAX + 1 ) \
 
 // Macros and functions for constructing a map bucket layout.
 
@@ -1273,45 +2418,104 @@ CC_PADDING( el_size, key_align )                \
 #define CC_MAP_KEY_PADDING( el_size, el_align, key_size, key_align )                                      \
 CC_PADDING( el_size + CC_MAP_EL_PADDING( el_size, key_align ) + key_size, CC_MAX( el_align, key_align ) ) \
 
+#define CC_MAP_KEY_PADDING_BEFORE_HASH( el_size, el_align, key_size, key_align )                  \
+CC_PADDING(                                                                                       \
+  el_size + CC_MAP_EL_PADDING( el_size, key_align ) + key_size + sizeof( size_t ),                \
+  CC_MAX( CC_MAX( el_align, key_align ), alignof( size_t ) )                                      \
+)                                                                                                 \
+
 // Struct for conveying key-related information from the _Generic macro into the function below.
 typedef struct
 {
   uint64_t size;
   uint64_t align;
+  bool is_integer; // Whether the key is a fundamental integer type using the default comparison function.
 } cc_key_details_ty;
 
+#define CC_CACHED_HASH_FLAG   0x80000000ULL
+#define CC_SEPARATE_KEYS_FLAG 0x40000000ULL
+
 // Function for creating the uint64_t layout descriptor.
 // This function must be inlined in order for layout calculations to be optimized into a compile-time constant.
 static inline CC_ALWAYS_INLINE uint64_t cc_layout(
   size_t cntr_id,
   uint64_t el_size,
   uint64_t el_align,
-  cc_key_details_ty key_details
+  cc_key_details_ty key_details,
+  bool cache_hash
 )
 {
+  // A concurrent map's shards are maps.
+  if( cntr_id == CC_CMAP )
+    cntr_id = CC_MAP;
+
+  if( cntr_id == CC_MAP && cache_hash )
+    return
+      key_details.size                                                                               |
+      CC_CACHED_HASH_FLAG                                                                            |
+      CC_MAP_EL_PADDING( el_size, key_details.align )                                          << 32 |
+      CC_MAP_KEY_PADDING_BEFORE_HASH( el_size, el_align, key_details.size, key_details.align ) << 48;
+
+  if(
+    cntr_id == CC_MAP &&
+    key_details.is_integer &&
+    CC_MAP_EL_PADDING( el_size, key_details.align ) +
+    CC_MAP_KEY_PADDING( el_size, el_align, key_details.size, key_details.align )
+  )
+    return key_details.size | CC_SEPARATE_KEYS_FLAG;
+
   if( cntr_id == CC_MAP )
     return
       key_details.size                                                                   |
       CC_MAP_EL_PADDING( el_size, key_details.align )                              << 32 |
       CC_MAP_KEY_PADDING( el_size, el_align, key_details.size, key_details.align ) << 48;
 
+  // An ordered map node also needs the alignment of its element and key (see CC_OMAPNODE_HDR_PADDING).
   if( cntr_id == CC_OMAP )
-    return key_details.size | CC_MAP_EL_PADDING( el_size, key_details.align ) << 32;
+    return
+      key_details.size                                      |
+      CC_MAP_EL_PADDING( el_size, key_details.align ) << 32 |
+      ( CC_MAX( el_align, key_details.align ) - 1 )   << 48;
 
-  if( cntr_id == CC_SET || cntr_id == CC_OSET )
+  // A set's element is its key, so it is laid out like a map bucket with a zero-sized element.
+  if( cntr_id == CC_SET && cache_hash )
+    return el_size | CC_CACHED_HASH_FLAG | CC_MAP_KEY_PADDING_BEFORE_HASH( 0, 1, el_size, el_align ) << 48;
+
+  if( cntr_id == CC_SET )
     return el_size;
 
+  if( cntr_id == CC_OSET )
+    return el_size | ( el_align - 1 ) << 48;
+
+  // B-tree maps and sets lay out keys and elements in separate arrays, so they need alignments rather than padding.
+  if( cntr_id == CC_BMAP )
+    return key_details.size | ( key_details.align - 1 ) << 32 | ( el_align - 1 ) << 48;
+
+  if( cntr_id == CC_BSET )
+    return el_size | ( el_align - 1 ) << 32;
+
   return 0; // Other container types don't require layout data.
 }
 
 // Macros for extracting data from a uint64_t layout descriptor.
 
-#define CC_KEY_SIZE( layout ) (uint32_t)( layout )
+#define CC_KEY_SIZE( layout ) (uint32_t)( layout & 0x3FFFFFFF )
+
+#define CC_HAS_CACHED_HASH( layout ) (bool)( layout & CC_CACHED_HASH_FLAG )
+
+#define CC_HAS_SEPARATE_KEYS( layout ) (bool)( layout & CC_SEPARATE_KEYS_FLAG )
 
 #define CC_KEY_OFFSET( el_size, layout ) ( (el_size) + (uint16_t)( layout >> 32 ) )
 
-#define CC_BUCKET_SIZE( el_size, layout )                                                \
-( CC_KEY_OFFSET( el_size, layout ) + (uint32_t)( layout ) + (uint16_t)( layout >> 48 ) ) \
+#define CC_CACHED_HASH_OFFSET( el_size, layout )                                          \
+( CC_KEY_OFFSET( el_size, layout ) + CC_KEY_SIZE( layout ) + (uint16_t)( layout >> 48 ) ) \
+
+// For maps whose keys are stored separately, the bucket size is the combined size of an element and a key.
+#define CC_BUCKET_SIZE( el_size, layout )                                                           \
+( CC_CACHED_HASH_OFFSET( el_size, layout ) + ( CC_HAS_CACHED_HASH( layout ) ? sizeof( size_t ) : 0 ) ) \
+
+// For ordered maps and sets, the last two bytes denote the alignment, minus one, of a node's element and key.
+#define CC_OMAP_NODE_ALIGN( layout ) ( (uint64_t)(uint16_t)( layout >> 48 ) + 1 )
 
 // Return type for all functions that could reallocate a container's memory.
 // It contains a new container handle (the pointer may have changed to due reallocation) and an additional pointer whose
@@ -1476,2102 +2680,10195 @@ static inline int cc_last_nonzero_uint16( uint64_t a )
 #endif
 
 /*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                      Vector                                                        */
+/*                                                     Allocators                                                     */
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-// Vector header.
-typedef struct
-{
-  alignas( cc_max_align_ty )
-  size_t size;
-  size_t cap;
-} cc_vec_hdr_ty;
-
-// Global placeholder for vector with no allocated storage.
-// In the case of vectors, the placeholder allows us to avoid checking for a NULL container handle inside functions.
-static const cc_vec_hdr_ty cc_vec_placeholder = { 0, 0 };
+// A container initialized via cc_init_with_allocator stores a pointer to a user-supplied cc_allocator in its header and
+// routes all its allocations through that allocator, rather than through the realloc and free functions (i.e.
+// CC_REALLOC and CC_FREE or the standard library functions) passed in by the API macros.
+// Containers without such an allocator, including all placeholders, store NULL.
 
-// Easy header access function.
-static inline cc_vec_hdr_ty *cc_vec_hdr( void *cntr )
+typedef struct cc_allocator
 {
-  return (cc_vec_hdr_ty *)cntr;
-}
+  void *( *realloc_fn )( void *ctx, void *ptr, size_t size );
+  void ( *free_fn )( void *ctx, void *ptr ); // NULL if the memory is only ever released in bulk.
+  void *ctx;
+} cc_allocator;
 
-static inline size_t cc_vec_size( void *cntr )
+static inline void *cc_allocator_realloc(
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_,
+  void *ptr,
+  size_t size
+)
 {
-  return cc_vec_hdr( cntr )->size;
-}
+  if( allocator )
+    return allocator->realloc_fn( allocator->ctx, ptr, size );
 
-static inline size_t cc_vec_cap( void *cntr )
-{
-  return cc_vec_hdr( cntr )->cap;
+  return realloc_( ptr, size );
 }
 
-static inline bool cc_vec_is_placeholder( void *cntr )
+static inline void cc_allocator_free(
+  cc_allocator *allocator,
+  cc_free_fnptr_ty free_,
+  void *ptr
+)
 {
-  return cc_vec_hdr( cntr )->cap == 0;
+  if( !allocator )
+    free_( ptr );
+  else if( allocator->free_fn )
+    allocator->free_fn( allocator->ctx, ptr );
 }
 
-// Returns a pointer-iterator to the element at a specified index.
-static inline void *cc_vec_get(
-  void *cntr,
-  void *key, // Pointer to a size_t index.
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr )
-)
+// Returns whether memory obtained from the allocator must be freed piece by piece.
+// If not, then clearing or cleaning up a list or ordered map need not visit every node unless there are destructors to
+// call.
+static inline bool cc_allocator_frees( cc_allocator *allocator )
 {
-  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * *(size_t *)key;
+  return !allocator || allocator->free_fn;
 }
 
-// Ensures that the capacity is large enough to accommodate n elements without reallocation.
-// Returns a cc_allocing_fn_result_ty containing the new handle and a pointer that evaluates to true if the operation
-// was successful.
-static inline cc_allocing_fn_result_ty cc_vec_reserve(
-  void *cntr,
-  size_t n,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( double, max_load ),
-  cc_realloc_fnptr_ty realloc_,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
-)
-{
-  if( cc_vec_cap( cntr ) >= n )
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+// cc_arena is a bump allocator that can back any number of containers.
+// Memory is carved sequentially out of blocks, each of which is twice as large as the last (up to a limit), and
+// individual frees are no-ops.
+// Each allocation is preceded by its capacity so that a reallocation can copy the contents if the allocation cannot be
+// resized in place, which is only possible if it is the most recent allocation.
 
-  bool is_placeholder = cc_vec_is_placeholder( cntr );
+// The size in bytes of an arena's first block.
+#define CC_ARENA_MIN_BLOCK_SIZE 4096
 
-  cc_vec_hdr_ty *new_cntr = (cc_vec_hdr_ty *)realloc_(
-    is_placeholder ? NULL : cntr,
-    sizeof( cc_vec_hdr_ty ) + el_size * n
-  );
+// Blocks stop growing after reaching this size in bytes, although a larger block is allocated for any allocation that
+// would not otherwise fit.
+#define CC_ARENA_MAX_BLOCK_SIZE 1048576
 
-  if( CC_UNLIKELY( !new_cntr ) )
-    return cc_make_allocing_fn_result( cntr, NULL );
+// Block header.
+typedef struct cc_arena_block_hdr_ty
+{
+  alignas( cc_max_align_ty )
+  struct cc_arena_block_hdr_ty *prev; // Blocks are linked from the most to the least recently allocated.
+  size_t size;                        // Bytes available after this header.
+} cc_arena_block_hdr_ty;
 
-  if( is_placeholder )
-    new_cntr->size = 0;
+typedef struct cc_arena
+{
+  cc_allocator allocator;       // Allocator whose context points back to the arena.
+  cc_arena_block_hdr_ty *block; // Block from which allocations are currently carved.
+  size_t block_used;            // Bytes already carved from that block.
+  void *last;                   // Most recent allocation, which can grow in place.
+  cc_realloc_fnptr_ty realloc_; // Functions used to allocate and free the blocks themselves.
+  cc_free_fnptr_ty free_;
+} cc_arena;
+
+static inline size_t cc_arena_alloc_cap( void *ptr )
+{
+  size_t cap;
+  memcpy( &cap, (char *)ptr - sizeof( cc_max_align_ty ), sizeof( size_t ) );
+  return cap;
+}
 
-  new_cntr->cap = n;
-  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+static inline void cc_arena_set_alloc_cap( void *ptr, size_t cap )
+{
+  memcpy( (char *)ptr - sizeof( cc_max_align_ty ), &cap, sizeof( size_t ) );
 }
 
-// Inserts elements at the specified index.
-// Returns a cc_allocing_fn_result_ty containing the new handle and a pointer-iterator to the newly inserted elements.
-// If the underlying storage needed to be expanded and an allocation failure occurred, or if n is zero, the latter
-// pointer will be NULL.
-static inline cc_allocing_fn_result_ty cc_vec_insert_n(
-  void *cntr,
-  size_t index,
-  void *els,
-  size_t n,
-  size_t el_size,
-  cc_realloc_fnptr_ty realloc_
-)
+// The realloc_fn of an arena's allocator.
+// Returns NULL in the case of allocation failure, in which case the original allocation, if any, remains valid.
+static inline void *cc_arena_realloc( void *ctx, void *ptr, size_t size )
 {
-  if( n == 0 )
-    return cc_make_allocing_fn_result( cntr, NULL );
+  cc_arena *arena = (cc_arena *)ctx;
+  size = size + CC_PADDING( size, alignof( cc_max_align_ty ) );
 
-  if( cc_vec_size( cntr ) + n > cc_vec_cap( cntr ) )
+  if( ptr )
   {
-    size_t cap = cc_vec_cap( cntr );
-    if( !cap )
-      cap = 2;
+    if( size <= cc_arena_alloc_cap( ptr ) )
+      return ptr;
 
-    while( cap < cc_vec_size( cntr ) + n )
-      cap *= 2;
+    // Grow the most recent allocation in place if the block has room.
+    if( ptr == arena->last )
+    {
+      size_t offset = (size_t)( (char *)ptr - (char *)arena->block - sizeof( cc_arena_block_hdr_ty ) );
+      if( size <= arena->block->size - offset )
+      {
+        arena->block_used = offset + size;
+        cc_arena_set_alloc_cap( ptr, size );
+        return ptr;
+      }
+    }
+  }
 
-    cc_allocing_fn_result_ty result = cc_vec_reserve(
-      cntr,
-      cap,
-      el_size,
-      0,        // Dummy.
-      NULL,     // Dummy.
-      0.0,      // Dummy.
-      realloc_,
-      NULL      // Dummy.
+  size_t needed = sizeof( cc_max_align_ty ) + size;
+
+  if( !arena->block || needed > arena->block->size - arena->block_used )
+  {
+    size_t block_size = CC_ARENA_MIN_BLOCK_SIZE;
+    if( arena->block )
+    {
+      block_size = arena->block->size;
+      if( block_size < CC_ARENA_MAX_BLOCK_SIZE )
+        block_size *= 2;
+    }
+
+    if( block_size < needed )
+      block_size = needed;
+
+    cc_arena_block_hdr_ty *new_block = (cc_arena_block_hdr_ty *)arena->realloc_(
+      NULL,
+      sizeof( cc_arena_block_hdr_ty ) + block_size
     );
-    if( CC_UNLIKELY( !result.other_ptr ) )
-      return result;
+    if( CC_UNLIKELY( !new_block ) )
+      return NULL;
 
-    cntr = result.new_cntr;
+    new_block->prev = arena->block;
+    new_block->size = block_size;
+    arena->block = new_block;
+    arena->block_used = 0;
   }
 
-  char *new_els = (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
-  memmove( new_els + n * el_size, new_els, el_size * ( cc_vec_hdr( cntr )->size - index ) );
-  memcpy( new_els, els, el_size * n );
-  cc_vec_hdr( cntr )->size += n;
+  void *new_ptr = (char *)arena->block + sizeof( cc_arena_block_hdr_ty ) + arena->block_used +
+    sizeof( cc_max_align_ty );
+  arena->block_used += needed;
+  arena->last = new_ptr;
+  cc_arena_set_alloc_cap( new_ptr, size );
 
-  return cc_make_allocing_fn_result( cntr, new_els );
+  if( ptr )
+    memcpy( new_ptr, ptr, cc_arena_alloc_cap( ptr ) );
+
+  return new_ptr;
 }
 
-static inline cc_allocing_fn_result_ty cc_vec_insert(
-  void *cntr,
-  void *el,
-  void *key, // Pointer to size_t index.
-  CC_UNUSED( bool, replace ),
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
-  CC_UNUSED( double, max_load ),
-  CC_UNUSED( cc_dtor_fnptr_ty, el_dtor ),
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+// Initializes the arena, recording the functions used to allocate and free its blocks.
+// cc_arena_init is the corresponding API macro.
+static inline void cc_arena_init_(
+  cc_arena *arena,
   cc_realloc_fnptr_ty realloc_,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_vec_insert_n( cntr, *(size_t *)key, el, 1, el_size, realloc_ );
+  arena->allocator.realloc_fn = cc_arena_realloc;
+  arena->allocator.free_fn = NULL;
+  arena->allocator.ctx = arena;
+  arena->block = NULL;
+  arena->block_used = 0;
+  arena->last = NULL;
+  arena->realloc_ = realloc_;
+  arena->free_ = free_;
 }
 
-static inline cc_allocing_fn_result_ty cc_vec_push_n(
-  void *cntr,
-  void *els,
-  size_t n,
-  size_t el_size,
-  cc_realloc_fnptr_ty realloc_
-)
+static inline cc_allocator *cc_arena_allocator( cc_arena *arena )
 {
-  return cc_vec_insert_n( cntr, cc_vec_size( cntr ), els, n, el_size, realloc_ );
+  return &arena->allocator;
 }
 
-static inline cc_allocing_fn_result_ty cc_vec_push(
-  void *cntr,
-  void *el,
-  size_t el_size,
-  cc_realloc_fnptr_ty realloc_
-)
+// Frees all blocks except the most recent one, from which allocations then restart.
+static inline void cc_arena_reset( cc_arena *arena )
 {
-  return cc_vec_push_n( cntr, el, 1, el_size, realloc_ );
+  if( !arena->block )
+    return;
+
+  cc_arena_block_hdr_ty *block = arena->block->prev;
+  while( block )
+  {
+    cc_arena_block_hdr_ty *prev = block->prev;
+    arena->free_( block );
+    block = prev;
+  }
+
+  arena->block->prev = NULL;
+  arena->block_used = 0;
+  arena->last = NULL;
 }
 
-// Erases n elements at the specified index.
-// Returns a pointer-iterator to the element after the erased elements, or an end pointer-iterator if there is no
-// subsequent element.
-static inline void *cc_vec_erase_n(
-  void *cntr,
-  size_t index,
-  size_t n,
-  size_t el_size,
-  cc_dtor_fnptr_ty el_dtor
-)
+// Frees all blocks.
+static inline void cc_arena_cleanup( cc_arena *arena )
 {
-  if( n == 0 )
-    return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
+  cc_arena_reset( arena );
 
-  if( el_dtor )
-    for( size_t j = 0; j < n; ++j )
-      el_dtor( (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( index + j ) );
+  if( arena->block )
+    arena->free_( arena->block );
 
-  memmove(
-    (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index,
-    (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( index + n ),
-    ( cc_vec_hdr( cntr )->size - n - index ) * el_size
-  );
+  arena->block = NULL;
+}
 
-  cc_vec_hdr( cntr )->size -= n;
-  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
+// A fixed-capacity buffer, declared via cc_fvec, cc_fmap, or cc_fset, begins with a header containing an allocator
+// that hands out the buffer's inline storage to one allocation at a time and fails every other request, so a container
+// initialized via cc_init_with_fixed_buffer never touches the heap.
+// A vector's growth and a map's or set's rehash therefore fail as though memory allocation had failed.
+typedef struct
+{
+  cc_allocator allocator; // Allocator whose context points back to this header.
+  void *storage;          // Inline storage for the container's header and elements.
+  size_t storage_size;    // Size of that storage in bytes.
+  bool in_use;            // Whether the storage is currently handed out.
+} cc_fixed_buf_hdr_ty;
+
+// The realloc_fn of a fixed-capacity buffer's allocator.
+// An allocation in the storage can be resized within it, but no other allocation can be made or resized.
+static inline void *cc_fixed_buf_realloc( void *ctx, void *ptr, size_t size )
+{
+  cc_fixed_buf_hdr_ty *buf = (cc_fixed_buf_hdr_ty *)ctx;
+
+  if( size > buf->storage_size || ( ptr != buf->storage && ( ptr || buf->in_use ) ) )
+    return NULL;
+
+  buf->in_use = true;
+  return buf->storage;
 }
 
-// Shrinks the vector's capacity to its current size.
-// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
-// operation was successful or false in the case of allocation failure.
-static inline void *cc_vec_erase(
-  void *cntr,
-  void *key, // Pointer to size_t index.
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
-  cc_dtor_fnptr_ty el_dtor,
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
-)
+// The free_fn of a fixed-capacity buffer's allocator.
+static inline void cc_fixed_buf_free( void *ctx, void *ptr )
 {
-  return cc_vec_erase_n( cntr, *(size_t *)key, 1, el_size, el_dtor );
+  cc_fixed_buf_hdr_ty *buf = (cc_fixed_buf_hdr_ty *)ctx;
+
+  if( ptr == buf->storage )
+    buf->in_use = false;
 }
 
-// Sets the number of elements in the vector.
-// If n is below the current size, then the destructor is called for all erased elements.
-// In this case, the vector's capacity is not changed.
-// If n is above the current size, the new elements are uninitialized.
-// Returns a cc_allocing_fn_result_ty containing new container handle and a pointer that evaluates to true if the
-// operation was successful or false in the case of allocation failure.
-static inline cc_allocing_fn_result_ty cc_vec_resize(
-  void *cntr,
-  size_t n,
-  size_t el_size,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_realloc_fnptr_ty realloc_
-)
+static inline void cc_fixed_buf_init( cc_fixed_buf_hdr_ty *buf, void *storage, size_t storage_size )
 {
-  // No resize necessary (also handles placeholder).
-  if( n == cc_vec_size( cntr ) )
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
-
-  // Downsizing.
-  if( n < cc_vec_size( cntr ) )
-  {
-    cc_vec_erase_n( cntr, n, cc_vec_size( cntr ) - n, el_size, el_dtor );
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
-  }
-
-  // Up-sizing.
-  cc_allocing_fn_result_ty result = cc_vec_reserve(
-    cntr,
-    n,
-    el_size,
-    0,        // Dummy.
-    NULL,     // Dummy.
-    0.0,      // Dummy.
-    realloc_,
-    NULL      // Dummy.
-  );
-  if( CC_UNLIKELY( !result.other_ptr ) )
-    return result;
+  buf->allocator.realloc_fn = cc_fixed_buf_realloc;
+  buf->allocator.free_fn = cc_fixed_buf_free;
+  buf->allocator.ctx = buf;
+  buf->storage = storage;
+  buf->storage_size = storage_size;
+  buf->in_use = false;
+}
 
-  cc_vec_hdr( result.new_cntr )->size = n;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                    Parallelism                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  return result;
-}
+#ifdef CC_PARALLEL_REHASH
 
-static inline cc_allocing_fn_result_ty cc_vec_shrink(
-  void *cntr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( double, max_load ),
-  cc_realloc_fnptr_ty realloc_,
-  cc_free_fnptr_ty free_
-)
-{
-  if( cc_vec_size( cntr ) == cc_vec_cap( cntr ) ) // Also handles placeholder.
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+// If CC_PARALLEL_REHASH is defined, rehashing and cloning a large map or set split the work into independent tasks and
+// run them via cc_parallel_for, which calls task( ctx, index ) once for each index in [ 0, task_count ) and returns
+// once all those calls have returned.
+// cc_parallel_for forwards to the user-supplied CC_PARALLEL_FOR if it is defined.
+// Otherwise, the built-in backend deals the tasks out round-robin to up to CC_PARALLEL_THREADS threads, the first of
+// which is the calling thread.
+// If a thread cannot be created, the calling thread runs that thread's share of the tasks itself, so cc_parallel_for
+// never fails.
 
-  if( cc_vec_size( cntr ) == 0 )
-  {
-    // Restore placeholder.
-    free_( cntr );
-    return cc_make_allocing_fn_result( (void *)&cc_vec_placeholder, cc_dummy_true_ptr );
-  }
+typedef void ( *cc_parallel_task_fnptr_ty )( void *, size_t );
 
-  cc_vec_hdr_ty *new_cntr = (cc_vec_hdr_ty *)realloc_( cntr, sizeof( cc_vec_hdr_ty ) + el_size * cc_vec_size( cntr ) );
-  if( CC_UNLIKELY( !new_cntr ) )
-    return cc_make_allocing_fn_result( cntr, NULL );
+#if !defined( CC_PARALLEL_FOR ) && ( defined( CC_PARALLEL_PTHREADS ) || defined( CC_PARALLEL_C11_THREADS ) )
 
-  cc_vec_hdr( new_cntr )->cap = cc_vec_size( new_cntr );
-  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
-}
+// The maximum number of threads that the built-in backend uses.
+#define CC_PARALLEL_MAX_THREADS 64
 
-// Initializes a shallow copy of the source vector.
-// The capacity of the new vector is the size of the source vector, not its capacity.
-// Returns a pointer to the copy, or NULL in the case of allocation failure.
-// The return value is cast to bool in the corresponding macro.
-static inline void *cc_vec_init_clone(
-  void *src,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  cc_realloc_fnptr_ty realloc_,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
-)
+// One thread's share of the tasks, i.e. every stride-th task beginning with first.
+typedef struct
 {
-  if( cc_vec_size( src ) == 0 )
-    return (void *)&cc_vec_placeholder;
-
-  cc_allocing_fn_result_ty result = cc_vec_resize(
-    (void *)&cc_vec_placeholder,
-    cc_vec_size( src ),
-    el_size,
-    NULL, // Destructor unused.
-    realloc_
-  );
+  cc_parallel_task_fnptr_ty task;
+  void *ctx;
+  size_t task_count;
+  size_t first;
+  size_t stride;
+} cc_parallel_share_ty;
+
+static inline void cc_parallel_run_share( cc_parallel_share_ty *share )
+{
+  for( size_t i = share->first; i < share->task_count; i += share->stride )
+    share->task( share->ctx, i );
+}
 
-  if( CC_UNLIKELY( !result.other_ptr ) )
-    return NULL;
+#ifdef CC_PARALLEL_PTHREADS
 
-  memcpy(
-    (char *)result.new_cntr + sizeof( cc_vec_hdr_ty ),
-    (char *)src + sizeof( cc_vec_hdr_ty ),
-    el_size * cc_vec_size( src )
-  );
+typedef pthread_t cc_parallel_thread_ty;
 
-  return result.new_cntr;
+static inline void *cc_parallel_thread_entry( void *share )
+{
+  cc_parallel_run_share( (cc_parallel_share_ty *)share );
+  return NULL;
 }
 
-// Erases all elements, calling their destructors if necessary.
-static inline void cc_vec_clear(
-  void *cntr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  cc_dtor_fnptr_ty el_dtor,
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
-)
+static inline bool cc_parallel_thread_create( cc_parallel_thread_ty *thread, cc_parallel_share_ty *share )
 {
-  cc_vec_erase_n( cntr, 0, cc_vec_size( cntr ), el_size, el_dtor );
+  return pthread_create( thread, NULL, cc_parallel_thread_entry, share ) == 0;
 }
 
-// Clears the vector and frees its memory if it is not a placeholder.
-static inline void cc_vec_cleanup(
-  void *cntr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
-  cc_dtor_fnptr_ty el_dtor,
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  cc_free_fnptr_ty free_
-)
+static inline void cc_parallel_thread_join( cc_parallel_thread_ty thread )
 {
-  cc_vec_clear(
-    cntr,
-    el_size,
-    0,       // Dummy.
-    el_dtor,
-    NULL,    // Dummy.
-    NULL     // Dummy.
-  );
-
-  if( !cc_vec_is_placeholder( cntr ) )
-    free_( cntr );
+  pthread_join( thread, NULL );
 }
 
-static inline void *cc_vec_end(
-  void *cntr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout )
-)
+static inline size_t cc_parallel_default_thread_count( void )
 {
-  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * cc_vec_size( cntr );
+  long count = sysconf( _SC_NPROCESSORS_ONLN );
+  return count > 0 ? (size_t)count : 1;
 }
 
-static inline void *cc_vec_next(
-  CC_UNUSED( void *, cntr ),
-  void *itr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout )
-)
+#else
+
+typedef thrd_t cc_parallel_thread_ty;
+
+static inline int cc_parallel_thread_entry( void *share )
 {
-  return (char *)itr + el_size;
+  cc_parallel_run_share( (cc_parallel_share_ty *)share );
+  return 0;
 }
 
-static inline void *cc_vec_first(
-  void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
-)
+static inline bool cc_parallel_thread_create( cc_parallel_thread_ty *thread, cc_parallel_share_ty *share )
 {
-  return (char *)cntr + sizeof( cc_vec_hdr_ty );
+  return thrd_create( thread, cc_parallel_thread_entry, share ) == thrd_success;
 }
 
-static inline void *cc_vec_last(
-  void *cntr,
-  size_t el_size,
-  CC_UNUSED( uint64_t, layout )
-)
+static inline void cc_parallel_thread_join( cc_parallel_thread_ty thread )
 {
-  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( cc_vec_size( cntr ) - 1 );
+  thrd_join( thread, NULL );
 }
 
-/*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                        List                                                        */
-/*--------------------------------------------------------------------------------------------------------------------*/
+static inline size_t cc_parallel_default_thread_count( void )
+{
+  return 4;
+}
 
-// List is implemented as a doubly linked list with sentinel nodes.
+#endif
 
-// Node header.
-typedef struct cc_listnode_hdr_ty
+static inline void cc_parallel_for( cc_parallel_task_fnptr_ty task, void *ctx, size_t task_count )
 {
-  alignas( cc_max_align_ty )
-  struct cc_listnode_hdr_ty *prev;
-  struct cc_listnode_hdr_ty *next;
-} cc_listnode_hdr_ty;
+#ifdef CC_PARALLEL_THREADS
+  size_t thread_count = CC_PARALLEL_THREADS;
+#else
+  size_t thread_count = cc_parallel_default_thread_count();
+#endif
+  if( thread_count > task_count )
+    thread_count = task_count;
+  if( thread_count > CC_PARALLEL_MAX_THREADS )
+    thread_count = CC_PARALLEL_MAX_THREADS;
 
-// List header.
-// It does not need to be aligned to alignof( cc_max_align_ty ) because no memory is allocated after the header.
-typedef struct
-{
-  size_t size;
-  cc_listnode_hdr_ty r_end;
-  cc_listnode_hdr_ty end;
-} cc_list_hdr_ty;
+  cc_parallel_share_ty shares[ CC_PARALLEL_MAX_THREADS ];
+  cc_parallel_thread_ty threads[ CC_PARALLEL_MAX_THREADS ];
+  bool created[ CC_PARALLEL_MAX_THREADS ];
 
-// Placeholder for a list with no allocated header.
-// The main purpose this serves is to provide every list with stable r_end and end pointer-iterators across translation
-// units and irrespective of whether any memory has been allocated for its header.
-// Every list initially (after cc_init) points to this placeholder, which differs across translation units, and is then
-// associated with that placeholder until cc_cleanup is called.
-// Calls to cc_r_end and cc_end on a list return pointers to the associated placeholder's r_end and end nodes even after
-// a header has been dynamically allocated for it.
-// The way this works is that the placeholder's r_end.prev pointer points to the placeholder's r_end (i.e. a circular
-// link), and ditto for end.next.
-// Meanwhile, a list with an allocated header has it's r_end.prev pointer point to the placeholder's r_end, and ditto
-// for it's end.next pointer.
-// Therefore cc_list_hdr( cntr )->r_end.prev always produces the associated placeholder's r_end, and ditto for
-// cc_list_hdr( cntr )->end.next.
-// Unfortunately, this means that r_end and end must be handled as special cases during inserts, splices, and iteration.
-static const cc_list_hdr_ty cc_list_placeholder = {
-  0,
-  {
-    (cc_listnode_hdr_ty *)&cc_list_placeholder.r_end, // Circular link.
-    (cc_listnode_hdr_ty *)&cc_list_placeholder.end
-  },
+  for( size_t i = 0; i < thread_count; ++i )
   {
-    (cc_listnode_hdr_ty *)&cc_list_placeholder.r_end,
-    (cc_listnode_hdr_ty *)&cc_list_placeholder.end    // Circular link.
+    cc_parallel_share_ty share = { task, ctx, task_count, i, thread_count };
+    shares[ i ] = share;
+    created[ i ] = i != 0 && cc_parallel_thread_create( &threads[ i ], &shares[ i ] );
   }
-};
 
-// Easy access to the list header.
-static inline cc_list_hdr_ty *cc_list_hdr( void *cntr )
-{
-  return (cc_list_hdr_ty *)cntr;
+  for( size_t i = 0; i < thread_count; ++i )
+    if( !created[ i ] )
+      cc_parallel_run_share( &shares[ i ] );
+
+  for( size_t i = 1; i < thread_count; ++i )
+    if( created[ i ] )
+      cc_parallel_thread_join( threads[ i ] );
 }
 
-// Easy access to a list node header from a pointer-iterator.
-static inline cc_listnode_hdr_ty *cc_listnode_hdr( void *itr )
+#else
+
+static inline void cc_parallel_for( cc_parallel_task_fnptr_ty task, void *ctx, size_t task_count )
 {
-  return (cc_listnode_hdr_ty *)( (char *)itr - sizeof( cc_listnode_hdr_ty ) );
+#ifdef CC_PARALLEL_FOR
+  CC_PARALLEL_FOR( task, ctx, task_count );
+#else
+  for( size_t i = 0; i < task_count; ++i )
+    task( ctx, i );
+#endif
 }
 
-// Easy access to a pointer-iterator from a pointer to a list node header.
-static inline void *cc_list_el( void *hdr )
+#endif
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                     Snapshots                                                      */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A snapshot is a relocatable image of a vector, map, or set that can be loaded without reinserting the elements (see
+// "Snapshots" in the API documentation for the format).
+// It consists of a snapshot header followed by a record for each of the container's tables - i.e. its allocations,
+// excluding their headers.
+// A vector or map has one table, or zero if it is a placeholder, and a map that is in the process of migrating its
+// key-element pairs to a larger table (see CC_INCREMENTAL_REHASH) has two.
+// Each record begins with a reserved slot that is zeroed in the snapshot and that a view of the snapshot overwrites
+// with the container header of the in-memory container, since that header must immediately precede the table.
+
+#define CC_SNAPSHOT_VERSION         3
+#define CC_SNAPSHOT_BYTE_ORDER_MARK 0x01020304
+#define CC_SNAPSHOT_SLOT_SIZE       128 // Must be a multiple of alignof( cc_max_align_ty ) and at least the size of
+                                        // every container header under any combination of options (checked below).
+#define CC_SNAPSHOT_MAX_TABLES      2
+
+// Flags recorded in a snapshot header for the options that change how a map's or set's tables are interpreted.
+// A snapshot only loads if its flags match those of the loading program.
+#define CC_SNAPSHOT_FLAT_SMALL_MAPS    0x1
+#define CC_SNAPSHOT_INCREMENTAL_REHASH 0x2
+
+#ifdef CC_FLAT_SMALL_MAPS
+#define CC_SNAPSHOT_FLAT_SMALL_MAPS_OPTION CC_SNAPSHOT_FLAT_SMALL_MAPS
+#else
+#define CC_SNAPSHOT_FLAT_SMALL_MAPS_OPTION 0
+#endif
+
+#ifdef CC_INCREMENTAL_REHASH
+#define CC_SNAPSHOT_INCREMENTAL_REHASH_OPTION CC_SNAPSHOT_INCREMENTAL_REHASH
+#else
+#define CC_SNAPSHOT_INCREMENTAL_REHASH_OPTION 0
+#endif
+
+#define CC_SNAPSHOT_MAP_OPTIONS ( CC_SNAPSHOT_FLAT_SMALL_MAPS_OPTION | CC_SNAPSHOT_INCREMENTAL_REHASH_OPTION )
+
+typedef struct
 {
-  return (char *)hdr + sizeof( cc_listnode_hdr_ty );
+  alignas( cc_max_align_ty )
+  char magic[ 6 ];          // "CCSNAP".
+  uint16_t version;         // CC_SNAPSHOT_VERSION.
+  uint32_t byte_order_mark; // CC_SNAPSHOT_BYTE_ORDER_MARK.
+  uint16_t size_t_size;     // sizeof( size_t ).
+  uint16_t cntr_id;
+  uint64_t el_size;         // Zero for sets.
+  uint64_t layout;          // As passed into map and set functions, or zero for vectors.
+  uint64_t options;         // CC_SNAPSHOT_MAP_OPTIONS for maps and sets, or zero for vectors.
+  uint64_t table_count;
+  uint64_t sizes[ CC_SNAPSHOT_MAX_TABLES ]; // Number of elements in each table.
+  uint64_t caps[ CC_SNAPSHOT_MAX_TABLES ];  // Capacity of each table (the number of elements for vectors).
+  uint64_t migration_bucket;                // For a map with two tables, see cc_map_hdr_ty below.
+} cc_snapshot_hdr_ty;
+
+// Returns the size of a snapshot record whose table occupies table_size bytes.
+static inline size_t cc_snapshot_record_size( size_t table_size )
+{
+  return CC_SNAPSHOT_SLOT_SIZE + table_size + CC_PADDING( table_size, alignof( cc_max_align_ty ) );
 }
 
-static inline bool cc_list_is_placeholder( void *cntr )
+// Fills in a snapshot header for a container with no tables.
+static inline void cc_snapshot_init_hdr(
+  cc_snapshot_hdr_ty *hdr,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout,
+  uint64_t options
+)
 {
-  return cc_list_hdr( cntr )->r_end.prev == &cc_list_hdr( cntr )->r_end;
+  memset( hdr, 0, sizeof( cc_snapshot_hdr_ty ) );
+  memcpy( hdr->magic, "CCSNAP", sizeof( hdr->magic ) );
+  hdr->version = CC_SNAPSHOT_VERSION;
+  hdr->byte_order_mark = CC_SNAPSHOT_BYTE_ORDER_MARK;
+  hdr->size_t_size = sizeof( size_t );
+  hdr->cntr_id = (uint16_t)cntr_id;
+  hdr->el_size = el_size;
+  hdr->layout = layout;
+  hdr->options = options;
 }
 
-static inline size_t cc_list_size( void *cntr )
+// Copies the header of the snapshot in buf, of buf_size bytes, into hdr and checks that it describes a container of the
+// specified type.
+// Returns false if the snapshot is truncated or was written from a container of a different type, on a platform with a
+// different byte order or size_t width, or by a program with different options.
+static inline bool cc_snapshot_read_hdr(
+  cc_snapshot_hdr_ty *hdr,
+  const void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout,
+  uint64_t options
+)
 {
-  return cc_list_hdr( cntr )->size;
+  if( buf_size < sizeof( cc_snapshot_hdr_ty ) )
+    return false;
+
+  memcpy( hdr, buf, sizeof( cc_snapshot_hdr_ty ) );
+
+  return
+    memcmp( hdr->magic, "CCSNAP", sizeof( hdr->magic ) ) == 0 &&
+    hdr->version == CC_SNAPSHOT_VERSION &&
+    hdr->byte_order_mark == CC_SNAPSHOT_BYTE_ORDER_MARK &&
+    hdr->size_t_size == sizeof( size_t ) &&
+    hdr->cntr_id == cntr_id &&
+    hdr->el_size == el_size &&
+    hdr->layout == layout &&
+    hdr->options == options &&
+    hdr->table_count <= CC_SNAPSHOT_MAX_TABLES;
 }
 
-static inline void *cc_list_r_end( void *cntr )
+// Writes a snapshot record containing the table_size bytes at table to record.
+// Returns a pointer to the end of the record.
+static inline char *cc_snapshot_write_record( char *record, const void *table, size_t table_size )
 {
-  return cc_list_el( cc_list_hdr( cntr )->r_end.prev );
+  memset( record, 0, CC_SNAPSHOT_SLOT_SIZE );
+  memcpy( record + CC_SNAPSHOT_SLOT_SIZE, table, table_size );
+  memset(
+    record + CC_SNAPSHOT_SLOT_SIZE + table_size,
+    0,
+    CC_PADDING( table_size, alignof( cc_max_align_ty ) )
+  );
+
+  return record + cc_snapshot_record_size( table_size );
 }
 
-static inline void *cc_list_end(
-  void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+// realloc_fn of the allocator associated with views of snapshots.
+// As a view does not own its memory, it can never allocate more.
+static inline void *cc_snapshot_view_realloc(
+  CC_UNUSED( void *, ctx ),
+  CC_UNUSED( void *, ptr ),
+  CC_UNUSED( size_t, size )
 )
 {
-  return cc_list_el( cc_list_hdr( cntr )->end.next );
+  return NULL;
 }
 
-static inline void *cc_list_prev(
-  void *cntr,
-  void *itr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
-)
-{
-  cc_listnode_hdr_ty *prev;
+// The allocator associated with views of snapshots.
+// Its NULL free_fn makes cleanup a no-op for views.
+static const cc_allocator cc_snapshot_view_allocator = { cc_snapshot_view_realloc, NULL, NULL };
 
-  // If itr is an end iterator, then we need to escape the placeholder originally associated with the list by retrieving
-  // the previous node from the allocated header, if a header has been allocated.
-  if( itr == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
-    prev = cc_list_hdr( cntr )->end.prev;
-  else
-    prev = cc_listnode_hdr( itr )->prev;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                     Statistics                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-  // If prev is r_end, then we need to decrement the pointer-iterator once more to ensure that the returned
-  // pointer-iterator is the r_end of the placeholder originally associated with the list.
-  if( prev == &cc_list_hdr( cntr )->r_end )
-    prev = prev->prev;
+// If CC_STATS is defined, vectors and maps count certain events in their headers, and get_stats reports these counts
+// together with structural statistics that it computes by traversing the container.
+// Otherwise, none of this code or header data exists.
 
-  return cc_list_el( prev );
-}
+#ifdef CC_STATS
 
-static inline void *cc_list_next(
-  void *cntr,
-  void *itr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
-)
+#define CC_STATS_CHAIN_LENGTHS 16
+
+typedef struct
 {
-  cc_listnode_hdr_ty *next;
+  size_t size;
+  size_t cap;                                   // Vectors, maps, and sets.
+  size_t reallocs;                              // Vectors.
+  size_t chain_counts[ CC_STATS_CHAIN_LENGTHS ]; // Maps and sets: chain_counts[ i ] is the number of chains of length
+                                                // i + 1, and the last element also counts all longer chains.
+  size_t max_chain_length;                      // Maps and sets.
+  size_t max_displacement;                      // Maps and sets: compare with displacement_limit.
+  size_t displacement_limit;                    // Maps and sets.
+  double avg_probes_hit;                        // Maps and sets: buckets probed per successful lookup.
+  double avg_probes_miss;                       // Maps and sets: buckets probed per unsuccessful lookup.
+  size_t evictions;                             // Maps and sets.
+  size_t rehashes;                              // Maps and sets.
+  size_t rehash_retries;                        // Maps and sets.
+  size_t migrations;                            // Maps and sets.
+  size_t height;                                // Ordered maps and sets.
+} cc_stats;
 
-  // See the comment in cc_list_prev above.
-  if( itr == cc_list_r_end( cntr ) )
-    next = cc_list_hdr( cntr )->r_end.next;
-  else
-    next = cc_listnode_hdr( itr )->next;
+#endif
 
-  // Again, see the comment in cc_list_prev above.
-  if( next == &cc_list_hdr( cntr )->end )
-    next = next->next;
+// Unlike the statistics, memory usage is always available.
+// payload counts the bytes of the elements and keys themselves, and overhead counts every other allocated byte, e.g.
+// headers, unused buckets or capacity, metadata, node headers, free nodes, and alignment padding.
+typedef struct
+{
+  size_t allocated;
+  size_t payload;
+  size_t overhead;
+} cc_mem_usage;
 
-  return cc_list_el( next );
+static inline cc_mem_usage cc_make_mem_usage( size_t allocated, size_t payload )
+{
+  cc_mem_usage usage = { allocated, payload, allocated - payload };
+  return usage;
 }
 
-static inline void *cc_list_first(
-  void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
-)
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                      Vector                                                        */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// Vector header.
+typedef struct
 {
-  return cc_list_next(
-    cntr,
-    cc_list_el( &cc_list_hdr( cntr )->r_end ),
-    0, // Dummy.
-    0  // Dummy.
-  );
-}
+  alignas( cc_max_align_ty )
+  size_t size;
+  size_t cap;
+  cc_allocator *allocator;
+#ifdef CC_STATS
+  size_t reallocs;
+#endif
+} cc_vec_hdr_ty;
 
-static inline void *cc_list_last(
-  void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
-)
+// The header must fit in the reserved slot of a snapshot record (see CC_SNAPSHOT_SLOT_SIZE).
+typedef char cc_vec_hdr_fits_snapshot_slot[ sizeof( cc_vec_hdr_ty ) <= CC_SNAPSHOT_SLOT_SIZE ? 1 : -1 ];
+
+// Global placeholder for vector with no allocated storage.
+// In the case of vectors, the placeholder allows us to avoid checking for a NULL container handle inside functions.
+static const cc_vec_hdr_ty cc_vec_placeholder = {
+  0,
+  0,
+  NULL
+#ifdef CC_STATS
+  ,
+  0
+#endif
+};
+
+// Easy header access function.
+static inline cc_vec_hdr_ty *cc_vec_hdr( void *cntr )
 {
-  return cc_list_prev(
-    cntr,
-    cc_list_el( &cc_list_hdr( cntr )->end ),
-    0, // Dummy.
-    0  // Dummy.
-  );
+  return (cc_vec_hdr_ty *)cntr;
 }
 
-// Allocates a header for a list that is currently a placeholder.
-// Returns the new container handle, or NULL in the case of allocation failure.
-static inline void *cc_list_alloc_hdr(
-  void *cntr,
-  cc_realloc_fnptr_ty realloc_
-)
+static inline size_t cc_vec_size( void *cntr )
 {
-  cc_list_hdr_ty *new_cntr = (cc_list_hdr_ty *)realloc_( NULL, sizeof( cc_list_hdr_ty ) );
-  if( CC_UNLIKELY( !new_cntr ) )
-    return NULL;
-
-  new_cntr->r_end.next = &new_cntr->end;
-  new_cntr->end.prev = &new_cntr->r_end;
+  return cc_vec_hdr( cntr )->size;
+}
 
-  // Link the new header's r_end and end with the original placeholder's r_end and end.
-  new_cntr->r_end.prev = &cc_list_hdr( cntr )->r_end;
-  new_cntr->end.next = &cc_list_hdr( cntr )->end;
+static inline size_t cc_vec_cap( void *cntr )
+{
+  return cc_vec_hdr( cntr )->cap;
+}
 
-  new_cntr->size = 0; 
-  return new_cntr;
+// A vector with an allocator always has an allocated header, even if its capacity is zero.
+static inline bool cc_vec_is_placeholder( void *cntr )
+{
+  return cc_vec_hdr( cntr )->cap == 0 && !cc_vec_hdr( cntr )->allocator;
 }
 
-// Attaches a node to the list before the node pointed to by the specified pointer-iterator.
-static inline void cc_list_attach(
+// Returns a pointer-iterator to the element at a specified index.
+static inline void *cc_vec_get(
   void *cntr,
-  void *itr,
-  cc_listnode_hdr_ty *node
+  void *key, // Pointer to a size_t index.
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr )
 )
 {
-  // Handle r_end and end pointer-iterators as a special case.
-  // We need to convert the pointer-iterator from the global placeholder's r_end or end to the local r_end or end.
-  if( itr == cc_list_r_end( cntr ) )
-    itr = cc_list_el( &cc_list_hdr( cntr )->r_end );
-  else if( itr == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
-    itr = cc_list_el( &cc_list_hdr( cntr )->end );
-
-  // Link node.
-  node->next = cc_listnode_hdr( itr );
-  node->prev = node->next->prev;
-  node->next->prev = node;
-  node->prev->next = node;
+  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * *(size_t *)key;
 }
 
-// Inserts an element into the list before the node pointed to by a given pointer-iterator.
-// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer-iterator to the newly inserted
-// element (or NULL in the case of allocation failure).
-static inline cc_allocing_fn_result_ty cc_list_insert(
+// Ensures that the capacity is large enough to accommodate n elements without reallocation.
+// Returns a cc_allocing_fn_result_ty containing the new handle and a pointer that evaluates to true if the operation
+// was successful.
+static inline cc_allocing_fn_result_ty cc_vec_reserve(
   void *cntr,
-  void *el,
-  void *key, // Pointer to void pointer-iterator.
-  CC_UNUSED( bool, replace ),
+  size_t n,
   size_t el_size,
   CC_UNUSED( uint64_t, layout ),
   CC_UNUSED( cc_hash_fnptr_ty, hash ),
-  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
   CC_UNUSED( double, max_load ),
-  CC_UNUSED( cc_dtor_fnptr_ty, el_dtor ),
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
   cc_realloc_fnptr_ty realloc_,
   CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  if( cc_list_is_placeholder( cntr ) )
-  {
-    void *new_cntr = cc_list_alloc_hdr( cntr, realloc_ );
-    if( CC_UNLIKELY( !new_cntr ) )
-      return cc_make_allocing_fn_result( cntr, NULL );
+  if( cc_vec_cap( cntr ) >= n )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
 
-    cntr = new_cntr;
-  }
+  bool is_placeholder = cc_vec_is_placeholder( cntr );
 
-  cc_listnode_hdr_ty *new_node = (cc_listnode_hdr_ty *)realloc_( NULL, sizeof( cc_listnode_hdr_ty ) + el_size );
-  if( CC_UNLIKELY( !new_node ) )
+  cc_vec_hdr_ty *new_cntr = (cc_vec_hdr_ty *)cc_allocator_realloc(
+    cc_vec_hdr( cntr )->allocator,
+    realloc_,
+    is_placeholder ? NULL : cntr,
+    sizeof( cc_vec_hdr_ty ) + el_size * n
+  );
+
+  if( CC_UNLIKELY( !new_cntr ) )
     return cc_make_allocing_fn_result( cntr, NULL );
 
-  memcpy( cc_list_el( new_node ), el, el_size );
+  if( is_placeholder )
+  {
+    new_cntr->size = 0;
+    new_cntr->allocator = NULL;
+#ifdef CC_STATS
+    new_cntr->reallocs = 0;
+#endif
+  }
 
-  // Handle r_end and end pointer-iterators as a special case.
-  // We need to convert the pointer-iterator from the associated placeholder's r_end or end to the local r_end or end.
-  if( *(void **)key == cc_list_r_end( cntr ) )
-    *(void **)key = cc_list_el( &cc_list_hdr( cntr )->r_end );
-  else if( *(void **)key == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
-    *(void **)key = cc_list_el( &cc_list_hdr( cntr )->end );
+#ifdef CC_STATS
+  ++new_cntr->reallocs;
+#endif
 
-  cc_list_attach( cntr, *(void **)key, new_node );
+  new_cntr->cap = n;
+  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+}
 
-  ++cc_list_hdr( cntr )->size;
+#ifndef CC_VEC_PAGE_SIZE
+#define CC_VEC_PAGE_SIZE 4096
+#endif
 
-  return cc_make_allocing_fn_result( cntr, cc_list_el( new_node ) );  
+#ifndef CC_VEC_HUGE_PAGE_SIZE
+#define CC_VEC_HUGE_PAGE_SIZE 2097152
+#endif
+
+// Bookkeeping that allocators place before each large allocation in the same pages (two size_t in glibc's case).
+// Rounding is applied to the allocation size plus this overhead so that the overhead does not spill onto a new page.
+#define CC_VEC_ALLOC_OVERHEAD ( 2 * sizeof( size_t ) )
+
+// Returns the capacity that a vector with the specified capacity should grow to in order to accommodate n elements.
+// The capacity grows from two by the growth factor.
+// Then, if the allocation would span at least 32 pages, its size is rounded up to whole pages (or, if it would span at
+// least eight huge pages, to whole huge pages), and the capacity is expanded to fill it.
+// Large allocations are typically mapped via mmap, so the rest of the last page would be wasted anyway, and mremap can
+// then grow them without copying.
+static inline size_t cc_vec_grown_cap( size_t cap, size_t n, size_t el_size, double growth )
+{
+  if( !cap )
+    cap = 2;
+
+  while( cap < n )
+  {
+    size_t new_cap = (size_t)( cap * growth );
+    cap = new_cap > cap ? new_cap : cap + 1; // Guarantees progress if growth is too small to increase cap.
+  }
+
+  size_t alloc_size = CC_VEC_ALLOC_OVERHEAD + sizeof( cc_vec_hdr_ty ) + el_size * cap;
+
+  size_t granularity;
+  if( alloc_size >= (size_t)CC_VEC_HUGE_PAGE_SIZE * 8 )
+    granularity = CC_VEC_HUGE_PAGE_SIZE;
+  else if( alloc_size >= (size_t)CC_VEC_PAGE_SIZE * 32 )
+    granularity = CC_VEC_PAGE_SIZE;
+  else
+    return cap;
+
+  alloc_size = ( alloc_size + granularity - 1 ) / granularity * granularity;
+  return ( alloc_size - CC_VEC_ALLOC_OVERHEAD - sizeof( cc_vec_hdr_ty ) ) / el_size;
 }
 
-static inline cc_allocing_fn_result_ty cc_list_push(
+// Inserts elements at the specified index, growing the capacity by growth if necessary.
+// Returns a cc_allocing_fn_result_ty containing the new handle and a pointer-iterator to the newly inserted elements.
+// If the underlying storage needed to be expanded and an allocation failure occurred, or if n is zero, the latter
+// pointer will be NULL.
+static inline cc_allocing_fn_result_ty cc_vec_insert_n(
   void *cntr,
-  void *el,
+  size_t index,
+  void *els,
+  size_t n,
   size_t el_size,
+  double growth,
   cc_realloc_fnptr_ty realloc_
 )
 {
-  return cc_list_insert(
-    cntr,
-    el,
-    &CC_MAKE_LVAL_COPY( void *, cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) ),
-    false,    // Dummy.
-    el_size,
-    0,        // Dummy.
-    NULL,     // Dummy.
-    NULL,     // Dummy.
-    0.0,      // Dummy.
-    NULL,     // Dummy.
-    NULL,     // Dummy.
-    realloc_,
-    NULL      // Dummy.
-  );
+  if( n == 0 )
+    return cc_make_allocing_fn_result( cntr, NULL );
+
+  if( cc_vec_size( cntr ) + n > cc_vec_cap( cntr ) )
+  {
+    cc_allocing_fn_result_ty result = cc_vec_reserve(
+      cntr,
+      cc_vec_grown_cap( cc_vec_cap( cntr ), cc_vec_size( cntr ) + n, el_size, growth ),
+      el_size,
+      0,        // Dummy.
+      NULL,     // Dummy.
+      0.0,      // Dummy.
+      realloc_,
+      NULL      // Dummy.
+    );
+    if( CC_UNLIKELY( !result.other_ptr ) )
+      return result;
+
+    cntr = result.new_cntr;
+  }
+
+  char *new_els = (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
+  memmove( new_els + n * el_size, new_els, el_size * ( cc_vec_hdr( cntr )->size - index ) );
+  memcpy( new_els, els, el_size * n );
+  cc_vec_hdr( cntr )->size += n;
+
+  return cc_make_allocing_fn_result( cntr, new_els );
 }
 
-// Erases the element pointed to by a given pointer-iterator and returns a pointer-iterator to next element (or end if
-// the element was the last element in the list).
-static inline void *cc_list_erase(
+static inline cc_allocing_fn_result_ty cc_vec_insert(
   void *cntr,
-  void *key, // Pointer to void pointer-iterator.
-  CC_UNUSED( size_t, el_size ),
+  void *el,
+  void *key, // Pointer to size_t index.
+  CC_UNUSED( bool, replace ),
+  size_t el_size,
   CC_UNUSED( uint64_t, layout ),
   CC_UNUSED( cc_hash_fnptr_ty, hash ),
   CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
-  cc_dtor_fnptr_ty el_dtor,
+  double growth, // For vectors, the API macro passes the growth factor in place of the max load factor.
+  CC_UNUSED( cc_dtor_fnptr_ty, el_dtor ),
   CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  cc_free_fnptr_ty free_
+  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  cc_listnode_hdr_ty *hdr = cc_listnode_hdr( *(void **)key );
-  cc_listnode_hdr_ty *next = hdr->next;
-  hdr->prev->next = next;
-  next->prev = hdr->prev;
-  
+  return cc_vec_insert_n( cntr, *(size_t *)key, el, 1, el_size, growth, realloc_ );
+}
+
+static inline cc_allocing_fn_result_ty cc_vec_push_n(
+  void *cntr,
+  void *els,
+  size_t n,
+  size_t el_size,
+  double growth,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  return cc_vec_insert_n( cntr, cc_vec_size( cntr ), els, n, el_size, growth, realloc_ );
+}
+
+static inline cc_allocing_fn_result_ty cc_vec_push(
+  void *cntr,
+  void *el,
+  size_t el_size,
+  double growth,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  return cc_vec_push_n( cntr, el, 1, el_size, growth, realloc_ );
+}
+
+// Erases n elements at the specified index.
+// Returns a pointer-iterator to the element after the erased elements, or an end pointer-iterator if there is no
+// subsequent element.
+static inline void *cc_vec_erase_n(
+  void *cntr,
+  size_t index,
+  size_t n,
+  size_t el_size,
+  cc_dtor_fnptr_ty el_dtor
+)
+{
+  if( n == 0 )
+    return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
+
   if( el_dtor )
-    el_dtor( *(void **)key );
+    for( size_t j = 0; j < n; ++j )
+      el_dtor( (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( index + j ) );
 
-  free_( hdr );
-  --cc_list_hdr( cntr )->size;
+  memmove(
+    (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index,
+    (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( index + n ),
+    ( cc_vec_hdr( cntr )->size - n - index ) * el_size
+  );
 
-  // If next is end, we need to make sure we're returning the associated placeholder's end.
-  if( next == &cc_list_hdr( cntr )->end )
-    next = next->next;
+  cc_vec_hdr( cntr )->size -= n;
+  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * index;
+}
+
+// Shrinks the vector's capacity to its current size.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline void *cc_vec_erase(
+  void *cntr,
+  void *key, // Pointer to size_t index.
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_vec_erase_n( cntr, *(size_t *)key, 1, el_size, el_dtor );
+}
+
+// Sets the number of elements in the vector.
+// If n is below the current size, then the destructor is called for all erased elements.
+// In this case, the vector's capacity is not changed.
+// If n is above the current size, the new elements are uninitialized.
+// Returns a cc_allocing_fn_result_ty containing new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline cc_allocing_fn_result_ty cc_vec_resize(
+  void *cntr,
+  size_t n,
+  size_t el_size,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  // No resize necessary (also handles placeholder).
+  if( n == cc_vec_size( cntr ) )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+
+  // Downsizing.
+  if( n < cc_vec_size( cntr ) )
+  {
+    cc_vec_erase_n( cntr, n, cc_vec_size( cntr ) - n, el_size, el_dtor );
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+  }
+
+  // Up-sizing.
+  cc_allocing_fn_result_ty result = cc_vec_reserve(
+    cntr,
+    n,
+    el_size,
+    0,        // Dummy.
+    NULL,     // Dummy.
+    0.0,      // Dummy.
+    realloc_,
+    NULL      // Dummy.
+  );
+  if( CC_UNLIKELY( !result.other_ptr ) )
+    return result;
+
+  cc_vec_hdr( result.new_cntr )->size = n;
+
+  return result;
+}
+
+static inline cc_allocing_fn_result_ty cc_vec_shrink(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  CC_UNUSED( double, max_load ),
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  if( cc_vec_size( cntr ) == cc_vec_cap( cntr ) ) // Also handles placeholder.
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+
+  // A vector with an allocator keeps its header so that it remains associated with the allocator.
+  if( cc_vec_size( cntr ) == 0 && !cc_vec_hdr( cntr )->allocator )
+  {
+    // Restore placeholder.
+    free_( cntr );
+    return cc_make_allocing_fn_result( (void *)&cc_vec_placeholder, cc_dummy_true_ptr );
+  }
+
+  cc_vec_hdr_ty *new_cntr = (cc_vec_hdr_ty *)cc_allocator_realloc(
+    cc_vec_hdr( cntr )->allocator,
+    realloc_,
+    cntr,
+    sizeof( cc_vec_hdr_ty ) + el_size * cc_vec_size( cntr )
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return cc_make_allocing_fn_result( cntr, NULL );
+
+#ifdef CC_STATS
+  ++cc_vec_hdr( new_cntr )->reallocs;
+#endif
+
+  cc_vec_hdr( new_cntr )->cap = cc_vec_size( new_cntr );
+  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+}
+
+// Initializes a vector that allocates its memory via the specified allocator.
+// The vector's header is allocated immediately so that it can store the pointer to the allocator.
+// Returns a pointer to the new vector, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_vec_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  cc_vec_hdr_ty *new_cntr = (cc_vec_hdr_ty *)allocator->realloc_fn( allocator->ctx, NULL, sizeof( cc_vec_hdr_ty ) );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+  new_cntr->size = 0;
+  new_cntr->cap = 0;
+  new_cntr->allocator = allocator;
+#ifdef CC_STATS
+  new_cntr->reallocs = 0;
+#endif
+  return new_cntr;
+}
+
+// A small-vector buffer, declared via cc_svec, begins with a header containing an allocator that hands out the
+// buffer's inline storage for as long as the vector fits in it.
+// Once the vector outgrows the storage, the allocator moves it to memory obtained from the realloc function visible
+// where cc_init_with_buffer was called, and the inline storage goes unused until the vector is reinitialized.
+typedef struct
+{
+  cc_allocator allocator;       // Allocator whose context points back to this header.
+  void *storage;                // Inline storage for the vector's header and elements.
+  size_t storage_size;          // Size of that storage in bytes.
+  cc_realloc_fnptr_ty realloc_; // Functions used once the vector has outgrown the inline storage.
+  cc_free_fnptr_ty free_;
+} cc_svec_hdr_ty;
+
+// The realloc_fn of a small-vector buffer's allocator.
+// Returns NULL in the case of allocation failure, in which case the original allocation remains valid.
+static inline void *cc_svec_realloc( void *ctx, void *ptr, size_t size )
+{
+  cc_svec_hdr_ty *svec = (cc_svec_hdr_ty *)ctx;
+
+  if( ptr != svec->storage )
+    return svec->realloc_( ptr, size );
+
+  if( size <= svec->storage_size )
+    return ptr;
+
+  void *new_ptr = svec->realloc_( NULL, size );
+  if( CC_UNLIKELY( !new_ptr ) )
+    return NULL;
+
+  memcpy( new_ptr, ptr, svec->storage_size );
+  return new_ptr;
+}
+
+// The free_fn of a small-vector buffer's allocator.
+static inline void cc_svec_free( void *ctx, void *ptr )
+{
+  cc_svec_hdr_ty *svec = (cc_svec_hdr_ty *)ctx;
+
+  if( ptr != svec->storage )
+    svec->free_( ptr );
+}
+
+// Initializes a vector whose header and elements are stored in the inline storage of a small-vector buffer, with a
+// capacity of as many elements as fit in that storage.
+// Returns a pointer to the new vector.
+// This call cannot fail.
+static inline void *cc_vec_init_with_buffer(
+  cc_svec_hdr_ty *buf,
+  void *storage,
+  size_t storage_size,
+  size_t el_size,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  buf->allocator.realloc_fn = cc_svec_realloc;
+  buf->allocator.free_fn = cc_svec_free;
+  buf->allocator.ctx = buf;
+  buf->storage = storage;
+  buf->storage_size = storage_size;
+  buf->realloc_ = realloc_;
+  buf->free_ = free_;
+
+  cc_vec_hdr_ty *cntr = (cc_vec_hdr_ty *)storage;
+  cntr->size = 0;
+  cntr->cap = ( storage_size - sizeof( cc_vec_hdr_ty ) ) / el_size;
+  cntr->allocator = &buf->allocator;
+#ifdef CC_STATS
+  cntr->reallocs = 0;
+#endif
+  return cntr;
+}
+
+// Initializes a vector whose header and elements are stored in the inline storage of a fixed-capacity buffer, with a
+// capacity of exactly slot_count elements.
+// The storage size passed to the buffer's allocator excludes any padding at the end of the buffer so that the vector
+// cannot grow beyond that capacity.
+// Returns a pointer to the new vector.
+// This call cannot fail.
+static inline void *cc_vec_init_with_fixed_buffer(
+  cc_fixed_buf_hdr_ty *buf,
+  void *storage,
+  CC_UNUSED( size_t, storage_size ),
+  size_t slot_count,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  cc_fixed_buf_init( buf, storage, sizeof( cc_vec_hdr_ty ) + el_size * slot_count );
+  buf->in_use = true;
+
+  cc_vec_hdr_ty *cntr = (cc_vec_hdr_ty *)storage;
+  cntr->size = 0;
+  cntr->cap = slot_count;
+  cntr->allocator = &buf->allocator;
+#ifdef CC_STATS
+  cntr->reallocs = 0;
+#endif
+  return cntr;
+}
+
+// Initializes a shallow copy of the source vector.
+// The capacity of the new vector is the size of the source vector, not its capacity.
+// The new vector uses the same allocator as the source vector.
+// Returns a pointer to the copy, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_vec_init_clone(
+  void *src,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  void *new_cntr = (void *)&cc_vec_placeholder;
+  if( cc_vec_hdr( src )->allocator )
+  {
+    new_cntr = cc_vec_init_with_allocator( cc_vec_hdr( src )->allocator, el_size, 0 /* Dummy */ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return NULL;
+  }
+
+  if( cc_vec_size( src ) == 0 )
+    return new_cntr;
+
+  cc_allocing_fn_result_ty result = cc_vec_resize(
+    new_cntr,
+    cc_vec_size( src ),
+    el_size,
+    NULL, // Destructor unused.
+    realloc_
+  );
+
+  if( CC_UNLIKELY( !result.other_ptr ) )
+  {
+    if( !cc_vec_is_placeholder( new_cntr ) )
+      cc_allocator_free( cc_vec_hdr( new_cntr )->allocator, free_, new_cntr );
+
+    return NULL;
+  }
+
+  memcpy(
+    (char *)result.new_cntr + sizeof( cc_vec_hdr_ty ),
+    (char *)src + sizeof( cc_vec_hdr_ty ),
+    el_size * cc_vec_size( src )
+  );
+
+  return result.new_cntr;
+}
+
+// Returns the number of bytes needed to store a snapshot of the vector.
+static inline size_t cc_vec_snapshot_size(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  if( cc_vec_size( cntr ) == 0 )
+    return sizeof( cc_snapshot_hdr_ty );
+
+  return sizeof( cc_snapshot_hdr_ty ) + cc_snapshot_record_size( el_size * cc_vec_size( cntr ) );
+}
+
+// Writes a snapshot of the vector to buf, which must be large enough to hold it.
+// Only the elements, not the unused capacity, are written.
+static inline void cc_vec_write_snapshot(
+  void *cntr,
+  void *buf,
+  size_t cntr_id,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  cc_snapshot_hdr_ty hdr;
+  cc_snapshot_init_hdr( &hdr, cntr_id, el_size, 0, 0 );
+
+  if( cc_vec_size( cntr ) )
+  {
+    hdr.table_count = 1;
+    hdr.sizes[ 0 ] = cc_vec_size( cntr );
+    hdr.caps[ 0 ] = cc_vec_size( cntr );
+    cc_snapshot_write_record(
+      (char *)buf + sizeof( cc_snapshot_hdr_ty ),
+      (char *)cntr + sizeof( cc_vec_hdr_ty ),
+      el_size * cc_vec_size( cntr )
+    );
+  }
+
+  memcpy( buf, &hdr, sizeof( cc_snapshot_hdr_ty ) );
+}
+
+// Creates a vector from the snapshot in buf, of buf_size bytes.
+// If is_view is true, the vector is a view of the snapshot that uses the snapshot's memory for its elements and its
+// header, for which buf must be suitably aligned.
+// Otherwise, the vector is a copy allocated via realloc_.
+// Returns a pointer to the vector, or NULL if the snapshot is invalid, buf is misaligned, or an allocation failure
+// occurred.
+static inline void *cc_vec_load_snapshot(
+  void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  bool is_view,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  cc_snapshot_hdr_ty hdr;
+  if( !cc_snapshot_read_hdr( &hdr, buf, buf_size, cntr_id, el_size, 0, 0 ) || hdr.table_count > 1 )
+    return NULL;
+
+  if( hdr.table_count == 0 )
+    return (void *)&cc_vec_placeholder;
+
+  if(
+    hdr.sizes[ 0 ] == 0 ||
+    hdr.sizes[ 0 ] != hdr.caps[ 0 ] ||
+    hdr.sizes[ 0 ] > SIZE_MAX / 2 / el_size ||
+    buf_size < sizeof( cc_snapshot_hdr_ty ) + cc_snapshot_record_size( el_size * hdr.sizes[ 0 ] )
+  )
+    return NULL;
+
+  size_t size = (size_t)hdr.sizes[ 0 ];
+  char *table = (char *)buf + sizeof( cc_snapshot_hdr_ty ) + CC_SNAPSHOT_SLOT_SIZE;
+  cc_vec_hdr_ty *cntr;
+
+  if( is_view )
+  {
+    if( (uintptr_t)buf % alignof( cc_max_align_ty ) )
+      return NULL;
+
+    cntr = (cc_vec_hdr_ty *)( table - sizeof( cc_vec_hdr_ty ) );
+    cntr->allocator = (cc_allocator *)&cc_snapshot_view_allocator;
+  }
+  else
+  {
+    cntr = (cc_vec_hdr_ty *)realloc_( NULL, sizeof( cc_vec_hdr_ty ) + el_size * size );
+    if( CC_UNLIKELY( !cntr ) )
+      return NULL;
+
+    memcpy( (char *)cntr + sizeof( cc_vec_hdr_ty ), table, el_size * size );
+    cntr->allocator = NULL;
+  }
+
+  cntr->size = size;
+  cntr->cap = size;
+#ifdef CC_STATS
+  cntr->reallocs = 0;
+#endif
+  return cntr;
+}
+
+// Initializes a vector from a copy of the snapshot in buf, of buf_size bytes.
+// Returns a pointer to the vector, or NULL if the snapshot is invalid or an allocation failure occurred.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_vec_init_from_snapshot(
+  const void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_vec_load_snapshot( (void *)buf, buf_size, cntr_id, el_size, false, realloc_ );
+}
+
+// Initializes a vector that is a view of the snapshot in buf, of buf_size bytes.
+// Returns a pointer to the vector, or NULL if the snapshot is invalid or buf is misaligned.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_vec_init_view_of_snapshot(
+  void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_vec_load_snapshot( buf, buf_size, cntr_id, el_size, true, NULL /* Unused */ );
+}
+
+// Erases all elements, calling their destructors if necessary.
+static inline void cc_vec_clear(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  cc_vec_erase_n( cntr, 0, cc_vec_size( cntr ), el_size, el_dtor );
+}
+
+// Clears the vector and frees its memory if it is not a placeholder.
+static inline void cc_vec_cleanup(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_vec_clear(
+    cntr,
+    el_size,
+    0,       // Dummy.
+    el_dtor,
+    NULL,    // Dummy.
+    NULL     // Dummy.
+  );
+
+  if( !cc_vec_is_placeholder( cntr ) )
+    cc_allocator_free( cc_vec_hdr( cntr )->allocator, free_, cntr );
+}
+
+#ifdef CC_STATS
+
+static inline void cc_vec_get_stats( void *cntr, cc_stats *stats )
+{
+  memset( stats, 0, sizeof( cc_stats ) );
+  stats->size = cc_vec_size( cntr );
+  stats->cap = cc_vec_cap( cntr );
+  stats->reallocs = cc_vec_hdr( cntr )->reallocs;
+}
+
+#endif
+
+static inline cc_mem_usage cc_vec_memory_usage( void *cntr, size_t el_size, CC_UNUSED( uint64_t, layout ) )
+{
+  if( cc_vec_is_placeholder( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+  return cc_make_mem_usage( sizeof( cc_vec_hdr_ty ) + el_size * cc_vec_cap( cntr ), el_size * cc_vec_size( cntr ) );
+}
+
+static inline void *cc_vec_end(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * cc_vec_size( cntr );
+}
+
+static inline void *cc_vec_next(
+  CC_UNUSED( void *, cntr ),
+  void *itr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return (char *)itr + el_size;
+}
+
+static inline void *cc_vec_first(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return (char *)cntr + sizeof( cc_vec_hdr_ty );
+}
+
+static inline void *cc_vec_last(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return (char *)cntr + sizeof( cc_vec_hdr_ty ) + el_size * ( cc_vec_size( cntr ) - 1 );
+}
+
+// Vector algorithms.
+// sort, stable_sort, binary_search, and unique compare elements via the three-way comparison function associated with
+// the element type, which the API macros pass as a constant.
+// These functions are forcibly inlined so that the compiler can inline the comparison function into them and exploit
+// the constant element size.
+
+// Ranges no longer than this are sorted via insertion sort.
+#define CC_VEC_INSERTION_SORT_MAX_SIZE 16
+
+// Values yielded by CC_EL_RADIX (see below).
+// For vectors of fundamental integer types that use the default comparison function, this value tells sort and
+// stable_sort how to interpret the elements as unsigned keys for a least-significant-digit radix sort, which never
+// calls the comparison function.
+#define CC_RADIX_NONE     0
+#define CC_RADIX_UNSIGNED 1
+#define CC_RADIX_SIGNED   2
+
+// Vectors shorter than this are not radix sorted because the histogram would cost more than it saves.
+#define CC_VEC_RADIX_SORT_MIN_SIZE 256
+
+// Swaps two elements.
+static inline CC_ALWAYS_INLINE void cc_vec_swap_els( void *el_1, void *el_2, size_t el_size )
+{
+  char buffer[ 64 ];
+
+  while( el_size )
+  {
+    size_t chunk = el_size < sizeof( buffer ) ? el_size : sizeof( buffer );
+    memcpy( buffer, el_1, chunk );
+    memcpy( el_1, el_2, chunk );
+    memcpy( el_2, buffer, chunk );
+    el_1 = (char *)el_1 + chunk;
+    el_2 = (char *)el_2 + chunk;
+    el_size -= chunk;
+  }
+}
+
+// Sorts a range via insertion sort, which is stable.
+static inline CC_ALWAYS_INLINE void cc_vec_insertion_sort( char *els, size_t n, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  for( size_t i = 1; i < n; ++i )
+    for( size_t j = i; j > 0 && cmpr( els + el_size * ( j - 1 ), els + el_size * j ) > 0; --j )
+      cc_vec_swap_els( els + el_size * ( j - 1 ), els + el_size * j, el_size );
+}
+
+// Restores the max-heap property of the subtree rooted at the specified index of a heap of size n.
+static inline CC_ALWAYS_INLINE void cc_vec_sift_down(
+  char *els,
+  size_t root,
+  size_t n,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  while( true )
+  {
+    size_t child = root * 2 + 1;
+    if( child >= n )
+      return;
+
+    if( child + 1 < n && cmpr( els + el_size * child, els + el_size * ( child + 1 ) ) < 0 )
+      ++child;
+
+    if( cmpr( els + el_size * root, els + el_size * child ) >= 0 )
+      return;
+
+    cc_vec_swap_els( els + el_size * root, els + el_size * child, el_size );
+    root = child;
+  }
+}
+
+// Sorts a range via heapsort, which cc_vec_intro_sort falls back on if partitioning repeatedly goes badly.
+static inline CC_ALWAYS_INLINE void cc_vec_heap_sort( char *els, size_t n, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  for( size_t i = n / 2; i-- > 0; )
+    cc_vec_sift_down( els, i, n, el_size, cmpr );
+
+  for( size_t i = n; i-- > 1; )
+  {
+    cc_vec_swap_els( els, els + el_size * i, el_size );
+    cc_vec_sift_down( els, 0, i, el_size, cmpr );
+  }
+}
+
+// Partitions a range of more than CC_VEC_INSERTION_SORT_MAX_SIZE elements around the median of its second, middle, and
+// last elements and returns the index at which that pivot ends up.
+// The elements before the pivot are not greater than it, and the elements after it are not less than it.
+static inline CC_ALWAYS_INLINE size_t cc_vec_partition( char *els, size_t n, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  char *low = els + el_size;
+  char *mid = els + el_size * ( n / 2 );
+  char *high = els + el_size * ( n - 1 );
+
+  if( cmpr( low, mid ) > 0 )
+    cc_vec_swap_els( low, mid, el_size );
+  if( cmpr( mid, high ) > 0 )
+  {
+    cc_vec_swap_els( mid, high, el_size );
+    if( cmpr( low, mid ) > 0 )
+      cc_vec_swap_els( low, mid, el_size );
+  }
+
+  // Move the pivot to the front.
+  // The second element, which is not greater than the pivot, and the last element, which is not less, then stop the
+  // scans below from running off either end of the range.
+  cc_vec_swap_els( els, mid, el_size );
+
+  size_t i = 0;
+  size_t j = n;
+  while( true )
+  {
+    do
+      ++i;
+    while( cmpr( els + el_size * i, els ) < 0 );
+
+    do
+      --j;
+    while( cmpr( els, els + el_size * j ) < 0 );
+
+    if( i >= j )
+      break;
+
+    cc_vec_swap_els( els + el_size * i, els + el_size * j, el_size );
+  }
+
+  cc_vec_swap_els( els, els + el_size * j, el_size );
+  return j;
+}
+
+// Returns the depth of partitioning beyond which cc_vec_intro_sort falls back on heapsort, i.e. 2 * log2( n ).
+static inline size_t cc_vec_intro_sort_depth_limit( size_t n )
+{
+  size_t depth_limit = 0;
+  while( n >>= 1 )
+    depth_limit += 2;
+
+  return depth_limit;
+}
+
+// Sorts a range via introsort.
+// Rather than recursing, the function defers the larger side of each partition to an explicit stack and continues with
+// the smaller side, so the stack never holds more than log2( n ) ranges.
+// Avoiding recursion allows the function to be inlined into the API macro's call site, where the element size and
+// comparison function are constants.
+static inline CC_ALWAYS_INLINE void cc_vec_intro_sort( char *els, size_t n, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  struct
+  {
+    char *els;
+    size_t n;
+    size_t depth_limit;
+  } stack[ sizeof( size_t ) * 8 ];
+  size_t stack_size = 0;
+  size_t depth_limit = cc_vec_intro_sort_depth_limit( n );
+
+  while( true )
+  {
+    if( n > CC_VEC_INSERTION_SORT_MAX_SIZE && depth_limit > 0 )
+    {
+      --depth_limit;
+      size_t pivot = cc_vec_partition( els, n, el_size, cmpr );
+      char *right = els + el_size * ( pivot + 1 );
+      size_t right_n = n - pivot - 1;
+
+      stack[ stack_size ].depth_limit = depth_limit;
+      if( pivot < right_n )
+      {
+        stack[ stack_size ].els = right;
+        stack[ stack_size ].n = right_n;
+        n = pivot;
+      }
+      else
+      {
+        stack[ stack_size ].els = els;
+        stack[ stack_size ].n = pivot;
+        els = right;
+        n = right_n;
+      }
+
+      ++stack_size;
+      continue;
+    }
+
+    if( n > CC_VEC_INSERTION_SORT_MAX_SIZE )
+      cc_vec_heap_sort( els, n, el_size, cmpr );
+    else
+      cc_vec_insertion_sort( els, n, el_size, cmpr );
+
+    if( stack_size == 0 )
+      return;
+
+    --stack_size;
+    els = stack[ stack_size ].els;
+    n = stack[ stack_size ].n;
+    depth_limit = stack[ stack_size ].depth_limit;
+  }
+}
+
+// Returns the radix sort key of an element of a fundamental integer type (see CC_RADIX_NONE above).
+// Flipping the sign bit of a signed integer makes the unsigned order of the keys match the signed order of the
+// elements.
+static inline uint64_t cc_vec_radix_key( void *el, size_t el_size, int radix )
+{
+  uint64_t key;
+  if( el_size == 1 )
+  {
+    uint8_t val;
+    memcpy( &val, el, 1 );
+    key = val;
+  }
+  else if( el_size == 2 )
+  {
+    uint16_t val;
+    memcpy( &val, el, 2 );
+    key = val;
+  }
+  else if( el_size == 4 )
+  {
+    uint32_t val;
+    memcpy( &val, el, 4 );
+    key = val;
+  }
+  else
+    memcpy( &key, el, 8 );
+
+  if( radix == CC_RADIX_SIGNED )
+    key ^= (uint64_t)1 << ( el_size * 8 - 1 );
+
+  return key;
+}
+
+// Sorts a range of integers via a least-significant-digit radix sort, which is stable, using the provided buffer of the
+// same size as the range.
+// Passes over bytes that are the same in every key are skipped.
+static inline void cc_vec_radix_sort( char *els, size_t n, char *buffer, size_t el_size, int radix )
+{
+  size_t counts[ 8 ][ 256 ];
+  memset( counts, 0, sizeof( counts[ 0 ] ) * el_size );
+
+  for( size_t i = 0; i < n; ++i )
+  {
+    uint64_t key = cc_vec_radix_key( els + el_size * i, el_size, radix );
+    for( size_t byte = 0; byte < el_size; ++byte )
+      ++counts[ byte ][ ( key >> ( byte * 8 ) ) & 0xFF ];
+  }
+
+  uint64_t first_key = cc_vec_radix_key( els, el_size, radix );
+  char *src = els;
+  char *dst = buffer;
+
+  for( size_t byte = 0; byte < el_size; ++byte )
+  {
+    if( counts[ byte ][ ( first_key >> ( byte * 8 ) ) & 0xFF ] == n )
+      continue;
+
+    size_t offset = 0;
+    for( size_t digit = 0; digit < 256; ++digit )
+    {
+      size_t count = counts[ byte ][ digit ];
+      counts[ byte ][ digit ] = offset;
+      offset += count;
+    }
+
+    for( size_t i = 0; i < n; ++i )
+    {
+      uint64_t key = cc_vec_radix_key( src + el_size * i, el_size, radix );
+      memcpy( dst + el_size * counts[ byte ][ ( key >> ( byte * 8 ) ) & 0xFF ]++, src + el_size * i, el_size );
+    }
+
+    char *temp = src;
+    src = dst;
+    dst = temp;
+  }
+
+  if( src != els )
+    memcpy( els, src, el_size * n );
+}
+
+#ifdef CC_PARALLEL_REHASH
+
+// If CC_PARALLEL_REHASH is defined, sort splits a large vector that it cannot radix sort into up to
+// CC_VEC_PARALLEL_MAX_TASKS ranges by partitioning it on the calling thread and then sorts the ranges concurrently.
+// The largest range is split until every range has fewer than 2 * CC_VEC_PARALLEL_MIN_TASK_SIZE elements.
+#define CC_VEC_PARALLEL_MIN_TASK_SIZE 65536
+#define CC_VEC_PARALLEL_MAX_TASKS 64
+
+typedef struct
+{
+  char *els;
+  size_t n;
+} cc_vec_sort_range_ty;
+
+typedef struct
+{
+  cc_vec_sort_range_ty ranges[ CC_VEC_PARALLEL_MAX_TASKS ];
+  size_t el_size;
+  cc_cmpr_fnptr_ty cmpr;
+} cc_vec_parallel_sort_ty;
+
+static inline void cc_vec_parallel_sort_task( void *ctx, size_t index )
+{
+  cc_vec_parallel_sort_ty *sort = (cc_vec_parallel_sort_ty *)ctx;
+  cc_vec_sort_range_ty range = sort->ranges[ index ];
+
+  cc_vec_intro_sort( range.els, range.n, sort->el_size, sort->cmpr );
+}
+
+static inline void cc_vec_parallel_sort( char *els, size_t n, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  cc_vec_parallel_sort_ty sort;
+  sort.el_size = el_size;
+  sort.cmpr = cmpr;
+  sort.ranges[ 0 ].els = els;
+  sort.ranges[ 0 ].n = n;
+  size_t range_count = 1;
+
+  while( range_count < CC_VEC_PARALLEL_MAX_TASKS )
+  {
+    size_t largest = 0;
+    for( size_t i = 1; i < range_count; ++i )
+      if( sort.ranges[ i ].n > sort.ranges[ largest ].n )
+        largest = i;
+
+    cc_vec_sort_range_ty range = sort.ranges[ largest ];
+    if( range.n < CC_VEC_PARALLEL_MIN_TASK_SIZE * 2 )
+      break;
+
+    // The pivot is already in its final position, so it belongs to neither of the new ranges.
+    size_t pivot = cc_vec_partition( range.els, range.n, el_size, cmpr );
+    sort.ranges[ largest ].n = pivot;
+    sort.ranges[ range_count ].els = range.els + el_size * ( pivot + 1 );
+    sort.ranges[ range_count ].n = range.n - pivot - 1;
+    ++range_count;
+  }
+
+  cc_parallel_for( cc_vec_parallel_sort_task, &sort, range_count );
+}
+
+#endif
+
+// Sorts the vector's elements.
+// Vectors of fundamental integer types are radix sorted if a buffer for the purpose can be allocated, and other vectors
+// are sorted in place via introsort.
+// This call cannot fail.
+static inline CC_ALWAYS_INLINE void cc_vec_sort(
+  void *cntr,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr,
+  int radix,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  char *els = (char *)cntr + sizeof( cc_vec_hdr_ty );
+  size_t n = cc_vec_size( cntr );
+
+  if( radix != CC_RADIX_NONE && n >= CC_VEC_RADIX_SORT_MIN_SIZE )
+  {
+    char *buffer = (char *)cc_allocator_realloc( cc_vec_hdr( cntr )->allocator, realloc_, NULL, el_size * n );
+    if( buffer )
+    {
+      cc_vec_radix_sort( els, n, buffer, el_size, radix );
+      cc_allocator_free( cc_vec_hdr( cntr )->allocator, free_, buffer );
+      return;
+    }
+  }
+
+#ifdef CC_PARALLEL_REHASH
+  if( n >= CC_VEC_PARALLEL_MIN_TASK_SIZE * 2 )
+  {
+    cc_vec_parallel_sort( els, n, el_size, cmpr );
+    return;
+  }
+#endif
+
+  cc_vec_intro_sort( els, n, el_size, cmpr );
+}
+
+// Merges the sorted runs [ 0, mid ) and [ mid, n ) of src into dst, preferring the first run in the case of equal
+// elements.
+static inline CC_ALWAYS_INLINE void cc_vec_merge(
+  char *src,
+  size_t mid,
+  size_t n,
+  char *dst,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  size_t i = 0;
+  size_t j = mid;
+
+  while( i < mid && j < n )
+  {
+    if( cmpr( src + el_size * j, src + el_size * i ) < 0 )
+      memcpy( dst, src + el_size * j++, el_size );
+    else
+      memcpy( dst, src + el_size * i++, el_size );
+
+    dst += el_size;
+  }
+
+  memcpy( dst, src + el_size * i, el_size * ( mid - i ) );
+  memcpy( dst + el_size * ( mid - i ), src + el_size * j, el_size * ( n - j ) );
+}
+
+// Reverses the order of a range of elements.
+static inline CC_ALWAYS_INLINE void cc_vec_reverse( char *els, size_t n, size_t el_size )
+{
+  for( size_t i = 0; i < n / 2; ++i )
+    cc_vec_swap_els( els + el_size * i, els + el_size * ( n - i - 1 ), el_size );
+}
+
+// Merges the sorted runs [ 0, mid ) and [ mid, n ) of els in place, preferring the first run in the case of equal
+// elements.
+// Each step skips the elements of the first run that are not greater than the first element of the second run and then
+// rotates the remainder of the first run past the elements of the second run that are less than its first element.
+// This approach needs no buffer but moves elements quadratically often in the worst case, so stable_sort only uses it
+// when it cannot allocate a buffer.
+static inline CC_ALWAYS_INLINE void cc_vec_merge_in_place(
+  char *els,
+  size_t mid,
+  size_t n,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  size_t start = 0;
+
+  while( start < mid && mid < n )
+  {
+    // Find the first element of the first run that is greater than the first element of the second run.
+    size_t low = start;
+    size_t high = mid;
+    while( low < high )
+    {
+      size_t i = low + ( high - low ) / 2;
+      if( cmpr( els + el_size * mid, els + el_size * i ) < 0 )
+        high = i;
+      else
+        low = i + 1;
+    }
+
+    start = low;
+    if( start == mid )
+      return;
+
+    // Find the end of the elements of the second run that are less than that element.
+    low = mid;
+    high = n;
+    while( low < high )
+    {
+      size_t i = low + ( high - low ) / 2;
+      if( cmpr( els + el_size * i, els + el_size * start ) < 0 )
+        low = i + 1;
+      else
+        high = i;
+    }
+
+    // Rotate [ start, mid ) past [ mid, low ).
+    cc_vec_reverse( els + el_size * start, mid - start, el_size );
+    cc_vec_reverse( els + el_size * mid, low - mid, el_size );
+    cc_vec_reverse( els + el_size * start, low - start, el_size );
+
+    start += low - mid;
+    mid = low;
+  }
+}
+
+// Sorts the vector's elements, preserving the order of equal elements.
+// Vectors of fundamental integer types are radix sorted, and other vectors are merge sorted.
+// If no buffer can be allocated - e.g. because the vector uses a fixed-capacity buffer - the elements are instead merge
+// sorted in place.
+// This call cannot fail.
+static inline CC_ALWAYS_INLINE void cc_vec_stable_sort(
+  void *cntr,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr,
+  int radix,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  char *els = (char *)cntr + sizeof( cc_vec_hdr_ty );
+  size_t n = cc_vec_size( cntr );
+
+  if( n <= CC_VEC_INSERTION_SORT_MAX_SIZE )
+  {
+    cc_vec_insertion_sort( els, n, el_size, cmpr );
+    return;
+  }
+
+  char *buffer = (char *)cc_allocator_realloc( cc_vec_hdr( cntr )->allocator, realloc_, NULL, el_size * n );
+
+  if( buffer && radix != CC_RADIX_NONE && n >= CC_VEC_RADIX_SORT_MIN_SIZE )
+    cc_vec_radix_sort( els, n, buffer, el_size, radix );
+  else
+  {
+    for( size_t start = 0; start < n; start += CC_VEC_INSERTION_SORT_MAX_SIZE )
+      cc_vec_insertion_sort(
+        els + el_size * start,
+        n - start < CC_VEC_INSERTION_SORT_MAX_SIZE ? n - start : CC_VEC_INSERTION_SORT_MAX_SIZE,
+        el_size,
+        cmpr
+      );
+
+    if( CC_UNLIKELY( !buffer ) )
+    {
+      for( size_t width = CC_VEC_INSERTION_SORT_MAX_SIZE; width < n; width *= 2 )
+        for( size_t start = 0; start + width < n; start += width * 2 )
+          cc_vec_merge_in_place(
+            els + el_size * start,
+            width,
+            n - start < width * 2 ? n - start : width * 2,
+            el_size,
+            cmpr
+          );
+
+      return;
+    }
+
+    // Merge runs of doubling width back and forth between the vector and the buffer.
+    char *src = els;
+    char *dst = buffer;
+    for( size_t width = CC_VEC_INSERTION_SORT_MAX_SIZE; width < n; width *= 2 )
+    {
+      for( size_t start = 0; start < n; start += width * 2 )
+      {
+        size_t remaining = n - start;
+        cc_vec_merge(
+          src + el_size * start,
+          remaining < width ? remaining : width,
+          remaining < width * 2 ? remaining : width * 2,
+          dst + el_size * start,
+          el_size,
+          cmpr
+        );
+      }
+
+      char *temp = src;
+      src = dst;
+      dst = temp;
+    }
+
+    if( src != els )
+      memcpy( els, src, el_size * n );
+  }
+
+  cc_allocator_free( cc_vec_hdr( cntr )->allocator, free_, buffer );
+}
+
+// Returns a pointer-iterator to the first element equal to el in a vector sorted by the comparison function, or NULL if
+// no such element exists.
+static inline CC_ALWAYS_INLINE void *cc_vec_binary_search( void *cntr, void *el, size_t el_size, cc_cmpr_fnptr_ty cmpr )
+{
+  char *els = (char *)cntr + sizeof( cc_vec_hdr_ty );
+  size_t low = 0;
+  size_t high = cc_vec_size( cntr );
+
+  while( low < high )
+  {
+    size_t mid = low + ( high - low ) / 2;
+    if( cmpr( els + el_size * mid, el ) < 0 )
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  if( low < cc_vec_size( cntr ) && cmpr( els + el_size * low, el ) == 0 )
+    return els + el_size * low;
+
+  return NULL;
+}
+
+// Erases every element that is equal to the element before it, calling the destructor if necessary.
+// Returns the number of elements erased.
+static inline CC_ALWAYS_INLINE size_t cc_vec_unique(
+  void *cntr,
+  size_t el_size,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor
+)
+{
+  char *els = (char *)cntr + sizeof( cc_vec_hdr_ty );
+  size_t size = cc_vec_size( cntr );
+  if( size < 2 )
+    return 0;
+
+  size_t kept = 1;
+  for( size_t i = 1; i < size; ++i )
+  {
+    char *el = els + el_size * i;
+    if( cmpr( els + el_size * ( kept - 1 ), el ) == 0 )
+    {
+      if( el_dtor )
+        el_dtor( el );
+    }
+    else
+    {
+      if( kept != i )
+        memcpy( els + el_size * kept, el, el_size );
+
+      ++kept;
+    }
+  }
+
+  cc_vec_hdr( cntr )->size = kept;
+  return size - kept;
+}
+
+// Erases every element for which the predicate does not return keep_if, calling the destructor if necessary, while
+// preserving the order of the remaining elements.
+// This function is the basis of both cc_filter (keep_if is true) and cc_erase_if (keep_if is false).
+// Returns the number of elements erased.
+static inline size_t cc_vec_filter(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  char *els = (char *)cntr + sizeof( cc_vec_hdr_ty );
+  size_t size = cc_vec_size( cntr );
+  if( size == 0 )
+    return 0;
+
+  size_t kept = 0;
+  for( size_t i = 0; i < size; ++i )
+  {
+    char *el = els + el_size * i;
+    if( pred( el, ctx ) == keep_if )
+    {
+      if( kept != i )
+        memcpy( els + el_size * kept, el, el_size );
+
+      ++kept;
+    }
+    else if( el_dtor )
+      el_dtor( el );
+  }
+
+  cc_vec_hdr( cntr )->size = kept;
+  return size - kept;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                     Node pool                                                      */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// If CC_POOL_NODES is defined, lists, ordered maps, and ordered sets allocate their nodes from a per-container pool
+// rather than allocating each node separately.
+// The pool carves nodes out of slabs, each of which holds twice as many nodes as the last (up to a limit).
+// Erased nodes are recycled via a free list, and all slabs are freed at once when the container is cleaned up.
+// A free node stores the pointer to the next free node in its first bytes.
+
+// The number of nodes in a pool's first slab.
+#define CC_POOL_MIN_SLAB_NODE_COUNT 8
+
+// Slabs stop growing after reaching this size in bytes.
+#define CC_POOL_MAX_SLAB_SIZE 1048576
+
+// Slab header.
+typedef struct cc_pool_slab_hdr_ty
+{
+  alignas( cc_max_align_ty )
+  struct cc_pool_slab_hdr_ty *next;
+  size_t node_count;
+} cc_pool_slab_hdr_ty;
+
+// Pool, embedded in the header of a list, ordered map, or ordered set.
+typedef struct
+{
+  void *free_nodes;                   // Recycled nodes.
+  cc_pool_slab_hdr_ty *first_slab;    // Slabs preceding current_slab are fully carved.
+  cc_pool_slab_hdr_ty *current_slab;  // Slab from which new nodes are carved once the free list is empty.
+  size_t current_slab_used;           // Number of nodes already carved from the current slab.
+} cc_pool_ty;
+
+static inline void cc_pool_init( cc_pool_ty *pool )
+{
+  pool->free_nodes = NULL;
+  pool->first_slab = NULL;
+  pool->current_slab = NULL;
+  pool->current_slab_used = 0;
+}
+
+// Rounds up the size of a node so that every node carved from a slab is suitably aligned.
+static inline size_t cc_pool_node_size( size_t size )
+{
+  return size + CC_PADDING( size, alignof( cc_max_align_ty ) );
+}
+
+// Returns a node of the specified size, which must be the same for every call on the same pool, or NULL in the case of
+// allocation failure.
+static inline void *cc_pool_alloc(
+  cc_pool_ty *pool,
+  size_t size,
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  size = cc_pool_node_size( size );
+
+  // Recycle an erased node.
+  if( pool->free_nodes )
+  {
+    void *node = pool->free_nodes;
+    memcpy( &pool->free_nodes, node, sizeof( void * ) );
+    return node;
+  }
+
+  // Move on to the next slab, or allocate a new one, if the current slab is exhausted.
+  if( !pool->current_slab || pool->current_slab_used == pool->current_slab->node_count )
+  {
+    if( pool->current_slab && pool->current_slab->next ) // Slab left over from before the pool was reset.
+      pool->current_slab = pool->current_slab->next;
+    else
+    {
+      // Double the node count, capping it according to the maximum slab size rather than simply ceasing to double
+      // because the current slab may be an oversized one allocated by cc_pool_alloc_n.
+      size_t node_count = CC_POOL_MIN_SLAB_NODE_COUNT;
+      if( pool->current_slab )
+      {
+        size_t max_node_count = CC_POOL_MAX_SLAB_SIZE / size;
+        if( max_node_count < CC_POOL_MIN_SLAB_NODE_COUNT )
+          max_node_count = CC_POOL_MIN_SLAB_NODE_COUNT;
+
+        node_count = pool->current_slab->node_count * 2;
+        if( node_count > max_node_count )
+          node_count = max_node_count;
+      }
+
+      cc_pool_slab_hdr_ty *new_slab = (cc_pool_slab_hdr_ty *)cc_allocator_realloc(
+        allocator,
+        realloc_,
+        NULL,
+        sizeof( cc_pool_slab_hdr_ty ) + node_count * size
+      );
+      if( CC_UNLIKELY( !new_slab ) )
+        return NULL;
+
+      new_slab->next = NULL;
+      new_slab->node_count = node_count;
+
+      if( pool->current_slab )
+        pool->current_slab->next = new_slab;
+      else
+        pool->first_slab = new_slab;
+
+      pool->current_slab = new_slab;
+    }
+
+    pool->current_slab_used = 0;
+  }
+
+  return (char *)pool->current_slab + sizeof( cc_pool_slab_hdr_ty ) + size * pool->current_slab_used++;
+}
+
+// Allocates a dedicated slab of node_count contiguous nodes of the specified size, all of which are considered in use.
+// The slab is linked before the slab from which cc_pool_alloc is carving nodes so that it is never carved again until
+// the pool is reset.
+// Returns a pointer to the first node, or NULL in the case of allocation failure.
+static inline void *cc_pool_alloc_n(
+  cc_pool_ty *pool,
+  size_t size,
+  size_t node_count,
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  size = cc_pool_node_size( size );
+
+  cc_pool_slab_hdr_ty *new_slab = (cc_pool_slab_hdr_ty *)cc_allocator_realloc(
+    allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_pool_slab_hdr_ty ) + node_count * size
+  );
+  if( CC_UNLIKELY( !new_slab ) )
+    return NULL;
+
+  new_slab->next = pool->first_slab;
+  new_slab->node_count = node_count;
+  pool->first_slab = new_slab;
+
+  if( !pool->current_slab )
+  {
+    pool->current_slab = new_slab;
+    pool->current_slab_used = node_count;
+  }
+
+  return (char *)new_slab + sizeof( cc_pool_slab_hdr_ty );
+}
+
+// Returns a node to the pool for recycling.
+static inline void cc_pool_free( cc_pool_ty *pool, void *node )
+{
+  memcpy( node, &pool->free_nodes, sizeof( void * ) );
+  pool->free_nodes = node;
+}
+
+// Makes every node in the pool available again without freeing the slabs.
+static inline void cc_pool_reset( cc_pool_ty *pool )
+{
+  pool->free_nodes = NULL;
+  pool->current_slab = pool->first_slab;
+  pool->current_slab_used = 0;
+}
+
+// Frees all the slabs at once.
+static inline void cc_pool_cleanup( cc_pool_ty *pool, cc_allocator *allocator, cc_free_fnptr_ty free_ )
+{
+  cc_pool_slab_hdr_ty *slab = pool->first_slab;
+  while( slab )
+  {
+    cc_pool_slab_hdr_ty *next = slab->next;
+    cc_allocator_free( allocator, free_, slab );
+    slab = next;
+  }
+
+  cc_pool_init( pool );
+}
+
+// Returns the total size of the pool's slabs, given the size of a node before rounding.
+static inline size_t cc_pool_allocated( cc_pool_ty *pool, size_t size )
+{
+  size = cc_pool_node_size( size );
+
+  size_t allocated = 0;
+  for( cc_pool_slab_hdr_ty *slab = pool->first_slab; slab; slab = slab->next )
+    allocated += sizeof( cc_pool_slab_hdr_ty ) + slab->node_count * size;
+
+  return allocated;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                        List                                                        */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// List is implemented as a doubly linked list with sentinel nodes.
+
+// Node header.
+typedef struct cc_listnode_hdr_ty
+{
+  alignas( cc_max_align_ty )
+  struct cc_listnode_hdr_ty *prev;
+  struct cc_listnode_hdr_ty *next;
+} cc_listnode_hdr_ty;
+
+// List header.
+// It does not need to be aligned to alignof( cc_max_align_ty ) because no memory is allocated after the header.
+typedef struct
+{
+  size_t size;
+  cc_listnode_hdr_ty r_end;
+  cc_listnode_hdr_ty end;
+  cc_allocator *allocator;
+#ifdef CC_POOL_NODES
+  cc_pool_ty pool;
+#endif
+} cc_list_hdr_ty;
+
+// Placeholder for a list with no allocated header.
+// The main purpose this serves is to provide every list with stable r_end and end pointer-iterators across translation
+// units and irrespective of whether any memory has been allocated for its header.
+// Every list initially (after cc_init) points to this placeholder, which differs across translation units, and is then
+// associated with that placeholder until cc_cleanup is called.
+// Calls to cc_r_end and cc_end on a list return pointers to the associated placeholder's r_end and end nodes even after
+// a header has been dynamically allocated for it.
+// The way this works is that the placeholder's r_end.prev pointer points to the placeholder's r_end (i.e. a circular
+// link), and ditto for end.next.
+// Meanwhile, a list with an allocated header has it's r_end.prev pointer point to the placeholder's r_end, and ditto
+// for it's end.next pointer.
+// Therefore cc_list_hdr( cntr )->r_end.prev always produces the associated placeholder's r_end, and ditto for
+// cc_list_hdr( cntr )->end.next.
+// Unfortunately, this means that r_end and end must be handled as special cases during inserts, splices, and iteration.
+static const cc_list_hdr_ty cc_list_placeholder = {
+  0,
+  {
+    (cc_listnode_hdr_ty *)&cc_list_placeholder.r_end, // Circular link.
+    (cc_listnode_hdr_ty *)&cc_list_placeholder.end
+  },
+  {
+    (cc_listnode_hdr_ty *)&cc_list_placeholder.r_end,
+    (cc_listnode_hdr_ty *)&cc_list_placeholder.end    // Circular link.
+  },
+  NULL
+#ifdef CC_POOL_NODES
+  ,
+  { NULL, NULL, NULL, 0 }
+#endif
+};
+
+// Easy access to the list header.
+static inline cc_list_hdr_ty *cc_list_hdr( void *cntr )
+{
+  return (cc_list_hdr_ty *)cntr;
+}
+
+// Easy access to a list node header from a pointer-iterator.
+static inline cc_listnode_hdr_ty *cc_listnode_hdr( void *itr )
+{
+  return (cc_listnode_hdr_ty *)( (char *)itr - sizeof( cc_listnode_hdr_ty ) );
+}
+
+// Easy access to a pointer-iterator from a pointer to a list node header.
+static inline void *cc_list_el( void *hdr )
+{
+  return (char *)hdr + sizeof( cc_listnode_hdr_ty );
+}
+
+static inline bool cc_list_is_placeholder( void *cntr )
+{
+  return cc_list_hdr( cntr )->r_end.prev == &cc_list_hdr( cntr )->r_end;
+}
+
+static inline size_t cc_list_size( void *cntr )
+{
+  return cc_list_hdr( cntr )->size;
+}
+
+static inline void *cc_list_r_end( void *cntr )
+{
+  return cc_list_el( cc_list_hdr( cntr )->r_end.prev );
+}
+
+static inline void *cc_list_end(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_list_el( cc_list_hdr( cntr )->end.next );
+}
+
+static inline void *cc_list_prev(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  cc_listnode_hdr_ty *prev;
+
+  // If itr is an end iterator, then we need to escape the placeholder originally associated with the list by retrieving
+  // the previous node from the allocated header, if a header has been allocated.
+  if( itr == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
+    prev = cc_list_hdr( cntr )->end.prev;
+  else
+    prev = cc_listnode_hdr( itr )->prev;
+
+  // If prev is r_end, then we need to decrement the pointer-iterator once more to ensure that the returned
+  // pointer-iterator is the r_end of the placeholder originally associated with the list.
+  if( prev == &cc_list_hdr( cntr )->r_end )
+    prev = prev->prev;
+
+  return cc_list_el( prev );
+}
+
+static inline void *cc_list_next(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  cc_listnode_hdr_ty *next;
+
+  // See the comment in cc_list_prev above.
+  if( itr == cc_list_r_end( cntr ) )
+    next = cc_list_hdr( cntr )->r_end.next;
+  else
+    next = cc_listnode_hdr( itr )->next;
+
+  // Again, see the comment in cc_list_prev above.
+  if( next == &cc_list_hdr( cntr )->end )
+    next = next->next;
+
+  return cc_list_el( next );
+}
+
+static inline void *cc_list_first(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_list_next(
+    cntr,
+    cc_list_el( &cc_list_hdr( cntr )->r_end ),
+    0, // Dummy.
+    0  // Dummy.
+  );
+}
+
+static inline void *cc_list_last(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_list_prev(
+    cntr,
+    cc_list_el( &cc_list_hdr( cntr )->end ),
+    0, // Dummy.
+    0  // Dummy.
+  );
+}
+
+// Allocates a header for a list that is currently a placeholder.
+// If allocator is not NULL, the header is allocated via, and associated with, that allocator.
+// Returns the new container handle, or NULL in the case of allocation failure.
+static inline void *cc_list_alloc_hdr(
+  void *cntr,
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  cc_list_hdr_ty *new_cntr = (cc_list_hdr_ty *)cc_allocator_realloc(
+    allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_list_hdr_ty )
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+  new_cntr->r_end.next = &new_cntr->end;
+  new_cntr->end.prev = &new_cntr->r_end;
+
+  // Link the new header's r_end and end with the original placeholder's r_end and end.
+  new_cntr->r_end.prev = &cc_list_hdr( cntr )->r_end;
+  new_cntr->end.next = &cc_list_hdr( cntr )->end;
+
+  new_cntr->size = 0; 
+  new_cntr->allocator = allocator;
+#ifdef CC_POOL_NODES
+  cc_pool_init( &new_cntr->pool );
+#endif
+  return new_cntr;
+}
+
+// Allocates a node with space for an element of size el_size, from the list's pool if CC_POOL_NODES is defined.
+// The list must not be a placeholder.
+// Returns a pointer to the node, or NULL in the case of allocation failure.
+static inline cc_listnode_hdr_ty *cc_list_alloc_node(
+  void *cntr,
+  size_t el_size,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+#ifdef CC_POOL_NODES
+  return (cc_listnode_hdr_ty *)cc_pool_alloc(
+    &cc_list_hdr( cntr )->pool,
+    sizeof( cc_listnode_hdr_ty ) + el_size,
+    cc_list_hdr( cntr )->allocator,
+    realloc_
+  );
+#else
+  return (cc_listnode_hdr_ty *)cc_allocator_realloc(
+    cc_list_hdr( cntr )->allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_listnode_hdr_ty ) + el_size
+  );
+#endif
+}
+
+// Frees a node allocated by cc_list_alloc_node, returning it to the list's pool if CC_POOL_NODES is defined.
+static inline void cc_list_free_node(
+  void *cntr,
+  cc_listnode_hdr_ty *node,
+  cc_free_fnptr_ty free_
+)
+{
+#ifdef CC_POOL_NODES
+  (void)free_;
+  cc_pool_free( &cc_list_hdr( cntr )->pool, node );
+#else
+  cc_allocator_free( cc_list_hdr( cntr )->allocator, free_, node );
+#endif
+}
+
+// Attaches a node to the list before the node pointed to by the specified pointer-iterator.
+static inline void cc_list_attach(
+  void *cntr,
+  void *itr,
+  cc_listnode_hdr_ty *node
+)
+{
+  // Handle r_end and end pointer-iterators as a special case.
+  // We need to convert the pointer-iterator from the global placeholder's r_end or end to the local r_end or end.
+  if( itr == cc_list_r_end( cntr ) )
+    itr = cc_list_el( &cc_list_hdr( cntr )->r_end );
+  else if( itr == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
+    itr = cc_list_el( &cc_list_hdr( cntr )->end );
+
+  // Link node.
+  node->next = cc_listnode_hdr( itr );
+  node->prev = node->next->prev;
+  node->next->prev = node;
+  node->prev->next = node;
+}
+
+// Inserts an element into the list before the node pointed to by a given pointer-iterator.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer-iterator to the newly inserted
+// element (or NULL in the case of allocation failure).
+static inline cc_allocing_fn_result_ty cc_list_insert(
+  void *cntr,
+  void *el,
+  void *key, // Pointer to void pointer-iterator.
+  CC_UNUSED( bool, replace ),
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
+  CC_UNUSED( double, max_load ),
+  CC_UNUSED( cc_dtor_fnptr_ty, el_dtor ),
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  if( cc_list_is_placeholder( cntr ) )
+  {
+    void *new_cntr = cc_list_alloc_hdr( cntr, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    cntr = new_cntr;
+  }
+
+  cc_listnode_hdr_ty *new_node = cc_list_alloc_node( cntr, el_size, realloc_ );
+  if( CC_UNLIKELY( !new_node ) )
+    return cc_make_allocing_fn_result( cntr, NULL );
+
+  memcpy( cc_list_el( new_node ), el, el_size );
+
+  // Handle r_end and end pointer-iterators as a special case.
+  // We need to convert the pointer-iterator from the associated placeholder's r_end or end to the local r_end or end.
+  if( *(void **)key == cc_list_r_end( cntr ) )
+    *(void **)key = cc_list_el( &cc_list_hdr( cntr )->r_end );
+  else if( *(void **)key == cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
+    *(void **)key = cc_list_el( &cc_list_hdr( cntr )->end );
+
+  cc_list_attach( cntr, *(void **)key, new_node );
+
+  ++cc_list_hdr( cntr )->size;
+
+  return cc_make_allocing_fn_result( cntr, cc_list_el( new_node ) );  
+}
+
+static inline cc_allocing_fn_result_ty cc_list_push(
+  void *cntr,
+  void *el,
+  size_t el_size,
+  CC_UNUSED( double, growth ),
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  return cc_list_insert(
+    cntr,
+    el,
+    &CC_MAKE_LVAL_COPY( void *, cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) ),
+    false,    // Dummy.
+    el_size,
+    0,        // Dummy.
+    NULL,     // Dummy.
+    NULL,     // Dummy.
+    0.0,      // Dummy.
+    NULL,     // Dummy.
+    NULL,     // Dummy.
+    realloc_,
+    NULL      // Dummy.
+  );
+}
+
+// Erases the element pointed to by a given pointer-iterator and returns a pointer-iterator to next element (or end if
+// the element was the last element in the list).
+static inline void *cc_list_erase(
+  void *cntr,
+  void *key, // Pointer to void pointer-iterator.
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout ),
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_listnode_hdr_ty *hdr = cc_listnode_hdr( *(void **)key );
+  cc_listnode_hdr_ty *next = hdr->next;
+  hdr->prev->next = next;
+  next->prev = hdr->prev;
+  
+  if( el_dtor )
+    el_dtor( *(void **)key );
+
+  cc_list_free_node( cntr, hdr, free_ );
+  --cc_list_hdr( cntr )->size;
+
+  // If next is end, we need to make sure we're returning the associated placeholder's end.
+  if( next == &cc_list_hdr( cntr )->end )
+    next = next->next;
+
+  return cc_list_el( next );
+}
+
+// Removes the element pointed to by pointer-iterator src_itr from the source list and attaches it to the list before
+// pointer-iterator itr.
+// Although this function never allocates memory for the element/node itself, it must allocate the list's header if the
+// list is currently a placeholder.
+// The exception is when src is a different list that does not share the same allocator or, if CC_POOL_NODES is
+// defined, simply a different list, in which case the node belongs to the source list's allocator or pool and the
+// element must therefore be moved into a new node allocated for this list.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline cc_allocing_fn_result_ty cc_list_splice(
+  void *cntr,
+  void *itr,
+  void *src,
+  void *src_itr,
+  size_t el_size,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  if( cc_list_is_placeholder( cntr ) )
+  {
+    void *new_cntr = cc_list_alloc_hdr( cntr, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    cntr = new_cntr;
+  }
+
+  cc_listnode_hdr_ty *node = cc_listnode_hdr( src_itr );
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+
+#ifdef CC_POOL_NODES
+  if( src != cntr )
+#else
+  if( cc_list_hdr( src )->allocator != cc_list_hdr( cntr )->allocator )
+#endif
+  {
+    cc_listnode_hdr_ty *new_node = cc_list_alloc_node( cntr, el_size, realloc_ );
+    if( CC_UNLIKELY( !new_node ) )
+    {
+      // Restore the node's links in the source list.
+      node->prev->next = node;
+      node->next->prev = node;
+      return cc_make_allocing_fn_result( cntr, NULL );
+    }
+
+    memcpy( cc_list_el( new_node ), src_itr, el_size );
+    cc_list_free_node( src, node, free_ );
+    node = new_node;
+  }
+
+  cc_list_attach( cntr, itr, node );
+
+  --cc_list_hdr( src )->size;
+  ++cc_list_hdr( cntr )->size;
+
+  return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+}
+
+// Erases all elements, calling their destructors if necessary.
+// If CC_POOL_NODES is defined, the nodes are not freed individually but rather returned to the pool en masse.
+// Likewise, if the list's allocator does not free memory piece by piece, the nodes are simply abandoned.
+static inline void cc_list_clear(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+#ifndef CC_POOL_NODES
+  if( cc_allocator_frees( cc_list_hdr( cntr )->allocator ) ) // Also handles placeholder.
+  {
+    while( cc_list_first( cntr, 0 /* Dummy */, 0 /* Dummy */ ) != cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
+      cc_list_erase(
+        cntr,
+        &CC_MAKE_LVAL_COPY( void *, cc_list_first( cntr, 0 /* Dummy */, 0 /* Dummy */ ) ),
+        0,       // Dummy.
+        0,       // Dummy.
+        NULL,    // Dummy.
+        NULL,    // Dummy.
+        el_dtor,
+        NULL,    // Dummy.
+        free_
+      );
+
+    return;
+  }
+#else
+  (void)free_;
+#endif
+
+  if( cc_list_is_placeholder( cntr ) )
+    return;
+
+  if( el_dtor )
+    for(
+      void *itr = cc_list_first( cntr, 0 /* Dummy */, 0 /* Dummy */ );
+      itr != cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ );
+      itr = cc_list_next( cntr, itr, 0 /* Dummy */, 0 /* Dummy */ )
+    )
+      el_dtor( itr );
+
+  cc_list_hdr( cntr )->r_end.next = &cc_list_hdr( cntr )->end;
+  cc_list_hdr( cntr )->end.prev = &cc_list_hdr( cntr )->r_end;
+  cc_list_hdr( cntr )->size = 0;
+#ifdef CC_POOL_NODES
+  cc_pool_reset( &cc_list_hdr( cntr )->pool );
+#endif
+}
+
+// Erases all elements, calling their destructors if necessary, and frees the memory for the list's header if it is not
+// a placeholder.
+static inline void cc_list_cleanup(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_list_clear( cntr, 0 /* Dummy */, 0 /* Dummy */, el_dtor, NULL /* Dummy */, free_ );
+
+  if( !cc_list_is_placeholder( cntr ) )
+  {
+#ifdef CC_POOL_NODES
+    cc_pool_cleanup( &cc_list_hdr( cntr )->pool, cc_list_hdr( cntr )->allocator, free_ );
+#endif
+    cc_allocator_free( cc_list_hdr( cntr )->allocator, free_, cntr );
+  }
+}
+
+// If CC_POOL_NODES is defined, the allocated memory includes free nodes and the uncarved remainders of slabs.
+static inline cc_mem_usage cc_list_memory_usage( void *cntr, size_t el_size, CC_UNUSED( uint64_t, layout ) )
+{
+  if( cc_list_is_placeholder( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+#ifdef CC_POOL_NODES
+  size_t nodes_size = cc_pool_allocated( &cc_list_hdr( cntr )->pool, sizeof( cc_listnode_hdr_ty ) + el_size );
+#else
+  size_t nodes_size = ( sizeof( cc_listnode_hdr_ty ) + el_size ) * cc_list_size( cntr );
+#endif
+
+  return cc_make_mem_usage( sizeof( cc_list_hdr_ty ) + nodes_size, el_size * cc_list_size( cntr ) );
+}
+
+// Initializes a list that allocates its memory via the specified allocator.
+// The list's header is allocated immediately so that it can store the pointer to the allocator.
+// Returns a pointer to the new list, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_list_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_list_alloc_hdr( (void *)&cc_list_placeholder, allocator, NULL /* Unused */ );
+}
+
+// Initializes a shallow copy of the source list.
+// This requires allocating memory for every node, as well as for the list's header unless src is a placeholder.
+// The new list uses the same allocator as the source list.
+// Returns a pointer to the copy, or NULL in the case of allocation failure.
+// That return value is cast to bool in the corresponding macro.
+static inline void *cc_list_init_clone(
+  void *src,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_allocing_fn_result_ty result = { (void *)&cc_list_placeholder, cc_dummy_true_ptr };
+
+  if( cc_list_hdr( src )->allocator )
+  {
+    result.new_cntr = cc_list_init_with_allocator( cc_list_hdr( src )->allocator, el_size, 0 /* Dummy */ );
+    if( CC_UNLIKELY( !result.new_cntr ) )
+      return NULL;
+  }
+
+  for(
+    void *i = cc_list_first( src, 0 /* Dummy */, 0 /* Dummy */ );
+    i != cc_list_end( src, 0 /* Dummy */, 0 /* Dummy */ );
+    i = cc_list_next( src, i, 0 /* Dummy */, 0 /* Dummy */ )
+  )
+  {
+    result = cc_list_insert(
+      result.new_cntr,
+      i,
+      &CC_MAKE_LVAL_COPY(
+        void *,
+        cc_list_end( result.new_cntr, 0 /* Dummy */, 0 /* Dummy */ )
+      ),
+      false,    // Dummy.
+      el_size,
+      0,        // Dummy.
+      NULL,     // Dummy.
+      NULL,     // Dummy.
+      0.0,      // Dummy.
+      NULL,     // Dummy.
+      NULL,     // Dummy.
+      realloc_,
+      NULL      // Dummy.
+    );
+
+    if( !result.other_ptr )
+    {
+      // Erase incomplete clone without invoking destructors.
+      
+      cc_list_cleanup( result.new_cntr, 0 /* Dummy */, 0 /* Dummy */, NULL /* No destructor */, NULL, free_ );
+
+      return NULL;
+    }
+  }
+
+  return result.new_cntr;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                        Map                                                         */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// cc_map implements Verstable (https://github.com/JacksonAllan/Verstable) within the constraints of the CC API.
+// As explained in its documentation, Verstable is an open-addressing hash table using quadratic probing and the
+// following additions:
+//
+// * All keys that hash (i.e. "belong") to the same bucket (their "home bucket") are linked together by an 11-bit
+//   integer specifying the quadratic displacement, relative to that bucket, of the next key in the chain.
+// * If a chain of keys exists for a given bucket, then it always begins at that bucket. To maintain this policy, a
+//   1-bit flag is used to mark whether the key occupying a bucket belongs there. When inserting a new key, if the
+//   bucket it belongs to is occupied by a key that does not belong there, then the occupying key is evicted and the new
+//   key takes the bucket.
+// * A 4-bit fragment of each key's hash code is also stored.
+// * The aforementioned metadata associated with each bucket (the 4-bit hash fragment, the 1-bit flag, and the 11-bit
+//   link to the next key in the chain) are stored together in a uint16_t array rather than in the bucket alongside the
+//   key and (optionally) the value.
+//
+// One way to conceptualize this scheme is as a chained hash table in which overflowing keys are stored not in separate
+// memory allocations but in otherwise unused buckets. In this regard, it shares similarities with Malte Skarupke's
+// Bytell hash table (https://www.youtube.com/watch?v=M2fKMP47slQ) and traditional "coalesced hashing".
+//
+// Advantages of this scheme include:
+//
+// * Fast lookups impervious to load factor: If the table contains any key belonging to the lookup key's home bucket,
+//   then that bucket contains the first in a traversable chain of all keys belonging to it. Hence, only the home bucket
+//   and other buckets containing keys belonging to it are ever probed. Moreover, the stored hash fragments allow
+//   skipping most non-matching keys in the chain without accessing the actual buckets array or calling the (potentially
+//   expensive) key comparison function.
+// * Fast insertions: Insertions are faster than they are in other schemes that move keys around (e.g. Robin Hood)
+//   because they only move, at most, one existing key.
+// * Fast, tombstone-free deletions: Deletions, which usually require tombstones in quadratic-probing hash tables, are
+//   tombstone-free and only move, at most, one existing key.
+// * Fast iteration: The separate metadata array allows keys in sparsely populated tables to be found without incurring
+//   the frequent cache misses that would result from traversing the buckets array.
+//
+// Adapting Verstable to the CC API necessitates some compromises, including:
+//
+// * Slower iteration: As a pointer-iterator in CC cannot store a pointer to the metadatum associated with the bucket to
+//   which it points, the metadatum's address must be calculated every iteration.
+// * Slower iterator-based erasure: As CC pointer-iterators cannot store a key's home bucket, CC must rehash the key
+//   being deleted in cases wherein Verstable does not need to.
+
+// Masks for manipulating and extracting data from a bucket's uint16_t metadatum.
+#define CC_MAP_EMPTY               0x0000
+#define CC_MAP_HASH_FRAG_MASK      0xF000 // 0b1111000000000000.
+#define CC_MAP_IN_HOME_BUCKET_MASK 0x0800 // 0b0000100000000000.
+#define CC_MAP_DISPLACEMENT_MASK   0x07FF // 0b0000011111111111, also denotes the displacement limit. Set to CC_LOAD to
+                                          // 1.0 to test proper handling of encroachment on the displacement limit
+                                          // during inserts.
+
+// Extracts a hash fragment from a uint64_t hash code.
+// We take the highest four bits so that keys that map (via modulo) to the same bucket have distinct hash fragments.
+static inline uint16_t cc_hash_frag( size_t hash )
+{
+  return ( hash >> ( sizeof( size_t ) - sizeof( uint16_t ) ) * CHAR_BIT ) & CC_MAP_HASH_FRAG_MASK;
+}
+
+// Standard quadratic probing formula that guarantees that all buckets are visited when the bucket count is a power of
+// two (at least in theory, because the displacement limit could terminate the search early when the bucket count is
+// high).
+static inline size_t cc_quadratic( uint16_t displacement )
+{
+  return ( (size_t)displacement * displacement + displacement ) / 2;
+}
+
+// Group scanning:
+// Iteration, rehashing, and clearing scan the metadata array for occupied buckets in groups of CC_MAP_GROUP_SIZE
+// metadata, read as a single uint64_t.
+// cc_map_group_occupied returns a mask that is nonzero if any bucket in the group is occupied, and cc_map_group_first
+// extracts the index, within the group, of the first occupied bucket from a nonzero mask.
+// Note that lookups, insertions, and erasures cannot benefit from group scanning in the same way because the keys in a
+// chain are linked via quadratic displacements and therefore do not occupy contiguous buckets.
+// Instead, the hash fragment stored in each metadatum already allows those operations to skip nonmatching keys with a
+// single comparison per link.
+
+#define CC_MAP_GROUP_SIZE 4
+typedef uint64_t cc_map_group_mask_ty;
+
+static inline cc_map_group_mask_ty cc_map_group_occupied( const uint16_t *metadata )
+{
+  uint64_t group;
+  memcpy( &group, metadata, sizeof( uint64_t ) );
+  return group;
+}
+
+static inline int cc_map_group_first( cc_map_group_mask_ty mask )
+{
+  return cc_first_nonzero_uint16( mask );
+}
+
+// The number of excess metadata allocated after the metadata array.
+// This number must be at least CC_MAP_GROUP_SIZE.
+#define CC_MAP_METADATA_EXCESS 4
+
+#define CC_MAP_MIN_NONZERO_BUCKET_COUNT 8 // Must be a power of two.
+
+// Flat tables:
+// If CC_FLAT_SMALL_MAPS is defined, a table whose bucket count is at most CC_MAP_FLAT_MAX_BUCKET_COUNT is flat, i.e.
+// its key-element pairs occupy the first size buckets, in insertion order (except where erasures have moved pairs),
+// and lookups compare the key with each of them in turn instead of hashing it and traversing a chain.
+// Each occupied bucket's metadatum marks it as the sole key-element pair in its chain, so iteration, clearing,
+// cloning, and snapshots work on flat tables unchanged.
+// A flat table can be filled completely, irrespective of the max load factor.
+// Once it is full, the next insertion rehashes it into a larger, ordinary table, and a shrink or reserve that leaves
+// the bucket count at or below the limit rehashes it back into a flat table.
+// Hash codes are only computed when a flat table is rehashed into an ordinary one or, if hash codes are cached for the
+// key type, upon insertion.
+#define CC_MAP_FLAT_MAX_BUCKET_COUNT 16
+
+#ifdef CC_STATS
+
+// Event counters stored in the map header if CC_STATS is defined (see cc_stats for their meanings).
+typedef struct
+{
+  size_t evictions;
+  size_t rehashes;
+  size_t rehash_retries;
+  size_t migrations;
+} cc_map_counters_ty;
+
+#endif
+
+// Map header.
+typedef struct
+{
+  alignas( cc_max_align_ty )
+  size_t size;
+  size_t cap_mask; // Rather than storing the capacity (i.e. bucket count) directly, we store the bit mask used to
+                   // reduce a hash code or displacement-derived bucket index to the buckets array, i.e. the capacity
+                   // minus one.
+                   // Consequently, a zero bucket count (i.e. a placeholder map) constitutes a special case, represented
+                   // by all bits unset (i.e. zero).
+  uint16_t *metadata; // As described above, each metadatum consists of a 4-bit hash-code fragment (X), a 1-bit flag
+                      // indicating whether the key in this bucket begins a chain associated with the bucket (Y), and
+                      // an 11-bit value indicating the quadratic displacement of the next key in the chain (Z):
+                      // XXXXYZZZZZZZZZZZ.
+                      // The metadata array lives in the same allocation as the header and buckets array, but we
+                      // store a pointer to it to avoid constantly recalculating its offset.
+  cc_allocator *allocator;
+#ifdef CC_INCREMENTAL_REHASH
+  void *old_cntr;          // The smaller table from which key-element pairs are still being migrated, or NULL.
+  size_t migration_bucket; // All buckets in the old table before this one are empty.
+#endif
+#ifdef CC_STATS
+  cc_map_counters_ty counters; // Carried over from table to table as the map grows.
+#endif
+} cc_map_hdr_ty;
+
+// The header must fit in the reserved slot of a snapshot record (see CC_SNAPSHOT_SLOT_SIZE).
+typedef char cc_map_hdr_fits_snapshot_slot[ sizeof( cc_map_hdr_ty ) <= CC_SNAPSHOT_SLOT_SIZE ? 1 : -1 ];
+
+// In the case of maps, this placeholder allows us to avoid checking for a NULL handle inside functions.
+// Setting the placeholder's metadata pointer to point to a CC_MAP_EMPTY placeholder, rather than NULL, allows us to
+// avoid checking for a zero bucket count during insertion and lookup.
+// The placeholder metadata span a whole group so that a group scan of them never reads out of bounds.
+static const uint16_t cc_map_placeholder_metadata[ CC_MAP_METADATA_EXCESS ] = { CC_MAP_EMPTY };
+static const cc_map_hdr_ty cc_map_placeholder = {
+  0,
+  0x0000000000000000ull,
+  (uint16_t *)cc_map_placeholder_metadata,
+  NULL
+#ifdef CC_INCREMENTAL_REHASH
+  ,
+  NULL,
+  0
+#endif
+#ifdef CC_STATS
+  ,
+  { 0, 0, 0, 0 }
+#endif
+};
+
+static inline cc_map_hdr_ty *cc_map_hdr( void *cntr )
+{
+  return (cc_map_hdr_ty *)cntr;
+}
+
+static inline size_t cc_map_size( void *cntr )
+{
+#ifdef CC_INCREMENTAL_REHASH
+  if( cc_map_hdr( cntr )->old_cntr )
+    return cc_map_hdr( cntr )->size + cc_map_hdr( cc_map_hdr( cntr )->old_cntr )->size;
+#endif
+
+  return cc_map_hdr( cntr )->size;
+}
+
+static inline size_t cc_map_cap( void *cntr )
+{
+  // If the capacity is zero, cap_mask will be zero, not the capacity minus one.
+  // We account for this special case by adding (bool)cap_mask rather than one.
+  return cc_map_hdr( cntr )->cap_mask + (bool)cc_map_hdr( cntr )->cap_mask;
+}
+
+static inline bool cc_map_is_placeholder( void *cntr )
+{
+  return !cc_map_hdr( cntr )->cap_mask;
+}
+
+// Returns true if the table is flat (see CC_MAP_FLAT_MAX_BUCKET_COUNT above).
+// A placeholder is not flat.
+static inline bool cc_map_is_flat( void *cntr )
+{
+#ifdef CC_FLAT_SMALL_MAPS
+  return cc_map_hdr( cntr )->cap_mask && cc_map_hdr( cntr )->cap_mask < CC_MAP_FLAT_MAX_BUCKET_COUNT;
+#else
+  (void)cntr;
+  return false;
+#endif
+}
+
+// The distance between the elements in consecutive buckets.
+#define CC_MAP_EL_STRIDE( el_size, layout )                                        \
+( CC_HAS_SEPARATE_KEYS( layout ) ? (el_size) : CC_BUCKET_SIZE( el_size, layout ) ) \
+
+static inline void *cc_map_el(
+  void *cntr,
+  size_t bucket,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return (char *)cntr + sizeof( cc_map_hdr_ty ) + CC_MAP_EL_STRIDE( el_size, layout ) * bucket;
+}
+
+static inline void *cc_map_key(
+  void *cntr,
+  size_t bucket,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  // Separately stored keys follow the elements array.
+  if( CC_HAS_SEPARATE_KEYS( layout ) )
+    return (char *)cc_map_el( cntr, cc_map_cap( cntr ), el_size, layout ) + CC_KEY_SIZE( layout ) * bucket;
+
+  return (char *)cc_map_el( cntr, bucket, el_size, layout ) + CC_KEY_OFFSET( el_size, layout );
+}
+
+// Copies the key-element pair in bucket src to bucket dest.
+static inline void cc_map_copy_bucket(
+  void *cntr,
+  size_t dest,
+  size_t src,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  if( CC_HAS_SEPARATE_KEYS( layout ) )
+  {
+    memcpy( cc_map_el( cntr, dest, el_size, layout ), cc_map_el( cntr, src, el_size, layout ), el_size );
+    memcpy(
+      cc_map_key( cntr, dest, el_size, layout ),
+      cc_map_key( cntr, src, el_size, layout ),
+      CC_KEY_SIZE( layout )
+    );
+    return;
+  }
+
+  memcpy(
+    cc_map_el( cntr, dest, el_size, layout ),
+    cc_map_el( cntr, src, el_size, layout ),
+    CC_BUCKET_SIZE( el_size, layout )
+  );
+}
+
+// Returns the hash code of the key in the specified bucket.
+// If hash codes are cached, the code is read from the bucket rather than recomputed via the hash function.
+static inline size_t cc_map_bucket_hash(
+  void *cntr,
+  size_t bucket,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash
+)
+{
+  if( !CC_HAS_CACHED_HASH( layout ) )
+    return hash( cc_map_key( cntr, bucket, el_size, layout ) );
+
+  size_t key_hash;
+  memcpy(
+    &key_hash,
+    (char *)cc_map_el( cntr, bucket, el_size, layout ) + CC_CACHED_HASH_OFFSET( el_size, layout ),
+    sizeof( size_t )
+  );
+  return key_hash;
+}
+
+// Stores the hash code of the key in the specified bucket if hash codes are cached.
+static inline void cc_map_cache_hash(
+  void *cntr,
+  size_t bucket,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  if( CC_HAS_CACHED_HASH( layout ) )
+    memcpy(
+      (char *)cc_map_el( cntr, bucket, el_size, layout ) + CC_CACHED_HASH_OFFSET( el_size, layout ),
+      &key_hash,
+      sizeof( size_t )
+    );
+}
+
+// Returns false if hash codes are cached and the key in the specified bucket does not have the specified hash code.
+// Checking this before calling the comparison function saves most calls of the latter on mismatching keys whose hash
+// codes happen to share a hash fragment.
+static inline bool cc_map_cached_hash_may_match(
+  void *cntr,
+  size_t bucket,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return !CC_HAS_CACHED_HASH( layout ) ||
+    cc_map_bucket_hash( cntr, bucket, el_size, layout, NULL /* Unused */ ) == key_hash;
+}
+
+static inline size_t cc_map_bucket_index_from_itr( void *cntr, void *itr, size_t el_size, uint64_t layout )
+{
+  return ( (char *)itr - (char *)cc_map_el( cntr, 0, el_size, layout ) ) / CC_MAP_EL_STRIDE( el_size, layout );
+}
+
+// Returns the table containing the bucket to which itr points, i.e. the map itself or, if CC_INCREMENTAL_REHASH is
+// defined, possibly its old table.
+static inline void *cc_map_table_for_itr( void *cntr, void *itr, size_t el_size, uint64_t layout )
+{
+#ifdef CC_INCREMENTAL_REHASH
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if(
+    old_cntr &&
+    (char *)itr >= (char *)cc_map_el( old_cntr, 0, el_size, layout ) &&
+    (char *)itr < (char *)cc_map_el( old_cntr, cc_map_cap( old_cntr ), el_size, layout )
+  )
+    return old_cntr;
+#else
+  (void)itr;
+  (void)el_size;
+  (void)layout;
+#endif
+
+  return cntr;
+}
+
+static inline void *cc_map_key_for(
+  void *cntr,
+  void *itr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  if( CC_HAS_SEPARATE_KEYS( layout ) )
+  {
+    void *table = cc_map_table_for_itr( cntr, itr, el_size, layout );
+    return cc_map_key( table, cc_map_bucket_index_from_itr( table, itr, el_size, layout ), el_size, layout );
+  }
+
+  return (char *)itr + CC_KEY_OFFSET( el_size, layout );
+}
+
+static inline size_t cc_map_min_cap_for_n_els(
+  size_t n,
+  double max_load
+)
+{
+  if( n == 0 )
+    return 0;
+
+  // Round up to a power of two.
+  size_t cap = CC_MAP_MIN_NONZERO_BUCKET_COUNT;
+
+  while( n > cap * max_load )
+    cap *= 2;
+
+  return cap;
+}
+
+// Returns the index of the first occupied bucket at or after the specified bucket, or the bucket count if there is no
+// such bucket.
+// The map must not be a placeholder because the search relies on the iteration stopper at the end of the metadata
+// array.
+// This function scans CC_MAP_GROUP_SIZE buckets at a time.
+static inline size_t cc_map_first_occupied( void *cntr, size_t bucket )
+{
+  while( true )
+  {
+    cc_map_group_mask_ty mask = cc_map_group_occupied( cc_map_hdr( cntr )->metadata + bucket );
+    if( mask )
+      return bucket + cc_map_group_first( mask );
+
+    bucket += CC_MAP_GROUP_SIZE;
+  }
+}
+
+// Calculates the metadata array offset and total allocation size for a map with a given non-zero capacity.
+// The data is organized in memory as follows:
+//   +--------+-----------------------------+-----+----------------+--------+
+//   | Header |           Buckets           | Pad |    Metadata    | Excess |
+//   +--------+-----------------------------+-----+----------------+--------+
+// The metadata array requires CC_MAP_METADATA_EXCESS excess elements to ensure that group scanning, which reads
+// CC_MAP_GROUP_SIZE metadata at a time, never reads beyond the end of it.
+static inline void cc_map_allocation_details(
+  size_t cap,
+  size_t el_size,
+  uint64_t layout,
+  size_t *metadata_offset,
+  size_t *allocation_size
+)
+{
+  size_t buckets_size = CC_BUCKET_SIZE( el_size, layout ) * cap;
+  *metadata_offset = sizeof( cc_map_hdr_ty ) + buckets_size + CC_PADDING( buckets_size, alignof( uint16_t ) );
+  *allocation_size = *metadata_offset + sizeof( uint16_t ) * ( cap + CC_MAP_METADATA_EXCESS );
+}
+
+// Finds the earliest empty bucket in which a key-element pair belonging to home_bucket can be placed, assuming that
+// home_bucket is already occupied.
+// The reason to begin the search at home_bucket, rather than the end of the existing chain, is that key-element pairs
+// deleted from other chains might have freed up buckets that could fall in this chain before the final key.
+// Returns true if an empty bucket within the range of the displacement limit was found, in which case the final two
+// pointer arguments contain the index of the empty bucket and its quadratic displacement from home_bucket.
+static inline bool cc_map_find_first_empty(
+  void *cntr,
+  size_t home_bucket,
+  size_t *empty,
+  uint16_t *displacement
+)
+{
+  *displacement = 1;
+  size_t linear_dispacement = 1;
+
+  while( true )
+  {
+    *empty = ( home_bucket + linear_dispacement ) & cc_map_hdr( cntr )->cap_mask;
+    if( cc_map_hdr( cntr )->metadata[ *empty ] == CC_MAP_EMPTY )
+      return true;
+
+    if( CC_UNLIKELY( ++*displacement == CC_MAP_DISPLACEMENT_MASK ) )
+      return false;
+
+    linear_dispacement += *displacement;
+  }
+}
+
+// Finds the key-element pair in the chain beginning in home_bucket after which to link a new key-element pair with
+// displacement_to_empty quadratic displacement and returns the index of the bucket containing that key-element pair.
+// Although the new key-element pair could simply be linked to the end of the chain, keeping the chain ordered by
+// displacement theoretically improves cache locality during lookups.
+static inline size_t cc_map_find_insert_location_in_chain(
+  void *cntr,
+  size_t home_bucket,
+  uint16_t displacement_to_empty
+)
+{
+  size_t candidate = home_bucket;
+  while( true )
+  {
+    uint16_t displacement = cc_map_hdr( cntr )->metadata[ candidate ] & CC_MAP_DISPLACEMENT_MASK;
+
+    if( displacement > displacement_to_empty )
+      return candidate;
+
+    candidate = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+  }
+}
+
+// Moves the key-element pair in the specified bucket, which belongs to the chain beginning in home_bucket but is not
+// the first in that chain, to the empty bucket with the specified quadratic displacement from home_bucket.
+// This requires:
+// * Finding the previous key-element pair in the chain by traversing the chain.
+// * Disconnecting the key-element pair from the chain.
+// * Moving the key-element pair to the empty bucket.
+// * Re-linking the key-element pair to the chain.
+static inline void cc_map_move_to_empty(
+  void *cntr,
+  size_t bucket,
+  size_t home_bucket,
+  size_t empty,
+  uint16_t displacement,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  // Find the previous key-element pair in chain.
+  size_t prev = home_bucket;
+  while( true )
+  {
+    size_t next = ( home_bucket + cc_quadratic( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK ) ) &
+      cc_map_hdr( cntr )->cap_mask;
+
+    if( next == bucket )
+      break;
+
+    prev = next;
+  }
+
+  // Disconnect the key-element pair from chain.
+  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
+    ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK );
+
+  // Find the key-element pair in the chain after which to link the moved key-element pair.
+  prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+
+  // Move the key and element.
+  cc_map_copy_bucket( cntr, empty, bucket, el_size, layout );
+
+  // Re-link the key-element pair to the chain from its new bucket.
+  cc_map_hdr( cntr )->metadata[ empty ] = ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) |
+    ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK );
+  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
+    displacement;
+}
+
+// Frees up a bucket occupied by a key-element pair not belonging there so that a new key-element pair belonging there
+// can be placed there as the beginning of a new chain.
+// This requires rehashing the occupying key-element pair's key (unless its hash code is cached) to find its home
+// bucket, finding the appropriate empty bucket to which to move it, and moving it there via cc_map_move_to_empty.
+// Returns true if the eviction succeeded, or false, without modifying the map, if no empty bucket to which to evict the
+// occupying key-element pair could be found within the displacement limit.
+static inline bool cc_map_evict(
+  void *cntr,
+  size_t bucket,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash
+)
+{
+  size_t home_bucket = cc_map_bucket_hash( cntr, bucket, el_size, layout, hash ) & cc_map_hdr( cntr )->cap_mask;
+
+  // Find the empty bucket to which to move the key-element pair.
+  // The search need not wait until the key-element pair is disconnected from its chain because disconnecting it does
+  // not change which buckets are empty.
+  size_t empty;
+  uint16_t displacement;
+  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
+    return false;
+
+  cc_map_move_to_empty( cntr, bucket, home_bucket, empty, displacement, el_size, layout );
+
+#ifdef CC_STATS
+  ++cc_map_hdr( cntr )->counters.evictions;
+#endif
+
+  return true;
+}
+
+// Returns the bucket of a flat table that contains the specified key, or the table's size if no bucket does.
+static inline size_t cc_map_flat_find(
+  void *cntr,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  size_t bucket = 0;
+  while( bucket < cc_map_hdr( cntr )->size && !cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
+    ++bucket;
+
+  return bucket;
+}
+
+// Appends a key-element pair, whose key does not already exist, to a flat table that is not full.
+// Returns a pointer-iterator to the inserted element.
+static inline void *cc_map_flat_append(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash, // Only used if hash codes are cached.
+  size_t el_size,
+  uint64_t layout
+)
+{
+  size_t bucket = cc_map_hdr( cntr )->size++;
+
+  memcpy( cc_map_key( cntr, bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+  memcpy( cc_map_el( cntr, bucket, el_size, layout ), el, el_size );
+  cc_map_cache_hash( cntr, bucket, key_hash, el_size, layout );
+  cc_map_hdr( cntr )->metadata[ bucket ] = CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+
+  return cc_map_el( cntr, bucket, el_size, layout );
+}
+
+// Inserts a key-element pair into a flat table, given the bucket returned by cc_map_flat_find for the key.
+// Returns NULL if the key does not already exist and the table is full.
+static inline void *cc_map_flat_insert_at_bucket(
+  void *cntr,
+  size_t bucket,
+  void *el,
+  void *key,
+  size_t key_hash, // Only used if hash codes are cached.
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+  if( bucket < cc_map_hdr( cntr )->size )
+  {
+    if( replace )
+    {
+      if( key_dtor )
+        key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+
+      if( el_dtor )
+        el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+
+      memcpy( cc_map_key( cntr, bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+      memcpy( cc_map_el( cntr, bucket, el_size, layout ), el, el_size );
+    }
+
+    return cc_map_el( cntr, bucket, el_size, layout );
+  }
+
+  if( CC_UNLIKELY( bucket == cc_map_cap( cntr ) ) )
+    return NULL;
+
+  return cc_map_flat_append( cntr, el, key, key_hash, el_size, layout );
+}
+
+// The counterpart of cc_map_insert_raw_from_hash for flat tables.
+// Returns NULL if the key does not already exist and the table is full.
+static inline void *cc_map_flat_insert(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash, // Only used if hash codes are cached.
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+  return cc_map_flat_insert_at_bucket(
+    cntr,
+    cc_map_flat_find( cntr, key, el_size, layout, cmpr ),
+    el,
+    key,
+    key_hash,
+    replace,
+    el_size,
+    layout,
+    el_dtor,
+    key_dtor
+  );
+}
+
+// Inserts a key-element pair, optionally replacing the existing key-element pair containing the same key if it exists.
+// There are two main cases that must be handled:
+// * If the key-element pair's home bucket is empty or occupied by a key-element pair that does not belong there, then
+//   the key-element pair is inserted there, evicting the occupying key-element pair if there is one.
+// * Otherwise, the chain of key-element pairs beginning at the home bucket is traversed in search of a matching key.
+//   If none is found, then the new key-element pair is inserted at the earliest available bucket, per quadratic probing
+//   from the home bucket, and then linked to the chain in a manner that maintains its quadratic order.
+// The replace argument tells the function whether to replace an existing key-element pair.
+// If replace is true, the function returns a pointer-iterator to the inserted element, or NULL if the key-element pair
+// was not inserted because of the max load factor or displacement limit constraints.
+// If replace is false, then the return value is as described above, except that if the key already exists, the function
+// returns a pointer-iterator to the associated element.
+// The key's hash code, key_hash, has already been computed, so this function is the shared basis of
+// cc_map_insert_from_hash and cc_map_insert_n.
+static inline void *cc_map_insert_raw_from_hash(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash,
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  double max_load,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+  uint16_t hashfrag = cc_hash_frag( key_hash );
+  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+
+  // Case 1: The home bucket is empty or contains a key-element pair that doesn't belong there.
+  // This case also implicitly handles the case of a zero-capacity placeholder map, since home_bucket will be zero and
+  // metadata[ 0 ] will be the empty placeholder metadatum.
+  // In that scenario, the zero cap_mask triggers the below load-factor check.
+  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+  {
+    // Load-factor check.
+    if( CC_UNLIKELY( cc_map_hdr( cntr )->size + 1 > max_load * cc_map_cap( cntr ) ) )
+      return NULL;
+
+    // Vacate the home bucket if it contains a key-element pair.
+    if(
+      cc_map_hdr( cntr )->metadata[ home_bucket ] != CC_MAP_EMPTY &&
+      CC_UNLIKELY( !cc_map_evict( cntr, home_bucket, el_size, layout, hash ) )
+    )
+      return NULL;
+
+    memcpy( cc_map_key( cntr, home_bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+    memcpy( cc_map_el( cntr, home_bucket, el_size, layout ), el, el_size );
+    cc_map_cache_hash( cntr, home_bucket, key_hash, el_size, layout );
+    cc_map_hdr( cntr )->metadata[ home_bucket ] = hashfrag | CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+
+    ++cc_map_hdr( cntr )->size;
+
+    return cc_map_el( cntr, home_bucket, el_size, layout );
+  }
+
+  // Case 2: The home bucket contains the beginning of a chain.
+
+  // Check the existing chain.
+  size_t bucket = home_bucket;
+  while( true )
+  {
+    if(
+      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
+      cc_map_cached_hash_may_match( cntr, bucket, key_hash, el_size, layout ) &&
+      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
+    )
+    {
+      if( replace )
+      {
+        if( key_dtor )
+          key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+
+        if( el_dtor )
+          el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+
+        memcpy( cc_map_key( cntr, bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+        memcpy( cc_map_el( cntr, bucket, el_size, layout ), el, el_size );
+      }
+
+      return cc_map_el( cntr, bucket, el_size, layout );
+    }
+
+    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+    if( displacement == CC_MAP_DISPLACEMENT_MASK )
+      break;
+
+    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+  }
+
+  // Load-factor check.
+  if( CC_UNLIKELY( cc_map_hdr( cntr )->size + 1 > max_load * cc_map_cap( cntr ) ) )
+    return NULL;
+
+  // Find the earliest empty bucket, per quadratic probing.
+  size_t empty;
+  uint16_t displacement;
+  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
+    return NULL;
+
+  size_t prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+
+  // Insert the new key and element in the empty bucket and link it to the chain.
+
+  memcpy( cc_map_key( cntr, empty, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+  memcpy( cc_map_el( cntr, empty, el_size, layout ), el, el_size );
+  cc_map_cache_hash( cntr, empty, key_hash, el_size, layout );
+
+  cc_map_hdr( cntr )->metadata[ empty ] = hashfrag | ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK
+    );
+  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
+    displacement;
+
+  ++cc_map_hdr( cntr )->size;
+
+  return cc_map_el( cntr, empty, el_size, layout );
+}
+
+// Inserts a key-element pair whose key's hash code has already been computed, assuming that the key does not already
+// exist and that the map's capacity is large enough to accommodate it without violating the load factor constraint.
+// These conditions are met during map resizing and rehashing.
+// This function is the same as cc_map_insert_raw_from_hash, except that no load-factor check or check of the existing
+// chain is performed.
+// It returns a pointer-iterator to the inserted element, or NULL if the key-element pair was not inserted because of
+// the max load factor or displacement limit constraints.
+static inline void *cc_map_reinsert(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash
+)
+{
+  if( cc_map_is_flat( cntr ) )
+  {
+    if( CC_UNLIKELY( cc_map_hdr( cntr )->size == cc_map_cap( cntr ) ) )
+      return NULL;
+
+    return cc_map_flat_append( cntr, el, key, key_hash, el_size, layout );
+  }
+
+  uint16_t hashfrag = cc_hash_frag( key_hash );
+  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+
+  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+  {
+    if(
+      cc_map_hdr( cntr )->metadata[ home_bucket ] != CC_MAP_EMPTY &&
+      CC_UNLIKELY( !cc_map_evict( cntr, home_bucket, el_size, layout, hash ) )
+    )
+      return NULL;
+
+    memcpy( cc_map_key( cntr, home_bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+    memcpy( cc_map_el( cntr, home_bucket, el_size, layout ), el, el_size );
+    cc_map_cache_hash( cntr, home_bucket, key_hash, el_size, layout );
+    cc_map_hdr( cntr )->metadata[ home_bucket ] = hashfrag | CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+
+    ++cc_map_hdr( cntr )->size;
+
+    return cc_map_el( cntr, home_bucket, el_size, layout );
+  }
+
+  size_t empty;
+  uint16_t displacement;
+  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
+    return NULL;
+
+  size_t prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+
+  memcpy( cc_map_key( cntr, empty, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+  memcpy( cc_map_el( cntr, empty, el_size, layout ), el, el_size );
+  cc_map_cache_hash( cntr, empty, key_hash, el_size, layout );
+
+  cc_map_hdr( cntr )->metadata[ empty ] = hashfrag | ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK
+    );
+  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
+    displacement;
+
+  ++cc_map_hdr( cntr )->size;
+
+  return cc_map_el( cntr, empty, el_size, layout );
+}
+
+// Erases the key-element pair in the specified bucket.
+// The erasure always occurs at the end of the chain to which the key-element pair belongs.
+// If the key-element pair to be erased is not the last in the chain, it is swapped with the last so that erasure occurs
+// at the end.
+// This helps keep a chain's key-element pairs close to their home bucket for the sake of cache locality.
+// Returns true if, in the case of iteration from first to end, cc_map_next should now be called on the pointer-iterator
+// to find the next key-element pair.
+// This return value is necessary because at the iterator location, the erasure could result in an empty bucket, a
+// bucket containing a moved key-element pair already visited during the iteration, or a bucket containing a moved
+// key-element pair not yet visited.
+static inline bool cc_map_erase_raw(
+  void *cntr,
+  size_t erase_bucket,
+  size_t home_bucket, // SIZE_MAX if unknown.
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+  --cc_map_hdr( cntr )->size;
+
+  // In a flat table, the last key-element pair moves into the erased bucket.
+  if( cc_map_is_flat( cntr ) )
+  {
+    size_t last = cc_map_hdr( cntr )->size;
+
+    if( el_dtor )
+      el_dtor( cc_map_el( cntr, erase_bucket, el_size, layout ) );
+    if( key_dtor )
+      key_dtor( cc_map_key( cntr, erase_bucket, el_size, layout ) );
+
+    if( erase_bucket != last )
+      cc_map_copy_bucket( cntr, erase_bucket, last, el_size, layout );
+
+    cc_map_hdr( cntr )->metadata[ last ] = CC_MAP_EMPTY;
+    return erase_bucket == last;
+  }
+
+  // Case 1: The key-element pair is the only one in its chain, so just remove it.
+  if(
+    cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK &&
+    ( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK
+  )
+  {
+    if( el_dtor )
+      el_dtor( cc_map_el( cntr, erase_bucket, el_size, layout ) );
+    if( key_dtor )
+      key_dtor( cc_map_key( cntr, erase_bucket, el_size, layout ) );
+
+    cc_map_hdr( cntr )->metadata[ erase_bucket ] = CC_MAP_EMPTY;
+    return true;
+  }
+
+  // Case 2 and 3 require that we know the key-element pair's home bucket.
+  if( home_bucket == SIZE_MAX )
+  {
+    if( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK )
+      home_bucket = erase_bucket;
+    else
+      home_bucket = cc_map_bucket_hash( cntr, erase_bucket, el_size, layout, hash ) & cc_map_hdr( cntr )->cap_mask;
+  }
+
+  if( el_dtor )
+    el_dtor( cc_map_el( cntr, erase_bucket, el_size, layout ) );
+  if( key_dtor )
+    key_dtor( cc_map_key( cntr, erase_bucket, el_size, layout ) );
+
+  // Case 2: The key-element pair is the last in a chain containing multiple key-element pairs.
+  // Traverse the chain from the beginning and find the penultimate key-element pair.
+  // Then disconnect the key-element pair and erase.
+  if( ( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK )
+  {
+    size_t bucket = home_bucket;
+    while( true )
+    {
+      uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+      size_t next = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+      if( next == erase_bucket )
+      {
+        cc_map_hdr( cntr )->metadata[ bucket ] |= CC_MAP_DISPLACEMENT_MASK;
+        cc_map_hdr( cntr )->metadata[ erase_bucket ] = CC_MAP_EMPTY;
+        return true;
+      }
+
+      bucket = next;
+    }
+  }
+
+  // Case 3: The chain has multiple key-element pairs, and the key-element pair is not the last one.
+  // Traverse the chain from the key-element pair to be erased and find the last and penultimate key-element pairs.
+  // Disconnect the last key-element pair from the chain, and swap it with the key-element pair to erase.
+  size_t bucket = erase_bucket;
+  while( true )
+  {
+    size_t prev = bucket;
+    bucket = ( home_bucket + cc_quadratic( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK ) ) &
+      cc_map_hdr( cntr )->cap_mask;
+
+    if( ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK )
+    {
+      cc_map_copy_bucket( cntr, erase_bucket, bucket, el_size, layout );
+
+      cc_map_hdr( cntr )->metadata[ erase_bucket ] = ( cc_map_hdr( cntr )->metadata[ erase_bucket ] &
+        ~CC_MAP_HASH_FRAG_MASK ) | ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK );
+
+      cc_map_hdr( cntr )->metadata[ prev ] |= CC_MAP_DISPLACEMENT_MASK;
+      cc_map_hdr( cntr )->metadata[ bucket ] = CC_MAP_EMPTY;
+
+      // Whether a pointer-iterator pointing to erase_bucket should be advanced depends on whether the key-element pair
+      // moved to the erase_bucket came from before or after that bucket.
+      // In the former case, the iteration would already have hit the moved key-element pair, so the pointer-iterator
+      // should still be advanced.
+      if( bucket > erase_bucket )
+        return false;
+
+      return true;
+    }
+  }
+}
+
+// Reinserts all key-element pairs in the table src into the map cntr, which must be large enough to accommodate them
+// without violating the max load factor.
+// Returns false if a key-element pair could not be reinserted because of the displacement limit.
+static inline bool cc_map_reinsert_all(
+  void *cntr,
+  void *src,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash
+)
+{
+  if( !cc_map_hdr( src )->size ) // Also handles placeholder, which has no iteration stopper.
+    return true;
+
+  for(
+    size_t i = cc_map_first_occupied( src, 0 );
+    i < cc_map_cap( src );
+    i = cc_map_first_occupied( src, i + 1 )
+  )
+    if( CC_UNLIKELY( !cc_map_reinsert(
+      cntr,
+      cc_map_el( src, i, el_size, layout ),
+      cc_map_key( src, i, el_size, layout ),
+      cc_map_bucket_hash( src, i, el_size, layout, hash ),
+      el_size,
+      layout,
+      hash
+    ) ) )
+      return false;
+
+  return true;
+}
+
+#ifdef CC_PARALLEL_REHASH
+
+// Parallel rehashing and cloning:
+// If CC_PARALLEL_REHASH is defined, cc_map_make_rehash reinserts the key-element pairs of a large table into the new
+// table in two phases.
+// In the first phase, the buckets of both tables are divided into partitions by their indices modulo m, the smaller of
+// the two bucket counts, and each task handles the partition whose indices modulo m form one range of [ 0, m ).
+// Because both bucket counts are powers of two, a key's home bucket in either table is the same modulo m, so the task
+// that scans a source bucket is also the one that owns the new home bucket of almost every key-element pair in it.
+// The task places each such key-element pair in the new table, provided that doing so touches only buckets in its
+// partition.
+// Hence, every key-element pair in a partition belongs to a chain whose home bucket is in the same partition, and the
+// tasks never touch the same bucket or need to synchronize.
+// The key-element pairs that a task cannot place - i.e. those displaced across a partition boundary in the source table
+// or whose placement would cross such a boundary in the new table - are recorded in a bitmap of source buckets.
+// In the second phase, the calling thread reinserts the recorded key-element pairs normally.
+// As the partitions are large, the second phase typically handles only a tiny fraction of the key-element pairs.
+// Cloning simply divides the bitwise copy of the table into chunks.
+
+// The minimum number of buckets in each partition, and hence the minimum bucket count for which rehashing and cloning
+// occur in parallel (i.e. in at least two tasks).
+#define CC_MAP_PARALLEL_MIN_TASK_BUCKETS 65536
+
+// The maximum number of tasks into which to split rehashing or cloning.
+#define CC_MAP_PARALLEL_MAX_TASKS 256
+
+// Returns the number of tasks, a power of two, into which to split work on a table with the specified bucket count, or
+// 1 if the table is too small to benefit from parallelism.
+static inline size_t cc_map_parallel_task_count( size_t bucket_count )
+{
+  size_t task_count = bucket_count / CC_MAP_PARALLEL_MIN_TASK_BUCKETS;
+  if( task_count < 2 )
+    return 1;
+
+  return task_count < CC_MAP_PARALLEL_MAX_TASKS ? task_count : CC_MAP_PARALLEL_MAX_TASKS;
+}
+
+// The buckets whose indices modulo mask + 1 lie in [ first, first + size ).
+typedef struct
+{
+  size_t mask;
+  size_t first;
+  size_t size;
+} cc_map_partition_ty;
+
+static inline bool cc_map_in_partition( const cc_map_partition_ty *partition, size_t bucket )
+{
+  return ( ( bucket & partition->mask ) - partition->first ) < partition->size;
+}
+
+// Same as cc_map_find_first_empty, except that it returns false, without accessing the bucket, if the probing reaches a
+// bucket outside the partition.
+static inline bool cc_map_find_first_empty_in_partition(
+  void *cntr,
+  size_t home_bucket,
+  const cc_map_partition_ty *partition,
+  size_t *empty,
+  uint16_t *displacement
+)
+{
+  *displacement = 1;
+  size_t linear_dispacement = 1;
+
+  while( true )
+  {
+    *empty = ( home_bucket + linear_dispacement ) & cc_map_hdr( cntr )->cap_mask;
+    if( CC_UNLIKELY( !cc_map_in_partition( partition, *empty ) ) )
+      return false;
+
+    if( cc_map_hdr( cntr )->metadata[ *empty ] == CC_MAP_EMPTY )
+      return true;
+
+    if( CC_UNLIKELY( ++*displacement == CC_MAP_DISPLACEMENT_MASK ) )
+      return false;
+
+    linear_dispacement += *displacement;
+  }
+}
+
+// Same as cc_map_reinsert, except that it only touches buckets in the partition, does not update the map's size, and
+// returns a bool.
+// Returns false, without modifying the map, if the key-element pair's home bucket is outside the partition or placing
+// it would entail touching a bucket outside the partition or violating the displacement limit.
+// Chains are traversed without bounds checks because all the key-element pairs already in the partition belong to
+// chains that lie entirely within it.
+// Increments *evictions if an eviction was necessary.
+static inline bool cc_map_reinsert_in_partition(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  const cc_map_partition_ty *partition,
+  size_t *evictions
+)
+{
+  uint16_t hashfrag = cc_hash_frag( key_hash );
+  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+
+  if( !cc_map_in_partition( partition, home_bucket ) )
+    return false;
+
+  size_t empty;
+  uint16_t displacement;
+
+  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+  {
+    if( cc_map_hdr( cntr )->metadata[ home_bucket ] != CC_MAP_EMPTY )
+    {
+      size_t occupant_home_bucket = cc_map_bucket_hash( cntr, home_bucket, el_size, layout, hash ) &
+        cc_map_hdr( cntr )->cap_mask;
+
+      if( CC_UNLIKELY( !cc_map_find_first_empty_in_partition(
+        cntr,
+        occupant_home_bucket,
+        partition,
+        &empty,
+        &displacement
+      ) ) )
+        return false;
+
+      cc_map_move_to_empty( cntr, home_bucket, occupant_home_bucket, empty, displacement, el_size, layout );
+      ++*evictions;
+    }
+
+    memcpy( cc_map_key( cntr, home_bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+    memcpy( cc_map_el( cntr, home_bucket, el_size, layout ), el, el_size );
+    cc_map_cache_hash( cntr, home_bucket, key_hash, el_size, layout );
+    cc_map_hdr( cntr )->metadata[ home_bucket ] = hashfrag | CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+
+    return true;
+  }
+
+  if( CC_UNLIKELY( !cc_map_find_first_empty_in_partition( cntr, home_bucket, partition, &empty, &displacement ) ) )
+    return false;
+
+  size_t prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+
+  memcpy( cc_map_key( cntr, empty, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+  memcpy( cc_map_el( cntr, empty, el_size, layout ), el, el_size );
+  cc_map_cache_hash( cntr, empty, key_hash, el_size, layout );
+
+  cc_map_hdr( cntr )->metadata[ empty ] = hashfrag | ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK
+    );
+  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
+    displacement;
+
+  return true;
+}
+
+// The outcome of one rehashing task.
+typedef struct
+{
+  size_t placed;
+  size_t evictions;
+} cc_map_rehash_task_result_ty;
+
+// The shared context of the rehashing tasks.
+typedef struct
+{
+  void *cntr;
+  void *src;
+  size_t el_size;
+  uint64_t layout;
+  cc_hash_fnptr_ty hash;
+  size_t partition_mask;
+  size_t partition_size;
+  uint64_t *deferred;                    // Bitmap of the source buckets whose key-element pairs were not placed.
+  cc_map_rehash_task_result_ty *results; // One per task.
+} cc_map_rehash_task_ctx_ty;
+
+// Runs the first phase of parallel rehashing for one partition.
+// Since each partition contains whole ranges of at least CC_MAP_PARALLEL_MIN_TASK_BUCKETS buckets aligned to that size,
+// no two tasks write to the same word of the bitmap.
+static inline void cc_map_rehash_task( void *ctx_, size_t task )
+{
+  cc_map_rehash_task_ctx_ty *ctx = (cc_map_rehash_task_ctx_ty *)ctx_;
+  cc_map_partition_ty partition = { ctx->partition_mask, task * ctx->partition_size, ctx->partition_size };
+  cc_map_rehash_task_result_ty result = { 0, 0 };
+
+  for( size_t begin = partition.first; begin < cc_map_cap( ctx->src ); begin += partition.mask + 1 )
+    for(
+      size_t i = cc_map_first_occupied( ctx->src, begin );
+      i < begin + partition.size;
+      i = cc_map_first_occupied( ctx->src, i + 1 )
+    )
+    {
+      if( cc_map_reinsert_in_partition(
+        ctx->cntr,
+        cc_map_el( ctx->src, i, ctx->el_size, ctx->layout ),
+        cc_map_key( ctx->src, i, ctx->el_size, ctx->layout ),
+        cc_map_bucket_hash( ctx->src, i, ctx->el_size, ctx->layout, ctx->hash ),
+        ctx->el_size,
+        ctx->layout,
+        ctx->hash,
+        &partition,
+        &result.evictions
+      ) )
+        ++result.placed;
+      else
+        ctx->deferred[ i / 64 ] |= (uint64_t)1 << ( i % 64 );
+    }
+
+  ctx->results[ task ] = result;
+}
+
+// Same as cc_map_reinsert_all, except that it reinserts the key-element pairs in parallel if the tables are large
+// enough and cntr is empty.
+// If the memory for the bitmap and the task results cannot be allocated, the reinsertion falls back on
+// cc_map_reinsert_all.
+static inline bool cc_map_reinsert_all_in_parallel(
+  void *cntr,
+  void *src,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  size_t partition_mask = ( cc_map_cap( cntr ) < cc_map_cap( src ) ? cc_map_cap( cntr ) : cc_map_cap( src ) ) - 1;
+  size_t task_count = cc_map_parallel_task_count( partition_mask + 1 );
+  if( task_count == 1 || !cc_map_hdr( src )->size || cc_map_hdr( cntr )->size )
+    return cc_map_reinsert_all( cntr, src, el_size, layout, hash );
+
+  size_t deferred_words = cc_map_cap( src ) / 64;
+  uint64_t *deferred = (uint64_t *)cc_allocator_realloc(
+    cc_map_hdr( cntr )->allocator,
+    realloc_,
+    NULL,
+    sizeof( uint64_t ) * deferred_words + sizeof( cc_map_rehash_task_result_ty ) * task_count
+  );
+  if( CC_UNLIKELY( !deferred ) )
+    return cc_map_reinsert_all( cntr, src, el_size, layout, hash );
+
+  memset( deferred, 0x00, sizeof( uint64_t ) * deferred_words );
+
+  cc_map_rehash_task_ctx_ty ctx = {
+    cntr,
+    src,
+    el_size,
+    layout,
+    hash,
+    partition_mask,
+    ( partition_mask + 1 ) / task_count,
+    deferred,
+    (cc_map_rehash_task_result_ty *)( deferred + deferred_words )
+  };
+
+  cc_parallel_for( cc_map_rehash_task, &ctx, task_count );
+
+  for( size_t i = 0; i < task_count; ++i )
+  {
+    cc_map_hdr( cntr )->size += ctx.results[ i ].placed;
+#ifdef CC_STATS
+    cc_map_hdr( cntr )->counters.evictions += ctx.results[ i ].evictions;
+#endif
+  }
+
+  // Second phase.
+  bool success = true;
+  for( size_t word = 0; word < deferred_words && success; ++word )
+    for( size_t i = word * 64; deferred[ word ] && i < word * 64 + 64 && success; ++i )
+      if( deferred[ word ] & (uint64_t)1 << ( i % 64 ) )
+        success = cc_map_reinsert(
+          cntr,
+          cc_map_el( src, i, el_size, layout ),
+          cc_map_key( src, i, el_size, layout ),
+          cc_map_bucket_hash( src, i, el_size, layout, hash ),
+          el_size,
+          layout,
+          hash
+        ) != NULL;
+
+  cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, deferred );
+  return success;
+}
+
+// The shared context of the cloning tasks, each of which copies one chunk of the table.
+typedef struct
+{
+  void *dest;
+  void *src;
+  size_t size;
+  size_t chunk_size;
+} cc_map_copy_task_ctx_ty;
+
+static inline void cc_map_copy_task( void *ctx_, size_t task )
+{
+  cc_map_copy_task_ctx_ty *ctx = (cc_map_copy_task_ctx_ty *)ctx_;
+  size_t begin = task * ctx->chunk_size;
+  if( begin < ctx->size )
+    memcpy(
+      (char *)ctx->dest + begin,
+      (char *)ctx->src + begin,
+      ctx->size - begin < ctx->chunk_size ? ctx->size - begin : ctx->chunk_size
+    );
+}
+
+#endif
+
+// Creates a rehashed duplicate of cntr with capacity cap.
+// If CC_INCREMENTAL_REHASH is defined, the duplicate also contains the key-element pairs not yet migrated from cntr's
+// old table, and it has no old table of its own.
+// If allocator is not NULL, the duplicate is allocated via, and associated with, that allocator.
+// Assumes that cap is a power of two large enough to accommodate all key-element pairs without violating the max load
+// factor.
+// Returns a pointer to the duplicate, or NULL in the case of allocation failure.
+// As this function is called very rarely in cc_map_insert and cc_map_get_or_insert, ideally it should not be inlined
+// into those functions.
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes" // Silence warning about combining noinline with static inline.
+__attribute__((noinline))
+#endif
+static inline void *cc_map_make_rehash(
+  void *cntr,
+  size_t cap,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+#ifdef CC_STATS
+  size_t retries = 0;
+#endif
+
+  // The attempt to resize and rehash must occur inside a loop that incrementally doubles the target bucket count
+  // because a failure could theoretically occur at any load factor due to the displacement limit.
+  while( true )
+  {
+    size_t metadata_offset;
+    size_t allocation_size;
+    cc_map_allocation_details( cap, el_size, layout, &metadata_offset, &allocation_size );
+
+    cc_map_hdr_ty *new_cntr = (cc_map_hdr_ty *)cc_allocator_realloc( allocator, realloc_, NULL, allocation_size );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return NULL;
+
+    new_cntr->size = 0;
+    new_cntr->cap_mask = cap - 1;
+    new_cntr->metadata = (uint16_t *)( (char *)new_cntr + metadata_offset );
+    new_cntr->allocator = allocator;
+#ifdef CC_INCREMENTAL_REHASH
+    new_cntr->old_cntr = NULL;
+    new_cntr->migration_bucket = 0;
+#endif
+#ifdef CC_STATS
+    new_cntr->counters = cc_map_hdr( cntr )->counters;
+    new_cntr->counters.rehash_retries += retries;
+    if( cc_map_size( cntr ) )
+      ++new_cntr->counters.rehashes;
+#endif
+
+    memset( new_cntr->metadata, 0x00, ( cap + CC_MAP_METADATA_EXCESS ) * sizeof( uint16_t ) );
+
+    // Iteration stopper at the end of the actual metadata array (i.e. the first of the excess metadata).
+    new_cntr->metadata[ cap ] = 0x01;
+
+#ifdef CC_PARALLEL_REHASH
+    bool success = cc_map_reinsert_all_in_parallel( new_cntr, cntr, el_size, layout, hash, realloc_, free_ );
+#else
+    bool success = cc_map_reinsert_all( new_cntr, cntr, el_size, layout, hash );
+#endif
+#ifdef CC_INCREMENTAL_REHASH
+    // Also gather the key-element pairs not yet migrated from the old table.
+    if( success && cc_map_hdr( cntr )->old_cntr )
+      success = cc_map_reinsert_all( new_cntr, cc_map_hdr( cntr )->old_cntr, el_size, layout, hash );
+#endif
+
+    // If a key could not be reinserted due to the displacement limit, double the bucket count and retry.
+    if( CC_UNLIKELY( !success ) )
+    {
+      cc_allocator_free( allocator, free_, new_cntr );
+      cap *= 2;
+#ifdef CC_STATS
+      ++retries;
+#endif
+      continue;
+    }
+
+    return new_cntr;
+  }
+}
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+// Frees the map's memory, including any old table, without calling destructors, unless the map is a placeholder.
+static inline void cc_map_free( void *cntr, cc_free_fnptr_ty free_ )
+{
+  if( cc_map_is_placeholder( cntr ) )
+    return;
+
+#ifdef CC_INCREMENTAL_REHASH
+  if( cc_map_hdr( cntr )->old_cntr )
+    cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, cc_map_hdr( cntr )->old_cntr );
+#endif
+
+  cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, cntr );
+}
+
+#ifdef CC_INCREMENTAL_REHASH
+
+// Incremental rehashing:
+// If CC_INCREMENTAL_REHASH is defined, a map that must grow does not immediately reinsert all its key-element pairs
+// into the new, larger table.
+// Instead, the new table's header stores a pointer to the old table, and every subsequent insertion first migrates the
+// key-element pairs in up to CC_MAP_MIGRATION_BUCKET_COUNT buckets of the old table, in bucket order, to the new table.
+// Each migrated key-element pair is erased from the old table, so a key exists in at most one of the two tables.
+// Lookups and erasures check both tables, and iteration visits the old table's remaining key-element pairs before the
+// new table's.
+// Migrating a constant number of buckets per insertion suffices to empty the old table long before the new table
+// reaches its max load factor, at which point the old table is freed.
+// If the new table does reach its max load factor first (i.e. if that factor is very low) or a key-element pair cannot
+// be migrated because of the displacement limit, the insertion instead falls back on rehashing both tables at once.
+// Erasures and lookups never migrate key-element pairs because they must not allocate memory (as the fallback could) or
+// invalidate pointer-iterators.
+
+// The maximum number of old-table buckets whose key-element pairs each insertion migrates.
+#define CC_MAP_MIGRATION_BUCKET_COUNT 16
+
+// Migrates the key-element pairs in up to bucket_count buckets of the map's old table to the map.
+// Frees the old table once it is empty.
+// Returns false if a key-element pair could not be reinserted because of the displacement limit, in which case the
+// map's chains may be corrupted and a full rehash via cc_map_make_rehash, which does not traverse chains, is required.
+static inline bool cc_map_migrate(
+  void *cntr,
+  size_t bucket_count,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_free_fnptr_ty free_
+)
+{
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+
+  while( bucket_count-- && cc_map_hdr( old_cntr )->size )
+  {
+    size_t bucket = cc_map_hdr( cntr )->migration_bucket;
+
+    if( cc_map_hdr( old_cntr )->metadata[ bucket ] == CC_MAP_EMPTY )
+    {
+      ++cc_map_hdr( cntr )->migration_bucket;
+      continue;
+    }
+
+    if( CC_UNLIKELY( !cc_map_reinsert(
+      cntr,
+      cc_map_el( old_cntr, bucket, el_size, layout ),
+      cc_map_key( old_cntr, bucket, el_size, layout ),
+      cc_map_bucket_hash( old_cntr, bucket, el_size, layout, hash ),
+      el_size,
+      layout,
+      hash
+    ) ) )
+      return false;
+
+    // Because all buckets before migration_bucket are empty, any key-element pair that the erasure moves into bucket
+    // comes from a later bucket, so the same bucket must be checked again.
+    cc_map_erase_raw( old_cntr, bucket, SIZE_MAX, el_size, layout, hash, NULL, NULL );
+  }
+
+  if( !cc_map_hdr( old_cntr )->size )
+  {
+    cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, old_cntr );
+    cc_map_hdr( cntr )->old_cntr = NULL;
+    cc_map_hdr( cntr )->migration_bucket = 0;
+  }
+
+  return true;
+}
+
+#endif
+
+// Reserves capacity such that the map can accommodate n key-element pairs without reallocation (i.e. without violating
+// the max load factor).
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline cc_allocing_fn_result_ty cc_map_reserve(
+  void *cntr,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  double max_load,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  size_t cap = cc_map_min_cap_for_n_els( n, max_load );
+
+  if( cc_map_cap( cntr ) >= cap )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+
+  void *new_cntr = cc_map_make_rehash(
+    cntr,
+    cap,
+    el_size,
+    layout,
+    hash,
+    cc_map_hdr( cntr )->allocator,
+    realloc_,
+    free_
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return cc_make_allocing_fn_result( cntr, NULL );
+
+  cc_map_free( cntr, free_ );
+
+  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+}
+
+// Returns a pointer-iterator to the element with the specified key, whose hash code has already been computed, or NULL
+// if no such element exists.
+// This function is the shared basis of cc_map_get and cc_map_get_n.
+static inline void *cc_map_get_from_hash(
+  void *cntr,
+  void *key,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // The key may still reside in the old table.
+  if( cc_map_hdr( cntr )->old_cntr )
+  {
+    void *itr = cc_map_get_from_hash( cc_map_hdr( cntr )->old_cntr, key, key_hash, el_size, layout, cmpr );
+    if( itr )
+      return itr;
+  }
+#endif
+
+  if( cc_map_is_flat( cntr ) )
+  {
+    size_t bucket = cc_map_flat_find( cntr, key, el_size, layout, cmpr );
+    return bucket < cc_map_hdr( cntr )->size ? cc_map_el( cntr, bucket, el_size, layout ) : NULL;
+  }
+
+  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+
+  // If the home bucket is empty or contains a key-element pair that does not belong there, then our key does not exist.
+  // This check also implicitly handles the case of a zero bucket count, since home_bucket will be zero and
+  // metadata[ 0 ] will be the empty placeholder.
+  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+    return NULL;
+
+  // Traverse the chain of key-element pairs belonging to the home bucket.
+  uint16_t hashfrag = cc_hash_frag( key_hash );
+  size_t bucket = home_bucket;
+  while( true )
+  {
+    if(
+      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
+      cc_map_cached_hash_may_match( cntr, bucket, key_hash, el_size, layout ) &&
+      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
+    )
+      return cc_map_el( cntr, bucket, el_size, layout );
+
+    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+    if( displacement == CC_MAP_DISPLACEMENT_MASK )
+      return NULL;
+
+    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+  }
+}
+
+// Inserts a key-element pair whose key's hash code, key_hash, has already been computed.
+// If replace is true, then the new key-element pair replaces any existing key-element pair containing the same key.
+// This function wraps cc_map_insert_raw_from_hash in a loop that handles growing and rehashing the table if a new
+// key-element pair cannot be inserted because of the max load factor or displacement limit constraints.
+// The hash function is still needed to rehash the existing keys if hash codes are not cached.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer-iterator to the newly inserted
+// element, or to the existing element with the matching key if replace is false.
+// If the underlying storage needed to be expanded and an allocation failure occurred, the latter pointer will be NULL.
+static inline cc_allocing_fn_result_ty cc_map_insert_from_hash(
+  void *cntr,
+  void *el,
+  void *key,
+  size_t key_hash,
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  while( true )
+  {
+#ifdef CC_INCREMENTAL_REHASH
+    if( cc_map_hdr( cntr )->old_cntr )
+    {
+      // If the key still resides in the old table, the insertion or replacement occurs there.
+      void *itr = cc_map_get_from_hash(
+        cc_map_hdr( cntr )->old_cntr,
+        key,
+        key_hash,
+        el_size,
+        layout,
+        cmpr
+      );
+      if( itr )
+      {
+        if( replace )
+        {
+          if( key_dtor )
+            key_dtor( cc_map_key_for( cc_map_hdr( cntr )->old_cntr, itr, el_size, layout ) );
+
+          if( el_dtor )
+            el_dtor( itr );
+
+          memcpy( cc_map_key_for( cc_map_hdr( cntr )->old_cntr, itr, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+          memcpy( itr, el, el_size );
+        }
+
+        return cc_make_allocing_fn_result( cntr, itr );
+      }
+
+      // The load-factor check must account for the key-element pairs yet to be migrated.
+      if(
+        CC_UNLIKELY( cc_map_size( cntr ) + 1 > max_load * cc_map_cap( cntr ) ) ||
+        CC_UNLIKELY( !cc_map_migrate( cntr, CC_MAP_MIGRATION_BUCKET_COUNT, el_size, layout, hash, free_ ) )
+      )
+      {
+        void *new_cntr = cc_map_make_rehash(
+          cntr,
+          cc_map_cap( cntr ) * 2,
+          el_size,
+          layout,
+          hash,
+          cc_map_hdr( cntr )->allocator,
+          realloc_,
+          free_
+        );
+        if( CC_UNLIKELY( !new_cntr ) )
+          return cc_make_allocing_fn_result( cntr, NULL );
+
+        cc_map_free( cntr, free_ );
+        cntr = new_cntr;
+        continue;
+      }
+    }
+#endif
+
+    void *itr = cc_map_is_flat( cntr ) ?
+      cc_map_flat_insert( cntr, el, key, key_hash, replace, el_size, layout, cmpr, el_dtor, key_dtor ) :
+      cc_map_insert_raw_from_hash(
+        cntr,
+        el,
+        key,
+        key_hash,
+        replace,
+        el_size,
+        layout,
+        max_load,
+        hash,
+        cmpr,
+        el_dtor,
+        key_dtor
+      );
+
+    if( CC_LIKELY( itr ) )
+      return cc_make_allocing_fn_result( cntr, itr );
+
+#ifdef CC_INCREMENTAL_REHASH
+    // Rather than rehashing all key-element pairs at once, begin migrating them to a new, empty table.
+    // If a migration is already in progress, the new table has hit the displacement limit, so the migration is
+    // abandoned in favor of a full rehash below.
+    // A flat table is always rehashed at once because it holds too few key-element pairs to warrant migration.
+    if( !cc_map_hdr( cntr )->old_cntr && cc_map_size( cntr ) && !cc_map_is_flat( cntr ) )
+    {
+      void *new_cntr = cc_map_make_rehash(
+        (void *)&cc_map_placeholder,
+        cc_map_cap( cntr ) * 2,
+        el_size,
+        layout,
+        NULL, // Unused because the placeholder contains no keys.
+        cc_map_hdr( cntr )->allocator,
+        realloc_,
+        free_
+      );
+      if( CC_UNLIKELY( !new_cntr ) )
+        return cc_make_allocing_fn_result( cntr, NULL );
+
+      cc_map_hdr( new_cntr )->old_cntr = cntr;
+#ifdef CC_STATS
+      cc_map_hdr( new_cntr )->counters = cc_map_hdr( cntr )->counters;
+      ++cc_map_hdr( new_cntr )->counters.migrations;
+#endif
+      cntr = new_cntr;
+      continue;
+    }
+#endif
+
+    void *new_cntr = cc_map_make_rehash(
+      cntr,
+      cc_map_hdr( cntr )->cap_mask ? cc_map_cap( cntr ) * 2 : CC_MAP_MIN_NONZERO_BUCKET_COUNT,
+      el_size,
+      layout,
+      hash,
+      cc_map_hdr( cntr )->allocator,
+      realloc_,
+      free_
+    );
+
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    cc_map_free( cntr, free_ );
+    cntr = new_cntr;
+  }
+}
+
+// Inserts a key-element pair, hashing the key via the hash function.
+// A flat table that does not need to grow and does not cache hash codes never calls the hash function.
+// The return value is as described for cc_map_insert_from_hash.
+static inline cc_allocing_fn_result_ty cc_map_insert(
+  void *cntr,
+  void *el,
+  void *key,
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  // A flat table only needs the key's hash code to append a new key if hash codes are cached, or to grow.
+  if( cc_map_is_flat( cntr ) )
+  {
+    size_t bucket = cc_map_flat_find( cntr, key, el_size, layout, cmpr );
+    if( bucket < cc_map_cap( cntr ) )
+      return cc_make_allocing_fn_result(
+        cntr,
+        cc_map_flat_insert_at_bucket(
+          cntr,
+          bucket,
+          el,
+          key,
+          bucket == cc_map_hdr( cntr )->size && CC_HAS_CACHED_HASH( layout ) ? hash( key ) : 0,
+          replace,
+          el_size,
+          layout,
+          el_dtor,
+          key_dtor
+        )
+      );
+  }
+
+  return cc_map_insert_from_hash(
+    cntr,
+    el,
+    key,
+    hash( key ),
+    replace,
+    el_size,
+    layout,
+    hash,
+    cmpr,
+    max_load,
+    el_dtor,
+    key_dtor,
+    realloc_,
+    free_
+  );
+}
+
+static inline void *cc_map_get(
+  void *cntr,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  // A flat table, like any old table from which it is still migrating key-element pairs, needs no hash code.
+  if( cc_map_is_flat( cntr ) )
+    return cc_map_get_from_hash( cntr, key, 0 /* Unused */, el_size, layout, cmpr );
+
+  return cc_map_get_from_hash( cntr, key, hash( key ), el_size, layout, cmpr );
+}
+
+// The number of lookups whose cache misses cc_map_get_n and cc_omap_get_n overlap.
+#define CC_GET_N_BATCH_SIZE 16
+
+// Looks up n keys stored contiguously at keys, writing a pointer-iterator to each corresponding element, or NULL, into
+// itrs.
+// Rather than performing each lookup in full before beginning the next, this function processes the keys in batches.
+// For each batch, it first hashes all the keys and prefetches their home metadata and buckets, and it then traverses
+// the chains.
+// Hence, the cache misses associated with the lookups in a batch overlap rather than occurring in series.
+// Returns the number of keys found.
+static inline size_t cc_map_get_n(
+  void *cntr,
+  const void *keys,
+  size_t n,
+  void **itrs,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  size_t hashes[ CC_GET_N_BATCH_SIZE ];
+  size_t found_count = 0;
+
+  if( cc_map_is_flat( cntr ) )
+  {
+    for( size_t i = 0; i < n; ++i )
+    {
+      itrs[ i ] = cc_map_get_from_hash(
+        cntr,
+        (char *)keys + i * CC_KEY_SIZE( layout ),
+        0, // Unused.
+        el_size,
+        layout,
+        cmpr
+      );
+
+      found_count += !!itrs[ i ];
+    }
+
+    return found_count;
+  }
+
+  for( size_t batch_begin = 0; batch_begin < n; batch_begin += CC_GET_N_BATCH_SIZE )
+  {
+    size_t batch_size = n - batch_begin < CC_GET_N_BATCH_SIZE ? n - batch_begin : CC_GET_N_BATCH_SIZE;
+
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      hashes[ i ] = hash( (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ) );
+      size_t home_bucket = hashes[ i ] & cc_map_hdr( cntr )->cap_mask;
+      CC_PREFETCH( cc_map_hdr( cntr )->metadata + home_bucket );
+      CC_PREFETCH( cc_map_key( cntr, home_bucket, el_size, layout ) );
+    }
+
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      itrs[ batch_begin + i ] = cc_map_get_from_hash(
+        cntr,
+        (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ),
+        hashes[ i ],
+        el_size,
+        layout,
+        cmpr
+      );
+
+      found_count += !!itrs[ batch_begin + i ];
+    }
+  }
+
+  return found_count;
+}
+
+// DEPRECATED.
+// For maps, the container handle doubles up as r_end.
+static inline void *cc_map_r_end( void *cntr )
+{
+  return cntr;
+}
+
+static inline void *cc_map_end(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return cc_map_el( cntr, cc_map_cap( cntr ), el_size, layout );
+}
+
+// Finds the first occupied bucket at or after the bucket pointed to by itr.
+static inline void *cc_map_leap_forward( void *cntr, void *itr, size_t el_size, uint64_t layout )
+{
+  return cc_map_el(
+    cntr,
+    cc_map_first_occupied( cntr, cc_map_bucket_index_from_itr( cntr, itr, el_size, layout ) ),
+    el_size,
+    layout
+  );
+}
+
+// DEPRECATED.
+// Finds the first occupied bucket before the bucket pointed to by itr.
+// This function also scans four buckets at a time, ideally using intrinsics.
+// However, because the r_end pointer-iterator, unlike end, constitutes a special case, this function is less efficient
+// cc_map_leap_forward.
+static inline void *cc_map_leap_backward( void *cntr, void *itr, size_t el_size, uint64_t layout )
+{
+  size_t bucket = cc_map_bucket_index_from_itr( cntr, itr, el_size, layout );
+
+  while( true )
+  {
+    if( bucket < 4 )
+    {
+      while( bucket-- )
+        if( cc_map_hdr( cntr )->metadata[ bucket ] )
+          return cc_map_el( cntr, bucket, el_size, layout );
+
+      return cc_map_r_end( cntr );
+    }
+
+    // This check is only necessary to silence a superfluous array-bounds warning under GCC.
+    // In practice, the case of a placeholder map is caught by the above check for bucket < 4.
+    if( cc_map_hdr( cntr )->metadata == cc_map_placeholder_metadata )
+      CC_UNREACHABLE;
+
+    uint64_t metadatum;
+    memcpy( &metadatum, cc_map_hdr( cntr )->metadata + bucket - 4, sizeof( uint64_t ) );
+    if( metadatum )
+      return cc_map_el( cntr, bucket - 1 - cc_last_nonzero_uint16( metadatum ), el_size, layout );
+
+    bucket -= 4;
+  }
+}
+
+static inline void *cc_map_first(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // Iteration begins with the key-element pairs remaining in the old table.
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr && cc_map_hdr( old_cntr )->size )
+    return cc_map_leap_forward(
+      old_cntr,
+      cc_map_el( old_cntr, cc_map_hdr( cntr )->migration_bucket, el_size, layout ),
+      el_size,
+      layout
+    );
+#endif
+
+  void *itr = cc_map_el( cntr, 0, el_size, layout );
+
+  if( !cc_map_hdr( cntr )->cap_mask )
+    return itr;
+
+  return cc_map_leap_forward( cntr, itr, el_size, layout );
+}
+
+// DEPRECATED.
+static inline void *cc_map_prev(
+  void *cntr,
+  void *itr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // Iteration from the new table continues into the old table.
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr )
+  {
+    if( cc_map_table_for_itr( cntr, itr, el_size, layout ) == cntr )
+    {
+      itr = cc_map_leap_backward( cntr, itr, el_size, layout );
+      if( itr != cc_map_r_end( cntr ) )
+        return itr;
+
+      itr = cc_map_end( old_cntr, el_size, layout );
+    }
+
+    itr = cc_map_leap_backward( old_cntr, itr, el_size, layout );
+    return itr == cc_map_r_end( old_cntr ) ? cc_map_r_end( cntr ) : itr;
+  }
+#endif
+
+  return cc_map_leap_backward( cntr, itr, el_size, layout );
+}
+
+// DEPRECATED.
+static inline void *cc_map_last(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return cc_map_prev( cntr, cc_map_end( cntr, el_size, layout ), el_size, layout );
+}
+
+static inline void *cc_map_next(
+  void *cntr,
+  void *itr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // Iteration from the old table continues into the new table.
+  void *table = cc_map_table_for_itr( cntr, itr, el_size, layout );
+  if( table != cntr )
+  {
+    itr = cc_map_leap_forward( table, (char *)itr + CC_MAP_EL_STRIDE( el_size, layout ), el_size, layout );
+    if( itr != cc_map_end( table, el_size, layout ) )
+      return itr;
+
+    return cc_map_leap_forward( cntr, cc_map_el( cntr, 0, el_size, layout ), el_size, layout );
+  }
+#endif
+
+  itr = (char *)itr + CC_MAP_EL_STRIDE( el_size, layout );
+  return cc_map_leap_forward( cntr, itr, el_size, layout );
+}
+
+// Erases the key-element pair pointed to by itr and returns a pointer-iterator to the next key-element pair in the
+// table.
+// This function must be inlined to ensure that the compiler optimizes away the cc_map_next call if the returned
+// pointer-iterator is discarded.
+static inline CC_ALWAYS_INLINE void *cc_map_erase_itr(
+  void *cntr,
+  void *itr,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  void *table = cc_map_table_for_itr( cntr, itr, el_size, layout );
+  size_t bucket = cc_map_bucket_index_from_itr( table, itr, el_size, layout );
+
+  if( cc_map_erase_raw( table, bucket, SIZE_MAX, el_size, layout, hash, el_dtor, key_dtor ) )
+    return cc_map_next( cntr, itr, el_size, layout );
+
+  return itr;
+}
+
+// A cursor for iterating over a map or set.
+// Unlike a pointer-iterator, a cursor keeps the table and index of the bucket to which it points, so stepping or
+// erasing via it never needs to derive them from a pointer.
+typedef struct
+{
+  void *table;   // The map itself or, if CC_INCREMENTAL_REHASH is defined, possibly its old table.
+  size_t bucket;
+} cc_cursor;
+
+// Points the cursor to the first occupied bucket at or after the specified bucket in the cursor's table and returns a
+// pointer-iterator to it.
+// If the cursor's table is the old table and no such bucket exists, iteration continues into the new table.
+static inline void *cc_map_cursor_seek(
+  void *cntr,
+  cc_cursor *cursor,
+  size_t bucket,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  cursor->bucket = cc_map_first_occupied( cursor->table, bucket );
+
+#ifdef CC_INCREMENTAL_REHASH
+  if( cursor->table != cntr && cursor->bucket == cc_map_cap( cursor->table ) )
+  {
+    cursor->table = cntr;
+    cursor->bucket = cc_map_first_occupied( cntr, 0 );
+  }
+#else
+  (void)cntr;
+#endif
+
+  return cc_map_el( cursor->table, cursor->bucket, el_size, layout );
+}
+
+// Points the cursor to the first key-element pair and returns a pointer-iterator to it, or an end pointer-iterator if
+// the map is empty.
+static inline void *cc_map_cursor_first(
+  void *cntr,
+  cc_cursor *cursor,
+  size_t el_size,
+  uint64_t layout
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // Iteration begins with the key-element pairs remaining in the old table.
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr && cc_map_hdr( old_cntr )->size )
+  {
+    cursor->table = old_cntr;
+    return cc_map_cursor_seek( cntr, cursor, cc_map_hdr( cntr )->migration_bucket, el_size, layout );
+  }
+#endif
+
+  cursor->table = cntr;
+
+  if( !cc_map_hdr( cntr )->cap_mask )
+  {
+    cursor->bucket = 0;
+    return cc_map_el( cntr, 0, el_size, layout );
+  }
+
+  return cc_map_cursor_seek( cntr, cursor, 0, el_size, layout );
+}
+
+// Advances the cursor to the next key-element pair and returns a pointer-iterator to it, or an end pointer-iterator if
+// the cursor pointed to the last key-element pair.
+static inline void *cc_map_cursor_next(
+  void *cntr,
+  cc_cursor *cursor,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return cc_map_cursor_seek( cntr, cursor, cursor->bucket + 1, el_size, layout );
+}
+
+// Erases the key-element pair to which the cursor points, advances the cursor to the next key-element pair, and returns
+// a pointer-iterator to it.
+// Because the cursor already holds the bucket, the key is only rehashed if it lies outside its home bucket and is not
+// the only key in its chain (see cc_map_erase_raw).
+// Like cc_map_erase_itr, this function must be inlined so that the cursor advance is optimized away if the returned
+// pointer-iterator is discarded.
+static inline CC_ALWAYS_INLINE void *cc_map_cursor_erase(
+  void *cntr,
+  cc_cursor *cursor,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  if( cc_map_erase_raw( cursor->table, cursor->bucket, SIZE_MAX, el_size, layout, hash, el_dtor, key_dtor ) )
+    return cc_map_cursor_next( cntr, cursor, el_size, layout );
+
+  return cc_map_el( cursor->table, cursor->bucket, el_size, layout );
+}
+
+// Erases the key-element pair containing the specified key, whose hash code has already been computed, if it exists.
+// Returns a pointer that evaluates to true if a key-element pair was erased, or else NULL.
+// This function is the shared basis of cc_map_erase and cc_map_erase_n.
+static inline void *cc_map_erase_from_hash(
+  void *cntr,
+  void *key,
+  size_t key_hash,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  // The key may still reside in the old table.
+  if(
+    cc_map_hdr( cntr )->old_cntr &&
+    cc_map_erase_from_hash(
+      cc_map_hdr( cntr )->old_cntr,
+      key,
+      key_hash,
+      el_size,
+      layout,
+      hash,
+      cmpr,
+      el_dtor,
+      key_dtor
+    )
+  )
+    return &cc_dummy_true;
+#endif
+
+  if( cc_map_is_flat( cntr ) )
+  {
+    size_t bucket = cc_map_flat_find( cntr, key, el_size, layout, cmpr );
+    if( bucket == cc_map_hdr( cntr )->size )
+      return NULL;
+
+    cc_map_erase_raw( cntr, bucket, SIZE_MAX, el_size, layout, hash, el_dtor, key_dtor );
+    return &cc_dummy_true;
+  }
+
+  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+
+  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+    return NULL;
+
+  uint16_t hashfrag = cc_hash_frag( key_hash );
+  size_t bucket = home_bucket;
+  while( true )
+  {
+    if(
+      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
+      cc_map_cached_hash_may_match( cntr, bucket, key_hash, el_size, layout ) &&
+      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
+    )
+    {
+      cc_map_erase_raw( cntr, bucket, home_bucket, el_size, layout, hash, el_dtor, key_dtor );
+      return &cc_dummy_true;
+    }
+
+    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+    if( displacement == CC_MAP_DISPLACEMENT_MASK )
+      return NULL;
+
+    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+  }
+}
+
+// Erases the key-element pair containing the specified key, if it exists.
+// Returns a pointer that evaluates to true if a key-element pair was erased, or else NULL.
+// This pointer is eventually cast to bool by the cc_erase API macro.
+static inline void *cc_map_erase(
+  void *cntr,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_map_erase_from_hash(
+    cntr,
+    key,
+    cc_map_is_flat( cntr ) ? 0 /* Unused */ : hash( key ),
+    el_size,
+    layout,
+    hash,
+    cmpr,
+    el_dtor,
+    key_dtor
+  );
+}
+
+// Inserts n key-element pairs stored contiguously at keys and els, replacing the existing key-element pairs containing
+// the same keys if they exist.
+// The capacity is first reserved for the current size plus n so that, ordinarily, no rehash occurs midway.
+// The keys are then hashed, and their home metadata and buckets prefetched, in batches, as in cc_map_get_n.
+// A pair that cannot be inserted because of the displacement limit, or while an incremental rehash is in progress,
+// falls back on cc_map_insert.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+// If the reservation fails, no pairs are inserted; if a later fallback fails, the preceding pairs remain inserted.
+static inline cc_allocing_fn_result_ty cc_map_insert_n(
+  void *cntr,
+  void *keys,
+  void *els,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_allocing_fn_result_ty result = cc_map_reserve(
+    cntr,
+    cc_map_size( cntr ) + n,
+    el_size,
+    layout,
+    hash,
+    max_load,
+    realloc_,
+    free_
+  );
+  if( CC_UNLIKELY( !result.other_ptr ) )
+    return result;
+
+  cntr = result.new_cntr;
+  size_t hashes[ CC_GET_N_BATCH_SIZE ];
+
+  // A flat table needs no hash codes, so the pairs are inserted one by one.
+  if( cc_map_is_flat( cntr ) )
+  {
+    for( size_t i = 0; i < n; ++i )
+    {
+      result = cc_map_insert(
+        cntr,
+        (char *)els + i * el_size,
+        (char *)keys + i * CC_KEY_SIZE( layout ),
+        true,
+        el_size,
+        layout,
+        hash,
+        cmpr,
+        max_load,
+        el_dtor,
+        key_dtor,
+        realloc_,
+        free_
+      );
+
+      cntr = result.new_cntr;
+      if( CC_UNLIKELY( !result.other_ptr ) )
+        return result;
+    }
+
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+  }
+
+  for( size_t batch_begin = 0; batch_begin < n; batch_begin += CC_GET_N_BATCH_SIZE )
+  {
+    size_t batch_size = n - batch_begin < CC_GET_N_BATCH_SIZE ? n - batch_begin : CC_GET_N_BATCH_SIZE;
+
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      hashes[ i ] = hash( (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ) );
+      size_t home_bucket = hashes[ i ] & cc_map_hdr( cntr )->cap_mask;
+      CC_PREFETCH( cc_map_hdr( cntr )->metadata + home_bucket );
+      CC_PREFETCH( cc_map_key( cntr, home_bucket, el_size, layout ) );
+    }
+
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      void *key = (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout );
+      void *el = (char *)els + ( batch_begin + i ) * el_size;
+
+      void *itr = NULL;
+#ifdef CC_INCREMENTAL_REHASH
+      if( !cc_map_hdr( cntr )->old_cntr )
+#endif
+        itr = cc_map_insert_raw_from_hash(
+          cntr,
+          el,
+          key,
+          hashes[ i ],
+          true,
+          el_size,
+          layout,
+          max_load,
+          hash,
+          cmpr,
+          el_dtor,
+          key_dtor
+        );
+
+      if( CC_UNLIKELY( !itr ) )
+      {
+        result = cc_map_insert(
+          cntr,
+          el,
+          key,
+          true,
+          el_size,
+          layout,
+          hash,
+          cmpr,
+          max_load,
+          el_dtor,
+          key_dtor,
+          realloc_,
+          free_
+        );
+
+        cntr = result.new_cntr;
+        if( CC_UNLIKELY( !result.other_ptr ) )
+          return result;
+      }
+    }
+  }
+
+  return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+}
+
+// Erases the key-element pairs containing the n keys stored contiguously at keys, if they exist.
+// As in cc_map_get_n, the keys are hashed, and their home metadata and buckets prefetched, in batches.
+// Returns the number of key-element pairs erased.
+static inline size_t cc_map_erase_n(
+  void *cntr,
+  const void *keys,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  size_t hashes[ CC_GET_N_BATCH_SIZE ];
+  size_t erased_count = 0;
+
+  if( cc_map_is_flat( cntr ) )
+  {
+    for( size_t i = 0; i < n; ++i )
+      erased_count += !!cc_map_erase_from_hash(
+        cntr,
+        (char *)keys + i * CC_KEY_SIZE( layout ),
+        0, // Unused.
+        el_size,
+        layout,
+        hash,
+        cmpr,
+        el_dtor,
+        key_dtor
+      );
+
+    return erased_count;
+  }
+
+  for( size_t batch_begin = 0; batch_begin < n; batch_begin += CC_GET_N_BATCH_SIZE )
+  {
+    size_t batch_size = n - batch_begin < CC_GET_N_BATCH_SIZE ? n - batch_begin : CC_GET_N_BATCH_SIZE;
+
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      hashes[ i ] = hash( (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ) );
+      size_t home_bucket = hashes[ i ] & cc_map_hdr( cntr )->cap_mask;
+      CC_PREFETCH( cc_map_hdr( cntr )->metadata + home_bucket );
+      CC_PREFETCH( cc_map_key( cntr, home_bucket, el_size, layout ) );
+    }
+
+    for( size_t i = 0; i < batch_size; ++i )
+      erased_count += !!cc_map_erase_from_hash(
+        cntr,
+        (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ),
+        hashes[ i ],
+        el_size,
+        layout,
+        hash,
+        cmpr,
+        el_dtor,
+        key_dtor
+      );
+  }
+
+  return erased_count;
+}
+
+// Erases every key-element pair in the specified table for which the predicate, called with a pointer-iterator to the
+// element, does not return keep_if.
+// Rather than erasing the pairs one by one, which requires rehashing the keys of displaced pairs to find their home
+// buckets, the function visits each chain once, starting at its home bucket, which is identified by the metadatum's
+// in-home-bucket flag.
+// The chain's remaining pairs are moved, in order, into its first buckets, and the buckets left over at the end of the
+// chain are emptied.
+// Because the links between buckets are never altered, no key is ever hashed.
+// Returns the number of key-element pairs erased.
+static inline size_t cc_map_filter_table(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
+  size_t size = cc_map_hdr( cntr )->size;
+  if( !size )
+    return 0;
+
+  uint16_t *metadata = cc_map_hdr( cntr )->metadata;
+  size_t kept = 0;
+
+  // A flat table is compacted just like a vector.
+  if( cc_map_is_flat( cntr ) )
+  {
+    for( size_t bucket = 0; bucket < size; ++bucket )
+    {
+      if( pred( cc_map_el( cntr, bucket, el_size, layout ), ctx ) == keep_if )
+      {
+        if( kept != bucket )
+          cc_map_copy_bucket( cntr, kept, bucket, el_size, layout );
+
+        ++kept;
+        continue;
+      }
+
+      if( el_dtor )
+        el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+      if( key_dtor )
+        key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+    }
+
+    for( size_t bucket = kept; bucket < size; ++bucket )
+      metadata[ bucket ] = CC_MAP_EMPTY;
+
+    cc_map_hdr( cntr )->size = kept;
+    return size - kept;
+  }
+
+  size_t cap_mask = cc_map_hdr( cntr )->cap_mask;
+
+  for(
+    size_t home_bucket = cc_map_first_occupied( cntr, 0 );
+    home_bucket <= cap_mask;
+    home_bucket = cc_map_first_occupied( cntr, home_bucket + 1 )
+  )
+  {
+    if( !( metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+      continue;
+
+    // Compact the chain.
+    size_t last_kept = SIZE_MAX; // Last bucket in the chain that has been filled, if any.
+    size_t bucket = home_bucket;
+    while( true )
+    {
+      if( pred( cc_map_el( cntr, bucket, el_size, layout ), ctx ) == keep_if )
+      {
+        size_t dst = last_kept == SIZE_MAX ? home_bucket :
+          ( home_bucket + cc_quadratic( metadata[ last_kept ] & CC_MAP_DISPLACEMENT_MASK ) ) & cap_mask;
+
+        if( dst != bucket )
+        {
+          cc_map_copy_bucket( cntr, dst, bucket, el_size, layout );
+
+          metadata[ dst ] = ( metadata[ dst ] & ~CC_MAP_HASH_FRAG_MASK ) |
+            ( metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK );
+        }
+
+        last_kept = dst;
+        ++kept;
+      }
+      else
+      {
+        if( el_dtor )
+          el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+        if( key_dtor )
+          key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+      }
+
+      uint16_t displacement = metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+      if( displacement == CC_MAP_DISPLACEMENT_MASK )
+        break;
+
+      bucket = ( home_bucket + cc_quadratic( displacement ) ) & cap_mask;
+    }
+
+    // Truncate the chain after the last filled bucket, or empty it entirely.
+    if( last_kept == SIZE_MAX )
+      bucket = home_bucket;
+    else
+    {
+      uint16_t displacement = metadata[ last_kept ] & CC_MAP_DISPLACEMENT_MASK;
+      if( displacement == CC_MAP_DISPLACEMENT_MASK )
+        continue;
+
+      metadata[ last_kept ] |= CC_MAP_DISPLACEMENT_MASK;
+      bucket = ( home_bucket + cc_quadratic( displacement ) ) & cap_mask;
+    }
+
+    while( true )
+    {
+      uint16_t displacement = metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
+      metadata[ bucket ] = CC_MAP_EMPTY;
+      if( displacement == CC_MAP_DISPLACEMENT_MASK )
+        break;
+
+      bucket = ( home_bucket + cc_quadratic( displacement ) ) & cap_mask;
+    }
+  }
+
+  cc_map_hdr( cntr )->size = kept;
+  return size - kept;
+}
+
+// Erases every key-element pair for which the predicate, called with a pointer-iterator to the element, does not
+// return keep_if.
+// This function is the basis of both cc_filter (keep_if is true) and cc_erase_if (keep_if is false).
+// Returns the number of key-element pairs erased.
+static inline size_t cc_map_filter(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  size_t erased_count = 0;
+
+#ifdef CC_INCREMENTAL_REHASH
+  // The old table, if any, is freed if no key-element pairs remain in it, just as after the last migration.
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr )
+  {
+    erased_count += cc_map_filter_table( old_cntr, pred, ctx, keep_if, el_size, layout, el_dtor, key_dtor );
+
+    if( !cc_map_hdr( old_cntr )->size )
+    {
+      cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, old_cntr );
+      cc_map_hdr( cntr )->old_cntr = NULL;
+      cc_map_hdr( cntr )->migration_bucket = 0;
+    }
+  }
+#else
+  (void)free_;
+#endif
+
+  return erased_count + cc_map_filter_table( cntr, pred, ctx, keep_if, el_size, layout, el_dtor, key_dtor );
+}
+
+// Shrinks the map's capacity to the minimum possible without violating the max load factor associated with the key
+// type (or, if the resulting table would be flat, without exceeding its bucket count).
+// The capacity never increases.
+// If shrinking is necessary, then a complete rehash occurs.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline cc_allocing_fn_result_ty cc_map_shrink(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  double max_load,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  size_t cap = cc_map_min_cap_for_n_els( cc_map_size( cntr ), max_load );
+
+#ifdef CC_FLAT_SMALL_MAPS
+  // A flat table can be filled completely, irrespective of the max load factor.
+  if( cc_map_size( cntr ) && cc_map_size( cntr ) <= CC_MAP_FLAT_MAX_BUCKET_COUNT )
+  {
+    cap = CC_MAP_MIN_NONZERO_BUCKET_COUNT;
+    while( cc_map_size( cntr ) > cap )
+      cap *= 2;
+  }
+#endif
+
+  // A map with an allocator keeps a minimal bucket array so that it remains associated with the allocator.
+  if( cap == 0 && cc_map_hdr( cntr )->allocator )
+    cap = CC_MAP_MIN_NONZERO_BUCKET_COUNT;
+
+  if( cap >= cc_map_cap( cntr ) ) // Shrink unnecessary.
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+
+  if( cap == 0 ) // Restore placeholder.
+  {
+    cc_map_free( cntr, free_ );
+
+    return cc_make_allocing_fn_result( (void *)&cc_map_placeholder, cc_dummy_true_ptr );
+  }
+
+  void *new_cntr = cc_map_make_rehash(
+    cntr,
+    cap,
+    el_size,
+    layout,
+    hash,
+    cc_map_hdr( cntr )->allocator,
+    realloc_,
+    free_
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return cc_make_allocing_fn_result( cntr, NULL );
+
+  cc_map_free( cntr, free_ );
+
+  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+}
+
+// Initializes a map that allocates its memory via the specified allocator.
+// The map's bucket array is allocated immediately, with the minimum nonzero capacity, so that its header can store the
+// pointer to the allocator.
+// Returns a pointer to the new map, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding API macro.
+static inline void *cc_map_init_with_allocator(
+  cc_allocator *allocator,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return cc_map_make_rehash(
+    (void *)&cc_map_placeholder,
+    CC_MAP_MIN_NONZERO_BUCKET_COUNT,
+    el_size,
+    layout,
+    NULL,      // Unused because the placeholder contains no keys.
+    allocator,
+    NULL,      // Unused.
+    NULL       // Unused.
+  );
+}
+
+// Initializes a map whose header, buckets, and metadata are stored in the inline storage of a fixed-capacity buffer,
+// with a bucket count of exactly slot_count.
+// Since each of the buffer's slots is at least as large as a bucket, the table always fits in the storage.
+// Returns a pointer to the new map.
+// This call cannot fail.
+static inline void *cc_map_init_with_fixed_buffer(
+  cc_fixed_buf_hdr_ty *buf,
+  void *storage,
+  size_t storage_size,
+  size_t slot_count,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  cc_fixed_buf_init( buf, storage, storage_size );
+
+  return cc_map_make_rehash(
+    (void *)&cc_map_placeholder,
+    slot_count,
+    el_size,
+    layout,
+    NULL,             // Unused because the placeholder contains no keys.
+    &buf->allocator,
+    NULL,             // Unused.
+    NULL              // Unused.
+  );
+}
+
+// Allocates a bitwise copy of the table src, which must not be a placeholder.
+// Returns a pointer to the copy, or NULL in the case of allocation failure.
+static inline void *cc_map_copy_table(
+  void *src,
+  size_t el_size,
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  size_t metadata_offset;
+  size_t allocation_size;
+  cc_map_allocation_details( cc_map_cap( src ), el_size, layout, &metadata_offset, &allocation_size );
+
+  cc_map_hdr_ty *new_cntr = (cc_map_hdr_ty*)cc_allocator_realloc(
+    cc_map_hdr( src )->allocator,
+    realloc_,
+    NULL,
+    allocation_size
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+#ifdef CC_PARALLEL_REHASH
+  size_t task_count = cc_map_parallel_task_count( cc_map_cap( src ) );
+  cc_map_copy_task_ctx_ty ctx = { new_cntr, src, allocation_size, ( allocation_size + task_count - 1 ) / task_count };
+  cc_parallel_for( cc_map_copy_task, &ctx, task_count );
+#else
+  memcpy( new_cntr, src, allocation_size );
+#endif
+  new_cntr->metadata = (uint16_t *)( (char *)new_cntr + metadata_offset );
+
+  return new_cntr;
+}
+
+// Initializes a shallow copy of the source map.
+// The capacity of the copy is the same as the capacity of the source map, unless the source map is empty, in which case
+// the copy is a placeholder (or, if the source map has an allocator, a map with the minimum nonzero capacity).
+// Hence, this function does no rehashing.
+// The copy uses the same allocator as the source map.
+// Returns a pointer to the copy, or NULL in the case of allocation failure.
+// That return value is cast to bool in the corresponding API macro.
+static inline void *cc_map_init_clone(
+  void *src,
+  size_t el_size,
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  if( cc_map_size( src ) == 0 ) // Also handles placeholder.
+  {
+    if( cc_map_hdr( src )->allocator )
+      return cc_map_init_with_allocator( cc_map_hdr( src )->allocator, el_size, layout );
+
+    return (void *)&cc_map_placeholder;
+  }
+
+  cc_map_hdr_ty *new_cntr = (cc_map_hdr_ty *)cc_map_copy_table( src, el_size, layout, realloc_ );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+#ifdef CC_INCREMENTAL_REHASH
+  // The copy's old table is a copy of the source map's old table, so the migration simply continues in both maps.
+  if( cc_map_hdr( src )->old_cntr )
+  {
+    new_cntr->old_cntr = cc_map_copy_table( cc_map_hdr( src )->old_cntr, el_size, layout, realloc_ );
+    if( CC_UNLIKELY( !new_cntr->old_cntr ) )
+    {
+      cc_allocator_free( new_cntr->allocator, free_, new_cntr );
+      return NULL;
+    }
+  }
+#else
+  (void)free_;
+#endif
+
+  return new_cntr;
+}
+
+// Returns the number of bytes a table with the specified capacity occupies in a snapshot, i.e. the size of its
+// allocation minus the size of the header.
+static inline size_t cc_map_snapshot_table_size(
+  size_t cap,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  size_t metadata_offset;
+  size_t allocation_size;
+  cc_map_allocation_details( cap, el_size, layout, &metadata_offset, &allocation_size );
+  return allocation_size - sizeof( cc_map_hdr_ty );
+}
+
+// Collects the tables that a snapshot of the map contains into tables and returns their number.
+static inline size_t cc_map_snapshot_tables(
+  void *cntr,
+  void **tables
+)
+{
+  if( cc_map_is_placeholder( cntr ) )
+    return 0;
+
+  tables[ 0 ] = cntr;
+
+#ifdef CC_INCREMENTAL_REHASH
+  if( cc_map_hdr( cntr )->old_cntr )
+  {
+    tables[ 1 ] = cc_map_hdr( cntr )->old_cntr;
+    return 2;
+  }
+#endif
+
+  return 1;
+}
+
+// Returns the number of bytes needed to store a snapshot of the map.
+static inline size_t cc_map_snapshot_size(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  void *tables[ CC_SNAPSHOT_MAX_TABLES ];
+  size_t table_count = cc_map_snapshot_tables( cntr, tables );
+
+  size_t size = sizeof( cc_snapshot_hdr_ty );
+  for( size_t i = 0; i < table_count; ++i )
+    size += cc_snapshot_record_size( cc_map_snapshot_table_size( cc_map_cap( tables[ i ] ), el_size, layout ) );
+
+  return size;
+}
+
+// Writes a snapshot of the map to buf, which must be large enough to hold it.
+// The buckets and metadata are written verbatim, so loading the snapshot requires no rehashing.
+static inline void cc_map_write_snapshot(
+  void *cntr,
+  void *buf,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  cc_snapshot_hdr_ty hdr;
+  cc_snapshot_init_hdr( &hdr, cntr_id, el_size, layout, CC_SNAPSHOT_MAP_OPTIONS );
+
+  void *tables[ CC_SNAPSHOT_MAX_TABLES ];
+  hdr.table_count = cc_map_snapshot_tables( cntr, tables );
+
+  char *record = (char *)buf + sizeof( cc_snapshot_hdr_ty );
+  for( size_t i = 0; i < hdr.table_count; ++i )
+  {
+    hdr.sizes[ i ] = cc_map_hdr( tables[ i ] )->size;
+    hdr.caps[ i ] = cc_map_cap( tables[ i ] );
+    record = cc_snapshot_write_record(
+      record,
+      (char *)tables[ i ] + sizeof( cc_map_hdr_ty ),
+      cc_map_snapshot_table_size( cc_map_cap( tables[ i ] ), el_size, layout )
+    );
+  }
+
+#ifdef CC_INCREMENTAL_REHASH
+  hdr.migration_bucket = cc_map_hdr( cntr )->migration_bucket;
+#endif
+
+  memcpy( buf, &hdr, sizeof( cc_snapshot_hdr_ty ) );
+}
+
+// Creates a map from the snapshot in buf, of buf_size bytes.
+// If is_view is true, the map is a view of the snapshot that uses the snapshot's memory for its tables and their
+// headers, for which buf must be suitably aligned.
+// Otherwise, the map is a copy allocated via realloc_.
+// In either case, no rehashing occurs.
+// Returns a pointer to the map, or NULL if the snapshot is invalid, buf is misaligned, or an allocation failure
+// occurred.
+static inline void *cc_map_load_snapshot(
+  void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout,
+  bool is_view,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_snapshot_hdr_ty hdr;
+  if( !cc_snapshot_read_hdr( &hdr, buf, buf_size, cntr_id, el_size, layout, CC_SNAPSHOT_MAP_OPTIONS ) )
+    return NULL;
+
+  if( hdr.table_count == 0 )
+    return (void *)&cc_map_placeholder;
+
+#ifdef CC_INCREMENTAL_REHASH
+  if( hdr.table_count == 2 && hdr.migration_bucket > hdr.caps[ 1 ] )
+    return NULL;
+#else
+  // A snapshot taken mid-migration can only be loaded if incremental rehashing is enabled.
+  if( hdr.table_count == 2 )
+    return NULL;
+#endif
+
+  if( is_view && (uintptr_t)buf % alignof( cc_max_align_ty ) )
+    return NULL;
+
+  // Validate the tables' dimensions before creating any of them.
+  size_t table_sizes[ CC_SNAPSHOT_MAX_TABLES ];
+  size_t required_size = sizeof( cc_snapshot_hdr_ty );
+  for( size_t i = 0; i < hdr.table_count; ++i )
+  {
+    uint64_t cap = hdr.caps[ i ];
+    if(
+      cap < CC_MAP_MIN_NONZERO_BUCKET_COUNT ||
+      ( cap & ( cap - 1 ) ) ||
+      cap > SIZE_MAX / 4 / ( CC_BUCKET_SIZE( el_size, layout ) + sizeof( uint16_t ) ) ||
+      hdr.sizes[ i ] > cap
+    )
+      return NULL;
+
+    table_sizes[ i ] = cc_map_snapshot_table_size( (size_t)cap, el_size, layout );
+    required_size += cc_snapshot_record_size( table_sizes[ i ] );
+  }
+
+  if( buf_size < required_size )
+    return NULL;
+
+  // The array is initialized only to silence a superfluous maybe-uninitialized warning under GCC, which cannot see that
+  // the zero table count was handled above.
+  cc_map_hdr_ty *tables[ CC_SNAPSHOT_MAX_TABLES ] = { NULL };
+  char *record = (char *)buf + sizeof( cc_snapshot_hdr_ty );
+  for( size_t i = 0; i < hdr.table_count; ++i )
+  {
+    if( is_view )
+    {
+      tables[ i ] = (cc_map_hdr_ty *)( record + CC_SNAPSHOT_SLOT_SIZE - sizeof( cc_map_hdr_ty ) );
+      tables[ i ]->allocator = (cc_allocator *)&cc_snapshot_view_allocator;
+    }
+    else
+    {
+      tables[ i ] = (cc_map_hdr_ty *)realloc_( NULL, sizeof( cc_map_hdr_ty ) + table_sizes[ i ] );
+      if( CC_UNLIKELY( !tables[ i ] ) )
+      {
+        if( i )
+          free_( tables[ 0 ] );
+
+        return NULL;
+      }
+
+      memcpy( (char *)tables[ i ] + sizeof( cc_map_hdr_ty ), record + CC_SNAPSHOT_SLOT_SIZE, table_sizes[ i ] );
+      tables[ i ]->allocator = NULL;
+    }
+
+    size_t metadata_offset;
+    size_t allocation_size;
+    cc_map_allocation_details( (size_t)hdr.caps[ i ], el_size, layout, &metadata_offset, &allocation_size );
+
+    tables[ i ]->size = (size_t)hdr.sizes[ i ];
+    tables[ i ]->cap_mask = (size_t)hdr.caps[ i ] - 1;
+    tables[ i ]->metadata = (uint16_t *)( (char *)tables[ i ] + metadata_offset );
+#ifdef CC_INCREMENTAL_REHASH
+    tables[ i ]->old_cntr = NULL;
+    tables[ i ]->migration_bucket = 0;
+#endif
+#ifdef CC_STATS
+    memset( &tables[ i ]->counters, 0, sizeof( cc_map_counters_ty ) );
+#endif
+
+    record += cc_snapshot_record_size( table_sizes[ i ] );
+  }
+
+#ifdef CC_INCREMENTAL_REHASH
+  if( hdr.table_count == 2 )
+  {
+    tables[ 0 ]->old_cntr = tables[ 1 ];
+    tables[ 0 ]->migration_bucket = (size_t)hdr.migration_bucket;
+  }
+#endif
+
+  return tables[ 0 ];
+}
+
+// Initializes a map from a copy of the snapshot in buf, of buf_size bytes.
+// Returns a pointer to the map, or NULL if the snapshot is invalid or an allocation failure occurred.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_map_init_from_snapshot(
+  const void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_load_snapshot( (void *)buf, buf_size, cntr_id, el_size, layout, false, realloc_, free_ );
+}
+
+// Initializes a map that is a view of the snapshot in buf, of buf_size bytes.
+// Returns a pointer to the map, or NULL if the snapshot is invalid or buf is misaligned.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_map_init_view_of_snapshot(
+  void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return cc_map_load_snapshot(
+    buf,
+    buf_size,
+    cntr_id,
+    el_size,
+    layout,
+    true,
+    NULL, // Unused.
+    NULL  // Unused.
+  );
+}
+
+// Erases all key-element pairs, calling the destructors for the key and element types if necessary, without changing
+// the map's capacity.
+// If CC_INCREMENTAL_REHASH is defined, the old table, if any, is freed.
+static inline void cc_map_clear(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+#ifdef CC_INCREMENTAL_REHASH
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr )
+  {
+    cc_map_clear( old_cntr, el_size, layout, el_dtor, key_dtor, free_ );
+    cc_allocator_free( cc_map_hdr( cntr )->allocator, free_, old_cntr );
+    cc_map_hdr( cntr )->old_cntr = NULL;
+    cc_map_hdr( cntr )->migration_bucket = 0;
+  }
+#else
+  (void)free_;
+#endif
+
+  if( cc_map_size( cntr ) == 0 ) // Also handles placeholder.
+    return;
+
+  // Without destructors, the metadata can simply be zeroed in bulk.
+  if( !key_dtor && !el_dtor )
+    memset( cc_map_hdr( cntr )->metadata, 0x00, cc_map_cap( cntr ) * sizeof( uint16_t ) );
+  else
+    for(
+      size_t bucket = cc_map_first_occupied( cntr, 0 );
+      bucket < cc_map_cap( cntr );
+      bucket = cc_map_first_occupied( cntr, bucket + 1 )
+    )
+    {
+      if( key_dtor )
+        key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+
+      if( el_dtor )
+        el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+
+      cc_map_hdr( cntr )->metadata[ bucket ] = CC_MAP_EMPTY;
+    }
+
+  cc_map_hdr( cntr )->size = 0;
+}
+
+// Clears the map and frees its memory if is not a placeholder.
+static inline void cc_map_cleanup(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_map_clear( cntr, el_size, layout, el_dtor, key_dtor, free_ );
+  cc_map_free( cntr, free_ );
+}
+
+#ifdef CC_STATS
+
+// Adds the chains of one table to the statistics.
+// A successful lookup of the nth key in a chain probes n buckets, and an unsuccessful lookup probes every bucket in the
+// chain beginning at the key's home bucket or, if there is no such chain, only the home bucket itself.
+// Hence, the total number of probes for looking up every key, and for looking up a nonexisting key in every possible
+// home bucket, are accumulated into probes_hit and probes_miss, respectively.
+// A flat table counts as a single chain containing all its key-element pairs, since lookups compare the key with
+// each of them in turn.
+static inline void cc_map_add_table_stats(
+  void *cntr,
+  cc_stats *stats,
+  size_t *probes_hit,
+  size_t *probes_miss
+)
+{
+  if( cc_map_is_flat( cntr ) )
+  {
+    size_t length = cc_map_hdr( cntr )->size;
+    if( length )
+    {
+      ++stats->chain_counts[ ( length < CC_STATS_CHAIN_LENGTHS ? length : CC_STATS_CHAIN_LENGTHS ) - 1 ];
+      if( length > stats->max_chain_length )
+        stats->max_chain_length = length;
+    }
+
+    *probes_hit += length * ( length + 1 ) / 2;
+    *probes_miss += length * cc_map_cap( cntr );
+    return;
+  }
+
+  for( size_t bucket = 0; bucket < cc_map_cap( cntr ); ++bucket )
+  {
+    uint16_t metadatum = cc_map_hdr( cntr )->metadata[ bucket ];
+
+    if(
+      metadatum != CC_MAP_EMPTY &&
+      ( metadatum & CC_MAP_DISPLACEMENT_MASK ) != CC_MAP_DISPLACEMENT_MASK &&
+      ( metadatum & CC_MAP_DISPLACEMENT_MASK ) > stats->max_displacement
+    )
+      stats->max_displacement = metadatum & CC_MAP_DISPLACEMENT_MASK;
+
+    if( !( metadatum & CC_MAP_IN_HOME_BUCKET_MASK ) )
+    {
+      ++*probes_miss;
+      continue;
+    }
+
+    size_t length = 1;
+    size_t link = bucket;
+    while( ( cc_map_hdr( cntr )->metadata[ link ] & CC_MAP_DISPLACEMENT_MASK ) != CC_MAP_DISPLACEMENT_MASK )
+    {
+      link = ( bucket + cc_quadratic( cc_map_hdr( cntr )->metadata[ link ] & CC_MAP_DISPLACEMENT_MASK ) ) &
+        cc_map_hdr( cntr )->cap_mask;
+      ++length;
+    }
+
+    ++stats->chain_counts[ ( length < CC_STATS_CHAIN_LENGTHS ? length : CC_STATS_CHAIN_LENGTHS ) - 1 ];
+    if( length > stats->max_chain_length )
+      stats->max_chain_length = length;
+
+    *probes_hit += length * ( length + 1 ) / 2;
+    *probes_miss += length;
+  }
+}
+
+// If an incremental migration is in progress, both tables contribute to the statistics, and the unsuccessful lookup
+// figure includes the probes of both tables, since such a lookup checks both.
+static inline void cc_map_get_stats( void *cntr, cc_stats *stats )
+{
+  memset( stats, 0, sizeof( cc_stats ) );
+  stats->size = cc_map_size( cntr );
+  stats->cap = cc_map_cap( cntr );
+  stats->displacement_limit = CC_MAP_DISPLACEMENT_MASK;
+  stats->evictions = cc_map_hdr( cntr )->counters.evictions;
+  stats->rehashes = cc_map_hdr( cntr )->counters.rehashes;
+  stats->rehash_retries = cc_map_hdr( cntr )->counters.rehash_retries;
+  stats->migrations = cc_map_hdr( cntr )->counters.migrations;
+
+  if( cc_map_is_placeholder( cntr ) )
+    return;
+
+  size_t probes_hit = 0;
+  size_t probes_miss = 0;
+  cc_map_add_table_stats( cntr, stats, &probes_hit, &probes_miss );
+  stats->avg_probes_miss = (double)probes_miss / (double)cc_map_cap( cntr );
+
+#ifdef CC_INCREMENTAL_REHASH
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr )
+  {
+    probes_miss = 0;
+    cc_map_add_table_stats( old_cntr, stats, &probes_hit, &probes_miss );
+    stats->avg_probes_miss += (double)probes_miss / (double)cc_map_cap( old_cntr );
+  }
+#endif
+
+  if( stats->size )
+    stats->avg_probes_hit = (double)probes_hit / (double)stats->size;
+}
+
+#endif
+
+// If an incremental migration is in progress, the old table also counts towards the allocated memory.
+static inline cc_mem_usage cc_map_memory_usage( void *cntr, size_t el_size, uint64_t layout )
+{
+  if( cc_map_is_placeholder( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+  size_t metadata_offset;
+  size_t allocated;
+  cc_map_allocation_details( cc_map_cap( cntr ), el_size, layout, &metadata_offset, &allocated );
+
+#ifdef CC_INCREMENTAL_REHASH
+  void *old_cntr = cc_map_hdr( cntr )->old_cntr;
+  if( old_cntr )
+  {
+    size_t old_allocated;
+    cc_map_allocation_details( cc_map_cap( old_cntr ), el_size, layout, &metadata_offset, &old_allocated );
+    allocated += old_allocated;
+  }
+#endif
+
+  return cc_make_mem_usage( allocated, ( el_size + CC_KEY_SIZE( layout ) ) * cc_map_size( cntr ) );
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                        Set                                                         */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A set is implemented as a map where the key and element are combined into one space in memory.
+// Hence, it reuses the functions for map, except:
+// * The key offset inside the bucket is zero.
+//   This is handled at the API-macro level via the cc_layout function and associated macros.
+// * The element size passed into map functions is zero in order to avoid double memcpy-ing.
+
+static inline size_t cc_set_size( void *cntr )
+{
+  return cc_map_size( cntr );
+}
+
+static inline size_t cc_set_cap( void *cntr )
+{
+  return cc_map_cap( cntr );
+}
+
+static inline cc_allocing_fn_result_ty cc_set_reserve(
+  void *cntr,
+  size_t n,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  double max_load,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_reserve( cntr, n, 0 /* Zero element size */, layout, hash, max_load, realloc_, free_ );
+}
+
+static inline cc_allocing_fn_result_ty cc_set_insert(
+  void *cntr,
+  void *key,
+  bool replace,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_insert(
+    cntr,
+    cntr,     // Dummy pointer for element as memcpy-ing to a NULL pointer is undefined behavior even when size is zero.
+    key,
+    replace,
+    0,        // Zero element size.
+    layout,
+    hash,
+    cmpr,
+    max_load,
+    el_dtor,
+    NULL,     // Only one destructor.
+    realloc_,
+    free_
+  );
+}
+
+static inline cc_allocing_fn_result_ty cc_set_insert_from_hash(
+  void *cntr,
+  void *key,
+  size_t key_hash,
+  bool replace,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_insert_from_hash(
+    cntr,
+    cntr,     // Dummy pointer for element as memcpy-ing to a NULL pointer is undefined behavior even when size is zero.
+    key,
+    key_hash,
+    replace,
+    0,        // Zero element size.
+    layout,
+    hash,
+    cmpr,
+    max_load,
+    el_dtor,
+    NULL,     // Only one destructor.
+    realloc_,
+    free_
+  );
+}
+
+static inline void *cc_set_get(
+  void *cntr,
+  void *key,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  return cc_map_get( cntr, key, 0 /* Zero element size */, layout, hash, cmpr );
+}
+
+static inline void *cc_set_get_from_hash(
+  void *cntr,
+  void *key,
+  size_t key_hash,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  return cc_map_get_from_hash( cntr, key, key_hash, 0 /* Zero element size */, layout, cmpr );
+}
+
+static inline size_t cc_set_get_n(
+  void *cntr,
+  const void *keys,
+  size_t n,
+  void **itrs,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  return cc_map_get_n( cntr, keys, n, itrs, 0 /* Zero element size */, layout, hash, cmpr );
+}
+
+static inline void *cc_set_erase_itr(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_map_erase_itr(
+    cntr,
+    itr,
+    0,       // Zero element size.
+    layout,
+    hash,
+    el_dtor,
+    NULL,    // Only one destructor.
+    NULL     // Dummy.
+  );
+}
+
+static inline void *cc_set_erase(
+  void *cntr,
+  void *key,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_map_erase(
+    cntr,
+    key,
+    0,       // Zero element size.
+    layout,
+    hash,
+    cmpr,
+    el_dtor,
+    NULL,    // Only one destructor.
+    NULL     // Dummy.
+  );
+}
+
+static inline cc_allocing_fn_result_ty cc_set_insert_n(
+  void *cntr,
+  void *els,
+  size_t n,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_insert_n(
+    cntr,
+    els,
+    els,      // Dummy pointer for elements as memcpy-ing from NULL is undefined behavior even when size is zero.
+    n,
+    0,        // Zero element size.
+    layout,
+    hash,
+    cmpr,
+    max_load,
+    el_dtor,
+    NULL,     // Only one destructor.
+    realloc_,
+    free_
+  );
+}
+
+static inline size_t cc_set_erase_n(
+  void *cntr,
+  const void *keys,
+  size_t n,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_map_erase_n(
+    cntr,
+    keys,
+    n,
+    0,       // Zero element size.
+    layout,
+    hash,
+    cmpr,
+    el_dtor,
+    NULL,    // Only one destructor.
+    NULL     // Dummy.
+  );
+}
+
+static inline size_t cc_set_filter(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_filter(
+    cntr,
+    pred,
+    ctx,
+    keep_if,
+    0,       // Zero element size.
+    layout,
+    el_dtor,
+    NULL,    // Only one destructor.
+    free_
+  );
+}
+
+static inline cc_allocing_fn_result_ty cc_set_shrink(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  double max_load,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_shrink( cntr, 0 /* Zero element size */, layout, hash, max_load, realloc_, free_ );
+}
+
+static inline void *cc_set_init_clone(
+  void *src,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_init_clone( src, 0 /* Zero element size */, layout, realloc_, free_ );
+}
+
+static inline void *cc_set_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_init_with_allocator( allocator, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_init_with_fixed_buffer(
+  cc_fixed_buf_hdr_ty *buf,
+  void *storage,
+  size_t storage_size,
+  size_t slot_count,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_init_with_fixed_buffer( buf, storage, storage_size, slot_count, 0 /* Zero element size */, layout );
+}
+
+static inline size_t cc_set_snapshot_size(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_snapshot_size( cntr, 0 /* Zero element size */, layout );
+}
+
+static inline void cc_set_write_snapshot(
+  void *cntr,
+  void *buf,
+  size_t cntr_id,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  cc_map_write_snapshot( cntr, buf, cntr_id, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_init_from_snapshot(
+  const void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_map_init_from_snapshot( buf, buf_size, cntr_id, 0 /* Zero element size */, layout, realloc_, free_ );
+}
+
+static inline void *cc_set_init_view_of_snapshot(
+  void *buf,
+  size_t buf_size,
+  size_t cntr_id,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_init_view_of_snapshot( buf, buf_size, cntr_id, 0 /* Zero element size */, layout );
+}
+
+static inline void cc_set_clear(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_map_clear( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
+}
+
+static inline void cc_set_cleanup(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_map_cleanup( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
+}
+
+#ifdef CC_STATS
+
+static inline void cc_set_get_stats( void *cntr, cc_stats *stats )
+{
+  cc_map_get_stats( cntr, stats );
+}
+
+#endif
+
+static inline cc_mem_usage cc_set_memory_usage( void *cntr, CC_UNUSED( size_t, el_size ), uint64_t layout )
+{
+  return cc_map_memory_usage( cntr, 0 /* Zero element size */, layout );
+}
+
+// DEPRECATED.
+static inline void *cc_set_r_end( void *cntr )
+{
+  return cc_map_r_end( cntr );
+}
+
+static inline void *cc_set_end(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_end( cntr, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_first(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_first( cntr, 0 /* Zero element size */, layout );
+}
+
+// DEPRECATED.
+static inline void *cc_set_last(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_last( cntr, 0 /* Zero element size */, layout );
+}
+
+// DEPRECATED.
+static inline void *cc_set_prev(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_prev( cntr, itr, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_next(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_next( cntr, itr, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_cursor_first(
+  void *cntr,
+  cc_cursor *cursor,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_cursor_first( cntr, cursor, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_cursor_next(
+  void *cntr,
+  cc_cursor *cursor,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_map_cursor_next( cntr, cursor, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_set_cursor_erase(
+  void *cntr,
+  cc_cursor *cursor,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  return cc_map_cursor_erase(
+    cntr,
+    cursor,
+    0,       // Zero element size.
+    layout,
+    hash,
+    el_dtor,
+    NULL,    // Only one destructor.
+    NULL     // Dummy.
+  );
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                   Concurrent map                                                   */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A concurrent map is a fixed array of shards, each consisting of an ordinary map and a reader-writer spinlock.
+// A key's shard is selected by the bits of its hash code immediately below the four bits that form the hash fragment
+// inside each shard, so that neither the shard's bucket index (the low bits) nor the hash fragment are weakened.
+// Every operation locks only one shard, via which it calls the map functions.
+// Lookups take the shard's lock in shared mode, so they only contend with one another on the lock word itself and never
+// wait unless a writer holds or is waiting for the same shard.
+// A seqlock would allow truly lock-free reads, but a reader racing a rehash could then dereference a bucket array that
+// the writer has already freed.
+// Since pointer-iterators into a shard would be invalidated by concurrent insertions, elements are copied out while the
+// shard is still locked rather than returned by pointer.
+
+// The shard count is rounded up to a power of two no greater than this value.
+#define CC_CMAP_MAX_SHARDS 1024
+
+// The size of a shard, chosen to match a typical cache line so that threads working in different shards rarely
+// contend for the same line.
+#define CC_CMAP_SHARD_SIZE 64
+
+// Atomic operations on a shard's lock word.
+// The lock word holds the number of readers, along with flags indicating that a writer holds the lock or is waiting for
+// it.
+// New readers wait while either flag is set, so that writers cannot be starved by a constant stream of readers.
+// cc_cmap_lock_ty is the type of the lock word's value, and cc_cmap_lock_word_ty is the type of the lock word itself.
+// The operations use GCC/Clang or MSVC intrinsics if available and C11 atomics otherwise.
+// If none of these are available, CC_CMAP_HAS_ATOMICS is 0, and declaring a concurrent map causes a compiler error.
+
+#if defined( __GNUC__ )
+
+#define CC_CMAP_HAS_ATOMICS 1
+typedef unsigned int cc_cmap_lock_ty;
+typedef cc_cmap_lock_ty cc_cmap_lock_word_ty;
+
+static inline cc_cmap_lock_ty cc_cmap_lock_load( cc_cmap_lock_word_ty *lock )
+{
+  return __atomic_load_n( lock, __ATOMIC_RELAXED );
+}
+
+static inline bool cc_cmap_lock_cas( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty expected, cc_cmap_lock_ty desired )
+{
+  return __atomic_compare_exchange_n( lock, &expected, desired, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+}
+
+static inline void cc_cmap_lock_or( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  __atomic_fetch_or( lock, bits, __ATOMIC_RELAXED );
+}
+
+static inline void cc_cmap_lock_release( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  __atomic_fetch_sub( lock, bits, __ATOMIC_RELEASE );
+}
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define CC_CMAP_PAUSE() __builtin_ia32_pause()
+#endif
+
+#elif defined( _MSC_VER )
+
+#include <intrin.h>
+
+#define CC_CMAP_HAS_ATOMICS 1
+typedef long cc_cmap_lock_ty;
+typedef cc_cmap_lock_ty cc_cmap_lock_word_ty;
+
+static inline cc_cmap_lock_ty cc_cmap_lock_load( cc_cmap_lock_word_ty *lock )
+{
+  return *(volatile cc_cmap_lock_ty *)lock;
+}
+
+static inline bool cc_cmap_lock_cas( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty expected, cc_cmap_lock_ty desired )
+{
+  return _InterlockedCompareExchange( lock, desired, expected ) == expected;
+}
+
+static inline void cc_cmap_lock_or( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  _InterlockedOr( lock, bits );
+}
+
+static inline void cc_cmap_lock_release( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  _InterlockedExchangeAdd( lock, -bits );
+}
+
+#if defined( _M_X64 ) || defined( _M_IX86 )
+#define CC_CMAP_PAUSE() _mm_pause()
+#endif
+
+#elif defined( __STDC_VERSION__ ) && __STDC_VERSION__ >= 201112L && !defined( __STDC_NO_ATOMICS__ )
+
+#include <stdatomic.h>
+
+#define CC_CMAP_HAS_ATOMICS 1
+typedef unsigned int cc_cmap_lock_ty;
+typedef _Atomic cc_cmap_lock_ty cc_cmap_lock_word_ty;
+
+static inline cc_cmap_lock_ty cc_cmap_lock_load( cc_cmap_lock_word_ty *lock )
+{
+  return atomic_load_explicit( lock, memory_order_relaxed );
+}
+
+static inline bool cc_cmap_lock_cas( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty expected, cc_cmap_lock_ty desired )
+{
+  return atomic_compare_exchange_weak_explicit( lock, &expected, desired, memory_order_acquire, memory_order_relaxed );
+}
+
+static inline void cc_cmap_lock_or( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  atomic_fetch_or_explicit( lock, bits, memory_order_relaxed );
+}
+
+static inline void cc_cmap_lock_release( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  atomic_fetch_sub_explicit( lock, bits, memory_order_release );
+}
+
+#else
+
+// These placeholders only allow the rest of the header to compile, since no concurrent map can be declared.
+
+#define CC_CMAP_HAS_ATOMICS 0
+typedef unsigned int cc_cmap_lock_ty;
+typedef cc_cmap_lock_ty cc_cmap_lock_word_ty;
+
+static inline cc_cmap_lock_ty cc_cmap_lock_load( cc_cmap_lock_word_ty *lock )
+{
+  return *lock;
+}
+
+static inline bool cc_cmap_lock_cas( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty expected, cc_cmap_lock_ty desired )
+{
+  if( *lock != expected )
+    return false;
+
+  *lock = desired;
+  return true;
+}
+
+static inline void cc_cmap_lock_or( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  *lock |= bits;
+}
+
+static inline void cc_cmap_lock_release( cc_cmap_lock_word_ty *lock, cc_cmap_lock_ty bits )
+{
+  *lock -= bits;
+}
+
+#endif
+
+#ifndef CC_CMAP_PAUSE
+#define CC_CMAP_PAUSE() (void)0
+#endif
+
+#define CC_CMAP_WRITER         0x40000000
+#define CC_CMAP_WRITER_WAITING 0x20000000
+
+static inline void cc_cmap_lock_shared( cc_cmap_lock_word_ty *lock )
+{
+  while( true )
+  {
+    cc_cmap_lock_ty state = cc_cmap_lock_load( lock );
+    if( !( state & ( CC_CMAP_WRITER | CC_CMAP_WRITER_WAITING ) ) && cc_cmap_lock_cas( lock, state, state + 1 ) )
+      return;
+
+    CC_CMAP_PAUSE();
+  }
+}
+
+static inline void cc_cmap_unlock_shared( cc_cmap_lock_word_ty *lock )
+{
+  cc_cmap_lock_release( lock, 1 );
+}
+
+// Acquiring the lock clears the waiting flag, which any other waiting writers then set again.
+static inline void cc_cmap_lock_exclusive( cc_cmap_lock_word_ty *lock )
+{
+  while( true )
+  {
+    cc_cmap_lock_ty state = cc_cmap_lock_load( lock );
+    if( !( state & ~(cc_cmap_lock_ty)CC_CMAP_WRITER_WAITING ) && cc_cmap_lock_cas( lock, state, CC_CMAP_WRITER ) )
+      return;
+
+    if( !( state & CC_CMAP_WRITER_WAITING ) )
+      cc_cmap_lock_or( lock, CC_CMAP_WRITER_WAITING );
+
+    CC_CMAP_PAUSE();
+  }
+}
+
+static inline void cc_cmap_unlock_exclusive( cc_cmap_lock_word_ty *lock )
+{
+  cc_cmap_lock_release( lock, CC_CMAP_WRITER );
+}
+
+// The map is placed first so that no padding is needed between the members on common platforms.
+typedef struct
+{
+  void *map;
+  cc_cmap_lock_word_ty lock;
+  char padding[ CC_CMAP_SHARD_SIZE - sizeof( void * ) - sizeof( cc_cmap_lock_word_ty ) ];
+} cc_cmap_shard_ty;
+
+// The shards follow the header in memory, aligned to CC_CMAP_SHARD_SIZE so that each shard occupies exactly one cache
+// line.
+// The header is allocated with CC_CMAP_SHARD_SIZE - 1 bytes of slack for this purpose.
+typedef struct
+{
+  size_t shard_count;
+  unsigned int shard_shift;
+  void *shards;
+} cc_cmap_hdr_ty;
+
+// A concurrent map initialized via init, or cleaned up, has no shards, so all insertions into it fail.
+static const cc_cmap_hdr_ty cc_cmap_placeholder = { 0, 0, NULL };
+
+static inline cc_cmap_hdr_ty *cc_cmap_hdr( void *cntr )
+{
+  return (cc_cmap_hdr_ty *)cntr;
+}
+
+static inline cc_cmap_shard_ty *cc_cmap_shards( void *cntr )
+{
+  return (cc_cmap_shard_ty *)cc_cmap_hdr( cntr )->shards;
+}
+
+static inline cc_cmap_shard_ty *cc_cmap_shard( void *cntr, size_t key_hash )
+{
+  return cc_cmap_shards( cntr ) +
+    ( ( key_hash >> cc_cmap_hdr( cntr )->shard_shift ) & ( cc_cmap_hdr( cntr )->shard_count - 1 ) );
+}
+
+// Allocates a concurrent map with the specified number of shards, each holding an empty map.
+// Returns a pointer to the new container, or NULL in the case of memory allocation failure.
+static inline void *cc_cmap_init_sharded( size_t shard_count, cc_realloc_fnptr_ty realloc_ )
+{
+  size_t count = 1;
+  unsigned int bits = 0;
+  while( count < shard_count && count < CC_CMAP_MAX_SHARDS )
+  {
+    count *= 2;
+    ++bits;
+  }
+
+  cc_cmap_hdr_ty *new_cntr = (cc_cmap_hdr_ty *)realloc_( NULL, sizeof( cc_cmap_hdr_ty ) + CC_CMAP_SHARD_SIZE - 1 +
+    sizeof( cc_cmap_shard_ty ) * count );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+  char *shards = (char *)( new_cntr + 1 );
+  new_cntr->shards = shards + ( -(uintptr_t)shards & ( CC_CMAP_SHARD_SIZE - 1 ) );
+  new_cntr->shard_count = count;
+  new_cntr->shard_shift = sizeof( size_t ) * CHAR_BIT - 4 /* Hash fragment bits */ - bits;
+
+  for( size_t i = 0; i < count; ++i )
+  {
+    cc_cmap_shards( new_cntr )[ i ].map = (void *)&cc_map_placeholder;
+    cc_cmap_shards( new_cntr )[ i ].lock = 0;
+  }
+
+  return new_cntr;
+}
+
+// Returns the total size of the shards.
+// As each shard is locked in turn, the result is only a snapshot if other threads are modifying the container.
+static inline size_t cc_cmap_size( void *cntr )
+{
+  size_t size = 0;
+  for( size_t i = 0; i < cc_cmap_hdr( cntr )->shard_count; ++i )
+  {
+    cc_cmap_lock_shared( &cc_cmap_shards( cntr )[ i ].lock );
+    size += cc_map_size( cc_cmap_shards( cntr )[ i ].map );
+    cc_cmap_unlock_shared( &cc_cmap_shards( cntr )[ i ].lock );
+  }
+
+  return size;
+}
+
+// Inserts a key-element pair into the key's shard via cc_map_insert.
+// If out is not NULL, the element now associated with the key - i.e. the new element, or the existing element if
+// replace is false - is copied into it before the shard is unlocked.
+// Returns a pointer that evaluates to true if the operation succeeded, or else NULL, which the API macros cast to bool.
+static inline void *cc_cmap_insert(
+  void *cntr,
+  void *el,
+  void *key,
+  bool replace,
+  void *out,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  double max_load,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  if( CC_UNLIKELY( !cc_cmap_hdr( cntr )->shard_count ) )
+    return NULL;
+
+  cc_cmap_shard_ty *shard = cc_cmap_shard( cntr, hash( key ) );
+  cc_cmap_lock_exclusive( &shard->lock );
+
+  cc_allocing_fn_result_ty result = cc_map_insert(
+    shard->map,
+    el,
+    key,
+    replace,
+    el_size,
+    layout,
+    hash,
+    cmpr,
+    max_load,
+    el_dtor,
+    key_dtor,
+    realloc_,
+    free_
+  );
+
+  shard->map = result.new_cntr;
+  if( result.other_ptr && out )
+    memcpy( out, result.other_ptr, el_size );
+
+  cc_cmap_unlock_exclusive( &shard->lock );
+  return result.other_ptr ? cc_dummy_true_ptr : NULL;
+}
+
+// Copies the element with the specified key into out.
+// Returns true, or false if no such element exists.
+static inline bool cc_cmap_get(
+  void *cntr,
+  void *key,
+  void *out,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  if( CC_UNLIKELY( !cc_cmap_hdr( cntr )->shard_count ) )
+    return false;
+
+  size_t key_hash = hash( key );
+  cc_cmap_shard_ty *shard = cc_cmap_shard( cntr, key_hash );
+  cc_cmap_lock_shared( &shard->lock );
+
+  void *itr = cc_map_get_from_hash( shard->map, key, key_hash, el_size, layout, cmpr );
+  if( itr )
+    memcpy( out, itr, el_size );
+
+  cc_cmap_unlock_shared( &shard->lock );
+  return itr;
+}
+
+static inline void *cc_cmap_erase(
+  void *cntr,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  cc_hash_fnptr_ty hash,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  if( CC_UNLIKELY( !cc_cmap_hdr( cntr )->shard_count ) )
+    return NULL;
+
+  cc_cmap_shard_ty *shard = cc_cmap_shard( cntr, hash( key ) );
+  cc_cmap_lock_exclusive( &shard->lock );
+  void *erased = cc_map_erase( shard->map, key, el_size, layout, hash, cmpr, el_dtor, key_dtor, free_ );
+  cc_cmap_unlock_exclusive( &shard->lock );
+  return erased;
+}
+
+// Clears each shard in turn.
+// Hence, elements inserted by other threads during the call may survive it.
+static inline void cc_cmap_clear(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  for( size_t i = 0; i < cc_cmap_hdr( cntr )->shard_count; ++i )
+  {
+    cc_cmap_lock_exclusive( &cc_cmap_shards( cntr )[ i ].lock );
+    cc_map_clear( cc_cmap_shards( cntr )[ i ].map, el_size, layout, el_dtor, key_dtor, free_ );
+    cc_cmap_unlock_exclusive( &cc_cmap_shards( cntr )[ i ].lock );
+  }
+}
+
+// Unlike the other concurrent map functions, this function must not be called while other threads are accessing the
+// container.
+static inline void cc_cmap_cleanup(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  for( size_t i = 0; i < cc_cmap_hdr( cntr )->shard_count; ++i )
+    cc_map_cleanup( cc_cmap_shards( cntr )[ i ].map, el_size, layout, el_dtor, key_dtor, free_ );
+
+  if( cntr != &cc_cmap_placeholder )
+    free_( cntr );
+}
+
+// As each shard is locked in turn, the result is only a snapshot if other threads are modifying the container.
+static inline cc_mem_usage cc_cmap_memory_usage( void *cntr, size_t el_size, uint64_t layout )
+{
+  if( cntr == &cc_cmap_placeholder )
+    return cc_make_mem_usage( 0, 0 );
+
+  cc_mem_usage usage = cc_make_mem_usage(
+    sizeof( cc_cmap_hdr_ty ) + CC_CMAP_SHARD_SIZE - 1 + sizeof( cc_cmap_shard_ty ) * cc_cmap_hdr( cntr )->shard_count,
+    0
+  );
+
+  for( size_t i = 0; i < cc_cmap_hdr( cntr )->shard_count; ++i )
+  {
+    cc_cmap_lock_shared( &cc_cmap_shards( cntr )[ i ].lock );
+    cc_mem_usage shard_usage = cc_map_memory_usage( cc_cmap_shards( cntr )[ i ].map, el_size, layout );
+    cc_cmap_unlock_shared( &cc_cmap_shards( cntr )[ i ].lock );
+
+    usage.allocated += shard_usage.allocated;
+    usage.payload += shard_usage.payload;
+    usage.overhead += shard_usage.overhead;
+  }
+
+  return usage;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                    Ring buffer                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// A ring is a fixed-capacity queue through which one producer thread passes elements to one consumer thread without
+// locks.
+// Its capacity is a power of two, and its head and tail are free-running counts of the elements popped and pushed, so
+// an index is reduced to a slot by masking and the size is always tail - head, even after the counts wrap around.
+// Only the producer writes the tail, and only the consumer writes the head.
+// Each side also keeps its own cached copy of the other side's index and rereads the real index (an acquire load that
+// usually incurs a cache miss) only when the cached copy suggests that the ring is full or empty.
+// Hence, push_n and pop_n amortize that cache-line transfer, along with the release store that publishes the new index,
+// over a whole batch of elements.
+
+// The size of a cache line.
+// The members written by the producer, those written by the consumer, and the elements each occupy their own lines so
+// that the two threads do not falsely share lines.
+#define CC_RING_LINE_SIZE 64
+
+// Atomic loads and stores of the head and tail.
+// cc_ring_index_ty is the type of the head and tail themselves.
+// The operations use GCC/Clang or MSVC intrinsics if available and C11 atomics otherwise.
+// If none of these are available, CC_RING_HAS_ATOMICS is 0, and declaring a ring causes a compiler error.
+
+#if defined( __GNUC__ )
+
+#define CC_RING_HAS_ATOMICS 1
+typedef size_t cc_ring_index_ty;
+
+static inline size_t cc_ring_index_load( cc_ring_index_ty *index )
+{
+  return __atomic_load_n( index, __ATOMIC_ACQUIRE );
+}
+
+static inline void cc_ring_index_store( cc_ring_index_ty *index, size_t value )
+{
+  __atomic_store_n( index, value, __ATOMIC_RELEASE );
+}
+
+#elif defined( _MSC_VER )
+
+// On x86 and x64, ordinary loads and stores already have acquire and release semantics, so only the compiler needs to
+// be prevented from reordering them.
+// Elsewhere, the interlocked intrinsics serve as full barriers.
+
+#define CC_RING_HAS_ATOMICS 1
+typedef size_t cc_ring_index_ty;
+
+static inline size_t cc_ring_index_load( cc_ring_index_ty *index )
+{
+#if defined( _M_X64 ) || defined( _M_IX86 )
+  size_t value = *(volatile size_t *)index;
+  _ReadWriteBarrier();
+  return value;
+#elif defined( _WIN64 )
+  return (size_t)_InterlockedOr64( (volatile __int64 *)index, 0 );
+#else
+  return (size_t)_InterlockedOr( (volatile long *)index, 0 );
+#endif
+}
+
+static inline void cc_ring_index_store( cc_ring_index_ty *index, size_t value )
+{
+#if defined( _M_X64 ) || defined( _M_IX86 )
+  _ReadWriteBarrier();
+  *(volatile size_t *)index = value;
+#elif defined( _WIN64 )
+  _InterlockedExchange64( (volatile __int64 *)index, (__int64)value );
+#else
+  _InterlockedExchange( (volatile long *)index, (long)value );
+#endif
+}
+
+#elif defined( __STDC_VERSION__ ) && __STDC_VERSION__ >= 201112L && !defined( __STDC_NO_ATOMICS__ )
+
+#include <stdatomic.h>
+
+#define CC_RING_HAS_ATOMICS 1
+typedef _Atomic size_t cc_ring_index_ty;
+
+static inline size_t cc_ring_index_load( cc_ring_index_ty *index )
+{
+  return atomic_load_explicit( index, memory_order_acquire );
+}
+
+static inline void cc_ring_index_store( cc_ring_index_ty *index, size_t value )
+{
+  atomic_store_explicit( index, value, memory_order_release );
+}
+
+#else
+
+// These placeholders only allow the rest of the header to compile, since no ring can be declared.
+
+#define CC_RING_HAS_ATOMICS 0
+typedef size_t cc_ring_index_ty;
+
+static inline size_t cc_ring_index_load( cc_ring_index_ty *index )
+{
+  return *index;
+}
+
+static inline void cc_ring_index_store( cc_ring_index_ty *index, size_t value )
+{
+  *index = value;
+}
+
+#endif
+
+// Ring header.
+// The elements immediately follow the header in memory.
+// The header is aligned to a cache line inside a memory block allocated with CC_RING_LINE_SIZE - 1 bytes of slack.
+typedef struct
+{
+  // Written by the producer.
+  cc_ring_index_ty tail;
+  size_t cached_head;
+  char producer_padding[ CC_RING_LINE_SIZE - sizeof( cc_ring_index_ty ) - sizeof( size_t ) ];
+  // Written by the consumer.
+  cc_ring_index_ty head;
+  size_t cached_tail;
+  char consumer_padding[ CC_RING_LINE_SIZE - sizeof( cc_ring_index_ty ) - sizeof( size_t ) ];
+  // Constant after initialization.
+  size_t cap;
+  void *block;
+  char padding[ CC_RING_LINE_SIZE - sizeof( size_t ) - sizeof( void * ) ];
+} cc_ring_hdr_ty;
+
+// A ring initialized via init, or cleaned up, has a capacity of zero, so all pushes onto it fail.
+// Every function checks the capacity before touching the head and tail because the placeholder is read-only.
+static const cc_ring_hdr_ty cc_ring_placeholder = { 0, 0, { 0 }, 0, 0, { 0 }, 0, NULL, { 0 } };
+
+static inline cc_ring_hdr_ty *cc_ring_hdr( void *cntr )
+{
+  return (cc_ring_hdr_ty *)cntr;
+}
+
+static inline void *cc_ring_el( void *cntr, size_t index, size_t el_size )
+{
+  return (char *)cntr + sizeof( cc_ring_hdr_ty ) + ( index & ( cc_ring_hdr( cntr )->cap - 1 ) ) * el_size;
+}
+
+// Copies n elements between the array arr and the slots beginning at the specified index, wrapping around the end of
+// the ring's storage if necessary.
+static inline void cc_ring_copy( void *cntr, size_t index, void *arr, size_t n, size_t el_size, bool into_ring )
+{
+  size_t first_n = cc_ring_hdr( cntr )->cap - ( index & ( cc_ring_hdr( cntr )->cap - 1 ) );
+  if( first_n > n )
+    first_n = n;
+
+  void *slots = cc_ring_el( cntr, index, el_size );
+  void *wrapped_slots = cc_ring_el( cntr, 0, el_size );
+  char *second_arr = (char *)arr + first_n * el_size;
+
+  if( into_ring )
+  {
+    memcpy( slots, arr, first_n * el_size );
+    memcpy( wrapped_slots, second_arr, ( n - first_n ) * el_size );
+  }
+  else
+  {
+    memcpy( arr, slots, first_n * el_size );
+    memcpy( second_arr, wrapped_slots, ( n - first_n ) * el_size );
+  }
+}
+
+// Allocates a ring with the specified capacity, rounded up to a power of two.
+// Returns a pointer to the new container, or NULL in the case of memory allocation failure.
+static inline void *cc_ring_init_with_cap( size_t cap, size_t el_size, cc_realloc_fnptr_ty realloc_ )
+{
+  if( cap > ( SIZE_MAX - sizeof( cc_ring_hdr_ty ) - CC_RING_LINE_SIZE ) / 2 / el_size )
+    return NULL;
+
+  size_t rounded_cap = 1;
+  while( rounded_cap < cap )
+    rounded_cap *= 2;
+
+  char *block = (char *)realloc_( NULL, CC_RING_LINE_SIZE - 1 + sizeof( cc_ring_hdr_ty ) + rounded_cap * el_size );
+  if( CC_UNLIKELY( !block ) )
+    return NULL;
+
+  cc_ring_hdr_ty *new_cntr = (cc_ring_hdr_ty *)( block + ( -(uintptr_t)block & ( CC_RING_LINE_SIZE - 1 ) ) );
+  new_cntr->tail = 0;
+  new_cntr->cached_head = 0;
+  new_cntr->head = 0;
+  new_cntr->cached_tail = 0;
+  new_cntr->cap = rounded_cap;
+  new_cntr->block = block;
+  return new_cntr;
+}
+
+static inline size_t cc_ring_cap( void *cntr )
+{
+  return cc_ring_hdr( cntr )->cap;
+}
+
+// Because the head and tail are read at slightly different times, the result is only a snapshot if the producer or
+// consumer is active during the call.
+// Reading the head first ensures that the result is never negative, and clamping it ensures that it never exceeds the
+// capacity.
+static inline size_t cc_ring_size( void *cntr )
+{
+  if( CC_UNLIKELY( !cc_ring_hdr( cntr )->cap ) )
+    return 0;
+
+  size_t head = cc_ring_index_load( &cc_ring_hdr( cntr )->head );
+  size_t size = cc_ring_index_load( &cc_ring_hdr( cntr )->tail ) - head;
+  return size < cc_ring_hdr( cntr )->cap ? size : cc_ring_hdr( cntr )->cap;
+}
+
+// Pushes n elements from the array els, but only if there is room for all of them.
+// Must only be called by the producer.
+// Returns a pointer that evaluates to true if the operation succeeded, or else NULL, which the API macros cast to bool.
+static inline void *cc_ring_push_n( void *cntr, void *els, size_t n, size_t el_size )
+{
+  cc_ring_hdr_ty *hdr = cc_ring_hdr( cntr );
+  if( CC_UNLIKELY( !hdr->cap ) )
+    return NULL;
+
+  size_t tail = hdr->tail;
+  if( hdr->cap - ( tail - hdr->cached_head ) < n )
+  {
+    hdr->cached_head = cc_ring_index_load( &hdr->head );
+    if( hdr->cap - ( tail - hdr->cached_head ) < n )
+      return NULL;
+  }
+
+  cc_ring_copy( cntr, tail, els, n, el_size, true );
+  cc_ring_index_store( &hdr->tail, tail + n );
+  return cc_dummy_true_ptr;
+}
+
+// Pops up to n elements into the array out.
+// Must only be called by the consumer.
+// Returns the number of elements popped.
+static inline size_t cc_ring_pop_n( void *cntr, void *out, size_t n, size_t el_size )
+{
+  cc_ring_hdr_ty *hdr = cc_ring_hdr( cntr );
+  if( CC_UNLIKELY( !hdr->cap ) )
+    return 0;
+
+  size_t head = hdr->head;
+  if( hdr->cached_tail - head < n )
+  {
+    hdr->cached_tail = cc_ring_index_load( &hdr->tail );
+    if( hdr->cached_tail - head < n )
+      n = hdr->cached_tail - head;
+  }
+
+  cc_ring_copy( cntr, head, out, n, el_size, false );
+  cc_ring_index_store( &hdr->head, head + n );
+  return n;
+}
+
+// Like popping, clearing must only be done by the consumer.
+static inline void cc_ring_clear(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  cc_ring_hdr_ty *hdr = cc_ring_hdr( cntr );
+  if( CC_UNLIKELY( !hdr->cap ) )
+    return;
+
+  size_t tail = cc_ring_index_load( &hdr->tail );
+  if( el_dtor )
+    for( size_t i = hdr->head; i != tail; ++i )
+      el_dtor( cc_ring_el( cntr, i, el_size ) );
+
+  hdr->cached_tail = tail;
+  cc_ring_index_store( &hdr->head, tail );
+}
+
+// Unlike the other ring functions, this function must not be called while the producer or consumer is accessing the
+// container.
+static inline void cc_ring_cleanup(
+  void *cntr,
+  size_t el_size,
+  CC_UNUSED( uint64_t, layout ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  cc_ring_clear( cntr, el_size, 0 /* Dummy */, el_dtor, NULL /* Dummy */, NULL /* Dummy */ );
+
+  if( cntr != &cc_ring_placeholder )
+    free_( cc_ring_hdr( cntr )->block );
+}
+
+// The allocated memory includes the slack used to align the header to a cache line.
+// As with cc_ring_size, the payload is only a snapshot if the producer or consumer is active during the call.
+static inline cc_mem_usage cc_ring_memory_usage( void *cntr, size_t el_size, CC_UNUSED( uint64_t, layout ) )
+{
+  if( !cc_ring_cap( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+  return cc_make_mem_usage(
+    CC_RING_LINE_SIZE - 1 + sizeof( cc_ring_hdr_ty ) + el_size * cc_ring_cap( cntr ),
+    el_size * cc_ring_size( cntr )
+  );
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                    Ordered map                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+// cc_omap is implemented as a red-black tree. The implementation is partially based on Thomas Niemann's canonical
+// public-domain implementation, which is available at https://www.darkridge.com/~jpr5/mirror/alg/node21.html and has
+// been incorporated into PostgreSQL. However, it differs from Niemann's in several important ways:
+//
+// * It uses an array of two child pointers, rather than separate left and right child pointers. This allows us to
+//   eliminate much repetitive code, especially in the post-insert and post-erase fix-up functions.
+// * Niemann's implementation of erasure may write to the sentinel node's parent pointer. Consequently, in
+//   multi-threaded applications, either the sentinel must be declared as a thread-local variable or a separate sentinel
+//   must be embedded into every tree, padding out the header struct. Instead, we use a global sentinel node per
+//   translation unit. This choice requires, in particular, significant changes to the erase and post-erase fix-up
+//   functions.
+// * Niemann's implementation of erasure may also overwrite the key stored by the target node with the key stored by its
+//   in-order successor and delete the latter node. This invalidates any external pointers to the in-order successor.
+//   Instead, we supplant the in-order successor into the position of the node targeted for erasure.
+
+// Node header.
+// To keep the header small, the node's color is packed into the least significant bit of its parent pointer, which is
+// always zero because nodes are at least pointer-aligned.
+// The header is not aligned to max_align_t.
+// Instead, each node's memory block begins with just enough padding for the element following the header to be
+// suitably aligned for el_ty and key_ty (see CC_OMAPNODE_HDR_PADDING below).
+// If CC_ORDER_STATISTICS is defined, the header also stores the number of nodes in the node's subtree, which is zero
+// for the sentinel, so that nodes can be found by position and positions by key in logarithmic time.
+typedef struct cc_omapnode_hdr_ty
+{
+  uintptr_t parent_and_color; // Parent pointer, with the least significant bit set if the node is red.
+  struct cc_omapnode_hdr_ty *children[ 2 ];
+#ifdef CC_ORDER_STATISTICS
+  size_t count;
+#endif
+} cc_omapnode_hdr_ty;
+
+// Ordered map header.
+typedef struct
+{
+  size_t size; // SIZE_MAX, combined with a NULL root, indicates a placeholder.
+  cc_omapnode_hdr_ty *root;
+  cc_omapnode_hdr_ty *sentinel;
+  cc_allocator *allocator;
+#ifdef CC_POOL_NODES
+  cc_pool_ty pool;
+#endif
+} cc_omap_hdr_ty;
+
+// Global sentinel node.
+// The beginning and end of the sentinel also serve as r_end and end, respectively.
+static const cc_omapnode_hdr_ty cc_omap_sentinel = {
+  0,
+  { NULL, NULL }
+#ifdef CC_ORDER_STATISTICS
+  , 0
+#endif
+};
+
+// Global placeholder for an ordered map with no allocated header.
+// This placeholder allows us to avoid checking for a NULL container handle inside functions.
+static const cc_omap_hdr_ty cc_omap_placeholder = {
+  SIZE_MAX,
+  (cc_omapnode_hdr_ty *)&cc_omap_sentinel,
+  (cc_omapnode_hdr_ty *)&cc_omap_sentinel,
+  NULL
+#ifdef CC_POOL_NODES
+  ,
+  { NULL, NULL, NULL, 0 }
+#endif
+};
+
+// Easy access to the ordered map header.
+static inline cc_omap_hdr_ty *cc_omap_hdr( void *cntr )
+{
+  return (cc_omap_hdr_ty *)cntr;
+}
+
+// Easy access to an ordered map node header from a pointer-iterator.
+static inline cc_omapnode_hdr_ty *cc_omapnode_hdr( void *itr )
+{
+  return (cc_omapnode_hdr_ty *)( (char *)itr - sizeof( cc_omapnode_hdr_ty ) );
+}
+
+// Functions for accessing the parent pointer and color packed into a node header.
+
+static inline cc_omapnode_hdr_ty *cc_omapnode_parent( cc_omapnode_hdr_ty *node )
+{
+  return (cc_omapnode_hdr_ty *)( node->parent_and_color & ~(uintptr_t)1 );
+}
+
+static inline bool cc_omapnode_is_red( cc_omapnode_hdr_ty *node )
+{
+  return node->parent_and_color & 1;
+}
+
+static inline void cc_omapnode_set_parent( cc_omapnode_hdr_ty *node, cc_omapnode_hdr_ty *parent )
+{
+  node->parent_and_color = (uintptr_t)parent | ( node->parent_and_color & 1 );
+}
+
+static inline void cc_omapnode_set_red( cc_omapnode_hdr_ty *node, bool is_red )
+{
+  node->parent_and_color = ( node->parent_and_color & ~(uintptr_t)1 ) | is_red;
+}
+
+// Sets both the parent pointer and the color of a node whose header has not yet been initialized.
+static inline void cc_omapnode_set_parent_and_color(
+  cc_omapnode_hdr_ty *node,
+  cc_omapnode_hdr_ty *parent,
+  bool is_red
+)
+{
+  node->parent_and_color = (uintptr_t)parent | is_red;
+}
+
+#ifdef CC_ORDER_STATISTICS
+
+// Recomputes a node's subtree count from those of its children.
+static inline void cc_omapnode_update_count( cc_omapnode_hdr_ty *node )
+{
+  node->count = node->children[ 0 ]->count + node->children[ 1 ]->count + 1;
+}
+
+// Adds one to, or subtracts one from, the subtree counts of the specified node and all its ancestors.
+static inline void cc_omapnode_adjust_counts( cc_omapnode_hdr_ty *node, cc_omapnode_hdr_ty *sentinel, bool increment )
+{
+  for( ; node != sentinel; node = cc_omapnode_parent( node ) )
+    node->count += increment ? 1 : (size_t)-1;
+}
+
+#endif
+
+// Padding at the start of each node's memory block such that the element and key following the node header are
+// suitably aligned, given that the block itself is aligned to max_align_t.
+#define CC_OMAPNODE_HDR_PADDING( layout ) CC_PADDING( sizeof( cc_omapnode_hdr_ty ), CC_OMAP_NODE_ALIGN( layout ) )
+
+// Size of each node's memory block.
+#define CC_OMAPNODE_SIZE( el_size, layout )                          \
+(                                                                    \
+  CC_OMAPNODE_HDR_PADDING( layout ) + sizeof( cc_omapnode_hdr_ty ) + \
+  CC_KEY_OFFSET( el_size, layout ) + CC_KEY_SIZE( layout )           \
+)                                                                    \
+
+static inline bool cc_omap_is_placeholder( void *cntr )
+{
+  if( cc_omap_hdr( cntr )->size == SIZE_MAX && cc_omap_hdr( cntr )->root == cc_omap_hdr( cntr )->sentinel )
+    return true;
+
+  return false;
+}
+
+// Easy access to a pointer-iterator from a pointer to an ordered map node header.
+static inline void *cc_omap_el( void *hdr )
+{
+  return (char *)hdr + sizeof( cc_omapnode_hdr_ty );
+}
+
+// Easy access to a key from a pointer to an ordered map node header.
+static inline void *cc_omap_key(
+  void *hdr, 
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return (char *)hdr + sizeof( cc_omapnode_hdr_ty ) + CC_KEY_OFFSET( el_size, layout );
+}
+
+static inline void *cc_omap_key_for(
+  CC_UNUSED( void *, cntr ),
+  void *itr,
+  size_t el_size,
+  uint64_t layout
+)
+{
+  return (char *)itr + CC_KEY_OFFSET( el_size, layout );
+}
+
+static inline size_t cc_omap_size( void *cntr )
+{
+  // Special case: If the header is a placeholder, the size member will be SIZE_MAX.
+  if( cc_omap_is_placeholder( cntr ) )
+    return 0;
+
+  return cc_omap_hdr( cntr )->size;
+}
+
+// An r_end pointer-iterator points to the sentinel.
+// An end pointer-iterator points to the end of the sentinel.
+static inline void *cc_omap_r_end_or_end(
+  void *cntr,
+  bool dir
+)
+{
+  return cc_omap_hdr( cntr )->sentinel + dir;
+}
+
+static inline void *cc_omap_r_end( void *cntr )
+{
+  return cc_omap_r_end_or_end( cntr, false );
+}
+
+static inline void *cc_omap_end(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_omap_r_end_or_end( cntr, true );
+}
+
+static inline void *cc_omap_first_or_last(
+  void *cntr,
+  bool dir
+)
+{
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+
+  if( node == cc_omap_hdr( cntr )->sentinel )
+    return cc_omap_hdr( cntr )->sentinel + dir;
+  
+  while( node->children[ !dir ] != cc_omap_hdr( cntr )->sentinel )
+    node = node->children[ !dir ];
+
+  return cc_omap_el( node );
+}
+
+static inline void *cc_omap_first(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_omap_first_or_last( cntr, true );
+}
+
+static inline void *cc_omap_last(
+  void *cntr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_omap_first_or_last( cntr, false );
+}
+
+static inline void *cc_omap_iterate(
+  void *cntr,
+  void *itr,
+  bool dir
+)
+{
+  // Handle the case of an end or r_end iterator.
+  if( itr == cc_omap_r_end_or_end( cntr, !dir ) )
+    return cc_omap_first_or_last( cntr, dir );
+
+  cc_omapnode_hdr_ty *node = cc_omapnode_hdr( itr );
+
+  if( node->children[ dir ] != cc_omap_hdr( cntr )->sentinel )
+  {
+    node = node->children[ dir ];
+    while( node->children[ !dir ] != cc_omap_hdr( cntr )->sentinel )
+      node = node->children[ !dir ];
+
+    return cc_omap_el( node );
+  }
+  
+  while( cc_omapnode_parent( node ) != cc_omap_hdr( cntr )->sentinel )
+  {
+    if( cc_omapnode_parent( node )->children[ !dir ] == node )
+      return cc_omap_el( cc_omapnode_parent( node ) );
+
+    node = cc_omapnode_parent( node );
+  }
+  
+  return cc_omap_r_end_or_end( cntr, dir );
+}
+
+static inline void *cc_omap_prev(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_omap_iterate( cntr, itr, false );
+}
+
+static inline void *cc_omap_next(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
+{
+  return cc_omap_iterate( cntr, itr, true );
+}
+
+// Allocates a header for an ordered map that is currently a placeholder.
+// If allocator is not NULL, the header is allocated via, and associated with, that allocator.
+// Returns the new container handle, or NULL in the case of allocation failure.
+static inline void *cc_omap_alloc_hdr(
+  void *cntr,
+  cc_allocator *allocator,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  cc_omap_hdr_ty *new_cntr = (cc_omap_hdr_ty *)cc_allocator_realloc(
+    allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_omap_hdr_ty )
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
+
+  new_cntr->size = 0;
+  new_cntr->root = cc_omap_hdr( cntr )->sentinel;;    // Link the new header's sentinel with the sentinel associated
+  new_cntr->sentinel = cc_omap_hdr( cntr )->sentinel; // with the placeholder.
+                                                      // This ensures that the end and r_end iterator-pointers remain
+                                                      // stable in the transition from a placeholder to a real header.
+  new_cntr->allocator = allocator;
+#ifdef CC_POOL_NODES
+  cc_pool_init( &new_cntr->pool );
+#endif
+  return new_cntr;
+}
+
+// Allocates a node, from the ordered map's pool if CC_POOL_NODES is defined.
+// The ordered map must not be a placeholder.
+// Returns a pointer to the node, or NULL in the case of allocation failure.
+static inline cc_omapnode_hdr_ty *cc_omap_alloc_node(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+#ifdef CC_POOL_NODES
+  char *block = (char *)cc_pool_alloc(
+    &cc_omap_hdr( cntr )->pool,
+    CC_OMAPNODE_SIZE( el_size, layout ),
+    cc_omap_hdr( cntr )->allocator,
+    realloc_
+  );
+#else
+  char *block = (char *)cc_allocator_realloc(
+    cc_omap_hdr( cntr )->allocator,
+    realloc_,
+    NULL,
+    CC_OMAPNODE_SIZE( el_size, layout )
+  );
+#endif
+  if( CC_UNLIKELY( !block ) )
+    return NULL;
+
+  return (cc_omapnode_hdr_ty *)( block + CC_OMAPNODE_HDR_PADDING( layout ) );
+}
+
+// Frees a node allocated by cc_omap_alloc_node, returning it to the ordered map's pool if CC_POOL_NODES is defined.
+static inline void cc_omap_free_node(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  uint64_t layout,
+  cc_free_fnptr_ty free_
+)
+{
+  char *block = (char *)node - CC_OMAPNODE_HDR_PADDING( layout );
+
+#ifdef CC_POOL_NODES
+  (void)free_;
+  cc_pool_free( &cc_omap_hdr( cntr )->pool, block );
+#else
+  cc_allocator_free( cc_omap_hdr( cntr )->allocator, free_, block );
+#endif
+}
+
+// Standard binary search tree rotation.
+static inline void cc_omap_rotate(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  bool dir
+)
+{
+  cc_omapnode_hdr_ty *child = node->children[ !dir ];
+
+  node->children[ !dir ] = child->children[ dir ];
+  if( child->children[ dir ] != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_set_parent( child->children[ dir ], node );
+
+  if( child != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_set_parent( child, cc_omapnode_parent( node ) );
+
+  if( cc_omapnode_parent( node ) != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_parent( node )->children[ node == cc_omapnode_parent( node )->children[ 1 ] ] = child;
+  else
+    cc_omap_hdr( cntr )->root = child;
+
+  child->children[ dir ] = node;
+  if( node != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_set_parent( node, child );
+
+#ifdef CC_ORDER_STATISTICS
+  // The child's subtree now contains exactly the nodes that node's subtree contained.
+  child->count = node->count;
+  cc_omapnode_update_count( node );
+#endif
+}
+
+// Post-insert fix-up function to restore the red-black tree balance.
+static inline void cc_omap_post_insert_fixup(
+  void *cntr,
+  cc_omapnode_hdr_ty *node
+)
+{
+  while( node != cc_omap_hdr( cntr )->root && cc_omapnode_is_red( cc_omapnode_parent( node ) ) )
+  {
+    cc_omapnode_hdr_ty *parent = cc_omapnode_parent( node );
+    cc_omapnode_hdr_ty *grandparent = cc_omapnode_parent( parent );
+    bool dir = parent == grandparent->children[ 0 ];
+    cc_omapnode_hdr_ty *uncle = grandparent->children[ dir ];
+
+    if( cc_omapnode_is_red( uncle ) )
+    {
+      cc_omapnode_set_red( parent, false );
+      cc_omapnode_set_red( uncle, false );
+      cc_omapnode_set_red( grandparent, true );
+      node = grandparent;
+    }
+    else
+    {
+      if( node == parent->children[ dir ] )
+      {
+        node = parent;
+        cc_omap_rotate( cntr, node, !dir );
+        parent = cc_omapnode_parent( node );
+      }
+
+      cc_omapnode_set_red( parent, false );
+      cc_omapnode_set_red( grandparent, true );
+      cc_omap_rotate( cntr, grandparent, dir );
+    }
+  }
+
+  cc_omapnode_set_red( cc_omap_hdr( cntr )->root, false );
+}
+
+// Links a node, whose header need not be initialized, into the tree as the specified child of parent, or as the root
+// if parent is the sentinel, and restores the balance of the tree.
+static inline void cc_omap_link_node(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  cc_omapnode_hdr_ty *parent,
+  bool dir
+)
+{
+  cc_omapnode_set_parent_and_color( node, parent, true );
+  node->children[ 0 ] = cc_omap_hdr( cntr )->sentinel;
+  node->children[ 1 ] = cc_omap_hdr( cntr )->sentinel;
+
+  if( parent != cc_omap_hdr( cntr )->sentinel )
+    parent->children[ dir ] = node;
+  else
+    cc_omap_hdr( cntr )->root = node;
+
+#ifdef CC_ORDER_STATISTICS
+  // The counts must be correct before any rotations occur.
+  node->count = 1;
+  cc_omapnode_adjust_counts( parent, cc_omap_hdr( cntr )->sentinel, true );
+#endif
+
+  cc_omap_post_insert_fixup( cntr, node );
+}
+
+// Inserts a key-element pair into the subtree rooted at the specified node, which must be the whole tree or a subtree
+// whose range of keys includes the key, optionally replacing the existing key-element pair containing the same key if
+// it exists.
+// The ordered map must not be a placeholder.
+// If replace is true, the function returns a pointer-iterator to the newly inserted element, or NULL in the case of
+// allocation failure.
+// If replace is false, then the return value is as described above, except that if the key already exists, the
+// pointer-iterator returned points to the associated element.
+// This function is the shared basis of cc_omap_insert and cc_omap_insert_n.
+static inline void *cc_omap_insert_below(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  void *el,
+  void *key,
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  // Find the node with the same key, or the parent of the node to be created.
+
+  cc_omapnode_hdr_ty *parent = cc_omap_hdr( cntr )->sentinel;
+  int cmpr_result = 0; // This initialization is redundant, but it silences a GCC warning when cmpr_result is used after
+                       // the loop below to determine whether the new node should be its parent's left or right child.
+                       // In reality, if that determination occurs, then cmpr_result was set inside the loop.
+
+  while( node != cc_omap_hdr( cntr )->sentinel )
+  {
+    cmpr_result = cmpr( key, cc_omap_key( node, el_size, layout ) );
+
+    // Matching key.
+    if( cmpr_result == 0 )
+    {
+      if( replace )
+      {
+        if( key_dtor )
+          key_dtor( cc_omap_key( node, el_size, layout ) );
+
+        if( el_dtor )
+          el_dtor( cc_omap_el( node ) );
+
+        memcpy( cc_omap_key( node, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+        memcpy( cc_omap_el( node ), el, el_size );
+      }
+
+      return cc_omap_el( node );
+    }
+
+    parent = node;
+    node = node->children[ cmpr_result > 0 ];
+  }
+
+  // Allocate and insert the new node.
+
+  cc_omapnode_hdr_ty *new_node = cc_omap_alloc_node( cntr, el_size, layout, realloc_ );
+  if( CC_UNLIKELY( !new_node ) )
+    return NULL;
+
+  memcpy( cc_omap_key( new_node, el_size, layout ), key, CC_KEY_SIZE( layout ) );
+  memcpy( cc_omap_el( new_node ), el, el_size );
+
+  cc_omap_link_node( cntr, new_node, parent, cmpr_result > 0 );
+
+  ++cc_omap_hdr( cntr )->size;
+  return cc_omap_el( new_node );
+}
+
+// Inserts a key-element pair into the ordered map, optionally replacing the existing key-element pair containing the
+// same key if it exists.
+// If replace is true, the function returns a cc_allocing_fn_result_ty containing the new container handle and a
+// pointer-iterator to the newly inserted element (or NULL in the case of allocation failure).
+// If replace is false, then the return value is as described above, except that if the key already exists, the
+// pointer-iterator returned points to the associated element.
+static inline cc_allocing_fn_result_ty cc_omap_insert(
+  void *cntr,
+  void *el,
+  void *key,
+  bool replace,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  CC_UNUSED( double, max_load ),
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  // Allocate a header if necessary.
+  if( cc_omap_is_placeholder( cntr ) )
+  {
+    void *new_cntr = cc_omap_alloc_hdr( cntr, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    cntr = new_cntr;
+  }
+
+  return cc_make_allocing_fn_result(
+    cntr,
+    cc_omap_insert_below(
+      cntr,
+      cc_omap_hdr( cntr )->root,
+      el,
+      key,
+      replace,
+      el_size,
+      layout,
+      cmpr,
+      el_dtor,
+      key_dtor,
+      realloc_
+    )
+  );
+}
+
+// Returns the smallest subtree, among those containing the specified node, whose range of keys includes the specified
+// key, which must not be less than the node's key.
+// A right child's subtree shares its parent's upper bound, so only the parents of left children need be compared with
+// the key.
+static inline cc_omapnode_hdr_ty *cc_omap_finger(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  while( cc_omapnode_parent( node ) != cc_omap_hdr( cntr )->sentinel )
+  {
+    if( node == cc_omapnode_parent( node )->children[ 0 ] )
+    {
+      int cmpr_result = cmpr( key, cc_omap_key( cc_omapnode_parent( node ), el_size, layout ) );
+      if( cmpr_result < 0 )
+        return node;
+
+      if( cmpr_result == 0 )
+        return cc_omapnode_parent( node );
+    }
+
+    node = cc_omapnode_parent( node );
+  }
+
+  return node;
+}
+
+// Inserts n key-element pairs stored contiguously at keys and els, in ascending order of their keys, replacing the
+// existing key-element pairs containing the same keys if they exist.
+// The pairs are visited in the order given by the array of indices order, or in their stored order if order is NULL.
+// Each descent begins not at the root but at the subtree that cc_omap_finger finds from the previously inserted node,
+// so a run of adjacent keys costs little more than a traversal.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure, in which case the preceding pairs remain
+// inserted.
+static inline cc_allocing_fn_result_ty cc_omap_insert_ascending(
+  void *cntr,
+  void *keys,
+  void *els,
+  const size_t *order,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_
+)
+{
+  if( n == 0 )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+
+  // Allocate a header if necessary.
+  if( cc_omap_is_placeholder( cntr ) )
+  {
+    void *new_cntr = cc_omap_alloc_hdr( cntr, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    cntr = new_cntr;
+  }
+
+  cc_omapnode_hdr_ty *finger = NULL;
+  for( size_t i = 0; i < n; ++i )
+  {
+    size_t index = order ? order[ i ] : i;
+    void *key = (char *)keys + CC_KEY_SIZE( layout ) * index;
+
+    void *itr = cc_omap_insert_below(
+      cntr,
+      finger ? cc_omap_finger( cntr, finger, key, el_size, layout, cmpr ) : cc_omap_hdr( cntr )->root,
+      (char *)els + el_size * index,
+      key,
+      true,
+      el_size,
+      layout,
+      cmpr,
+      el_dtor,
+      key_dtor,
+      realloc_
+    );
+    if( CC_UNLIKELY( !itr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
+
+    finger = cc_omapnode_hdr( itr );
+  }
+
+  return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+}
+
+// State shared by the recursive calls of cc_omap_build_subtree.
+typedef struct
+{
+  cc_omapnode_hdr_ty *sentinel;
+  char *nodes;                 // Contiguous nodes, or NULL if the nodes were allocated individually.
+  size_t node_size;
+  cc_omapnode_hdr_ty *chain;   // Individually allocated nodes, linked via their parent pointers.
+  void *source;                // Ordered map whose key-element pairs to copy, in place of keys and els, or NULL.
+                               // If both source and keys are NULL, the nodes in chain already contain their
+                               // key-element pairs in ascending order and are merely relinked.
+  void *source_itr;            // Pointer-iterator to the next key-element pair to copy from source.
+  char *keys;
+  char *els;
+  const size_t *order;         // Order in which to consume the key-element pairs, or NULL for their stored order.
+  size_t next;                 // Position, in that order, of the next key-element pair to consume.
+  size_t remaining;            // Number of key-element pairs left to consume.
+  size_t el_size;
+  uint64_t layout;
+  cc_cmpr_fnptr_ty cmpr;
+  cc_dtor_fnptr_ty el_dtor;
+  cc_dtor_fnptr_ty key_dtor;
+  size_t red_depth;
+} cc_omap_builder_ty;
+
+// Returns a pointer to the key at the specified position in the builder's input order.
+static inline char *cc_omap_builder_key( cc_omap_builder_ty *builder, size_t position )
+{
+  return builder->keys + CC_KEY_SIZE( builder->layout ) * ( builder->order ? builder->order[ position ] : position );
+}
+
+// Returns a pointer to the element at the specified position in the builder's input order.
+static inline char *cc_omap_builder_el( cc_omap_builder_ty *builder, size_t position )
+{
+  return builder->els + builder->el_size * ( builder->order ? builder->order[ position ] : position );
+}
+
+// Consumes the next key-element pair from the builder's input, skipping all but the last of a run of equal keys.
+// The skipped pairs are destroyed, mirroring the replacement semantics of cc_omap_insert.
+static inline void cc_omap_builder_consume( cc_omap_builder_ty *builder, cc_omapnode_hdr_ty *node )
+{
+  if( !builder->source && !builder->keys )
+    return;
+
+  // The keys of an ordered map are already unique.
+  if( builder->source )
+  {
+    memcpy(
+      cc_omap_el( node ),
+      builder->source_itr,
+      CC_KEY_OFFSET( builder->el_size, builder->layout ) + CC_KEY_SIZE( builder->layout )
+    );
+    builder->source_itr = cc_omap_iterate( builder->source, builder->source_itr, true );
+    --builder->remaining;
+    return;
+  }
+
+  while(
+    builder->remaining > 1 &&
+    builder->cmpr(
+      cc_omap_builder_key( builder, builder->next ),
+      cc_omap_builder_key( builder, builder->next + 1 )
+    ) == 0
+  )
+  {
+    if( builder->key_dtor )
+      builder->key_dtor( cc_omap_builder_key( builder, builder->next ) );
+
+    if( builder->el_dtor )
+      builder->el_dtor( cc_omap_builder_el( builder, builder->next ) );
+
+    ++builder->next;
+    --builder->remaining;
+  }
+
+  memcpy(
+    cc_omap_key( node, builder->el_size, builder->layout ),
+    cc_omap_builder_key( builder, builder->next ),
+    CC_KEY_SIZE( builder->layout )
+  );
+  memcpy( cc_omap_el( node ), cc_omap_builder_el( builder, builder->next ), builder->el_size );
+
+  ++builder->next;
+  --builder->remaining;
+}
+
+// Allocates the nodes that the builder will consume, either as one contiguous block if CC_POOL_NODES is defined or if
+// the ordered map's allocator releases memory in bulk (so that the nodes will never be freed individually) or otherwise
+// individually.
+// Returns false in the case of allocation failure, in which case any nodes already allocated are freed.
+static inline bool cc_omap_builder_alloc_nodes(
+  cc_omap_builder_ty *builder,
+  void *cntr,
+  size_t node_count,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+#ifdef CC_POOL_NODES
+  (void)free_;
+  builder->nodes = (char *)cc_pool_alloc_n(
+    &cc_omap_hdr( cntr )->pool,
+    CC_OMAPNODE_SIZE( builder->el_size, builder->layout ),
+    node_count,
+    cc_omap_hdr( cntr )->allocator,
+    realloc_
+  );
+  return builder->nodes;
+#else
+  if( !cc_allocator_frees( cc_omap_hdr( cntr )->allocator ) )
+  {
+    builder->nodes = (char *)cc_allocator_realloc(
+      cc_omap_hdr( cntr )->allocator,
+      realloc_,
+      NULL,
+      builder->node_size * node_count
+    );
+    return builder->nodes;
+  }
+
+  for( size_t i = 0; i < node_count; ++i )
+  {
+    cc_omapnode_hdr_ty *node = cc_omap_alloc_node( cntr, builder->el_size, builder->layout, realloc_ );
+    if( CC_UNLIKELY( !node ) )
+    {
+      while( builder->chain )
+      {
+        node = builder->chain;
+        builder->chain = cc_omapnode_parent( node );
+        cc_omap_free_node( cntr, node, builder->layout, free_ );
+      }
+
+      return false;
+    }
+
+    cc_omapnode_set_parent_and_color( node, builder->chain, false );
+    builder->chain = node;
+  }
+
+  return true;
+#endif
+}
+
+// Builds a perfectly balanced subtree of node_count nodes from the builder's remaining input and returns its root.
+// Because the subtree's left and right halves differ in size by at most one, all its leaves lie on the deepest two
+// levels.
+// Hence, coloring only nodes at the builder's red_depth, i.e. the deepest level if that level is incomplete, red gives
+// every path from the root to a leaf the same number of black nodes.
+static inline cc_omapnode_hdr_ty *cc_omap_build_subtree(
+  cc_omap_builder_ty *builder,
+  size_t node_count,
+  size_t depth
+)
+{
+  if( node_count == 0 )
+    return builder->sentinel;
+
+  cc_omapnode_hdr_ty *left = cc_omap_build_subtree( builder, node_count / 2, depth + 1 );
+
+  cc_omapnode_hdr_ty *node;
+  if( builder->nodes )
+  {
+    node = (cc_omapnode_hdr_ty *)( builder->nodes + CC_OMAPNODE_HDR_PADDING( builder->layout ) );
+    builder->nodes += builder->node_size;
+  }
+  else
+  {
+    node = builder->chain;
+    builder->chain = cc_omapnode_parent( node );
+  }
+
+  cc_omap_builder_consume( builder, node );
+  cc_omapnode_set_parent_and_color( node, builder->sentinel, depth == builder->red_depth );
+#ifdef CC_ORDER_STATISTICS
+  node->count = node_count;
+#endif
+
+  node->children[ 0 ] = left;
+  if( left != builder->sentinel )
+    cc_omapnode_set_parent( left, node );
+
+  node->children[ 1 ] = cc_omap_build_subtree( builder, node_count - node_count / 2 - 1, depth + 1 );
+  if( node->children[ 1 ] != builder->sentinel )
+    cc_omapnode_set_parent( node->children[ 1 ], node );
 
-  return cc_list_el( next );
+  return node;
 }
 
-// Removes the element pointed to by pointer-iterator src_itr from the source list and attaches it to the list before
-// pointer-iterator itr.
-// Although this function never allocates memory for the element/node itself, it must allocate the list's header if the
-// list is currently a placeholder.
+// Builds the tree of an empty ordered map directly, in linear time, from n key-element pairs stored contiguously at
+// keys and els and visited in ascending order of their keys, per the array of indices order or, if order is NULL, in
+// their stored order.
+// n must be greater than zero.
+// All the nodes are allocated in one contiguous block if CC_POOL_NODES is defined or if the ordered map's allocator
+// releases memory in bulk.
 // Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
-// operation was successful or false in the case of allocation failure.
-static inline cc_allocing_fn_result_ty cc_list_splice(
+// operation was successful or false in the case of allocation failure, in which case no pairs are inserted or
+// destroyed.
+static inline cc_allocing_fn_result_ty cc_omap_build(
   void *cntr,
-  void *itr,
-  void *src,
-  void *src_itr,
-  cc_realloc_fnptr_ty realloc_
+  void *keys,
+  void *els,
+  const size_t *order,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
 )
 {
-  if( cc_list_is_placeholder( cntr ) )
+  // Allocate a header if necessary.
+  // In the case of allocation failure, the header is freed again so that the ordered map is left as it was.
+  void *placeholder = NULL;
+  if( cc_omap_is_placeholder( cntr ) )
   {
-    void *new_cntr = cc_list_alloc_hdr( cntr, realloc_ );
+    void *new_cntr = cc_omap_alloc_hdr( cntr, NULL, realloc_ );
     if( CC_UNLIKELY( !new_cntr ) )
       return cc_make_allocing_fn_result( cntr, NULL );
 
+    placeholder = cntr;
     cntr = new_cntr;
   }
 
-  cc_listnode_hdr( src_itr )->prev->next = cc_listnode_hdr( src_itr )->next;
-  cc_listnode_hdr( src_itr )->next->prev = cc_listnode_hdr( src_itr )->prev;
-  cc_list_attach( cntr, itr, cc_listnode_hdr( src_itr ) );
+  cc_omap_builder_ty builder;
+  builder.sentinel = cc_omap_hdr( cntr )->sentinel;
+  builder.nodes = NULL;
+  builder.node_size = cc_pool_node_size( CC_OMAPNODE_SIZE( el_size, layout ) );
+  builder.chain = NULL;
+  builder.source = NULL;
+  builder.keys = (char *)keys;
+  builder.els = (char *)els;
+  builder.order = order;
+  builder.next = 0;
+  builder.remaining = n;
+  builder.el_size = el_size;
+  builder.layout = layout;
+  builder.cmpr = cmpr;
+  builder.el_dtor = el_dtor;
+  builder.key_dtor = key_dtor;
+
+  // Count the unique keys, which determines the number of nodes.
+  size_t node_count = 1;
+  for( size_t i = 1; i < n; ++i )
+    if( cmpr( cc_omap_builder_key( &builder, i - 1 ), cc_omap_builder_key( &builder, i ) ) != 0 )
+      ++node_count;
+
+  // The deepest level is incomplete, and its nodes must be red, unless the node count is one less than a power of two.
+  // In that case, red_depth lies one level beyond the tree, so all nodes are black.
+  builder.red_depth = 0;
+  for( size_t i = node_count + 1; i > 1; i /= 2 )
+    ++builder.red_depth;
+
+  // Allocate the nodes.
+  if( CC_UNLIKELY( !cc_omap_builder_alloc_nodes( &builder, cntr, node_count, realloc_, free_ ) ) )
+  {
+    if( placeholder )
+    {
+      cc_allocator_free( NULL, free_, cntr );
+      cntr = placeholder;
+    }
+
+    return cc_make_allocing_fn_result( cntr, NULL );
+  }
 
-  --cc_list_hdr( src )->size;
-  ++cc_list_hdr( cntr )->size;
+  // Build the tree.
+  cc_omap_hdr( cntr )->root = cc_omap_build_subtree( &builder, node_count, 0 );
+  cc_omapnode_set_parent( cc_omap_hdr( cntr )->root, cc_omap_hdr( cntr )->sentinel );
+  cc_omap_hdr( cntr )->size = node_count;
 
   return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
 }
 
-// Initializes a shallow copy of the source list.
-// This requires allocating memory for every node, as well as for the list's header unless src is a placeholder.
-// Returns a pointer to the copy, or NULL in the case of allocation failure.
-// That return value is cast to bool in the corresponding macro.
-static inline void *cc_list_init_clone(
-  void *src,
+// Inserts n key-element pairs whose keys are in ascending order, replacing the existing key-element pairs containing
+// the same keys if they exist.
+// If the ordered map is empty, the tree is built directly via cc_omap_build.
+// Otherwise, the pairs are inserted individually via cc_omap_insert_ascending.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+// If the ordered map was empty, then in the case of allocation failure, no pairs are inserted or destroyed.
+static inline cc_allocing_fn_result_ty cc_omap_insert_sorted_n(
+  void *cntr,
+  void *keys,
+  void *els,
+  size_t n,
   size_t el_size,
-  CC_UNUSED( uint64_t, layout ),
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
   cc_realloc_fnptr_ty realloc_,
   cc_free_fnptr_ty free_
 )
 {
-  cc_allocing_fn_result_ty result = { (void *)&cc_list_placeholder, cc_dummy_true_ptr };
+  if( n == 0 )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
 
-  for(
-    void *i = cc_list_first( src, 0 /* Dummy */, 0 /* Dummy */ );
-    i != cc_list_end( src, 0 /* Dummy */, 0 /* Dummy */ );
-    i = cc_list_next( src, i, 0 /* Dummy */, 0 /* Dummy */ )
-  )
-  {
-    result = cc_list_insert(
-      result.new_cntr,
-      i,
-      &CC_MAKE_LVAL_COPY(
-        void *,
-        cc_list_end( result.new_cntr, 0 /* Dummy */, 0 /* Dummy */ )
-      ),
-      false,    // Dummy.
+  // Fall back on individual insertions if the ordered map is not empty.
+  if( cc_omap_size( cntr ) )
+    return cc_omap_insert_ascending(
+      cntr,
+      keys,
+      els,
+      NULL,    // Stored order.
+      n,
       el_size,
-      0,        // Dummy.
-      NULL,     // Dummy.
-      NULL,     // Dummy.
-      0.0,      // Dummy.
-      NULL,     // Dummy.
-      NULL,     // Dummy.
-      realloc_,
-      NULL      // Dummy.
+      layout,
+      cmpr,
+      el_dtor,
+      key_dtor,
+      realloc_
     );
 
-    if( !result.other_ptr )
-    {
-      // Erase incomplete clone without invoking destructors.
-      
-      void *j = cc_list_first( result.new_cntr, 0 /* Dummy */, 0 /* Dummy */ );
-      while( j != cc_list_end( result.new_cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
-      {
-        void *next = cc_list_next( result.new_cntr, j, 0 /* Dummy */, 0 /* Dummy */ );
-        free_( cc_listnode_hdr( j ) );
-        j = next;
-      }
+  return cc_omap_build( cntr, keys, els, NULL, n, el_size, layout, cmpr, el_dtor, key_dtor, realloc_, free_ );
+}
+
+// Sorts the indices of n keys stored contiguously at keys into ascending order of the keys via a bottom-up merge sort.
+// The merge sort is stable, so the indices of equal keys retain their relative order.
+// indices must have space for 2 * n indices, the latter half of which serves as scratch space.
+// Returns a pointer to whichever half holds the sorted indices.
+static inline size_t *cc_omap_sort_indices(
+  void *keys,
+  size_t n,
+  size_t *indices,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  size_t *src = indices;
+  size_t *dst = indices + n;
 
-      if( !cc_list_is_placeholder( result.new_cntr ) )
-        free_( result.new_cntr );
+  for( size_t i = 0; i < n; ++i )
+    src[ i ] = i;
 
-      return NULL;
+  for( size_t width = 1; width < n; width *= 2 )
+  {
+    for( size_t begin = 0; begin < n; begin += width * 2 )
+    {
+      size_t mid = n - begin > width ? begin + width : n;
+      size_t end = n - mid > width ? mid + width : n;
+      size_t left = begin;
+      size_t right = mid;
+      size_t out = begin;
+
+      while( left < mid && right < end )
+        dst[ out++ ] = cmpr(
+          (char *)keys + CC_KEY_SIZE( layout ) * src[ right ],
+          (char *)keys + CC_KEY_SIZE( layout ) * src[ left ]
+        ) < 0 ? src[ right++ ] : src[ left++ ];
+
+      while( left < mid )
+        dst[ out++ ] = src[ left++ ];
+
+      while( right < end )
+        dst[ out++ ] = src[ right++ ];
     }
+
+    size_t *temp = src;
+    src = dst;
+    dst = temp;
   }
 
-  return result.new_cntr;
+  return src;
 }
 
-// Erases all elements, calling their destructors if necessary.
-static inline void cc_list_clear(
+// Inserts n key-element pairs stored contiguously at keys and els, in any order, replacing the existing key-element
+// pairs containing the same keys if they exist.
+// If the keys are already in ascending order, this function defers to cc_omap_insert_sorted_n.
+// Otherwise, it sorts the pairs' indices and then, in that order, either builds the tree via cc_omap_build, if the
+// ordered map is empty, or inserts the pairs via cc_omap_insert_ascending.
+// Because the sort is stable, the last of several equal keys prevails, as it would with n calls to cc_omap_insert.
+// If the indices cannot be allocated, the pairs are instead inserted individually in their stored order.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure.
+static inline cc_allocing_fn_result_ty cc_omap_insert_n(
   void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout ),
+  void *keys,
+  void *els,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  CC_UNUSED( double, max_load ),
   cc_dtor_fnptr_ty el_dtor,
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
   cc_free_fnptr_ty free_
 )
 {
-  while( cc_list_first( cntr, 0 /* Dummy */, 0 /* Dummy */ ) != cc_list_end( cntr, 0 /* Dummy */, 0 /* Dummy */ ) )
-    cc_list_erase(
+  bool is_sorted = true;
+  for( size_t i = 1; i < n && is_sorted; ++i )
+    is_sorted = cmpr( (char *)keys + CC_KEY_SIZE( layout ) * ( i - 1 ), (char *)keys + CC_KEY_SIZE( layout ) * i ) <= 0;
+
+  if( is_sorted )
+    return cc_omap_insert_sorted_n( cntr, keys, els, n, el_size, layout, cmpr, el_dtor, key_dtor, realloc_, free_ );
+
+  cc_allocator *allocator = cc_omap_hdr( cntr )->allocator;
+  size_t *indices = (size_t *)cc_allocator_realloc( allocator, realloc_, NULL, sizeof( size_t ) * n * 2 );
+  if( CC_UNLIKELY( !indices ) )
+  {
+    for( size_t i = 0; i < n; ++i )
+    {
+      cc_allocing_fn_result_ty result = cc_omap_insert(
+        cntr,
+        (char *)els + el_size * i,
+        (char *)keys + CC_KEY_SIZE( layout ) * i,
+        true,
+        el_size,
+        layout,
+        NULL, // Dummy.
+        cmpr,
+        0.0,  // Dummy.
+        el_dtor,
+        key_dtor,
+        realloc_,
+        free_
+      );
+
+      cntr = result.new_cntr;
+      if( CC_UNLIKELY( !result.other_ptr ) )
+        return cc_make_allocing_fn_result( cntr, NULL );
+    }
+
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
+  }
+
+  size_t *order = cc_omap_sort_indices( keys, n, indices, layout, cmpr );
+
+  cc_allocing_fn_result_ty result;
+  if( cc_omap_size( cntr ) )
+    result = cc_omap_insert_ascending(
       cntr,
-      &CC_MAKE_LVAL_COPY( void *, cc_list_first( cntr, 0 /* Dummy */, 0 /* Dummy */ ) ),
-      0,       // Dummy.
-      0,       // Dummy.
-      NULL,    // Dummy.
-      NULL,    // Dummy.
+      keys,
+      els,
+      order,
+      n,
+      el_size,
+      layout,
+      cmpr,
       el_dtor,
-      NULL,    // Dummy.
-      free_
+      key_dtor,
+      realloc_
     );
+  else
+    result = cc_omap_build( cntr, keys, els, order, n, el_size, layout, cmpr, el_dtor, key_dtor, realloc_, free_ );
+
+  cc_allocator_free( allocator, free_, indices );
+  return result;
 }
 
-// Erases all elements, calling their destructors if necessary, and frees the memory for the list's header if it is not
-// a placeholder.
-static inline void cc_list_cleanup(
+// Standard binary search tree lookup.
+static inline void *cc_omap_get(
   void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout ),
-  cc_dtor_fnptr_ty el_dtor,
-  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  cc_free_fnptr_ty free_
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  cc_list_clear( cntr, 0 /* Dummy */, 0 /* Dummy */, el_dtor, NULL /* Dummy */, free_ );
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  while( node != cc_omap_hdr( cntr )->sentinel )
+  {
+    int cmpr_result = cmpr( key, cc_omap_key( node, el_size, layout ) );
+    if( cmpr_result == 0 )
+      return cc_omap_el( node );
+    else
+      node = node->children[ cmpr_result > 0 ];
+  }
 
-  if( !cc_list_is_placeholder( cntr ) )
-    free_( cntr );
+  return NULL;
 }
 
-/*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                        Map                                                         */
-/*--------------------------------------------------------------------------------------------------------------------*/
+// Looks up n keys stored contiguously at keys, writing a pointer-iterator to each corresponding element, or NULL, into
+// itrs.
+// Rather than performing each lookup in full before beginning the next, this function processes the keys in batches,
+// descending the tree for all keys in a batch level by level and prefetching each next node.
+// Hence, the cache misses associated with the lookups in a batch overlap rather than occurring in series.
+// Returns the number of keys found.
+static inline size_t cc_omap_get_n(
+  void *cntr,
+  const void *keys,
+  size_t n,
+  void **itrs,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  cc_omapnode_hdr_ty *nodes[ CC_GET_N_BATCH_SIZE ];
+  size_t found_count = 0;
 
-// cc_map implements Verstable (https://github.com/JacksonAllan/Verstable) within the constraints of the CC API.
-// As explained in its documentation, Verstable is an open-addressing hash table using quadratic probing and the
-// following additions:
-//
-// * All keys that hash (i.e. "belong") to the same bucket (their "home bucket") are linked together by an 11-bit
-//   integer specifying the quadratic displacement, relative to that bucket, of the next key in the chain.
-// * If a chain of keys exists for a given bucket, then it always begins at that bucket. To maintain this policy, a
-//   1-bit flag is used to mark whether the key occupying a bucket belongs there. When inserting a new key, if the
-//   bucket it belongs to is occupied by a key that does not belong there, then the occupying key is evicted and the new
-//   key takes the bucket.
-// * A 4-bit fragment of each key's hash code is also stored.
-// * The aforementioned metadata associated with each bucket (the 4-bit hash fragment, the 1-bit flag, and the 11-bit
-//   link to the next key in the chain) are stored together in a uint16_t array rather than in the bucket alongside the
-//   key and (optionally) the value.
-//
-// One way to conceptualize this scheme is as a chained hash table in which overflowing keys are stored not in separate
-// memory allocations but in otherwise unused buckets. In this regard, it shares similarities with Malte Skarupke's
-// Bytell hash table (https://www.youtube.com/watch?v=M2fKMP47slQ) and traditional "coalesced hashing".
-//
-// Advantages of this scheme include:
-//
-// * Fast lookups impervious to load factor: If the table contains any key belonging to the lookup key's home bucket,
-//   then that bucket contains the first in a traversable chain of all keys belonging to it. Hence, only the home bucket
-//   and other buckets containing keys belonging to it are ever probed. Moreover, the stored hash fragments allow
-//   skipping most non-matching keys in the chain without accessing the actual buckets array or calling the (potentially
-//   expensive) key comparison function.
-// * Fast insertions: Insertions are faster than they are in other schemes that move keys around (e.g. Robin Hood)
-//   because they only move, at most, one existing key.
-// * Fast, tombstone-free deletions: Deletions, which usually require tombstones in quadratic-probing hash tables, are
-//   tombstone-free and only move, at most, one existing key.
-// * Fast iteration: The separate metadata array allows keys in sparsely populated tables to be found without incurring
-//   the frequent cache misses that would result from traversing the buckets array.
-//
-// Adapting Verstable to the CC API necessitates some compromises, including:
-//
-// * Slower iteration: As a pointer-iterator in CC cannot store a pointer to the metadatum associated with the bucket to
-//   which it points, the metadatum's address must be calculated every iteration.
-// * Slower iterator-based erasure: As CC pointer-iterators cannot store a key's home bucket, CC must rehash the key
-//   being deleted in cases wherein Verstable does not need to.
+  for( size_t batch_begin = 0; batch_begin < n; batch_begin += CC_GET_N_BATCH_SIZE )
+  {
+    size_t batch_size = n - batch_begin < CC_GET_N_BATCH_SIZE ? n - batch_begin : CC_GET_N_BATCH_SIZE;
 
-// Masks for manipulating and extracting data from a bucket's uint16_t metadatum.
-#define CC_MAP_EMPTY               0x0000
-#define CC_MAP_HASH_FRAG_MASK      0xF000 // 0b1111000000000000.
-#define CC_MAP_IN_HOME_BUCKET_MASK 0x0800 // 0b0000100000000000.
-#define CC_MAP_DISPLACEMENT_MASK   0x07FF // 0b0000011111111111, also denotes the displacement limit. Set to CC_LOAD to
-                                          // 1.0 to test proper handling of encroachment on the displacement limit
-                                          // during inserts.
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      nodes[ i ] = cc_omap_hdr( cntr )->root;
+      itrs[ batch_begin + i ] = NULL;
+    }
 
-// Extracts a hash fragment from a uint64_t hash code.
-// We take the highest four bits so that keys that map (via modulo) to the same bucket have distinct hash fragments.
-static inline uint16_t cc_hash_frag( size_t hash )
-{
-  return ( hash >> ( sizeof( size_t ) - sizeof( uint16_t ) ) * CHAR_BIT ) & CC_MAP_HASH_FRAG_MASK;
+    // Each pass advances every unresolved lookup by one level.
+    // A lookup is resolved when its node is the sentinel, either because its key was found or because it does not
+    // exist.
+    bool unresolved = true;
+    while( unresolved )
+    {
+      unresolved = false;
+
+      for( size_t i = 0; i < batch_size; ++i )
+      {
+        if( nodes[ i ] == cc_omap_hdr( cntr )->sentinel )
+          continue;
+
+        int cmpr_result = cmpr(
+          (char *)keys + ( batch_begin + i ) * CC_KEY_SIZE( layout ),
+          cc_omap_key( nodes[ i ], el_size, layout )
+        );
+
+        if( cmpr_result == 0 )
+        {
+          itrs[ batch_begin + i ] = cc_omap_el( nodes[ i ] );
+          ++found_count;
+          nodes[ i ] = cc_omap_hdr( cntr )->sentinel;
+          continue;
+        }
+
+        nodes[ i ] = nodes[ i ]->children[ cmpr_result > 0 ];
+        CC_PREFETCH( nodes[ i ] );
+        unresolved = true;
+      }
+    }
+  }
+
+  return found_count;
 }
 
-// Standard quadratic probing formula that guarantees that all buckets are visited when the bucket count is a power of
-// two (at least in theory, because the displacement limit could terminate the search early when the bucket count is
-// high).
-static inline size_t cc_quadratic( uint16_t displacement )
+// If dir is true, this function returns a pointer-iterator to the first element with a key greater than or equal to the
+// specified key, or an end pointer-iterator if no such element exists.
+// If dir is false, then the returned pointer-iterator is the last element with a key less than or equal to the
+// specified key, or an r_end pointer-iterator if no such element exists.
+// This function is the basis of the cc_first and cc_last API macros when overloaded with two arguments.
+static inline void *cc_omap_bounded_first_or_last(
+  void *cntr,
+  void *key,
+  bool dir,
+  size_t el_size,
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
 {
-  return ( (size_t)displacement * displacement + displacement ) / 2;
-}
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  void *result = cc_omap_r_end_or_end( cntr, dir );
 
-#define CC_MAP_MIN_NONZERO_BUCKET_COUNT 8 // Must be a power of two.
+  while( node != cc_omap_hdr( cntr )->sentinel )
+  {
+    int cmpr_result = cmpr( cc_omap_key( node, el_size, layout ), key );
+    if( cmpr_result == 0 )
+      return cc_omap_el( node );
 
-// Map header.
-typedef struct
-{
-  alignas( cc_max_align_ty )
-  size_t size;
-  size_t cap_mask; // Rather than storing the capacity (i.e. bucket count) directly, we store the bit mask used to
-                   // reduce a hash code or displacement-derived bucket index to the buckets array, i.e. the capacity
-                   // minus one.
-                   // Consequently, a zero bucket count (i.e. a placeholder map) constitutes a special case, represented
-                   // by all bits unset (i.e. zero).
-  uint16_t *metadata; // As described above, each metadatum consists of a 4-bit hash-code fragment (X), a 1-bit flag
-                      // indicating whether the key in this bucket begins a chain associated with the bucket (Y), and
-                      // an 11-bit value indicating the quadratic displacement of the next key in the chain (Z):
-                      // XXXXYZZZZZZZZZZZ.
-                      // The metadata array lives in the same allocation as the header and buckets array, but we
-                      // store a pointer to it to avoid constantly recalculating its offset.
-} cc_map_hdr_ty;
+    if( ( cmpr_result > 0 ) == dir )
+      result = cc_omap_el( node );
 
-// In the case of maps, this placeholder allows us to avoid checking for a NULL handle inside functions.
-// Setting the placeholder's metadata pointer to point to a CC_MAP_EMPTY placeholder, rather than NULL, allows us to
-// avoid checking for a zero bucket count during insertion and lookup.
-static const uint16_t cc_map_placeholder_metadatum = CC_MAP_EMPTY;
-static const cc_map_hdr_ty cc_map_placeholder = { 0, 0x0000000000000000ull, (uint16_t *)&cc_map_placeholder_metadatum };
+    node = node->children[ cmpr_result < 0 ];
+  }
 
-static inline cc_map_hdr_ty *cc_map_hdr( void *cntr )
-{
-  return (cc_map_hdr_ty *)cntr;
+  return result;
 }
 
-static inline size_t cc_map_size( void *cntr )
+// Returns a pointer-iterator to the element at the specified zero-based position in key order, or an end
+// pointer-iterator if the position is not less than the size.
+// If CC_ORDER_STATISTICS is defined, this function descends the tree by way of the subtree counts, so it takes
+// logarithmic time.
+// Otherwise, it iterates from the first or last element, whichever is nearer.
+static inline void *cc_omap_nth(
+  void *cntr,
+  size_t n,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
+)
 {
-  return cc_map_hdr( cntr )->size;
-}
+  if( n >= cc_omap_size( cntr ) )
+    return cc_omap_r_end_or_end( cntr, true );
 
-static inline size_t cc_map_cap( void *cntr )
-{
-  // If the capacity is zero, cap_mask will be zero, not the capacity minus one.
-  // We account for this special case by adding (bool)cap_mask rather than one.
-  return cc_map_hdr( cntr )->cap_mask + (bool)cc_map_hdr( cntr )->cap_mask;
-}
+#ifdef CC_ORDER_STATISTICS
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  while( true )
+  {
+    size_t left_count = node->children[ 0 ]->count;
+    if( n == left_count )
+      return cc_omap_el( node );
 
-static inline bool cc_map_is_placeholder( void *cntr )
-{
-  return !cc_map_hdr( cntr )->cap_mask;
+    if( n < left_count )
+      node = node->children[ 0 ];
+    else
+    {
+      n -= left_count + 1;
+      node = node->children[ 1 ];
+    }
+  }
+#else
+  if( n < cc_omap_size( cntr ) / 2 )
+  {
+    void *itr = cc_omap_first_or_last( cntr, true );
+    while( n-- )
+      itr = cc_omap_iterate( cntr, itr, true );
+
+    return itr;
+  }
+
+  void *itr = cc_omap_first_or_last( cntr, false );
+  for( size_t i = cc_omap_size( cntr ) - 1; i > n; --i )
+    itr = cc_omap_iterate( cntr, itr, false );
+
+  return itr;
+#endif
 }
 
-static inline void *cc_map_el(
+// Returns the number of keys less than the specified key or, if inclusive is true, less than or equal to it.
+// If CC_ORDER_STATISTICS is defined, this function takes logarithmic time.
+// Otherwise, it iterates from the first element and therefore takes time proportional to the result.
+static inline size_t cc_omap_rank_raw(
   void *cntr,
-  size_t bucket,
+  void *key,
+  bool inclusive,
   size_t el_size,
-  uint64_t layout
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  return (char *)cntr + sizeof( cc_map_hdr_ty ) + CC_BUCKET_SIZE( el_size, layout ) * bucket;
+  size_t rank = 0;
+
+#ifdef CC_ORDER_STATISTICS
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  while( node != cc_omap_hdr( cntr )->sentinel )
+  {
+    int cmpr_result = cmpr( cc_omap_key( node, el_size, layout ), key );
+    if( cmpr_result == 0 )
+      return rank + node->children[ 0 ]->count + inclusive;
+
+    if( cmpr_result < 0 )
+    {
+      rank += node->children[ 0 ]->count + 1;
+      node = node->children[ 1 ];
+    }
+    else
+      node = node->children[ 0 ];
+  }
+#else
+  for(
+    void *itr = cc_omap_first_or_last( cntr, true );
+    itr != cc_omap_r_end_or_end( cntr, true );
+    itr = cc_omap_iterate( cntr, itr, true )
+  )
+  {
+    int cmpr_result = cmpr( cc_omap_key_for( cntr, itr, el_size, layout ), key );
+    if( cmpr_result > 0 || ( cmpr_result == 0 && !inclusive ) )
+      break;
+
+    ++rank;
+  }
+#endif
+
+  return rank;
 }
 
-static inline void *cc_map_key(
+static inline size_t cc_omap_rank(
   void *cntr,
-  size_t bucket,
+  void *key,
   size_t el_size,
-  uint64_t layout
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  return (char *)cc_map_el( cntr, bucket, el_size, layout ) + CC_KEY_OFFSET( el_size, layout );
+  return cc_omap_rank_raw( cntr, key, false, el_size, layout, cmpr );
 }
 
-static inline void *cc_map_key_for(
-  void *itr,
+// Returns the number of keys in the range [ lo, hi ].
+// If CC_ORDER_STATISTICS is defined, this function subtracts the ranks of the bounds from each other, so it takes
+// logarithmic time.
+// Otherwise, it iterates from the first element with a key not less than lo, as found by
+// cc_omap_bounded_first_or_last, and therefore takes time proportional to the result.
+static inline size_t cc_omap_count_range(
+  void *cntr,
+  void *lo,
+  void *hi,
   size_t el_size,
-  uint64_t layout
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  return (char *)itr + CC_KEY_OFFSET( el_size, layout );
-}
+#ifdef CC_ORDER_STATISTICS
+  size_t below_lo = cc_omap_rank_raw( cntr, lo, false, el_size, layout, cmpr );
+  size_t through_hi = cc_omap_rank_raw( cntr, hi, true, el_size, layout, cmpr );
+  return through_hi > below_lo ? through_hi - below_lo : 0;
+#else
+  size_t count = 0;
+  for(
+    void *itr = cc_omap_bounded_first_or_last( cntr, lo, true, el_size, layout, cmpr );
+    itr != cc_omap_r_end_or_end( cntr, true ) && cmpr( cc_omap_key_for( cntr, itr, el_size, layout ), hi ) <= 0;
+    itr = cc_omap_iterate( cntr, itr, true )
+  )
+    ++count;
 
-static inline size_t cc_map_bucket_index_from_itr( void *cntr, void *itr, size_t el_size, uint64_t layout )
-{
-  return ( (char *)itr - (char *)cc_map_el( cntr, 0, el_size, layout ) ) / CC_BUCKET_SIZE( el_size, layout );
+  return count;
+#endif
 }
 
-static inline size_t cc_map_min_cap_for_n_els(
-  size_t n,
-  double max_load
+// Post-erase fix-up function to restore the red-black tree balance.
+// Niemann's implementation of this function assumes that if the starting node is a sentinel, its parent pointer has
+// been temporarily set to point to the appropriate parent.
+// Since we never write to the sentinel, we instead pass the initial parent into the function via a parameter.
+static inline void cc_omap_post_erase_fixup(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
+  cc_omapnode_hdr_ty *parent
 )
 {
-  if( n == 0 )
-    return 0;
+  while( node != cc_omap_hdr( cntr )->root && !cc_omapnode_is_red( node ) )
+  {
+    bool dir = ( node == parent->children[ 0 ] );
+    cc_omapnode_hdr_ty *sibling = parent->children[ dir ];
 
-  // Round up to a power of two.
-  size_t cap = CC_MAP_MIN_NONZERO_BUCKET_COUNT;
-  while( n > cap * max_load )
-    cap *= 2;
+    if( cc_omapnode_is_red( sibling ) )
+    {
+      cc_omapnode_set_red( sibling, false );
+      cc_omapnode_set_red( parent, true );
+      cc_omap_rotate( cntr, parent, !dir );
+      sibling = parent->children[ dir ];
+    }
 
-  return cap;
+    if( !cc_omapnode_is_red( sibling->children[ 0 ] ) && !cc_omapnode_is_red( sibling->children[ 1 ] ) )
+    {
+      cc_omapnode_set_red( sibling, true );
+      node = parent;
+      parent = cc_omapnode_parent( node ); // At this point, node can no longer be a sentinel, so we can use its
+                                           // parent pointer.
+    }
+    else
+    {
+      if( !cc_omapnode_is_red( sibling->children[ dir ] ) )
+      {
+        cc_omapnode_set_red( sibling->children[ !dir ], false );
+        cc_omapnode_set_red( sibling, true );
+        cc_omap_rotate( cntr, sibling, dir );
+        sibling = parent->children[ dir ];
+      }
+
+      cc_omapnode_set_red( sibling, cc_omapnode_is_red( parent ) );
+      cc_omapnode_set_red( parent, false );
+      cc_omapnode_set_red( sibling->children[ dir ], false );
+      cc_omap_rotate( cntr, parent, !dir );
+      node = cc_omap_hdr( cntr )->root;
+    }
+  }
+
+  if( node != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_set_red( node, false );
 }
 
-// Calculates the metadata array offset and total allocation size for a map with a given non-zero capacity.
-// The data is organized in memory as follows:
-//   +--------+-----------------------------+-----+----------------+--------+
-//   | Header |           Buckets           | Pad |    Metadata    | Excess |
-//   +--------+-----------------------------+-----+----------------+--------+
-// The metadata array requires four excess elements to ensure that iteration functions, which read four metadata at a
-// time, never read beyond the end of it.
-static inline void cc_map_allocation_details(
-  size_t cap,
+// Erases the key-element pair denoted by node.
+static inline void cc_omap_erase_raw(
+  void *cntr,
+  cc_omapnode_hdr_ty *node,
   size_t el_size,
   uint64_t layout,
-  size_t *metadata_offset,
-  size_t *allocation_size
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
 )
 {
-  size_t buckets_size = CC_BUCKET_SIZE( el_size, layout ) * cap;
-  *metadata_offset = sizeof( cc_map_hdr_ty ) + buckets_size + CC_PADDING( buckets_size, alignof( uint16_t ) );
-  *allocation_size = *metadata_offset + sizeof( uint16_t ) * ( cap + 4 );
-}
+  cc_omapnode_hdr_ty *to_detach;
 
-// Finds the earliest empty bucket in which a key-element pair belonging to home_bucket can be placed, assuming that
-// home_bucket is already occupied.
-// The reason to begin the search at home_bucket, rather than the end of the existing chain, is that key-element pairs
-// deleted from other chains might have freed up buckets that could fall in this chain before the final key.
-// Returns true if an empty bucket within the range of the displacement limit was found, in which case the final two
-// pointer arguments contain the index of the empty bucket and its quadratic displacement from home_bucket.
-static inline bool cc_map_find_first_empty(
-  void *cntr,
-  size_t home_bucket,
-  size_t *empty,
-  uint16_t *displacement
-)
-{
-  *displacement = 1;
-  size_t linear_dispacement = 1;
+  if( node->children[ 0 ] == cc_omap_hdr( cntr )->sentinel || node->children[ 1 ] == cc_omap_hdr( cntr )->sentinel )
+    to_detach = node;
+  else
+  {
+    to_detach = node->children[ 1 ];
+    while( to_detach->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
+      to_detach = to_detach->children[ 0 ];
+  }
 
-  while( true )
+  cc_omapnode_hdr_ty *child = to_detach->children[ to_detach->children[ 0 ] == cc_omap_hdr( cntr )->sentinel ];
+
+  if( child != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_set_parent( child, cc_omapnode_parent( to_detach ) );
+  if( cc_omapnode_parent( to_detach ) != cc_omap_hdr( cntr )->sentinel )
+    cc_omapnode_parent( to_detach )->children[ to_detach == cc_omapnode_parent( to_detach )->children[ 1 ] ] = child;
+  else
+    cc_omap_hdr( cntr )->root = child;
+
+#ifdef CC_ORDER_STATISTICS
+  // As for insertion, the counts must be correct before any rotations occur.
+  // If to_detach is not node, node remains in the tree, standing in for to_detach, until it is supplanted below.
+  cc_omapnode_adjust_counts( cc_omapnode_parent( to_detach ), cc_omap_hdr( cntr )->sentinel, false );
+#endif
+
+  if( !cc_omapnode_is_red( to_detach ) )
+    cc_omap_post_erase_fixup( cntr, child, cc_omapnode_parent( to_detach ) ); // Since child's parent pointer will be
+                                                                              // invalid if child is a sentinel, we
+                                                                              // must pass child's theoretical parent
+                                                                              // into the fix-up function.
+
+  // Here, most red-black tree implementations, including Niemann's, copy the data stored by to_detach into node and
+  // then free to_detach.
+  // Instead, we supplant to_detach into node's position and then free node.
+  // This prevents the invalidation of any external pointer-iterators pointing to to_detach.
+  if( to_detach != node )
   {
-    *empty = ( home_bucket + linear_dispacement ) & cc_map_hdr( cntr )->cap_mask;
-    if( cc_map_hdr( cntr )->metadata[ *empty ] == CC_MAP_EMPTY )
-      return true;
+    cc_omapnode_set_parent( to_detach, cc_omapnode_parent( node ) );
+    to_detach->children[ 0 ] = node->children[ 0 ];
+    to_detach->children[ 1 ] = node->children[ 1 ];
 
-    if( CC_UNLIKELY( ++*displacement == CC_MAP_DISPLACEMENT_MASK ) )
-      return false;
+    if( cc_omapnode_parent( node ) != cc_omap_hdr( cntr )->sentinel )
+      cc_omapnode_parent( node )->children[ cc_omapnode_parent( node )->children[ 1 ] == node ] = to_detach;
+    else
+      cc_omap_hdr( cntr )->root = to_detach;
 
-    linear_dispacement += *displacement;
+    if( node->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
+      cc_omapnode_set_parent( node->children[ 0 ], to_detach );
+    if( node->children[ 1 ] != cc_omap_hdr( cntr )->sentinel )
+      cc_omapnode_set_parent( node->children[ 1 ], to_detach );
+
+    cc_omapnode_set_red( to_detach, cc_omapnode_is_red( node ) );
+#ifdef CC_ORDER_STATISTICS
+    to_detach->count = node->count;
+#endif
   }
+
+  if( key_dtor )
+    key_dtor( cc_omap_key( node, el_size, layout ) );
+
+  if( el_dtor )
+    el_dtor( cc_omap_el( node ) );
+
+  cc_omap_free_node( cntr, node, layout, free_ );
+  --cc_omap_hdr( cntr )->size;
 }
 
-// Finds the key-element pair in the chain beginning in home_bucket after which to link a new key-element pair with
-// displacement_to_empty quadratic displacement and returns the index of the bucket containing that key-element pair.
-// Although the new key-element pair could simply be linked to the end of the chain, keeping the chain ordered by
-// displacement theoretically improves cache locality during lookups.
-static inline size_t cc_map_find_insert_location_in_chain(
+// Erases the key-element pair containing the specified key, if it exists.
+// Returns a pointer that evaluates to true if a key-element pair was erased, or else NULL.
+// This pointer is eventually cast to bool by the cc_erase API macro.
+static inline void *cc_omap_erase(
+  void *cntr,
+  void *key,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  void *itr = cc_omap_get( cntr, key, el_size, layout, NULL /* Dummy */, cmpr );
+  if( !itr )
+    return NULL;
+
+  cc_omap_erase_raw( cntr, cc_omapnode_hdr( itr ), el_size, layout, el_dtor, key_dtor, free_ );
+  return &cc_dummy_true;
+}
+
+// Erases the key-element pairs containing the n keys stored contiguously at keys, if they exist.
+// The keys are located in batches via cc_omap_get_n so that the cache misses of their descents overlap.
+// Erasing a node never moves another, so the pointer-iterators found for a batch remain valid while the batch's nodes
+// are erased.
+// However, a key repeated within a batch yields the same pointer-iterator, so only its first occurrence is erased.
+// Returns the number of key-element pairs erased.
+static inline size_t cc_omap_erase_n(
   void *cntr,
-  size_t home_bucket,
-  uint16_t displacement_to_empty
+  const void *keys,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
 )
 {
-  size_t candidate = home_bucket;
-  while( true )
+  void *itrs[ CC_GET_N_BATCH_SIZE ];
+  size_t erased_count = 0;
+
+  for( size_t batch_begin = 0; batch_begin < n; batch_begin += CC_GET_N_BATCH_SIZE )
   {
-    uint16_t displacement = cc_map_hdr( cntr )->metadata[ candidate ] & CC_MAP_DISPLACEMENT_MASK;
+    size_t batch_size = n - batch_begin < CC_GET_N_BATCH_SIZE ? n - batch_begin : CC_GET_N_BATCH_SIZE;
 
-    if( displacement > displacement_to_empty )
-      return candidate;
+    cc_omap_get_n(
+      cntr,
+      (const char *)keys + CC_KEY_SIZE( layout ) * batch_begin,
+      batch_size,
+      itrs,
+      el_size,
+      layout,
+      NULL, // Dummy.
+      cmpr
+    );
 
-    candidate = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+    for( size_t i = 0; i < batch_size; ++i )
+    {
+      if( !itrs[ i ] )
+        continue;
+
+      for( size_t j = i + 1; j < batch_size; ++j )
+        if( itrs[ j ] == itrs[ i ] )
+          itrs[ j ] = NULL;
+
+      cc_omap_erase_raw( cntr, cc_omapnode_hdr( itrs[ i ] ), el_size, layout, el_dtor, key_dtor, free_ );
+      ++erased_count;
+    }
   }
+
+  return erased_count;
 }
 
-// Frees up a bucket occupied by a key-element pair not belonging there so that a new key-element pair belonging there
-// can be placed there as the beginning of a new chain.
-// This requires:
-// * Finding the previous key-element pair in the chain to which the occupying key-element pair belongs by rehashing the
-//   key and traversing the chain.
-// * Disconnecting the key-element pair from the chain.
-// * Finding the appropriate empty bucket to which to move the key-element pair.
-// * Moving the key-element pair to the empty bucket.
-// * Re-linking the key-element pair to the chain.
-// Returns true if the eviction succeeded, or false if no empty bucket to which to evict the occupying key-element pair
-// could be found within the displacement limit.
-static inline bool cc_map_evict(
+// Erases every key-element pair for which the predicate, called with a pointer-iterator to the element, does not
+// return keep_if.
+// Rather than erasing the pairs one by one, each with a fix-up, the function dismantles the tree in descending order,
+// repeatedly detaching its greatest node, and either destroys each node or pushes it onto a chain.
+// It then rebuilds a perfectly balanced tree from the chain via cc_omap_build_subtree.
+// The remaining nodes are relinked rather than reallocated, so pointer-iterators to them remain valid.
+// This function is the basis of both cc_filter (keep_if is true) and cc_erase_if (keep_if is false).
+// Returns the number of key-element pairs erased.
+static inline size_t cc_omap_filter(
   void *cntr,
-  size_t bucket,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
 )
 {
-  // Find the previous key-element pair in chain.
-  size_t home_bucket = hash( cc_map_key( cntr, bucket, el_size, layout ) ) & cc_map_hdr( cntr )->cap_mask;
-  size_t prev = home_bucket;
-  while( true )
+  size_t size = cc_omap_size( cntr );
+  if( !size )
+    return 0;
+
+  cc_omapnode_hdr_ty *sentinel = cc_omap_hdr( cntr )->sentinel;
+  cc_omapnode_hdr_ty *chain = NULL;
+  size_t kept = 0;
+
+  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  while( node != sentinel )
   {
-    size_t next = ( home_bucket + cc_quadratic( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK ) ) &
-      cc_map_hdr( cntr )->cap_mask;
+    if( node->children[ 1 ] != sentinel )
+    {
+      node = node->children[ 1 ];
+      continue;
+    }
 
-    if( next == bucket )
-      break;
+    // The node is the greatest remaining, so it is either the root or the right child of its parent.
+    // Replace it with its left subtree, whose greatest node is the next to visit, if it exists, or else the parent.
+    cc_omapnode_hdr_ty *parent = cc_omapnode_parent( node );
+    cc_omapnode_hdr_ty *left = node->children[ 0 ];
 
-    prev = next;
-  }
+    if( left != sentinel )
+      cc_omapnode_set_parent( left, parent );
+    if( parent != sentinel )
+      parent->children[ 1 ] = left;
 
-  // Disconnect the key-element pair from chain.
-  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
-    ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK );
+    if( pred( cc_omap_el( node ), ctx ) == keep_if )
+    {
+      cc_omapnode_set_parent_and_color( node, chain, false );
+      chain = node;
+      ++kept;
+    }
+    else
+    {
+      if( key_dtor )
+        key_dtor( cc_omap_key( node, el_size, layout ) );
 
-  // Find the empty bucket to which to move the key-element pair.
-  size_t empty;
-  uint16_t displacement;
-  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
-    return false;
+      if( el_dtor )
+        el_dtor( cc_omap_el( node ) );
 
-  // Find the key-element pair in the chain after which to link the moved key-element pair.
-  prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+      cc_omap_free_node( cntr, node, layout, free_ );
+    }
 
-  // Move the key and element.
-  memcpy(
-    cc_map_el( cntr, empty, el_size, layout ),
-    cc_map_el( cntr, bucket, el_size, layout ),
-    CC_BUCKET_SIZE( el_size, layout )
-  );
+    node = left != sentinel ? left : parent;
+  }
 
-  // Re-link the key-element pair to the chain from its new bucket.
-  cc_map_hdr( cntr )->metadata[ empty ] = ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) |
-    ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK );
-  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
-    displacement;
+  cc_omap_builder_ty builder;
+  builder.sentinel = sentinel;
+  builder.nodes = NULL;
+  builder.chain = chain;
+  builder.source = NULL;
+  builder.keys = NULL;
+
+  // See cc_omap_build.
+  builder.red_depth = 0;
+  for( size_t i = kept + 1; i > 1; i /= 2 )
+    ++builder.red_depth;
+
+  cc_omap_hdr( cntr )->root = cc_omap_build_subtree( &builder, kept, 0 );
+  cc_omap_hdr( cntr )->size = kept;
+  return size - kept;
+}
 
-  return true;
+// Erases the key-element pair pointed to by itr and returns a pointer-iterator to the next key-element pair in the
+// tree.
+// This function must be inlined to ensure that the compiler optimizes away the cc_omap_next call if the returned
+// pointer-iterator is discarded.
+static inline CC_ALWAYS_INLINE void *cc_omap_erase_itr(
+  void *cntr,
+  void *itr,
+  size_t el_size,
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  void *next = cc_omap_next( cntr, itr, 0 /* Dummy */, 0 /* Dummy */ );
+  cc_omap_erase_raw( cntr, cc_omapnode_hdr( itr ), el_size, layout, el_dtor, key_dtor, free_ );
+  return next;
 }
 
-// Inserts a key-element pair, optionally replacing the existing key-element pair containing the same key if it exists.
-// There are two main cases that must be handled:
-// * If the key-element pair's home bucket is empty or occupied by a key-element pair that does not belong there, then
-//   the key-element pair is inserted there, evicting the occupying key-element pair if there is one.
-// * Otherwise, the chain of key-element pairs beginning at the home bucket is traversed in search of a matching key.
-//   If none is found, then the new key-element pair is inserted at the earliest available bucket, per quadratic probing
-//   from the home bucket, and then linked to the chain in a manner that maintains its quadratic order.
-// The replace argument tells the function whether to replace an existing key-element pair.
-// If replace is true, the function returns a pointer-iterator to the inserted element, or NULL if the key-element pair
-// was not inserted because of the max load factor or displacement limit constraints.
-// If replace is false, then the return value is as described above, except that if the key already exists, the function
-// returns a pointer-iterator to the associated element.
-static inline void *cc_map_insert_raw(
+// Calls the destructors for the key and element types, if necessary, for every key-element pair in the detached
+// subtree rooted at the specified node and frees the nodes if must_free_nodes is true.
+// The subtree is dismantled in post-order without any fix-ups.
+// Returns the number of nodes in the subtree.
+static inline size_t cc_omap_destroy_subtree(
   void *cntr,
-  void *el,
-  void *key,
-  bool replace,
+  cc_omapnode_hdr_ty *node,
   size_t el_size,
   uint64_t layout,
-  double max_load,
-  cc_hash_fnptr_ty hash,
-  cc_cmpr_fnptr_ty cmpr,
   cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor
+  cc_dtor_fnptr_ty key_dtor,
+  bool must_free_nodes,
+  cc_free_fnptr_ty free_
 )
 {
-  size_t key_hash = hash( key );
-  uint16_t hashfrag = cc_hash_frag( key_hash );
-  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+  size_t node_count = 0;
 
-  // Case 1: The home bucket is empty or contains a key-element pair that doesn't belong there.
-  // This case also implicitly handles the case of a zero-capacity placeholder map, since home_bucket will be zero and
-  // metadata[ 0 ] will be the empty placeholder metadatum.
-  // In that scenario, the zero cap_mask triggers the below load-factor check.
-  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
+  while( node != cc_omap_hdr( cntr )->sentinel )
   {
-    // Load-factor check.
-    if( CC_UNLIKELY( cc_map_hdr( cntr )->size + 1 > max_load * cc_map_cap( cntr ) ) )
-      return NULL;
+    cc_omapnode_hdr_ty *next;
 
-    // Vacate the home bucket if it contains a key-element pair.
-    if(
-      cc_map_hdr( cntr )->metadata[ home_bucket ] != CC_MAP_EMPTY &&
-      CC_UNLIKELY( !cc_map_evict( cntr, home_bucket, el_size, layout, hash ) )
-    )
-      return NULL;
+    if( node->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
+    {
+      next = node->children[ 0 ];
+      node->children[ 0 ] = cc_omap_hdr( cntr )->sentinel;
+    }
+    else if( node->children[ 1 ] != cc_omap_hdr( cntr )->sentinel )
+    {
+      next = node->children[ 1 ];
+      node->children[ 1 ] = cc_omap_hdr( cntr )->sentinel;
+    }
+    else
+    {
+      next = cc_omapnode_parent( node );
 
-    memcpy( cc_map_key( cntr, home_bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-    memcpy( cc_map_el( cntr, home_bucket, el_size, layout ), el, el_size );
-    cc_map_hdr( cntr )->metadata[ home_bucket ] = hashfrag | CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+      if( key_dtor )
+        key_dtor( cc_omap_key( node, el_size, layout ) );
 
-    ++cc_map_hdr( cntr )->size;
+      if( el_dtor )
+        el_dtor( cc_omap_el( node ) );
 
-    return cc_map_el( cntr, home_bucket, el_size, layout );
+      if( must_free_nodes )
+        cc_omap_free_node( cntr, node, layout, free_ );
+
+      ++node_count;
+    }
+
+    node = next;
   }
 
-  // Case 2: The home bucket contains the beginning of a chain.
+  return node_count;
+}
 
-  // Check the existing chain.
-  size_t bucket = home_bucket;
-  while( true )
-  {
-    if(
-      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
-      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
-    )
-    {
-      if( replace )
-      {
-        if( key_dtor )
-          key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
+// Returns the number of black nodes on every path from the specified node, inclusive, to a leaf.
+static inline size_t cc_omap_black_height( cc_omapnode_hdr_ty *node, cc_omapnode_hdr_ty *sentinel )
+{
+  size_t black_height = 0;
+  for( ; node != sentinel; node = node->children[ 0 ] )
+    black_height += !cc_omapnode_is_red( node );
 
-        if( el_dtor )
-          el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
+  return black_height;
+}
 
-        memcpy( cc_map_key( cntr, bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-        memcpy( cc_map_el( cntr, bucket, el_size, layout ), el, el_size );
-      }
+// Joins two detached subtrees and a detached node, whose key lies between those of the two subtrees, into one tree and
+// returns its root.
+// The node, colored red, takes the place of the black node with the same black height as the shorter subtree on the
+// inner spine of the taller subtree, adopting that node and the shorter subtree as its children.
+// The post-insert fix-up then restores the balance, so the join takes time proportional to the logarithm of the number
+// of nodes.
+static inline cc_omapnode_hdr_ty *cc_omap_join_subtrees(
+  cc_omapnode_hdr_ty *left,
+  cc_omapnode_hdr_ty *node,
+  cc_omapnode_hdr_ty *right,
+  cc_omapnode_hdr_ty *sentinel
+)
+{
+  // Coloring the root of a red-black tree black never violates the tree's invariants.
+  if( left != sentinel )
+    cc_omapnode_set_red( left, false );
+  if( right != sentinel )
+    cc_omapnode_set_red( right, false );
 
-      return cc_map_el( cntr, bucket, el_size, layout );
-    }
+  size_t left_height = cc_omap_black_height( left, sentinel );
+  size_t right_height = cc_omap_black_height( right, sentinel );
 
-    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
-    if( displacement == CC_MAP_DISPLACEMENT_MASK )
-      break;
+  if( left_height == right_height )
+  {
+    cc_omapnode_set_parent_and_color( node, sentinel, false );
+    node->children[ 0 ] = left;
+    node->children[ 1 ] = right;
+    if( left != sentinel )
+      cc_omapnode_set_parent( left, node );
+    if( right != sentinel )
+      cc_omapnode_set_parent( right, node );
+
+#ifdef CC_ORDER_STATISTICS
+    cc_omapnode_update_count( node );
+#endif
+    return node;
+  }
 
-    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+  // dir is the side of the taller subtree on which the shorter subtree belongs.
+  bool dir = left_height > right_height;
+  cc_omapnode_hdr_ty *shorter = dir ? right : left;
+  size_t shorter_height = dir ? right_height : left_height;
+
+  // The fix-up needs a header through which its rotations can update the root.
+  cc_omap_hdr_ty tree;
+  tree.root = dir ? left : right;
+  tree.sentinel = sentinel;
+
+  // Find the black node, possibly the sentinel, on the inner spine whose black height matches the shorter subtree's.
+  cc_omapnode_hdr_ty *parent = sentinel;
+  cc_omapnode_hdr_ty *spine = tree.root;
+  size_t height = dir ? left_height : right_height;
+  while( cc_omapnode_is_red( spine ) || height > shorter_height )
+  {
+    height -= !cc_omapnode_is_red( spine );
+    parent = spine;
+    spine = spine->children[ dir ];
   }
 
-  // Load-factor check.
-  if( CC_UNLIKELY( cc_map_hdr( cntr )->size + 1 > max_load * cc_map_cap( cntr ) ) )
-    return NULL;
+  cc_omapnode_set_parent_and_color( node, parent, true );
+  node->children[ !dir ] = spine;
+  node->children[ dir ] = shorter;
+  parent->children[ dir ] = node;
+  if( spine != sentinel )
+    cc_omapnode_set_parent( spine, node );
+  if( shorter != sentinel )
+    cc_omapnode_set_parent( shorter, node );
+
+#ifdef CC_ORDER_STATISTICS
+  // As for insertion, the counts must be correct before any rotations occur.
+  cc_omapnode_update_count( node );
+  for( ; parent != sentinel; parent = cc_omapnode_parent( parent ) )
+    parent->count += shorter->count + 1;
+#endif
 
-  // Find the earliest empty bucket, per quadratic probing.
-  size_t empty;
-  uint16_t displacement;
-  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
-    return NULL;
+  cc_omap_post_insert_fixup( &tree, node );
+  return tree.root;
+}
 
-  size_t prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+// Splits the tree containing the specified node into the subtree of nodes whose keys are less than the node's key, the
+// subtree of nodes whose keys are greater, and the node itself, which is left detached.
+// The two subtrees are assembled by joining, in turn, the subtrees hanging off the path from the node to the root with
+// the nodes on that path.
+// Because each join recomputes the black heights of the subtrees, the split takes time proportional to the square of
+// the logarithm of the number of nodes.
+static inline void cc_omap_split_subtrees(
+  cc_omapnode_hdr_ty *node,
+  cc_omapnode_hdr_ty *sentinel,
+  cc_omapnode_hdr_ty **left,
+  cc_omapnode_hdr_ty **right
+)
+{
+  cc_omapnode_hdr_ty *subtrees[ 2 ] = { node->children[ 0 ], node->children[ 1 ] };
+  for( int dir = 0; dir < 2; ++dir )
+    if( subtrees[ dir ] != sentinel )
+      cc_omapnode_set_parent( subtrees[ dir ], sentinel );
 
-  // Insert the new key and element in the empty bucket and link it to the chain.
+  cc_omapnode_hdr_ty *parent = cc_omapnode_parent( node );
+  while( parent != sentinel )
+  {
+    cc_omapnode_hdr_ty *grandparent = cc_omapnode_parent( parent );
+    bool dir = node == parent->children[ 1 ];
 
-  memcpy( cc_map_key( cntr, empty, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-  memcpy( cc_map_el( cntr, empty, el_size, layout ), el, el_size );
+    // The parent and its other subtree lie on the opposite side of the node from the parent's other child.
+    cc_omapnode_hdr_ty *other = parent->children[ !dir ];
+    if( other != sentinel )
+      cc_omapnode_set_parent( other, sentinel );
 
-  cc_map_hdr( cntr )->metadata[ empty ] = hashfrag | ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK
-    );
-  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
-    displacement;
+    if( dir )
+      subtrees[ 0 ] = cc_omap_join_subtrees( other, parent, subtrees[ 0 ], sentinel );
+    else
+      subtrees[ 1 ] = cc_omap_join_subtrees( subtrees[ 1 ], parent, other, sentinel );
 
-  ++cc_map_hdr( cntr )->size;
+    node = parent;
+    parent = grandparent;
+  }
 
-  return cc_map_el( cntr, empty, el_size, layout );
+  *left = subtrees[ 0 ];
+  *right = subtrees[ 1 ];
 }
 
-// Inserts a key-element pair, assuming that the key does not already exist and that the map's capacity is large enough
-// to accommodate it without violating the load factor constraint.
-// These conditions are met during map resizing and rehashing.
-// This function is the same as cc_map_insert_raw, except that no load-factor check or check of the existing chain is
-// performed.
-// It returns a pointer-iterator to the inserted element, or NULL if the key-element pair was not inserted because of
-// the max load factor or displacement limit constraints.
-static inline void *cc_map_reinsert(
+// Erases the key-element pairs from the one pointed to by itr_first up to, but not including, the one pointed to by
+// itr_end, which may be an end pointer-iterator, and returns itr_end.
+// Rather than erasing the nodes one by one, each with a fix-up, the function splits the range off the tree, joins the
+// remaining subtrees, and then destroys the range's nodes en masse.
+// Hence, besides the destructor calls and freeing of the nodes, it takes polylogarithmic time.
+static inline void *cc_omap_erase_range(
   void *cntr,
-  void *el,
-  void *key,
+  void *itr_first,
+  void *itr_end,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash
-)
-{
-  size_t key_hash = hash( key );
-  uint16_t hashfrag = cc_hash_frag( key_hash );
-  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
-
-  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
-  {
-    if(
-      cc_map_hdr( cntr )->metadata[ home_bucket ] != CC_MAP_EMPTY &&
-      CC_UNLIKELY( !cc_map_evict( cntr, home_bucket, el_size, layout, hash ) )
-    )
-      return NULL;
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  if( itr_first == itr_end )
+    return itr_end;
 
-    memcpy( cc_map_key( cntr, home_bucket, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-    memcpy( cc_map_el( cntr, home_bucket, el_size, layout ), el, el_size );
-    cc_map_hdr( cntr )->metadata[ home_bucket ] = hashfrag | CC_MAP_IN_HOME_BUCKET_MASK | CC_MAP_DISPLACEMENT_MASK;
+  cc_omapnode_hdr_ty *sentinel = cc_omap_hdr( cntr )->sentinel;
+  cc_omapnode_hdr_ty *first = cc_omapnode_hdr( itr_first );
+  cc_omapnode_hdr_ty *left;
+  cc_omapnode_hdr_ty *range;
+  cc_omap_split_subtrees( first, sentinel, &left, &range );
 
-    ++cc_map_hdr( cntr )->size;
+  if( itr_end == cc_omap_r_end_or_end( cntr, true ) )
+  {
+    if( left != sentinel )
+      cc_omapnode_set_red( left, false );
 
-    return cc_map_el( cntr, home_bucket, el_size, layout );
+    cc_omap_hdr( cntr )->root = left;
+  }
+  else
+  {
+    cc_omapnode_hdr_ty *right;
+    cc_omap_split_subtrees( cc_omapnode_hdr( itr_end ), sentinel, &range, &right );
+    cc_omap_hdr( cntr )->root = cc_omap_join_subtrees( left, cc_omapnode_hdr( itr_end ), right, sentinel );
   }
 
-  size_t empty;
-  uint16_t displacement;
-  if( CC_UNLIKELY( !cc_map_find_first_empty( cntr, home_bucket, &empty, &displacement ) ) )
-    return NULL;
-
-  size_t prev = cc_map_find_insert_location_in_chain( cntr, home_bucket, displacement );
+  // Reattach the first node to the range so that it is destroyed along with the rest.
+  first->children[ 0 ] = sentinel;
+  first->children[ 1 ] = range;
+  cc_omapnode_set_parent( first, sentinel );
+  if( range != sentinel )
+    cc_omapnode_set_parent( range, first );
 
-  memcpy( cc_map_key( cntr, empty, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-  memcpy( cc_map_el( cntr, empty, el_size, layout ), el, el_size );
+  cc_omap_hdr( cntr )->size -= cc_omap_destroy_subtree( cntr, first, el_size, layout, el_dtor, key_dtor, true, free_ );
+  return itr_end;
+}
 
-  cc_map_hdr( cntr )->metadata[ empty ] = hashfrag | ( cc_map_hdr( cntr )->metadata[ prev ] & CC_MAP_DISPLACEMENT_MASK
-    );
-  cc_map_hdr( cntr )->metadata[ prev ] = ( cc_map_hdr( cntr )->metadata[ prev ] & ~CC_MAP_DISPLACEMENT_MASK ) |
-    displacement;
+// Returns true if nodes allocated for the source ordered map can simply be relinked into the destination ordered map.
+// As with splicing between lists, that requires the two ordered maps to share an allocator, and the nodes must also
+// share a sentinel.
+// If CC_POOL_NODES is defined, it is never possible because each ordered map's nodes belong to its own pool.
+static inline bool cc_omap_can_move_nodes( void *dst, void *src )
+{
+#ifdef CC_POOL_NODES
+  (void)dst;
+  (void)src;
+  return false;
+#else
+  return
+    cc_omap_hdr( dst )->allocator == cc_omap_hdr( src )->allocator &&
+    cc_omap_hdr( dst )->sentinel == cc_omap_hdr( src )->sentinel;
+#endif
+}
 
-  ++cc_map_hdr( cntr )->size;
+// Copies n consecutive key-element pairs of the source ordered map, beginning with the one pointed to by itr, into the
+// nodes of a perfectly balanced detached subtree built for the ordered map by cc_omap_build_subtree.
+// The ordered map must not be a placeholder, and n must be greater than zero.
+// Returns the subtree's root, or NULL in the case of allocation failure.
+static inline cc_omapnode_hdr_ty *cc_omap_copy_subtree(
+  void *cntr,
+  void *src,
+  void *itr,
+  size_t n,
+  size_t el_size,
+  uint64_t layout,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_omap_builder_ty builder;
+  builder.sentinel = cc_omap_hdr( cntr )->sentinel;
+  builder.nodes = NULL;
+  builder.node_size = cc_pool_node_size( CC_OMAPNODE_SIZE( el_size, layout ) );
+  builder.chain = NULL;
+  builder.source = src;
+  builder.source_itr = itr;
+  builder.remaining = n;
+  builder.el_size = el_size;
+  builder.layout = layout;
+
+  // See cc_omap_build.
+  builder.red_depth = 0;
+  for( size_t i = n + 1; i > 1; i /= 2 )
+    ++builder.red_depth;
+
+  if( CC_UNLIKELY( !cc_omap_builder_alloc_nodes( &builder, cntr, n, realloc_, free_ ) ) )
+    return NULL;
 
-  return cc_map_el( cntr, empty, el_size, layout );
+  return cc_omap_build_subtree( &builder, n, 0 );
 }
 
-// Creates a rehashed duplicate of cntr with capacity cap.
-// Assumes that cap is a power of two large enough to accommodate all key-element pairs without violating the max load
-// factor.
-// Returns a pointer to the duplicate, or NULL in the case of allocation failure.
-// As this function is called very rarely in cc_map_insert and cc_map_get_or_insert, ideally it should not be inlined
-// into those functions.
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wattributes" // Silence warning about combining noinline with static inline.
-__attribute__((noinline))
-#endif
-static inline void *cc_map_make_rehash(
+// Relinks the nodes of the detached subtree rooted at subtree, which number subtree_size and must belong to the
+// ordered map, into the ordered map's tree.
+// If every key in the subtree is greater than every key in the tree, or vice versa, the subtree and the tree are
+// joined in polylogarithmic time, with the subtree's first or last node, respectively, serving as the joining node.
+// Otherwise, the subtree's nodes are relinked into the tree one by one, replacing the key-element pairs containing the
+// same keys if they exist.
+// The ordered map must not be a placeholder.
+static inline void cc_omap_graft(
   void *cntr,
-  size_t cap,
+  cc_omapnode_hdr_ty *subtree,
+  size_t subtree_size,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  cc_realloc_fnptr_ty realloc_,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
   cc_free_fnptr_ty free_
 )
 {
-  // The attempt to resize and rehash must occur inside a loop that incrementally doubles the target bucket count
-  // because a failure could theoretically occur at any load factor due to the displacement limit.
-  while( true )
+  cc_omapnode_hdr_ty *sentinel = cc_omap_hdr( cntr )->sentinel;
+
+  if( subtree == sentinel )
+    return;
+
+  if( cc_omap_hdr( cntr )->root == sentinel )
   {
-    size_t metadata_offset;
-    size_t allocation_size;
-    cc_map_allocation_details( cap, el_size, layout, &metadata_offset, &allocation_size );
+    cc_omapnode_set_red( subtree, false );
+    cc_omap_hdr( cntr )->root = subtree;
+    cc_omap_hdr( cntr )->size += subtree_size;
+    return;
+  }
 
-    cc_map_hdr_ty *new_cntr = (cc_map_hdr_ty *)realloc_( NULL, allocation_size );
-    if( CC_UNLIKELY( !new_cntr ) )
-      return NULL;
+  // A temporary header allows iteration over the subtree.
+  cc_omap_hdr_ty other;
+  other.root = subtree;
+  other.sentinel = sentinel;
 
-    new_cntr->size = 0;
-    new_cntr->cap_mask = cap - 1;
-    new_cntr->metadata = (uint16_t *)( (char *)new_cntr + metadata_offset );
+  for( int i = 0; i < 2; ++i )
+  {
+    // If dir is true, check whether the subtree's first key is greater than the tree's last key.
+    // Otherwise, check whether the subtree's last key is less than the tree's first key.
+    bool dir = i;
+    void *itr = cc_omap_first_or_last( &other, dir );
+    int cmpr_result = cmpr(
+      cc_omap_key_for( cntr, itr, el_size, layout ),
+      cc_omap_key_for( cntr, cc_omap_first_or_last( cntr, !dir ), el_size, layout )
+    );
+    if( dir ? cmpr_result <= 0 : cmpr_result >= 0 )
+      continue;
 
-    memset( new_cntr->metadata, 0x00, ( cap + 4 ) * sizeof( uint16_t ) );
+    cc_omapnode_hdr_ty *halves[ 2 ];
+    cc_omap_split_subtrees( cc_omapnode_hdr( itr ), sentinel, &halves[ 0 ], &halves[ 1 ] );
 
-    // Iteration stopper at the end of the actual metadata array (i.e. the first of the four excess metadata).
-    new_cntr->metadata[ cap ] = 0x01;
+    if( dir )
+      cc_omap_hdr( cntr )->root = cc_omap_join_subtrees(
+        cc_omap_hdr( cntr )->root,
+        cc_omapnode_hdr( itr ),
+        halves[ 1 ],
+        sentinel
+      );
+    else
+      cc_omap_hdr( cntr )->root = cc_omap_join_subtrees(
+        halves[ 0 ],
+        cc_omapnode_hdr( itr ),
+        cc_omap_hdr( cntr )->root,
+        sentinel
+      );
 
-    for( size_t i = 0; i < cc_map_cap( cntr ); ++i )
-      if( cc_map_hdr( cntr )->metadata[ i ] != CC_MAP_EMPTY )
-      {
-        void *key = cc_map_key( cntr, i, el_size, layout );
-        if( CC_UNLIKELY( !cc_map_reinsert(            
-          new_cntr,
-          cc_map_el( cntr, i, el_size, layout ),
-          key,
-          el_size,
-          layout,
-          hash
-        ) ) )
-          break;
-      }
+    cc_omap_hdr( cntr )->size += subtree_size;
+    return;
+  }
 
-    // If a key could not be reinserted due to the displacement limit, double the bucket count and retry.
-    if( CC_UNLIKELY( new_cntr->size < cc_map_size( cntr ) ) )
+  // The key ranges overlap, so dismantle the subtree in post-order, as cc_omap_destroy_subtree does, and relink each
+  // node individually.
+  cc_omapnode_hdr_ty *node = subtree;
+  while( node != sentinel )
+  {
+    cc_omapnode_hdr_ty *next;
+
+    if( node->children[ 0 ] != sentinel )
     {
-      free_( new_cntr );
-      cap *= 2;
+      next = node->children[ 0 ];
+      node->children[ 0 ] = sentinel;
+      node = next;
       continue;
     }
 
-    return new_cntr;
+    if( node->children[ 1 ] != sentinel )
+    {
+      next = node->children[ 1 ];
+      node->children[ 1 ] = sentinel;
+      node = next;
+      continue;
+    }
+
+    next = cc_omapnode_parent( node );
+
+    cc_omapnode_hdr_ty *parent = sentinel;
+    cc_omapnode_hdr_ty *position = cc_omap_hdr( cntr )->root;
+    int cmpr_result = 0; // See cc_omap_insert_below.
+
+    while( position != sentinel )
+    {
+      cmpr_result = cmpr( cc_omap_key( node, el_size, layout ), cc_omap_key( position, el_size, layout ) );
+      if( cmpr_result == 0 )
+        break;
+
+      parent = position;
+      position = position->children[ cmpr_result > 0 ];
+    }
+
+    if( position != sentinel )
+    {
+      if( key_dtor )
+        key_dtor( cc_omap_key( position, el_size, layout ) );
+
+      if( el_dtor )
+        el_dtor( cc_omap_el( position ) );
+
+      memcpy( cc_omap_el( position ), cc_omap_el( node ), CC_KEY_OFFSET( el_size, layout ) + CC_KEY_SIZE( layout ) );
+      cc_omap_free_node( cntr, node, layout, free_ );
+    }
+    else
+    {
+      cc_omap_link_node( cntr, node, parent, cmpr_result > 0 );
+      ++cc_omap_hdr( cntr )->size;
+    }
+
+    node = next;
   }
 }
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#endif
 
-// Reserves capacity such that the map can accommodate n key-element pairs without reallocation (i.e. without violating
-// the max load factor).
-// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
-// operation was successful or false in the case of allocation failure.
-static inline cc_allocing_fn_result_ty cc_map_reserve(
-  void *cntr,
-  size_t n,
-  size_t el_size,
-  uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  double max_load,
-  cc_realloc_fnptr_ty realloc_,
-  cc_free_fnptr_ty free_
-)
+// Returns the number of nodes in the second of two trees, given their combined number of nodes.
+// If CC_ORDER_STATISTICS is defined, the count is read from the second tree's root.
+// Otherwise, the function iterates over the two trees in lockstep and counts the nodes of whichever is smaller, so it
+// takes time proportional to the smaller size.
+static inline size_t cc_omap_count_second( void *first_tree, void *second_tree, size_t total )
 {
-  size_t cap = cc_map_min_cap_for_n_els( n, max_load );
-
-  if( cc_map_cap( cntr ) >= cap )
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
-
-  void *new_cntr = cc_map_make_rehash(
-    cntr,
-    cap,
-    el_size,
-    layout,
-    hash,
-    realloc_,
-    free_
-  );
-  if( CC_UNLIKELY( !new_cntr ) )
-    return cc_make_allocing_fn_result( cntr, NULL );
+#ifdef CC_ORDER_STATISTICS
+  (void)first_tree;
+  (void)total;
+  return cc_omap_hdr( second_tree )->root->count;
+#else
+  void *trees[ 2 ] = { first_tree, second_tree };
+  void *itrs[ 2 ] = { cc_omap_first_or_last( first_tree, true ), cc_omap_first_or_last( second_tree, true ) };
+  size_t counts[ 2 ] = { 0, 0 };
 
-  if( !cc_map_is_placeholder( cntr ) )
-    free_( cntr );
+  while( true )
+    for( int i = 0; i < 2; ++i )
+    {
+      if( itrs[ i ] == cc_omap_r_end_or_end( trees[ i ], true ) )
+        return i ? counts[ 1 ] : total - counts[ 0 ];
 
-  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
+      itrs[ i ] = cc_omap_iterate( trees[ i ], itrs[ i ], true );
+      ++counts[ i ];
+    }
+#endif
 }
 
-// Inserts a key-element pair.
-// If replace is true, then the new key-element pair replaces any existing key-element pair containing the same key.
-// This function wraps cc_map_insert_raw in a loop that handles growing and rehashing the table if a new key-element
-// pair cannot be inserted because of the max load factor or displacement limit constraints.
-// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer-iterator to the newly inserted
-// element, or to the existing element with the matching key if replace is false.
-// If the underlying storage needed to be expanded and an allocation failure occurred, the latter pointer will be NULL.
-static inline cc_allocing_fn_result_ty cc_map_insert(
+// Moves the key-element pairs whose keys are greater than or equal to the specified key into dst, which must be a
+// different ordered map of the same type, combining them with dst's existing key-element pairs as cc_omap_join does.
+// If the nodes can be relinked into dst, the pairs are split off the tree in polylogarithmic time (besides the
+// counting done by cc_omap_count_second).
+// Otherwise, they are copied into new nodes allocated for dst and then erased, without destructor calls, from the
+// ordered map.
+// Returns a cc_allocing_fn_result_ty containing dst's new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure, in which case neither ordered map is changed.
+static inline cc_allocing_fn_result_ty cc_omap_split_at(
   void *cntr,
-  void *el,
   void *key,
-  bool replace,
+  void *dst,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
   cc_cmpr_fnptr_ty cmpr,
-  double max_load,
   cc_dtor_fnptr_ty el_dtor,
   cc_dtor_fnptr_ty key_dtor,
   cc_realloc_fnptr_ty realloc_,
   cc_free_fnptr_ty free_
 )
 {
-  while( true )
+  void *itr = cc_omap_bounded_first_or_last( cntr, key, true, el_size, layout, cmpr );
+  if( itr == cc_omap_r_end_or_end( cntr, true ) )
+    return cc_make_allocing_fn_result( dst, cc_dummy_true_ptr );
+
+  // Allocate a header for dst if necessary.
+  // In the case of allocation failure, the header is freed again so that dst is left as it was.
+  void *placeholder = NULL;
+  if( cc_omap_is_placeholder( dst ) )
   {
-    void *itr = cc_map_insert_raw(
-      cntr,
-      el,
-      key,
-      replace,
-      el_size,
-      layout,
-      max_load,
-      hash,
-      cmpr,
-      el_dtor,
-      key_dtor
-    );
+    void *new_dst = cc_omap_alloc_hdr( dst, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_dst ) )
+      return cc_make_allocing_fn_result( dst, NULL );
 
-    if( CC_LIKELY( itr ) )
-      return cc_make_allocing_fn_result( cntr, itr );
+    placeholder = dst;
+    dst = new_dst;
+  }
 
-    void *new_cntr = cc_map_make_rehash(
+  cc_omapnode_hdr_ty *sentinel = cc_omap_hdr( cntr )->sentinel;
+  cc_omapnode_hdr_ty *subtree;
+  size_t subtree_size = 0;
+
+  if( cc_omap_can_move_nodes( dst, cntr ) )
+  {
+    cc_omapnode_hdr_ty *left;
+    cc_omapnode_hdr_ty *right;
+    cc_omap_split_subtrees( cc_omapnode_hdr( itr ), sentinel, &left, &right );
+    subtree = cc_omap_join_subtrees( sentinel, cc_omapnode_hdr( itr ), right, sentinel );
+
+    if( left != sentinel )
+      cc_omapnode_set_red( left, false );
+
+    cc_omap_hdr( cntr )->root = left;
+
+    cc_omap_hdr_ty moved;
+    moved.root = subtree;
+    moved.sentinel = sentinel;
+    subtree_size = cc_omap_count_second( cntr, &moved, cc_omap_hdr( cntr )->size );
+    cc_omap_hdr( cntr )->size -= subtree_size;
+  }
+  else
+  {
+    for( void *i = itr; i != cc_omap_r_end_or_end( cntr, true ); i = cc_omap_iterate( cntr, i, true ) )
+      ++subtree_size;
+
+    subtree = cc_omap_copy_subtree( dst, cntr, itr, subtree_size, el_size, layout, realloc_, free_ );
+    if( CC_UNLIKELY( !subtree ) )
+    {
+      if( placeholder )
+      {
+        cc_allocator_free( NULL, free_, dst );
+        dst = placeholder;
+      }
+
+      return cc_make_allocing_fn_result( dst, NULL );
+    }
+
+    cc_omap_erase_range(
       cntr,
-      cc_map_hdr( cntr )->cap_mask ? cc_map_cap( cntr ) * 2 : CC_MAP_MIN_NONZERO_BUCKET_COUNT,
+      itr,
+      cc_omap_r_end_or_end( cntr, true ),
       el_size,
       layout,
-      hash,
-      realloc_,
+      NULL,   // The key-element pairs now belong to dst.
+      NULL,
       free_
     );
-
-    if( CC_UNLIKELY( !new_cntr ) )
-      return cc_make_allocing_fn_result( cntr, NULL );
-
-    if( !cc_map_is_placeholder( cntr ) )
-        free_( cntr );
-
-    cntr = new_cntr;
   }
+
+  cc_omap_graft( dst, subtree, subtree_size, el_size, layout, cmpr, el_dtor, key_dtor, free_ );
+  return cc_make_allocing_fn_result( dst, cc_dummy_true_ptr );
 }
 
-static inline void *cc_map_get(
+// Moves all key-element pairs from src, which must be a different ordered map of the same type, into the ordered map,
+// replacing the key-element pairs containing the same keys if they exist.
+// If the nodes can be relinked into the ordered map and the two maps' key ranges do not overlap, the trees are joined
+// in polylogarithmic time (see cc_omap_graft).
+// If the nodes cannot be relinked, they are first copied into new nodes allocated for the ordered map.
+// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
+// operation was successful or false in the case of allocation failure, in which case neither ordered map is changed.
+static inline cc_allocing_fn_result_ty cc_omap_join(
   void *cntr,
-  void *key,
+  void *src,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  cc_cmpr_fnptr_ty cmpr
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
 )
 {
-  size_t key_hash = hash( key );
-  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
+  if( cc_omap_size( src ) == 0 )
+    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
 
-  // If the home bucket is empty or contains a key-element pair that does not belong there, then our key does not exist.
-  // This check also implicitly handles the case of a zero bucket count, since home_bucket will be zero and
-  // metadata[ 0 ] will be the empty placeholder.
-  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
-    return NULL;
+  // Allocate a header if necessary, freeing it again in the case of allocation failure (see cc_omap_build).
+  void *placeholder = NULL;
+  if( cc_omap_is_placeholder( cntr ) )
+  {
+    void *new_cntr = cc_omap_alloc_hdr( cntr, NULL, realloc_ );
+    if( CC_UNLIKELY( !new_cntr ) )
+      return cc_make_allocing_fn_result( cntr, NULL );
 
-  // Traverse the chain of key-element pairs belonging to the home bucket.
-  uint16_t hashfrag = cc_hash_frag( key_hash );
-  size_t bucket = home_bucket;
-  while( true )
+    placeholder = cntr;
+    cntr = new_cntr;
+  }
+
+  cc_omapnode_hdr_ty *subtree;
+  size_t subtree_size = cc_omap_hdr( src )->size;
+
+  if( cc_omap_can_move_nodes( cntr, src ) )
   {
-    if(
-      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
-      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
-    )
-      return cc_map_el( cntr, bucket, el_size, layout );
+    subtree = cc_omap_hdr( src )->root;
+  }
+  else
+  {
+    subtree = cc_omap_copy_subtree(
+      cntr,
+      src,
+      cc_omap_first_or_last( src, true ),
+      subtree_size,
+      el_size,
+      layout,
+      realloc_,
+      free_
+    );
+    if( CC_UNLIKELY( !subtree ) )
+    {
+      if( placeholder )
+      {
+        cc_allocator_free( NULL, free_, cntr );
+        cntr = placeholder;
+      }
 
-    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
-    if( displacement == CC_MAP_DISPLACEMENT_MASK )
-      return NULL;
+      return cc_make_allocing_fn_result( cntr, NULL );
+    }
 
-    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
+    // The key-element pairs now belong to the ordered map, so no destructors are called.
+    cc_omap_destroy_subtree( src, cc_omap_hdr( src )->root, el_size, layout, NULL, NULL, true, free_ );
   }
-}
 
-// DEPRECATED.
-// For maps, the container handle doubles up as r_end.
-static inline void *cc_map_r_end( void *cntr )
-{
-  return cntr;
+  cc_omap_hdr( src )->root = cc_omap_hdr( src )->sentinel;
+  cc_omap_hdr( src )->size = 0;
+
+  cc_omap_graft( cntr, subtree, subtree_size, el_size, layout, cmpr, el_dtor, key_dtor, free_ );
+  return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
 }
 
-static inline void *cc_map_end(
+// Erases all key-element pairs, calling the destructors for the key and element types if necessary.
+// If CC_POOL_NODES is defined, the nodes are not freed individually but rather returned to the pool en masse, so the
+// tree need only be traversed if there are destructors to call.
+// The same applies if the ordered map's allocator does not free memory piece by piece.
+static inline void cc_omap_clear(
   void *cntr,
   size_t el_size,
-  uint64_t layout
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_map_el( cntr, cc_map_cap( cntr ), el_size, layout );
-}
+#ifdef CC_POOL_NODES
+  if( cc_omap_is_placeholder( cntr ) )
+    return;
 
-// Finds the first occupied bucket at or after the bucket pointed to by itr.
-// This function scans four buckets at a time, ideally using intrinsics.
-static inline void *cc_map_leap_forward( void *cntr, void *itr, size_t el_size, uint64_t layout )
-{
-  uint16_t *itr_metadatum = cc_map_hdr( cntr )->metadata + cc_map_bucket_index_from_itr( cntr, itr, el_size, layout );
+  cc_pool_reset( &cc_omap_hdr( cntr )->pool );
+  bool must_free_nodes = false;
+#else
+  bool must_free_nodes = cc_allocator_frees( cc_omap_hdr( cntr )->allocator ); // Also handles placeholder.
+#endif
 
-  while( true )
+  if( !el_dtor && !key_dtor && !must_free_nodes )
   {
-    uint64_t metadata;
-    memcpy( &metadata, itr_metadatum, sizeof( uint64_t ) );
-    if( metadata )
-      return (char *)itr + CC_BUCKET_SIZE( el_size, layout ) * cc_first_nonzero_uint16( metadata );
-
-    itr = (char *)itr + CC_BUCKET_SIZE( el_size, layout ) * 4;
-    itr_metadatum += 4;
+    cc_omap_hdr( cntr )->size = 0;
+    cc_omap_hdr( cntr )->root = cc_omap_hdr( cntr )->sentinel;
+    return;
   }
-}
 
-// DEPRECATED.
-// Finds the first occupied bucket before the bucket pointed to by itr.
-// This function also scans four buckets at a time, ideally using intrinsics.
-// However, because the r_end pointer-iterator, unlike end, constitutes a special case, this function is less efficient
-// cc_map_leap_forward.
-static inline void *cc_map_leap_backward( void *cntr, void *itr, size_t el_size, uint64_t layout )
-{
-  size_t bucket = cc_map_bucket_index_from_itr( cntr, itr, el_size, layout );
+  cc_omap_destroy_subtree(
+    cntr,
+    cc_omap_hdr( cntr )->root,
+    el_size,
+    layout,
+    el_dtor,
+    key_dtor,
+    must_free_nodes,
+    free_
+  );
 
-  while( true )
+  if( !cc_omap_is_placeholder( cntr ) )
   {
-    if( bucket < 4 )
-    {
-      while( bucket-- )
-        if( cc_map_hdr( cntr )->metadata[ bucket ] )
-          return cc_map_el( cntr, bucket, el_size, layout );
-
-      return cc_map_r_end( cntr );
-    }
-
-    // This check is only necessary to silence a superfluous array-bounds warning under GCC.
-    // In practice, the case of a placeholder map is caught by the above check for bucket < 4.
-    if( cc_map_hdr( cntr )->metadata == &cc_map_placeholder_metadatum )
-      CC_UNREACHABLE;
-
-    uint64_t metadatum;
-    memcpy( &metadatum, cc_map_hdr( cntr )->metadata + bucket - 4, sizeof( uint64_t ) );
-    if( metadatum )
-      return cc_map_el( cntr, bucket - 1 - cc_last_nonzero_uint16( metadatum ), el_size, layout );
-
-    bucket -= 4;
+    cc_omap_hdr( cntr )->size = 0;
+    cc_omap_hdr( cntr )->root = cc_omap_hdr( cntr )->sentinel;
   }
 }
 
-static inline void *cc_map_first(
+// Erases all key-element pairs, calling their destructors if necessary, and frees the memory for the ordered map's
+// header if it is not a placeholder.
+static inline void cc_omap_cleanup(
   void *cntr,
   size_t el_size,
-  uint64_t layout
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
 )
 {
-  void *itr = cc_map_el( cntr, 0, el_size, layout );
+  cc_omap_clear( cntr, el_size, layout, el_dtor, key_dtor, free_ );
 
-  if( !cc_map_hdr( cntr )->cap_mask )
-    return itr;
+  if( !cc_omap_is_placeholder( cntr ) )
+  {
+#ifdef CC_POOL_NODES
+    cc_pool_cleanup( &cc_omap_hdr( cntr )->pool, cc_omap_hdr( cntr )->allocator, free_ );
+#endif
+    cc_allocator_free( cc_omap_hdr( cntr )->allocator, free_, cntr );
+  }
+}
 
-  return cc_map_leap_forward( cntr, itr, el_size, layout );
+#ifdef CC_STATS
+
+// Returns the number of nodes on the longest path from the specified node to a leaf.
+// As the tree is balanced, the depth of the recursion is logarithmic in the number of nodes.
+static inline size_t cc_omap_subtree_height( cc_omapnode_hdr_ty *node, cc_omapnode_hdr_ty *sentinel )
+{
+  if( node == sentinel )
+    return 0;
+
+  size_t left_height = cc_omap_subtree_height( node->children[ 0 ], sentinel );
+  size_t right_height = cc_omap_subtree_height( node->children[ 1 ], sentinel );
+  return 1 + ( left_height > right_height ? left_height : right_height );
 }
 
-// DEPRECATED.
-static inline void *cc_map_last(
-  void *cntr,
-  size_t el_size,
-  uint64_t layout
-)
+static inline void cc_omap_get_stats( void *cntr, cc_stats *stats )
 {
-  return cc_map_leap_backward( cntr, cc_map_end( cntr, el_size, layout ), el_size, layout );
+  memset( stats, 0, sizeof( cc_stats ) );
+  stats->size = cc_omap_size( cntr );
+  stats->height = cc_omap_subtree_height( cc_omap_hdr( cntr )->root, cc_omap_hdr( cntr )->sentinel );
 }
 
-// DEPRECATED.
-static inline void *cc_map_prev(
-  void *cntr,
-  void *itr,
-  size_t el_size,
-  uint64_t layout
-)
+#endif
+
+// If CC_POOL_NODES is defined, the allocated memory includes free nodes and the uncarved remainders of slabs.
+static inline cc_mem_usage cc_omap_memory_usage( void *cntr, size_t el_size, uint64_t layout )
 {
-  return cc_map_leap_backward( cntr, itr, el_size, layout );
+  if( cc_omap_is_placeholder( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+#ifdef CC_POOL_NODES
+  size_t nodes_size = cc_pool_allocated( &cc_omap_hdr( cntr )->pool, CC_OMAPNODE_SIZE( el_size, layout ) );
+#else
+  size_t nodes_size = CC_OMAPNODE_SIZE( el_size, layout ) * cc_omap_size( cntr );
+#endif
+
+  return cc_make_mem_usage(
+    sizeof( cc_omap_hdr_ty ) + nodes_size,
+    ( el_size + CC_KEY_SIZE( layout ) ) * cc_omap_size( cntr )
+  );
 }
 
-static inline void *cc_map_next(
-  void *cntr,
-  void *itr,
-  size_t el_size,
-  uint64_t layout
+// Initializes an ordered map that allocates its memory via the specified allocator.
+// The ordered map's header is allocated immediately so that it can store the pointer to the allocator.
+// Returns a pointer to the new ordered map, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_omap_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  itr = (char *)itr + CC_BUCKET_SIZE( el_size, layout );
-  return cc_map_leap_forward( cntr, itr, el_size, layout );
+  return cc_omap_alloc_hdr( (void *)&cc_omap_placeholder, allocator, NULL /* Unused */ );
 }
 
-// Erases the key-element pair in the specified bucket.
-// The erasure always occurs at the end of the chain to which the key-element pair belongs.
-// If the key-element pair to be erased is not the last in the chain, it is swapped with the last so that erasure occurs
-// at the end.
-// This helps keep a chain's key-element pairs close to their home bucket for the sake of cache locality.
-// Returns true if, in the case of iteration from first to end, cc_map_next should now be called on the pointer-iterator
-// to find the next key-element pair.
-// This return value is necessary because at the iterator location, the erasure could result in an empty bucket, a
-// bucket containing a moved key-element pair already visited during the iteration, or a bucket containing a moved
-// key-element pair not yet visited.
-static inline bool cc_map_erase_raw(
-  void *cntr,
-  size_t erase_bucket,
-  size_t home_bucket, // SIZE_MAX if unknown.
+// Initializes a shallow copy of the source ordered map.
+// The copy uses the same allocator as the source ordered map.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_omap_init_clone(
+  void *src,
   size_t el_size,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
 )
 {
-  --cc_map_hdr( cntr )->size;
+  if( cc_omap_size( src ) == 0 && !cc_omap_hdr( src )->allocator ) // Also handles placeholder.
+    return (void *)&cc_omap_placeholder;
 
-  // Case 1: The key-element pair is the only one in its chain, so just remove it.
-  if(
-    cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK &&
-    ( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK
-  )
-  {
-    if( el_dtor )
-      el_dtor( cc_map_el( cntr, erase_bucket, el_size, layout ) );
-    if( key_dtor )
-      key_dtor( cc_map_key( cntr, erase_bucket, el_size, layout ) );
+  // Create a header.
 
-    cc_map_hdr( cntr )->metadata[ erase_bucket ] = CC_MAP_EMPTY;
-    return true;
-  }
+  cc_omap_hdr_ty *new_cntr = (cc_omap_hdr_ty *)cc_omap_alloc_hdr(
+    (void *)&cc_omap_placeholder,
+    cc_omap_hdr( src )->allocator,
+    realloc_
+  );
+  if( CC_UNLIKELY( !new_cntr ) )
+    return NULL;
 
-  // Case 2 and 3 require that we know the key-element pair's home bucket.
-  if( home_bucket == SIZE_MAX )
+  if( cc_omap_size( src ) == 0 )
+    return new_cntr;
+
+  // Clone the root node.
+
+  new_cntr->root = cc_omap_alloc_node( new_cntr, el_size, layout, realloc_ );
+  if( CC_UNLIKELY( !new_cntr->root ) )
   {
-    if( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK )
-      home_bucket = erase_bucket;
-    else
-      home_bucket = hash( cc_map_key( cntr, erase_bucket, el_size, layout ) ) & cc_map_hdr( cntr )->cap_mask;
+    cc_allocator_free( new_cntr->allocator, free_, new_cntr );
+    return NULL;
   }
 
-  if( el_dtor )
-    el_dtor( cc_map_el( cntr, erase_bucket, el_size, layout ) );
-  if( key_dtor )
-    key_dtor( cc_map_key( cntr, erase_bucket, el_size, layout ) );
+  cc_omapnode_set_parent_and_color( new_cntr->root, cc_omap_hdr( new_cntr )->sentinel, false );
+  new_cntr->root->children[ 0 ] = cc_omap_hdr( new_cntr )->sentinel;
+  new_cntr->root->children[ 1 ] = cc_omap_hdr( new_cntr )->sentinel;
+#ifdef CC_ORDER_STATISTICS
+  new_cntr->root->count = cc_omap_hdr( src )->root->count;
+#endif
+  memcpy(
+    cc_omap_el( new_cntr->root ),
+    cc_omap_el( cc_omap_hdr( src )->root ),
+    CC_KEY_OFFSET( el_size, layout ) + CC_KEY_SIZE( layout )
+  );
 
-  // Case 2: The key-element pair is the last in a chain containing multiple key-element pairs.
-  // Traverse the chain from the beginning and find the penultimate key-element pair.
-  // Then disconnect the key-element pair and erase.
-  if( ( cc_map_hdr( cntr )->metadata[ erase_bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK )
+  // Clone every non-root node iteratively.
+
+  cc_omapnode_hdr_ty *src_node = cc_omap_hdr( src )->root;
+  cc_omapnode_hdr_ty *new_node = new_cntr->root;
+
+  while( src_node != cc_omap_hdr( src )->sentinel )
   {
-    size_t bucket = home_bucket;
-    while( true )
+    int dir;
+    for( dir = 0; dir < 2; ++dir )
+      if(
+        src_node->children[ dir ] != cc_omap_hdr( src )->sentinel &&
+        new_node->children[ dir ] == new_cntr->sentinel
+      )
+        break;
+
+    if( dir == 2 )
     {
-      uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
-      size_t next = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
-      if( next == erase_bucket )
-      {
-        cc_map_hdr( cntr )->metadata[ bucket ] |= CC_MAP_DISPLACEMENT_MASK;
-        cc_map_hdr( cntr )->metadata[ erase_bucket ] = CC_MAP_EMPTY;
-        return true;
-      }
+      src_node = cc_omapnode_parent( src_node );
+      new_node = cc_omapnode_parent( new_node );
+      continue;
+    }
 
-      bucket = next;
+    new_node->children[ dir ] = cc_omap_alloc_node( new_cntr, el_size, layout, realloc_ );
+    if( !new_node->children[ dir ] )
+    {
+      // Free the partially formed clone tree without calling destructors.
+      new_node->children[ dir ] = new_cntr->sentinel;
+      cc_omap_cleanup( new_cntr, el_size, layout, NULL /* No destructor */, NULL /* No destructor */, free_ );
+      return NULL;
     }
-  }
 
-  // Case 3: The chain has multiple key-element pairs, and the key-element pair is not the last one.
-  // Traverse the chain from the key-element pair to be erased and find the last and penultimate key-element pairs.
-  // Disconnect the last key-element pair from the chain, and swap it with the key-element pair to erase.
-  size_t bucket = erase_bucket;
-  while( true )
-  {
-    size_t prev = bucket;
-    bucket = ( home_bucket + cc_quadratic( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK ) ) &
-      cc_map_hdr( cntr )->cap_mask;
+    cc_omapnode_set_parent_and_color(
+      new_node->children[ dir ],
+      new_node,
+      cc_omapnode_is_red( src_node->children[ dir ] )
+    );
+    new_node->children[ dir ]->children[ 0 ] = new_cntr->sentinel;
+    new_node->children[ dir ]->children[ 1 ] = new_cntr->sentinel;
+#ifdef CC_ORDER_STATISTICS
+    new_node->children[ dir ]->count = src_node->children[ dir ]->count;
+#endif
 
-    if( ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK ) == CC_MAP_DISPLACEMENT_MASK )
-    {
-      memcpy(
-        cc_map_el( cntr, erase_bucket, el_size, layout ),
-        cc_map_el( cntr, bucket, el_size, layout ),
-        CC_BUCKET_SIZE( el_size, layout )
-      );
+    memcpy(
+      cc_omap_el( new_node->children[ dir ] ),
+      cc_omap_el( src_node->children[ dir ] ),
+      CC_KEY_OFFSET( el_size, layout ) + CC_KEY_SIZE( layout )
+    );
+
+    src_node = src_node->children[ dir ];
+    new_node = new_node->children[ dir ];
+  }
 
-      cc_map_hdr( cntr )->metadata[ erase_bucket ] = ( cc_map_hdr( cntr )->metadata[ erase_bucket ] &
-        ~CC_MAP_HASH_FRAG_MASK ) | ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK );
+  new_cntr->size = cc_omap_hdr( src )->size;
+  return new_cntr;
+}
 
-      cc_map_hdr( cntr )->metadata[ prev ] |= CC_MAP_DISPLACEMENT_MASK;
-      cc_map_hdr( cntr )->metadata[ bucket ] = CC_MAP_EMPTY;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*                                                    Ordered set                                                     */
+/*--------------------------------------------------------------------------------------------------------------------*/
 
-      // Whether a pointer-iterator pointing to erase_bucket should be advanced depends on whether the key-element pair
-      // moved to the erase_bucket came from before or after that bucket.
-      // In the former case, the iteration would already have hit the moved key-element pair, so the pointer-iterator
-      // should still be advanced.
-      if( bucket > erase_bucket )
-        return false;
+// An ordered set is implemented as an ordered map where the key and element are combined into one space in memory.
+// Hence, it reuses the functions for omap, except:
+// * The key offset inside the bucket is zero.
+//   This is handled at the API-macro level via the cc_layout function and associated macros.
+// * The element size passed into map functions is zero in order to avoid double memcpy-ing.
 
-      return true;
-    }
-  }
+static inline size_t cc_oset_size( void *cntr )
+{
+  return cc_omap_size( cntr );
 }
 
-// Erases the key-element pair pointed to by itr and returns a pointer-iterator to the next key-element pair in the
-// table.
-// This function must be inlined to ensure that the compiler optimizes away the cc_map_next call if the returned
-// pointer-iterator is discarded.
-static inline CC_ALWAYS_INLINE void *cc_map_erase_itr(
+static inline cc_allocing_fn_result_ty cc_oset_insert(
   void *cntr,
-  void *itr,
-  size_t el_size,
+  void *key,
+  bool replace,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  CC_UNUSED( double, max_load ),
   cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
+  cc_realloc_fnptr_ty realloc_,
   CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  size_t bucket = cc_map_bucket_index_from_itr( cntr, itr, el_size, layout );
-
-  if( cc_map_erase_raw( cntr, bucket, SIZE_MAX, el_size, layout, hash, el_dtor, key_dtor ) )
-    return cc_map_next( cntr, itr, el_size, layout );
-
-  return itr;
+  return cc_omap_insert(
+    cntr,
+    cntr,     // Dummy pointer for element as memcpy-ing to a NULL pointer is undefined behavior even when size is zero.
+    key,
+    replace,
+    0,        // Zero element size.
+    layout,
+    NULL,     // Dummy.
+    cmpr,
+    0.0,      // Dummy.
+    el_dtor,
+    NULL,     // Only one destructor.
+    realloc_,
+    NULL      // Dummy.
+  );
 }
 
-// Erases the key-element pair containing the specified key, if it exists.
-// Returns a pointer that evaluates to true if a key-element pair was erased, or else NULL.
-// This pointer is eventually cast to bool by the cc_erase API macro.
-static inline void *cc_map_erase(
+static inline cc_allocing_fn_result_ty cc_oset_insert_sorted_n(
   void *cntr,
-  void *key,
-  size_t el_size,
+  void *els,
+  size_t n,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
   cc_cmpr_fnptr_ty cmpr,
   cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
 )
 {
-  size_t key_hash = hash( key );
-  size_t home_bucket = key_hash & cc_map_hdr( cntr )->cap_mask;
-
-  if( !( cc_map_hdr( cntr )->metadata[ home_bucket ] & CC_MAP_IN_HOME_BUCKET_MASK ) )
-    return NULL;
-
-  uint16_t hashfrag = cc_hash_frag( key_hash );
-  size_t bucket = home_bucket;
-  while( true )
-  {
-    if(
-      ( cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_HASH_FRAG_MASK ) == hashfrag &&
-      CC_LIKELY( cmpr( cc_map_key( cntr, bucket, el_size, layout ), key ) )
-    )
-    {
-      cc_map_erase_raw( cntr, bucket, home_bucket, el_size, layout, hash, el_dtor, key_dtor );
-      return &cc_dummy_true;
-    }
-
-    uint16_t displacement = cc_map_hdr( cntr )->metadata[ bucket ] & CC_MAP_DISPLACEMENT_MASK;
-    if( displacement == CC_MAP_DISPLACEMENT_MASK )
-      return NULL;
-
-    bucket = ( home_bucket + cc_quadratic( displacement ) ) & cc_map_hdr( cntr )->cap_mask;
-  }
+  return cc_omap_insert_sorted_n(
+    cntr,
+    els,
+    els,      // Dummy pointer for elements as memcpy-ing from NULL is undefined behavior even when size is zero.
+    n,
+    0,        // Zero element size.
+    layout,
+    cmpr,
+    el_dtor,
+    NULL,     // Only one destructor.
+    realloc_,
+    free_
+  );
 }
 
-// Shrinks the map's capacity to the minimum possible without violating the max load factor associated with the key
-// type.
-// If shrinking is necessary, then a complete rehash occurs.
-// Returns a cc_allocing_fn_result_ty containing the new container handle and a pointer that evaluates to true if the
-// operation was successful or false in the case of allocation failure.
-static inline cc_allocing_fn_result_ty cc_map_shrink(
+static inline cc_allocing_fn_result_ty cc_oset_insert_n(
   void *cntr,
-  size_t el_size,
+  void *els,
+  size_t n,
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  double max_load,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  CC_UNUSED( double, max_load ),
+  cc_dtor_fnptr_ty el_dtor,
   cc_realloc_fnptr_ty realloc_,
   cc_free_fnptr_ty free_
 )
 {
-  size_t cap = cc_map_min_cap_for_n_els( cc_map_size( cntr ), max_load );
-
-  if( cap == cc_map_cap( cntr ) ) // Shrink unnecessary.
-    return cc_make_allocing_fn_result( cntr, cc_dummy_true_ptr );
-
-  if( cap == 0 ) // Restore placeholder.
-  {
-    if( !cc_map_is_placeholder( cntr ) )
-      free_( cntr );
-
-    return cc_make_allocing_fn_result( (void *)&cc_map_placeholder, cc_dummy_true_ptr );
-  }
-
-  void *new_cntr = cc_map_make_rehash(
+  return cc_omap_insert_n(
     cntr,
-    cap,
-    el_size,
+    els,
+    els,      // Dummy pointer for elements as memcpy-ing from NULL is undefined behavior even when size is zero.
+    n,
+    0,        // Zero element size.
     layout,
-    hash,
+    NULL,     // Dummy.
+    cmpr,
+    0.0,      // Dummy.
+    el_dtor,
+    NULL,     // Only one destructor.
     realloc_,
     free_
   );
-  if( CC_UNLIKELY( !new_cntr ) )
-    return cc_make_allocing_fn_result( cntr, NULL );
-
-  if( !cc_map_is_placeholder( cntr ) )
-    free_( cntr );
-
-  return cc_make_allocing_fn_result( new_cntr, cc_dummy_true_ptr );
 }
 
-// Initializes a shallow copy of the source map.
-// The capacity of the copy is the same as the capacity of the source map, unless the source map is empty, in which case
-// the copy is a placeholder.
-// Hence, this function does no rehashing.
-// Returns a pointer to the copy, or NULL in the case of allocation failure.
-// That return value is cast to bool in the corresponding API macro.
-static inline void *cc_map_init_clone(
-  void *src,
-  size_t el_size,
+static inline void *cc_oset_get(
+  void *cntr,
+  void *key,
+  CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_realloc_fnptr_ty realloc_,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  if( cc_map_size( src ) == 0 ) // Also handles placeholder.
-    return (void *)&cc_map_placeholder;
-
-  size_t buckets_size = CC_BUCKET_SIZE( el_size, layout ) * cc_map_cap( src );
-  size_t metadata_offset = sizeof( cc_map_hdr_ty ) + buckets_size + CC_PADDING( buckets_size, alignof( uint16_t ) );
-  size_t allocation_size = metadata_offset + sizeof( uint16_t ) * ( cc_map_cap( src ) + 4 );
-
-  cc_map_hdr_ty *new_cntr = (cc_map_hdr_ty*)realloc_( NULL, allocation_size );
-  if( CC_UNLIKELY( !new_cntr ) )
-    return NULL;
-
-  memcpy( new_cntr, src, allocation_size );
-  new_cntr->metadata = (uint16_t *)( (char *)new_cntr + metadata_offset );
-
-  return new_cntr;
+  return cc_omap_get( cntr, key, 0 /* Zero element size */, layout, NULL /* Dummy */, cmpr );
 }
 
-// Erases all key-element pairs, calling the destructors for the key and element types if necessary, without changing
-// the map's capacity.
-static inline void cc_map_clear(
+static inline size_t cc_oset_get_n(
   void *cntr,
-  size_t el_size,
+  const void *keys,
+  size_t n,
+  void **itrs,
+  CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  if( cc_map_size( cntr ) == 0 ) // Also handles placeholder.
-    return;
-
-  for( size_t bucket = 0; bucket < cc_map_cap( cntr ); ++bucket )
-    if( cc_map_hdr( cntr )->metadata[ bucket ] )
-    {
-      if( key_dtor )
-        key_dtor( cc_map_key( cntr, bucket, el_size, layout ) );
-
-      if( el_dtor )
-        el_dtor( cc_map_el( cntr, bucket, el_size, layout ) );
-
-      cc_map_hdr( cntr )->metadata[ bucket ] = CC_MAP_EMPTY;
-    }
-
-  cc_map_hdr( cntr )->size = 0;
+  return cc_omap_get_n( cntr, keys, n, itrs, 0 /* Zero element size */, layout, NULL /* Dummy */, cmpr );
 }
 
-// Clears the map and frees its memory if is not a placeholder.
-static inline void cc_map_cleanup(
+static inline void *cc_oset_bounded_first_or_last(
   void *cntr,
-  size_t el_size,
+  void *key,
+  bool dir,
+  CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
-  cc_free_fnptr_ty free_
+  cc_cmpr_fnptr_ty cmpr
 )
 {
-  cc_map_clear( cntr, el_size, layout, key_dtor, el_dtor, NULL /* Dummy */ );
-
-  if( !cc_map_is_placeholder( cntr ) )
-    free_( cntr );
+  return cc_omap_bounded_first_or_last( cntr, key, dir, 0 /* Zero element size */, layout, cmpr );
 }
 
-/*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                        Set                                                         */
-/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void *cc_oset_nth(
+  void *cntr,
+  size_t n,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_omap_nth( cntr, n, 0 /* Zero element size */, layout );
+}
 
-// A set is implemented as a map where the key and element are combined into one space in memory.
-// Hence, it reuses the functions for map, except:
-// * The key offset inside the bucket is zero.
-//   This is handled at the API-macro level via the cc_layout function and associated macros.
-// * The element size passed into map functions is zero in order to avoid double memcpy-ing.
+static inline size_t cc_oset_rank(
+  void *cntr,
+  void *key,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
+{
+  return cc_omap_rank( cntr, key, 0 /* Zero element size */, layout, cmpr );
+}
 
-static inline size_t cc_set_size( void *cntr )
+static inline size_t cc_oset_count_range(
+  void *cntr,
+  void *lo,
+  void *hi,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_cmpr_fnptr_ty cmpr
+)
 {
-  return cc_map_size( cntr );
+  return cc_omap_count_range( cntr, lo, hi, 0 /* Zero element size */, layout, cmpr );
 }
 
-static inline size_t cc_set_cap( void *cntr )
+static inline void *cc_oset_erase_itr(
+  void *cntr,
+  void *itr,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
 {
-  return cc_map_cap( cntr );
+  return cc_omap_erase_itr(
+    cntr,
+    itr,
+    0,       // Zero element size.
+    layout,
+    NULL,    // Dummy.
+    el_dtor,
+    NULL,    // Only one destructor.
+    free_
+  );
 }
 
-static inline cc_allocing_fn_result_ty cc_set_reserve(
+static inline void *cc_oset_erase(
   void *cntr,
-  size_t n,
+  void *key,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  double max_load,
-  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
   cc_free_fnptr_ty free_
 )
 {
-  return cc_map_reserve( cntr, n, 0 /* Zero element size */, layout, hash, max_load, realloc_, free_ );
+  return cc_omap_erase(
+    cntr,
+    key,
+    0,       // Zero element size.
+    layout,
+    NULL,    // Dummy.
+    cmpr,
+    el_dtor,
+    NULL,    // Only one destructor.
+    free_
+  );
 }
 
-static inline cc_allocing_fn_result_ty cc_set_insert(
+static inline size_t cc_oset_erase_n(
   void *cntr,
-  void *key,
-  bool replace,
+  const void *keys,
+  size_t n,
+  CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
+  CC_UNUSED( cc_hash_fnptr_ty, hash ),
   cc_cmpr_fnptr_ty cmpr,
-  double max_load,
   cc_dtor_fnptr_ty el_dtor,
-  cc_realloc_fnptr_ty realloc_,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
   cc_free_fnptr_ty free_
 )
 {
-  return cc_map_insert(
+  return cc_omap_erase_n(
     cntr,
-    cntr,     // Dummy pointer for element as memcpy-ing to a NULL pointer is undefined behavior even when size is zero.
-    key,
-    replace,
-    0,        // Zero element size.
+    keys,
+    n,
+    0,       // Zero element size.
     layout,
-    hash,
+    NULL,    // Dummy.
     cmpr,
-    max_load,
     el_dtor,
-    NULL,     // Only one destructor.
-    realloc_,
+    NULL,    // Only one destructor.
     free_
   );
 }
 
-static inline void *cc_set_get(
+static inline size_t cc_oset_filter(
   void *cntr,
-  void *key,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  cc_cmpr_fnptr_ty cmpr
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_map_get( cntr, key, 0 /* Zero element size */, layout, hash, cmpr );
+  return cc_omap_filter(
+    cntr,
+    pred,
+    ctx,
+    keep_if,
+    0,       // Zero element size.
+    layout,
+    el_dtor,
+    NULL,    // Only one destructor.
+    free_
+  );
 }
 
-static inline void *cc_set_erase_itr(
+static inline void *cc_oset_erase_range(
   void *cntr,
-  void *itr,
+  void *itr_first,
+  void *itr_end,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
   cc_dtor_fnptr_ty el_dtor,
   CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_map_erase_itr(
+  return cc_omap_erase_range(
     cntr,
-    itr,
+    itr_first,
+    itr_end,
     0,       // Zero element size.
     layout,
-    hash,
     el_dtor,
     NULL,    // Only one destructor.
-    NULL     // Dummy.
+    free_
   );
 }
 
-static inline void *cc_set_erase(
+static inline cc_allocing_fn_result_ty cc_oset_split_at(
   void *cntr,
   void *key,
+  void *dst,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
   cc_cmpr_fnptr_ty cmpr,
   cc_dtor_fnptr_ty el_dtor,
   CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_realloc_fnptr_ty realloc_,
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_map_erase(
+  return cc_omap_split_at(
     cntr,
     key,
+    dst,
     0,       // Zero element size.
     layout,
-    hash,
     cmpr,
     el_dtor,
     NULL,    // Only one destructor.
-    NULL     // Dummy.
+    realloc_,
+    free_
   );
 }
 
-static inline cc_allocing_fn_result_ty cc_set_shrink(
+static inline cc_allocing_fn_result_ty cc_oset_join(
   void *cntr,
+  void *src,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
-  cc_hash_fnptr_ty hash,
-  double max_load,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
   cc_realloc_fnptr_ty realloc_,
   cc_free_fnptr_ty free_
 )
 {
-  return cc_map_shrink( cntr, 0 /* Zero element size */, layout, hash, max_load, realloc_, free_ );
+  return cc_omap_join(
+    cntr,
+    src,
+    0,       // Zero element size.
+    layout,
+    cmpr,
+    el_dtor,
+    NULL,    // Only one destructor.
+    realloc_,
+    free_
+  );
 }
 
-static inline void *cc_set_init_clone(
+static inline void *cc_oset_init_clone(
   void *src,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
   cc_realloc_fnptr_ty realloc_,
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_free_fnptr_ty free_
 )
 {
-  return cc_map_init_clone( src, 0 /* Zero element size */, layout, realloc_, NULL /* Dummy */ );
+  return cc_omap_init_clone( src, 0 /* Zero element size */, layout, realloc_, free_ );
 }
 
-static inline void cc_set_clear(
+static inline void *cc_oset_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_omap_init_with_allocator( allocator, 0 /* Zero element size */, layout );
+}
+
+static inline void cc_oset_clear(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
   cc_dtor_fnptr_ty el_dtor,
   CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
-  CC_UNUSED( cc_free_fnptr_ty, free_ )
+  cc_free_fnptr_ty free_
 )
 {
-  cc_map_clear( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, NULL /* Dummy */ );
+  cc_omap_clear( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
 }
 
-static inline void cc_set_cleanup(
+static inline void cc_oset_cleanup(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
@@ -3580,363 +12877,910 @@ static inline void cc_set_cleanup(
   cc_free_fnptr_ty free_
 )
 {
-  cc_map_cleanup( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
+  cc_omap_cleanup( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
 }
 
-// DEPRECATED.
-static inline void *cc_set_r_end( void *cntr )
+#ifdef CC_STATS
+
+static inline void cc_oset_get_stats( void *cntr, cc_stats *stats )
 {
-  return cc_map_r_end( cntr );
+  cc_omap_get_stats( cntr, stats );
 }
 
-static inline void *cc_set_end(
+#endif
+
+static inline cc_mem_usage cc_oset_memory_usage( void *cntr, CC_UNUSED( size_t, el_size ), uint64_t layout )
+{
+  return cc_omap_memory_usage( cntr, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_oset_r_end( void *cntr )
+{
+  return cc_omap_r_end( cntr );
+}
+
+static inline void *cc_oset_end(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
-  uint64_t layout
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_map_end( cntr, 0 /* Zero element size */, layout );
+  return cc_omap_end( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
-static inline void *cc_set_first(
+static inline void *cc_oset_first(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
-  uint64_t layout
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_map_first( cntr, 0 /* Zero element size */, layout );
+  return cc_omap_first( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
-// DEPRECATED.
-static inline void *cc_set_last(
+static inline void *cc_oset_last(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
-  uint64_t layout
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_map_last( cntr, 0 /* Zero element size */, layout );
+  return cc_omap_last( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
-// DEPRECATED.
-static inline void *cc_set_prev(
+static inline void *cc_oset_prev(
   void *cntr,
   void *itr,
   CC_UNUSED( size_t, el_size ),
-  uint64_t layout
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_map_prev( cntr, itr, 0 /* Zero element size */, layout );
+  return cc_omap_prev( cntr, itr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
-static inline void *cc_set_next(
+static inline void *cc_oset_next(
   void *cntr,
   void *itr,
   CC_UNUSED( size_t, el_size ),
-  uint64_t layout
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_map_next( cntr, itr, 0 /* Zero element size */, layout );
+  return cc_omap_next( cntr, itr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                    Ordered map                                                     */
+/*                                                    B-tree map                                                      */
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-// cc_omap is implemented as a red-black tree. The implementation is partially based on Thomas Niemann's canonical
-// public-domain implementation, which is available at https://www.darkridge.com/~jpr5/mirror/alg/node21.html and has
-// been incorporated into PostgreSQL. However, it differs from Niemann's in several important ways:
+// cc_bmap is an ordered map implemented as a B-tree whose nodes are sized to span a few cache lines.
+// Whereas a lookup in a red-black tree incurs a likely cache miss at every level of a tree of height ~2 * log2( n ), a
+// lookup in a B-tree incurs a few cache misses at each level of a tree of height ~log_b( n ), where the fan-out b is
+// typically between ten and several dozen.
+// In exchange, insertions and erasures shift key-element pairs within nodes and move them between nodes, so they
+// invalidate pointer-iterators.
 //
-// * It uses an array of two child pointers, rather than separate left and right child pointers. This allows us to
-//   eliminate much repetitive code, especially in the post-insert and post-erase fix-up functions.
-// * Niemann's implementation of erasure may write to the sentinel node's parent pointer. Consequently, in
-//   multi-threaded applications, either the sentinel must be declared as a thread-local variable or a separate sentinel
-//   must be embedded into every tree, padding out the header struct. Instead, we use a global sentinel node per
-//   translation unit. This choice requires, in particular, significant changes to the erase and post-erase fix-up
-//   functions.
-// * Niemann's implementation of erasure may also overwrite the key stored by the target node with the key stored by its
-//   in-order successor and delete the latter node. This invalidates any external pointers to the in-order successor.
-//   Instead, we supplant the in-order successor into the position of the node targeted for erasure.
+// The implementation is a classic B-tree: every node, not just every leaf, stores key-element pairs, and the pairs in
+// internal nodes separate the subtrees of their children.
+// Each node consists of a header, an array of keys, an array of elements, and, in internal nodes only, an array of
+// child pointers:
+//   +--------+------------+----+------------+----+-----------------+
+//   |   #1   |     #2     | #3 |     #4     | #5 |       #6        |
+//   +--------+------------+----+------------+----+-----------------+
+//   #1 Node header.
+//   #2 Keys.
+//   #3 Padding to el_ty alignment.
+//   #4 Elements.
+//   #5 Padding to pointer alignment (internal nodes only).
+//   #6 Child pointers (internal nodes only).
+// Storing the keys contiguously allows a search inside a node to scan only the keys, and for keys of fundamental
+// integer types with the default comparison function, the scan is branch-free and, for int under CC_SIMD, vectorized.
+//
+// All nodes have the same size, CC_BMAP_NODE_SIZE (doubled as necessary for large types), and are carved from slabs
+// such that every node is aligned to its size.
+// Hence, the node containing a pointer-iterator can be found by masking the pointer-iterator's address, and the index
+// of the key-element pair follows from the pointer-iterator's offset from the start of the relevant array.
+// This allows pointer-iterators to be plain pointers to elements, as for the other containers.
+// Nodes freed by erasures are kept in a free list for reuse, and the slabs are only freed when the map is cleared or
+// cleaned up.
+//
+// The layout data for a B-tree map is a uint64_t composed of a uint32_t denoting the key size, a uint16_t denoting the
+// key alignment minus one, and a uint16_t denoting the element alignment minus one (see cc_layout).
+// The geometry of the nodes is derived from the element size and layout data by cc_bmap_geometry, which the compiler
+// should optimize into compile-time constants.
+
+#define CC_BMAP_NODE_SIZE     256 // Four 64-byte cache lines.
+#define CC_BMAP_MIN_NODE_CAP  6   // Minimum number of key-element pairs that an internal node can hold.
+#define CC_BMAP_MAX_SLAB_NODES 64 // The number of nodes per slab doubles, starting from one, up to this limit.
+
+// Above this number of keys, a search inside a node over keys of a fundamental integer type first narrows the range via
+// binary search.
+#define CC_BMAP_LINEAR_SEARCH_LIMIT 16
 
 // Node header.
-typedef struct cc_omapnode_hdr_ty
+typedef struct cc_bmapnode_hdr_ty
 {
-  alignas( cc_max_align_ty )
-  bool is_red;
-  struct cc_omapnode_hdr_ty *parent;
-  struct cc_omapnode_hdr_ty *children[ 2 ];
-} cc_omapnode_hdr_ty;
+  struct cc_bmapnode_hdr_ty *parent; // If the node is free, the next node in the free list.
+  uint16_t count;                    // Number of key-element pairs.
+  uint16_t position;                 // Index of the node in its parent's array of child pointers.
+  bool is_leaf;
+} cc_bmapnode_hdr_ty;
+
+// Slab header.
+// The nodes, aligned to the node size, follow the header.
+typedef struct cc_bmap_slab_hdr_ty
+{
+  struct cc_bmap_slab_hdr_ty *prev;
+  size_t node_count;
+} cc_bmap_slab_hdr_ty;
 
-// Ordered map header.
+// B-tree map header.
+// Its alignment ensures that the end pointer-iterator, which points to the end of the header, is suitably aligned for
+// any element type.
 typedef struct
 {
-  size_t size; // SIZE_MAX, combined with a NULL root, indicates a placeholder.
-  cc_omapnode_hdr_ty *root;
-  cc_omapnode_hdr_ty *sentinel;
-} cc_omap_hdr_ty;
-
-// Global sentinel node.
-// The beginning and end of the sentinel also serve as r_end and end, respectively.
-static const cc_omapnode_hdr_ty cc_omap_sentinel = { false, NULL, { NULL, NULL } };
+  alignas( cc_max_align_ty )
+  size_t size; // SIZE_MAX indicates a placeholder.
+  cc_bmapnode_hdr_ty *root; // NULL if the map is empty.
+  cc_allocator *allocator;
+  cc_bmapnode_hdr_ty *free_nodes;
+  size_t free_node_count;
+  cc_bmap_slab_hdr_ty *slabs;
+  size_t next_slab_node_count;
+#ifdef CC_STATS
+  size_t height;
+#endif
+} cc_bmap_hdr_ty;
 
-// Global placeholder for an ordered map with no allocated header.
-// This placeholder allows us to avoid checking for a NULL container handle inside functions.
-static const cc_omap_hdr_ty cc_omap_placeholder = {
+// Global placeholder for a B-tree map with no allocated header.
+static const cc_bmap_hdr_ty cc_bmap_placeholder = {
   SIZE_MAX,
-  (cc_omapnode_hdr_ty *)&cc_omap_sentinel,
-  (cc_omapnode_hdr_ty *)&cc_omap_sentinel
+  NULL,
+  NULL,
+  NULL,
+  0,
+  NULL,
+  1
+#ifdef CC_STATS
+  ,
+  0
+#endif
 };
 
-// Easy access to the ordered map header.
-static inline cc_omap_hdr_ty *cc_omap_hdr( void *cntr )
+// Node geometry.
+// Each node has room for one key-element pair (and one child pointer) more than its capacity so that an insertion can
+// temporarily overfill a node before splitting it (see cc_bmap_insert_at).
+typedef struct
 {
-  return (cc_omap_hdr_ty *)cntr;
+  size_t node_size;
+  size_t key_size;
+  size_t key_offset;
+  size_t leaf_cap;
+  size_t leaf_el_offset;
+  size_t inner_cap;
+  size_t inner_el_offset;
+  size_t children_offset;
+} cc_bmap_geometry_ty;
+
+#define CC_BMAP_KEY_ALIGN( layout ) ( (size_t)(uint16_t)( layout >> 32 ) + 1 )
+
+#define CC_BMAP_EL_ALIGN( layout ) ( (size_t)(uint16_t)( layout >> 48 ) + 1 )
+
+// This function must be inlined in order for the geometry calculations to be optimized into compile-time constants.
+static inline CC_ALWAYS_INLINE cc_bmap_geometry_ty cc_bmap_geometry( size_t el_size, uint64_t layout )
+{
+  cc_bmap_geometry_ty geo;
+  size_t el_align = CC_BMAP_EL_ALIGN( layout );
+  size_t pair_size;
+  size_t overhead;
+  size_t leaf_slots;
+  size_t inner_slots;
+
+  geo.key_size = CC_KEY_SIZE( layout );
+  geo.key_offset = sizeof( cc_bmapnode_hdr_ty ) +
+                   CC_PADDING( sizeof( cc_bmapnode_hdr_ty ), CC_BMAP_KEY_ALIGN( layout ) );
+  pair_size = geo.key_size + el_size;
+
+  // The padding before the elements and child pointers is counted at its maximum so that it need not be calculated
+  // until the number of slots is known.
+  overhead = geo.key_offset + ( el_align - 1 ) + ( alignof( cc_bmapnode_hdr_ty * ) - 1 ) +
+    sizeof( cc_bmapnode_hdr_ty * );
+
+  geo.node_size = CC_BMAP_NODE_SIZE;
+  while(
+    geo.node_size < overhead ||
+    geo.node_size < el_align ||
+    ( geo.node_size - overhead ) / ( pair_size + sizeof( cc_bmapnode_hdr_ty * ) ) <= CC_BMAP_MIN_NODE_CAP
+  )
+    geo.node_size *= 2;
+
+  leaf_slots = ( geo.node_size - geo.key_offset - ( el_align - 1 ) ) / pair_size;
+  inner_slots = ( geo.node_size - overhead ) / ( pair_size + sizeof( cc_bmapnode_hdr_ty * ) );
+  if( leaf_slots > UINT16_MAX )
+    leaf_slots = UINT16_MAX;
+
+  geo.leaf_cap = leaf_slots - 1;
+  geo.leaf_el_offset = geo.key_offset + leaf_slots * geo.key_size;
+  geo.leaf_el_offset += CC_PADDING( geo.leaf_el_offset, el_align );
+
+  geo.inner_cap = inner_slots - 1;
+  geo.inner_el_offset = geo.key_offset + inner_slots * geo.key_size;
+  geo.inner_el_offset += CC_PADDING( geo.inner_el_offset, el_align );
+  geo.children_offset = geo.inner_el_offset + inner_slots * el_size;
+  geo.children_offset += CC_PADDING( geo.children_offset, alignof( cc_bmapnode_hdr_ty * ) );
+
+  return geo;
 }
 
-// Easy access to an ordered map node header from a pointer-iterator.
-static inline cc_omapnode_hdr_ty *cc_omapnode_hdr( void *itr )
+// Easy access to the B-tree map header.
+static inline cc_bmap_hdr_ty *cc_bmap_hdr( void *cntr )
 {
-  return (cc_omapnode_hdr_ty *)( (char *)itr - sizeof( cc_omapnode_hdr_ty ) );
+  return (cc_bmap_hdr_ty *)cntr;
 }
 
-static inline bool cc_omap_is_placeholder( void *cntr )
+static inline bool cc_bmap_is_placeholder( void *cntr )
 {
-  if( cc_omap_hdr( cntr )->size == SIZE_MAX && cc_omap_hdr( cntr )->root == cc_omap_hdr( cntr )->sentinel )
-    return true;
+  return cc_bmap_hdr( cntr )->size == SIZE_MAX;
+}
+
+// Easy access to the key at index i of a node.
+static inline void *cc_bmap_node_key(
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  return (char *)node + geo->key_offset + i * geo->key_size;
+}
+
+// Easy access to the element at index i of a node.
+static inline void *cc_bmap_node_el(
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  return (char *)node + ( node->is_leaf ? geo->leaf_el_offset : geo->inner_el_offset ) + i * el_size;
+}
+
+// Easy access to the child pointers of an internal node.
+static inline cc_bmapnode_hdr_ty **cc_bmap_children( cc_bmapnode_hdr_ty *node, const cc_bmap_geometry_ty *geo )
+{
+  return (cc_bmapnode_hdr_ty **)( (char *)node + geo->children_offset );
+}
+
+static inline size_t cc_bmap_cap( cc_bmapnode_hdr_ty *node, const cc_bmap_geometry_ty *geo )
+{
+  return node->is_leaf ? geo->leaf_cap : geo->inner_cap;
+}
+
+// Minimum number of key-element pairs in a non-root node.
+static inline size_t cc_bmap_min_count( cc_bmapnode_hdr_ty *node, const cc_bmap_geometry_ty *geo )
+{
+  return ( cc_bmap_cap( node, geo ) - 1 ) / 2;
+}
 
-  return false;
+// A pointer-iterator points to an element or, in the case of a set (i.e. a zero element size), to a key.
+static inline void *cc_bmap_itr(
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  return el_size ? cc_bmap_node_el( node, i, el_size, geo ) : cc_bmap_node_key( node, i, geo );
 }
 
-// Easy access to a pointer-iterator from a pointer to an ordered map node header.
-static inline void *cc_omap_el( void *hdr )
+// Retrieves the node containing the key-element pair pointed to by a pointer-iterator.
+static inline cc_bmapnode_hdr_ty *cc_bmap_itr_node( void *itr, const cc_bmap_geometry_ty *geo )
 {
-  return (char *)hdr + sizeof( cc_omapnode_hdr_ty );
+  return (cc_bmapnode_hdr_ty *)( (char *)itr - ( (uintptr_t)itr & ( geo->node_size - 1 ) ) );
 }
 
-// Easy access to a key from a pointer to an ordered map node header.
-static inline void *cc_omap_key(
-  void *hdr, 
+// Retrieves the index, within its node, of the key-element pair pointed to by a pointer-iterator.
+static inline size_t cc_bmap_itr_index(
+  cc_bmapnode_hdr_ty *node,
+  void *itr,
   size_t el_size,
-  uint64_t layout
+  const cc_bmap_geometry_ty *geo
 )
 {
-  return (char *)hdr + sizeof( cc_omapnode_hdr_ty ) + CC_KEY_OFFSET( el_size, layout );
+  if( el_size )
+    return (size_t)( (char *)itr - (char *)cc_bmap_node_el( node, 0, el_size, geo ) ) / el_size;
+
+  return (size_t)( (char *)itr - (char *)cc_bmap_node_key( node, 0, geo ) ) / geo->key_size;
 }
 
-static inline void *cc_omap_key_for(
+static inline void *cc_bmap_key_for(
+  CC_UNUSED( void *, cntr ),
   void *itr,
   size_t el_size,
   uint64_t layout
 )
 {
-  return (char *)itr + CC_KEY_OFFSET( el_size, layout );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmapnode_hdr_ty *node = cc_bmap_itr_node( itr, &geo );
+  return cc_bmap_node_key( node, cc_bmap_itr_index( node, itr, el_size, &geo ), &geo );
 }
 
-static inline size_t cc_omap_size( void *cntr )
+static inline size_t cc_bmap_size( void *cntr )
 {
   // Special case: If the header is a placeholder, the size member will be SIZE_MAX.
-  if( cc_omap_is_placeholder( cntr ) )
+  if( cc_bmap_is_placeholder( cntr ) )
     return 0;
 
-  return cc_omap_hdr( cntr )->size;
+  return cc_bmap_hdr( cntr )->size;
 }
 
-// An r_end pointer-iterator points to the sentinel.
-// An end pointer-iterator points to the end of the sentinel.
-static inline void *cc_omap_r_end_or_end(
-  void *cntr,
+// Searching inside a node.
+// A search function returns the number of keys in the node that are less than the specified key and sets *found to
+// whether the key at that index equals the specified key.
+// For the fundamental integer types with the default comparison function, dedicated search functions compare the keys
+// directly, without calls to the comparison function.
+// Since the keys are sorted, the number of keys less than the specified key can be counted without branches, which
+// avoids the branch mispredictions inherent in a binary search.
+// The search function is selected, once per API call, by comparing the comparison function pointer against the default
+// three-way comparison functions for those types, which are declared here and defined below the API.
+
+typedef size_t ( *cc_bmap_search_fnptr_ty )( void *, size_t, void *, size_t, cc_cmpr_fnptr_ty, bool * );
+
+static inline size_t cc_bmap_search_generic(
+  void *keys,
+  size_t count,
+  void *key,
+  size_t key_size,
+  cc_cmpr_fnptr_ty cmpr,
+  bool *found
+)
+{
+  size_t low = 0;
+  size_t high = count;
+
+  while( low < high )
+  {
+    size_t mid = low + ( high - low ) / 2;
+    int cmpr_result = cmpr( (char *)keys + mid * key_size, key );
+    if( cmpr_result == 0 )
+    {
+      *found = true;
+      return mid;
+    }
+
+    if( cmpr_result < 0 )
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  *found = false;
+  return low;
+}
+
+#define CC_BMAP_INTEGER_SEARCH_FUNCTION( ty, name )           \
+                                                              \
+static inline int cc_cmpr_##name##_three_way( void *, void * ); \
+                                                              \
+static inline size_t cc_bmap_search_##name(                   \
+  void *keys,                                                 \
+  size_t count,                                               \
+  void *key,                                                  \
+  CC_UNUSED( size_t, key_size ),                              \
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),                        \
+  bool *found                                                 \
+)                                                             \
+{                                                             \
+  ty *range = (ty *)keys;                                     \
+  size_t range_count = count;                                 \
+  size_t rank = 0;                                            \
+  ty target = *(ty *)key;                                     \
+                                                              \
+  while( range_count > CC_BMAP_LINEAR_SEARCH_LIMIT )          \
+  {                                                           \
+    size_t half = range_count / 2;                            \
+    if( range[ half ] < target )                              \
+    {                                                         \
+      range += half + 1;                                      \
+      rank += half + 1;                                       \
+      range_count -= half + 1;                                \
+    }                                                         \
+    else                                                      \
+      range_count = half;                                     \
+  }                                                           \
+                                                              \
+  for( size_t i = 0; i < range_count; ++i )                   \
+    rank += range[ i ] < target;                              \
+                                                              \
+  *found = rank < count && ( (ty *)keys )[ rank ] == target;  \
+  return rank;                                                \
+}                                                             \
+
+CC_BMAP_INTEGER_SEARCH_FUNCTION( char, char )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( unsigned char, unsigned_char )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( signed char, signed_char )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( unsigned short, unsigned_short )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( short, short )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( unsigned int, unsigned_int )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( int, int )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( unsigned long, unsigned_long )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( long, long )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( unsigned long long, unsigned_long_long )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( long long, long_long )
+CC_BMAP_INTEGER_SEARCH_FUNCTION( size_t, size_t )
+
+// Under CC_SIMD, int keys are compared four at a time.
+// Each comparison yields -1 in the lanes whose keys are less than the specified key, so subtracting the comparison
+// results from a vector of counters counts those keys.
+#if defined( CC_SIMD_SSE2 ) || defined( CC_SIMD_NEON )
+
+static inline size_t cc_bmap_search_int_simd(
+  void *keys,
+  size_t count,
+  void *key,
+  CC_UNUSED( size_t, key_size ),
+  CC_UNUSED( cc_cmpr_fnptr_ty, cmpr ),
+  bool *found
+)
+{
+  int *range = (int *)keys;
+  int target = *(int *)key;
+  size_t rank;
+  size_t i = 0;
+
+#if defined( CC_SIMD_SSE2 )
+  __m128i targets = _mm_set1_epi32( target );
+  __m128i counts = _mm_setzero_si128();
+
+  for( ; i + 4 <= count; i += 4 )
+    counts = _mm_sub_epi32( counts, _mm_cmplt_epi32( _mm_loadu_si128( (const __m128i *)( range + i ) ), targets ) );
+
+  counts = _mm_add_epi32( counts, _mm_shuffle_epi32( counts, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+  counts = _mm_add_epi32( counts, _mm_shuffle_epi32( counts, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+  rank = (size_t)_mm_cvtsi128_si32( counts );
+#else
+  int32x4_t targets = vdupq_n_s32( target );
+  uint32x4_t counts = vdupq_n_u32( 0 );
+
+  for( ; i + 4 <= count; i += 4 )
+    counts = vsubq_u32( counts, vcltq_s32( vld1q_s32( range + i ), targets ) );
+
+  uint32x2_t sums = vadd_u32( vget_low_u32( counts ), vget_high_u32( counts ) );
+  rank = vget_lane_u32( vpadd_u32( sums, sums ), 0 );
+#endif
+
+  for( ; i < count; ++i )
+    rank += range[ i ] < target;
+
+  *found = rank < count && range[ rank ] == target;
+  return rank;
+}
+
+#define CC_BMAP_SEARCH_INT cc_bmap_search_int_simd
+
+#else
+
+#define CC_BMAP_SEARCH_INT cc_bmap_search_int
+
+#endif
+
+static inline cc_bmap_search_fnptr_ty cc_bmap_search_fn( cc_cmpr_fnptr_ty cmpr )
+{
+  return
+    cmpr == cc_cmpr_int_three_way                ? CC_BMAP_SEARCH_INT                 :
+    cmpr == cc_cmpr_unsigned_int_three_way       ? cc_bmap_search_unsigned_int       :
+    cmpr == cc_cmpr_size_t_three_way             ? cc_bmap_search_size_t             :
+    cmpr == cc_cmpr_long_long_three_way          ? cc_bmap_search_long_long          :
+    cmpr == cc_cmpr_unsigned_long_long_three_way ? cc_bmap_search_unsigned_long_long :
+    cmpr == cc_cmpr_long_three_way               ? cc_bmap_search_long               :
+    cmpr == cc_cmpr_unsigned_long_three_way      ? cc_bmap_search_unsigned_long      :
+    cmpr == cc_cmpr_short_three_way              ? cc_bmap_search_short              :
+    cmpr == cc_cmpr_unsigned_short_three_way     ? cc_bmap_search_unsigned_short     :
+    cmpr == cc_cmpr_char_three_way               ? cc_bmap_search_char               :
+    cmpr == cc_cmpr_unsigned_char_three_way      ? cc_bmap_search_unsigned_char      :
+    cmpr == cc_cmpr_signed_char_three_way        ? cc_bmap_search_signed_char        :
+    cc_bmap_search_generic;
+}
+
+// Searches a node for the specified key.
+// Returns the index of the first key not less than the specified key and sets *found to whether that key is equal.
+static inline size_t cc_bmap_search_node(
+  cc_bmapnode_hdr_ty *node,
+  void *key,
+  const cc_bmap_geometry_ty *geo,
+  cc_cmpr_fnptr_ty cmpr,
+  cc_bmap_search_fnptr_ty search,
+  bool *found
+)
+{
+  return search( cc_bmap_node_key( node, 0, geo ), node->count, key, geo->key_size, cmpr, found );
+}
+
+// An r_end pointer-iterator points to the global placeholder.
+// An end pointer-iterator points to the end of the global placeholder.
+// Hence, neither is invalidated when a map's header is allocated or freed.
+static inline void *cc_bmap_r_end_or_end(
+  CC_UNUSED( void *, cntr ),
   bool dir
 )
 {
-  return cc_omap_hdr( cntr )->sentinel + dir;
+  return (cc_bmap_hdr_ty *)&cc_bmap_placeholder + dir;
 }
 
-static inline void *cc_omap_r_end( void *cntr )
+static inline void *cc_bmap_r_end( void *cntr )
 {
-  return cc_omap_r_end_or_end( cntr, false );
+  return cc_bmap_r_end_or_end( cntr, false );
 }
 
-static inline void *cc_omap_end(
+static inline void *cc_bmap_end(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_omap_r_end_or_end( cntr, true );
+  return cc_bmap_r_end_or_end( cntr, true );
 }
 
-static inline void *cc_omap_first_or_last(
+static inline void *cc_bmap_first_or_last(
   void *cntr,
-  bool dir
+  bool dir,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
 )
 {
-  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  cc_bmapnode_hdr_ty *node = cc_bmap_hdr( cntr )->root;
 
-  if( node == cc_omap_hdr( cntr )->sentinel )
-    return cc_omap_hdr( cntr )->sentinel + dir;
-  
-  while( node->children[ !dir ] != cc_omap_hdr( cntr )->sentinel )
-    node = node->children[ !dir ];
+  if( !node )
+    return cc_bmap_r_end_or_end( cntr, dir );
 
-  return cc_omap_el( node );
+  while( !node->is_leaf )
+    node = cc_bmap_children( node, geo )[ dir ? 0 : node->count ];
+
+  return cc_bmap_itr( node, dir ? 0 : node->count - 1u, el_size, geo );
 }
 
-static inline void *cc_omap_first(
+static inline void *cc_bmap_first(
   void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  size_t el_size,
+  uint64_t layout
 )
 {
-  return cc_omap_first_or_last( cntr, true );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  return cc_bmap_first_or_last( cntr, true, el_size, &geo );
 }
 
-static inline void *cc_omap_last(
+static inline void *cc_bmap_last(
   void *cntr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  size_t el_size,
+  uint64_t layout
 )
 {
-  return cc_omap_first_or_last( cntr, false );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  return cc_bmap_first_or_last( cntr, false, el_size, &geo );
 }
 
-static inline void *cc_omap_iterate(
+static inline void *cc_bmap_iterate(
   void *cntr,
   void *itr,
-  bool dir
+  bool dir,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
 )
 {
   // Handle the case of an end or r_end iterator.
-  if( itr == cc_omap_r_end_or_end( cntr, !dir ) )
-    return cc_omap_first_or_last( cntr, dir );
+  if( itr == cc_bmap_r_end_or_end( cntr, !dir ) )
+    return cc_bmap_first_or_last( cntr, dir, el_size, geo );
 
-  cc_omapnode_hdr_ty *node = cc_omapnode_hdr( itr );
+  cc_bmapnode_hdr_ty *node = cc_bmap_itr_node( itr, geo );
+  size_t i = cc_bmap_itr_index( node, itr, el_size, geo );
 
-  if( node->children[ dir ] != cc_omap_hdr( cntr )->sentinel )
+  // In an internal node, the adjacent pair is the extreme pair in the adjacent subtree.
+  if( !node->is_leaf )
   {
-    node = node->children[ dir ];
-    while( node->children[ !dir ] != cc_omap_hdr( cntr )->sentinel )
-      node = node->children[ !dir ];
+    node = cc_bmap_children( node, geo )[ i + dir ];
+    while( !node->is_leaf )
+      node = cc_bmap_children( node, geo )[ dir ? 0 : node->count ];
 
-    return cc_omap_el( node );
+    return cc_bmap_itr( node, dir ? 0 : node->count - 1u, el_size, geo );
   }
-  
-  while( node->parent != cc_omap_hdr( cntr )->sentinel )
-  {
-    if( node->parent->children[ !dir ] == node )
-      return cc_omap_el( node->parent );
 
+  if( dir ? i + 1 < node->count : i > 0 )
+    return cc_bmap_itr( node, dir ? i + 1 : i - 1, el_size, geo );
+
+  // Otherwise, the adjacent pair is the separator in the nearest ancestor of which the node is not in the extreme
+  // subtree.
+  while( node->parent && node->position == ( dir ? node->parent->count : 0 ) )
     node = node->parent;
-  }
-  
-  return cc_omap_r_end_or_end( cntr, dir );
+
+  if( !node->parent )
+    return cc_bmap_r_end_or_end( cntr, dir );
+
+  return cc_bmap_itr( node->parent, dir ? node->position : node->position - 1u, el_size, geo );
 }
 
-static inline void *cc_omap_prev(
+static inline void *cc_bmap_prev(
   void *cntr,
   void *itr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  size_t el_size,
+  uint64_t layout
 )
 {
-  return cc_omap_iterate( cntr, itr, false );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  return cc_bmap_iterate( cntr, itr, false, el_size, &geo );
 }
 
-static inline void *cc_omap_next(
+static inline void *cc_bmap_next(
   void *cntr,
   void *itr,
-  CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  size_t el_size,
+  uint64_t layout
 )
 {
-  return cc_omap_iterate( cntr, itr, true );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  return cc_bmap_iterate( cntr, itr, true, el_size, &geo );
 }
 
-// Allocates a header for an ordered map that is currently a placeholder.
+// Allocates a header for a B-tree map.
+// If allocator is not NULL, the header is allocated via, and associated with, that allocator.
 // Returns the new container handle, or NULL in the case of allocation failure.
-static inline void *cc_omap_alloc_hdr(
-  void *cntr,
+static inline void *cc_bmap_alloc_hdr(
+  cc_allocator *allocator,
   cc_realloc_fnptr_ty realloc_
 )
 {
-  cc_omap_hdr_ty *new_cntr = (cc_omap_hdr_ty *)realloc_( NULL, sizeof( cc_omap_hdr_ty ) );
+  cc_bmap_hdr_ty *new_cntr = (cc_bmap_hdr_ty *)cc_allocator_realloc(
+    allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_bmap_hdr_ty )
+  );
   if( CC_UNLIKELY( !new_cntr ) )
     return NULL;
 
+  *new_cntr = cc_bmap_placeholder;
   new_cntr->size = 0;
-  new_cntr->root = cc_omap_hdr( cntr )->sentinel;;    // Link the new header's sentinel with the sentinel associated
-  new_cntr->sentinel = cc_omap_hdr( cntr )->sentinel; // with the placeholder.
-                                                      // This ensures that the end and r_end iterator-pointers remain
-                                                      // stable in the transition from a placeholder to a real header.
+  new_cntr->allocator = allocator;
   return new_cntr;
 }
 
-// Standard binary search tree rotation.
-static inline void cc_omap_rotate(
+// Ensures that at least n nodes are available in the B-tree map's free list, allocating a new slab if necessary.
+// The B-tree map must not be a placeholder.
+// Returns false in the case of allocation failure.
+static inline bool cc_bmap_reserve_nodes(
   void *cntr,
-  cc_omapnode_hdr_ty *node,
-  bool dir
+  size_t n,
+  const cc_bmap_geometry_ty *geo,
+  cc_realloc_fnptr_ty realloc_
 )
 {
-  cc_omapnode_hdr_ty *child = node->children[ !dir ];
+  cc_bmap_hdr_ty *hdr = cc_bmap_hdr( cntr );
+  if( hdr->free_node_count >= n )
+    return true;
 
-  node->children[ !dir ] = child->children[ dir ];
-  if( child->children[ dir ] != cc_omap_hdr( cntr )->sentinel )
-    child->children[ dir ]->parent = node;
+  size_t node_count = hdr->next_slab_node_count;
+  if( node_count < n - hdr->free_node_count )
+    node_count = n - hdr->free_node_count;
 
-  if( child != cc_omap_hdr( cntr )->sentinel )
-    child->parent = node->parent;
+  // The slab is over-allocated by enough to align the first node to the node size.
+  cc_bmap_slab_hdr_ty *slab = (cc_bmap_slab_hdr_ty *)cc_allocator_realloc(
+    hdr->allocator,
+    realloc_,
+    NULL,
+    sizeof( cc_bmap_slab_hdr_ty ) + geo->node_size - 1 + node_count * geo->node_size
+  );
+  if( CC_UNLIKELY( !slab ) )
+    return false;
 
-  if( node->parent != cc_omap_hdr( cntr )->sentinel )
-    node->parent->children[ node == node->parent->children[ 1 ] ] = child;
-  else
-    cc_omap_hdr( cntr )->root = child;
+  slab->prev = hdr->slabs;
+  slab->node_count = node_count;
+  hdr->slabs = slab;
 
-  child->children[ dir ] = node;
-  if( node != cc_omap_hdr( cntr )->sentinel )
-    node->parent = child;
+  char *nodes = (char *)( slab + 1 );
+  nodes += CC_PADDING( (uintptr_t)nodes, geo->node_size );
+
+  for( size_t i = 0; i < node_count; ++i )
+  {
+    cc_bmapnode_hdr_ty *node = (cc_bmapnode_hdr_ty *)( nodes + i * geo->node_size );
+    node->parent = hdr->free_nodes;
+    hdr->free_nodes = node;
+  }
+
+  hdr->free_node_count += node_count;
+  if( hdr->next_slab_node_count < CC_BMAP_MAX_SLAB_NODES )
+    hdr->next_slab_node_count *= 2;
+
+  return true;
 }
 
-// Post-insert fix-up function to restore the red-black tree balance.
-static inline void cc_omap_post_insert_fixup(
+// Takes a node, which must have been reserved via cc_bmap_reserve_nodes, from the free list.
+static inline cc_bmapnode_hdr_ty *cc_bmap_take_node(
   void *cntr,
-  cc_omapnode_hdr_ty *node
+  bool is_leaf
+)
+{
+  cc_bmapnode_hdr_ty *node = cc_bmap_hdr( cntr )->free_nodes;
+  cc_bmap_hdr( cntr )->free_nodes = node->parent;
+  --cc_bmap_hdr( cntr )->free_node_count;
+
+  node->parent = NULL;
+  node->count = 0;
+  node->position = 0;
+  node->is_leaf = is_leaf;
+  return node;
+}
+
+// Returns a node to the free list.
+static inline void cc_bmap_recycle_node(
+  void *cntr,
+  cc_bmapnode_hdr_ty *node
+)
+{
+  node->parent = cc_bmap_hdr( cntr )->free_nodes;
+  cc_bmap_hdr( cntr )->free_nodes = node;
+  ++cc_bmap_hdr( cntr )->free_node_count;
+}
+
+// Moves n key-element pairs from index src_i of src to index dest_i of dest.
+// The ranges may overlap.
+static inline void cc_bmap_move_pairs(
+  cc_bmapnode_hdr_ty *dest,
+  size_t dest_i,
+  cc_bmapnode_hdr_ty *src,
+  size_t src_i,
+  size_t n,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  memmove( cc_bmap_node_key( dest, dest_i, geo ), cc_bmap_node_key( src, src_i, geo ), n * geo->key_size );
+  memmove( cc_bmap_node_el( dest, dest_i, el_size, geo ), cc_bmap_node_el( src, src_i, el_size, geo ), n * el_size );
+}
+
+// Moves n child pointers from index src_i of src to index dest_i of dest, which must both be internal nodes, and
+// updates the moved children's parent and position members.
+// The ranges may overlap.
+static inline void cc_bmap_move_children(
+  cc_bmapnode_hdr_ty *dest,
+  size_t dest_i,
+  cc_bmapnode_hdr_ty *src,
+  size_t src_i,
+  size_t n,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  // The addresses are computed from the node bases, rather than via cc_bmap_children, because GCC otherwise sometimes
+  // misjudges the bounds of the child pointer array and issues a superfluous array-bounds warning.
+  memmove(
+    (char *)dest + geo->children_offset + dest_i * sizeof( cc_bmapnode_hdr_ty * ),
+    (char *)src + geo->children_offset + src_i * sizeof( cc_bmapnode_hdr_ty * ),
+    n * sizeof( cc_bmapnode_hdr_ty * )
+  );
+
+  for( size_t i = dest_i; i < dest_i + n; ++i )
+  {
+    cc_bmap_children( dest, geo )[ i ]->parent = dest;
+    cc_bmap_children( dest, geo )[ i ]->position = (uint16_t)i;
+  }
+}
+
+// Sets the child pointer at index i of an internal node.
+static inline void cc_bmap_set_child(
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  cc_bmapnode_hdr_ty *child,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  cc_bmap_children( node, geo )[ i ] = child;
+  child->parent = node;
+  child->position = (uint16_t)i;
+}
+
+// Inserts a copy of the specified key and element at index i of a node.
+// If the node is internal, child becomes the child to the right of the new pair.
+static inline void cc_bmap_insert_into_node(
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  void *key,
+  void *el,
+  cc_bmapnode_hdr_ty *child,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  cc_bmap_move_pairs( node, i + 1, node, i, node->count - i, el_size, geo );
+  memcpy( cc_bmap_node_key( node, i, geo ), key, geo->key_size );
+  memcpy( cc_bmap_node_el( node, i, el_size, geo ), el, el_size );
+
+  if( !node->is_leaf )
+  {
+    cc_bmap_move_children( node, i + 2, node, i + 1, node->count - i, geo );
+    cc_bmap_set_child( node, i + 1, child, geo );
+  }
+
+  ++node->count;
+}
+
+// Inserts the specified key and element at index i of a leaf, splitting the leaf and its ancestors as necessary.
+// Enough nodes for the splits must already have been reserved.
+// Returns a pointer-iterator to the inserted element.
+// Since each node has room for one pair more than its capacity, a full node is split after the insertion into it, with
+// the median pair moving up into the parent.
+static inline void *cc_bmap_insert_at(
+  void *cntr,
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  void *key,
+  void *el,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
 )
 {
-  while( node != cc_omap_hdr( cntr )->root && node->parent->is_red )
+  // The location of the inserted pair, which may move during the splits.
+  cc_bmapnode_hdr_ty *result_node = node;
+  size_t result_i = i;
+
+  cc_bmap_insert_into_node( node, i, key, el, NULL, el_size, geo );
+
+  while( node->count > cc_bmap_cap( node, geo ) )
   {
-    bool dir = node->parent == node->parent->parent->children[ 0 ];
-    cc_omapnode_hdr_ty *uncle = node->parent->parent->children[ dir ];
+    size_t median = node->count / 2u;
+    size_t right_count = node->count - median - 1;
 
-    if( uncle->is_red )
+    // Move the pairs after the median, and the children to the right of the median, to a new sibling.
+
+    cc_bmapnode_hdr_ty *sibling = cc_bmap_take_node( cntr, node->is_leaf );
+    cc_bmap_move_pairs( sibling, 0, node, median + 1, right_count, el_size, geo );
+    if( !node->is_leaf )
+      cc_bmap_move_children( sibling, 0, node, median + 1, right_count + 1, geo );
+
+    sibling->count = (uint16_t)right_count;
+    node->count = (uint16_t)median;
+
+    // Move the median into the parent, creating a new root if necessary.
+
+    if( !node->parent )
     {
-      node->parent->is_red = false;
-      uncle->is_red = false;
-      node->parent->parent->is_red = true;
-      node = node->parent->parent;
+      cc_bmap_hdr( cntr )->root = cc_bmap_take_node( cntr, false );
+      cc_bmap_set_child( cc_bmap_hdr( cntr )->root, 0, node, geo );
+#ifdef CC_STATS
+      ++cc_bmap_hdr( cntr )->height;
+#endif
     }
-    else
+
+    cc_bmapnode_hdr_ty *parent = node->parent;
+    size_t position = node->position;
+
+    cc_bmap_insert_into_node(
+      parent,
+      position,
+      cc_bmap_node_key( node, median, geo ),
+      cc_bmap_node_el( node, median, el_size, geo ),
+      sibling,
+      el_size,
+      geo
+    );
+
+    if( result_node == node )
     {
-      if( node == node->parent->children[ dir ] )
+      if( result_i == median )
       {
-        node = node->parent;
-        cc_omap_rotate( cntr, node, !dir );
+        result_node = parent;
+        result_i = position;
+      }
+      else if( result_i > median )
+      {
+        result_node = sibling;
+        result_i -= median + 1;
       }
-
-      node->parent->is_red = false;
-      node->parent->parent->is_red = true;
-      cc_omap_rotate( cntr, node->parent->parent, dir );
     }
+
+    node = parent;
   }
 
-  cc_omap_hdr( cntr )->root->is_red = false;
+  return cc_bmap_itr( result_node, result_i, el_size, geo );
 }
 
-// Inserts a key-element pair into the ordered map, optionally replacing the existing key-element pair containing the
+// Inserts a key-element pair into the B-tree map, optionally replacing the existing key-element pair containing the
 // same key if it exists.
-// If replace is true, the function returns a cc_allocing_fn_result_ty containing the new container handle and a
-// pointer-iterator to the newly inserted element (or NULL in the case of allocation failure).
-// If replace is false, then the return value is as described above, except that if the key already exists, the
-// pointer-iterator returned points to the associated element.
-static inline cc_allocing_fn_result_ty cc_omap_insert(
+// The return value is as described for cc_omap_insert.
+static inline cc_allocing_fn_result_ty cc_bmap_insert(
   void *cntr,
   void *el,
   void *key,
@@ -3952,80 +13796,83 @@ static inline cc_allocing_fn_result_ty cc_omap_insert(
   CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  // Allocate a header if necessary.
-  if( cc_omap_is_placeholder( cntr ) )
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmap_search_fnptr_ty search = cc_bmap_search_fn( cmpr );
+
+  if( cc_bmap_is_placeholder( cntr ) )
   {
-    void *new_cntr = cc_omap_alloc_hdr( cntr, realloc_ );
+    void *new_cntr = cc_bmap_alloc_hdr( NULL, realloc_ );
     if( CC_UNLIKELY( !new_cntr ) )
       return cc_make_allocing_fn_result( cntr, NULL );
 
     cntr = new_cntr;
   }
 
-  // Find the node with the same key, or the parent of the node to be created.
+  // Find the matching key or the leaf position for the new key.
 
-  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
-  cc_omapnode_hdr_ty *parent = cc_omap_hdr( cntr )->sentinel;
-  int cmpr_result = 0; // This initialization is redundant, but it silences a GCC warning when cmpr_result is used after
-                       // the loop below to determine whether the new node should be its parent's left or right child.
-                       // In reality, if that determination occurs, then cmpr_result was set inside the loop.
+  cc_bmapnode_hdr_ty *node = cc_bmap_hdr( cntr )->root;
+  size_t i = 0;
 
-  while( node != cc_omap_hdr( cntr )->sentinel )
+  while( node )
   {
-    cmpr_result = cmpr( key, cc_omap_key( node, el_size, layout ) );
+    bool found;
+    i = cc_bmap_search_node( node, key, &geo, cmpr, search, &found );
 
-    // Matching key.
-    if( cmpr_result == 0 )
+    if( found )
     {
       if( replace )
       {
         if( key_dtor )
-          key_dtor( cc_omap_key( node, el_size, layout ) );
+          key_dtor( cc_bmap_node_key( node, i, &geo ) );
 
         if( el_dtor )
-          el_dtor( cc_omap_el( node ) );
+          el_dtor( cc_bmap_node_el( node, i, el_size, &geo ) );
 
-        memcpy( cc_omap_key( node, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-        memcpy( cc_omap_el( node ), el, el_size );
+        memcpy( cc_bmap_node_key( node, i, &geo ), key, geo.key_size );
+        memcpy( cc_bmap_node_el( node, i, el_size, &geo ), el, el_size );
       }
 
-      return cc_make_allocing_fn_result( cntr, cc_omap_el( node ) ); 
+      return cc_make_allocing_fn_result( cntr, cc_bmap_itr( node, i, el_size, &geo ) );
     }
 
-    parent = node;
-    node = node->children[ cmpr_result > 0 ];
+    if( node->is_leaf )
+      break;
+
+    node = cc_bmap_children( node, &geo )[ i ];
   }
 
-  // Allocate and insert the new node.
-
-  cc_omapnode_hdr_ty *new_node = (cc_omapnode_hdr_ty *)realloc_(
-    NULL,
-    sizeof( cc_omapnode_hdr_ty ) + CC_BUCKET_SIZE( el_size, layout )
-  );
-  if( CC_UNLIKELY( !new_node ) )
-    return cc_make_allocing_fn_result( cntr, NULL );
+  // Reserve a node for every full node on the path to the root, which will be split, plus one for a new root if the
+  // root will be split (or for the first leaf if the map is empty).
+  // Reserving all nodes up front ensures that allocation failure leaves the map unchanged.
 
-  new_node->parent = parent;
-  new_node->children[ 0 ] = cc_omap_hdr( cntr )->sentinel;
-  new_node->children[ 1 ] = cc_omap_hdr( cntr )->sentinel;
-  new_node->is_red = true;
+  size_t needed = 0;
+  cc_bmapnode_hdr_ty *ancestor = node;
+  while( ancestor && ancestor->count == cc_bmap_cap( ancestor, &geo ) )
+  {
+    ++needed;
+    ancestor = ancestor->parent;
+  }
 
-  memcpy( cc_omap_key( new_node, el_size, layout ), key, CC_KEY_SIZE( layout ) );
-  memcpy( cc_omap_el( new_node ), el, el_size );
+  if( !ancestor )
+    ++needed;
 
-  if( parent != cc_omap_hdr( cntr )->sentinel )
-    parent->children[ cmpr_result > 0 ] = new_node;
-  else
-    cc_omap_hdr( cntr )->root = new_node;
+  if( CC_UNLIKELY( !cc_bmap_reserve_nodes( cntr, needed, &geo, realloc_ ) ) )
+    return cc_make_allocing_fn_result( cntr, NULL );
 
-  cc_omap_post_insert_fixup( cntr, new_node );
+  if( !node )
+  {
+    node = cc_bmap_hdr( cntr )->root = cc_bmap_take_node( cntr, true );
+#ifdef CC_STATS
+    cc_bmap_hdr( cntr )->height = 1;
+#endif
+  }
 
-  ++cc_omap_hdr( cntr )->size;
-  return cc_make_allocing_fn_result( cntr, cc_omap_el( new_node ) );  
+  void *new_itr = cc_bmap_insert_at( cntr, node, i, key, el, el_size, &geo );
+  ++cc_bmap_hdr( cntr )->size;
+  return cc_make_allocing_fn_result( cntr, new_itr );
 }
 
-// Standard binary search tree lookup.
-static inline void *cc_omap_get(
+static inline void *cc_bmap_get(
   void *cntr,
   void *key,
   size_t el_size,
@@ -4034,14 +13881,21 @@ static inline void *cc_omap_get(
   cc_cmpr_fnptr_ty cmpr
 )
 {
-  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
-  while( node != cc_omap_hdr( cntr )->sentinel )
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmap_search_fnptr_ty search = cc_bmap_search_fn( cmpr );
+  cc_bmapnode_hdr_ty *node = cc_bmap_hdr( cntr )->root;
+
+  while( node )
   {
-    int cmpr_result = cmpr( key, cc_omap_key( node, el_size, layout ) );
-    if( cmpr_result == 0 )
-      return cc_omap_el( node );
-    else
-      node = node->children[ cmpr_result > 0 ];
+    bool found;
+    size_t i = cc_bmap_search_node( node, key, &geo, cmpr, search, &found );
+    if( found )
+      return cc_bmap_itr( node, i, el_size, &geo );
+
+    if( node->is_leaf )
+      break;
+
+    node = cc_bmap_children( node, &geo )[ i ];
   }
 
   return NULL;
@@ -4051,8 +13905,7 @@ static inline void *cc_omap_get(
 // specified key, or an end pointer-iterator if no such element exists.
 // If dir is false, then the returned pointer-iterator is the last element with a key less than or equal to the
 // specified key, or an r_end pointer-iterator if no such element exists.
-// This function is the basis of the cc_first and cc_last API macros when overloaded with two arguments.
-static inline void *cc_omap_bounded_first_or_last(
+static inline void *cc_bmap_bounded_first_or_last(
   void *cntr,
   void *key,
   bool dir,
@@ -4061,148 +13914,307 @@ static inline void *cc_omap_bounded_first_or_last(
   cc_cmpr_fnptr_ty cmpr
 )
 {
-  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
-  void *result = cc_omap_r_end_or_end( cntr, dir );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmap_search_fnptr_ty search = cc_bmap_search_fn( cmpr );
+  cc_bmapnode_hdr_ty *node = cc_bmap_hdr( cntr )->root;
+  void *result = cc_bmap_r_end_or_end( cntr, dir );
 
-  while( node != cc_omap_hdr( cntr )->sentinel )
+  while( node )
   {
-    int cmpr_result = cmpr( cc_omap_key( node, el_size, layout ), key );
-    if( cmpr_result == 0 )
-      return cc_omap_el( node );
-
-    if( ( cmpr_result > 0 ) == dir )
-      result = cc_omap_el( node );
+    bool found;
+    size_t i = cc_bmap_search_node( node, key, &geo, cmpr, search, &found );
+    if( found )
+      return cc_bmap_itr( node, i, el_size, &geo );
+
+    // The nearest key in this node on the relevant side bounds the result, and any better candidate lies in the subtree
+    // between it and the specified key.
+    if( dir && i < node->count )
+      result = cc_bmap_itr( node, i, el_size, &geo );
+    else if( !dir && i > 0 )
+      result = cc_bmap_itr( node, i - 1, el_size, &geo );
+
+    if( node->is_leaf )
+      break;
 
-    node = node->children[ cmpr_result < 0 ];
+    node = cc_bmap_children( node, &geo )[ i ];
   }
 
   return result;
 }
 
-// Post-erase fix-up function to restore the red-black tree balance.
-// Niemann's implementation of this function assumes that if the starting node is a sentinel, its parent pointer has
-// been temporarily set to point to the appropriate parent.
-// Since we never write to the sentinel, we instead pass the initial parent into the function via a parameter.
-static inline void cc_omap_post_erase_fixup(
-  void *cntr,
-  cc_omapnode_hdr_ty *node,
-  cc_omapnode_hdr_ty *parent
+// The location of a key-element pair, which erasure functions track as the tree is rebalanced so that they can return a
+// pointer-iterator to the pair following the erased one.
+// A NULL node denotes the end.
+typedef struct
+{
+  cc_bmapnode_hdr_ty *node;
+  size_t i;
+} cc_bmap_pos_ty;
+
+// Copies the key-element pair at index src_i of src to index dest_i of dest, which must be different nodes.
+static inline void cc_bmap_copy_pair(
+  cc_bmapnode_hdr_ty *dest,
+  size_t dest_i,
+  cc_bmapnode_hdr_ty *src,
+  size_t src_i,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo
+)
+{
+  memcpy( cc_bmap_node_key( dest, dest_i, geo ), cc_bmap_node_key( src, src_i, geo ), geo->key_size );
+  memcpy( cc_bmap_node_el( dest, dest_i, el_size, geo ), cc_bmap_node_el( src, src_i, el_size, geo ), el_size );
+}
+
+// Refills an underfull node by rotating the last pair of its left sibling into the parent and the separating pair from
+// the parent into the node.
+static inline void cc_bmap_borrow_from_left(
+  cc_bmapnode_hdr_ty *left,
+  cc_bmapnode_hdr_ty *node,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo,
+  cc_bmap_pos_ty *tracked
 )
 {
-  while( node != cc_omap_hdr( cntr )->root && !node->is_red )
+  cc_bmapnode_hdr_ty *parent = node->parent;
+  size_t separator = node->position - 1u;
+
+  cc_bmap_move_pairs( node, 1, node, 0, node->count, el_size, geo );
+  cc_bmap_copy_pair( node, 0, parent, separator, el_size, geo );
+  cc_bmap_copy_pair( parent, separator, left, left->count - 1u, el_size, geo );
+
+  if( !node->is_leaf )
   {
-    bool dir = ( node == parent->children[ 0 ] );
-    cc_omapnode_hdr_ty *sibling = parent->children[ dir ];
+    cc_bmap_move_children( node, 1, node, 0, node->count + 1u, geo );
+    cc_bmap_set_child( node, 0, cc_bmap_children( left, geo )[ left->count ], geo );
+  }
 
-    if( sibling->is_red )
-    {
-      sibling->is_red = false;
-      parent->is_red = true;
-      cc_omap_rotate( cntr, parent, !dir );
-      sibling = parent->children[ dir ];
-    }
+  if( tracked->node == node )
+    ++tracked->i;
+  else if( tracked->node == parent && tracked->i == separator )
+  {
+    tracked->node = node;
+    tracked->i = 0;
+  }
+  else if( tracked->node == left && tracked->i == left->count - 1u )
+  {
+    tracked->node = parent;
+    tracked->i = separator;
+  }
+
+  --left->count;
+  ++node->count;
+}
+
+// Refills an underfull node by rotating the separating pair from the parent into the node and the first pair of its
+// right sibling into the parent.
+static inline void cc_bmap_borrow_from_right(
+  cc_bmapnode_hdr_ty *node,
+  cc_bmapnode_hdr_ty *right,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo,
+  cc_bmap_pos_ty *tracked
+)
+{
+  cc_bmapnode_hdr_ty *parent = node->parent;
+  size_t separator = node->position;
+
+  cc_bmap_copy_pair( node, node->count, parent, separator, el_size, geo );
+  cc_bmap_copy_pair( parent, separator, right, 0, el_size, geo );
+  cc_bmap_move_pairs( right, 0, right, 1, right->count - 1u, el_size, geo );
+
+  if( !node->is_leaf )
+  {
+    cc_bmap_set_child( node, node->count + 1u, cc_bmap_children( right, geo )[ 0 ], geo );
+    cc_bmap_move_children( right, 0, right, 1, right->count, geo );
+  }
 
-    if( !sibling->children[ 0 ]->is_red && !sibling->children[ 1 ]->is_red )
+  if( tracked->node == parent && tracked->i == separator )
+  {
+    tracked->node = node;
+    tracked->i = node->count;
+  }
+  else if( tracked->node == right )
+  {
+    if( tracked->i == 0 )
     {
-      sibling->is_red = true;
-      node = parent;
-      parent = node->parent; // At this point, node can no longer be a sentinel, so we can use its parent pointer.
+      tracked->node = parent;
+      tracked->i = separator;
     }
     else
-    {
-      if( !sibling->children[ dir ]->is_red )
-      {
-        sibling->children[ !dir ]->is_red = false;
-        sibling->is_red = true;
-        cc_omap_rotate( cntr, sibling, dir );
-        sibling = parent->children[ dir ];
-      }
-
-      sibling->is_red = parent->is_red;
-      parent->is_red = false;
-      sibling->children[ dir ]->is_red = false;
-      cc_omap_rotate( cntr, parent, !dir );
-      node = cc_omap_hdr( cntr )->root;
-    }
+      --tracked->i;
   }
 
-  if( node != cc_omap_hdr( cntr )->sentinel )
-    node->is_red = false;
+  --right->count;
+  ++node->count;
 }
 
-// Erases the key-element pair denoted by node.
-static inline void cc_omap_erase_raw(
+// Merges a node, the separating pair from the parent, and the node's right sibling into the node and frees the sibling.
+static inline void cc_bmap_merge(
   void *cntr,
-  cc_omapnode_hdr_ty *node,
+  cc_bmapnode_hdr_ty *left,
+  cc_bmapnode_hdr_ty *right,
   size_t el_size,
-  uint64_t layout,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
-  cc_free_fnptr_ty free_
+  const cc_bmap_geometry_ty *geo,
+  cc_bmap_pos_ty *tracked
 )
 {
-  cc_omapnode_hdr_ty *to_detach;
+  cc_bmapnode_hdr_ty *parent = left->parent;
+  size_t separator = left->position;
 
-  if( node->children[ 0 ] == cc_omap_hdr( cntr )->sentinel || node->children[ 1 ] == cc_omap_hdr( cntr )->sentinel )
-    to_detach = node;
-  else
+  cc_bmap_copy_pair( left, left->count, parent, separator, el_size, geo );
+  cc_bmap_move_pairs( left, left->count + 1u, right, 0, right->count, el_size, geo );
+  if( !left->is_leaf )
+    cc_bmap_move_children( left, left->count + 1u, right, 0, right->count + 1u, geo );
+
+  cc_bmap_move_pairs( parent, separator, parent, separator + 1, parent->count - separator - 1, el_size, geo );
+  cc_bmap_move_children( parent, separator + 1, parent, separator + 2, parent->count - separator - 1, geo );
+
+  if( tracked->node == parent )
   {
-    to_detach = node->children[ 1 ];
-    while( to_detach->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
-      to_detach = to_detach->children[ 0 ];
+    if( tracked->i == separator )
+    {
+      tracked->node = left;
+      tracked->i = left->count;
+    }
+    else if( tracked->i > separator )
+      --tracked->i;
+  }
+  else if( tracked->node == right )
+  {
+    tracked->node = left;
+    tracked->i += left->count + 1u;
   }
 
-  cc_omapnode_hdr_ty *child = to_detach->children[ to_detach->children[ 0 ] == cc_omap_hdr( cntr )->sentinel ];
+  left->count = (uint16_t)( left->count + right->count + 1u );
+  --parent->count;
+  cc_bmap_recycle_node( cntr, right );
+}
 
-  if( child != cc_omap_hdr( cntr )->sentinel )
-    child->parent = to_detach->parent;
-  if( to_detach->parent != cc_omap_hdr( cntr )->sentinel )
-    to_detach->parent->children[ to_detach == to_detach->parent->children[ 1 ] ] = child;
-  else
-    cc_omap_hdr( cntr )->root = child;
+// Restores the minimum occupancy of a node that has lost one pair, and then of its ancestors as necessary, by borrowing
+// from or merging with siblings.
+// If the root is left without pairs, it is replaced by its only child or, if it is a leaf, the tree becomes empty.
+static inline void cc_bmap_rebalance(
+  void *cntr,
+  cc_bmapnode_hdr_ty *node,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo,
+  cc_bmap_pos_ty *tracked
+)
+{
+  while( node->parent && node->count < cc_bmap_min_count( node, geo ) )
+  {
+    cc_bmapnode_hdr_ty *parent = node->parent;
+    cc_bmapnode_hdr_ty *left = node->position > 0 ?
+      cc_bmap_children( parent, geo )[ node->position - 1 ] : NULL;
+    cc_bmapnode_hdr_ty *right = node->position < parent->count ?
+      cc_bmap_children( parent, geo )[ node->position + 1 ] : NULL;
 
-  if( !to_detach->is_red )
-    cc_omap_post_erase_fixup( cntr, child, to_detach->parent );  // Since child's parent pointer will be invalid if
-                                                                 // child is a sentinel, we must pass child's
-                                                                 // theoretical parent into the fix-up function.
+    if( left && left->count > cc_bmap_min_count( left, geo ) )
+    {
+      cc_bmap_borrow_from_left( left, node, el_size, geo, tracked );
+      return;
+    }
 
-  // Here, most red-black tree implementations, including Niemann's, copy the data stored by to_detach into node and
-  // then free to_detach.
-  // Instead, we supplant to_detach into node's position and then free node.
-  // This prevents the invalidation of any external pointer-iterators pointing to to_detach.
-  if( to_detach != node )
-  {
-    to_detach->parent = node->parent;
-    to_detach->children[ 0 ] = node->children[ 0 ];
-    to_detach->children[ 1 ] = node->children[ 1 ];
+    if( right && right->count > cc_bmap_min_count( right, geo ) )
+    {
+      cc_bmap_borrow_from_right( node, right, el_size, geo, tracked );
+      return;
+    }
 
-    if( node->parent != cc_omap_hdr( cntr )->sentinel )
-      node->parent->children[ node->parent->children[ 1 ] == node ] = to_detach;
+    if( left )
+      cc_bmap_merge( cntr, left, node, el_size, geo, tracked );
     else
-      cc_omap_hdr( cntr )->root = to_detach;
+      cc_bmap_merge( cntr, node, right, el_size, geo, tracked );
 
-    if( node->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
-      node->children[ 0 ]->parent = to_detach;
-    if( node->children[ 1 ] != cc_omap_hdr( cntr )->sentinel )
-      node->children[ 1 ]->parent = to_detach;
+    node = parent;
+  }
+
+  if( !node->parent && node->count == 0 )
+  {
+    if( node->is_leaf )
+      cc_bmap_hdr( cntr )->root = NULL;
+    else
+    {
+      cc_bmap_hdr( cntr )->root = cc_bmap_children( node, geo )[ 0 ];
+      cc_bmap_hdr( cntr )->root->parent = NULL;
+      cc_bmap_hdr( cntr )->root->position = 0;
+    }
 
-    to_detach->is_red = node->is_red;
+    cc_bmap_recycle_node( cntr, node );
+#ifdef CC_STATS
+    --cc_bmap_hdr( cntr )->height;
+#endif
   }
+}
 
+// Erases the key-element pair at index i of a node, calling the destructors for the key and element types if
+// necessary.
+// Returns a pointer-iterator to the following key-element pair, or an end pointer-iterator.
+static inline void *cc_bmap_erase_raw(
+  void *cntr,
+  cc_bmapnode_hdr_ty *node,
+  size_t i,
+  size_t el_size,
+  const cc_bmap_geometry_ty *geo,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor
+)
+{
   if( key_dtor )
-    key_dtor( cc_omap_key( node, el_size, layout ) );
+    key_dtor( cc_bmap_node_key( node, i, geo ) );
 
   if( el_dtor )
-    el_dtor( cc_omap_el( node ) );
+    el_dtor( cc_bmap_node_el( node, i, el_size, geo ) );
 
-  free_( node );
-  --cc_omap_hdr( cntr )->size;
+  cc_bmap_pos_ty next;
+
+  if( !node->is_leaf )
+  {
+    // Replace the pair with its in-order successor, i.e. the first pair in the leftmost leaf of the right subtree, and
+    // remove the successor from that leaf instead.
+    cc_bmapnode_hdr_ty *leaf = cc_bmap_children( node, geo )[ i + 1 ];
+    while( !leaf->is_leaf )
+      leaf = cc_bmap_children( leaf, geo )[ 0 ];
+
+    cc_bmap_copy_pair( node, i, leaf, 0, el_size, geo );
+    next.node = node;
+    next.i = i;
+    node = leaf;
+    i = 0;
+  }
+  else if( i + 1 < node->count )
+  {
+    next.node = node;
+    next.i = i;
+  }
+  else
+  {
+    // The successor of the last pair in a leaf is the separator in the nearest ancestor of which the leaf is not in the
+    // rightmost subtree.
+    cc_bmapnode_hdr_ty *ancestor = node;
+    while( ancestor->parent && ancestor->position == ancestor->parent->count )
+      ancestor = ancestor->parent;
+
+    next.node = ancestor->parent;
+    next.i = ancestor->position;
+  }
+
+  cc_bmap_move_pairs( node, i, node, i + 1, node->count - i - 1, el_size, geo );
+  --node->count;
+  --cc_bmap_hdr( cntr )->size;
+
+  cc_bmap_rebalance( cntr, node, el_size, geo, &next );
+
+  if( !next.node )
+    return cc_bmap_r_end_or_end( cntr, true );
+
+  return cc_bmap_itr( next.node, next.i, el_size, geo );
 }
 
 // Erases the key-element pair containing the specified key, if it exists.
 // Returns a pointer that evaluates to true if a key-element pair was erased, or else NULL.
 // This pointer is eventually cast to bool by the cc_erase API macro.
-static inline void *cc_omap_erase(
+static inline void *cc_bmap_erase(
   void *cntr,
   void *key,
   size_t el_size,
@@ -4211,22 +14223,23 @@ static inline void *cc_omap_erase(
   cc_cmpr_fnptr_ty cmpr,
   cc_dtor_fnptr_ty el_dtor,
   cc_dtor_fnptr_ty key_dtor,
-  cc_free_fnptr_ty free_
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  void *itr = cc_omap_get( cntr, key, el_size, layout, NULL /* Dummy */, cmpr );
+  void *itr = cc_bmap_get( cntr, key, el_size, layout, NULL /* Dummy */, cmpr );
   if( !itr )
     return NULL;
 
-  cc_omap_erase_raw( cntr, cc_omapnode_hdr( itr ), el_size, layout, el_dtor, key_dtor, free_ );
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmapnode_hdr_ty *node = cc_bmap_itr_node( itr, &geo );
+  cc_bmap_erase_raw( cntr, node, cc_bmap_itr_index( node, itr, el_size, &geo ), el_size, &geo, el_dtor, key_dtor );
   return &cc_dummy_true;
 }
 
 // Erases the key-element pair pointed to by itr and returns a pointer-iterator to the next key-element pair in the
 // tree.
-// This function must be inlined to ensure that the compiler optimizes away the cc_omap_next call if the returned
-// pointer-iterator is discarded.
-static inline CC_ALWAYS_INLINE void *cc_omap_erase_itr(
+// Because erasure may move key-element pairs, the returned pointer-iterator is located after rebalancing.
+static inline void *cc_bmap_erase_itr(
   void *cntr,
   void *itr,
   size_t el_size,
@@ -4234,16 +14247,58 @@ static inline CC_ALWAYS_INLINE void *cc_omap_erase_itr(
   CC_UNUSED( cc_hash_fnptr_ty, hash ),
   cc_dtor_fnptr_ty el_dtor,
   cc_dtor_fnptr_ty key_dtor,
+  CC_UNUSED( cc_free_fnptr_ty, free_ )
+)
+{
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmapnode_hdr_ty *node = cc_bmap_itr_node( itr, &geo );
+  return cc_bmap_erase_raw(
+    cntr,
+    node,
+    cc_bmap_itr_index( node, itr, el_size, &geo ),
+    el_size,
+    &geo,
+    el_dtor,
+    key_dtor
+  );
+}
+
+// Erases every key-element pair for which the predicate, called with a pointer-iterator to the element, does not
+// return keep_if.
+// The key-element pairs are simply visited in order and erased one by one, with each erasure yielding the next pair.
+// This function is the basis of both cc_filter (keep_if is true) and cc_erase_if (keep_if is false).
+// Returns the number of key-element pairs erased.
+static inline size_t cc_bmap_filter(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
   cc_free_fnptr_ty free_
 )
 {
-  void *next = cc_omap_next( cntr, itr, 0 /* Dummy */, 0 /* Dummy */ );
-  cc_omap_erase_raw( cntr, cc_omapnode_hdr( itr ), el_size, layout, el_dtor, key_dtor, free_ );
-  return next;
+  size_t erased_count = 0;
+  void *itr = cc_bmap_first( cntr, el_size, layout );
+  while( itr != cc_bmap_end( cntr, el_size, layout ) )
+  {
+    if( pred( itr, ctx ) == keep_if )
+      itr = cc_bmap_next( cntr, itr, el_size, layout );
+    else
+    {
+      itr = cc_bmap_erase_itr( cntr, itr, el_size, layout, NULL, el_dtor, key_dtor, free_ );
+      ++erased_count;
+    }
+  }
+
+  return erased_count;
 }
 
-// Erases all key-element pairs, calling the destructors for the key and element types if necessary.
-static inline void cc_omap_clear(
+// Erases all key-element pairs, calling the destructors for the key and element types if necessary, and frees all
+// nodes.
+static inline void cc_bmap_clear(
   void *cntr,
   size_t el_size,
   uint64_t layout,
@@ -4252,65 +14307,114 @@ static inline void cc_omap_clear(
   cc_free_fnptr_ty free_
 )
 {
-  cc_omapnode_hdr_ty *node = cc_omap_hdr( cntr )->root;
+  if( cc_bmap_is_placeholder( cntr ) )
+    return;
 
-  while( node != cc_omap_hdr( cntr )->sentinel )
+  cc_bmap_hdr_ty *hdr = cc_bmap_hdr( cntr );
+
+  if( el_dtor || key_dtor )
   {
-    cc_omapnode_hdr_ty *next;
+    cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
 
-    if( node->children[ 0 ] != cc_omap_hdr( cntr )->sentinel )
-    {
-      next = node->children[ 0 ];
-      node->children[ 0 ] = cc_omap_hdr( cntr )->sentinel;
-    }
-    else if( node->children[ 1 ] != cc_omap_hdr( cntr )->sentinel )
-    {
-      next = node->children[ 1 ];
-      node->children[ 1 ] = cc_omap_hdr( cntr )->sentinel;
-    }
-    else
+    for(
+      void *itr = cc_bmap_first_or_last( cntr, true, el_size, &geo );
+      itr != cc_bmap_r_end_or_end( cntr, true );
+      itr = cc_bmap_iterate( cntr, itr, true, el_size, &geo )
+    )
     {
-      next = node->parent;
+      cc_bmapnode_hdr_ty *node = cc_bmap_itr_node( itr, &geo );
+      size_t i = cc_bmap_itr_index( node, itr, el_size, &geo );
 
       if( key_dtor )
-        key_dtor( cc_omap_key( node, el_size, layout ) );
+        key_dtor( cc_bmap_node_key( node, i, &geo ) );
 
       if( el_dtor )
-        el_dtor( cc_omap_el( node ) );
-
-      free_( node );
+        el_dtor( cc_bmap_node_el( node, i, el_size, &geo ) );
     }
-
-    node = next;
   }
 
-  if( !cc_omap_is_placeholder( cntr ) )
+  while( hdr->slabs )
   {
-    cc_omap_hdr( cntr )->size = 0;
-    cc_omap_hdr( cntr )->root = cc_omap_hdr( cntr )->sentinel;
+    cc_bmap_slab_hdr_ty *prev = hdr->slabs->prev;
+    cc_allocator_free( hdr->allocator, free_, hdr->slabs );
+    hdr->slabs = prev;
   }
+
+  hdr->size = 0;
+  hdr->root = NULL;
+  hdr->free_nodes = NULL;
+  hdr->free_node_count = 0;
+  hdr->next_slab_node_count = 1;
+#ifdef CC_STATS
+  hdr->height = 0;
+#endif
+}
+
+// Erases all key-element pairs, calling their destructors if necessary, and frees the memory for the B-tree map's
+// header if it is not a placeholder.
+static inline void cc_bmap_cleanup(
+  void *cntr,
+  size_t el_size,
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  cc_dtor_fnptr_ty key_dtor,
+  cc_free_fnptr_ty free_
+)
+{
+  cc_bmap_clear( cntr, el_size, layout, el_dtor, key_dtor, free_ );
+
+  if( !cc_bmap_is_placeholder( cntr ) )
+    cc_allocator_free( cc_bmap_hdr( cntr )->allocator, free_, cntr );
+}
+
+#ifdef CC_STATS
+
+static inline void cc_bmap_get_stats(
+  void *cntr,
+  cc_stats *stats
+)
+{
+  memset( stats, 0, sizeof( cc_stats ) );
+  stats->size = cc_bmap_size( cntr );
+
+  stats->height = cc_bmap_hdr( cntr )->height;
+}
+
+#endif
+
+// The allocated memory includes free nodes and the padding used to align each slab's nodes to the node size.
+static inline cc_mem_usage cc_bmap_memory_usage( void *cntr, size_t el_size, uint64_t layout )
+{
+  if( cc_bmap_is_placeholder( cntr ) )
+    return cc_make_mem_usage( 0, 0 );
+
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+
+  size_t allocated = sizeof( cc_bmap_hdr_ty );
+  for( cc_bmap_slab_hdr_ty *slab = cc_bmap_hdr( cntr )->slabs; slab; slab = slab->prev )
+    allocated += sizeof( cc_bmap_slab_hdr_ty ) + geo.node_size - 1 + slab->node_count * geo.node_size;
+
+  return cc_make_mem_usage( allocated, ( el_size + geo.key_size ) * cc_bmap_size( cntr ) );
 }
 
-// Erases all key-element pairs, calling their destructors if necessary, and frees the memory for the ordered map's
-// header if it is not a placeholder.
-static inline void cc_omap_cleanup(
-  void *cntr,
-  size_t el_size,
-  uint64_t layout,
-  cc_dtor_fnptr_ty el_dtor,
-  cc_dtor_fnptr_ty key_dtor,
-  cc_free_fnptr_ty free_
+// Initializes a B-tree map that allocates its memory via the specified allocator.
+// The B-tree map's header is allocated immediately so that it can store the pointer to the allocator.
+// Returns a pointer to the new B-tree map, or NULL in the case of allocation failure.
+// The return value is cast to bool in the corresponding macro.
+static inline void *cc_bmap_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  CC_UNUSED( uint64_t, layout )
 )
 {
-  cc_omap_clear( cntr, el_size, layout, el_dtor, key_dtor, free_ );
-
-  if( !cc_omap_is_placeholder( cntr ) )
-    free_( cntr );
+  return cc_bmap_alloc_hdr( allocator, NULL /* Unused */ );
 }
 
-// Initializes a shallow copy of the source ordered map.
+// Initializes a shallow copy of the source B-tree map.
+// The copy uses the same allocator as the source B-tree map.
+// Each node is copied whole, and then its parent pointer and child pointers are redirected to the copied nodes.
 // The return value is cast to bool in the corresponding macro.
-static inline void *cc_omap_init_clone(
+static inline void *cc_bmap_init_clone(
   void *src,
   size_t el_size,
   uint64_t layout,
@@ -4318,104 +14422,88 @@ static inline void *cc_omap_init_clone(
   cc_free_fnptr_ty free_
 )
 {
-  if( cc_omap_size( src ) == 0 ) // Also handles placeholder.
-    return (void *)&cc_omap_placeholder;
-
-  // Create a header.
+  if( cc_bmap_size( src ) == 0 && !cc_bmap_hdr( src )->allocator ) // Also handles placeholder.
+    return (void *)&cc_bmap_placeholder;
 
-  cc_omap_hdr_ty *new_cntr = (cc_omap_hdr_ty *)realloc_( NULL, sizeof( cc_omap_hdr_ty ) );
+  cc_bmap_hdr_ty *new_cntr = (cc_bmap_hdr_ty *)cc_bmap_alloc_hdr( cc_bmap_hdr( src )->allocator, realloc_ );
   if( CC_UNLIKELY( !new_cntr ) )
     return NULL;
 
-  new_cntr->sentinel = (cc_omapnode_hdr_ty *)&cc_omap_sentinel;
+  if( cc_bmap_size( src ) == 0 )
+    return new_cntr;
 
-  // Clone the root node.
+  cc_bmap_geometry_ty geo = cc_bmap_geometry( el_size, layout );
+  cc_bmapnode_hdr_ty *src_node = cc_bmap_hdr( src )->root;
+  cc_bmapnode_hdr_ty *new_node = NULL;
 
-  new_cntr->root = (cc_omapnode_hdr_ty *)realloc_(
-    NULL,
-    sizeof( cc_omapnode_hdr_ty ) + CC_BUCKET_SIZE( el_size, layout )
-  );
-  if( CC_UNLIKELY( !new_cntr->root ) )
+  // Until a child of a copied node is itself copied, the copied node's child pointer still points to the source child,
+  // whose parent is not the copied node.
+  // Hence, the next child to copy is the first whose parent is not the copied node.
+  while( true )
   {
-    free_( new_cntr );
-    return NULL;
-  }
-
-  new_cntr->root->is_red = false;
-  new_cntr->root->parent = cc_omap_hdr( new_cntr )->sentinel;
-  new_cntr->root->children[ 0 ] = cc_omap_hdr( new_cntr )->sentinel;
-  new_cntr->root->children[ 1 ] = cc_omap_hdr( new_cntr )->sentinel;
-  memcpy( cc_omap_el( new_cntr->root ), cc_omap_el( cc_omap_hdr( src )->root ), CC_BUCKET_SIZE( el_size, layout ) );
-
-  // Clone every non-root node iteratively.
-
-  cc_omapnode_hdr_ty *src_node = cc_omap_hdr( src )->root;
-  cc_omapnode_hdr_ty *new_node = new_cntr->root;
+    size_t i = 0;
+    if( new_node && !new_node->is_leaf )
+      while( i <= new_node->count && cc_bmap_children( new_node, &geo )[ i ]->parent == new_node )
+        ++i;
 
-  while( src_node != cc_omap_hdr( src )->sentinel )
-  {
-    int dir;
-    for( dir = 0; dir < 2; ++dir )
-      if(
-        src_node->children[ dir ] != cc_omap_hdr( src )->sentinel &&
-        new_node->children[ dir ] == new_cntr->sentinel
-      )
+    if( new_node && ( new_node->is_leaf || i > new_node->count ) )
+    {
+      if( !new_node->parent )
         break;
 
-    if( dir == 2 )
-    {
       src_node = src_node->parent;
       new_node = new_node->parent;
       continue;
     }
 
-    new_node->children[ dir ] = (cc_omapnode_hdr_ty *)realloc_(
-      NULL,
-      sizeof( cc_omapnode_hdr_ty ) + CC_BUCKET_SIZE( el_size, layout )
-    );
-    if( !new_node->children[ dir ] )
+    if( CC_UNLIKELY( !cc_bmap_reserve_nodes( new_cntr, 1, &geo, realloc_ ) ) )
     {
-      // Free the partially formed clone tree without calling destructors.
-      new_node->children[ dir ] = new_cntr->sentinel;
-      cc_omap_cleanup( new_cntr, el_size, layout, NULL /* No destructor */, NULL /* No destructor */, free_ );
+      // Free the partially formed clone without calling destructors or traversing the tree.
+      cc_bmap_cleanup( new_cntr, el_size, layout, NULL /* No destructor */, NULL /* No destructor */, free_ );
       return NULL;
     }
 
-    new_node->children[ dir ]->parent = new_node;
-    new_node->children[ dir ]->children[ 0 ] = new_cntr->sentinel;
-    new_node->children[ dir ]->children[ 1 ] = new_cntr->sentinel;
-    new_node->children[ dir ]->is_red = src_node->children[ dir ]->is_red;
+    cc_bmapnode_hdr_ty *child = cc_bmap_take_node( new_cntr, true );
 
-    memcpy(
-      cc_omap_el( new_node->children[ dir ] ),
-      cc_omap_el( src_node->children[ dir ] ),
-      CC_BUCKET_SIZE( el_size, layout )
-    );
+    if( new_node )
+    {
+      src_node = cc_bmap_children( src_node, &geo )[ i ];
+      memcpy( child, src_node, geo.node_size );
+      cc_bmap_children( new_node, &geo )[ i ] = child;
+      child->parent = new_node;
+    }
+    else
+    {
+      memcpy( child, src_node, geo.node_size );
+      new_cntr->root = child;
+    }
 
-    src_node = src_node->children[ dir ];
-    new_node = new_node->children[ dir ];
+    new_node = child;
   }
 
-  new_cntr->size = cc_omap_hdr( src )->size;
+  new_cntr->size = cc_bmap_hdr( src )->size;
+#ifdef CC_STATS
+  new_cntr->height = cc_bmap_hdr( src )->height;
+#endif
   return new_cntr;
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
-/*                                                    Ordered set                                                     */
+/*                                                    B-tree set                                                      */
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-// An ordered set is implemented as an ordered map where the key and element are combined into one space in memory.
-// Hence, it reuses the functions for omap, except:
-// * The key offset inside the bucket is zero.
-//   This is handled at the API-macro level via the cc_layout function and associated macros.
-// * The element size passed into map functions is zero in order to avoid double memcpy-ing.
+// A B-tree set is implemented as a B-tree map where the element is the key.
+// Hence, it reuses the functions for bmap, except:
+// * The element size passed into bmap functions is zero, so nodes contain no element arrays and pointer-iterators point
+//   to keys.
+// * The element destructor is passed into bmap functions as the key destructor.
 
-static inline size_t cc_oset_size( void *cntr )
+static inline size_t cc_bset_size( void *cntr )
 {
-  return cc_omap_size( cntr );
+  return cc_bmap_size( cntr );
 }
 
-static inline cc_allocing_fn_result_ty cc_oset_insert(
+static inline cc_allocing_fn_result_ty cc_bset_insert(
   void *cntr,
   void *key,
   bool replace,
@@ -4428,7 +14516,7 @@ static inline cc_allocing_fn_result_ty cc_oset_insert(
   CC_UNUSED( cc_free_fnptr_ty, free_ )
 )
 {
-  return cc_omap_insert(
+  return cc_bmap_insert(
     cntr,
     cntr,     // Dummy pointer for element as memcpy-ing to a NULL pointer is undefined behavior even when size is zero.
     key,
@@ -4438,14 +14526,14 @@ static inline cc_allocing_fn_result_ty cc_oset_insert(
     NULL,     // Dummy.
     cmpr,
     0.0,      // Dummy.
-    el_dtor,
-    NULL,     // Only one destructor.
+    NULL,     // No element destructor.
+    el_dtor,  // The element is the key.
     realloc_,
     NULL      // Dummy.
   );
 }
 
-static inline void *cc_oset_get(
+static inline void *cc_bset_get(
   void *cntr,
   void *key,
   CC_UNUSED( size_t, el_size ),
@@ -4454,10 +14542,10 @@ static inline void *cc_oset_get(
   cc_cmpr_fnptr_ty cmpr
 )
 {
-  return cc_omap_get( cntr, key, 0 /* Zero element size */, layout, NULL /* Dummy */, cmpr );
+  return cc_bmap_get( cntr, key, 0 /* Zero element size */, layout, NULL /* Dummy */, cmpr );
 }
 
-static inline void *cc_oset_bounded_first_or_last(
+static inline void *cc_bset_bounded_first_or_last(
   void *cntr,
   void *key,
   bool dir,
@@ -4466,10 +14554,10 @@ static inline void *cc_oset_bounded_first_or_last(
   cc_cmpr_fnptr_ty cmpr
 )
 {
-  return cc_omap_bounded_first_or_last( cntr, key, dir, 0 /* Zero element size */, layout, cmpr );
+  return cc_bmap_bounded_first_or_last( cntr, key, dir, 0 /* Zero element size */, layout, cmpr );
 }
 
-static inline void *cc_oset_erase_itr(
+static inline void *cc_bset_erase_itr(
   void *cntr,
   void *itr,
   CC_UNUSED( size_t, el_size ),
@@ -4480,19 +14568,44 @@ static inline void *cc_oset_erase_itr(
   cc_free_fnptr_ty free_
 )
 {
-  return cc_omap_erase_itr(
+  return cc_bmap_erase_itr(
     cntr,
     itr,
     0,       // Zero element size.
     layout,
     NULL,    // Dummy.
-    el_dtor,
-    NULL,    // Only one destructor.
+    NULL,    // No element destructor.
+    el_dtor, // The element is the key.
     free_
   );
 }
 
-static inline void *cc_oset_erase(
+static inline size_t cc_bset_filter(
+  void *cntr,
+  cc_pred_fnptr_ty pred,
+  void *ctx,
+  bool keep_if,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout,
+  cc_dtor_fnptr_ty el_dtor,
+  CC_UNUSED( cc_dtor_fnptr_ty, key_dtor ),
+  cc_free_fnptr_ty free_
+)
+{
+  return cc_bmap_filter(
+    cntr,
+    pred,
+    ctx,
+    keep_if,
+    0,       // Zero element size.
+    layout,
+    NULL,    // No element destructor.
+    el_dtor, // The element is the key.
+    free_
+  );
+}
+
+static inline void *cc_bset_erase(
   void *cntr,
   void *key,
   CC_UNUSED( size_t, el_size ),
@@ -4504,20 +14617,20 @@ static inline void *cc_oset_erase(
   cc_free_fnptr_ty free_
 )
 {
-  return cc_omap_erase(
+  return cc_bmap_erase(
     cntr,
     key,
     0,       // Zero element size.
     layout,
     NULL,    // Dummy.
     cmpr,
-    el_dtor,
-    NULL,    // Only one destructor.
+    NULL,    // No element destructor.
+    el_dtor, // The element is the key.
     free_
   );
 }
 
-static inline void *cc_oset_init_clone(
+static inline void *cc_bset_init_clone(
   void *src,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
@@ -4525,10 +14638,19 @@ static inline void *cc_oset_init_clone(
   cc_free_fnptr_ty free_
 )
 {
-  return cc_omap_init_clone( src, 0 /* Zero element size */, layout, realloc_, free_ );
+  return cc_bmap_init_clone( src, 0 /* Zero element size */, layout, realloc_, free_ );
 }
 
-static inline void cc_oset_clear(
+static inline void *cc_bset_init_with_allocator(
+  cc_allocator *allocator,
+  CC_UNUSED( size_t, el_size ),
+  uint64_t layout
+)
+{
+  return cc_bmap_init_with_allocator( allocator, 0 /* Zero element size */, layout );
+}
+
+static inline void cc_bset_clear(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
@@ -4537,10 +14659,10 @@ static inline void cc_oset_clear(
   cc_free_fnptr_ty free_
 )
 {
-  cc_omap_clear( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
+  cc_bmap_clear( cntr, 0 /* Zero element size */, layout, NULL /* No element destructor */, el_dtor, free_ );
 }
 
-static inline void cc_oset_cleanup(
+static inline void cc_bset_cleanup(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   uint64_t layout,
@@ -4549,59 +14671,73 @@ static inline void cc_oset_cleanup(
   cc_free_fnptr_ty free_
 )
 {
-  cc_omap_cleanup( cntr, 0 /* Zero element size */, layout, el_dtor, NULL /* Only one destructor */, free_ );
+  cc_bmap_cleanup( cntr, 0 /* Zero element size */, layout, NULL /* No element destructor */, el_dtor, free_ );
 }
 
-static inline void *cc_oset_r_end( void *cntr )
+#ifdef CC_STATS
+
+static inline void cc_bset_get_stats( void *cntr, cc_stats *stats )
 {
-  return cc_omap_r_end( cntr );
+  cc_bmap_get_stats( cntr, stats );
 }
 
-static inline void *cc_oset_end(
+#endif
+
+static inline cc_mem_usage cc_bset_memory_usage( void *cntr, CC_UNUSED( size_t, el_size ), uint64_t layout )
+{
+  return cc_bmap_memory_usage( cntr, 0 /* Zero element size */, layout );
+}
+
+static inline void *cc_bset_r_end( void *cntr )
+{
+  return cc_bmap_r_end( cntr );
+}
+
+static inline void *cc_bset_end(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
   CC_UNUSED( uint64_t, layout )
 )
 {
-  return cc_omap_end( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
+  return cc_bmap_end( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
 }
 
-static inline void *cc_oset_first(
+static inline void *cc_bset_first(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  uint64_t layout
 )
 {
-  return cc_omap_first( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
+  return cc_bmap_first( cntr, 0 /* Zero element size */, layout );
 }
 
-static inline void *cc_oset_last(
+static inline void *cc_bset_last(
   void *cntr,
   CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  uint64_t layout
 )
 {
-  return cc_omap_last( cntr, 0 /* Zero element size */, 0 /* Dummy */ );
+  return cc_bmap_last( cntr, 0 /* Zero element size */, layout );
 }
 
-static inline void *cc_oset_prev(
+static inline void *cc_bset_prev(
   void *cntr,
   void *itr,
   CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  uint64_t layout
 )
 {
-  return cc_omap_prev( cntr, itr, 0 /* Zero element size */, 0 /* Dummy */ );
+  return cc_bmap_prev( cntr, itr, 0 /* Zero element size */, layout );
 }
 
-static inline void *cc_oset_next(
+static inline void *cc_bset_next(
   void *cntr,
   void *itr,
   CC_UNUSED( size_t, el_size ),
-  CC_UNUSED( uint64_t, layout )
+  uint64_t layout
 )
 {
-  return cc_omap_next( cntr, itr, 0 /* Zero element size */, 0 /* Dummy */ );
+  return cc_bmap_next( cntr, itr, 0 /* Zero element size */, layout );
 }
 
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -4617,7 +14753,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                                \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                                \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                                \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ||                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                                                   \
   ),                                                                                   \
   *(cntr) = (                                                                          \
     CC_CNTR_ID( *(cntr) ) == CC_VEC  ? (CC_TYPEOF_XP( *(cntr) ))&cc_vec_placeholder  : \
@@ -4625,7 +14765,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ? (CC_TYPEOF_XP( *(cntr) ))&cc_map_placeholder  : \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ? (CC_TYPEOF_XP( *(cntr) ))&cc_map_placeholder  : \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ? (CC_TYPEOF_XP( *(cntr) ))&cc_omap_placeholder : \
-                         /* CC_OSET */ (CC_TYPEOF_XP( *(cntr) ))&cc_omap_placeholder   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? (CC_TYPEOF_XP( *(cntr) ))&cc_bmap_placeholder : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? (CC_TYPEOF_XP( *(cntr) ))&cc_omap_placeholder : \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ? (CC_TYPEOF_XP( *(cntr) ))&cc_bmap_placeholder : \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ? (CC_TYPEOF_XP( *(cntr) ))&cc_cmap_placeholder : \
+                         /* CC_RING */ (CC_TYPEOF_XP( *(cntr) ))&cc_ring_placeholder   \
   ),                                                                                   \
   (void)0                                                                              \
 )                                                                                      \
@@ -4639,7 +14783,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||               \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||               \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||               \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||               \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||               \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||               \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ||               \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                  \
   ),                                                  \
   /* Function select */                               \
   (                                                   \
@@ -4648,7 +14796,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_size  : \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_size  : \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_size : \
-                         /* CC_OSET */ cc_oset_size   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_size : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_size : \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ? cc_bset_size : \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ? cc_cmap_size : \
+                         /* CC_RING */ cc_ring_size   \
   )                                                   \
   /* Function arguments */                            \
   (                                                   \
@@ -4656,25 +14808,27 @@ static inline void *cc_oset_next(
   )                                                   \
 )                                                     \
 
-#define cc_cap( cntr )                              \
-(                                                   \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),           \
-  CC_STATIC_ASSERT(                                 \
-    CC_CNTR_ID( *(cntr) ) == CC_VEC ||              \
-    CC_CNTR_ID( *(cntr) ) == CC_MAP ||              \
-    CC_CNTR_ID( *(cntr) ) == CC_SET                 \
-  ),                                                \
-  /* Function select */                             \
-  (                                                 \
-    CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_cap : \
-    CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_cap : \
-                          /* CC_SET */ cc_set_cap   \
-  )                                                 \
-  /* Function arguments */                          \
-  (                                                 \
-    *(cntr)                                         \
-  )                                                 \
-)                                                   \
+#define cc_cap( cntr )                             \
+(                                                  \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),          \
+  CC_STATIC_ASSERT(                                \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||             \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||             \
+    CC_CNTR_ID( *(cntr) ) == CC_SET ||             \
+    CC_CNTR_ID( *(cntr) ) == CC_RING               \
+  ),                                               \
+  /* Function select */                            \
+  (                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_cap : \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_cap : \
+    CC_CNTR_ID( *(cntr) ) == CC_SET ? cc_set_cap : \
+                     /* CC_RING */ cc_ring_cap     \
+  )                                                \
+  /* Function arguments */                         \
+  (                                                \
+    *(cntr)                                        \
+  )                                                \
+)                                                  \
 
 #define cc_reserve( cntr, n )                                                                \
 (                                                                                            \
@@ -4714,14 +14868,16 @@ static inline void *cc_oset_next(
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
   CC_STATIC_ASSERT(                                                                          \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                                      \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                                                         \
   ),                                                                                         \
   CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
     *(cntr),                                                                                 \
     /* Function select */                                                                    \
     (                                                                                        \
-      CC_CNTR_ID( *(cntr) ) == CC_SET ? cc_set_insert  :                                     \
-                          /* CC_OSET */ cc_oset_insert                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_insert  :                                    \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_insert :                                    \
+                           /* CC_BSET */ cc_bset_insert                                      \
     )                                                                                        \
     /* Function arguments */                                                                 \
     (                                                                                        \
@@ -4740,37 +14896,91 @@ static inline void *cc_oset_next(
   CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
 )                                                                                            \
 
-#define cc_insert_3( cntr, key, el )                                                         \
+#define cc_insert_3( cntr, key, el )                                                                \
+(                                                                                                   \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                           \
+  CC_STATIC_ASSERT(                                                                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_LIST ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP                                                                \
+  ),                                                                                                \
+  CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                                                              \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP,                                                               \
+    bool,                                                                                           \
+    CC_EL_TY( *(cntr) ) *,                                                                          \
+    /* A concurrent map's handle never changes, so it must not be temporarily repointed as below */ \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ?                                                              \
+    cc_cmap_insert(                                                                                 \
+      *(cntr),                                                                                      \
+      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                              \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                            \
+      true,                                                                                         \
+      NULL,                                                                                         \
+      CC_EL_SIZE( *(cntr) ),                                                                        \
+      CC_LAYOUT( *(cntr) ),                                                                         \
+      CC_KEY_HASH( *(cntr) ),                                                                       \
+      CC_KEY_CMPR( *(cntr) ),                                                                       \
+      CC_KEY_LOAD( *(cntr) ),                                                                       \
+      CC_EL_DTOR( *(cntr) ),                                                                        \
+      CC_KEY_DTOR( *(cntr) ),                                                                       \
+      CC_REALLOC_FN,                                                                                \
+      CC_FREE_FN                                                                                    \
+    ) :                                                                                             \
+    (                                                                                               \
+      CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                          \
+        *(cntr),                                                                                    \
+        /* Function select */                                                                       \
+        (                                                                                           \
+          CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_insert  :                                       \
+          CC_CNTR_ID( *(cntr) ) == CC_LIST ? cc_list_insert :                                       \
+          CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_insert  :                                       \
+          CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_insert :                                       \
+                               /* CC_BMAP */ cc_bmap_insert                                         \
+        )                                                                                           \
+        /* Function arguments */                                                                    \
+        (                                                                                           \
+          *(cntr),                                                                                  \
+          &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                          \
+          &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                        \
+          true,                                                                                     \
+          CC_EL_SIZE( *(cntr) ),                                                                    \
+          CC_LAYOUT( *(cntr) ),                                                                     \
+          CC_KEY_HASH( *(cntr) ),                                                                   \
+          CC_KEY_CMPR( *(cntr) ),                                                                   \
+          CC_CNTR_ID( *(cntr) ) == CC_VEC ? CC_EL_VEC_GROWTH( *(cntr) ) : CC_KEY_LOAD( *(cntr) ),   \
+          CC_EL_DTOR( *(cntr) ),                                                                    \
+          CC_KEY_DTOR( *(cntr) ),                                                                   \
+          CC_REALLOC_FN,                                                                            \
+          CC_FREE_FN                                                                                \
+        )                                                                                           \
+      ),                                                                                            \
+      CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) )                                                   \
+    )                                                                                               \
+  )                                                                                                 \
+)                                                                                                   \
+
+// The hash code must be the one that the key type's hash function would return for the key.
+#define cc_insert_with_hash( ... ) CC_SELECT_ON_NUM_ARGS( cc_insert_with_hash, __VA_ARGS__ )
+
+#define cc_insert_with_hash_3( cntr, key, hash )                                             \
 (                                                                                            \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
-  CC_STATIC_ASSERT(                                                                          \
-    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_LIST ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_OMAP                                                         \
-  ),                                                                                         \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_SET ),                                       \
   CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
     *(cntr),                                                                                 \
-    /* Function select */                                                                    \
-    (                                                                                        \
-      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_insert  :                                    \
-      CC_CNTR_ID( *(cntr) ) == CC_LIST ? cc_list_insert :                                    \
-      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_insert  :                                    \
-                           /* CC_OMAP */ cc_omap_insert                                      \
-    )                                                                                        \
-    /* Function arguments */                                                                 \
-    (                                                                                        \
+    cc_set_insert_from_hash(                                                                 \
       *(cntr),                                                                               \
-      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                       \
       &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                     \
+      (hash),                                                                                \
       true,                                                                                  \
-      CC_EL_SIZE( *(cntr) ),                                                                 \
       CC_LAYOUT( *(cntr) ),                                                                  \
       CC_KEY_HASH( *(cntr) ),                                                                \
       CC_KEY_CMPR( *(cntr) ),                                                                \
       CC_KEY_LOAD( *(cntr) ),                                                                \
       CC_EL_DTOR( *(cntr) ),                                                                 \
-      CC_KEY_DTOR( *(cntr) ),                                                                \
       CC_REALLOC_FN,                                                                         \
       CC_FREE_FN                                                                             \
     )                                                                                        \
@@ -4778,79 +14988,25 @@ static inline void *cc_oset_next(
   CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
 )                                                                                            \
 
-#define cc_insert_n( cntr, index, els, n )                                                   \
-(                                                                                            \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
-  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),                                       \
-  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
-    *(cntr),                                                                                 \
-    cc_vec_insert_n( *(cntr), (index), (els), (n), CC_EL_SIZE( *(cntr) ), CC_REALLOC_FN )    \
-  ),                                                                                         \
-  CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
-)                                                                                            \
-
-#define cc_push( cntr, el )                                                                  \
+#define cc_insert_with_hash_4( cntr, key, el, hash )                                         \
 (                                                                                            \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
-  CC_STATIC_ASSERT(                                                                          \
-    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_LIST                                                         \
-  ),                                                                                         \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP ),                                       \
   CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
     *(cntr),                                                                                 \
-    /* Function select */                                                                    \
-    (                                                                                        \
-      CC_CNTR_ID( *(cntr) ) == CC_VEC  ?  cc_vec_push  :                                     \
-                            /* CC_LIST */ cc_list_push                                       \
-    )                                                                                        \
-    /* Function arguments */                                                                 \
-    (                                                                                        \
+    cc_map_insert_from_hash(                                                                 \
       *(cntr),                                                                               \
       &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                       \
-      CC_EL_SIZE( *(cntr) ),                                                                 \
-      CC_REALLOC_FN                                                                          \
-    )                                                                                        \
-  ),                                                                                         \
-  CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
-)                                                                                            \
-
-#define cc_push_n( cntr, els, n )                                                            \
-(                                                                                            \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
-  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),                                       \
-  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
-    *(cntr),                                                                                 \
-    cc_vec_push_n( *(cntr), (els), (n), CC_EL_SIZE( *(cntr) ), CC_REALLOC_FN )               \
-  ),                                                                                         \
-  CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
-)                                                                                            \
-
-#define cc_get_or_insert( ... ) CC_SELECT_ON_NUM_ARGS( cc_get_or_insert, __VA_ARGS__ )
-
-#define cc_get_or_insert_2( cntr, key )                                                      \
-(                                                                                            \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
-  CC_STATIC_ASSERT(                                                                          \
-    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                                         \
-  ),                                                                                         \
-  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
-    *(cntr),                                                                                 \
-    /* Function select */                                                                    \
-    (                                                                                        \
-      CC_CNTR_ID( *(cntr) ) == CC_SET ? cc_set_insert  :                                     \
-                          /* CC_OSET */ cc_oset_insert                                       \
-    )                                                                                        \
-    /* Function arguments */                                                                 \
-    (                                                                                        \
-      *(cntr),                                                                               \
       &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                     \
-      false,                                                                                 \
+      (hash),                                                                                \
+      true,                                                                                  \
+      CC_EL_SIZE( *(cntr) ),                                                                 \
       CC_LAYOUT( *(cntr) ),                                                                  \
       CC_KEY_HASH( *(cntr) ),                                                                \
       CC_KEY_CMPR( *(cntr) ),                                                                \
       CC_KEY_LOAD( *(cntr) ),                                                                \
       CC_EL_DTOR( *(cntr) ),                                                                 \
+      CC_KEY_DTOR( *(cntr) ),                                                                \
       CC_REALLOC_FN,                                                                         \
       CC_FREE_FN                                                                             \
     )                                                                                        \
@@ -4858,33 +15014,250 @@ static inline void *cc_oset_next(
   CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
 )                                                                                            \
 
-#define cc_get_or_insert_3( cntr, key, el )                                                  \
+#define cc_insert_n( ... ) CC_SELECT_ON_NUM_ARGS( cc_insert_n, __VA_ARGS__ )
+
+#define cc_insert_n_3( cntr, els, n )                                                      \
+(                                                                                          \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                  \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_SET || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                     \
+    *(cntr),                                                                               \
+    /* Function select */                                                                  \
+    (                                                                                      \
+      CC_CNTR_ID( *(cntr) ) == CC_SET ? cc_set_insert_n :                                  \
+                         /* CC_OSET */ cc_oset_insert_n                                    \
+    )                                                                                      \
+    /* Function arguments */                                                               \
+    (                                                                                      \
+      *(cntr),                                                                             \
+      (els),                                                                               \
+      (n),                                                                                 \
+      CC_LAYOUT( *(cntr) ),                                                                \
+      CC_KEY_HASH( *(cntr) ),                                                              \
+      CC_KEY_CMPR( *(cntr) ),                                                              \
+      CC_KEY_LOAD( *(cntr) ),                                                              \
+      CC_EL_DTOR( *(cntr) ),                                                               \
+      CC_REALLOC_FN,                                                                       \
+      CC_FREE_FN                                                                           \
+    )                                                                                      \
+  ),                                                                                       \
+  CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) )                \
+)                                                                                          \
+
+// For vectors, the second argument of the four-argument form of insert_n (and of erase_n below) is an index, whereas
+// for the other containers, it is an array of keys.
+// Both function calls must compile for every container type, so the argument is cast to both types, and only the call
+// matching the container type is evaluated.
+#define cc_insert_n_4( cntr, index_or_keys, els, n )        \
+(                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                   \
+  CC_STATIC_ASSERT(                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP                        \
+  ),                                                        \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                      \
+    *(cntr),                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ?                       \
+      cc_vec_insert_n(                                      \
+        *(cntr),                                            \
+        (size_t)( index_or_keys ),                          \
+        (els),                                              \
+        (n),                                                \
+        CC_EL_SIZE( *(cntr) ),                              \
+        CC_EL_VEC_GROWTH( *(cntr) ),                        \
+        CC_REALLOC_FN                                       \
+      ) :                                                   \
+      /* Function select */                                 \
+      (                                                     \
+        CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_insert_n : \
+                           /* CC_OMAP */ cc_omap_insert_n   \
+      )                                                     \
+      /* Function arguments */                              \
+      (                                                     \
+        *(cntr),                                            \
+        (void *)(size_t)( index_or_keys ),                  \
+        (els),                                              \
+        (n),                                                \
+        CC_EL_SIZE( *(cntr) ),                              \
+        CC_LAYOUT( *(cntr) ),                               \
+        CC_KEY_HASH( *(cntr) ),                             \
+        CC_KEY_CMPR( *(cntr) ),                             \
+        CC_KEY_LOAD( *(cntr) ),                             \
+        CC_EL_DTOR( *(cntr) ),                              \
+        CC_KEY_DTOR( *(cntr) ),                             \
+        CC_REALLOC_FN,                                      \
+        CC_FREE_FN                                          \
+      )                                                     \
+  ),                                                        \
+  CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                      \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC,                        \
+    CC_EL_TY( *(cntr) ) *,                                  \
+    bool,                                                   \
+    CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) )             \
+  )                                                         \
+)                                                           \
+
+#define cc_insert_sorted_n( ... ) CC_SELECT_ON_NUM_ARGS( cc_insert_sorted_n, __VA_ARGS__ )
+
+#define cc_insert_sorted_n_3( cntr, els, n )                                \
+(                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OSET ),                     \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                      \
+    *(cntr),                                                                \
+    cc_oset_insert_sorted_n(                                                \
+      *(cntr),                                                              \
+      (els),                                                                \
+      (n),                                                                  \
+      CC_LAYOUT( *(cntr) ),                                                 \
+      CC_KEY_CMPR( *(cntr) ),                                               \
+      CC_EL_DTOR( *(cntr) ),                                                \
+      CC_REALLOC_FN,                                                        \
+      CC_FREE_FN                                                            \
+    )                                                                       \
+  ),                                                                        \
+  CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
+)                                                                           \
+
+#define cc_insert_sorted_n_4( cntr, keys, els, n )                          \
+(                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP ),                     \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                      \
+    *(cntr),                                                                \
+    cc_omap_insert_sorted_n(                                                \
+      *(cntr),                                                              \
+      (keys),                                                               \
+      (els),                                                                \
+      (n),                                                                  \
+      CC_EL_SIZE( *(cntr) ),                                                \
+      CC_LAYOUT( *(cntr) ),                                                 \
+      CC_KEY_CMPR( *(cntr) ),                                               \
+      CC_EL_DTOR( *(cntr) ),                                                \
+      CC_KEY_DTOR( *(cntr) ),                                               \
+      CC_REALLOC_FN,                                                        \
+      CC_FREE_FN                                                            \
+    )                                                                       \
+  ),                                                                        \
+  CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
+)                                                                           \
+
+#define cc_init_from_sorted( ... ) CC_SELECT_ON_NUM_ARGS( cc_init_from_sorted, __VA_ARGS__ )
+
+#define cc_init_from_sorted_3( cntr, els, n ) ( cc_init( cntr ), cc_insert_sorted_n_3( cntr, els, n ) )
+
+#define cc_init_from_sorted_4( cntr, keys, els, n ) ( cc_init( cntr ), cc_insert_sorted_n_4( cntr, keys, els, n ) )
+
+#define cc_push( cntr, el )                                                                                \
+(                                                                                                          \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                                  \
+  CC_STATIC_ASSERT(                                                                                        \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                                                                    \
+    CC_CNTR_ID( *(cntr) ) == CC_LIST ||                                                                    \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                                                                       \
+  ),                                                                                                       \
+  CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                                                                     \
+    CC_CNTR_ID( *(cntr) ) == CC_RING,                                                                      \
+    bool,                                                                                                  \
+    CC_EL_TY( *(cntr) ) *,                                                                                 \
+    /* A ring's handle never changes, so it must not be temporarily repointed as below */                  \
+    CC_CNTR_ID( *(cntr) ) == CC_RING ?                                                                     \
+    cc_ring_push_n( *(cntr), &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ), 1, CC_EL_SIZE( *(cntr) ) ) : \
+    (                                                                                                      \
+      CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                                 \
+        *(cntr),                                                                                           \
+        /* Function select */                                                                              \
+        (                                                                                                  \
+          CC_CNTR_ID( *(cntr) ) == CC_VEC  ?  cc_vec_push  :                                               \
+                                /* CC_LIST */ cc_list_push                                                 \
+        )                                                                                                  \
+        /* Function arguments */                                                                           \
+        (                                                                                                  \
+          *(cntr),                                                                                         \
+          &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                                 \
+          CC_EL_SIZE( *(cntr) ),                                                                           \
+          CC_EL_VEC_GROWTH( *(cntr) ),                                                                     \
+          CC_REALLOC_FN                                                                                    \
+        )                                                                                                  \
+      ),                                                                                                   \
+      CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) )                                                          \
+    )                                                                                                      \
+  )                                                                                                        \
+)                                                                                                          \
+
+#define cc_push_n( cntr, els, n )                                  \
+(                                                                  \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                          \
+  CC_STATIC_ASSERT(                                                \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                             \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                               \
+  ),                                                               \
+  CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                             \
+    CC_CNTR_ID( *(cntr) ) == CC_RING,                              \
+    bool,                                                          \
+    CC_EL_TY( *(cntr) ) *,                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_RING ?                             \
+    cc_ring_push_n( *(cntr), (els), (n), CC_EL_SIZE( *(cntr) ) ) : \
+    (                                                              \
+      CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                         \
+        *(cntr),                                                   \
+        cc_vec_push_n(                                             \
+          *(cntr),                                                 \
+          (els),                                                   \
+          (n),                                                     \
+          CC_EL_SIZE( *(cntr) ),                                   \
+          CC_EL_VEC_GROWTH( *(cntr) ),                             \
+          CC_REALLOC_FN                                            \
+        )                                                          \
+      ),                                                           \
+      CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) )                  \
+    )                                                              \
+  )                                                                \
+)                                                                  \
+
+#define cc_pop( cntr, out )                                                               \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_RING ),                                   \
+  CC_CAST_MAYBE_UNUSED( bool, cc_ring_pop_n( *(cntr), (out), 1, CC_EL_SIZE( *(cntr) ) ) ) \
+)                                                                                         \
+
+#define cc_pop_n( cntr, out, n )                                                              \
+(                                                                                             \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                     \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_RING ),                                       \
+  CC_CAST_MAYBE_UNUSED( size_t, cc_ring_pop_n( *(cntr), (out), (n), CC_EL_SIZE( *(cntr) ) ) ) \
+)                                                                                             \
+
+#define cc_get_or_insert( ... ) CC_SELECT_ON_NUM_ARGS( cc_get_or_insert, __VA_ARGS__ )
+
+#define cc_get_or_insert_2( cntr, key )                                                      \
 (                                                                                            \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                    \
   CC_STATIC_ASSERT(                                                                          \
-    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_OMAP                                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                                      \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                                      \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                                                         \
   ),                                                                                         \
   CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                       \
     *(cntr),                                                                                 \
     /* Function select */                                                                    \
     (                                                                                        \
-      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_insert  :                                     \
-                          /* CC_OMAP */ cc_omap_insert                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_insert  :                                    \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_insert :                                    \
+                           /* CC_BSET */ cc_bset_insert                                      \
     )                                                                                        \
     /* Function arguments */                                                                 \
     (                                                                                        \
       *(cntr),                                                                               \
-      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                       \
       &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                     \
       false,                                                                                 \
-      CC_EL_SIZE( *(cntr) ),                                                                 \
       CC_LAYOUT( *(cntr) ),                                                                  \
       CC_KEY_HASH( *(cntr) ),                                                                \
       CC_KEY_CMPR( *(cntr) ),                                                                \
       CC_KEY_LOAD( *(cntr) ),                                                                \
       CC_EL_DTOR( *(cntr) ),                                                                 \
-      CC_KEY_DTOR( *(cntr) ),                                                                \
       CC_REALLOC_FN,                                                                         \
       CC_FREE_FN                                                                             \
     )                                                                                        \
@@ -4892,54 +15265,252 @@ static inline void *cc_oset_next(
   CC_CAST_MAYBE_UNUSED( CC_EL_TY( *(cntr) ) *, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
 )                                                                                            \
 
-#define cc_get( cntr, key )                              \
-(                                                        \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                \
-  CC_STATIC_ASSERT(                                      \
-    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                     \
-  ),                                                     \
-  CC_CAST_MAYBE_UNUSED(                                  \
-    CC_EL_TY( *(cntr) ) *,                               \
-    /* Function select */                                \
-    (                                                    \
-      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_get  :   \
-      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_get  :   \
-      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_get  :   \
-      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_get :   \
-                           /* CC_OSET */ cc_oset_get     \
-    )                                                    \
-    /* Function arguments */                             \
-    (                                                    \
-      *(cntr),                                           \
-      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ), \
-      CC_EL_SIZE( *(cntr) ),                             \
-      CC_LAYOUT( *(cntr) ),                              \
-      CC_KEY_HASH( *(cntr) ),                            \
-      CC_KEY_CMPR( *(cntr) )                             \
-    )                                                    \
-  )                                                      \
-)                                                        \
+#define cc_get_or_insert_3( cntr, key, el )                                                         \
+(                                                                                                   \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                           \
+  CC_STATIC_ASSERT(                                                                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                                             \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP                                                                \
+  ),                                                                                                \
+  CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                                                              \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP,                                                               \
+    bool,                                                                                           \
+    CC_EL_TY( *(cntr) ) *,                                                                          \
+    /* A concurrent map's handle never changes, so it must not be temporarily repointed as below */ \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ?                                                              \
+    cc_cmap_insert(                                                                                 \
+      *(cntr),                                                                                      \
+      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                              \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                            \
+      false,                                                                                        \
+      NULL,                                                                                         \
+      CC_EL_SIZE( *(cntr) ),                                                                        \
+      CC_LAYOUT( *(cntr) ),                                                                         \
+      CC_KEY_HASH( *(cntr) ),                                                                       \
+      CC_KEY_CMPR( *(cntr) ),                                                                       \
+      CC_KEY_LOAD( *(cntr) ),                                                                       \
+      CC_EL_DTOR( *(cntr) ),                                                                        \
+      CC_KEY_DTOR( *(cntr) ),                                                                       \
+      CC_REALLOC_FN,                                                                                \
+      CC_FREE_FN                                                                                    \
+    ) :                                                                                             \
+    (                                                                                               \
+      CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                          \
+        *(cntr),                                                                                    \
+        /* Function select */                                                                       \
+        (                                                                                           \
+          CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_insert  :                                       \
+          CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_insert :                                       \
+                               /* CC_BMAP */ cc_bmap_insert                                         \
+        )                                                                                           \
+        /* Function arguments */                                                                    \
+        (                                                                                           \
+          *(cntr),                                                                                  \
+          &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                                          \
+          &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                        \
+          false,                                                                                    \
+          CC_EL_SIZE( *(cntr) ),                                                                    \
+          CC_LAYOUT( *(cntr) ),                                                                     \
+          CC_KEY_HASH( *(cntr) ),                                                                   \
+          CC_KEY_CMPR( *(cntr) ),                                                                   \
+          CC_KEY_LOAD( *(cntr) ),                                                                   \
+          CC_EL_DTOR( *(cntr) ),                                                                    \
+          CC_KEY_DTOR( *(cntr) ),                                                                   \
+          CC_REALLOC_FN,                                                                            \
+          CC_FREE_FN                                                                                \
+        )                                                                                           \
+      ),                                                                                            \
+      CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) )                                                   \
+    )                                                                                               \
+  )                                                                                                 \
+)                                                                                                   \
+
+#define cc_get_or_insert_4( cntr, key, el, out )                      \
+(                                                                     \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                             \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_CMAP ),               \
+  CC_STATIC_ASSERT( CC_IS_SAME_TY( *(out), (**(*(cntr)))( NULL ) ) ), \
+  CC_CAST_MAYBE_UNUSED(                                               \
+    bool,                                                             \
+    cc_cmap_insert(                                                   \
+      *(cntr),                                                        \
+      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),                \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),              \
+      false,                                                          \
+      (out),                                                          \
+      CC_EL_SIZE( *(cntr) ),                                          \
+      CC_LAYOUT( *(cntr) ),                                           \
+      CC_KEY_HASH( *(cntr) ),                                         \
+      CC_KEY_CMPR( *(cntr) ),                                         \
+      CC_KEY_LOAD( *(cntr) ),                                         \
+      CC_EL_DTOR( *(cntr) ),                                          \
+      CC_KEY_DTOR( *(cntr) ),                                         \
+      CC_REALLOC_FN,                                                  \
+      CC_FREE_FN                                                      \
+    )                                                                 \
+  )                                                                   \
+)                                                                     \
+
+#define cc_get( ... ) CC_SELECT_ON_NUM_ARGS( cc_get, __VA_ARGS__ )
+
+#define cc_get_2( cntr, key )                              \
+(                                                          \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                  \
+  CC_STATIC_ASSERT(                                        \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                       \
+  ),                                                       \
+  CC_CAST_MAYBE_UNUSED(                                    \
+    CC_EL_TY( *(cntr) ) *,                                 \
+    /* Function select */                                  \
+    (                                                      \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_get  :     \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_get  :     \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_get  :     \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_get :     \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_get :     \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_get :     \
+                           /* CC_BSET */ cc_bset_get       \
+    )                                                      \
+    /* Function arguments */                               \
+    (                                                      \
+      *(cntr),                                             \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),   \
+      CC_EL_SIZE( *(cntr) ),                               \
+      CC_LAYOUT( *(cntr) ),                                \
+      CC_KEY_HASH( *(cntr) ),                              \
+      CC_KEY_CMPR( *(cntr) )                               \
+    )                                                      \
+  )                                                        \
+)                                                          \
+
+#define cc_get_3( cntr, key, out )                                    \
+(                                                                     \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                             \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_CMAP ),               \
+  CC_STATIC_ASSERT( CC_IS_SAME_TY( *(out), (**(*(cntr)))( NULL ) ) ), \
+  cc_cmap_get(                                                        \
+    *(cntr),                                                          \
+    &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                \
+    (out),                                                            \
+    CC_EL_SIZE( *(cntr) ),                                            \
+    CC_LAYOUT( *(cntr) ),                                             \
+    CC_KEY_HASH( *(cntr) ),                                           \
+    CC_KEY_CMPR( *(cntr) )                                            \
+  )                                                                   \
+)                                                                     \
+
+#define cc_get_n( cntr, keys, n, itrs )                     \
+(                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                   \
+  CC_STATIC_ASSERT(                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                     \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                     \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                     \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET                        \
+  ),                                                        \
+  /* Function select */                                     \
+  (                                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_get_n  :      \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_get_n  :      \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_get_n :      \
+                         /* CC_OSET */ cc_oset_get_n        \
+  )                                                         \
+  /* Function arguments */                                  \
+  (                                                         \
+    *(cntr),                                                \
+    (keys),                                                 \
+    (n),                                                    \
+    (void **)(itrs),                                        \
+    CC_EL_SIZE( *(cntr) ),                                  \
+    CC_LAYOUT( *(cntr) ),                                   \
+    CC_KEY_HASH( *(cntr) ),                                 \
+    CC_KEY_CMPR( *(cntr) )                                  \
+  )                                                         \
+)                                                           \
+
+// The hash code must be the one that the key type's hash function would return for the key.
+#define cc_get_with_hash( cntr, key, hash )                                               \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                   \
+    CC_EL_TY( *(cntr) ) *,                                                                \
+    /* Function select */                                                                 \
+    (                                                                                     \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_get_from_hash :                            \
+                         /* CC_SET */ cc_set_get_from_hash                                \
+    )                                                                                     \
+    /* Function arguments */                                                              \
+    (                                                                                     \
+      *(cntr),                                                                            \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                  \
+      (hash),                                                                             \
+      CC_EL_SIZE( *(cntr) ),                                                              \
+      CC_LAYOUT( *(cntr) ),                                                               \
+      CC_KEY_CMPR( *(cntr) )                                                              \
+    )                                                                                     \
+  )                                                                                       \
+)                                                                                         \
+
+// key points to a borrowed key of any type, and cmpr compares a stored key (its first argument) with that borrowed key
+// (its second argument) for equality.
+#define cc_get_heterogeneous( cntr, key, hash, cmpr )                                     \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                   \
+    CC_EL_TY( *(cntr) ) *,                                                                \
+    /* Function select */                                                                 \
+    (                                                                                     \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_get_from_hash :                            \
+                         /* CC_SET */ cc_set_get_from_hash                                \
+    )                                                                                     \
+    /* Function arguments */                                                              \
+    (                                                                                     \
+      *(cntr),                                                                            \
+      (void *)(key),                                                                      \
+      (hash),                                                                             \
+      CC_EL_SIZE( *(cntr) ),                                                              \
+      CC_LAYOUT( *(cntr) ),                                                               \
+      (cmpr)                                                                              \
+    )                                                                                     \
+  )                                                                                       \
+)                                                                                         \
+
+#define cc_hash_for( cntr, key )                                                          \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_KEY_HASH( *(cntr) )( &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ) )             \
+)                                                                                         \
 
 #define cc_key_for( cntr, itr )                            \
 (                                                          \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                  \
   CC_STATIC_ASSERT(                                        \
     CC_CNTR_ID( *(cntr) ) == CC_MAP ||                     \
-    CC_CNTR_ID( *(cntr) ) == CC_OMAP                       \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP                       \
   ),                                                       \
   CC_CAST_MAYBE_UNUSED(                                    \
     const CC_KEY_TY( *(cntr) ) *,                          \
     /* Function select */                                  \
     (                                                      \
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_key_for  : \
-                           /* CC_OMAP */ cc_omap_key_for   \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_key_for : \
+                           /* CC_BMAP */ cc_bmap_key_for   \
     )                                                      \
     /* Function arguments */                               \
     (                                                      \
+      *(cntr),                                             \
       (itr),                                               \
       CC_EL_SIZE( *(cntr) ),                               \
       CC_LAYOUT( *(cntr) )                                 \
@@ -4956,13 +15527,19 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                 \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                 \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                 \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP                                    \
   ),                                                                    \
   CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                                  \
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                 \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                 \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                 \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET,                                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP,                                   \
     bool,                                                               \
     CC_EL_TY( *(cntr) ) *,                                              \
     /* Function select */                                               \
@@ -4972,7 +15549,10 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_erase  :                \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_erase  :                \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_erase :                \
-                           /* CC_OSET */ cc_oset_erase                  \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_erase :                \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_erase :                \
+      CC_CNTR_ID( *(cntr) ) == CC_BSET ? cc_bset_erase :                \
+                           /* CC_CMAP */ cc_cmap_erase                  \
     )                                                                   \
     /* Function arguments */                                            \
     (                                                                   \
@@ -4989,15 +15569,55 @@ static inline void *cc_oset_next(
   )                                                                     \
 )                                                                       \
 
-#define cc_erase_n( cntr, index, n )                                                      \
-(                                                                                         \
-  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
-  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),                                    \
-  CC_CAST_MAYBE_UNUSED(                                                                   \
-    CC_EL_TY( *(cntr) ) *,                                                                \
-    cc_vec_erase_n( *(cntr), (index), (n), CC_EL_SIZE( *(cntr) ), CC_EL_DTOR( *(cntr) ) ) \
-  )                                                                                       \
-)                                                                                         \
+#define cc_erase_n( cntr, index_or_keys, n )                 \
+(                                                            \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                    \
+  CC_STATIC_ASSERT(                                          \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET                         \
+  ),                                                         \
+  CC_CNTR_ID( *(cntr) ) == CC_VEC ?                          \
+    CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                     \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC,                       \
+      CC_EL_TY( *(cntr) ) *,                                 \
+      size_t,                                                \
+      cc_vec_erase_n(                                        \
+        *(cntr),                                             \
+        (size_t)( index_or_keys ),                           \
+        (n),                                                 \
+        CC_EL_SIZE( *(cntr) ),                               \
+        CC_EL_DTOR( *(cntr) )                                \
+      )                                                      \
+    ) :                                                      \
+    CC_IF_THEN_CAST_TY_1_ELSE_CAST_TY_2(                     \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC,                       \
+      CC_EL_TY( *(cntr) ) *,                                 \
+      size_t,                                                \
+      /* Function select */                                  \
+      (                                                      \
+        CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_erase_n  : \
+        CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_erase_n  : \
+        CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_erase_n : \
+                             /* CC_OSET */ cc_oset_erase_n   \
+      )                                                      \
+      /* Function arguments */                               \
+      (                                                      \
+        *(cntr),                                             \
+        (const void *)(size_t)( index_or_keys ),             \
+        (n),                                                 \
+        CC_EL_SIZE( *(cntr) ),                               \
+        CC_LAYOUT( *(cntr) ),                                \
+        CC_KEY_HASH( *(cntr) ),                              \
+        CC_KEY_CMPR( *(cntr) ),                              \
+        CC_EL_DTOR( *(cntr) ),                               \
+        CC_KEY_DTOR( *(cntr) ),                              \
+        CC_FREE_FN                                           \
+      )                                                      \
+    )                                                        \
+)                                                            \
 
 #define cc_erase_itr( cntr, itr )                            \
 (                                                            \
@@ -5006,7 +15626,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                      \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                      \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                      \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                         \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                      \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                         \
   ),                                                         \
   CC_CAST_MAYBE_UNUSED(                                      \
     CC_EL_TY( *(cntr) ) *,                                   \
@@ -5015,7 +15637,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_erase_itr  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_erase_itr  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_erase_itr : \
-                           /* CC_OSET */ cc_oset_erase_itr   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_erase_itr : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_erase_itr : \
+                           /* CC_BSET */ cc_bset_erase_itr   \
     )                                                        \
     /* Function arguments */                                 \
     (                                                        \
@@ -5031,6 +15655,286 @@ static inline void *cc_oset_next(
   )                                                          \
 )                                                            \
 
+#define cc_cursor_first( cntr, cursor )                                                   \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                   \
+    CC_EL_TY( *(cntr) ) *,                                                                \
+    /* Function select */                                                                 \
+    ( CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_cursor_first : cc_set_cursor_first )       \
+    /* Function arguments */                                                              \
+    (                                                                                     \
+      *(cntr),                                                                            \
+      (cursor),                                                                           \
+      CC_EL_SIZE( *(cntr) ),                                                              \
+      CC_LAYOUT( *(cntr) )                                                                \
+    )                                                                                     \
+  )                                                                                       \
+)                                                                                         \
+
+#define cc_cursor_next( cntr, cursor )                                                    \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                   \
+    CC_EL_TY( *(cntr) ) *,                                                                \
+    /* Function select */                                                                 \
+    ( CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_cursor_next : cc_set_cursor_next )         \
+    /* Function arguments */                                                              \
+    (                                                                                     \
+      *(cntr),                                                                            \
+      (cursor),                                                                           \
+      CC_EL_SIZE( *(cntr) ),                                                              \
+      CC_LAYOUT( *(cntr) )                                                                \
+    )                                                                                     \
+  )                                                                                       \
+)                                                                                         \
+
+#define cc_cursor_erase( cntr, cursor )                                                   \
+(                                                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_MAP || CC_CNTR_ID( *(cntr) ) == CC_SET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                   \
+    CC_EL_TY( *(cntr) ) *,                                                                \
+    /* Function select */                                                                 \
+    ( CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_cursor_erase : cc_set_cursor_erase )       \
+    /* Function arguments */                                                              \
+    (                                                                                     \
+      *(cntr),                                                                            \
+      (cursor),                                                                           \
+      CC_EL_SIZE( *(cntr) ),                                                              \
+      CC_LAYOUT( *(cntr) ),                                                               \
+      CC_KEY_HASH( *(cntr) ),                                                             \
+      CC_EL_DTOR( *(cntr) ),                                                              \
+      CC_KEY_DTOR( *(cntr) ),                                                             \
+      CC_FREE_FN                                                                          \
+    )                                                                                     \
+  )                                                                                       \
+)                                                                                         \
+
+#define cc_erase_range( cntr, itr_first, itr_end )                                          \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                     \
+    CC_EL_TY( *(cntr) ) *,                                                                  \
+    /* Function select */                                                                   \
+    (                                                                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_erase_range :                              \
+                         /* CC_OSET */ cc_oset_erase_range                                  \
+    )                                                                                       \
+    /* Function arguments */                                                                \
+    (                                                                                       \
+      *(cntr),                                                                              \
+      (itr_first),                                                                          \
+      (itr_end),                                                                            \
+      CC_EL_SIZE( *(cntr) ),                                                                \
+      CC_LAYOUT( *(cntr) ),                                                                 \
+      CC_EL_DTOR( *(cntr) ),                                                                \
+      CC_KEY_DTOR( *(cntr) ),                                                               \
+      CC_FREE_FN                                                                            \
+    )                                                                                       \
+  )                                                                                         \
+)                                                                                           \
+
+#define cc_split_at( cntr, key, dst )                                                       \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( dst ),                                                    \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  CC_STATIC_ASSERT( CC_IS_SAME_TY( *(cntr), *(dst) ) ),                                     \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                      \
+    *(dst),                                                                                 \
+    /* Function select */                                                                   \
+    (                                                                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_split_at :                                 \
+                         /* CC_OSET */ cc_oset_split_at                                     \
+    )                                                                                       \
+    /* Function arguments */                                                                \
+    (                                                                                       \
+      *(cntr),                                                                              \
+      &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                    \
+      *(dst),                                                                               \
+      CC_EL_SIZE( *(cntr) ),                                                                \
+      CC_LAYOUT( *(cntr) ),                                                                 \
+      CC_KEY_CMPR( *(cntr) ),                                                               \
+      CC_EL_DTOR( *(cntr) ),                                                                \
+      CC_KEY_DTOR( *(cntr) ),                                                               \
+      CC_REALLOC_FN,                                                                        \
+      CC_FREE_FN                                                                            \
+    )                                                                                       \
+  ),                                                                                        \
+  CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(dst) ) )                  \
+)                                                                                           \
+
+#define cc_join( cntr, src )                                                                \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  CC_STATIC_ASSERT( CC_IS_SAME_TY( *(cntr), *(src) ) ),                                     \
+  CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                                      \
+    *(cntr),                                                                                \
+    /* Function select */                                                                   \
+    (                                                                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_join :                                     \
+                         /* CC_OSET */ cc_oset_join                                         \
+    )                                                                                       \
+    /* Function arguments */                                                                \
+    (                                                                                       \
+      *(cntr),                                                                              \
+      *(src),                                                                               \
+      CC_EL_SIZE( *(cntr) ),                                                                \
+      CC_LAYOUT( *(cntr) ),                                                                 \
+      CC_KEY_CMPR( *(cntr) ),                                                               \
+      CC_EL_DTOR( *(cntr) ),                                                                \
+      CC_KEY_DTOR( *(cntr) ),                                                               \
+      CC_REALLOC_FN,                                                                        \
+      CC_FREE_FN                                                                            \
+    )                                                                                       \
+  ),                                                                                        \
+  CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) )                 \
+)                                                                                           \
+
+#define cc_sort( cntr )                                   \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),    \
+  CC_STATIC_ASSERT( CC_HAS_CMPR( CC_EL_TY( *(cntr) ) ) ), \
+  cc_vec_sort(                                            \
+    *(cntr),                                              \
+    CC_EL_SIZE( *(cntr) ),                                \
+    CC_EL_CMPR( *(cntr) ),                                \
+    CC_EL_RADIX( *(cntr) ),                               \
+    CC_REALLOC_FN,                                        \
+    CC_FREE_FN                                            \
+  )                                                       \
+)                                                         \
+
+#define cc_stable_sort( cntr )                            \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),    \
+  CC_STATIC_ASSERT( CC_HAS_CMPR( CC_EL_TY( *(cntr) ) ) ), \
+  cc_vec_stable_sort(                                     \
+    *(cntr),                                              \
+    CC_EL_SIZE( *(cntr) ),                                \
+    CC_EL_CMPR( *(cntr) ),                                \
+    CC_EL_RADIX( *(cntr) ),                               \
+    CC_REALLOC_FN,                                        \
+    CC_FREE_FN                                            \
+  )                                                       \
+)                                                         \
+
+#define cc_binary_search( cntr, el )                      \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),    \
+  CC_STATIC_ASSERT( CC_HAS_CMPR( CC_EL_TY( *(cntr) ) ) ), \
+  CC_CAST_MAYBE_UNUSED(                                   \
+    CC_EL_TY( *(cntr) ) *,                                \
+    cc_vec_binary_search(                                 \
+      *(cntr),                                            \
+      &CC_MAKE_LVAL_COPY( CC_EL_TY( *(cntr) ), (el) ),    \
+      CC_EL_SIZE( *(cntr) ),                              \
+      CC_EL_CMPR( *(cntr) )                               \
+    )                                                     \
+  )                                                       \
+)                                                         \
+
+#define cc_unique( cntr )                                 \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),    \
+  CC_STATIC_ASSERT( CC_HAS_CMPR( CC_EL_TY( *(cntr) ) ) ), \
+  CC_CAST_MAYBE_UNUSED(                                   \
+    size_t,                                               \
+    cc_vec_unique(                                        \
+      *(cntr),                                            \
+      CC_EL_SIZE( *(cntr) ),                              \
+      CC_EL_CMPR( *(cntr) ),                              \
+      CC_EL_DTOR( *(cntr) )                               \
+    )                                                     \
+  )                                                       \
+)                                                         \
+
+#define cc_filter( cntr, pred, ctx )                      \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT(                                       \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                      \
+  ),                                                      \
+  CC_CAST_MAYBE_UNUSED(                                   \
+    size_t,                                               \
+    /* Function select */                                 \
+    (                                                     \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_filter : \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_filter : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_filter : \
+                           /* CC_BSET */ cc_bset_filter   \
+    )                                                     \
+    /* Function arguments */                              \
+    (                                                     \
+      *(cntr),                                            \
+      (pred),                                             \
+      (ctx),                                              \
+      true,                                               \
+      CC_EL_SIZE( *(cntr) ),                              \
+      CC_LAYOUT( *(cntr) ),                               \
+      CC_EL_DTOR( *(cntr) ),                              \
+      CC_KEY_DTOR( *(cntr) ),                             \
+      CC_FREE_FN                                          \
+    )                                                     \
+  )                                                       \
+)                                                         \
+
+#define cc_erase_if( cntr, pred, ctx )                    \
+(                                                         \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                 \
+  CC_STATIC_ASSERT(                                       \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                      \
+  ),                                                      \
+  CC_CAST_MAYBE_UNUSED(                                   \
+    size_t,                                               \
+    /* Function select */                                 \
+    (                                                     \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_filter  : \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_filter : \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_filter : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_filter : \
+                           /* CC_BSET */ cc_bset_filter   \
+    )                                                     \
+    /* Function arguments */                              \
+    (                                                     \
+      *(cntr),                                            \
+      (pred),                                             \
+      (ctx),                                              \
+      false,                                              \
+      CC_EL_SIZE( *(cntr) ),                              \
+      CC_LAYOUT( *(cntr) ),                               \
+      CC_EL_DTOR( *(cntr) ),                              \
+      CC_KEY_DTOR( *(cntr) ),                             \
+      CC_FREE_FN                                          \
+    )                                                     \
+  )                                                       \
+)                                                         \
+
 #define cc_splice( cntr, itr, src, src_itr )                                \
 (                                                                           \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                   \
@@ -5038,7 +15942,15 @@ static inline void *cc_oset_next(
   CC_STATIC_ASSERT( CC_IS_SAME_TY( (cntr), (src) ) ),                       \
   CC_POINT_HNDL_TO_ALLOCING_FN_RESULT(                                      \
     *(cntr),                                                                \
-    cc_list_splice( *(cntr), (itr), *(src), (src_itr), CC_REALLOC_FN )      \
+    cc_list_splice(                                                         \
+      *(cntr),                                                              \
+      (itr),                                                                \
+      *(src),                                                               \
+      (src_itr),                                                            \
+      CC_EL_SIZE( *(cntr) ),                                                \
+      CC_REALLOC_FN,                                                        \
+      CC_FREE_FN                                                            \
+    )                                                                       \
   ),                                                                        \
   CC_CAST_MAYBE_UNUSED( bool, CC_FIX_HNDL_AND_RETURN_OTHER_PTR( *(cntr) ) ) \
 )                                                                           \
@@ -5094,7 +16006,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                       \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                       \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                       \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                          \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                          \
   ),                                                          \
   CC_STATIC_ASSERT( CC_IS_SAME_TY( *(cntr), *(src) ) ),       \
   CC_CAST_MAYBE_UNUSED(                                       \
@@ -5107,7 +16021,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_init_clone  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_init_clone  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_init_clone : \
-                           /* CC_OSET */ cc_oset_init_clone   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_init_clone : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_init_clone : \
+                           /* CC_BSET */ cc_bset_init_clone   \
     )                                                         \
     /* Function arguments */                                  \
     (                                                         \
@@ -5120,6 +16036,286 @@ static inline void *cc_oset_next(
   )                                                           \
 )                                                             \
 
+#define cc_init_with_allocator( cntr, allocator )                      \
+(                                                                      \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                              \
+  CC_STATIC_ASSERT(                                                    \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_LIST ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                                   \
+  ),                                                                   \
+  CC_CAST_MAYBE_UNUSED(                                                \
+    bool,                                                              \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))                                \
+    /* Function select */                                              \
+    (                                                                  \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_init_with_allocator  : \
+      CC_CNTR_ID( *(cntr) ) == CC_LIST ? cc_list_init_with_allocator : \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_init_with_allocator  : \
+      CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_init_with_allocator  : \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_init_with_allocator : \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_init_with_allocator : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_init_with_allocator : \
+                           /* CC_BSET */ cc_bset_init_with_allocator   \
+    )                                                                  \
+    /* Function arguments */                                           \
+    (                                                                  \
+      (allocator),                                                     \
+      CC_EL_SIZE( *(cntr) ),                                           \
+      CC_LAYOUT( *(cntr) )                                             \
+    )                                                                  \
+  )                                                                    \
+)                                                                      \
+
+// Small-vector buffers allocate via the realloc and free functions visible where cc_init_with_buffer is called once
+// the vector outgrows them.
+#define cc_init_with_buffer( cntr, buf )                                          \
+(                                                                                 \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                         \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_VEC ),                            \
+  CC_STATIC_ASSERT( sizeof( (buf)->els[ 0 ] ) == CC_EL_SIZE( *(cntr) ) ),         \
+  (void)(                                                                         \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))cc_vec_init_with_buffer(                   \
+      &(buf)->hdr,                                                                \
+      &(buf)->vec_hdr,                                                            \
+      sizeof( (buf)->vec_hdr ) + sizeof( (buf)->els ),                            \
+      CC_EL_SIZE( *(cntr) ),                                                      \
+      CC_REALLOC_FN,                                                              \
+      CC_FREE_FN                                                                  \
+    )                                                                             \
+  )                                                                               \
+)                                                                                 \
+
+// Fixed-capacity buffers never allocate via the realloc and free functions.
+#define cc_init_with_fixed_buffer( cntr, buf )                                 \
+(                                                                              \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                      \
+  CC_STATIC_ASSERT(                                                            \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_SET                                            \
+  ),                                                                           \
+  CC_STATIC_ASSERT( sizeof( (buf)->slots[ 0 ].el ) == CC_EL_SIZE( *(cntr) ) ), \
+  (void)(                                                                      \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))                                        \
+    /* Function select */                                                      \
+    (                                                                          \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_init_with_fixed_buffer :        \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_init_with_fixed_buffer :        \
+                       /* CC_SET */ cc_set_init_with_fixed_buffer              \
+    )                                                                          \
+    /* Function arguments */                                                   \
+    (                                                                          \
+      &(buf)->hdr,                                                             \
+      &(buf)->cntr_hdr,                                                        \
+      (size_t)( (char *)( (buf) + 1 ) - (char *)&(buf)->cntr_hdr ),            \
+      sizeof( (buf)->slots ) / sizeof( (buf)->slots[ 0 ] ),                    \
+      CC_EL_SIZE( *(cntr) ),                                                   \
+      CC_LAYOUT( *(cntr) )                                                     \
+    )                                                                          \
+  )                                                                            \
+)                                                                              \
+
+#define cc_init_sharded( cntr, shard_count )                                                \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_CMAP ),                                     \
+  CC_CAST_MAYBE_UNUSED(                                                                     \
+    bool,                                                                                   \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))cc_cmap_init_sharded( (shard_count), CC_REALLOC_FN ) \
+  )                                                                                         \
+)                                                                                           \
+
+#define cc_init_with_cap( cntr, cap )                                                                       \
+(                                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_RING ),                                                     \
+  CC_CAST_MAYBE_UNUSED(                                                                                     \
+    bool,                                                                                                   \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))cc_ring_init_with_cap( (cap), CC_EL_SIZE( *(cntr) ), CC_REALLOC_FN ) \
+  )                                                                                                         \
+)                                                                                                           \
+
+// Arenas allocate their blocks via the realloc and free functions visible where cc_arena_init is called.
+#define cc_arena_init( arena ) cc_arena_init_( (arena), CC_REALLOC_FN, CC_FREE_FN )
+
+#define cc_snapshot_size( cntr )                             \
+(                                                            \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                    \
+  CC_STATIC_ASSERT(                                          \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_SET                          \
+  ),                                                         \
+  /* Function select */                                      \
+  (                                                          \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_snapshot_size : \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_snapshot_size : \
+                     /* CC_SET */ cc_set_snapshot_size       \
+  )                                                          \
+  /* Function arguments */                                   \
+  (                                                          \
+    *(cntr),                                                 \
+    CC_EL_SIZE( *(cntr) ),                                   \
+    CC_LAYOUT( *(cntr) )                                     \
+  )                                                          \
+)                                                            \
+
+#define cc_write_snapshot( cntr, buf )                        \
+(                                                             \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                     \
+  CC_STATIC_ASSERT(                                           \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                        \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                        \
+    CC_CNTR_ID( *(cntr) ) == CC_SET                           \
+  ),                                                          \
+  /* Function select */                                       \
+  (                                                           \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_write_snapshot : \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_write_snapshot : \
+                     /* CC_SET */ cc_set_write_snapshot       \
+  )                                                           \
+  /* Function arguments */                                    \
+  (                                                           \
+    *(cntr),                                                  \
+    (buf),                                                    \
+    CC_CNTR_ID( *(cntr) ),                                    \
+    CC_EL_SIZE( *(cntr) ),                                    \
+    CC_LAYOUT( *(cntr) )                                      \
+  )                                                           \
+)                                                             \
+
+#define cc_init_from_snapshot( cntr, buf, buf_size )                \
+(                                                                   \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                           \
+  CC_STATIC_ASSERT(                                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                              \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                              \
+    CC_CNTR_ID( *(cntr) ) == CC_SET                                 \
+  ),                                                                \
+  CC_CAST_MAYBE_UNUSED(                                             \
+    bool,                                                           \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))                             \
+    /* Function select */                                           \
+    (                                                               \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_init_from_snapshot : \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_init_from_snapshot : \
+                       /* CC_SET */ cc_set_init_from_snapshot       \
+    )                                                               \
+    /* Function arguments */                                        \
+    (                                                               \
+      (buf),                                                        \
+      (buf_size),                                                   \
+      CC_CNTR_ID( *(cntr) ),                                        \
+      CC_EL_SIZE( *(cntr) ),                                        \
+      CC_LAYOUT( *(cntr) ),                                         \
+      CC_REALLOC_FN,                                                \
+      CC_FREE_FN                                                    \
+    )                                                               \
+  )                                                                 \
+)                                                                   \
+
+#define cc_init_view_of_snapshot( cntr, buf, buf_size )                \
+(                                                                      \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                              \
+  CC_STATIC_ASSERT(                                                    \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP ||                                 \
+    CC_CNTR_ID( *(cntr) ) == CC_SET                                    \
+  ),                                                                   \
+  CC_CAST_MAYBE_UNUSED(                                                \
+    bool,                                                              \
+    *(cntr) = (CC_TYPEOF_XP( *(cntr) ))                                \
+    /* Function select */                                              \
+    (                                                                  \
+      CC_CNTR_ID( *(cntr) ) == CC_VEC ? cc_vec_init_view_of_snapshot : \
+      CC_CNTR_ID( *(cntr) ) == CC_MAP ? cc_map_init_view_of_snapshot : \
+                       /* CC_SET */ cc_set_init_view_of_snapshot       \
+    )                                                                  \
+    /* Function arguments */                                           \
+    (                                                                  \
+      (buf),                                                           \
+      (buf_size),                                                      \
+      CC_CNTR_ID( *(cntr) ),                                           \
+      CC_EL_SIZE( *(cntr) ),                                           \
+      CC_LAYOUT( *(cntr) )                                             \
+    )                                                                  \
+  )                                                                    \
+)                                                                      \
+
+#ifdef CC_STATS
+#define cc_get_stats( cntr, stats )                        \
+(                                                          \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                  \
+  CC_STATIC_ASSERT(                                        \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                       \
+  ),                                                       \
+  /* Function select */                                    \
+  (                                                        \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_get_stats  : \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_get_stats  : \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_get_stats  : \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_get_stats : \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_get_stats : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_get_stats : \
+                         /* CC_BSET */ cc_bset_get_stats   \
+  )                                                        \
+  /* Function arguments */                                 \
+  (                                                        \
+    *(cntr),                                               \
+    (stats)                                                \
+  )                                                        \
+)                                                          \
+
+#endif
+
+#define cc_memory_usage( cntr )                               \
+(                                                             \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                     \
+  CC_STATIC_ASSERT(                                           \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_LIST ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ||                       \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                          \
+  ),                                                          \
+  /* Function select */                                       \
+  (                                                           \
+    CC_CNTR_ID( *(cntr) ) == CC_VEC  ? cc_vec_memory_usage  : \
+    CC_CNTR_ID( *(cntr) ) == CC_LIST ? cc_list_memory_usage : \
+    CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_memory_usage  : \
+    CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_memory_usage  : \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_memory_usage : \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_memory_usage : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_memory_usage : \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ? cc_bset_memory_usage : \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ? cc_cmap_memory_usage : \
+                         /* CC_RING */ cc_ring_memory_usage   \
+  )                                                           \
+  /* Function arguments */                                    \
+  (                                                           \
+    *(cntr),                                                  \
+    CC_EL_SIZE( *(cntr) ),                                    \
+    CC_LAYOUT( *(cntr) )                                      \
+  )                                                           \
+)                                                             \
+
 #define cc_clear( cntr )                               \
 (                                                      \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),              \
@@ -5129,7 +16325,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                   \
   ),                                                   \
   /* Function select */                                \
   (                                                    \
@@ -5138,7 +16338,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_clear  : \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_clear  : \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_clear : \
-                         /* CC_OSET */ cc_oset_clear   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_clear : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_clear : \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ? cc_bset_clear : \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ? cc_cmap_clear : \
+                         /* CC_RING */ cc_ring_clear   \
   )                                                    \
   /* Function arguments */                             \
   (                                                    \
@@ -5160,7 +16364,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                     \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_RING                     \
   ),                                                     \
   /* Function select */                                  \
   (                                                      \
@@ -5169,7 +16377,11 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_cleanup  : \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_cleanup  : \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_cleanup : \
-                         /* CC_OSET */ cc_oset_cleanup   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_cleanup : \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_cleanup : \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET ? cc_bset_cleanup : \
+    CC_CNTR_ID( *(cntr) ) == CC_CMAP ? cc_cmap_cleanup : \
+                         /* CC_RING */ cc_ring_cleanup   \
   )                                                      \
   /* Function arguments */                               \
   (                                                      \
@@ -5195,7 +16407,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                     \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                     \
   ),                                                     \
   CC_CAST_MAYBE_UNUSED(                                  \
     CC_EL_TY( *(cntr) ) *,                               \
@@ -5205,7 +16419,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_r_end  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_r_end  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_r_end : \
-                           /* CC_OSET */ cc_oset_r_end   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_r_end : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_r_end : \
+                           /* CC_BSET */ cc_bset_r_end   \
     )                                                    \
     /* Function arguments */                             \
     (                                                    \
@@ -5223,7 +16439,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                   \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                   \
   ),                                                   \
   CC_CAST_MAYBE_UNUSED(                                \
     CC_EL_TY( *(cntr) ) *,                             \
@@ -5234,7 +16452,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_end  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_end  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_end : \
-                           /* CC_OSET */ cc_oset_end   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_end : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_end : \
+                           /* CC_BSET */ cc_bset_end   \
     )                                                  \
     /* Function arguments */                           \
     (                                                  \
@@ -5256,7 +16476,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                  \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                     \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                     \
   ),                                                     \
   CC_CAST_MAYBE_UNUSED(                                  \
     CC_EL_TY( *(cntr) ) *,                               \
@@ -5267,7 +16489,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_first  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_first  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_first : \
-                           /* CC_OSET */ cc_oset_first   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_first : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_first : \
+                           /* CC_BSET */ cc_bset_first   \
     )                                                    \
     /* Function arguments */                             \
     (                                                    \
@@ -5283,14 +16507,18 @@ static inline void *cc_oset_next(
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                \
   CC_STATIC_ASSERT(                                                      \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                     \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                  \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                                     \
   ),                                                                     \
   CC_CAST_MAYBE_UNUSED(                                                  \
     CC_EL_TY( *(cntr) ) *,                                               \
     /* Function select */                                                \
     (                                                                    \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_bounded_first_or_last : \
-                           /* CC_OSET */ cc_oset_bounded_first_or_last   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_bounded_first_or_last : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_bounded_first_or_last : \
+                           /* CC_BSET */ cc_bset_bounded_first_or_last   \
     )                                                                    \
     /* Function arguments */                                             \
     (                                                                    \
@@ -5319,7 +16547,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                 \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                    \
   ),                                                    \
   CC_CAST_MAYBE_UNUSED(                                 \
     CC_EL_TY( *(cntr) ) *,                              \
@@ -5330,7 +16560,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_last  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_last  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_last : \
-                           /* CC_OSET */ cc_oset_last   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_last : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_last : \
+                           /* CC_BSET */ cc_bset_last   \
     )                                                   \
     /* Function arguments */                            \
     (                                                   \
@@ -5346,14 +16578,18 @@ static inline void *cc_oset_next(
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                \
   CC_STATIC_ASSERT(                                                      \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                                  \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                                     \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                                  \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                                  \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                                     \
   ),                                                                     \
   CC_CAST_MAYBE_UNUSED(                                                  \
     CC_EL_TY( *(cntr) ) *,                                               \
     /* Function select */                                                \
     (                                                                    \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_bounded_first_or_last : \
-                           /* CC_OSET */ cc_oset_bounded_first_or_last   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_bounded_first_or_last : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_bounded_first_or_last : \
+                           /* CC_BSET */ cc_bset_bounded_first_or_last   \
     )                                                                    \
     /* Function arguments */                                             \
     (                                                                    \
@@ -5367,6 +16603,66 @@ static inline void *cc_oset_next(
   )                                                                      \
 )                                                                        \
 
+#define cc_nth( cntr, n )                                                                   \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  CC_CAST_MAYBE_UNUSED(                                                                     \
+    CC_EL_TY( *(cntr) ) *,                                                                  \
+    /* Function select */                                                                   \
+    (                                                                                       \
+      CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_nth :                                      \
+                         /* CC_OSET */ cc_oset_nth                                          \
+    )                                                                                       \
+    /* Function arguments */                                                                \
+    (                                                                                       \
+      *(cntr),                                                                              \
+      (n),                                                                                  \
+      CC_EL_SIZE( *(cntr) ),                                                                \
+      CC_LAYOUT( *(cntr) )                                                                  \
+    )                                                                                       \
+  )                                                                                         \
+)                                                                                           \
+
+#define cc_rank( cntr, key )                                                                \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  /* Function select */                                                                     \
+  (                                                                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_rank :                                       \
+                       /* CC_OSET */ cc_oset_rank                                           \
+  )                                                                                         \
+  /* Function arguments */                                                                  \
+  (                                                                                         \
+    *(cntr),                                                                                \
+    &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (key) ),                                      \
+    CC_EL_SIZE( *(cntr) ),                                                                  \
+    CC_LAYOUT( *(cntr) ),                                                                   \
+    CC_KEY_CMPR( *(cntr) )                                                                  \
+  )                                                                                         \
+)                                                                                           \
+
+#define cc_count_range( cntr, lo, hi )                                                      \
+(                                                                                           \
+  CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),                                                   \
+  CC_STATIC_ASSERT( CC_CNTR_ID( *(cntr) ) == CC_OMAP || CC_CNTR_ID( *(cntr) ) == CC_OSET ), \
+  /* Function select */                                                                     \
+  (                                                                                         \
+    CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_count_range :                                \
+                       /* CC_OSET */ cc_oset_count_range                                    \
+  )                                                                                         \
+  /* Function arguments */                                                                  \
+  (                                                                                         \
+    *(cntr),                                                                                \
+    &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (lo) ),                                       \
+    &CC_MAKE_LVAL_COPY( CC_KEY_TY( *(cntr) ), (hi) ),                                       \
+    CC_EL_SIZE( *(cntr) ),                                                                  \
+    CC_LAYOUT( *(cntr) ),                                                                   \
+    CC_KEY_CMPR( *(cntr) )                                                                  \
+  )                                                                                         \
+)                                                                                           \
+
 #define cc_next( cntr, itr )                            \
 (                                                       \
   CC_WARN_DUPLICATE_SIDE_EFFECTS( cntr ),               \
@@ -5376,7 +16672,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                 \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                    \
   ),                                                    \
   CC_CAST_MAYBE_UNUSED(                                 \
     CC_EL_TY( *(cntr) ) *,                              \
@@ -5387,7 +16685,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_next  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_next  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_next : \
-                          /* CC_OSET */  cc_oset_next   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_next : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_next : \
+                           /* CC_BSET */ cc_bset_next   \
     )                                                   \
     /* Function arguments */                            \
     (                                                   \
@@ -5411,7 +16711,9 @@ static inline void *cc_oset_next(
     CC_CNTR_ID( *(cntr) ) == CC_MAP  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_SET  ||                 \
     CC_CNTR_ID( *(cntr) ) == CC_OMAP ||                 \
-    CC_CNTR_ID( *(cntr) ) == CC_OSET                    \
+    CC_CNTR_ID( *(cntr) ) == CC_BMAP ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_OSET ||                 \
+    CC_CNTR_ID( *(cntr) ) == CC_BSET                    \
   ),                                                    \
   CC_CAST_MAYBE_UNUSED(                                 \
     CC_EL_TY( *(cntr) ) *,                              \
@@ -5421,7 +16723,9 @@ static inline void *cc_oset_next(
       CC_CNTR_ID( *(cntr) ) == CC_MAP  ? cc_map_prev  : \
       CC_CNTR_ID( *(cntr) ) == CC_SET  ? cc_set_prev  : \
       CC_CNTR_ID( *(cntr) ) == CC_OMAP ? cc_omap_prev : \
-                           /* CC_OSET */ cc_oset_prev   \
+      CC_CNTR_ID( *(cntr) ) == CC_BMAP ? cc_bmap_prev : \
+      CC_CNTR_ID( *(cntr) ) == CC_OSET ? cc_oset_prev : \
+                           /* CC_BSET */ cc_bset_prev   \
     )                                                   \
     /* Function arguments */                            \
     (                                                   \
@@ -5450,6 +16754,26 @@ static inline void *cc_oset_next(
   )                                                                                                                   \
     for( const CC_KEY_TY( *(cntr) ) *key_ptr_name = cc_key_for( (cntr), i_name ); key_ptr_name; key_ptr_name = NULL ) \
 
+// The hidden cursor is declared in an outer loop that runs once, so that break and continue in the body behave as they
+// would in cc_for_each.
+#define cc_for_each_fast( ... ) CC_SELECT_ON_NUM_ARGS( cc_for_each_fast, __VA_ARGS__ )
+
+#define cc_for_each_fast_2( cntr, i_name )                                                                     \
+  for(                                                                                                         \
+    cc_cursor CC_CAT_2( i_name, _cc_cursor ), *CC_CAT_2( i_name, _cc_once ) = &CC_CAT_2( i_name, _cc_cursor ); \
+    CC_CAT_2( i_name, _cc_once );                                                                              \
+    CC_CAT_2( i_name, _cc_once ) = NULL                                                                        \
+  )                                                                                                            \
+    for(                                                                                                       \
+      CC_EL_TY( *(cntr) ) *i_name = cc_cursor_first( (cntr), &CC_CAT_2( i_name, _cc_cursor ) );                \
+      i_name != cc_end( cntr );                                                                                \
+      i_name = cc_cursor_next( (cntr), &CC_CAT_2( i_name, _cc_cursor ) )                                       \
+    )                                                                                                          \
+
+#define cc_for_each_fast_3( cntr, key_ptr_name, i_name )                                                              \
+  cc_for_each_fast_2( cntr, i_name )                                                                                  \
+    for( const CC_KEY_TY( *(cntr) ) *key_ptr_name = cc_key_for( (cntr), i_name ); key_ptr_name; key_ptr_name = NULL ) \
+
 #define cc_r_for_each( ... ) CC_SELECT_ON_NUM_ARGS( cc_r_for_each, __VA_ARGS__ )
 
 #define cc_r_for_each_2( cntr, i_name )              \
@@ -5471,7 +16795,8 @@ static inline void *cc_oset_next(
 /*                         Destructor, comparison, and hash functions and custom load factors                         */
 /*--------------------------------------------------------------------------------------------------------------------*/
 
-// Octal counters that support up to 511 of each function type and 511 load factors.
+// Octal counters that support up to 511 of each function type, 511 load factors, 511 growth factors, and 511
+// hash-caching declarations.
 #define CC_N_DTORS_D1 0 // D1 = digit 1, i.e. the least significant digit.
 #define CC_N_DTORS_D2 0
 #define CC_N_DTORS_D3 0
@@ -5484,6 +16809,12 @@ static inline void *cc_oset_next(
 #define CC_N_LOADS_D1 0
 #define CC_N_LOADS_D2 0
 #define CC_N_LOADS_D3 0
+#define CC_N_VEC_GROWTHS_D1 0
+#define CC_N_VEC_GROWTHS_D2 0
+#define CC_N_VEC_GROWTHS_D3 0
+#define CC_N_CACHE_HASHS_D1 0
+#define CC_N_CACHE_HASHS_D2 0
+#define CC_N_CACHE_HASHS_D3 0
 
 #define CC_CAT_3_( a, b, c ) a##b##c
 #define CC_CAT_3( a, b, c ) CC_CAT_3_( a, b, c )
@@ -5496,6 +16827,8 @@ static inline void *cc_oset_next(
 #define CC_N_CMPRS CC_CAT_4( 0, CC_N_CMPRS_D3, CC_N_CMPRS_D2, CC_N_CMPRS_D1 )
 #define CC_N_HASHS CC_CAT_4( 0, CC_N_HASHS_D3, CC_N_HASHS_D2, CC_N_HASHS_D1 )
 #define CC_N_LOADS CC_CAT_4( 0, CC_N_LOADS_D3, CC_N_LOADS_D2, CC_N_LOADS_D1 )
+#define CC_N_VEC_GROWTHS CC_CAT_4( 0, CC_N_VEC_GROWTHS_D3, CC_N_VEC_GROWTHS_D2, CC_N_VEC_GROWTHS_D1 )
+#define CC_N_CACHE_HASHS CC_CAT_4( 0, CC_N_CACHE_HASHS_D3, CC_N_CACHE_HASHS_D2, CC_N_CACHE_HASHS_D1 )
 
 // CC_FOR_EACH_XXX macros that call macro m with the first argument n, where n = [0, counter XXX ),
 // and the second argument arg.
@@ -5539,6 +16872,11 @@ CC_CAT_2( CC_R3_, d3 )( m, arg )               \
 #define CC_FOR_EACH_CMPR( m, arg ) CC_FOR_OCT_COUNT( m, arg, CC_N_CMPRS_D3, CC_N_CMPRS_D2, CC_N_CMPRS_D1 )
 #define CC_FOR_EACH_HASH( m, arg ) CC_FOR_OCT_COUNT( m, arg, CC_N_HASHS_D3, CC_N_HASHS_D2, CC_N_HASHS_D1 )
 #define CC_FOR_EACH_LOAD( m, arg ) CC_FOR_OCT_COUNT( m, arg, CC_N_LOADS_D3, CC_N_LOADS_D2, CC_N_LOADS_D1 )
+#define CC_FOR_EACH_VEC_GROWTH( m, arg )                                                  \
+CC_FOR_OCT_COUNT( m, arg, CC_N_VEC_GROWTHS_D3, CC_N_VEC_GROWTHS_D2, CC_N_VEC_GROWTHS_D1 ) \
+
+#define CC_FOR_EACH_CACHE_HASH( m, arg )                                                   \
+CC_FOR_OCT_COUNT( m, arg, CC_N_CACHE_HASHS_D3, CC_N_CACHE_HASHS_D2, CC_N_CACHE_HASHS_D1 ) \
 
 // Macros for inferring the destructor, comparison, or hash function or load factor associated with a container's
 // key or element type, as well as for determining whether a comparison or hash function exists for a type and inferring
@@ -5607,6 +16945,8 @@ std::is_same<CC_TYPEOF_XP(**arg), CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( arg ), cc_cmp
     cc_cmpr_size_t_select                                                                                  : \
   std::is_same<CC_TYPEOF_XP(**cntr), CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * )>::value             ? \
     cc_cmpr_c_string_select                                                                                : \
+  std::is_same<CC_TYPEOF_XP(**cntr), CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str )>::value             ? \
+    cc_cmpr_str_select                                                                                     : \
   cc_cmpr_dummy_select                                                                                       \
 )( CC_CNTR_ID( cntr ) )                                                                                      \
 
@@ -5645,9 +16985,51 @@ std::is_same<                                                \
     cc_hash_size_t                                                                                         : \
   std::is_same<CC_TYPEOF_XP(**cntr), CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * )>::value             ? \
     cc_hash_c_string                                                                                       : \
+  std::is_same<CC_TYPEOF_XP(**cntr), CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str )>::value             ? \
+    cc_hash_str                                                                                            : \
   (cc_hash_fnptr_ty)NULL                                                                                     \
 )                                                                                                            \
 
+#define CC_EL_CMPR_SLOT( n, arg ) std::is_same<arg, cc_cmpr_##n##_ty>::value ? cc_cmpr_##n##_fn_select :
+#define CC_EL_CMPR( cntr )                                                                        \
+(                                                                                                 \
+  CC_FOR_EACH_CMPR( CC_EL_CMPR_SLOT, CC_EL_TY( cntr ) )                                           \
+  std::is_same<CC_EL_TY( cntr ), char>::value               ? cc_cmpr_char_select :               \
+  std::is_same<CC_EL_TY( cntr ), unsigned char>::value      ? cc_cmpr_unsigned_char_select :      \
+  std::is_same<CC_EL_TY( cntr ), signed char>::value        ? cc_cmpr_signed_char_select :        \
+  std::is_same<CC_EL_TY( cntr ), unsigned short>::value     ? cc_cmpr_unsigned_short_select :     \
+  std::is_same<CC_EL_TY( cntr ), short>::value              ? cc_cmpr_short_select :              \
+  std::is_same<CC_EL_TY( cntr ), unsigned int>::value       ? cc_cmpr_unsigned_int_select :       \
+  std::is_same<CC_EL_TY( cntr ), int>::value                ? cc_cmpr_int_select :                \
+  std::is_same<CC_EL_TY( cntr ), unsigned long>::value      ? cc_cmpr_unsigned_long_select :      \
+  std::is_same<CC_EL_TY( cntr ), long>::value               ? cc_cmpr_long_select :               \
+  std::is_same<CC_EL_TY( cntr ), unsigned long long>::value ? cc_cmpr_unsigned_long_long_select : \
+  std::is_same<CC_EL_TY( cntr ), long long>::value          ? cc_cmpr_long_long_select :          \
+  std::is_same<CC_EL_TY( cntr ), size_t>::value             ? cc_cmpr_size_t_select :             \
+  std::is_same<CC_EL_TY( cntr ), char *>::value             ? cc_cmpr_c_string_select :           \
+  std::is_same<CC_EL_TY( cntr ), cc_str>::value             ? cc_cmpr_str_select :                \
+  cc_cmpr_dummy_select                                                                            \
+)( CC_CNTR_ID( cntr ) )                                                                           \
+
+#define CC_EL_RADIX_SLOT( n, arg ) std::is_same<arg, cc_cmpr_##n##_ty>::value ? CC_RADIX_NONE :
+#define CC_EL_RADIX( cntr )                                                                                            \
+(                                                                                                                      \
+  CC_FOR_EACH_CMPR( CC_EL_RADIX_SLOT, CC_EL_TY( cntr ) )                                                               \
+  std::is_same<CC_EL_TY( cntr ), char>::value               ? ( (char)-1 < 0 ? CC_RADIX_SIGNED : CC_RADIX_UNSIGNED ) : \
+  std::is_same<CC_EL_TY( cntr ), unsigned char>::value      ? CC_RADIX_UNSIGNED :                                      \
+  std::is_same<CC_EL_TY( cntr ), signed char>::value        ? CC_RADIX_SIGNED :                                        \
+  std::is_same<CC_EL_TY( cntr ), unsigned short>::value     ? CC_RADIX_UNSIGNED :                                      \
+  std::is_same<CC_EL_TY( cntr ), short>::value              ? CC_RADIX_SIGNED :                                        \
+  std::is_same<CC_EL_TY( cntr ), unsigned int>::value       ? CC_RADIX_UNSIGNED :                                      \
+  std::is_same<CC_EL_TY( cntr ), int>::value                ? CC_RADIX_SIGNED :                                        \
+  std::is_same<CC_EL_TY( cntr ), unsigned long>::value      ? CC_RADIX_UNSIGNED :                                      \
+  std::is_same<CC_EL_TY( cntr ), long>::value               ? CC_RADIX_SIGNED :                                        \
+  std::is_same<CC_EL_TY( cntr ), unsigned long long>::value ? CC_RADIX_UNSIGNED :                                      \
+  std::is_same<CC_EL_TY( cntr ), long long>::value          ? CC_RADIX_SIGNED :                                        \
+  std::is_same<CC_EL_TY( cntr ), size_t>::value             ? CC_RADIX_UNSIGNED :                                      \
+  CC_RADIX_NONE                                                                                                        \
+)                                                                                                                      \
+
 #define CC_HAS_CMPR_SLOT( n, arg ) std::is_same<arg, cc_cmpr_##n##_ty>::value ? true :
 #define CC_HAS_CMPR( ty )                              \
 (                                                      \
@@ -5664,6 +17046,7 @@ std::is_same<                                                \
   std::is_same<ty, signed long long>::value   ? true : \
   std::is_same<ty, size_t>::value             ? true : \
   std::is_same<ty, char *>::value             ? true : \
+  std::is_same<ty, cc_str>::value             ? true : \
   CC_FOR_EACH_CMPR( CC_HAS_CMPR_SLOT, ty )             \
   false                                                \
 )                                                      \
@@ -5684,6 +17067,7 @@ std::is_same<                                                \
   std::is_same<ty, signed long long>::value   ? true : \
   std::is_same<ty, size_t>::value             ? true : \
   std::is_same<ty, char *>::value             ? true : \
+  std::is_same<ty, cc_str>::value             ? true : \
   CC_FOR_EACH_HASH( CC_HAS_HASH_SLOT, ty )             \
   false                                                \
 )                                                      \
@@ -5700,13 +17084,53 @@ std::is_same<                                                \
   CC_DEFAULT_LOAD                            \
 )                                            \
 
-#define CC_LAYOUT( cntr )                                                        \
-cc_layout(                                                                       \
-  CC_CNTR_ID( cntr ),                                                            \
-  CC_EL_SIZE( cntr ),                                                            \
-  alignof( CC_EL_TY( cntr ) ),                                                   \
-  cc_key_details_ty{ sizeof( CC_KEY_TY( cntr ) ), alignof( CC_KEY_TY( cntr ) ) } \
-)                                                                                \
+#define CC_EL_VEC_GROWTH_SLOT( n, arg ) std::is_same<arg, cc_vec_growth_##n##_ty>::value ? cc_vec_growth_##n##_val :
+#define CC_EL_VEC_GROWTH( cntr )                                     \
+(                                                                    \
+  CC_FOR_EACH_VEC_GROWTH( CC_EL_VEC_GROWTH_SLOT, CC_EL_TY( cntr ) ) \
+  CC_DEFAULT_VEC_GROWTH                                              \
+)                                                                    \
+
+#define CC_KEY_CACHE_HASH_SLOT( n, arg )                           \
+std::is_same<                                                      \
+  CC_TYPEOF_XP(**arg),                                             \
+  CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( arg ), cc_cache_hash_##n##_ty ) \
+>::value ? true :                                                  \
+
+#define CC_KEY_CACHE_HASH( cntr )                        \
+(                                                        \
+  CC_FOR_EACH_CACHE_HASH( CC_KEY_CACHE_HASH_SLOT, cntr ) \
+  false                                                  \
+)                                                        \
+
+// Mirrors the is_integer member that CC_KEY_DETAILS infers in C (see cc_key_details_ty).
+#define CC_KEY_IS_INTEGER_SLOT( n, arg ) std::is_same<arg, cc_cmpr_##n##_ty>::value ? false :
+#define CC_KEY_IS_INTEGER( cntr )                                     \
+(                                                                     \
+  CC_FOR_EACH_CMPR( CC_KEY_IS_INTEGER_SLOT, CC_KEY_TY( cntr ) )       \
+  std::is_same<CC_KEY_TY( cntr ), char>::value               ? true : \
+  std::is_same<CC_KEY_TY( cntr ), unsigned char>::value      ? true : \
+  std::is_same<CC_KEY_TY( cntr ), signed char>::value        ? true : \
+  std::is_same<CC_KEY_TY( cntr ), unsigned short>::value     ? true : \
+  std::is_same<CC_KEY_TY( cntr ), short>::value              ? true : \
+  std::is_same<CC_KEY_TY( cntr ), unsigned int>::value       ? true : \
+  std::is_same<CC_KEY_TY( cntr ), int>::value                ? true : \
+  std::is_same<CC_KEY_TY( cntr ), unsigned long>::value      ? true : \
+  std::is_same<CC_KEY_TY( cntr ), long>::value               ? true : \
+  std::is_same<CC_KEY_TY( cntr ), unsigned long long>::value ? true : \
+  std::is_same<CC_KEY_TY( cntr ), long long>::value          ? true : \
+  std::is_same<CC_KEY_TY( cntr ), size_t>::value             ? true : \
+  false                                                               \
+)                                                                     \
+
+#define CC_LAYOUT( cntr )                                                                                    \
+cc_layout(                                                                                                   \
+  CC_CNTR_ID( cntr ),                                                                                        \
+  CC_EL_SIZE( cntr ),                                                                                        \
+  alignof( CC_EL_TY( cntr ) ),                                                                               \
+  cc_key_details_ty{ sizeof( CC_KEY_TY( cntr ) ), alignof( CC_KEY_TY( cntr ) ), CC_KEY_IS_INTEGER( cntr ) }, \
+  CC_KEY_CACHE_HASH( cntr )                                                                                  \
+)                                                                                                            \
 
 #else
 
@@ -5742,6 +17166,7 @@ _Generic( (**cntr),
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long long ):          cc_cmpr_long_long_select,          \
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_size_t ):    cc_cmpr_size_t_select,             \
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * ):             cc_cmpr_c_string_select,           \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str ):             cc_cmpr_str_select,                \
     default: cc_cmpr_dummy_select                                                                     \
   )                                                                                                   \
 )( CC_CNTR_ID( cntr ) )                                                                               \
@@ -5764,10 +17189,55 @@ _Generic( (**cntr),
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long long ):          cc_hash_long_long,          \
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_size_t ):    cc_hash_size_t,             \
     CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * ):             cc_hash_c_string,           \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str ):             cc_hash_str,                \
     default: (cc_hash_fnptr_ty)NULL                                                            \
   )                                                                                            \
 )                                                                                              \
 
+#define CC_EL_CMPR_SLOT( n, arg ) cc_cmpr_##n##_ty: cc_cmpr_##n##_fn_select,
+#define CC_EL_CMPR( cntr )                                 \
+_Generic( (CC_EL_TY( cntr )){ 0 },                         \
+  CC_FOR_EACH_CMPR( CC_EL_CMPR_SLOT, )                     \
+  default: _Generic( (CC_EL_TY( cntr )){ 0 },              \
+    cc_maybe_char:      cc_cmpr_char_select,               \
+    unsigned char:      cc_cmpr_unsigned_char_select,      \
+    signed char:        cc_cmpr_signed_char_select,        \
+    unsigned short:     cc_cmpr_unsigned_short_select,     \
+    short:              cc_cmpr_short_select,              \
+    unsigned int:       cc_cmpr_unsigned_int_select,       \
+    int:                cc_cmpr_int_select,                \
+    unsigned long:      cc_cmpr_unsigned_long_select,      \
+    long:               cc_cmpr_long_select,               \
+    unsigned long long: cc_cmpr_unsigned_long_long_select, \
+    long long:          cc_cmpr_long_long_select,          \
+    cc_maybe_size_t:    cc_cmpr_size_t_select,             \
+    char *:             cc_cmpr_c_string_select,           \
+    cc_str:             cc_cmpr_str_select,                \
+    default: cc_cmpr_dummy_select                          \
+  )                                                        \
+)( CC_CNTR_ID( cntr ) )                                    \
+
+#define CC_EL_RADIX_SLOT( n, arg ) cc_cmpr_##n##_ty: CC_RADIX_NONE,
+#define CC_EL_RADIX( cntr )                                                     \
+_Generic( (CC_EL_TY( cntr )){ 0 },                                              \
+  CC_FOR_EACH_CMPR( CC_EL_RADIX_SLOT, )                                         \
+  default: _Generic( (CC_EL_TY( cntr )){ 0 },                                   \
+    cc_maybe_char:      ( (char)-1 < 0 ? CC_RADIX_SIGNED : CC_RADIX_UNSIGNED ), \
+    unsigned char:      CC_RADIX_UNSIGNED,                                      \
+    signed char:        CC_RADIX_SIGNED,                                        \
+    unsigned short:     CC_RADIX_UNSIGNED,                                      \
+    short:              CC_RADIX_SIGNED,                                        \
+    unsigned int:       CC_RADIX_UNSIGNED,                                      \
+    int:                CC_RADIX_SIGNED,                                        \
+    unsigned long:      CC_RADIX_UNSIGNED,                                      \
+    long:               CC_RADIX_SIGNED,                                        \
+    unsigned long long: CC_RADIX_UNSIGNED,                                      \
+    long long:          CC_RADIX_SIGNED,                                        \
+    cc_maybe_size_t:    CC_RADIX_UNSIGNED,                                      \
+    default: CC_RADIX_NONE                                                      \
+  )                                                                             \
+)                                                                               \
+
 #define CC_HAS_CMPR_SLOT( n, arg ) cc_cmpr_##n##_ty: true,
 #define CC_HAS_CMPR( ty )               \
 _Generic( (ty){ 0 },                    \
@@ -5786,6 +17256,7 @@ _Generic( (ty){ 0 },                    \
     long long:          true,           \
     cc_maybe_size_t:    true,           \
     char *:             true,           \
+    cc_str:             true,           \
     default:            false           \
   )                                     \
 )                                       \
@@ -5808,6 +17279,7 @@ _Generic( (ty){ 0 },                    \
     long long:          true,           \
     cc_maybe_size_t:    true,           \
     char *:             true,           \
+    cc_str:             true,           \
     default:            false           \
   )                                     \
 )                                       \
@@ -5819,46 +17291,68 @@ _Generic( (**cntr),                                      \
   default: CC_DEFAULT_LOAD                               \
 )                                                        \
 
-#define CC_KEY_DETAILS_SLOT( n, arg )                                               \
-CC_MAKE_BASE_FNPTR_TY( arg, cc_cmpr_##n##_ty ):                                     \
-  ( cc_key_details_ty ){ sizeof( cc_cmpr_##n##_ty ), alignof( cc_cmpr_##n##_ty ) }, \
-
-#define CC_KEY_DETAILS( cntr )                                                              \
-_Generic( (**cntr),                                                                         \
-  CC_FOR_EACH_CMPR( CC_KEY_DETAILS_SLOT, CC_EL_TY( cntr ) )                                 \
-  default: _Generic( (**cntr),                                                              \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_char ):                               \
-      ( cc_key_details_ty ){ sizeof( char ), alignof( char ) },                             \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned char ) :                              \
-      ( cc_key_details_ty ){ sizeof( unsigned char ), alignof( unsigned char ) },           \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), signed char ) :                                \
-      ( cc_key_details_ty ){ sizeof( signed char ), alignof( signed char ) },               \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned short ) :                             \
-      ( cc_key_details_ty ){ sizeof( unsigned short ), alignof( unsigned short ) },         \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), short ) :                                      \
-      ( cc_key_details_ty ){ sizeof( short ), alignof( short ) },                           \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned int ) :                               \
-      ( cc_key_details_ty ){ sizeof( unsigned int ), alignof( unsigned int ) },             \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), int ) :                                        \
-      ( cc_key_details_ty ){ sizeof( int ), alignof( int ) },                               \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned long ):                               \
-      ( cc_key_details_ty ){ sizeof( unsigned long ), alignof( unsigned long ) },           \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long ):                                        \
-      ( cc_key_details_ty ){ sizeof( long ), alignof( long ) },                             \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned long long ):                          \
-      ( cc_key_details_ty ){ sizeof( unsigned long long ), alignof( unsigned long long ) }, \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long long ):                                   \
-      ( cc_key_details_ty ){ sizeof( long long ), alignof( long long ) },                   \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_size_t ):                             \
-      ( cc_key_details_ty ){ sizeof( size_t ), alignof( size_t ) },                         \
-    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * ):                                      \
-      ( cc_key_details_ty ){ sizeof( char * ), alignof( char * ) },                         \
-    default: ( cc_key_details_ty ){ 0 }                                                     \
-  )                                                                                         \
-)                                                                                           \
+#define CC_EL_VEC_GROWTH_SLOT( n, arg ) cc_vec_growth_##n##_ty: cc_vec_growth_##n##_val,
+#define CC_EL_VEC_GROWTH( cntr )                   \
+_Generic( (CC_EL_TY( cntr )){ 0 },                 \
+  CC_FOR_EACH_VEC_GROWTH( CC_EL_VEC_GROWTH_SLOT, ) \
+  default: CC_DEFAULT_VEC_GROWTH                   \
+)                                                  \
+
+#define CC_KEY_DETAILS_SLOT( n, arg )                                                      \
+CC_MAKE_BASE_FNPTR_TY( arg, cc_cmpr_##n##_ty ):                                            \
+  ( cc_key_details_ty ){ sizeof( cc_cmpr_##n##_ty ), alignof( cc_cmpr_##n##_ty ), false }, \
+
+#define CC_KEY_DETAILS( cntr )                                                                    \
+_Generic( (**cntr),                                                                               \
+  CC_FOR_EACH_CMPR( CC_KEY_DETAILS_SLOT, CC_EL_TY( cntr ) )                                       \
+  default: _Generic( (**cntr),                                                                    \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_char ):                                     \
+      ( cc_key_details_ty ){ sizeof( char ), alignof( char ), true },                             \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned char ) :                                    \
+      ( cc_key_details_ty ){ sizeof( unsigned char ), alignof( unsigned char ), true },           \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), signed char ) :                                      \
+      ( cc_key_details_ty ){ sizeof( signed char ), alignof( signed char ), true },               \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned short ) :                                   \
+      ( cc_key_details_ty ){ sizeof( unsigned short ), alignof( unsigned short ), true },         \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), short ) :                                            \
+      ( cc_key_details_ty ){ sizeof( short ), alignof( short ), true },                           \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned int ) :                                     \
+      ( cc_key_details_ty ){ sizeof( unsigned int ), alignof( unsigned int ), true },             \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), int ) :                                              \
+      ( cc_key_details_ty ){ sizeof( int ), alignof( int ), true },                               \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned long ):                                     \
+      ( cc_key_details_ty ){ sizeof( unsigned long ), alignof( unsigned long ), true },           \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long ):                                              \
+      ( cc_key_details_ty ){ sizeof( long ), alignof( long ), true },                             \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), unsigned long long ):                                \
+      ( cc_key_details_ty ){ sizeof( unsigned long long ), alignof( unsigned long long ), true }, \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), long long ):                                         \
+      ( cc_key_details_ty ){ sizeof( long long ), alignof( long long ), true },                   \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_maybe_size_t ):                                   \
+      ( cc_key_details_ty ){ sizeof( size_t ), alignof( size_t ), true },                         \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), char * ):                                            \
+      ( cc_key_details_ty ){ sizeof( char * ), alignof( char * ), false },                        \
+    CC_MAKE_BASE_FNPTR_TY( CC_EL_TY( cntr ), cc_str ):                                            \
+      ( cc_key_details_ty ){ sizeof( cc_str ), alignof( cc_str ), false },                        \
+    default: ( cc_key_details_ty ){ 0 }                                                           \
+  )                                                                                               \
+)                                                                                                 \
 
-#define CC_LAYOUT( cntr )                                                                                \
-cc_layout( CC_CNTR_ID( cntr ), CC_EL_SIZE( cntr ), alignof( CC_EL_TY( cntr ) ), CC_KEY_DETAILS( cntr ) ) \
+#define CC_KEY_CACHE_HASH_SLOT( n, arg ) CC_MAKE_BASE_FNPTR_TY( arg, cc_cache_hash_##n##_ty ): true,
+#define CC_KEY_CACHE_HASH( cntr )                                    \
+_Generic( (**cntr),                                                  \
+  CC_FOR_EACH_CACHE_HASH( CC_KEY_CACHE_HASH_SLOT, CC_EL_TY( cntr ) ) \
+  default: false                                                     \
+)                                                                    \
+
+#define CC_LAYOUT( cntr )     \
+cc_layout(                    \
+  CC_CNTR_ID( cntr ),         \
+  CC_EL_SIZE( cntr ),         \
+  alignof( CC_EL_TY( cntr ) ),\
+  CC_KEY_DETAILS( cntr ),     \
+  CC_KEY_CACHE_HASH( cntr )   \
+)                             \
 
 #endif
 
@@ -5911,7 +17405,8 @@ static inline int cc_cmpr_##name##_equal( void *void_val_1, void *void_val_2 )
                                                                                                        \
 static inline CC_ALWAYS_INLINE cc_cmpr_fnptr_ty cc_cmpr_##name##_select( size_t cntr_id )              \
 {                                                                                                      \
-  return cntr_id == CC_MAP || cntr_id == CC_SET ? cc_cmpr_##name##_equal : cc_cmpr_##name##_three_way; \
+  return cntr_id == CC_MAP || cntr_id == CC_SET || cntr_id == CC_CMAP ?                                \
+    cc_cmpr_##name##_equal : cc_cmpr_##name##_three_way;                                               \
 }                                                                                                      \
                                                                                                        \
 static inline size_t cc_hash_##name( void *void_val )                                                  \
@@ -5972,9 +17467,72 @@ typedef CC_TYPEOF_XP(
 
 #endif
 
+// Mixing primitives shared by the string hash functions below, adapted from wyhash
+// (https://github.com/wangyi-fudan/wyhash).
+// cc_wymum replaces a and b with the low and high halves of their 128-bit product, and cc_wymix folds that product into
+// 64 bits.
+
+#define CC_WYHASH_SECRET_0 0x2D358DCCAA6C78A5ULL
+#define CC_WYHASH_SECRET_1 0x8BB84B93962EACC9ULL
+#define CC_WYHASH_SECRET_2 0x4B33A62ED433D4A3ULL
+#define CC_WYHASH_SECRET_3 0x4D5A2DA51DE1AA47ULL
+
+static inline void cc_wymum( uint64_t *a, uint64_t *b )
+{
+#if defined( __SIZEOF_INT128__ )
+  __uint128_t product = (__uint128_t)*a * *b;
+  *a = (uint64_t)product;
+  *b = (uint64_t)( product >> 64 );
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+  *a = _umul128( *a, *b, b );
+#else
+  uint64_t a_high = *a >> 32, a_low = (uint32_t)*a, b_high = *b >> 32, b_low = (uint32_t)*b;
+  uint64_t cross_1 = a_high * b_low;
+  uint64_t cross_2 = a_low * b_high;
+  uint64_t low = a_low * b_low;
+  uint64_t low_plus_cross_1 = low + ( cross_1 << 32 );
+  uint64_t carry = low_plus_cross_1 < low;
+  *a = low_plus_cross_1 + ( cross_2 << 32 );
+  carry += *a < low_plus_cross_1;
+  *b = a_high * b_high + ( cross_1 >> 32 ) + ( cross_2 >> 32 ) + carry;
+#endif
+}
+
+static inline uint64_t cc_wymix( uint64_t a, uint64_t b )
+{
+  cc_wymum( &a, &b );
+  return a ^ b;
+}
+
+// Reduces a 64-bit hash code to a size_t.
+static inline size_t cc_fold_hash( uint64_t hash )
+{
+#if SIZE_MAX == 0xFFFFFFFF
+  return (size_t)( hash - ( hash >> 32 ) );
+#else
+  return (size_t)hash;
+#endif
+}
+
 // Null-terminated C strings.
-// We use FNV-1a because newer, faster alternatives that process word-sized chunks require prior knowledge of the
-// string's length.
+// Because the string's length isn't known in advance, we hash it one (unaligned) word at a time and detect the null
+// terminator inside each word via SWAR zero-byte detection.
+// Loading a whole word may read past the terminator.
+// That is harmless as long as the load doesn't cross into another, possibly unmapped, page, so a word that straddles a
+// boundary between 4096-byte pages (the smallest page size in common use) is instead loaded byte by byte.
+// Because words are counted from the start of the string, not from an alignment boundary, the hash code doesn't depend
+// on where the string is stored.
+// AddressSanitizer would flag the harmless overreads, so the function is exempt from its instrumentation.
+
+#define CC_MIN_PAGE_SIZE 4096
+
+#if defined( __GNUC__ ) && ( defined( __SANITIZE_ADDRESS__ ) || defined( __clang__ ) )
+#define CC_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined( _MSC_VER ) && defined( __SANITIZE_ADDRESS__ )
+#define CC_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#else
+#define CC_NO_SANITIZE_ADDRESS
+#endif
 
 static inline int cc_cmpr_c_string_three_way( void *void_val_1, void *void_val_2 )
 {
@@ -5988,46 +17546,171 @@ static inline int cc_cmpr_c_string_equal( void *void_val_1, void *void_val_2 )
 
 static inline cc_cmpr_fnptr_ty cc_cmpr_c_string_select( size_t cntr_id )                               \
 {                                                                                                      \
-  return cntr_id == CC_MAP || cntr_id == CC_SET ? cc_cmpr_c_string_equal : cc_cmpr_c_string_three_way; \
+  return cntr_id == CC_MAP || cntr_id == CC_SET || cntr_id == CC_CMAP ?                                \
+    cc_cmpr_c_string_equal : cc_cmpr_c_string_three_way;                                               \
 }                                                                                                      \
 
-#if SIZE_MAX == 0xFFFFFFFF // 32-bit size_t.
+// Returns a word whose zero bytes in the given word are set to 0x80 and whose other bytes are set to zero.
+static inline uint64_t cc_zero_bytes( uint64_t word )
+{
+  return ~( ( ( word & 0x7F7F7F7F7F7F7F7FULL ) + 0x7F7F7F7F7F7F7F7FULL ) | word | 0x7F7F7F7F7F7F7F7FULL );
+}
+
+// Clears the bytes of a word that lie at or after its first zero byte in memory order, given the result of
+// cc_zero_bytes.
+static inline uint64_t cc_truncate_word_at_zero_byte( uint64_t word, uint64_t zero_bytes )
+{
+  if( cc_is_little_endian() )
+    return word & ( ( ( zero_bytes & ( ~zero_bytes + 1 ) ) >> 7 ) - 1 );
+
+  zero_bytes |= zero_bytes >> 8;
+  zero_bytes |= zero_bytes >> 16;
+  zero_bytes |= zero_bytes >> 32;
+  return word & ~( ( zero_bytes >> 7 ) * 0xFF );
+}
 
-static inline size_t cc_hash_c_string( void *void_val )
+static inline CC_NO_SANITIZE_ADDRESS size_t cc_hash_c_string( void *void_val )
 {
-    char *val = *(char **)void_val;
-    size_t hash = 0x01000193;
-    while( *val )
-      hash = ( (unsigned char)*val++ ^ hash ) * 0x811C9DC5;
+  const char *val = *(char **)void_val;
+  uint64_t hash = CC_WYHASH_SECRET_0;
+
+  while( true )
+  {
+    uint64_t word = 0;
+    bool is_last_word;
+
+    if( CC_LIKELY(
+      ( (uintptr_t)val & ( CC_MIN_PAGE_SIZE - 1 ) ) <= CC_MIN_PAGE_SIZE - sizeof( uint64_t )
+    ) )
+    {
+      memcpy( &word, val, sizeof( uint64_t ) );
+      uint64_t zero_bytes = cc_zero_bytes( word );
+      is_last_word = zero_bytes;
+      if( is_last_word )
+        word = cc_truncate_word_at_zero_byte( word, zero_bytes );
+    }
+    else
+    {
+      size_t len = 0;
+      while( len < sizeof( uint64_t ) && val[ len ] )
+        ++len;
+
+      memcpy( &word, val, len );
+      is_last_word = len < sizeof( uint64_t );
+    }
+
+    hash = cc_wymix( word ^ CC_WYHASH_SECRET_1, hash );
+    if( is_last_word )
+      return cc_fold_hash( cc_wymix( hash ^ CC_WYHASH_SECRET_2, CC_WYHASH_SECRET_3 ) );
 
-    return hash;
+    val += sizeof( uint64_t );
+  }
 }
 
-#elif SIZE_MAX == 0xFFFFFFFFFFFFFFFF // 64-bit size_t.
+// Length-aware strings (see cc_str in the API documentation).
+// As the length is known, these are hashed via wyhash, which consumes up to 48 bytes per round without examining them
+// for a terminator.
+
+typedef struct
+{
+  char *data;
+  size_t len;
+} cc_str;
 
-static inline size_t cc_hash_c_string( void *void_val )
+static inline uint64_t cc_read_uint64( const unsigned char *ptr )
 {
-    char *val = *(char **)void_val;
-    size_t hash = 0xCBF29CE484222325;
-    while( *val )
-      hash = ( (unsigned char)*val++ ^ hash ) * 0x100000001B3;
+  uint64_t val;
+  memcpy( &val, ptr, sizeof( uint64_t ) );
+  return val;
+}
 
-    return hash;
+static inline uint64_t cc_read_uint32( const unsigned char *ptr )
+{
+  uint32_t val;
+  memcpy( &val, ptr, sizeof( uint32_t ) );
+  return val;
 }
 
-#else // Strange size_t.
+static inline int cc_cmpr_str_three_way( void *void_val_1, void *void_val_2 )
+{
+  cc_str *val_1 = (cc_str *)void_val_1;
+  cc_str *val_2 = (cc_str *)void_val_2;
+  int result = memcmp( val_1->data, val_2->data, val_1->len < val_2->len ? val_1->len : val_2->len );
+  return result ? result : ( val_1->len > val_2->len ) - ( val_1->len < val_2->len );
+}
 
-static inline size_t cc_hash_c_string( void *void_val )
+static inline int cc_cmpr_str_equal( void *void_val_1, void *void_val_2 )
 {
-    char *val = *(char **)void_val;
-    size_t hash = 0;
-    while( *val )
-        hash = hash * 131 + (unsigned char)*val++;
+  cc_str *val_1 = (cc_str *)void_val_1;
+  cc_str *val_2 = (cc_str *)void_val_2;
+  return val_1->len == val_2->len && memcmp( val_1->data, val_2->data, val_1->len ) == 0;
+}
 
-    return hash;
+static inline cc_cmpr_fnptr_ty cc_cmpr_str_select( size_t cntr_id )
+{
+  return cntr_id == CC_MAP || cntr_id == CC_SET || cntr_id == CC_CMAP ?
+    cc_cmpr_str_equal : cc_cmpr_str_three_way;
 }
 
-#endif
+static inline size_t cc_hash_str( void *void_val )
+{
+  const unsigned char *data = (const unsigned char *)( (cc_str *)void_val )->data;
+  size_t len = ( (cc_str *)void_val )->len;
+  uint64_t seed = cc_wymix( CC_WYHASH_SECRET_0, CC_WYHASH_SECRET_1 );
+  uint64_t a;
+  uint64_t b;
+
+  if( len <= 16 )
+  {
+    if( len >= 4 )
+    {
+      a = ( cc_read_uint32( data ) << 32 ) | cc_read_uint32( data + ( ( len >> 3 ) << 2 ) );
+      b = ( cc_read_uint32( data + len - 4 ) << 32 ) | cc_read_uint32( data + len - 4 - ( ( len >> 3 ) << 2 ) );
+    }
+    else if( len > 0 )
+    {
+      a = ( (uint64_t)data[ 0 ] << 16 ) | ( (uint64_t)data[ len >> 1 ] << 8 ) | data[ len - 1 ];
+      b = 0;
+    }
+    else
+      a = b = 0;
+  }
+  else
+  {
+    size_t remaining = len;
+    if( remaining > 48 )
+    {
+      uint64_t seed_1 = seed;
+      uint64_t seed_2 = seed;
+      do
+      {
+        seed = cc_wymix( cc_read_uint64( data ) ^ CC_WYHASH_SECRET_1, cc_read_uint64( data + 8 ) ^ seed );
+        seed_1 = cc_wymix( cc_read_uint64( data + 16 ) ^ CC_WYHASH_SECRET_2, cc_read_uint64( data + 24 ) ^ seed_1 );
+        seed_2 = cc_wymix( cc_read_uint64( data + 32 ) ^ CC_WYHASH_SECRET_3, cc_read_uint64( data + 40 ) ^ seed_2 );
+        data += 48;
+        remaining -= 48;
+      }
+      while( remaining > 48 );
+
+      seed ^= seed_1 ^ seed_2;
+    }
+
+    while( remaining > 16 )
+    {
+      seed = cc_wymix( cc_read_uint64( data ) ^ CC_WYHASH_SECRET_1, cc_read_uint64( data + 8 ) ^ seed );
+      data += 16;
+      remaining -= 16;
+    }
+
+    a = cc_read_uint64( data + remaining - 16 );
+    b = cc_read_uint64( data + remaining - 8 );
+  }
+
+  a ^= CC_WYHASH_SECRET_1;
+  b ^= seed;
+  cc_wymum( &a, &b );
+  return cc_fold_hash( cc_wymix( a ^ CC_WYHASH_SECRET_0 ^ len, b ^ CC_WYHASH_SECRET_1 ) );
+}
 
 // Dummy for containers with no comparison function.
 static inline CC_ALWAYS_INLINE cc_cmpr_fnptr_ty cc_cmpr_dummy_select( CC_UNUSED( size_t, cntr_id ) )
@@ -6158,7 +17841,7 @@ static inline int CC_CAT_3( cc_cmpr_, CC_N_CMPRS, _fn_equals )( void *void_val_1
 
 static inline CC_ALWAYS_INLINE cc_cmpr_fnptr_ty CC_CAT_3( cc_cmpr_, CC_N_CMPRS, _fn_select )( size_t cntr_id )
 {
-  return cntr_id == CC_MAP || cntr_id == CC_SET ?
+  return cntr_id == CC_MAP || cntr_id == CC_SET || cntr_id == CC_CMAP ?
     CC_CAT_3( cc_cmpr_, CC_N_CMPRS, _fn_equals )
     :
     CC_CAT_3( cc_cmpr_, CC_N_CMPRS, _fn_three_way );
@@ -6414,4 +18097,173 @@ const double CC_CAT_3( cc_load_, CC_N_LOADS, _val ) = CC_OTHER_ARGS( CC_LOAD );
 #undef CC_LOAD
 #endif
 
+#ifdef CC_VEC_GROWTH
+
+typedef CC_TYPEOF_TY( CC_1ST_ARG( CC_VEC_GROWTH ) ) CC_CAT_3( cc_vec_growth_, CC_N_VEC_GROWTHS, _ty );
+
+const double CC_CAT_3( cc_vec_growth_, CC_N_VEC_GROWTHS, _val ) = CC_OTHER_ARGS( CC_VEC_GROWTH );
+
+#if CC_N_VEC_GROWTHS_D1 == 0
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 1
+#elif CC_N_VEC_GROWTHS_D1 == 1
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 2
+#elif CC_N_VEC_GROWTHS_D1 == 2
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 3
+#elif CC_N_VEC_GROWTHS_D1 == 3
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 4
+#elif CC_N_VEC_GROWTHS_D1 == 4
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 5
+#elif CC_N_VEC_GROWTHS_D1 == 5
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 6
+#elif CC_N_VEC_GROWTHS_D1 == 6
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 7
+#elif CC_N_VEC_GROWTHS_D1 == 7
+#undef CC_N_VEC_GROWTHS_D1
+#define CC_N_VEC_GROWTHS_D1 0
+#if CC_N_VEC_GROWTHS_D2 == 0
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 1
+#elif CC_N_VEC_GROWTHS_D2 == 1
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 2
+#elif CC_N_VEC_GROWTHS_D2 == 2
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 3
+#elif CC_N_VEC_GROWTHS_D2 == 3
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 4
+#elif CC_N_VEC_GROWTHS_D2 == 4
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 5
+#elif CC_N_VEC_GROWTHS_D2 == 5
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 6
+#elif CC_N_VEC_GROWTHS_D2 == 6
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 7
+#elif CC_N_VEC_GROWTHS_D2 == 7
+#undef CC_N_VEC_GROWTHS_D2
+#define CC_N_VEC_GROWTHS_D2 0
+#if CC_N_VEC_GROWTHS_D3 == 0
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 1
+#elif CC_N_VEC_GROWTHS_D3 == 1
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 2
+#elif CC_N_VEC_GROWTHS_D3 == 2
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 3
+#elif CC_N_VEC_GROWTHS_D3 == 3
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 4
+#elif CC_N_VEC_GROWTHS_D3 == 4
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 5
+#elif CC_N_VEC_GROWTHS_D3 == 5
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 6
+#elif CC_N_VEC_GROWTHS_D3 == 6
+#undef CC_N_VEC_GROWTHS_D3
+#define CC_N_VEC_GROWTHS_D3 7
+#elif CC_N_VEC_GROWTHS_D3 == 7
+#error Sorry, the number of growth factors is limited to 511.
+#endif
+#endif
+#endif
+
+#undef CC_VEC_GROWTH
+#endif
+
+#ifdef CC_CACHE_HASH
+
+// Convert the user-defined CC_CACHE_HASH macro into a cc_cache_hash_XXXX_ty that can be plugged into the
+// CC_KEY_CACHE_HASH macro above.
+
+typedef CC_TYPEOF_TY( CC_CACHE_HASH ) CC_CAT_3( cc_cache_hash_, CC_N_CACHE_HASHS, _ty );
+
+#if CC_N_CACHE_HASHS_D1 == 0
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 1
+#elif CC_N_CACHE_HASHS_D1 == 1
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 2
+#elif CC_N_CACHE_HASHS_D1 == 2
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 3
+#elif CC_N_CACHE_HASHS_D1 == 3
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 4
+#elif CC_N_CACHE_HASHS_D1 == 4
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 5
+#elif CC_N_CACHE_HASHS_D1 == 5
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 6
+#elif CC_N_CACHE_HASHS_D1 == 6
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 7
+#elif CC_N_CACHE_HASHS_D1 == 7
+#undef CC_N_CACHE_HASHS_D1
+#define CC_N_CACHE_HASHS_D1 0
+#if CC_N_CACHE_HASHS_D2 == 0
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 1
+#elif CC_N_CACHE_HASHS_D2 == 1
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 2
+#elif CC_N_CACHE_HASHS_D2 == 2
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 3
+#elif CC_N_CACHE_HASHS_D2 == 3
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 4
+#elif CC_N_CACHE_HASHS_D2 == 4
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 5
+#elif CC_N_CACHE_HASHS_D2 == 5
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 6
+#elif CC_N_CACHE_HASHS_D2 == 6
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 7
+#elif CC_N_CACHE_HASHS_D2 == 7
+#undef CC_N_CACHE_HASHS_D2
+#define CC_N_CACHE_HASHS_D2 0
+#if CC_N_CACHE_HASHS_D3 == 0
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 1
+#elif CC_N_CACHE_HASHS_D3 == 1
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 2
+#elif CC_N_CACHE_HASHS_D3 == 2
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 3
+#elif CC_N_CACHE_HASHS_D3 == 3
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 4
+#elif CC_N_CACHE_HASHS_D3 == 4
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 5
+#elif CC_N_CACHE_HASHS_D3 == 5
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 6
+#elif CC_N_CACHE_HASHS_D3 == 6
+#undef CC_N_CACHE_HASHS_D3
+#define CC_N_CACHE_HASHS_D3 7
+#elif CC_N_CACHE_HASHS_D3 == 7
+#error Sorry, the number of hash-caching declarations is limited to 511.
+#endif
+#endif
+#endif
+
+#undef CC_CACHE_HASH
+#endif
+
 #endif
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# Builds the benchmarks and runs the benchmark suite, comparing its results against a baseline.
+#
+# Usage: ./run_benchmarks.sh [BASELINE]
+#
+# BASELINE is either the CSV output of an earlier run of bench_suite or a git revision (e.g. origin/main).
+# In the latter case, the suite is first built against that revision's cc.h and run on this machine to produce the
+# baseline, so that both sets of results are measured under the same conditions.
+# Without a baseline, the results are recorded in bench_results.csv but not compared.
+# Additional arguments to bench_suite can be supplied via BENCH_ARGS.
+# The exit status is 2 if any CC result regressed.
+
+set -e
+
+CXX=${CXX:-clang++}
+CXXFLAGS="-std=c++11 -O3 -Wall"
+BENCH_ARGS=${BENCH_ARGS:-"--keys 200000 --runs 10 --warmup 2"}
+
+# Pin the suite to the last CPU, which is the least likely to be servicing interrupts.
+BENCH_ARGS="$BENCH_ARGS --cpu $(( $(nproc) - 1 ))"
+
+# Build the standalone benchmarks too, so that they keep compiling.
+$CXX $CXXFLAGS ../benchmarks/map_and_set/bench_map_and_set.cpp -pthread -o bench_map_and_set
+$CXX $CXXFLAGS ../benchmarks/omap_and_oset/bench_omap_and_oset.cpp -o bench_omap_and_oset
+
+$CXX $CXXFLAGS ../benchmarks/suite/bench_suite.cpp -o bench_suite
+
+if [ -z "$1" ]; then
+  ./bench_suite $BENCH_ARGS > bench_results.csv
+  exit 0
+fi
+
+if [ -f "$1" ]; then
+  baseline=$1
+else
+  # Build the current suite against the revision's cc.h, which it includes via ../../cc.h.
+  tmp=$(mktemp -d)
+  trap 'rm -rf "$tmp"' EXIT
+  mkdir -p "$tmp/benchmarks/suite"
+  git show "$1:cc.h" > "$tmp/cc.h"
+  cp ../benchmarks/suite/bench_suite.cpp "$tmp/benchmarks/suite/"
+  $CXX $CXXFLAGS "$tmp/benchmarks/suite/bench_suite.cpp" -o bench_suite_baseline
+  ./bench_suite_baseline $BENCH_ARGS > bench_baseline.csv
+  baseline=bench_baseline.csv
+fi
+
+./bench_suite $BENCH_ARGS --baseline "$baseline" > bench_results.csv
@@ -5,5 +5,11 @@ set -e
 clang -Wall unit_tests.c -o unit_tests
 ./unit_tests
 
+# Rerun the unit tests with the optional features that change container internals enabled, along with the tests that
+# access concurrent maps and rings from several threads at once.
+clang -Wall -pthread -DCC_SIMD -DCC_ORDER_STATISTICS -DCC_FLAT_SMALL_MAPS -DCC_POOL_NODES -DCC_INCREMENTAL_REHASH -DCC_STATS -DCC_PARALLEL_REHASH \
+  -DTEST_THREADS unit_tests.c -o unit_tests_with_options
+./unit_tests_with_options
+
 clang++ -Wall tests_against_stl.cpp -o tests_against_stl
 ./tests_against_stl
@@ -28,6 +28,7 @@ License (MIT):
 
 */
 
+#include <algorithm>
 #include <ctime>
 #include <iostream>
 #include <list>
@@ -103,6 +104,12 @@ void tracking_free( void *ptr )
 #define CC_REALLOC unreliable_tracking_realloc
 #define CC_FREE tracking_free
 
+// Predicate for cc_erase_if, which receives the divisor via ctx.
+bool is_multiple( void *el, void *ctx )
+{
+  return *(int *)el % *(int *)ctx == 0;
+}
+
 int main()
 {
   srand( (unsigned int)std::time( nullptr ) );
@@ -117,7 +124,7 @@ int main()
 
     for( int op = 0; op < N_OPS; ++op )
     {
-      switch( rand() % 10 )
+      switch( rand() % 11 )
       {
         case 0: // cc_push.
         {
@@ -245,6 +252,16 @@ int main()
           our_vec = clone;
         }
         break;
+        case 10: // cc_sort and cc_stable_sort.
+        {
+          if( rand() % 2 )
+            cc_sort( &our_vec );
+          else
+            cc_stable_sort( &our_vec );
+
+          std::sort( stl_vec.begin(), stl_vec.end() );
+        }
+        break;
       }
     }
 
@@ -463,7 +480,7 @@ int main()
 
     for( int op = 0; op < N_OPS; ++op )
     {
-      switch( rand() % 7 )
+      switch( rand() % 8 )
       {
         case 0: // cc_insert.
         {
@@ -547,6 +564,24 @@ int main()
           our_map = clone;
         }
         break;
+        case 7: // cc_erase_if.
+        {
+          int divisor = rand() % 50 + 10;
+          size_t stl_erased_count = 0;
+          for( auto i = stl_map.begin(); i != stl_map.end(); )
+          {
+            if( i->second % divisor == 0 )
+            {
+              i = stl_map.erase( i );
+              ++stl_erased_count;
+            }
+            else
+              ++i;
+          }
+
+          ALWAYS_ASSERT( cc_erase_if( &our_map, is_multiple, &divisor ) == stl_erased_count );
+        }
+        break;
       }
     }
 
@@ -679,7 +714,7 @@ int main()
 
     for( int op = 0; op < N_OPS; ++op )
     {
-      switch( rand() % 5 )
+      switch( rand() % 7 )
       {
         case 0: // cc_insert.
         {
@@ -764,6 +799,50 @@ int main()
           }
         }
         break;
+        case 5: // cc_erase_range, cc_split_at, and cc_join.
+        {
+          int key = rand() % ( N_OPS / 10 );
+
+          if( rand() % 4 == 0 )
+          {
+            cc_erase_range( &our_omap, cc_first( &our_omap, key ), cc_first( &our_omap, key + 10 ) );
+            stl_omap.erase( stl_omap.lower_bound( key ), stl_omap.lower_bound( key + 10 ) );
+          }
+          else
+          {
+            cc_omap( int, int ) upper;
+            cc_init( &upper );
+            UNTIL_SUCCESS( cc_split_at( &our_omap, key, &upper ) );
+
+            ALWAYS_ASSERT( cc_size( &our_omap ) + cc_size( &upper ) == stl_omap.size() );
+            ALWAYS_ASSERT( cc_size( &upper ) == (size_t)std::distance( stl_omap.lower_bound( key ), stl_omap.end() ) );
+            cc_for_each( &upper, cc_itr )
+              ALWAYS_ASSERT( *cc_key_for( &upper, cc_itr ) >= key );
+
+            UNTIL_SUCCESS( cc_join( &our_omap, &upper ) );
+            ALWAYS_ASSERT( cc_size( &upper ) == 0 );
+            cc_cleanup( &upper );
+          }
+        }
+        break;
+        case 6: // cc_erase_if.
+        {
+          int divisor = rand() % 50 + 10;
+          size_t stl_erased_count = 0;
+          for( auto i = stl_omap.begin(); i != stl_omap.end(); )
+          {
+            if( i->second % divisor == 0 )
+            {
+              i = stl_omap.erase( i );
+              ++stl_erased_count;
+            }
+            else
+              ++i;
+          }
+
+          ALWAYS_ASSERT( cc_erase_if( &our_omap, is_multiple, &divisor ) == stl_erased_count );
+        }
+        break;
       }
     }
 
@@ -910,6 +989,247 @@ int main()
     cc_cleanup( &our_oset );
   }
 
+  // B-tree map.
+  for( int test = 0; test < N_TESTS; ++test )
+  {
+    std::cout << "B-tree map test " << test << "... ";
+    std::map<int, int> stl_bmap;
+    cc_bmap( int, int ) our_bmap;
+    cc_init( &our_bmap );
+
+    for( int op = 0; op < N_OPS; ++op )
+    {
+      switch( rand() % 5 )
+      {
+        case 0: // cc_insert.
+        {
+          int *el;
+          int key = rand() % ( N_OPS / 10 );
+          int el_val = rand();
+          UNTIL_SUCCESS( ( el = cc_insert( &our_bmap, key, el_val ) ) );
+
+          ALWAYS_ASSERT( *el == el_val );
+          ALWAYS_ASSERT( *cc_key_for( &our_bmap, el ) == key );
+
+          stl_bmap[ key ] = el_val;
+        }
+        break;
+        case 1: // cc_get_or_insert.
+        {
+          int *el;
+          int key = rand() % ( N_OPS / 10 );
+          int el_val = rand();
+          size_t original_size = cc_size( &our_bmap );
+          UNTIL_SUCCESS( ( el = cc_get_or_insert( &our_bmap, key, el_val ) ) );
+
+          ALWAYS_ASSERT( *cc_key_for( &our_bmap, el ) == key );
+
+          if( cc_size( &our_bmap ) > original_size )
+          {
+            ALWAYS_ASSERT( *el == el_val );
+
+            stl_bmap[ key ] = el_val;
+          }
+          else
+            ALWAYS_ASSERT( *el == stl_bmap.find( key )->second );
+        }
+        break;
+        case 2: // cc_get.
+        {
+          int key = rand() % ( N_OPS / 10 );
+          int *el = cc_get( &our_bmap, key );
+          if( el )
+            ALWAYS_ASSERT( *el == stl_bmap.find( key )->second );
+          else
+            ALWAYS_ASSERT( stl_bmap.find( key ) == stl_bmap.end() );
+        }
+        break;
+        case 3: // cc_erase and cc_erase_itr.
+        {
+          if( rand() % 2 )
+          {
+            int key = rand() % ( N_OPS / 10 );
+            ALWAYS_ASSERT( cc_erase( &our_bmap, key ) == (bool)stl_bmap.erase( key ) );
+          }
+          else
+          {
+            int key = rand() % ( N_OPS / 10 );
+            int *el = cc_get( &our_bmap, key );
+            if( el )
+              cc_erase_itr( &our_bmap, el );
+            
+            stl_bmap.erase( key );
+          }
+        }
+        break;
+        case 4: // cc_init_clone.
+        {
+          cc_bmap( int, int ) clone;
+
+          if( rand() % 2 ) // Probable failure due to failing realloc.
+          {
+            if( cc_init_clone( &clone, &our_bmap ) )
+            {
+              cc_cleanup( &our_bmap );
+              our_bmap = clone;
+            }
+          }
+          else // Non-failing.
+          {
+            failing_alloc_on = false;
+            UNTIL_SUCCESS( cc_init_clone( &clone, &our_bmap ) );
+            cc_cleanup( &our_bmap );
+            our_bmap = clone;
+            failing_alloc_on = true;
+          }
+        }
+        break;
+      }
+    }
+
+    // Check our_bmap against STL's ordered map.
+
+    // Forward iteration.
+    auto stl_itr = stl_bmap.begin();
+    cc_for_each( &our_bmap, cc_itr )
+    {
+      ALWAYS_ASSERT( *cc_key_for( &our_bmap, cc_itr ) == stl_itr->first );
+      ALWAYS_ASSERT( *cc_itr == stl_itr->second );
+      ++stl_itr;
+    }
+    ALWAYS_ASSERT( stl_itr == stl_bmap.end() );
+
+    // Reverse iteration.
+    auto stl_r_itr = stl_bmap.rbegin();
+    cc_r_for_each( &our_bmap, cc_itr )
+    {
+      ALWAYS_ASSERT( *cc_key_for( &our_bmap, cc_itr ) == stl_r_itr->first );
+      ALWAYS_ASSERT( *cc_itr == stl_r_itr->second );
+      ++stl_r_itr;
+    }
+    ALWAYS_ASSERT( stl_r_itr == stl_bmap.rend() );
+
+    std::cout << "Done. Final size: " << cc_size( &our_bmap ) << "\n";
+    cc_cleanup( &our_bmap );
+  }
+
+  // B-tree set.
+  for( int test = 0; test < N_TESTS; ++test )
+  {
+    std::cout << "B-tree set test " << test << "... ";
+    std::set<int> stl_bset;
+    cc_bset( int ) our_bset;
+    cc_init( &our_bset );
+
+    for( int op = 0; op < N_OPS; ++op )
+    {
+      switch( rand() % 5 )
+      {
+        case 0: // cc_insert.
+        {
+          int el_val = rand() % ( N_OPS / 10 );
+          int *el;
+          UNTIL_SUCCESS( ( el = cc_insert( &our_bset, el_val ) ) );
+
+          ALWAYS_ASSERT( *el == el_val );
+
+          stl_bset.insert( el_val );
+        }
+        break;
+        case 1: // cc_get_or_insert.
+        {
+          int *el;
+          int el_val = rand();
+          size_t original_size = cc_size( &our_bset );
+          UNTIL_SUCCESS( ( el = cc_get_or_insert( &our_bset, el_val ) ) );
+
+          if( cc_size( &our_bset ) > original_size )
+          {
+            ALWAYS_ASSERT( *el == el_val );
+
+            stl_bset.insert( el_val );
+          }
+          else
+            ALWAYS_ASSERT( *el == *stl_bset.find( el_val ) );
+        }
+        break;
+        case 2: // cc_get.
+        {
+          int el_val = rand() % ( N_OPS / 10 );
+          int *el = cc_get( &our_bset, el_val );
+          if( el )
+            ALWAYS_ASSERT( *el == *stl_bset.find( el_val ) );
+          else
+            ALWAYS_ASSERT( stl_bset.find( el_val ) == stl_bset.end() );
+        }
+        break;
+        case 3: // cc_erase and cc_erase_itr.
+        {
+          if( rand() % 2 )
+          {
+            int el_val = rand() % ( N_OPS / 10 );
+            ALWAYS_ASSERT( cc_erase( &our_bset, el_val ) == (bool)stl_bset.erase( el_val ) );
+          }
+          else
+          {
+            int el_val = rand() % ( N_OPS / 10 );
+            int *el = cc_get( &our_bset, el_val );
+            if( el )
+              cc_erase_itr( &our_bset, el );
+            
+            stl_bset.erase( el_val );
+          }
+        }
+        break;
+        case 4: // cc_init_clone.
+        {
+          cc_bset( int ) clone;
+
+          if( rand() % 2 ) // Probable failure due to failing realloc.
+          {
+            if( cc_init_clone( &clone, &our_bset ) )
+            {
+              cc_cleanup( &our_bset );
+              our_bset = clone;
+            }
+          }
+          else // Non-failing.
+          {
+            failing_alloc_on = false;
+            UNTIL_SUCCESS( cc_init_clone( &clone, &our_bset ) );
+            cc_cleanup( &our_bset );
+            our_bset = clone;
+            failing_alloc_on = true;
+          }
+        }
+        break;
+      }
+    }
+
+    // Check our_bset against STL's ordered set.
+
+    // Forward iteration.
+    auto stl_itr = stl_bset.begin();
+    cc_for_each( &our_bset, cc_itr )
+    {
+      ALWAYS_ASSERT( *cc_itr == *stl_itr );
+      ++stl_itr;
+    }
+    ALWAYS_ASSERT( stl_itr == stl_bset.end() );
+
+    // Reverse iteration.
+    auto stl_r_itr = stl_bset.rbegin();
+    cc_r_for_each( &our_bset, cc_itr )
+    {
+      ALWAYS_ASSERT( *cc_itr == *stl_r_itr );
+      ++stl_r_itr;
+    }
+    ALWAYS_ASSERT( stl_r_itr == stl_bset.rend() );
+
+    std::cout << "Done. Final size: " << cc_size( &our_bset ) << "\n";
+    cc_cleanup( &our_bset );
+  }
+
   ALWAYS_ASSERT( oustanding_allocs.empty() );
   std::cout << "All done.\nSimulated allocation failures: " << simulated_alloc_failures << "\n";
 }
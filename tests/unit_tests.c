@@ -31,10 +31,21 @@ License (MIT):
 #define TEST_SET
 #define TEST_OMAP
 #define TEST_OSET
+#define TEST_CMAP
+#define TEST_BMAP
+#define TEST_BSET
+#define TEST_RING
+
+// Define TEST_THREADS, and link with POSIX threads, to also test concurrent maps and rings from several threads at
+// once.
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#ifdef TEST_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "../cc.h"
 
@@ -55,16 +66,29 @@ License (MIT):
 
 // Custom realloc and free functions that track the number of outstanding allocations.
 // If SIMULATE_ALLOC_FAILURES is defined above, the realloc will also sporadically fail.
+// If TEST_THREADS is defined, a mutex guards the counters and rand so that several threads can allocate at once.
 
 size_t simulated_alloc_failures = 0;
 size_t oustanding_allocs = 0;
 
+#ifdef TEST_THREADS
+pthread_mutex_t alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_ALLOCS() pthread_mutex_lock( &alloc_mutex )
+#define UNLOCK_ALLOCS() pthread_mutex_unlock( &alloc_mutex )
+#else
+#define LOCK_ALLOCS() (void)0
+#define UNLOCK_ALLOCS() (void)0
+#endif
+
 static void *unreliable_tracking_realloc( void *ptr, size_t size )
 {
+  LOCK_ALLOCS();
+
 #ifdef SIMULATE_ALLOC_FAILURES
   if( rand() % 5 == 0 )
   {
     ++simulated_alloc_failures;
+    UNLOCK_ALLOCS();
     return NULL;
   }
 #endif
@@ -75,21 +99,84 @@ static void *unreliable_tracking_realloc( void *ptr, size_t size )
   if( !ptr )
     ++oustanding_allocs;
 
+  UNLOCK_ALLOCS();
   return new_ptr;
 }
 
 static void tracking_free( void *ptr )
 {
+  LOCK_ALLOCS();
+
   if( ptr )
     --oustanding_allocs;
 
   free( ptr );
+  UNLOCK_ALLOCS();
 }
 
 // Activate custom realloc and free functions.
 #define CC_REALLOC unreliable_tracking_realloc
 #define CC_FREE tracking_free
 
+// Stateful allocator, for use with init_with_allocator, that counts its own outstanding allocations via its context
+// pointer and otherwise defers to the above functions.
+
+static void *counting_realloc( void *ctx, void *ptr, size_t size )
+{
+  void *new_ptr = unreliable_tracking_realloc( ptr, size );
+  if( new_ptr && !ptr )
+    ++*(size_t *)ctx;
+
+  return new_ptr;
+}
+
+static void counting_free( void *ctx, void *ptr )
+{
+  if( ptr )
+    --*(size_t *)ctx;
+
+  tracking_free( ptr );
+}
+
+// Stateful allocator, for checking memory_usage, that counts the bytes it has outstanding via its context pointer.
+// Each allocation is prefixed with its size.
+
+static void *byte_counting_realloc( void *ctx, void *ptr, size_t size )
+{
+  size_t old_size = 0;
+  if( ptr )
+  {
+    ptr = (char *)ptr - sizeof( cc_max_align_ty );
+    old_size = *(size_t *)ptr;
+  }
+
+  char *new_ptr = (char *)unreliable_tracking_realloc( ptr, sizeof( cc_max_align_ty ) + size );
+  if( !new_ptr )
+    return NULL;
+
+  *(size_t *)new_ptr = size;
+  *(size_t *)ctx += size - old_size;
+  return new_ptr + sizeof( cc_max_align_ty );
+}
+
+static void byte_counting_free( void *ctx, void *ptr )
+{
+  if( !ptr )
+    return;
+
+  ptr = (char *)ptr - sizeof( cc_max_align_ty );
+  *(size_t *)ctx -= *(size_t *)ptr;
+  tracking_free( ptr );
+}
+
+// Checks a result of memory_usage against the expected allocated and payload bytes.
+static void check_memory_usage( cc_mem_usage usage, size_t allocated, size_t payload )
+{
+  ALWAYS_ASSERT( usage.allocated == allocated );
+  ALWAYS_ASSERT( usage.payload == payload );
+  ALWAYS_ASSERT( usage.overhead == allocated - payload );
+}
+
 // Define a custom type that will be used to check that destructors are always called where necessary.
 
 bool dtor_called[ 100 ];
@@ -109,6 +196,57 @@ typedef struct { int val; } custom_ty;
 #define CC_LOAD custom_ty, 0.7
 #include "../cc.h"
 
+// Define a second custom type, whose destructor records its calls separately, so that tests can check that maps never
+// confuse their key and element destructors.
+
+bool el_dtor_called[ 100 ];
+
+typedef struct { int val; } custom_el_ty;
+#define CC_DTOR custom_el_ty, { el_dtor_called[ val.val ] = true; }
+#include "../cc.h"
+
+// Define a custom type, with an oddly sized key to exercise bucket padding, whose hash codes maps and sets cache.
+// Its hash function counts its calls so that tests can check when the cached hash codes are used.
+
+size_t cached_hash_calls = 0;
+
+typedef struct { int val; char padding[ 3 ]; } cached_hash_ty;
+#define CC_CMPR cached_hash_ty, { return val_1.val < val_2.val ? -1 : val_1.val > val_2.val; }
+#define CC_HASH cached_hash_ty, { ++cached_hash_calls; return val.val * 2654435761ull; }
+#define CC_CACHE_HASH cached_hash_ty
+#include "../cc.h"
+
+// Define a custom type whose vectors grow by a factor of 1.5 rather than the default 2.0.
+
+typedef struct { int val; } slow_growth_ty;
+#define CC_VEC_GROWTH slow_growth_ty, 1.5
+#include "../cc.h"
+
+// Define a custom type whose comparison function ignores one member so that tests can check whether sorts are stable.
+
+typedef struct { int key; int seq; } sort_ty;
+#define CC_CMPR sort_ty, { return val_1.key < val_2.key ? -1 : val_1.key > val_2.key; }
+#include "../cc.h"
+
+// Predicates for filter and erase_if.
+// Those that test for multiples receive the divisor via ctx.
+
+static bool is_int_multiple( void *el, void *ctx )
+{
+  return *(int *)el % *(int *)ctx == 0;
+}
+
+static bool is_size_t_multiple( void *el, void *ctx )
+{
+  return *(size_t *)el % *(size_t *)ctx == 0;
+}
+
+static bool is_custom_ty_even( void *el, void *ctx )
+{
+  (void)ctx;
+  return ( (custom_ty *)el )->val % 2 == 0;
+}
+
 // Vector tests.
 #ifdef TEST_VEC
 
@@ -591,1366 +729,6837 @@ static void test_vec_init_clone( void )
   cleanup( &our_vec );
 }
 
-static void test_vec_dtors( void )
+static void test_vec_init_with_allocator( void )
 {
-  vec( custom_ty ) our_vec;
-  init( &our_vec );
+  int expected [ 30 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
+  };
 
-  // Test erase and clear.
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
 
-  UNTIL_SUCCESS( resize( &our_vec, 100 ) );
-  for( int i = 0; i < 100; ++i )
-    get( &our_vec, i )->val = i;
+  vec( int ) our_vec;
+  UNTIL_SUCCESS( init_with_allocator( &our_vec, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_vec ) == 0 );
+  ALWAYS_ASSERT( cap( &our_vec ) == 0 );
 
-  bool erase = true;
-  for( int i = 0; i < 50; )
-  {
-    if( erase )
-      erase( &our_vec, i );
-    else
-      i += 1;
+  UNTIL_SUCCESS( push_n( &our_vec, expected, 30 ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  VEC_CHECK;
 
-    erase = !erase;
-  }
+  // Test that clones share the allocator.
+  vec( int ) our_vec_clone;
+  UNTIL_SUCCESS( init_clone( &our_vec_clone, &our_vec ) );
+  ALWAYS_ASSERT( allocs == 2 );
 
+  // Test that shrinking an empty vector keeps its header, and hence its allocator.
   clear( &our_vec );
-  check_dtors_arr();
-
-  // Test cleanup.
-  UNTIL_SUCCESS( resize( &our_vec, 100 ) );
-  for( int i = 0; i < 100; ++i )
-    get( &our_vec, i )->val = i;
+  UNTIL_SUCCESS( shrink( &our_vec ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  UNTIL_SUCCESS( push_n( &our_vec, expected, 30 ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  VEC_CHECK;
 
   cleanup( &our_vec );
-  check_dtors_arr();
-}
-
-#endif
-
-// List tests.
-#ifdef TEST_LIST
-
-#define LIST_CHECK                                                              \
-ALWAYS_ASSERT( size( &our_list ) == sizeof( expected ) / sizeof( *expected ) ); \
-do                                                                              \
-{                                                                               \
-  int *arr = expected;                                                          \
-  for_each( &our_list, i )                                                      \
-  {                                                                             \
-    ALWAYS_ASSERT( *i == *arr );                                                \
-    ++arr;                                                                      \
-  }                                                                             \
-}while( false )                                                                 \
-
-static void test_list_insert( void )
-{
-  list( int ) our_list;
-  init( &our_list );
+  cleanup( &our_vec_clone );
+  ALWAYS_ASSERT( allocs == 0 );
 
-  int expected [ 90 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
-    20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
-    30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
-    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,
-    50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
-    60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
-    70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
-    80, 81, 82, 83, 84, 85, 86, 87, 88, 89
-  };
+  // Test arena with two vectors growing in turn, such that only the most recent allocation can grow in place.
+  cc_arena arena;
+  cc_arena_init( &arena );
 
-  // End.
-  for( int i = 0; i < 30; ++i )
+  vec( int ) other_vec;
+  UNTIL_SUCCESS( init_with_allocator( &our_vec, cc_arena_allocator( &arena ) ) );
+  UNTIL_SUCCESS( init_with_allocator( &other_vec, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( el = insert( &our_list, end( &our_list ), 60 + i ) );
-    ALWAYS_ASSERT( *el == 60 + i );
+    UNTIL_SUCCESS( push( &our_vec, i ) );
+    UNTIL_SUCCESS( push( &other_vec, -i ) );
   }
 
-  // Beginning.
-  for( int i = 0; i < 30; ++i )
+  for( int i = 0; i < 1000; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( el = insert( &our_list, first( &our_list ), 29 - i ) );
-    ALWAYS_ASSERT( *el == 29 - i );
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i );
+    ALWAYS_ASSERT( *get( &other_vec, i ) == -i );
   }
 
-  // Middle.
-  int *mid = first( &our_list );
-  for( int i = 0; i < 30; ++i )
-    mid = next( &our_list, mid );
+  cleanup( &our_vec );
+  cc_arena_cleanup( &arena ); // Releases other_vec too.
+}
 
-  for( int i = 0; i < 30; ++i )
+static void test_vec_init_with_buffer( void )
+{
+  struct
   {
-    int *el;
-    UNTIL_SUCCESS( el = insert( &our_list, mid, 30 + i ) );
-    ALWAYS_ASSERT( *el == 30 + i );
-  }
+    vec( uint32_t ) ids;
+    svec( uint32_t, 4 ) ids_buf;
+  } hot;
+
+  size_t allocs_before = oustanding_allocs;
+
+  init_with_buffer( &hot.ids, &hot.ids_buf );
+  ALWAYS_ASSERT( size( &hot.ids ) == 0 );
+  ALWAYS_ASSERT( cap( &hot.ids ) >= 4 );
+
+  // Up to the buffer's capacity, insertions do not allocate memory, so they cannot fail.
+  uint32_t els[] = { 1, 2 };
+  ALWAYS_ASSERT( push( &hot.ids, 0 ) );
+  ALWAYS_ASSERT( push( &hot.ids, 3 ) );
+  ALWAYS_ASSERT( insert_n( &hot.ids, 1, els, 2 ) );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+  for( uint32_t i = 0; i < 4; ++i )
+    ALWAYS_ASSERT( *get( &hot.ids, i ) == i );
+
+  // Outgrow the buffer.
+  for( uint32_t i = 4; i < 100; ++i )
+    UNTIL_SUCCESS( push( &hot.ids, i ) );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before + 1 );
+  ALWAYS_ASSERT( size( &hot.ids ) == 100 );
+
+  ALWAYS_ASSERT( erase_n( &hot.ids, 0, 50 ) );
+  uint32_t expected = 50;
+  for_each( &hot.ids, i )
+    ALWAYS_ASSERT( *i == expected++ );
+  ALWAYS_ASSERT( expected == 100 );
+
+  // Test that clones share the buffer's allocator but not its storage.
+  vec( uint32_t ) clone;
+  UNTIL_SUCCESS( init_clone( &clone, &hot.ids ) );
+  ALWAYS_ASSERT( size( &clone ) == 50 );
+  ALWAYS_ASSERT( *get( &clone, 0 ) == 50 );
+  cleanup( &clone );
+
+  cleanup( &hot.ids );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+
+  // Test that shrinking and regrowing a vector that still fits in the buffer does not allocate memory.
+  init_with_buffer( &hot.ids, &hot.ids_buf );
+  ALWAYS_ASSERT( push( &hot.ids, 0 ) );
+  ALWAYS_ASSERT( shrink( &hot.ids ) );
+  ALWAYS_ASSERT( cap( &hot.ids ) == 1 );
+  ALWAYS_ASSERT( push( &hot.ids, 1 ) );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+
+  cleanup( &hot.ids );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+}
 
-  LIST_CHECK;
+static void test_vec_init_with_fixed_buffer( void )
+{
+  vec( int ) our_vec;
+  fvec( int, 4 ) our_vec_buf;
 
-  cleanup( &our_list );
+  size_t allocs_before = oustanding_allocs;
+
+  init_with_fixed_buffer( &our_vec, &our_vec_buf );
+  ALWAYS_ASSERT( size( &our_vec ) == 0 );
+  ALWAYS_ASSERT( cap( &our_vec ) == 4 );
+
+  // Insertions within the buffer's capacity cannot fail, while insertions beyond it always fail.
+  for( int i = 0; i < 4; ++i )
+    ALWAYS_ASSERT( push( &our_vec, i ) );
+  ALWAYS_ASSERT( !push( &our_vec, 4 ) );
+  ALWAYS_ASSERT( !reserve( &our_vec, 5 ) );
+  ALWAYS_ASSERT( size( &our_vec ) == 4 );
+  for( int i = 0; i < 4; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i );
+
+  // Test that init_clone fails rather than allocating.
+  vec( int ) our_vec_clone;
+  ALWAYS_ASSERT( !init_clone( &our_vec_clone, &our_vec ) );
+
+  // Test that shrinking and regrowing within the buffer's capacity succeeds.
+  ALWAYS_ASSERT( erase_n( &our_vec, 0, 3 ) );
+  ALWAYS_ASSERT( shrink( &our_vec ) );
+  ALWAYS_ASSERT( cap( &our_vec ) == 1 );
+  ALWAYS_ASSERT( reserve( &our_vec, 4 ) );
+  ALWAYS_ASSERT( push( &our_vec, 4 ) );
+  ALWAYS_ASSERT( *get( &our_vec, 0 ) == 3 );
+  ALWAYS_ASSERT( *get( &our_vec, 1 ) == 4 );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+
+  // Test that the buffer can be reused after cleanup.
+  cleanup( &our_vec );
+  init_with_fixed_buffer( &our_vec, &our_vec_buf );
+  ALWAYS_ASSERT( cap( &our_vec ) == 4 );
+  ALWAYS_ASSERT( push( &our_vec, 0 ) );
+  cleanup( &our_vec );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
 }
 
-static void test_list_push( void )
+static void test_vec_growth( void )
 {
-  list( int ) our_list;
-  init( &our_list );
-
-  int expected [ 100 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
-    20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
-    30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
-    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,
-    50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
-    60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
-    70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
-    80, 81, 82, 83, 84, 85, 86, 87, 88, 89,
-    90, 91, 92, 93, 94, 95, 96, 97, 98, 99
-  };
+  // Custom growth factor.
+  vec( slow_growth_ty ) slow_vec;
+  init( &slow_vec );
 
+  size_t expected_cap = 2;
   for( int i = 0; i < 100; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( el = push( &our_list, i ) );
-    ALWAYS_ASSERT( ( *el == i ) );
+    if( (size_t)i == expected_cap )
+      expected_cap = expected_cap * 3 / 2;
+
+    slow_growth_ty el = { i };
+    UNTIL_SUCCESS( push( &slow_vec, el ) );
+    ALWAYS_ASSERT( cap( &slow_vec ) == expected_cap );
   }
 
-  LIST_CHECK;
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( get( &slow_vec, i )->val == i );
 
-  cleanup( &our_list );
+  cleanup( &slow_vec );
+
+  // Default growth factor, with the capacity of large vectors rounded up to fill whole pages.
+  vec( int ) our_vec;
+  init( &our_vec );
+
+  // Reserving is exact.
+  UNTIL_SUCCESS( reserve( &our_vec, 100000 ) );
+  ALWAYS_ASSERT( cap( &our_vec ) == 100000 );
+  UNTIL_SUCCESS( resize( &our_vec, 100000 ) );
+  ALWAYS_ASSERT( cap( &our_vec ) == 100000 );
+
+  UNTIL_SUCCESS( push( &our_vec, 0 ) );
+  ALWAYS_ASSERT( cap( &our_vec ) >= 200000 && cap( &our_vec ) < 200000 + CC_VEC_PAGE_SIZE / sizeof( int ) );
+  ALWAYS_ASSERT(
+    ( CC_VEC_ALLOC_OVERHEAD + sizeof( cc_vec_hdr_ty ) + cap( &our_vec ) * sizeof( int ) ) % CC_VEC_PAGE_SIZE == 0
+  );
+
+  size_t cap = cap( &our_vec );
+  UNTIL_SUCCESS( reserve( &our_vec, cap + 1 ) );
+  ALWAYS_ASSERT( cap( &our_vec ) == cap + 1 );
+
+  // Larger allocations are rounded up to fill whole huge pages.
+  UNTIL_SUCCESS( resize( &our_vec, 3000000 ) );
+  UNTIL_SUCCESS( push( &our_vec, 0 ) );
+  ALWAYS_ASSERT( cap( &our_vec ) >= 6000000 );
+  ALWAYS_ASSERT(
+    ( CC_VEC_ALLOC_OVERHEAD + sizeof( cc_vec_hdr_ty ) + cap( &our_vec ) * sizeof( int ) ) % CC_VEC_HUGE_PAGE_SIZE == 0
+  );
+
+  cleanup( &our_vec );
 }
 
-static void test_list_splice( void )
+static void test_vec_snapshot( void )
 {
-  list( int ) our_list;
-  list( int ) src_list;
-  init( &our_list );
-  init( &src_list );
+  vec( int ) our_vec;
+  init( &our_vec );
 
-  // Splice from one list to another.
+  // Test snapshot of placeholder.
+  size_t buf_size = snapshot_size( &our_vec );
+  void *buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_vec, buf );
 
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( push( &src_list, i ) );
+  vec( int ) loaded_vec;
+  UNTIL_SUCCESS( init_from_snapshot( &loaded_vec, buf, buf_size ) );
+  ALWAYS_ASSERT( (void *)loaded_vec == (void *)&cc_vec_placeholder );
+  free( buf );
 
-  bool splice = true;
-  for( int *i = first( &src_list ); i != last( &src_list ); )
-  {
-    int *next = next( &src_list, i );
+  // Test snapshot of non-placeholder.
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( push( &our_vec, i ) );
 
-    if( splice )
-      UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &src_list, i ) );
+  buf_size = snapshot_size( &our_vec );
+  buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_vec, buf );
 
-    splice = !splice;
-    i = next;
-  }
+  UNTIL_SUCCESS( init_from_snapshot( &loaded_vec, buf, buf_size ) );
+  ALWAYS_ASSERT( size( &loaded_vec ) == 30 );
+  for( int i = 0; i < 30; ++i )
+    ALWAYS_ASSERT( *get( &loaded_vec, i ) == i );
 
-  ALWAYS_ASSERT( size( &our_list ) == 50 );
-  for( int *i = first( &our_list ), j = 0; i != last( &our_list ); i = next( &our_list, i ), j += 2 )
-    ALWAYS_ASSERT( *i == j );
+  // Test that the loaded vector owns its memory.
+  UNTIL_SUCCESS( push( &loaded_vec, 30 ) );
+  ALWAYS_ASSERT( size( &loaded_vec ) == 31 );
 
-  ALWAYS_ASSERT( size( &src_list ) == 50 );
-  for( int *i = first( &src_list ), j = 1; i != last( &src_list ); i = next( &src_list, i ), j += 2 )
-    ALWAYS_ASSERT( *i == j );
+  // Test view.
+  vec( int ) view_vec;
+  ALWAYS_ASSERT( init_view_of_snapshot( &view_vec, buf, buf_size ) );
+  ALWAYS_ASSERT( size( &view_vec ) == 30 );
+  for( int i = 0; i < 30; ++i )
+    ALWAYS_ASSERT( *get( &view_vec, i ) == i );
 
-  // Splice within the same list.
+  ALWAYS_ASSERT( (char *)get( &view_vec, 0 ) > (char *)buf );
+  ALWAYS_ASSERT( (char *)get( &view_vec, 29 ) < (char *)buf + buf_size );
 
-  int *i = last( &our_list );
-  while( i != r_end( &our_list ) )
-  {
-    int *prev = prev( &our_list, i );
+  // Test that the view cannot grow.
+  ALWAYS_ASSERT( !push( &view_vec, 30 ) );
+  ALWAYS_ASSERT( size( &view_vec ) == 30 );
 
-    UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &our_list, i ) );
+  cleanup( &view_vec );
 
-    i = prev;
-  }
+  // Test rejection of invalid snapshots.
+  vec( int ) invalid_vec;
+  ALWAYS_ASSERT( !init_from_snapshot( &invalid_vec, buf, buf_size - 1 ) );
+  ALWAYS_ASSERT( !init_view_of_snapshot( &invalid_vec, (char *)buf + 1, buf_size - 1 ) );
 
-  ALWAYS_ASSERT( size( &our_list ) == 50 );
-  for( int *i = first( &our_list ), j = 98; i != last( &our_list ); i = next( &our_list, i ), j -= 2 )
-    ALWAYS_ASSERT( *i == j );
+  vec( short ) other_ty_vec;
+  ALWAYS_ASSERT( !init_from_snapshot( &other_ty_vec, buf, buf_size ) );
 
-  cleanup( &our_list );
-  cleanup( &src_list );
+  *(char *)buf = 'X';
+  ALWAYS_ASSERT( !init_from_snapshot( &invalid_vec, buf, buf_size ) );
+
+  free( buf );
+  cleanup( &our_vec );
+  cleanup( &loaded_vec );
 }
 
-static void test_list_erase( void )
+#ifdef CC_STATS
+static void test_vec_stats( void )
 {
-  list( int ) our_list;
-  init( &our_list );
+  vec( int ) our_vec;
+  init( &our_vec );
 
-  int expected [ 50 ] = {
-    1, 3, 5, 7, 9,
-    11, 13, 15, 17, 19,
-    21, 23, 25, 27, 29,
-    31, 33, 35, 37, 39,
-    41, 43, 45, 47, 49,
-    51, 53, 55, 57, 59,
-    61, 63, 65, 67, 69,
-    71, 73, 75, 77, 79,
-    81, 83, 85, 87, 89,
-    91, 93, 95, 97, 99
-  };
+  cc_stats stats;
+  get_stats( &our_vec, &stats );
+  ALWAYS_ASSERT( stats.size == 0 );
+  ALWAYS_ASSERT( stats.cap == 0 );
+  ALWAYS_ASSERT( stats.reallocs == 0 );
 
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-
-  bool erase = true;
-  for( int *i = first( &our_list ); i != end( &our_list ); )
-  {
-    if( erase )
-      i = erase( &our_list, i );
-    else
-      i = next( &our_list, i );
+    UNTIL_SUCCESS( push( &our_vec, i ) );
 
-    erase = !erase;
-  }
+  get_stats( &our_vec, &stats );
+  ALWAYS_ASSERT( stats.size == 100 );
+  ALWAYS_ASSERT( stats.cap == cap( &our_vec ) );
+  ALWAYS_ASSERT( stats.reallocs > 0 );
 
-  LIST_CHECK;
+  // Test that only successful reallocations are counted.
+  size_t reallocs = stats.reallocs;
+  UNTIL_SUCCESS( reserve( &our_vec, cap( &our_vec ) + 1 ) );
+  UNTIL_SUCCESS( shrink( &our_vec ) );
+  get_stats( &our_vec, &stats );
+  ALWAYS_ASSERT( stats.reallocs == reallocs + 2 );
 
-  cleanup( &our_list );
+  cleanup( &our_vec );
 }
+#endif
 
-static void test_list_clear( void )
+static void test_vec_memory_usage( void )
 {
-  vec( int ) our_list;
-  init( &our_list );
-
-  int expected [ 30 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
-    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-  };
+  vec( int ) our_vec;
+  init( &our_vec );
+  check_memory_usage( memory_usage( &our_vec ), 0, 0 );
 
-  // Empty.
-  clear( &our_list );
-  ALWAYS_ASSERT( size( &our_list ) == 0 );
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_vec, &allocator ) );
+  check_memory_usage( memory_usage( &our_vec ), bytes, 0 );
 
-  // Non-empty.
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-  ALWAYS_ASSERT( size( &our_list ) == 30 );
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( push( &our_vec, i ) );
 
-  clear( &our_list );
-  ALWAYS_ASSERT( size( &our_list ) == 0 );
+  check_memory_usage( memory_usage( &our_vec ), bytes, sizeof( int ) * 100 );
 
-  // Test use.
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-  LIST_CHECK;
+  // Test that shrinking leaves only the header as overhead.
+  UNTIL_SUCCESS( shrink( &our_vec ) );
+  check_memory_usage( memory_usage( &our_vec ), bytes, sizeof( int ) * 100 );
+  ALWAYS_ASSERT( memory_usage( &our_vec ).overhead == sizeof( cc_vec_hdr_ty ) );
 
-  cleanup( &our_list );
+  cleanup( &our_vec );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_vec ), 0, 0 );
 }
 
-static void test_list_cleanup( void )
+static void test_vec_dtors( void )
 {
-  list( int ) our_list;
-  init( &our_list );
+  vec( custom_ty ) our_vec;
+  init( &our_vec );
 
-  int expected [ 30 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
-    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-  };
+  // Test erase and clear.
 
-  // Empty.
-  cleanup( &our_list );
-  ALWAYS_ASSERT( (void *)our_list == (void *)&cc_list_placeholder );
+  UNTIL_SUCCESS( resize( &our_vec, 100 ) );
+  for( int i = 0; i < 100; ++i )
+    get( &our_vec, i )->val = i;
 
-  // Non-empty.
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-  ALWAYS_ASSERT( size( &our_list ) == 30 );
-  cleanup( &our_list );
-  ALWAYS_ASSERT( size( &our_list ) == 0 );
-  ALWAYS_ASSERT( (void *)our_list == (void *)&cc_list_placeholder );
+  bool erase = true;
+  for( int i = 0; i < 50; )
+  {
+    if( erase )
+      erase( &our_vec, i );
+    else
+      i += 1;
 
-  // Test use.
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-  LIST_CHECK;
+    erase = !erase;
+  }
 
-  cleanup( &our_list );
+  clear( &our_vec );
+  check_dtors_arr();
+
+  // Test cleanup.
+  UNTIL_SUCCESS( resize( &our_vec, 100 ) );
+  for( int i = 0; i < 100; ++i )
+    get( &our_vec, i )->val = i;
+
+  cleanup( &our_vec );
+  check_dtors_arr();
 }
 
-// This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
-// from placeholder to non-placeholder.
-static void test_list_iteration( void )
+static void test_vec_sort( void )
 {
-  list( int ) our_list;
-  init( &our_list );
+  vec( int ) our_vec;
+  init( &our_vec );
 
-  int expected [ 30 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
-    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
-    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-  };
+  // Empty.
+  sort( &our_vec );
+  stable_sort( &our_vec );
+  ALWAYS_ASSERT( size( &our_vec ) == 0 );
 
-  int *r_end = r_end( &our_list );
-  int *end = end( &our_list );
+  // Test sizes on either side of the insertion sort and radix sort thresholds, with negative values, duplicates, and
+  // the extremes of int.
+  size_t sizes[] = { 1, 2, 16, 17, 100, 255, 256, 1000, 10000 };
+  for( size_t i = 0; i < sizeof( sizes ) / sizeof( *sizes ); ++i )
+    for( int stable = 0; stable < 2; ++stable )
+    {
+      UNTIL_SUCCESS( resize( &our_vec, sizes[ i ] ) );
+
+      long long sum = 0;
+      for( size_t j = 0; j < sizes[ i ]; ++j )
+      {
+        int el = rand() % 2001 - 1000;
+        if( j == sizes[ i ] / 2 )
+          el = -0x7FFFFFFF - 1;
+        else if( j == sizes[ i ] / 3 )
+          el = 0x7FFFFFFF;
+
+        *get( &our_vec, j ) = el;
+        sum += el;
+      }
+
+      if( stable )
+        stable_sort( &our_vec );
+      else
+        sort( &our_vec );
+
+      for( size_t j = 0; j < sizes[ i ]; ++j )
+      {
+        ALWAYS_ASSERT( j == 0 || *get( &our_vec, j - 1 ) <= *get( &our_vec, j ) );
+        sum -= *get( &our_vec, j );
+      }
+
+      ALWAYS_ASSERT( sum == 0 );
+    }
 
-  // Empty.
+  // Test already sorted and reverse-sorted elements, which defeat naive quicksorts.
+  for( int i = 0; i < 10000; ++i )
+    *get( &our_vec, i ) = 10000 - i;
 
-  // Test fist and last.
-  ALWAYS_ASSERT( first( &our_list ) == end );
-  ALWAYS_ASSERT( last( &our_list ) == r_end );
+  sort( &our_vec );
+  for( int i = 0; i < 10000; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i + 1 );
 
-  // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_list, r_end( &our_list ) ) == first( &our_list ) );
-  ALWAYS_ASSERT( prev( &our_list, end( &our_list ) ) == last( &our_list ) );
+  sort( &our_vec );
+  for( int i = 0; i < 10000; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i + 1 );
 
-  size_t n_iterations = 0;
-  for( int *i = first( &our_list ); i != end( &our_list ); i = next( &our_list, i ) )
-    ++n_iterations;
-  for( int *i = last( &our_list ); i != r_end( &our_list ); i = prev( &our_list, i ) )
-    ++n_iterations;
+  cleanup( &our_vec );
 
-  for_each( &our_list, i )
-    ++n_iterations;
-  for_each( &our_list, i )
-    ++n_iterations;
+  // Test a type with a custom comparison function, which sort and stable_sort call rather than radix sorting.
+  vec( sort_ty ) our_sort_vec;
+  init( &our_sort_vec );
+  UNTIL_SUCCESS( resize( &our_sort_vec, 2000 ) );
 
-  ALWAYS_ASSERT( n_iterations == 0 );
+  for( int stable = 0; stable < 2; ++stable )
+  {
+    for( int i = 0; i < 2000; ++i )
+    {
+      get( &our_sort_vec, i )->key = rand() % 1000;
+      get( &our_sort_vec, i )->seq = i;
+    }
 
-  // Non-empty.
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( push( &our_list, i ) );
-  
-  for( int *i = first( &our_list ); i != end( &our_list ); i = next( &our_list, i ) )
-    ++n_iterations;
-  for( int *i = last( &our_list ); i != r_end( &our_list ); i = prev( &our_list, i ) )
-    ++n_iterations;
+    if( stable )
+      stable_sort( &our_sort_vec );
+    else
+      sort( &our_sort_vec );
 
-  for_each( &our_list, i )
-    ++n_iterations;
-  for_each( &our_list, i )
-    ++n_iterations;
+    for( int i = 1; i < 2000; ++i )
+    {
+      sort_ty *prev = get( &our_sort_vec, i - 1 );
+      sort_ty *el = get( &our_sort_vec, i );
+      ALWAYS_ASSERT( prev->key <= el->key );
+      ALWAYS_ASSERT( !stable || prev->key < el->key || prev->seq < el->seq );
+    }
+  }
 
-  ALWAYS_ASSERT( n_iterations == 120 );
+  cleanup( &our_sort_vec );
 
-  // Test iterator stability.
-  ALWAYS_ASSERT( r_end( &our_list ) == r_end );
-  ALWAYS_ASSERT( end( &our_list ) == end );
+  // Test vectors that use fixed-capacity buffers, for which the sorting functions can never allocate a buffer.
+  fvec( int, 300 ) our_vec_buf;
+  init_with_fixed_buffer( &our_vec, &our_vec_buf );
 
-  // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_list, r_end( &our_list ) ) == first( &our_list ) );
-  ALWAYS_ASSERT( prev( &our_list, end( &our_list ) ) == last( &our_list ) );
+  for( int stable = 0; stable < 2; ++stable )
+  {
+    clear( &our_vec );
+    for( int i = 0; i < 300; ++i )
+      ALWAYS_ASSERT( push( &our_vec, rand() % 2001 - 1000 ) );
 
-  // Test fist and last.
-  ALWAYS_ASSERT( *first( &our_list ) == 0 );
-  ALWAYS_ASSERT( *last( &our_list ) == 29 );
+    if( stable )
+      stable_sort( &our_vec );
+    else
+      sort( &our_vec );
 
-  LIST_CHECK;
+    for( int i = 1; i < 300; ++i )
+      ALWAYS_ASSERT( *get( &our_vec, i - 1 ) <= *get( &our_vec, i ) );
+  }
 
-  cleanup( &our_list );
+  cleanup( &our_vec );
+
+  fvec( sort_ty, 1000 ) our_sort_vec_buf;
+  init_with_fixed_buffer( &our_sort_vec, &our_sort_vec_buf );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    sort_ty el = { rand() % 100, i };
+    ALWAYS_ASSERT( push( &our_sort_vec, el ) );
+  }
+
+  stable_sort( &our_sort_vec );
+  for( int i = 1; i < 1000; ++i )
+  {
+    sort_ty *prev = get( &our_sort_vec, i - 1 );
+    sort_ty *el = get( &our_sort_vec, i );
+    ALWAYS_ASSERT( prev->key < el->key || ( prev->key == el->key && prev->seq < el->seq ) );
+  }
+
+  cleanup( &our_sort_vec );
 }
 
-static void test_list_init_clone( void )
+#ifdef CC_PARALLEL_REHASH
+static void test_vec_parallel_sort( void )
 {
-  list( int ) src_list;
-  init( &src_list );
-
-  int expected [ 10 ] = {
-    0, 1, 2, 3, 4, 5, 6, 7, 8, 9
-  };
+  vec( sort_ty ) our_vec;
+  init( &our_vec );
 
-  // Test init_clone placeholder.
-  list( int ) empty_list;
-  UNTIL_SUCCESS( init_clone( &empty_list, &src_list ) );
-  ALWAYS_ASSERT( (void *)empty_list == (void *)&cc_list_placeholder );
+  UNTIL_SUCCESS( resize( &our_vec, CC_VEC_PARALLEL_MIN_TASK_SIZE * 2 ) );
+  for( size_t i = 0; i < size( &our_vec ); ++i )
+    get( &our_vec, i )->key = rand() % 1000;
 
-  // Test init_clone non-placeholder.
-  list( int ) our_list;
-  for( int i = 0; i < 10; ++i )
-    UNTIL_SUCCESS( push( &src_list, i ) );
-  UNTIL_SUCCESS( init_clone( &our_list, &src_list ) ); // Note that because elements are allocated individually,
-                                                       // this loop may never exist if realloc failure rate is set too
-                                                       // high.
-  LIST_CHECK;
+  sort( &our_vec );
+  for( size_t i = 1; i < size( &our_vec ); ++i )
+    ALWAYS_ASSERT( get( &our_vec, i - 1 )->key <= get( &our_vec, i )->key );
 
-  cleanup( &src_list );
-  cleanup( &empty_list );
-  cleanup( &our_list );
+  cleanup( &our_vec );
 }
+#endif
 
-static void test_list_dtors( void )
+static void test_vec_binary_search_and_unique( void )
 {
-  list( custom_ty ) our_list;
-  init( &our_list );
+  vec( int ) our_vec;
+  init( &our_vec );
 
-  // Test erase and clear.
+  ALWAYS_ASSERT( !binary_search( &our_vec, 0 ) );
+  ALWAYS_ASSERT( unique( &our_vec ) == 0 );
 
-  for( int i = 0; i < 100; ++i )
-  {
-    custom_ty el = { i };
-    UNTIL_SUCCESS( push( &our_list, el ) );
-  }
+  // Each even number from 0 to 198 appears three times.
+  for( int i = 0; i < 300; ++i )
+    UNTIL_SUCCESS( push( &our_vec, i % 100 * 2 ) );
 
-  bool erase = true;
-  for( custom_ty *i = first( &our_list ); i != end( &our_list ); )
+  sort( &our_vec );
+  for( int i = -1; i < 201; ++i )
   {
-    if( erase )
-      i = erase( &our_list, i );
+    int *el = binary_search( &our_vec, i );
+    if( i % 2 == 0 && i >= 0 && i < 200 )
+      ALWAYS_ASSERT( el && *el == i && el == get( &our_vec, i / 2 * 3 ) );
     else
-      i = next( &our_list, i );
+      ALWAYS_ASSERT( !el );
+  }
 
-    erase = !erase;
+  ALWAYS_ASSERT( unique( &our_vec ) == 200 );
+  ALWAYS_ASSERT( size( &our_vec ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i * 2 );
+
+  ALWAYS_ASSERT( binary_search( &our_vec, 42 ) == get( &our_vec, 21 ) );
+
+  cleanup( &our_vec );
+
+  // Test that unique calls the destructor for each erased element.
+  vec( custom_ty ) our_custom_vec;
+  init( &our_custom_vec );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    custom_ty el = { i < 100 ? i : rand() % 100 };
+    UNTIL_SUCCESS( push( &our_custom_vec, el ) );
   }
 
-  clear( &our_list );
+  sort( &our_custom_vec );
+  ALWAYS_ASSERT( unique( &our_custom_vec ) == 900 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( get( &our_custom_vec, i )->val == i );
+
+  cleanup( &our_custom_vec );
   check_dtors_arr();
+}
 
-  // Test cleanup.
+static bool is_even( void *el, void *ctx )
+{
+  ++*(size_t *)ctx;
+  return *(int *)el % 2 == 0;
+}
+
+static void test_vec_filter( void )
+{
+  vec( int ) our_vec;
+  init( &our_vec );
+
+  size_t pred_calls = 0;
+  ALWAYS_ASSERT( filter( &our_vec, is_even, &pred_calls ) == 0 );
+  ALWAYS_ASSERT( pred_calls == 0 );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( push( &our_vec, i ) );
+
+  ALWAYS_ASSERT( filter( &our_vec, is_even, &pred_calls ) == 50 );
+  ALWAYS_ASSERT( pred_calls == 100 );
+  ALWAYS_ASSERT( size( &our_vec ) == 50 );
+  for( int i = 0; i < 50; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i * 2 );
+
+  // erase_if is the inverse of filter.
+  int divisor = 4;
+  ALWAYS_ASSERT( erase_if( &our_vec, is_int_multiple, &divisor ) == 25 );
+  ALWAYS_ASSERT( size( &our_vec ) == 25 );
+  for( int i = 0; i < 25; ++i )
+    ALWAYS_ASSERT( *get( &our_vec, i ) == i * 4 + 2 );
+
+  cleanup( &our_vec );
+
+  // Test that filter calls the destructor for each erased element.
+  vec( custom_ty ) our_custom_vec;
+  init( &our_custom_vec );
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( push( &our_list, el ) );
+    UNTIL_SUCCESS( push( &our_custom_vec, el ) );
   }
 
-  cleanup( &our_list );
+  ALWAYS_ASSERT( filter( &our_custom_vec, is_custom_ty_even, NULL ) == 50 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( dtor_called[ i ] == ( i % 2 == 1 ) );
+
+  cleanup( &our_custom_vec );
   check_dtors_arr();
 }
 
 #endif
 
-// Map tests.
-#ifdef TEST_MAP
-
-static void test_map_reserve( void )
-{
-  map( int, size_t ) our_map;
-  init( &our_map );
-
-  // Reserve zero with placeholder.
-  UNTIL_SUCCESS( reserve( &our_map, 0 ) );
-  ALWAYS_ASSERT( (void *)our_map  == (void *)&cc_map_placeholder );
-
-  // Reserve up from placeholder.
-  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
-  ALWAYS_ASSERT( 30 <= cap( &our_map ) * CC_DEFAULT_LOAD );
-
-  // Reserve same capacity.
-  size_t cap = cap( &our_map );
-  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
-  ALWAYS_ASSERT( cap( &our_map ) == cap );
-
-  // Reserve up from non-placeholder.
-  UNTIL_SUCCESS( reserve( &our_map, 60 ) );
-  ALWAYS_ASSERT( 60 <= cap( &our_map ) * CC_DEFAULT_LOAD );
-
-  // Reserve lower capacity.
-  cap = cap( &our_map );
-  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
-  ALWAYS_ASSERT( cap( &our_map ) == cap );
-
-  // Test validity through use.
-  for( int i = 0; i < 60; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
-
-  // Check.
-  ALWAYS_ASSERT( size( &our_map ) == 60 );
-  for( int i = 0; i < 60; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+// List tests.
+#ifdef TEST_LIST
 
-  cleanup( &our_map );
-}
+#define LIST_CHECK                                                              \
+ALWAYS_ASSERT( size( &our_list ) == sizeof( expected ) / sizeof( *expected ) ); \
+do                                                                              \
+{                                                                               \
+  int *arr = expected;                                                          \
+  for_each( &our_list, i )                                                      \
+  {                                                                             \
+    ALWAYS_ASSERT( *i == *arr );                                                \
+    ++arr;                                                                      \
+  }                                                                             \
+}while( false )                                                                 \
 
-static void test_map_shrink( void )
+static void test_list_insert( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
-
-  // Test placeholder.
-  UNTIL_SUCCESS( shrink( &our_map ) );
-  ALWAYS_ASSERT( size( &our_map ) == 0 );
-  ALWAYS_ASSERT( cap( &our_map ) == 0 );
+  list( int ) our_list;
+  init( &our_list );
 
-  // Test restoration of placeholder.
-  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
-  UNTIL_SUCCESS( shrink( &our_map ) );
-  ALWAYS_ASSERT( size( &our_map ) == 0 );
-  ALWAYS_ASSERT( cap( &our_map ) == 0 );
-  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
+  int expected [ 90 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
+    30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,
+    50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
+    70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+    80, 81, 82, 83, 84, 85, 86, 87, 88, 89
+  };
 
-  // Test shrink same size.
-  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
+  // End.
   for( int i = 0; i < 30; ++i )
-    insert( &our_map, i, i + 1 );
-
-  ALWAYS_ASSERT( size( &our_map ) == 30 );
-  map( int, size_t ) same = our_map;
-  size_t cap = cap( &our_map );
-  UNTIL_SUCCESS( shrink( &our_map ) );
-  ALWAYS_ASSERT( our_map == same );
-  ALWAYS_ASSERT( cap( &our_map ) == cap );
-
-  // Test shrink down.
-  UNTIL_SUCCESS( reserve( &our_map, 500 ) );
-  ALWAYS_ASSERT( size( &our_map ) == 30 );
-  ALWAYS_ASSERT( 500 <= cap( &our_map ) * CC_DEFAULT_LOAD );
-  UNTIL_SUCCESS( shrink( &our_map ) );
-  ALWAYS_ASSERT( size( &our_map ) == 30 );
-  ALWAYS_ASSERT( cap( &our_map ) == cap );
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_list, end( &our_list ), 60 + i ) );
+    ALWAYS_ASSERT( *el == 60 + i );
+  }
 
-  // Check.
+  // Beginning.
   for( int i = 0; i < 30; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
-
-  cleanup( &our_map ); 
-}
-
-static void test_map_insert( void )
-{
-  map( int, size_t ) our_map;
-  init( &our_map );
-
-  // Insert new.
-  for( int i = 0; i < 100; ++i )
   {
-    size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_map, i, i + 1 ) );
-    ALWAYS_ASSERT( *el == (size_t)i + 1 );
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_list, first( &our_list ), 29 - i ) );
+    ALWAYS_ASSERT( *el == 29 - i );
   }
 
-  // Insert existing.
-  for( int i = 0; i < 100; ++i )
+  // Middle.
+  int *mid = first( &our_list );
+  for( int i = 0; i < 30; ++i )
+    mid = next( &our_list, mid );
+
+  for( int i = 0; i < 30; ++i )
   {
-    size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_map, i, i + 2 ) );
-    ALWAYS_ASSERT( *el == (size_t)i + 2 );
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_list, mid, 30 + i ) );
+    ALWAYS_ASSERT( *el == 30 + i );
   }
 
-  // Check.
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 2 );
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_get_or_insert( void )
+static void test_list_push( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
-
-  // Test insert.
-  for( int i = 0; i < 100; ++i )
-  {
-    size_t *el;
-    UNTIL_SUCCESS( ( el = get_or_insert( &our_map, i, i + 1 ) ) );
-    ALWAYS_ASSERT( *el == (size_t)i + 1 );
-  }
+  list( int ) our_list;
+  init( &our_list );
 
-  ALWAYS_ASSERT( size( &our_map ) == 100 );
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  int expected [ 100 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
+    30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,
+    50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69,
+    70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+    80, 81, 82, 83, 84, 85, 86, 87, 88, 89,
+    90, 91, 92, 93, 94, 95, 96, 97, 98, 99
+  };
 
-  // Test get.
   for( int i = 0; i < 100; ++i )
   {
-    size_t *el_1 = get( &our_map, i );
-    size_t *el_2;
-    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_map, i, i + 1 ) ) );
-    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == (size_t)i + 1 );
+    int *el;
+    UNTIL_SUCCESS( el = push( &our_list, i ) );
+    ALWAYS_ASSERT( ( *el == i ) );
   }
 
-  ALWAYS_ASSERT( size( &our_map ) == 100 );
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_get( void )
+static void test_list_splice( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
+  list( int ) our_list;
+  list( int ) src_list;
+  init( &our_list );
+  init( &src_list );
 
-  // Test empty.
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_map, i ) );
+  // Splice from one list to another.
 
-  // Test get existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+    UNTIL_SUCCESS( push( &src_list, i ) );
 
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  bool splice = true;
+  for( int *i = first( &src_list ); i != last( &src_list ); )
+  {
+    int *next = next( &src_list, i );
 
-  // Test get non-existing.
-  for( int i = 100; i < 200; ++i )
-    ALWAYS_ASSERT( !get( &our_map, i ) );
+    if( splice )
+      UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &src_list, i ) );
 
-  cleanup( &our_map );
-}
+    splice = !splice;
+    i = next;
+  }
 
-static void test_map_erase( void )
-{
-  map( int, size_t ) our_map;
-  init( &our_map );
+  ALWAYS_ASSERT( size( &our_list ) == 50 );
+  for( int *i = first( &our_list ), j = 0; i != last( &our_list ); i = next( &our_list, i ), j += 2 )
+    ALWAYS_ASSERT( *i == j );
 
-  // Test erase existing.
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &src_list ) == 50 );
+  for( int *i = first( &src_list ), j = 1; i != last( &src_list ); i = next( &src_list, i ), j += 2 )
+    ALWAYS_ASSERT( *i == j );
 
-  ALWAYS_ASSERT( size( &our_map ) == 100 );
+  // Splice within the same list.
 
-  for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_map, i ) );
+  int *i = last( &our_list );
+  while( i != r_end( &our_list ) )
+  {
+    int *prev = prev( &our_list, i );
 
-  // Test erase non-existing.
-  for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_map, i ) );
+    UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &our_list, i ) );
 
-  // Check.
-  ALWAYS_ASSERT( size( &our_map ) == 50 );
-  for( int i = 0; i < 100; ++i )
-  {
-    if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_map, i ) );
-    else
-      ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+    i = prev;
   }
 
-  cleanup( &our_map );
+  ALWAYS_ASSERT( size( &our_list ) == 50 );
+  for( int *i = first( &our_list ), j = 98; i != last( &our_list ); i = next( &our_list, i ), j -= 2 )
+    ALWAYS_ASSERT( *i == j );
+
+  cleanup( &our_list );
+  cleanup( &src_list );
 }
 
-static void test_map_erase_itr( void )
+static void test_list_erase( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
-
-  // In this instance, the key count and order of insert have been carefully chosen to cause skipped or repeat-visited
-  // keys if erase_itr does not correctly handle the case of another key being moved to the bucket of the erased key.
-  for( int i = 119; i >= 0; --i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  list( int ) our_list;
+  init( &our_list );
 
-  ALWAYS_ASSERT( size( &our_map ) == 120 );
+  int expected [ 50 ] = {
+    1, 3, 5, 7, 9,
+    11, 13, 15, 17, 19,
+    21, 23, 25, 27, 29,
+    31, 33, 35, 37, 39,
+    41, 43, 45, 47, 49,
+    51, 53, 55, 57, 59,
+    61, 63, 65, 67, 69,
+    71, 73, 75, 77, 79,
+    81, 83, 85, 87, 89,
+    91, 93, 95, 97, 99
+  };
 
-  // Test with iterator from get.
-  for( int i = 0; i < 120; i += 4 )
-    erase_itr( &our_map, get( &our_map, i ) );
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
 
-  // Check.
-  ALWAYS_ASSERT( size( &our_map ) == 90 );
-  for( int i = 0; i < 120; ++i )
+  bool erase = true;
+  for( int *i = first( &our_list ); i != end( &our_list ); )
   {
-    if( i % 4 == 0 )
-      ALWAYS_ASSERT( !get( &our_map, i ) );
+    if( erase )
+      i = erase( &our_list, i );
     else
-    {
-      size_t *el = get( &our_map, i );
-      ALWAYS_ASSERT( el && *el == i + 1 );
-    }
-  }
-
-  // Test deletion while iterating.
-  size_t *el = first( &our_map );
-  size_t n_iterations = 0;
-  while( el != end( &our_map ) )
-  {
-    ++n_iterations;
+      i = next( &our_list, i );
 
-    if( *key_for( &our_map, el ) % 2 == 0 )
-      el = erase_itr( &our_map, el );
-    else
-      el = next( &our_map, el );
+    erase = !erase;
   }
 
-  ALWAYS_ASSERT( n_iterations == 90 );
-  ALWAYS_ASSERT( size( &our_map ) == 60 );
-
-  for( int i = 0; i < 120; ++i )
-  {
-    if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_map, i ) );
-    else
-    {
-      el = get( &our_map, i );
-      ALWAYS_ASSERT( el && *el == i + 1 );
-    }
-  }
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_clear( void )
+static void test_list_clear( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
+  vec( int ) our_list;
+  init( &our_list );
 
-  // Test empty.
-  clear( &our_map );
-  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  int expected [ 30 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
+  };
 
-  // Test non-empty;
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  // Empty.
+  clear( &our_list );
+  ALWAYS_ASSERT( size( &our_list ) == 0 );
 
-  clear( &our_map );
-  ALWAYS_ASSERT( size( &our_map ) == 0 );
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_map, i ) );
+  // Non-empty.
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+  ALWAYS_ASSERT( size( &our_list ) == 30 );
 
-  // Test reuse.
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  clear( &our_list );
+  ALWAYS_ASSERT( size( &our_list ) == 0 );
 
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  // Test use.
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_cleanup( void )
+static void test_list_cleanup( void )
 {
-  map( int, size_t ) our_map;
-  init( &our_map );
+  list( int ) our_list;
+  init( &our_list );
+
+  int expected [ 30 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
+  };
 
   // Empty.
-  cleanup( &our_map );
-  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
+  cleanup( &our_list );
+  ALWAYS_ASSERT( (void *)our_list == (void *)&cc_list_placeholder );
 
   // Non-empty.
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
-  ALWAYS_ASSERT( size( &our_map ) == 100 );
-  cleanup( &our_map );
-  ALWAYS_ASSERT( size( &our_map ) == 0 );
-  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+  ALWAYS_ASSERT( size( &our_list ) == 30 );
+  cleanup( &our_list );
+  ALWAYS_ASSERT( size( &our_list ) == 0 );
+  ALWAYS_ASSERT( (void *)our_list == (void *)&cc_list_placeholder );
 
   // Test use.
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_init_clone( void )
+// This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
+// from placeholder to non-placeholder.
+static void test_list_iteration( void )
 {
-  map( int, size_t ) src_map;
-  init( &src_map );
-
-  // Test init_clone placeholder.
-  map( int, size_t ) empty_map;
-  UNTIL_SUCCESS( init_clone( &empty_map, &src_map ) );
-  ALWAYS_ASSERT( (void *)empty_map == (void *)&cc_map_placeholder );
-
-  // Test init_clone non-placeholder.
-  map( int, size_t ) our_map;
-  for( int i = 0; i < 10; ++i )
-    UNTIL_SUCCESS( insert( &src_map, i, i + 1 ) );
-  UNTIL_SUCCESS( init_clone( &our_map, &src_map ) );
-
-  // Check.
-  ALWAYS_ASSERT( size( &our_map ) == 10 );
-  for( int i = 0; i < 10; ++i )
-    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  list( int ) our_list;
+  init( &our_list );
 
-  cleanup( &src_map );
-  cleanup( &empty_map );
-  cleanup( &our_map );
-}
+  int expected [ 30 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29
+  };
 
-static void test_map_iteration_and_get_key( void )
-{
-  map( int, size_t ) our_map;
-  init( &our_map );
+  int *r_end = r_end( &our_list );
+  int *end = end( &our_list );
 
   // Empty.
 
-  // Test first and last.
-  ALWAYS_ASSERT( first( &our_map ) == end( &our_map ) );
+  // Test fist and last.
+  ALWAYS_ASSERT( first( &our_list ) == end );
+  ALWAYS_ASSERT( last( &our_list ) == r_end );
 
-  size_t n_iterations = 0;
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_list, r_end( &our_list ) ) == first( &our_list ) );
+  ALWAYS_ASSERT( prev( &our_list, end( &our_list ) ) == last( &our_list ) );
 
-  for( size_t *i = first( &our_map ); i != end( &our_map ); i = next( &our_map, i ) )
+  size_t n_iterations = 0;
+  for( int *i = first( &our_list ); i != end( &our_list ); i = next( &our_list, i ) )
     ++n_iterations;
-
-  for_each( &our_map, i )
+  for( int *i = last( &our_list ); i != r_end( &our_list ); i = prev( &our_list, i ) )
     ++n_iterations;
 
-  for_each( &our_map, k, i )
+  for_each( &our_list, i )
+    ++n_iterations;
+  for_each( &our_list, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 0 );
 
   // Non-empty.
-
   for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+    UNTIL_SUCCESS( push( &our_list, i ) );
   
-  for( size_t *i = first( &our_map ); i != end( &our_map ); i = next( &our_map, i ) )
-  {
-    ALWAYS_ASSERT( (size_t)*key_for( &our_map, i ) == *i - 1 );
+  for( int *i = first( &our_list ); i != end( &our_list ); i = next( &our_list, i ) )
     ++n_iterations;
-  }
-
-  for_each( &our_map, i )
+  for( int *i = last( &our_list ); i != r_end( &our_list ); i = prev( &our_list, i ) )
     ++n_iterations;
 
-  for_each( &our_map, k, i )
-  {
-    ALWAYS_ASSERT( (size_t)*k == *i - 1 );
+  for_each( &our_list, i )
+    ++n_iterations;
+  for_each( &our_list, i )
     ++n_iterations;
-  }
-
-  ALWAYS_ASSERT( n_iterations == 90 );
 
-  // Iteration over empty, non-placeholder map.
+  ALWAYS_ASSERT( n_iterations == 120 );
 
-  clear( &our_map );
+  // Test iterator stability.
+  ALWAYS_ASSERT( r_end( &our_list ) == r_end );
+  ALWAYS_ASSERT( end( &our_list ) == end );
 
-  n_iterations = 0;
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_list, r_end( &our_list ) ) == first( &our_list ) );
+  ALWAYS_ASSERT( prev( &our_list, end( &our_list ) ) == last( &our_list ) );
 
-  for_each( &our_map, i )
-    ++n_iterations;
+  // Test fist and last.
+  ALWAYS_ASSERT( *first( &our_list ) == 0 );
+  ALWAYS_ASSERT( *last( &our_list ) == 29 );
 
-  ALWAYS_ASSERT( n_iterations == 0 );
+  LIST_CHECK;
 
-  cleanup( &our_map );
+  cleanup( &our_list );
 }
 
-static void test_map_dtors( void )
+static void test_list_init_clone( void )
 {
-  map( custom_ty, custom_ty ) our_map;
-  init( &our_map );
+  list( int ) src_list;
+  init( &src_list );
 
-  // Test erase and clear.
+  int expected [ 10 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+  };
 
-  for( int i = 0; i < 50; ++i )
-  {
-    custom_ty key = { i };
-    custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_map, key, el ) );
-  }
+  // Test init_clone placeholder.
+  list( int ) empty_list;
+  UNTIL_SUCCESS( init_clone( &empty_list, &src_list ) );
+  ALWAYS_ASSERT( (void *)empty_list == (void *)&cc_list_placeholder );
 
-  for( int i = 0; i < 50; i += 2 )
+  // Test init_clone non-placeholder.
+  list( int ) our_list;
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( push( &src_list, i ) );
+  UNTIL_SUCCESS( init_clone( &our_list, &src_list ) ); // Note that because elements are allocated individually,
+                                                       // this loop may never exist if realloc failure rate is set too
+                                                       // high.
+  LIST_CHECK;
+
+  cleanup( &src_list );
+  cleanup( &empty_list );
+  cleanup( &our_list );
+}
+
+static void test_list_init_with_allocator( void )
+{
+  int expected [ 10 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+  };
+
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  list( int ) our_list;
+  UNTIL_SUCCESS( init_with_allocator( &our_list, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_list ) == 0 );
+
+  for( int i = 0; i < 5; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+
+  // Test splice from a list that does not share the allocator.
+  list( int ) src_list;
+  init( &src_list );
+  for( int i = 5; i < 10; ++i )
+    UNTIL_SUCCESS( push( &src_list, i ) );
+
+  while( size( &src_list ) )
+    UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &src_list, first( &src_list ) ) );
+
+  LIST_CHECK;
+
+  // Test that clones share the allocator.
+  size_t allocs_before_clone = allocs;
+  list( int ) our_list_clone;
+  UNTIL_SUCCESS( init_clone( &our_list_clone, &our_list ) );
+  ALWAYS_ASSERT( allocs > allocs_before_clone );
+
+  cleanup( &src_list );
+  cleanup( &our_list );
+  cleanup( &our_list_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_list, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+
+  int expected_el = 0;
+  for_each( &our_list, i )
+    ALWAYS_ASSERT( *i == expected_el++ );
+
+  // Test that the arena can be reset and reused.
+  cc_arena_reset( &arena );
+  UNTIL_SUCCESS( init_with_allocator( &our_list, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+  LIST_CHECK;
+
+  cleanup( &our_list );
+  cc_arena_cleanup( &arena );
+}
+
+static void test_list_memory_usage( void )
+{
+  list( int ) our_list;
+  init( &our_list );
+  check_memory_usage( memory_usage( &our_list ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_list, &allocator ) );
+  check_memory_usage( memory_usage( &our_list ), bytes, 0 );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
+
+  check_memory_usage( memory_usage( &our_list ), bytes, sizeof( int ) * 100 );
+
+  // Erase every second element.
+  for( int *i = first( &our_list ); i != end( &our_list ); )
   {
-    custom_ty key = { i };
-    erase( &our_map, key );
+    i = erase( &our_list, i );
+    if( i != end( &our_list ) )
+      i = next( &our_list, i );
   }
 
-  clear( &our_map );
+  check_memory_usage( memory_usage( &our_list ), bytes, sizeof( int ) * 50 );
 
-  check_dtors_arr();
+  cleanup( &our_list );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_list ), 0, 0 );
+}
 
-  // Test replace.
+static void test_list_dtors( void )
+{
+  list( custom_ty ) our_list;
+  init( &our_list );
 
-  for( int i = 0; i < 50; ++i )
+  // Test erase and clear.
+
+  for( int i = 0; i < 100; ++i )
   {
-    custom_ty key = { i };
-    custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+    custom_ty el = { i };
+    UNTIL_SUCCESS( push( &our_list, el ) );
   }
-  for( int i = 0; i < 50; ++i )
+
+  bool erase = true;
+  for( custom_ty *i = first( &our_list ); i != end( &our_list ); )
   {
-    custom_ty key = { i };
-    custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+    if( erase )
+      i = erase( &our_list, i );
+    else
+      i = next( &our_list, i );
+
+    erase = !erase;
   }
 
+  clear( &our_list );
   check_dtors_arr();
-  clear( &our_map );
 
   // Test cleanup.
 
-  for( int i = 0; i < 50; ++i )
+  for( int i = 0; i < 100; ++i )
   {
-    custom_ty key = { i };
-    custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+    custom_ty el = { i };
+    UNTIL_SUCCESS( push( &our_list, el ) );
   }
 
-  cleanup( &our_map );
+  cleanup( &our_list );
   check_dtors_arr();
 }
 
-// Strings are a special case that warrant seperate testing.
-static void test_map_strings( void )
-{
-  map( char *, char * ) our_map;
-  init( &our_map );
+#ifdef CC_POOL_NODES
 
-  char **el;
+// Stateful allocator that counts its outstanding allocations like counting_realloc but always fails while
+// fail_pool_allocs is set.
+bool fail_pool_allocs;
+static void *failable_counting_realloc( void *ctx, void *ptr, size_t size )
+{
+  if( fail_pool_allocs )
+    return NULL;
 
-  // String literals.
-  UNTIL_SUCCESS( ( el = insert( &our_map, "This", "is" ) ) );
-  ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
-  UNTIL_SUCCESS( ( el = get_or_insert( &our_map, "a", "test" ) ) );
-  ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
+  return counting_realloc( ctx, ptr, size );
+}
 
-  // Other strings.
-  char str_1[] = "of";
-  char str_2[] = "maps";
-  char str_3[] = "with";
-  char str_4[] = "strings.";
+static void test_list_pool( void )
+{
+  int expected [ 10 ] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+  };
 
-  UNTIL_SUCCESS( ( el = insert( &our_map, str_1, str_2 ) ) );
-  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = get_or_insert( &our_map, str_3, str_4 ) ) );
-  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+  size_t src_allocs = 0;
+  cc_allocator src_allocator = { counting_realloc, counting_free, &src_allocs };
+  size_t allocs = 0;
+  cc_allocator allocator = { failable_counting_realloc, counting_free, &allocs };
 
-  // Check.
-  ALWAYS_ASSERT( size( &our_map ) == 4 );
-  ALWAYS_ASSERT( strcmp( *get( &our_map, "This" ), "is" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_map, "a" ), "test" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_map, str_1, str_2 ) ) );
-  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_map, str_3, str_4 ) ) );
-  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
-  ALWAYS_ASSERT( size( &our_map ) == 4 );
+  list( int ) src_list;
+  UNTIL_SUCCESS( init_with_allocator( &src_list, &src_allocator ) );
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( push( &src_list, i ) );
 
-  // Erase.
-  erase( &our_map, "This" );
-  erase( &our_map, str_1 );
-  ALWAYS_ASSERT( size( &our_map ) == 2 );
+  list( int ) our_list;
+  UNTIL_SUCCESS( init_with_allocator( &our_list, &allocator ) );
+
+  // Test that a splice between different lists, even ones sharing an allocator, copies the element into a node from
+  // the destination list's pool, leaving the source list intact if that allocation fails.
+  int *src_i = next( &src_list, first( &src_list ) );
+  fail_pool_allocs = true;
+  ALWAYS_ASSERT( !splice( &our_list, end( &our_list ), &src_list, src_i ) );
+  fail_pool_allocs = false;
+  ALWAYS_ASSERT( size( &our_list ) == 0 );
+  ALWAYS_ASSERT( size( &src_list ) == 10 );
+  ALWAYS_ASSERT( *src_i == 1 );
+  int j = 0;
+  for_each( &src_list, i )
+    ALWAYS_ASSERT( *i == j++ );
+
+  UNTIL_SUCCESS( splice( &our_list, end( &our_list ), &src_list, src_i ) ); // Invalidates src_i.
+  ALWAYS_ASSERT( size( &our_list ) == 1 );
+  ALWAYS_ASSERT( *first( &our_list ) == 1 );
+  ALWAYS_ASSERT( size( &src_list ) == 9 );
+  ALWAYS_ASSERT( *next( &src_list, first( &src_list ) ) == 2 );
+
+  // The source list recycles the spliced element's node.
+  size_t src_allocs_before = src_allocs;
+  ALWAYS_ASSERT( insert( &src_list, next( &src_list, first( &src_list ) ), 1 ) );
+  ALWAYS_ASSERT( src_allocs == src_allocs_before );
+  cleanup( &src_list );
+  ALWAYS_ASSERT( src_allocs == 0 );
 
-  // Iteration.
-  for_each( &our_map, i )
-    ALWAYS_ASSERT( strcmp( *i, "test" ) == 0 || strcmp( *i, str_4 ) == 0 );
+  // Test that clear retains the slabs for reuse.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( push( &our_list, i ) );
 
-  cleanup( &our_map );
-}
+  size_t allocs_before = allocs;
+  clear( &our_list );
+  ALWAYS_ASSERT( allocs == allocs_before );
+
+  fail_pool_allocs = true;
+  for( int i = 0; i < 101; ++i )
+    ALWAYS_ASSERT( push( &our_list, i ) );
+  fail_pool_allocs = false;
+  ALWAYS_ASSERT( allocs == allocs_before );
+  ALWAYS_ASSERT( size( &our_list ) == 101 );
+  j = 0;
+  for_each( &our_list, i )
+    ALWAYS_ASSERT( *i == j++ );
 
-#define TEST_MAP_DEFAULT_INTEGER_TYPE( ty )    \
-{                                              \
-  map( ty, int ) our_map;                      \
-  init( &our_map );                            \
-                                               \
-  for( int i = 0; i < 100; ++i )               \
-    UNTIL_SUCCESS( insert( &our_map, i, i ) ); \
-                                               \
-  for( int i = 0; i < 100; ++i )               \
-    ALWAYS_ASSERT( *get( &our_map, i ) == i ); \
-                                               \
-  cleanup( &our_map );                         \
-}                                              \
+  // Test that cleanup frees the slabs while some nodes are still in use, some are recycled, and some were never
+  // carved.
+  while( size( &our_list ) > 10 )
+    erase( &our_list, last( &our_list ) );
+  LIST_CHECK;
 
-static void test_map_default_integer_types( void )
-{
-  TEST_MAP_DEFAULT_INTEGER_TYPE( char );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned char );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( signed char );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned short );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( short );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned int );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( int );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned long );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( long );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned long long );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( long );
-  TEST_MAP_DEFAULT_INTEGER_TYPE( size_t );
+  cleanup( &our_list );
+  ALWAYS_ASSERT( allocs == 0 );
 }
 
 #endif
 
-// Set tests.
-#ifdef TEST_SET
+#endif
 
-static void test_set_reserve( void )
+// Map tests.
+#ifdef TEST_MAP
+
+static void test_map_reserve( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Reserve zero with placeholder.
-  UNTIL_SUCCESS( reserve( &our_set, 0 ) );
-  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+  UNTIL_SUCCESS( reserve( &our_map, 0 ) );
+  ALWAYS_ASSERT( (void *)our_map  == (void *)&cc_map_placeholder );
 
   // Reserve up from placeholder.
-  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
-  ALWAYS_ASSERT( 30 <= cap( &our_set ) * CC_DEFAULT_LOAD );
+  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
+  ALWAYS_ASSERT( 30 <= cap( &our_map ) * CC_DEFAULT_LOAD );
 
   // Reserve same capacity.
-  size_t cap = cap( &our_set );
-  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
-  ALWAYS_ASSERT( cap( &our_set ) == cap );
+  size_t cap = cap( &our_map );
+  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
+  ALWAYS_ASSERT( cap( &our_map ) == cap );
 
   // Reserve up from non-placeholder.
-  UNTIL_SUCCESS( reserve( &our_set, 60 ) );
-  ALWAYS_ASSERT( 60 <= cap( &our_set ) * CC_DEFAULT_LOAD );
+  UNTIL_SUCCESS( reserve( &our_map, 60 ) );
+  ALWAYS_ASSERT( 60 <= cap( &our_map ) * CC_DEFAULT_LOAD );
 
   // Reserve lower capacity.
-  cap = cap( &our_set );
-  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
-  ALWAYS_ASSERT( cap( &our_set ) == cap );
+  cap = cap( &our_map );
+  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
+  ALWAYS_ASSERT( cap( &our_map ) == cap );
 
   // Test validity through use.
   for( int i = 0; i < 60; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_set ) == 60 );
+  ALWAYS_ASSERT( size( &our_map ) == 60 );
   for( int i = 0; i < 60; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_shrink( void )
+static void test_map_shrink( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Test placeholder.
-  UNTIL_SUCCESS( shrink( &our_set ) );
-  ALWAYS_ASSERT( size( &our_set ) == 0 );
-  ALWAYS_ASSERT( cap( &our_set ) == 0 );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( cap( &our_map ) == 0 );
 
   // Test restoration of placeholder.
-  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
-  UNTIL_SUCCESS( shrink( &our_set ) );
-  ALWAYS_ASSERT( size( &our_set ) == 0 );
-  ALWAYS_ASSERT( cap( &our_set ) == 0 );
-  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( cap( &our_map ) == 0 );
+  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
 
   // Test shrink same size.
-  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  UNTIL_SUCCESS( reserve( &our_map, 30 ) );
   for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    insert( &our_map, i, i + 1 );
 
-  ALWAYS_ASSERT( size( &our_set ) == 30 );
-  set( int ) same = our_set;
-  size_t cap = cap( &our_set );
-  UNTIL_SUCCESS( shrink( &our_set ) );
-  ALWAYS_ASSERT( our_set == same );
-  ALWAYS_ASSERT( cap( &our_set ) == cap );
+  ALWAYS_ASSERT( size( &our_map ) == 30 );
+  map( int, size_t ) same = our_map;
+  size_t cap = cap( &our_map );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( our_map == same );
+  ALWAYS_ASSERT( cap( &our_map ) == cap );
 
   // Test shrink down.
-  UNTIL_SUCCESS( reserve( &our_set, 500 ) );
-  ALWAYS_ASSERT( size( &our_set ) == 30 );
-  ALWAYS_ASSERT( 500 <= cap( &our_set ) * CC_DEFAULT_LOAD );
-  UNTIL_SUCCESS( shrink( &our_set ) );
-
-  ALWAYS_ASSERT( size( &our_set ) == 30 );
-  ALWAYS_ASSERT( cap( &our_set ) == cap );
+  UNTIL_SUCCESS( reserve( &our_map, 500 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 30 );
+  ALWAYS_ASSERT( 500 <= cap( &our_map ) * CC_DEFAULT_LOAD );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( size( &our_map ) == 30 );
+  ALWAYS_ASSERT( cap( &our_map ) == cap );
 
   // Check.
   for( int i = 0; i < 30; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
 
-  cleanup( &our_set ); 
+  cleanup( &our_map ); 
 }
 
-static void test_set_insert( void )
+static void test_map_insert( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Insert new.
   for( int i = 0; i < 100; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( el = insert( &our_set, i ) );
-    ALWAYS_ASSERT( ( *el == i ) );
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_map, i, i + 1 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 1 );
   }
 
   // Insert existing.
   for( int i = 0; i < 100; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( el = insert( &our_set, i ) );
-    ALWAYS_ASSERT( ( *el == i ) );
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_map, i, i + 2 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 2 );
   }
 
   // Check.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 2 );
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_get_or_insert( void )
+// If CC_INCREMENTAL_REHASH is defined, this tests that lookups, iteration, erasure, and cloning work while key-element
+// pairs are split between the old and new tables.
+static void test_map_insert_n( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  // Test insertion into an empty map, with keys in scrambled order.
+  int keys[ 1000 ];
+  size_t els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+  {
+    keys[ i ] = i * 337 % 1000;
+    els[ i ] = keys[ i ] + 1;
+  }
+
+  UNTIL_SUCCESS( insert_n( &our_map, keys, els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+
+  // Test insertion into a non-empty map, with some keys already present and repeated keys, of which the last wins.
+  for( int i = 0; i < 100; ++i )
+  {
+    keys[ i ] = 950 + i / 2;
+    els[ i ] = i;
+  }
+
+  UNTIL_SUCCESS( insert_n( &our_map, keys, els, 100 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+  for( int i = 950; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)( i - 950 ) * 2 + 1 );
+
+  // Test zero keys.
+  UNTIL_SUCCESS( insert_n( &our_map, keys, els, 0 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_growth( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+    // Check periodically.
+    if( i % 37 == 0 )
+    {
+      for( int j = 0; j <= i; ++j )
+        ALWAYS_ASSERT( *get( &our_map, j ) == (size_t)j + 1 );
+
+      size_t n_iterations = 0;
+      for_each( &our_map, key, el )
+      {
+        ALWAYS_ASSERT( *el == (size_t)*key + 1 );
+        ++n_iterations;
+      }
+      ALWAYS_ASSERT( n_iterations == size( &our_map ) );
+    }
+  }
+
+  // Test erasure while iterating.
+  size_t *el = first( &our_map );
+  while( el != end( &our_map ) )
+  {
+    if( *key_for( &our_map, el ) % 3 == 0 )
+      el = erase_itr( &our_map, el );
+    else
+      el = next( &our_map, el );
+  }
+
+  ALWAYS_ASSERT( size( &our_map ) == 666 );
+
+  // Test erasure by key and cloning.
+  for( int i = 1; i < 1000; i += 3 )
+    ALWAYS_ASSERT( erase( &our_map, i ) );
+
+  map( int, size_t ) our_map_clone;
+  UNTIL_SUCCESS( init_clone( &our_map_clone, &our_map ) );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    if( i % 3 == 2 )
+    {
+      ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+      ALWAYS_ASSERT( *get( &our_map_clone, i ) == (size_t)i + 1 );
+    }
+    else
+    {
+      ALWAYS_ASSERT( !get( &our_map, i ) );
+      ALWAYS_ASSERT( !get( &our_map_clone, i ) );
+    }
+  }
+
+  cleanup( &our_map );
+  cleanup( &our_map_clone );
+}
+
+static void test_map_get_or_insert( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Test insert.
   for( int i = 0; i < 100; ++i )
   {
-    int *el;
-    UNTIL_SUCCESS( ( el = get_or_insert( &our_set, i ) ) );
-    ALWAYS_ASSERT( *el == i );
+    size_t *el;
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_map, i, i + 1 ) ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 1 );
   }
 
-  ALWAYS_ASSERT( size( &our_set ) == 100 );
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
 
   // Test get.
   for( int i = 0; i < 100; ++i )
   {
-    int *el_1 = get( &our_set, i );
-    int *el_2;
-    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_set, i ) ) );
-    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == i );
+    size_t *el_1 = get( &our_map, i );
+    size_t *el_2;
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_map, i, i + 1 ) ) );
+    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == (size_t)i + 1 );
   }
 
-  ALWAYS_ASSERT( size( &our_set ) == 100 );
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_get( void )
+static void test_map_get( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Test empty.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_set, i ) );
+    ALWAYS_ASSERT( !get( &our_map, i ) );
 
   // Test get existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
 
   // Test get non-existing.
   for( int i = 100; i < 200; ++i )
-    ALWAYS_ASSERT( !get( &our_set, i ) );
+    ALWAYS_ASSERT( !get( &our_map, i ) );
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_erase( void )
+static void test_map_get_n( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  int keys[ 200 ];
+  size_t *itrs[ 200 ];
+  for( int i = 0; i < 200; ++i )
+    keys[ i ] = i;
+
+  // Test empty.
+  ALWAYS_ASSERT( get_n( &our_map, keys, 200, itrs ) == 0 );
+  for( int i = 0; i < 200; ++i )
+    ALWAYS_ASSERT( !itrs[ i ] );
+
+  // Test mix of existing and non-existing, with a count that is not a multiple of the batch size.
+  for( int i = 0; i < 200; i += 2 )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+  ALWAYS_ASSERT( get_n( &our_map, keys, 199, itrs ) == 100 );
+  for( int i = 0; i < 199; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( itrs[ i ] == get( &our_map, i ) && *itrs[ i ] == (size_t)i + 1 );
+    else
+      ALWAYS_ASSERT( !itrs[ i ] );
+  }
+
+  // Test zero keys.
+  ALWAYS_ASSERT( get_n( &our_map, keys, 0, itrs ) == 0 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_erase( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Test erase existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
-  ALWAYS_ASSERT( size( &our_set ) == 100 );
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
 
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_set, i ) );
+    ALWAYS_ASSERT( erase( &our_map, i ) );
 
   // Test erase non-existing.
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_set, i ) );
+    ALWAYS_ASSERT( !erase( &our_map, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_set ) == 50 );
+  ALWAYS_ASSERT( size( &our_map ) == 50 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_set, i ) );
+      ALWAYS_ASSERT( !get( &our_map, i ) );
     else
-      ALWAYS_ASSERT( *get( &our_set, i ) == i );
+      ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
   }
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_erase_itr( void )
+static void test_map_erase_n( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+  // Test mix of existing, non-existing, and repeated keys, with a count that is not a multiple of the batch size.
+  int keys[ 150 ];
+  for( int i = 0; i < 100; ++i )
+    keys[ i ] = i * 2;
+
+  for( int i = 100; i < 150; ++i )
+    keys[ i ] = i - 100;
+
+  ALWAYS_ASSERT( erase_n( &our_map, keys, 150 ) == 75 );
+  ALWAYS_ASSERT( size( &our_map ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_map, i ) == ( i % 2 == 0 || i < 50 ) );
+
+  // Test zero keys.
+  ALWAYS_ASSERT( erase_n( &our_map, keys, 0 ) == 0 );
+  ALWAYS_ASSERT( size( &our_map ) == 25 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_erase_itr( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // In this instance, the key count and order of insert have been carefully chosen to cause skipped or repeat-visited
-  // keys if vt_erase_itr does not correctly handle the case of another key being moved to the bucket of the erased key.
+  // keys if erase_itr does not correctly handle the case of another key being moved to the bucket of the erased key.
   for( int i = 119; i >= 0; --i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
-  ALWAYS_ASSERT( size( &our_set ) == 120 );
+  ALWAYS_ASSERT( size( &our_map ) == 120 );
 
   // Test with iterator from get.
   for( int i = 0; i < 120; i += 4 )
-    erase_itr( &our_set, get( &our_set, i ) );
+    erase_itr( &our_map, get( &our_map, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_set ) == 90 );
+  ALWAYS_ASSERT( size( &our_map ) == 90 );
   for( int i = 0; i < 120; ++i )
   {
     if( i % 4 == 0 )
-      ALWAYS_ASSERT( !get( &our_set, i ) );
+      ALWAYS_ASSERT( !get( &our_map, i ) );
     else
     {
-      int *el = get( &our_set, i );
-      ALWAYS_ASSERT( el && *el == i );
+      size_t *el = get( &our_map, i );
+      ALWAYS_ASSERT( el && *el == i + 1 );
     }
   }
 
   // Test deletion while iterating.
-  int *el = first( &our_set );
+  size_t *el = first( &our_map );
   size_t n_iterations = 0;
-  while( el != end( &our_set ) )
+  while( el != end( &our_map ) )
   {
     ++n_iterations;
 
-    if( *el % 2 == 0 )
-      el = erase_itr( &our_set, el );
+    if( *key_for( &our_map, el ) % 2 == 0 )
+      el = erase_itr( &our_map, el );
     else
-      el = next( &our_set, el );
+      el = next( &our_map, el );
   }
 
   ALWAYS_ASSERT( n_iterations == 90 );
-  ALWAYS_ASSERT( size( &our_set ) == 60 );
+  ALWAYS_ASSERT( size( &our_map ) == 60 );
 
   for( int i = 0; i < 120; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_set, i ) );
+      ALWAYS_ASSERT( !get( &our_map, i ) );
     else
     {
-      el = get( &our_set, i );
-      ALWAYS_ASSERT( el && *el == i );
+      el = get( &our_map, i );
+      ALWAYS_ASSERT( el && *el == i + 1 );
     }
   }
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_clear( void )
+static void test_map_cursor( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  cc_cursor cursor;
+  ALWAYS_ASSERT( cursor_first( &our_map, &cursor ) == end( &our_map ) );
+
+  size_t n_iterations = 0;
+  for_each_fast( &our_map, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Check that every key is visited exactly once after each insertion, which, if CC_INCREMENTAL_REHASH is defined,
+  // includes iteration while key-element pairs remain in the old table.
+  for( int i = 119; i >= 0; --i )
+  {
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+    size_t key_sum = 0;
+    n_iterations = 0;
+    for_each_fast( &our_map, key, el )
+    {
+      ALWAYS_ASSERT( *el == (size_t)*key + 1 );
+      key_sum += *key;
+      ++n_iterations;
+    }
+
+    ALWAYS_ASSERT( n_iterations == 120 - (size_t)i );
+    ALWAYS_ASSERT( key_sum == ( 119 + (size_t)i ) * ( 120 - (size_t)i ) / 2 );
+  }
+
+  // Test break.
+  n_iterations = 0;
+  for_each_fast( &our_map, i )
+  {
+    if( ++n_iterations == 10 )
+      break;
+  }
+
+  ALWAYS_ASSERT( n_iterations == 10 );
+
+  // Test deletion while iterating.
+  // As in test_map_erase_itr, keys moved into the bucket of an erased key must be visited exactly once.
+  n_iterations = 0;
+  size_t *el = cursor_first( &our_map, &cursor );
+  while( el != end( &our_map ) )
+  {
+    ++n_iterations;
+
+    if( *key_for( &our_map, el ) % 2 == 0 )
+      el = cursor_erase( &our_map, &cursor );
+    else
+      el = cursor_next( &our_map, &cursor );
+  }
+
+  ALWAYS_ASSERT( n_iterations == 120 );
+  ALWAYS_ASSERT( size( &our_map ) == 60 );
+
+  for( int i = 0; i < 120; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_map, i ) );
+    else
+    {
+      el = get( &our_map, i );
+      ALWAYS_ASSERT( el && *el == (size_t)i + 1 );
+    }
+  }
+
+  // Erase the rest.
+  el = cursor_first( &our_map, &cursor );
+  while( el != end( &our_map ) )
+    el = cursor_erase( &our_map, &cursor );
+
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_erase_if( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  size_t divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_map, is_size_t_multiple, &divisor ) == 0 );
+
+  // Small map, which is flat if CC_FLAT_SMALL_MAPS is defined.
+  for( int i = 0; i < 5; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i ) );
+
+  divisor = 2;
+  ALWAYS_ASSERT( erase_if( &our_map, is_size_t_multiple, &divisor ) == 3 );
+  ALWAYS_ASSERT( size( &our_map ) == 2 );
+  ALWAYS_ASSERT( *get( &our_map, 1 ) == 1 && *get( &our_map, 3 ) == 3 );
+
+  // Erase the multiples of three, and then keep only the even elements among the rest.
+  // The elements are equal to the keys.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i ) );
+
+  divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_map, is_size_t_multiple, &divisor ) == 334 );
+  ALWAYS_ASSERT( size( &our_map ) == 666 );
+
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_map, is_size_t_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_map ) == 333 );
+
+  size_t n_iterations = 0;
+  for_each( &our_map, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 333 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    size_t *el = get( &our_map, i );
+    if( i % 2 == 0 && i % 3 != 0 )
+      ALWAYS_ASSERT( el && *el == (size_t)i );
+    else
+      ALWAYS_ASSERT( !el );
+  }
+
+  // The chains remain intact, so every key can be reinserted and then erased individually.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i ) );
+
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( erase( &our_map, i ) );
+
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+
+  // Erase everything.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i ) );
+
+  divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_map, is_size_t_multiple, &divisor ) == 1000 );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( first( &our_map ) == end( &our_map ) );
+
+  cleanup( &our_map );
+
+  // Test that erase_if calls the destructors for each erased key and element.
+  map( custom_ty, custom_ty ) our_custom_map;
+  init( &our_custom_map );
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_custom_map, key, el ) );
+  }
+
+  ALWAYS_ASSERT( erase_if( &our_custom_map, is_custom_ty_even, NULL ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( dtor_called[ i ] == ( i % 2 == 0 ) );
+
+  cleanup( &our_custom_map );
+  check_dtors_arr();
+}
+
+static void test_map_clear( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Test empty.
-  clear( &our_set );
-  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  clear( &our_map );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
 
   // Test non-empty;
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
-  clear( &our_set );
-  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  clear( &our_map );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_set, i ) );
+    ALWAYS_ASSERT( !get( &our_map, i ) );
 
   // Test reuse.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
 
-  cleanup( &our_set );
+  cleanup( &our_map );
 }
 
-static void test_set_cleanup( void )
+static void test_map_cleanup( void )
 {
-  set( int ) our_set;
-  init( &our_set );
+  map( int, size_t ) our_map;
+  init( &our_map );
 
   // Empty.
-  cleanup( &our_set );
-  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+  cleanup( &our_map );
+  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
 
   // Non-empty.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
-  ALWAYS_ASSERT( size( &our_set ) == 100 );
-  cleanup( &our_set );
-  ALWAYS_ASSERT( size( &our_set ) == 0 );
-  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
+  cleanup( &our_map );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( (void *)our_map == (void *)&cc_map_placeholder );
+
+  // Test use.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_init_clone( void )
+{
+  map( int, size_t ) src_map;
+  init( &src_map );
+
+  // Test init_clone placeholder.
+  map( int, size_t ) empty_map;
+  UNTIL_SUCCESS( init_clone( &empty_map, &src_map ) );
+  ALWAYS_ASSERT( (void *)empty_map == (void *)&cc_map_placeholder );
+
+  // Test init_clone non-placeholder.
+  map( int, size_t ) our_map;
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &src_map, i, i + 1 ) );
+  UNTIL_SUCCESS( init_clone( &our_map, &src_map ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_map ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+
+  cleanup( &src_map );
+  cleanup( &empty_map );
+  cleanup( &our_map );
+}
+
+static void test_map_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  map( int, size_t ) our_map;
+  UNTIL_SUCCESS( init_with_allocator( &our_map, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  ALWAYS_ASSERT( allocs == 1 );
+
+  // Test that clones share the allocator.
+  map( int, size_t ) our_map_clone;
+  UNTIL_SUCCESS( init_clone( &our_map_clone, &our_map ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  ALWAYS_ASSERT( size( &our_map_clone ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_map_clone, i ) == (size_t)i + 1 );
+
+  // Test that shrinking an empty map keeps it associated with the allocator.
+  clear( &our_map );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  ALWAYS_ASSERT( cap( &our_map ) > 0 );
+
+  cleanup( &our_map );
+  cleanup( &our_map_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_map, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+
+  cleanup( &our_map );
+  cc_arena_cleanup( &arena );
+}
+
+static void test_map_init_with_fixed_buffer( void )
+{
+  map( int, size_t ) our_map;
+  fmap( int, size_t, 16 ) our_map_buf;
+
+  size_t allocs_before = oustanding_allocs;
+
+  init_with_fixed_buffer( &our_map, &our_map_buf );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( cap( &our_map ) == 16 );
+
+  // Insert until the map would need to rehash.
+  int n = 0;
+  while( insert( &our_map, n, n + 1 ) )
+    ++n;
+  ALWAYS_ASSERT( n >= 8 && n <= 16 );
+  ALWAYS_ASSERT( size( &our_map ) == (size_t)n );
+  ALWAYS_ASSERT( cap( &our_map ) == 16 );
+  ALWAYS_ASSERT( !reserve( &our_map, 17 ) );
+  for( int i = 0; i < n; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+  ALWAYS_ASSERT( !get( &our_map, n ) );
+
+  // Test that replacing an existing key and reinserting after erasure succeed.
+  ALWAYS_ASSERT( insert( &our_map, 0, 100 ) );
+  ALWAYS_ASSERT( *get( &our_map, 0 ) == 100 );
+  ALWAYS_ASSERT( erase( &our_map, 0 ) );
+  ALWAYS_ASSERT( insert( &our_map, n, n + 1 ) );
+  ALWAYS_ASSERT( *get( &our_map, n ) == (size_t)n + 1 );
+
+  // Test that init_clone fails rather than allocating.
+  map( int, size_t ) our_map_clone;
+  ALWAYS_ASSERT( !init_clone( &our_map_clone, &our_map ) );
+
+  clear( &our_map );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( insert( &our_map, 0, 1 ) );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+
+  // Test that the buffer can be reused after cleanup.
+  cleanup( &our_map );
+  init_with_fixed_buffer( &our_map, &our_map_buf );
+  ALWAYS_ASSERT( size( &our_map ) == 0 );
+  ALWAYS_ASSERT( insert( &our_map, 0, 1 ) );
+  cleanup( &our_map );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+}
+
+static void test_map_iteration_and_get_key( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  // Empty.
+
+  // Test first and last.
+  ALWAYS_ASSERT( first( &our_map ) == end( &our_map ) );
+
+  size_t n_iterations = 0;
+
+  for( size_t *i = first( &our_map ); i != end( &our_map ); i = next( &our_map, i ) )
+    ++n_iterations;
+
+  for_each( &our_map, i )
+    ++n_iterations;
+
+  for_each( &our_map, k, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  
+  for( size_t *i = first( &our_map ); i != end( &our_map ); i = next( &our_map, i ) )
+  {
+    ALWAYS_ASSERT( (size_t)*key_for( &our_map, i ) == *i - 1 );
+    ++n_iterations;
+  }
+
+  for_each( &our_map, i )
+    ++n_iterations;
+
+  for_each( &our_map, k, i )
+  {
+    ALWAYS_ASSERT( (size_t)*k == *i - 1 );
+    ++n_iterations;
+  }
+
+  ALWAYS_ASSERT( n_iterations == 90 );
+
+  // Iteration over empty, non-placeholder map.
+
+  clear( &our_map );
+
+  n_iterations = 0;
+
+  for_each( &our_map, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_memory_usage( void )
+{
+  map( int, short ) our_map;
+  init( &our_map );
+  check_memory_usage( memory_usage( &our_map ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_map, &allocator ) );
+  check_memory_usage( memory_usage( &our_map ), bytes, 0 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_map, i, (short)i ) );
+    check_memory_usage( memory_usage( &our_map ), bytes, ( sizeof( int ) + sizeof( short ) ) * (size_t)( i + 1 ) );
+  }
+
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_map, i ) );
+
+  check_memory_usage( memory_usage( &our_map ), bytes, ( sizeof( int ) + sizeof( short ) ) * 100 );
+
+  // Test that shrinking reduces the overhead.
+  size_t overhead = memory_usage( &our_map ).overhead;
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  check_memory_usage( memory_usage( &our_map ), bytes, ( sizeof( int ) + sizeof( short ) ) * 100 );
+  ALWAYS_ASSERT( memory_usage( &our_map ).overhead < overhead );
+
+  cleanup( &our_map );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_map ), 0, 0 );
+}
+
+static void test_map_dtors( void )
+{
+  map( custom_ty, custom_ty ) our_map;
+  init( &our_map );
+
+  // Test erase and clear.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+  }
+
+  for( int i = 0; i < 50; i += 2 )
+  {
+    custom_ty key = { i };
+    erase( &our_map, key );
+  }
+
+  clear( &our_map );
+
+  check_dtors_arr();
+
+  // Test replace.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+  }
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+  }
+
+  check_dtors_arr();
+  clear( &our_map );
+
+  // Test cleanup.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+  }
+
+  cleanup( &our_map );
+  check_dtors_arr();
+}
+
+// Keys 0 to 49 map to elements 50 to 99, so calling either destructor on the wrong member would mark the wrong half.
+static void test_map_key_and_el_dtors( void )
+{
+  map( custom_ty, custom_el_ty ) our_map;
+  init( &our_map );
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_el_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_map, key, el ) );
+  }
+
+  cleanup( &our_map );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    ALWAYS_ASSERT( dtor_called[ i ] == ( i < 50 ) );
+    ALWAYS_ASSERT( el_dtor_called[ i ] == ( i >= 50 ) );
+    dtor_called[ i ] = false;
+    el_dtor_called[ i ] = false;
+  }
+}
+
+// Strings are a special case that warrant seperate testing.
+static void test_map_strings( void )
+{
+  map( char *, char * ) our_map;
+  init( &our_map );
+
+  char **el;
+
+  // String literals.
+  UNTIL_SUCCESS( ( el = insert( &our_map, "This", "is" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_map, "a", "test" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
+
+  // Other strings.
+  char str_1[] = "of";
+  char str_2[] = "maps";
+  char str_3[] = "with";
+  char str_4[] = "strings.";
+
+  UNTIL_SUCCESS( ( el = insert( &our_map, str_1, str_2 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_map, str_3, str_4 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_map ) == 4 );
+  ALWAYS_ASSERT( strcmp( *get( &our_map, "This" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_map, "a" ), "test" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_map, str_1, str_2 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_map, str_3, str_4 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+  ALWAYS_ASSERT( size( &our_map ) == 4 );
+
+  // Erase.
+  erase( &our_map, "This" );
+  erase( &our_map, str_1 );
+  ALWAYS_ASSERT( size( &our_map ) == 2 );
+
+  // Iteration.
+  for_each( &our_map, i )
+    ALWAYS_ASSERT( strcmp( *i, "test" ) == 0 || strcmp( *i, str_4 ) == 0 );
+
+  cleanup( &our_map );
+}
+
+// The default C-string hash function reads whole words, so check that the hash code of a string doesn't depend on
+// where it is stored, including when it straddles a page boundary.
+static void test_map_strings_unaligned( void )
+{
+  map( char *, size_t ) our_map;
+  init( &our_map );
+
+  static char originals[ 41 ][ 41 ];
+  for( size_t len = 0; len < 41; ++len )
+  {
+    for( size_t i = 0; i < len; ++i )
+      originals[ len ][ i ] = (char)( 'a' + ( i * 7 + len ) % 26 );
+
+    originals[ len ][ len ] = '\0';
+    UNTIL_SUCCESS( insert( &our_map, originals[ len ], len ) );
+  }
+
+  ALWAYS_ASSERT( size( &our_map ) == 41 );
+
+  static char buffer[ 3 * 4096 ];
+  char *page_boundary = buffer + 2 * 4096 - (uintptr_t)buffer % 4096;
+
+  for( size_t len = 0; len < 41; ++len )
+    for( char *copy = page_boundary - 48; copy < page_boundary + 8; ++copy )
+    {
+      memcpy( copy, originals[ len ], len + 1 );
+      size_t *el = get( &our_map, copy );
+      ALWAYS_ASSERT( el && *el == len );
+    }
+
+  cleanup( &our_map );
+}
+
+static void test_map_str( void )
+{
+  map( cc_str, int ) our_map;
+  init( &our_map );
+
+  // "abc\0abd" followed by 100 letters.
+  char chars[ 108 ] = "abc\0abd";
+  for( int i = 0; i < 100; ++i )
+    chars[ 8 + i ] = (char)( 'A' + i % 26 );
+
+  cc_str strs[] = {
+    { chars, 0 },      // Empty.
+    { chars, 2 },      // "ab".
+    { chars, 3 },      // "abc".
+    { chars, 4 },      // "abc\0".
+    { chars + 4, 3 },  // "abd".
+    { chars + 8, 99 },
+    { chars + 8, 100 }
+  };
+
+  for( int i = 0; i < 7; ++i )
+    UNTIL_SUCCESS( insert( &our_map, strs[ i ], i ) );
+
+  ALWAYS_ASSERT( size( &our_map ) == 7 );
+
+  // Look up via copies of the strings stored elsewhere.
+  char chars_copy[ 108 ];
+  memcpy( chars_copy, chars, sizeof( chars ) );
+
+  for( int i = 0; i < 7; ++i )
+  {
+    cc_str key = { chars_copy + ( strs[ i ].data - chars ), strs[ i ].len };
+    ALWAYS_ASSERT( *get( &our_map, key ) == i );
+  }
+
+  // Absent strings.
+  cc_str absent_1 = { chars_copy, 1 };
+  cc_str absent_2 = { chars_copy + 8, 98 };
+  ALWAYS_ASSERT( !get( &our_map, absent_1 ) );
+  ALWAYS_ASSERT( !get( &our_map, absent_2 ) );
+
+  // Replace and erase.
+  UNTIL_SUCCESS( insert( &our_map, strs[ 3 ], 30 ) );
+  ALWAYS_ASSERT( size( &our_map ) == 7 );
+  ALWAYS_ASSERT( *get( &our_map, strs[ 3 ] ) == 30 );
+  ALWAYS_ASSERT( erase( &our_map, strs[ 2 ] ) );
+  ALWAYS_ASSERT( !get( &our_map, strs[ 2 ] ) );
+  ALWAYS_ASSERT( *get( &our_map, strs[ 3 ] ) == 30 );
+  ALWAYS_ASSERT( size( &our_map ) == 6 );
+
+  cleanup( &our_map );
+}
+
+// Compares a stored cc_str with a borrowed, null-terminated string.
+static int cmpr_str_with_c_string( void *stored_key, void *borrowed_key )
+{
+  cc_str *str = (cc_str *)stored_key;
+  const char *c_string = *(const char **)borrowed_key;
+  return strlen( c_string ) == str->len && memcmp( c_string, str->data, str->len ) == 0;
+}
+
+static void test_map_separate_keys( void )
+{
+  // A map whose key is a fundamental integer type and whose buckets would otherwise require padding stores its keys and
+  // elements in separate arrays.
+  map( unsigned long long, char ) our_map;
+  init( &our_map );
+
+  // Small map, which is flat if CC_FLAT_SMALL_MAPS is defined.
+  for( unsigned long long i = 0; i < 5; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, (char)i ) );
+  ALWAYS_ASSERT( erase( &our_map, 0 ) );
+  for( unsigned long long i = 1; i < 5; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (char)i && *key_for( &our_map, get( &our_map, i ) ) == i );
+  clear( &our_map );
+
+  for( unsigned long long i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i * 7, (char)i ) );
+  ALWAYS_ASSERT( size( &our_map ) == 1000 );
+
+  // Replacement.
+  UNTIL_SUCCESS( insert( &our_map, 7, 'x' ) );
+  ALWAYS_ASSERT( *get( &our_map, 7 ) == 'x' );
+  ALWAYS_ASSERT( *key_for( &our_map, get( &our_map, 7 ) ) == 7 );
+  *get( &our_map, 7 ) = 1;
+
+  // Erasure via pointer-iterators, which moves keys and elements between buckets.
+  for( char *el = first( &our_map ); el != end( &our_map ); )
+  {
+    if( *key_for( &our_map, el ) % 2 )
+      el = erase_itr( &our_map, el );
+    else
+      el = next( &our_map, el );
+  }
+  ALWAYS_ASSERT( size( &our_map ) == 500 );
+
+  // Cloning and rehashing preserve every key-element pair.
+  map( unsigned long long, char ) our_map_clone;
+  UNTIL_SUCCESS( init_clone( &our_map_clone, &our_map ) );
+  UNTIL_SUCCESS( shrink( &our_map_clone ) );
+  for( unsigned long long i = 0; i < 1000; ++i )
+  {
+    char *el = get( &our_map_clone, i * 7 );
+    if( i % 2 )
+      ALWAYS_ASSERT( !el );
+    else
+      ALWAYS_ASSERT( el && *el == (char)i && *key_for( &our_map_clone, el ) == i * 7 );
+  }
+
+  size_t n_iterations = 0;
+  for_each( &our_map_clone, key, el )
+  {
+    ALWAYS_ASSERT( *key % 14 == 0 && *el == (char)( *key / 7 ) );
+    ++n_iterations;
+  }
+  ALWAYS_ASSERT( n_iterations == 500 );
+
+  cleanup( &our_map_clone );
+  cleanup( &our_map );
+}
+
+static void test_map_with_hash( void )
+{
+  map( cached_hash_ty, int ) our_map;
+  init( &our_map );
+
+  size_t hashes[ 100 ];
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    hashes[ i ] = hash_for( &our_map, key );
+  }
+
+  // With precomputed hash codes, insertions (including the ensuing rehashes, since hash codes are cached for this key
+  // type) and lookups never call the hash function.
+  size_t hash_calls = cached_hash_calls;
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    UNTIL_SUCCESS( insert_with_hash( &our_map, key, i + 1, hashes[ i ] ) );
+  }
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    ALWAYS_ASSERT( *get_with_hash( &our_map, key, hashes[ i ] ) == i + 1 );
+  }
+
+  // Replacement.
+  cached_hash_ty replaced_key = { 50, { 0 } };
+  ALWAYS_ASSERT( *insert_with_hash( &our_map, replaced_key, 500, hashes[ 50 ] ) == 500 );
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+
+  // Lookups with precomputed hash codes agree with ordinary lookups.
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    ALWAYS_ASSERT( get_with_hash( &our_map, key, hashes[ i ] ) == get( &our_map, key ) );
+  }
+  cached_hash_ty missing_key = { 100, { 0 } };
+  ALWAYS_ASSERT( !get_with_hash( &our_map, missing_key, hash_for( &our_map, missing_key ) ) );
+
+  cleanup( &our_map );
+
+  // Heterogeneous lookup of cc_str keys via borrowed, null-terminated strings.
+  map( cc_str, int ) str_map;
+  init( &str_map );
+
+  char chars[] = "alpha beta gamma";
+  cc_str strs[] = { { chars, 5 }, { chars + 6, 4 }, { chars + 11, 5 } };
+  for( int i = 0; i < 3; ++i )
+    UNTIL_SUCCESS( insert( &str_map, strs[ i ], i ) );
+
+  const char *c_strings[] = { "alpha", "beta", "gamma" };
+  for( int i = 0; i < 3; ++i )
+  {
+    int *el = get_heterogeneous( &str_map, &c_strings[ i ], hash_for( &str_map, strs[ i ] ), cmpr_str_with_c_string );
+    ALWAYS_ASSERT( el && *el == i );
+  }
+
+  const char *absent = "alphabet";
+  ALWAYS_ASSERT( !get_heterogeneous( &str_map, &absent, hash_for( &str_map, strs[ 0 ] ), cmpr_str_with_c_string ) );
+
+  cleanup( &str_map );
+}
+
+static void test_map_cached_hash( void )
+{
+  map( cached_hash_ty, char ) our_map;
+  init( &our_map );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    UNTIL_SUCCESS( insert( &our_map, key, (char)i ) );
+  }
+
+  // Rehashing uses the cached hash codes.
+  size_t hash_calls = cached_hash_calls;
+  UNTIL_SUCCESS( reserve( &our_map, 1000 ) );
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+
+  // So does erasing via pointer-iterators.
+  for( char *el = first( &our_map ); el != end( &our_map ); )
+  {
+    if( key_for( &our_map, el )->val % 2 )
+      el = erase_itr( &our_map, el );
+    else
+      el = next( &our_map, el );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+  ALWAYS_ASSERT( size( &our_map ) == 50 );
+
+  // Each lookup hashes only the key looked up.
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    char *el = get( &our_map, key );
+    if( i % 2 )
+      ALWAYS_ASSERT( !el );
+    else
+      ALWAYS_ASSERT( el && *el == (char)i );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls + 100 );
+
+  cleanup( &our_map );
+}
+
+#ifdef CC_FLAT_SMALL_MAPS
+static void test_map_flat( void )
+{
+  map( cached_hash_ty, int ) our_map;
+  init( &our_map );
+
+  // Reserving the table up front ensures that no insertion below fails and is retried.
+  UNTIL_SUCCESS( reserve( &our_map, CC_MAP_FLAT_MAX_BUCKET_COUNT / 2 ) );
+  ALWAYS_ASSERT( cap( &our_map ) == CC_MAP_FLAT_MAX_BUCKET_COUNT );
+
+  // Because hash codes are cached for this key type, a flat table hashes each new key once, upon insertion.
+  size_t hash_calls = cached_hash_calls;
+  for( int i = 0; i < CC_MAP_FLAT_MAX_BUCKET_COUNT; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    UNTIL_SUCCESS( insert( &our_map, key, i ) );
+  }
+  ALWAYS_ASSERT( size( &our_map ) == CC_MAP_FLAT_MAX_BUCKET_COUNT );
+  ALWAYS_ASSERT( cap( &our_map ) == CC_MAP_FLAT_MAX_BUCKET_COUNT );
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls + CC_MAP_FLAT_MAX_BUCKET_COUNT );
+
+  // Lookups, replacements of existing keys, and erasures hash nothing.
+  hash_calls = cached_hash_calls;
+  for( int i = 0; i < CC_MAP_FLAT_MAX_BUCKET_COUNT; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    ALWAYS_ASSERT( *get( &our_map, key ) == i );
+  }
+  cached_hash_ty missing_key = { CC_MAP_FLAT_MAX_BUCKET_COUNT, { 0 } };
+  ALWAYS_ASSERT( !get( &our_map, missing_key ) );
+  cached_hash_ty replaced_key = { 3, { 0 } };
+  ALWAYS_ASSERT( *insert( &our_map, replaced_key, 300 ) == 300 );
+  ALWAYS_ASSERT( !erase( &our_map, missing_key ) );
+
+  for( int *el = first( &our_map ); el != end( &our_map ); )
+  {
+    if( key_for( &our_map, el )->val % 2 )
+      el = erase_itr( &our_map, el );
+    else
+      el = next( &our_map, el );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+  ALWAYS_ASSERT( size( &our_map ) == CC_MAP_FLAT_MAX_BUCKET_COUNT / 2 );
+
+  for( int i = 0; i < CC_MAP_FLAT_MAX_BUCKET_COUNT; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    int *el = get( &our_map, key );
+    if( i % 2 )
+      ALWAYS_ASSERT( !el );
+    else
+      ALWAYS_ASSERT( el && *el == i );
+  }
+
+  // Test the switch to an ordinary table and back.
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    UNTIL_SUCCESS( insert( &our_map, key, i ) );
+  }
+  ALWAYS_ASSERT( size( &our_map ) == 100 );
+  ALWAYS_ASSERT( cap( &our_map ) > CC_MAP_FLAT_MAX_BUCKET_COUNT );
+
+  for( int i = 5; i < 100; ++i )
+  {
+    cached_hash_ty key = { i, { 0 } };
+    ALWAYS_ASSERT( erase( &our_map, key ) );
+  }
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( cap( &our_map ) == CC_MAP_MIN_NONZERO_BUCKET_COUNT );
+
+  size_t count = 0;
+  for_each( &our_map, key, el )
+  {
+    ALWAYS_ASSERT( key->val < 5 && *el == key->val );
+    ++count;
+  }
+  ALWAYS_ASSERT( count == 5 );
+
+  cleanup( &our_map );
+}
+
+static void test_map_flat_shrink( void )
+{
+  // Test that shrink sizes a flat table to its contents, irrespective of the max load factor, rather than growing it.
+  size_t sizes[] = { 1, 8, 9, 15, 16 };
+  for( size_t i = 0; i < sizeof( sizes ) / sizeof( *sizes ); ++i )
+  {
+    map( int, int ) our_map;
+    init( &our_map );
+
+    for( int j = 0; j < (int)sizes[ i ]; ++j )
+      UNTIL_SUCCESS( insert( &our_map, j, j + 1 ) );
+
+    size_t cap_before = cap( &our_map );
+    UNTIL_SUCCESS( shrink( &our_map ) );
+    ALWAYS_ASSERT( cap( &our_map ) <= cap_before );
+    ALWAYS_ASSERT( cap( &our_map ) == ( sizes[ i ] <= CC_MAP_MIN_NONZERO_BUCKET_COUNT ? 8 : 16 ) );
+    ALWAYS_ASSERT( size( &our_map ) == sizes[ i ] );
+    for( int j = 0; j < (int)sizes[ i ]; ++j )
+      ALWAYS_ASSERT( *get( &our_map, j ) == j + 1 );
+
+    cleanup( &our_map );
+  }
+
+  // Test that shrink succeeds on a full fixed-capacity map or set, which it cannot rehash.
+  map( int, int ) our_map;
+  fmap( int, int, 16 ) our_map_buf;
+  init_with_fixed_buffer( &our_map, &our_map_buf );
+
+  int n = 0;
+  while( insert( &our_map, n, n + 1 ) )
+    ++n;
+  ALWAYS_ASSERT( n == 16 );
+  ALWAYS_ASSERT( shrink( &our_map ) );
+  ALWAYS_ASSERT( cap( &our_map ) == 16 );
+  for( int i = 0; i < n; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == i + 1 );
+
+  cleanup( &our_map );
+
+  set( int ) our_set;
+  fset( int, 8 ) our_set_buf;
+  init_with_fixed_buffer( &our_set, &our_set_buf );
+
+  n = 0;
+  while( insert( &our_set, n ) )
+    ++n;
+  ALWAYS_ASSERT( n == 8 );
+  ALWAYS_ASSERT( shrink( &our_set ) );
+  ALWAYS_ASSERT( cap( &our_set ) == 8 );
+  for( int i = 0; i < n; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+}
+#endif
+
+static void test_map_snapshot( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  // Test snapshot of placeholder.
+  size_t buf_size = snapshot_size( &our_map );
+  void *buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_map, buf );
+
+  map( int, size_t ) loaded_map;
+  UNTIL_SUCCESS( init_from_snapshot( &loaded_map, buf, buf_size ) );
+  ALWAYS_ASSERT( (void *)loaded_map == (void *)&cc_map_placeholder );
+  free( buf );
+
+  // Test snapshots taken at various points during growth, including partway through incremental rehashes if
+  // CC_INCREMENTAL_REHASH is defined.
+  for( int i = 0; i < 300; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+    if( i % 37 == 0 )
+    {
+      buf_size = snapshot_size( &our_map );
+      buf = malloc( buf_size );
+      ALWAYS_ASSERT( buf );
+      write_snapshot( &our_map, buf );
+
+      UNTIL_SUCCESS( init_from_snapshot( &loaded_map, buf, buf_size ) );
+      ALWAYS_ASSERT( size( &loaded_map ) == size( &our_map ) );
+      ALWAYS_ASSERT( cap( &loaded_map ) == cap( &our_map ) );
+      for( int j = 0; j <= i; ++j )
+        ALWAYS_ASSERT( *get( &loaded_map, j ) == (size_t)j + 1 );
+
+      cleanup( &loaded_map );
+      free( buf );
+    }
+  }
+
+  buf_size = snapshot_size( &our_map );
+  buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_map, buf );
+
+  // Test that the loaded map owns its memory.
+  UNTIL_SUCCESS( init_from_snapshot( &loaded_map, buf, buf_size ) );
+  for( int i = 300; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &loaded_map, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &loaded_map ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &loaded_map, i ) == (size_t)i + 1 );
+
+  // Test view.
+  map( int, size_t ) view_map;
+  ALWAYS_ASSERT( init_view_of_snapshot( &view_map, buf, buf_size ) );
+  ALWAYS_ASSERT( size( &view_map ) == 300 );
+  ALWAYS_ASSERT( cap( &view_map ) == cap( &our_map ) );
+  for( int i = 0; i < 300; ++i )
+  {
+    size_t *el = get( &view_map, i );
+    ALWAYS_ASSERT( el && *el == (size_t)i + 1 );
+    ALWAYS_ASSERT( (char *)el > (char *)buf && (char *)el < (char *)buf + buf_size );
+  }
+  ALWAYS_ASSERT( !get( &view_map, 300 ) );
+
+  size_t n = 0;
+  for_each( &view_map, key, el )
+  {
+    ALWAYS_ASSERT( *el == (size_t)*key + 1 );
+    ++n;
+  }
+  ALWAYS_ASSERT( n == 300 );
+
+  // Test that the view cannot grow.
+  ALWAYS_ASSERT( !reserve( &view_map, cap( &view_map ) ) );
+  ALWAYS_ASSERT( size( &view_map ) == 300 );
+
+  cleanup( &view_map );
+
+  // Test rejection of invalid snapshots.
+  map( int, size_t ) invalid_map;
+  ALWAYS_ASSERT( !init_from_snapshot( &invalid_map, buf, buf_size - 1 ) );
+
+  map( int, int ) other_ty_map;
+  ALWAYS_ASSERT( !init_from_snapshot( &other_ty_map, buf, buf_size ) );
+
+  set( int ) other_cntr_set;
+  ALWAYS_ASSERT( !init_from_snapshot( &other_cntr_set, buf, buf_size ) );
+
+  // Test rejection of a snapshot written by a program with a different CC_FLAT_SMALL_MAPS setting.
+  ( (cc_snapshot_hdr_ty *)buf )->options ^= CC_SNAPSHOT_FLAT_SMALL_MAPS;
+  ALWAYS_ASSERT( !init_from_snapshot( &invalid_map, buf, buf_size ) );
+  ALWAYS_ASSERT( !init_view_of_snapshot( &invalid_map, buf, buf_size ) );
+
+  free( buf );
+  cleanup( &our_map );
+  cleanup( &loaded_map );
+}
+
+#ifdef CC_INCREMENTAL_REHASH
+// A view of a map partway through a migration places both tables' headers in the reserved slots of their records, so
+// modifying the view must not corrupt either table.
+static void test_map_snapshot_view_during_migration( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  int n = 0;
+  while( !cc_map_hdr( our_map )->old_cntr )
+  {
+    UNTIL_SUCCESS( insert( &our_map, n, n + 1 ) );
+    ++n;
+  }
+
+  size_t buf_size = snapshot_size( &our_map );
+  void *buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_map, buf );
+
+  map( int, size_t ) view_map;
+  ALWAYS_ASSERT( init_view_of_snapshot( &view_map, buf, buf_size ) );
+  ALWAYS_ASSERT( cc_map_hdr( view_map )->old_cntr );
+  ALWAYS_ASSERT( size( &view_map ) == (size_t)n );
+
+  // Erase every even key and then insert new keys, which continues the migration, until the view is full.
+  for( int i = 0; i < n; i += 2 )
+    ALWAYS_ASSERT( erase( &view_map, i ) );
+
+  size_t expected_size = size( &view_map );
+  for( int i = n; insert( &view_map, i, i + 1 ); ++i )
+    ++expected_size;
+
+  ALWAYS_ASSERT( size( &view_map ) == expected_size );
+
+  size_t iterated = 0;
+  for_each( &view_map, key, el )
+  {
+    ALWAYS_ASSERT( *key >= 0 && ( *key % 2 == 1 || *key >= n ) );
+    ALWAYS_ASSERT( *el == (size_t)*key + 1 );
+    ALWAYS_ASSERT( get( &view_map, *key ) == el );
+    ++iterated;
+  }
+  ALWAYS_ASSERT( iterated == expected_size );
+
+  cleanup( &view_map );
+  free( buf );
+  cleanup( &our_map );
+}
+#endif
+
+#ifdef CC_STATS
+static void test_map_stats( void )
+{
+  map( int, int ) our_map;
+  init( &our_map );
+
+  cc_stats stats;
+  get_stats( &our_map, &stats );
+  ALWAYS_ASSERT( stats.size == 0 );
+  ALWAYS_ASSERT( stats.cap == 0 );
+  ALWAYS_ASSERT( stats.max_chain_length == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i ) );
+
+  get_stats( &our_map, &stats );
+  ALWAYS_ASSERT( stats.size == 1000 );
+  ALWAYS_ASSERT( stats.cap == cap( &our_map ) );
+  ALWAYS_ASSERT( stats.displacement_limit == CC_MAP_DISPLACEMENT_MASK );
+  ALWAYS_ASSERT( stats.max_displacement < stats.displacement_limit );
+  ALWAYS_ASSERT( stats.avg_probes_hit >= 1.0 );
+  ALWAYS_ASSERT( stats.avg_probes_miss >= 1.0 );
+  ALWAYS_ASSERT( stats.rehashes + stats.migrations > 0 );
+
+  // Test that the chains account for every key.
+  ALWAYS_ASSERT( stats.max_chain_length < CC_STATS_CHAIN_LENGTHS );
+  size_t keys_in_chains = 0;
+  for( size_t i = 0; i < CC_STATS_CHAIN_LENGTHS; ++i )
+    keys_in_chains += stats.chain_counts[ i ] * ( i + 1 );
+  ALWAYS_ASSERT( keys_in_chains == 1000 );
+
+  // Test that the counters survive growth.
+  size_t evictions = stats.evictions;
+  UNTIL_SUCCESS( reserve( &our_map, cap( &our_map ) * 2 ) );
+  get_stats( &our_map, &stats );
+  ALWAYS_ASSERT( stats.evictions >= evictions );
+
+  // Test that an empty table has no chains.
+  clear( &our_map );
+  get_stats( &our_map, &stats );
+  ALWAYS_ASSERT( stats.size == 0 );
+  ALWAYS_ASSERT( stats.max_chain_length == 0 );
+  ALWAYS_ASSERT( stats.avg_probes_hit == 0.0 );
+  ALWAYS_ASSERT( stats.avg_probes_miss == 1.0 );
+
+  cleanup( &our_map );
+}
+#endif
+
+#ifdef CC_PARALLEL_REHASH
+static void test_map_parallel_rehash( void )
+{
+  map( int, size_t ) our_map;
+  init( &our_map );
+
+  for( int i = 0; i < 200000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+
+  // Rehash into a larger table, which partitions the buckets by the old bucket count.
+  UNTIL_SUCCESS( reserve( &our_map, cap( &our_map ) * 2 ) );
+  ALWAYS_ASSERT( cap( &our_map ) >= 4 * CC_MAP_PARALLEL_MIN_TASK_BUCKETS );
+  ALWAYS_ASSERT( size( &our_map ) == 200000 );
+  for( int i = 0; i < 200000; ++i )
+    ALWAYS_ASSERT( *get( &our_map, i ) == (size_t)i + 1 );
+
+  // Rehash into a smaller table, which partitions the buckets by the new bucket count.
+  for( int i = 150000; i < 200000; ++i )
+    ALWAYS_ASSERT( erase( &our_map, i ) );
+
+  UNTIL_SUCCESS( shrink( &our_map ) );
+  ALWAYS_ASSERT( cap( &our_map ) >= 2 * CC_MAP_PARALLEL_MIN_TASK_BUCKETS );
+  ALWAYS_ASSERT( size( &our_map ) == 150000 );
+  for( int i = 0; i < 200000; ++i )
+    ALWAYS_ASSERT( i < 150000 ? *get( &our_map, i ) == (size_t)i + 1 : !get( &our_map, i ) );
+
+  // Test validity through use.
+  for( int i = 150000; i < 200000; ++i )
+    UNTIL_SUCCESS( insert( &our_map, i, i + 1 ) );
+  for( int i = 0; i < 200000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_map, i ) );
+
+  // Clone.
+  map( int, size_t ) clone;
+  UNTIL_SUCCESS( init_clone( &clone, &our_map ) );
+  ALWAYS_ASSERT( size( &clone ) == 100000 );
+  for( int i = 0; i < 200000; ++i )
+    ALWAYS_ASSERT( i % 2 ? *get( &clone, i ) == (size_t)i + 1 : !get( &clone, i ) );
+
+  cleanup( &our_map );
+  cleanup( &clone );
+}
+#endif
+
+#define TEST_MAP_DEFAULT_INTEGER_TYPE( ty )    \
+{                                              \
+  map( ty, int ) our_map;                      \
+  init( &our_map );                            \
+                                               \
+  for( int i = 0; i < 100; ++i )               \
+    UNTIL_SUCCESS( insert( &our_map, i, i ) ); \
+                                               \
+  for( int i = 0; i < 100; ++i )               \
+    ALWAYS_ASSERT( *get( &our_map, i ) == i ); \
+                                               \
+  cleanup( &our_map );                         \
+}                                              \
+
+static void test_map_default_integer_types( void )
+{
+  TEST_MAP_DEFAULT_INTEGER_TYPE( char );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( short );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( int );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_MAP_DEFAULT_INTEGER_TYPE( size_t );
+}
+
+#endif
+
+// Set tests.
+#ifdef TEST_SET
+
+static void test_set_reserve( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Reserve zero with placeholder.
+  UNTIL_SUCCESS( reserve( &our_set, 0 ) );
+  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+
+  // Reserve up from placeholder.
+  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  ALWAYS_ASSERT( 30 <= cap( &our_set ) * CC_DEFAULT_LOAD );
+
+  // Reserve same capacity.
+  size_t cap = cap( &our_set );
+  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  ALWAYS_ASSERT( cap( &our_set ) == cap );
+
+  // Reserve up from non-placeholder.
+  UNTIL_SUCCESS( reserve( &our_set, 60 ) );
+  ALWAYS_ASSERT( 60 <= cap( &our_set ) * CC_DEFAULT_LOAD );
+
+  // Reserve lower capacity.
+  cap = cap( &our_set );
+  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  ALWAYS_ASSERT( cap( &our_set ) == cap );
+
+  // Test validity through use.
+  for( int i = 0; i < 60; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_set ) == 60 );
+  for( int i = 0; i < 60; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+}
+
+static void test_set_shrink( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test placeholder.
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( cap( &our_set ) == 0 );
+
+  // Test restoration of placeholder.
+  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( cap( &our_set ) == 0 );
+  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+
+  // Test shrink same size.
+  UNTIL_SUCCESS( reserve( &our_set, 30 ) );
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 30 );
+  set( int ) same = our_set;
+  size_t cap = cap( &our_set );
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  ALWAYS_ASSERT( our_set == same );
+  ALWAYS_ASSERT( cap( &our_set ) == cap );
+
+  // Test shrink down.
+  UNTIL_SUCCESS( reserve( &our_set, 500 ) );
+  ALWAYS_ASSERT( size( &our_set ) == 30 );
+  ALWAYS_ASSERT( 500 <= cap( &our_set ) * CC_DEFAULT_LOAD );
+  UNTIL_SUCCESS( shrink( &our_set ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 30 );
+  ALWAYS_ASSERT( cap( &our_set ) == cap );
+
+  // Check.
+  for( int i = 0; i < 30; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set ); 
+}
+
+static void test_set_insert( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_set, i ) );
+    ALWAYS_ASSERT( ( *el == i ) );
+  }
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_set, i ) );
+    ALWAYS_ASSERT( ( *el == i ) );
+  }
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+}
+
+static void test_set_insert_n( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test insertion into an empty set, with elements in scrambled order.
+  int els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+    els[ i ] = i * 337 % 1000;
+
+  UNTIL_SUCCESS( insert_n( &our_set, els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_set ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  // Test insertion into a non-empty set, with some elements already present and repeated elements.
+  for( int i = 0; i < 100; ++i )
+    els[ i ] = 950 + i;
+
+  UNTIL_SUCCESS( insert_n( &our_set, els, 100 ) );
+  ALWAYS_ASSERT( size( &our_set ) == 1050 );
+  for( int i = 0; i < 1050; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  // Test zero elements.
+  UNTIL_SUCCESS( insert_n( &our_set, els, 0 ) );
+  ALWAYS_ASSERT( size( &our_set ) == 1050 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_get_or_insert( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test insert.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_set, i ) ) );
+    ALWAYS_ASSERT( *el == i );
+  }
+
+  ALWAYS_ASSERT( size( &our_set ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  // Test get.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el_1 = get( &our_set, i );
+    int *el_2;
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_set, i ) ) );
+    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == i );
+  }
+
+  ALWAYS_ASSERT( size( &our_set ) == 100 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_get( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test empty.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_set, i ) );
+
+  // Test get existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  // Test get non-existing.
+  for( int i = 100; i < 200; ++i )
+    ALWAYS_ASSERT( !get( &our_set, i ) );
+
+  cleanup( &our_set );
+}
+
+static void test_set_get_n( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  int keys[ 200 ];
+  int *itrs[ 200 ];
+  for( int i = 0; i < 200; ++i )
+    keys[ i ] = i;
+
+  // Test empty.
+  ALWAYS_ASSERT( get_n( &our_set, keys, 200, itrs ) == 0 );
+  for( int i = 0; i < 200; ++i )
+    ALWAYS_ASSERT( !itrs[ i ] );
+
+  // Test mix of existing and non-existing, with a count that is not a multiple of the batch size.
+  for( int i = 0; i < 200; i += 2 )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( get_n( &our_set, keys, 199, itrs ) == 100 );
+  for( int i = 0; i < 199; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( itrs[ i ] == get( &our_set, i ) && *itrs[ i ] == i );
+    else
+      ALWAYS_ASSERT( !itrs[ i ] );
+  }
+
+  // Test zero keys.
+  ALWAYS_ASSERT( get_n( &our_set, keys, 0, itrs ) == 0 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_erase( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_set, i ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_set, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_set ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_set, i ) );
+    else
+      ALWAYS_ASSERT( *get( &our_set, i ) == i );
+  }
+
+  cleanup( &our_set );
+}
+
+static void test_set_erase_n( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  // Test mix of existing, non-existing, and repeated elements, with a count that is not a multiple of the batch size.
+  int els[ 150 ];
+  for( int i = 0; i < 100; ++i )
+    els[ i ] = i * 2;
+
+  for( int i = 100; i < 150; ++i )
+    els[ i ] = i - 100;
+
+  ALWAYS_ASSERT( erase_n( &our_set, els, 150 ) == 75 );
+  ALWAYS_ASSERT( size( &our_set ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_set, i ) == ( i % 2 == 0 || i < 50 ) );
+
+  // Test zero elements.
+  ALWAYS_ASSERT( erase_n( &our_set, els, 0 ) == 0 );
+  ALWAYS_ASSERT( size( &our_set ) == 25 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_erase_itr( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // In this instance, the key count and order of insert have been carefully chosen to cause skipped or repeat-visited
+  // keys if vt_erase_itr does not correctly handle the case of another key being moved to the bucket of the erased key.
+  for( int i = 119; i >= 0; --i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 120 );
+
+  // Test with iterator from get.
+  for( int i = 0; i < 120; i += 4 )
+    erase_itr( &our_set, get( &our_set, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_set ) == 90 );
+  for( int i = 0; i < 120; ++i )
+  {
+    if( i % 4 == 0 )
+      ALWAYS_ASSERT( !get( &our_set, i ) );
+    else
+    {
+      int *el = get( &our_set, i );
+      ALWAYS_ASSERT( el && *el == i );
+    }
+  }
+
+  // Test deletion while iterating.
+  int *el = first( &our_set );
+  size_t n_iterations = 0;
+  while( el != end( &our_set ) )
+  {
+    ++n_iterations;
+
+    if( *el % 2 == 0 )
+      el = erase_itr( &our_set, el );
+    else
+      el = next( &our_set, el );
+  }
+
+  ALWAYS_ASSERT( n_iterations == 90 );
+  ALWAYS_ASSERT( size( &our_set ) == 60 );
+
+  for( int i = 0; i < 120; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_set, i ) );
+    else
+    {
+      el = get( &our_set, i );
+      ALWAYS_ASSERT( el && *el == i );
+    }
+  }
+
+  cleanup( &our_set );
+}
+
+static void test_set_erase_if( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  int divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_set, is_int_multiple, &divisor ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_set, is_int_multiple, &divisor ) == 334 );
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_set, is_int_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_set ) == 333 );
+
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( !get( &our_set, i ) == ( i % 2 != 0 || i % 3 == 0 ) );
+
+  // The chains remain intact.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( erase( &our_set, i ) );
+
+  cleanup( &our_set );
+
+  // Test that erase_if calls the destructor for each erased element.
+  set( custom_ty ) our_custom_set;
+  init( &our_custom_set );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    UNTIL_SUCCESS( insert( &our_custom_set, el ) );
+  }
+
+  ALWAYS_ASSERT( erase_if( &our_custom_set, is_custom_ty_even, NULL ) == 50 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( dtor_called[ i ] == ( i % 2 == 0 ) );
+
+  cleanup( &our_custom_set );
+  check_dtors_arr();
+}
+
+static void test_set_clear( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Test empty.
+  clear( &our_set );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+
+  // Test non-empty;
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  clear( &our_set );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_set, i ) );
+
+  // Test reuse.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+}
+
+static void test_set_cleanup( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Empty.
+  cleanup( &our_set );
+  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+
+  // Non-empty.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+  ALWAYS_ASSERT( size( &our_set ) == 100 );
+  cleanup( &our_set );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( (void *)our_set == (void *)&cc_map_placeholder );
+
+  // Test use.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+}
+
+static void test_set_init_clone( void )
+{
+  set( int ) src_set;
+  init( &src_set );
+
+  // Test init_clone placeholder.
+  set( int ) empty_set;
+  UNTIL_SUCCESS( init_clone( &empty_set, &src_set ) );
+  ALWAYS_ASSERT( (void *)empty_set == (void *)&cc_map_placeholder );
+
+  // Test init_clone non-placeholder.
+  set( int ) our_set = NULL;
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &src_set, i ) );
+  UNTIL_SUCCESS( init_clone( &our_set, &src_set ) );
+
+  // Check
+  ALWAYS_ASSERT( size( &our_set ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &src_set );
+  cleanup( &empty_set );
+  cleanup( &our_set );
+}
+
+static void test_set_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  set( int ) our_set;
+  UNTIL_SUCCESS( init_with_allocator( &our_set, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+  ALWAYS_ASSERT( allocs == 1 );
+
+  // Test that clones share the allocator.
+  set( int ) our_set_clone;
+  UNTIL_SUCCESS( init_clone( &our_set_clone, &our_set ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  ALWAYS_ASSERT( size( &our_set_clone ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_set_clone, i ) == i );
+
+  // Test that shrinking an empty set keeps it associated with the allocator.
+  clear( &our_set );
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  ALWAYS_ASSERT( allocs == 2 );
+  ALWAYS_ASSERT( cap( &our_set ) > 0 );
+
+  cleanup( &our_set );
+  cleanup( &our_set_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_set, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  ALWAYS_ASSERT( size( &our_set ) == 1000 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+
+  cleanup( &our_set );
+  cc_arena_cleanup( &arena );
+}
+
+static void test_set_init_with_fixed_buffer( void )
+{
+  set( int ) our_set;
+  fset( int, 16 ) our_set_buf;
+
+  size_t allocs_before = oustanding_allocs;
+
+  init_with_fixed_buffer( &our_set, &our_set_buf );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( cap( &our_set ) == 16 );
+
+  // Insert until the set would need to rehash.
+  int n = 0;
+  while( insert( &our_set, n ) )
+    ++n;
+  ALWAYS_ASSERT( n >= 8 && n <= 16 );
+  ALWAYS_ASSERT( size( &our_set ) == (size_t)n );
+  ALWAYS_ASSERT( cap( &our_set ) == 16 );
+  ALWAYS_ASSERT( !reserve( &our_set, 17 ) );
+  for( int i = 0; i < n; ++i )
+    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+  ALWAYS_ASSERT( !get( &our_set, n ) );
+
+  // Test that reinserting after erasure succeeds.
+  ALWAYS_ASSERT( erase( &our_set, 0 ) );
+  ALWAYS_ASSERT( insert( &our_set, n ) );
+  ALWAYS_ASSERT( *get( &our_set, n ) == n );
+
+  // Test that init_clone fails rather than allocating.
+  set( int ) our_set_clone;
+  ALWAYS_ASSERT( !init_clone( &our_set_clone, &our_set ) );
+
+  clear( &our_set );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( insert( &our_set, 0 ) );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+
+  // Test that the buffer can be reused after cleanup.
+  cleanup( &our_set );
+  init_with_fixed_buffer( &our_set, &our_set_buf );
+  ALWAYS_ASSERT( size( &our_set ) == 0 );
+  ALWAYS_ASSERT( insert( &our_set, 0 ) );
+  cleanup( &our_set );
+  ALWAYS_ASSERT( oustanding_allocs == allocs_before );
+}
+
+static void test_set_cursor( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  size_t n_iterations = 0;
+  for_each_fast( &our_set, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  for( int i = 119; i >= 0; --i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  for_each_fast( &our_set, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 120 );
+
+  // Test deletion while iterating.
+  n_iterations = 0;
+  cc_cursor cursor;
+  int *el = cursor_first( &our_set, &cursor );
+  while( el != end( &our_set ) )
+  {
+    ++n_iterations;
+
+    if( *el % 3 == 0 )
+      el = cursor_erase( &our_set, &cursor );
+    else
+      el = cursor_next( &our_set, &cursor );
+  }
+
+  ALWAYS_ASSERT( n_iterations == 120 );
+  ALWAYS_ASSERT( size( &our_set ) == 80 );
+
+  for( int i = 0; i < 120; ++i )
+  {
+    if( i % 3 == 0 )
+      ALWAYS_ASSERT( !get( &our_set, i ) );
+    else
+      ALWAYS_ASSERT( get( &our_set, i ) && *get( &our_set, i ) == i );
+  }
+
+  cleanup( &our_set );
+}
+
+static void test_set_iteration( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  // Empty.
+
+  // Test first and last.
+  ALWAYS_ASSERT( first( &our_set ) == end( &our_set ) );
+
+  size_t n_iterations = 0;
+
+  for( int *i = first( &our_set ); i != end( &our_set ); i = next( &our_set, i ) )
+    ++n_iterations;
+
+  for_each( &our_set, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+  
+  for( int *i = first( &our_set ); i != end( &our_set ); i = next( &our_set, i ) )
+    ++n_iterations;
+
+  for_each( &our_set, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 60 );
+
+  // Iteration over empty, non-placeholder set.
+
+  clear( &our_set );
+
+  n_iterations = 0;
+
+  for_each( &our_set, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_memory_usage( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+  check_memory_usage( memory_usage( &our_set ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_set, &allocator ) );
+  check_memory_usage( memory_usage( &our_set ), bytes, 0 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+    check_memory_usage( memory_usage( &our_set ), bytes, sizeof( int ) * (size_t)( i + 1 ) );
+  }
+
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_set, i ) );
+
+  check_memory_usage( memory_usage( &our_set ), bytes, sizeof( int ) * 100 );
+
+  size_t overhead = memory_usage( &our_set ).overhead;
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  check_memory_usage( memory_usage( &our_set ), bytes, sizeof( int ) * 100 );
+  ALWAYS_ASSERT( memory_usage( &our_set ).overhead < overhead );
+
+  cleanup( &our_set );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_set ), 0, 0 );
+}
+
+static void test_set_dtors( void )
+{
+  set( custom_ty ) our_set;
+  init( &our_set );
+
+  // Test erase and clear.
+
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    UNTIL_SUCCESS( insert( &our_set, el ) );
+  }
+
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    erase( &our_set, el );
+  }
+
+  clear( &our_set );
+
+  check_dtors_arr();
+
+  // Test replace.
+
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    UNTIL_SUCCESS( insert( &our_set, el ) );
+  }
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    UNTIL_SUCCESS( insert( &our_set, el ) );
+  }
+
+  check_dtors_arr();
+  clear( &our_set );
+
+  // Test cleanup.
+
+  for( int i = 0; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    UNTIL_SUCCESS( insert( &our_set, el ) );
+  }
+
+  cleanup( &our_set );
+  check_dtors_arr();
+}
+
+static void test_set_strings( void )
+{
+  set( char * ) our_set;
+  init( &our_set );
+
+  char **el;
+
+  // String literals.
+  UNTIL_SUCCESS( ( el = insert( &our_set, "This" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "This" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, "is" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, "a" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "a" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, "test" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
+
+  // Other strings.
+  char str_1[] = "of";
+  char str_2[] = "sets";
+  char str_3[] = "with";
+  char str_4[] = "strings";
+
+  UNTIL_SUCCESS( ( el = insert( &our_set, str_1 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_1 ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, str_2 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, str_3 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_3 ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_set, str_4 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_set ) == 8 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "This" ), "This" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "is" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "a" ), "a" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "test" ), "test" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "of" ), str_1 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "sets" ), str_2 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "with" ), str_3 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_set, "strings" ), str_4 ) == 0 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_cached_hash( void )
+{
+  set( cached_hash_ty ) our_set;
+  init( &our_set );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty el = { i, { 0 } };
+    UNTIL_SUCCESS( insert( &our_set, el ) );
+  }
+
+  // Rehashing uses the cached hash codes.
+  size_t hash_calls = cached_hash_calls;
+  UNTIL_SUCCESS( reserve( &our_set, 1000 ) );
+  UNTIL_SUCCESS( shrink( &our_set ) );
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+
+  // So does erasing via pointer-iterators.
+  for( cached_hash_ty *el = first( &our_set ); el != end( &our_set ); )
+  {
+    if( el->val % 2 )
+      el = erase_itr( &our_set, el );
+    else
+      el = next( &our_set, el );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+  ALWAYS_ASSERT( size( &our_set ) == 50 );
+
+  // Each lookup hashes only the element looked up.
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty el = { i, { 0 } };
+    cached_hash_ty *itr = get( &our_set, el );
+    if( i % 2 )
+      ALWAYS_ASSERT( !itr );
+    else
+      ALWAYS_ASSERT( itr && itr->val == i );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls + 100 );
+
+  cleanup( &our_set );
+}
+
+static void test_set_with_hash( void )
+{
+  set( cached_hash_ty ) our_set;
+  init( &our_set );
+
+  size_t hashes[ 100 ];
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty el = { i, { 0 } };
+    hashes[ i ] = hash_for( &our_set, el );
+  }
+
+  // With precomputed hash codes, insertions and lookups never call the hash function.
+  size_t hash_calls = cached_hash_calls;
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty el = { i, { 0 } };
+    UNTIL_SUCCESS( insert_with_hash( &our_set, el, hashes[ i ] ) );
+  }
+  ALWAYS_ASSERT( size( &our_set ) == 100 );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    cached_hash_ty el = { i, { 0 } };
+    cached_hash_ty *itr = get_with_hash( &our_set, el, hashes[ i ] );
+    ALWAYS_ASSERT( itr && itr->val == i );
+  }
+  ALWAYS_ASSERT( cached_hash_calls == hash_calls );
+
+  cached_hash_ty missing_el = { 100, { 0 } };
+  ALWAYS_ASSERT( !get_with_hash( &our_set, missing_el, hash_for( &our_set, missing_el ) ) );
+
+  cleanup( &our_set );
+}
+
+static void test_set_snapshot( void )
+{
+  set( int ) our_set;
+  init( &our_set );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_set, i ) );
+
+  size_t buf_size = snapshot_size( &our_set );
+  void *buf = malloc( buf_size );
+  ALWAYS_ASSERT( buf );
+  write_snapshot( &our_set, buf );
+
+  // Test copy.
+  set( int ) loaded_set;
+  UNTIL_SUCCESS( init_from_snapshot( &loaded_set, buf, buf_size ) );
+  ALWAYS_ASSERT( size( &loaded_set ) == 100 );
+  ALWAYS_ASSERT( cap( &loaded_set ) == cap( &our_set ) );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &loaded_set, i ) == i );
+
+  UNTIL_SUCCESS( insert( &loaded_set, 100 ) );
+  ALWAYS_ASSERT( size( &loaded_set ) == 101 );
+
+  // Test view.
+  set( int ) view_set;
+  ALWAYS_ASSERT( init_view_of_snapshot( &view_set, buf, buf_size ) );
+  ALWAYS_ASSERT( size( &view_set ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &view_set, i ) == i );
+  ALWAYS_ASSERT( !get( &view_set, 100 ) );
+
+  ALWAYS_ASSERT( !reserve( &view_set, cap( &view_set ) ) );
+
+  cleanup( &view_set );
+
+  // Test rejection of snapshot of a different key type.
+  set( short ) other_ty_set;
+  ALWAYS_ASSERT( !init_from_snapshot( &other_ty_set, buf, buf_size ) );
+
+  free( buf );
+  cleanup( &our_set );
+  cleanup( &loaded_set );
+}
+
+#define TEST_SET_DEFAULT_INTEGER_TYPE( ty )    \
+{                                              \
+  set( ty ) our_set;                           \
+  init( &our_set );                            \
+                                               \
+  for( ty i = 0; i < 100; ++i )                \
+    UNTIL_SUCCESS( insert( &our_set, i ) );    \
+                                               \
+  for( ty i = 0; i < 100; ++i )                \
+    ALWAYS_ASSERT( *get( &our_set, i ) == i ); \
+                                               \
+  cleanup( &our_set );                         \
+}                                              \
+
+static void test_set_default_integer_types( void )
+{
+  TEST_SET_DEFAULT_INTEGER_TYPE( char );
+  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_SET_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_SET_DEFAULT_INTEGER_TYPE( short );
+  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_SET_DEFAULT_INTEGER_TYPE( int );
+  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_SET_DEFAULT_INTEGER_TYPE( long );
+  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_SET_DEFAULT_INTEGER_TYPE( long );
+  TEST_SET_DEFAULT_INTEGER_TYPE( size_t );
+}
+
+#endif
+
+// Concurrent map tests.
+// Except for test_cmap_threads, these tests run on one thread, so they check the map semantics of each operation across
+// shards rather than thread safety.
+#ifdef TEST_CMAP
+
+static void test_cmap_init_sharded( void )
+{
+  cmap( int, size_t ) our_cmap;
+
+  // Test rounding of the shard count.
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 0 ) );
+  ALWAYS_ASSERT( cc_cmap_hdr( our_cmap )->shard_count == 1 );
+  cleanup( &our_cmap );
+
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 5 ) );
+  ALWAYS_ASSERT( cc_cmap_hdr( our_cmap )->shard_count == 8 );
+  // Test that the shards are aligned to cache lines.
+  ALWAYS_ASSERT( (uintptr_t)cc_cmap_shards( our_cmap ) % CC_CMAP_SHARD_SIZE == 0 );
+  cleanup( &our_cmap );
+
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 1000000 ) );
+  ALWAYS_ASSERT( cc_cmap_hdr( our_cmap )->shard_count == CC_CMAP_MAX_SHARDS );
+  cleanup( &our_cmap );
+
+  // Test that a concurrent map without shards rejects insertions.
+  init( &our_cmap );
+  ALWAYS_ASSERT( !insert( &our_cmap, 0, 1 ) );
+  ALWAYS_ASSERT( !get_or_insert( &our_cmap, 0, 1 ) );
+  ALWAYS_ASSERT( size( &our_cmap ) == 0 );
+  cleanup( &our_cmap );
+  ALWAYS_ASSERT( (void *)our_cmap == (void *)&cc_cmap_placeholder );
+}
+
+static void test_cmap_insert( void )
+{
+  cmap( int, size_t ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_cmap ) == 100 );
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 2 ) );
+
+  ALWAYS_ASSERT( size( &our_cmap ) == 100 );
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t el;
+    ALWAYS_ASSERT( get( &our_cmap, i, &el ) && el == (size_t)i + 2 );
+  }
+
+  // Check that the keys are spread across the shards.
+  size_t used_shards = 0;
+  for( size_t i = 0; i < cc_cmap_hdr( our_cmap )->shard_count; ++i )
+    used_shards += cc_map_size( cc_cmap_shards( our_cmap )[ i ].map ) > 0;
+
+  ALWAYS_ASSERT( used_shards == cc_cmap_hdr( our_cmap )->shard_count );
+
+  cleanup( &our_cmap );
+}
+
+static void test_cmap_get_or_insert( void )
+{
+  cmap( int, size_t ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Test insert.
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 )
+      UNTIL_SUCCESS( get_or_insert( &our_cmap, i, i + 1 ) );
+    else
+    {
+      size_t el = 0;
+      UNTIL_SUCCESS( get_or_insert( &our_cmap, i, i + 1, &el ) );
+      ALWAYS_ASSERT( el == (size_t)i + 1 );
+    }
+  }
+
+  ALWAYS_ASSERT( size( &our_cmap ) == 100 );
+
+  // Test get.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t el = 0;
+    UNTIL_SUCCESS( get_or_insert( &our_cmap, i, i + 2, &el ) );
+    ALWAYS_ASSERT( el == (size_t)i + 1 );
+  }
+
+  ALWAYS_ASSERT( size( &our_cmap ) == 100 );
+
+  cleanup( &our_cmap );
+}
+
+static void test_cmap_get( void )
+{
+  cmap( int, size_t ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Test empty.
+  size_t el = 0;
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_cmap, i, &el ) );
+
+  // Test get existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 1 ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( get( &our_cmap, i, &el ) && el == (size_t)i + 1 );
+
+  // Test get non-existing and that out is left untouched.
+  for( int i = 100; i < 200; ++i )
+    ALWAYS_ASSERT( !get( &our_cmap, i, &el ) && el == 100 );
+
+  cleanup( &our_cmap );
+}
+
+static void test_cmap_erase( void )
+{
+  cmap( int, size_t ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_cmap ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_cmap, i ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_cmap, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_cmap ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t el;
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_cmap, i, &el ) );
+    else
+      ALWAYS_ASSERT( get( &our_cmap, i, &el ) && el == (size_t)i + 1 );
+  }
+
+  cleanup( &our_cmap );
+}
+
+static void test_cmap_clear( void )
+{
+  cmap( int, size_t ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Test empty.
+  clear( &our_cmap );
+  ALWAYS_ASSERT( size( &our_cmap ) == 0 );
+
+  // Test non-empty.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 1 ) );
+
+  clear( &our_cmap );
+  ALWAYS_ASSERT( size( &our_cmap ) == 0 );
+
+  size_t el;
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_cmap, i, &el ) );
+
+  // Test reuse.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i + 1 ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( get( &our_cmap, i, &el ) && el == (size_t)i + 1 );
+
+  cleanup( &our_cmap );
+}
+
+static void test_cmap_memory_usage( void )
+{
+  cmap( int, size_t ) our_cmap;
+  init( &our_cmap );
+  check_memory_usage( memory_usage( &our_cmap ), 0, 0 );
+
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+  size_t shards_size = sizeof( cc_cmap_hdr_ty ) + CC_CMAP_SHARD_SIZE - 1 + sizeof( cc_cmap_shard_ty ) * 8;
+  check_memory_usage( memory_usage( &our_cmap ), shards_size, 0 );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_cmap, i, i ) );
+
+  cc_mem_usage usage = memory_usage( &our_cmap );
+  ALWAYS_ASSERT( usage.payload == ( sizeof( int ) + sizeof( size_t ) ) * 100 );
+  ALWAYS_ASSERT( usage.allocated > shards_size + usage.payload );
+  ALWAYS_ASSERT( usage.overhead == usage.allocated - usage.payload );
+
+  // Test that the shards' tables remain allocated after clear.
+  clear( &our_cmap );
+  check_memory_usage( memory_usage( &our_cmap ), usage.allocated, 0 );
+
+  cleanup( &our_cmap );
+  check_memory_usage( memory_usage( &our_cmap ), 0, 0 );
+}
+
+static void test_cmap_dtors( void )
+{
+  cmap( custom_ty, custom_ty ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  // Test erase and clear.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_cmap, key, el ) );
+  }
+
+  for( int i = 0; i < 50; i += 2 )
+  {
+    custom_ty key = { i };
+    erase( &our_cmap, key );
+  }
+
+  clear( &our_cmap );
+
+  check_dtors_arr();
+
+  // Test replace.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_cmap, key, el ) );
+  }
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_cmap, key, el ) );
+  }
+
+  check_dtors_arr();
+  clear( &our_cmap );
+
+  // Test cleanup.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_cmap, key, el ) );
+  }
+
+  cleanup( &our_cmap );
+  check_dtors_arr();
+}
+
+// Strings are a special case that warrant seperate testing.
+static void test_cmap_strings( void )
+{
+  cmap( char *, char * ) our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  char str_1[] = "of";
+  char str_2[] = "concurrent";
+  char str_3[] = "maps";
+
+  UNTIL_SUCCESS( insert( &our_cmap, "This", "is" ) );
+  UNTIL_SUCCESS( insert( &our_cmap, "a", "test" ) );
+  UNTIL_SUCCESS( get_or_insert( &our_cmap, str_1, str_2 ) );
+  UNTIL_SUCCESS( get_or_insert( &our_cmap, str_1, str_3 ) );
+  ALWAYS_ASSERT( size( &our_cmap ) == 3 );
+
+  // Look up via pointers to different copies of the keys.
+  char key[] = "This";
+  char *el;
+  ALWAYS_ASSERT( get( &our_cmap, key, &el ) && strcmp( el, "is" ) == 0 );
+  ALWAYS_ASSERT( get( &our_cmap, "a", &el ) && strcmp( el, "test" ) == 0 );
+  ALWAYS_ASSERT( get( &our_cmap, "of", &el ) && strcmp( el, str_2 ) == 0 );
+  ALWAYS_ASSERT( !get( &our_cmap, "maps", &el ) );
+
+  ALWAYS_ASSERT( erase( &our_cmap, key ) );
+  ALWAYS_ASSERT( size( &our_cmap ) == 2 );
+
+  cleanup( &our_cmap );
+}
+
+#ifdef TEST_THREADS
+
+#define CMAP_THREADS_WRITER_COUNT 4
+#define CMAP_THREADS_READER_COUNT 4
+#define CMAP_THREADS_KEYS_PER_WRITER 2000
+
+typedef cmap( int, int ) cmap_threads_ty;
+
+typedef struct
+{
+  cmap_threads_ty *cntr;
+  int first_key;
+} cmap_threads_writer_ctx;
+
+// Inserts every key in the writer's range, replaces the even keys' elements, and then erases the odd keys.
+static void *cmap_threads_writer( void *ctx_ )
+{
+  cmap_threads_writer_ctx *ctx = (cmap_threads_writer_ctx *)ctx_;
+
+  for( int i = ctx->first_key; i < ctx->first_key + CMAP_THREADS_KEYS_PER_WRITER; ++i )
+    UNTIL_SUCCESS( insert( ctx->cntr, i, i ) );
+
+  for( int i = ctx->first_key; i < ctx->first_key + CMAP_THREADS_KEYS_PER_WRITER; i += 2 )
+    UNTIL_SUCCESS( insert( ctx->cntr, i, -i ) );
+
+  for( int i = ctx->first_key + 1; i < ctx->first_key + CMAP_THREADS_KEYS_PER_WRITER; i += 2 )
+    ALWAYS_ASSERT( erase( ctx->cntr, i ) );
+
+  return NULL;
+}
+
+// Checks that every element found is one that a writer associated with the key.
+static void *cmap_threads_reader( void *cntr_ )
+{
+  cmap_threads_ty *cntr = (cmap_threads_ty *)cntr_;
+
+  for( int pass = 0; pass < 4; ++pass )
+    for( int i = 0; i < CMAP_THREADS_WRITER_COUNT * CMAP_THREADS_KEYS_PER_WRITER; ++i )
+    {
+      int el;
+      if( get( cntr, i, &el ) )
+        ALWAYS_ASSERT( el == i || el == -i );
+    }
+
+  return NULL;
+}
+
+static void test_cmap_threads( void )
+{
+  cmap_threads_ty our_cmap;
+  UNTIL_SUCCESS( init_sharded( &our_cmap, 8 ) );
+
+  pthread_t writers[ CMAP_THREADS_WRITER_COUNT ];
+  cmap_threads_writer_ctx writer_ctxs[ CMAP_THREADS_WRITER_COUNT ];
+  pthread_t readers[ CMAP_THREADS_READER_COUNT ];
+
+  for( int i = 0; i < CMAP_THREADS_WRITER_COUNT; ++i )
+  {
+    writer_ctxs[ i ].cntr = &our_cmap;
+    writer_ctxs[ i ].first_key = i * CMAP_THREADS_KEYS_PER_WRITER;
+    ALWAYS_ASSERT( pthread_create( &writers[ i ], NULL, cmap_threads_writer, &writer_ctxs[ i ] ) == 0 );
+  }
+
+  for( int i = 0; i < CMAP_THREADS_READER_COUNT; ++i )
+    ALWAYS_ASSERT( pthread_create( &readers[ i ], NULL, cmap_threads_reader, &our_cmap ) == 0 );
+
+  for( int i = 0; i < CMAP_THREADS_WRITER_COUNT; ++i )
+    ALWAYS_ASSERT( pthread_join( writers[ i ], NULL ) == 0 );
+
+  for( int i = 0; i < CMAP_THREADS_READER_COUNT; ++i )
+    ALWAYS_ASSERT( pthread_join( readers[ i ], NULL ) == 0 );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_cmap ) == CMAP_THREADS_WRITER_COUNT * CMAP_THREADS_KEYS_PER_WRITER / 2 );
+  for( int i = 0; i < CMAP_THREADS_WRITER_COUNT * CMAP_THREADS_KEYS_PER_WRITER; ++i )
+  {
+    int el;
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( get( &our_cmap, i, &el ) && el == -i );
+    else
+      ALWAYS_ASSERT( !get( &our_cmap, i, &el ) );
+  }
+
+  cleanup( &our_cmap );
+}
+
+#endif
+
+#endif
+
+// Ring tests.
+// As with concurrent maps, these tests, except for test_ring_threads, run on one thread, acting as both producer and
+// consumer, so they check the queue semantics of each operation rather than thread safety.
+#ifdef TEST_RING
+
+static void test_ring_init_with_cap( void )
+{
+  ring( int ) our_ring;
+
+  // Test rounding of the capacity.
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 0 ) );
+  ALWAYS_ASSERT( cap( &our_ring ) == 1 );
+  cleanup( &our_ring );
+
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 5 ) );
+  ALWAYS_ASSERT( cap( &our_ring ) == 8 );
+  cleanup( &our_ring );
+
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 64 ) );
+  ALWAYS_ASSERT( cap( &our_ring ) == 64 );
+  ALWAYS_ASSERT( (uintptr_t)our_ring % CC_RING_LINE_SIZE == 0 );
+  cleanup( &our_ring );
+
+  // Test that an impossibly large capacity fails rather than overflowing.
+  ALWAYS_ASSERT( !init_with_cap( &our_ring, SIZE_MAX / 2 ) );
+
+  // Test that a ring without storage rejects pushes.
+  init( &our_ring );
+  int els[ 2 ] = { 0, 1 };
+  int el;
+  ALWAYS_ASSERT( !push( &our_ring, 0 ) );
+  ALWAYS_ASSERT( !push_n( &our_ring, els, 2 ) );
+  ALWAYS_ASSERT( !pop( &our_ring, &el ) );
+  ALWAYS_ASSERT( pop_n( &our_ring, els, 2 ) == 0 );
+  ALWAYS_ASSERT( size( &our_ring ) == 0 );
+  ALWAYS_ASSERT( cap( &our_ring ) == 0 );
+  cleanup( &our_ring );
+  ALWAYS_ASSERT( (void *)our_ring == (void *)&cc_ring_placeholder );
+}
+
+static void test_ring_push_and_pop( void )
+{
+  ring( int ) our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 8 ) );
+
+  // Fill and drain the ring several times so that the elements wrap around the end of its storage.
+  int next_pushed = 0;
+  int next_popped = 0;
+  for( int round = 0; round < 3; ++round )
+  {
+    for( int i = 0; i < 5; ++i )
+      ALWAYS_ASSERT( push( &our_ring, next_pushed++ ) );
+
+    ALWAYS_ASSERT( size( &our_ring ) == 5 );
+
+    for( int i = 0; i < 5; ++i )
+    {
+      int el;
+      ALWAYS_ASSERT( pop( &our_ring, &el ) && el == next_popped++ );
+    }
+  }
+
+  // Test that pushing fails once the ring is full.
+  for( int i = 0; i < 8; ++i )
+    ALWAYS_ASSERT( push( &our_ring, next_pushed++ ) );
+
+  ALWAYS_ASSERT( !push( &our_ring, -1 ) );
+  ALWAYS_ASSERT( size( &our_ring ) == 8 );
+
+  // Test that popping fails once the ring is empty.
+  for( int i = 0; i < 8; ++i )
+  {
+    int el;
+    ALWAYS_ASSERT( pop( &our_ring, &el ) && el == next_popped++ );
+  }
+
+  int el = -1;
+  ALWAYS_ASSERT( !pop( &our_ring, &el ) && el == -1 );
+  ALWAYS_ASSERT( size( &our_ring ) == 0 );
+
+  cleanup( &our_ring );
+}
+
+static void test_ring_push_n_and_pop_n( void )
+{
+  ring( int ) our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 16 ) );
+
+  // Push and pop batches of varying sizes that straddle the end of the ring's storage.
+  int next_pushed = 0;
+  int next_popped = 0;
+  for( int batch = 1; batch <= 16; ++batch )
+  {
+    int els[ 16 ];
+    for( int i = 0; i < batch; ++i )
+      els[ i ] = next_pushed++;
+
+    ALWAYS_ASSERT( push_n( &our_ring, els, batch ) );
+    ALWAYS_ASSERT( size( &our_ring ) == (size_t)batch );
+
+    int out[ 16 ];
+    ALWAYS_ASSERT( pop_n( &our_ring, out, batch ) == (size_t)batch );
+    for( int i = 0; i < batch; ++i )
+      ALWAYS_ASSERT( out[ i ] == next_popped++ );
+  }
+
+  // Test that push_n pushes nothing unless there is room for every element.
+  int els[ 12 ] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+  ALWAYS_ASSERT( push_n( &our_ring, els, 12 ) );
+  ALWAYS_ASSERT( !push_n( &our_ring, els, 5 ) );
+  ALWAYS_ASSERT( size( &our_ring ) == 12 );
+  ALWAYS_ASSERT( push_n( &our_ring, els, 4 ) );
+  ALWAYS_ASSERT( size( &our_ring ) == 16 );
+
+  // Test that pop_n pops as many elements as are available.
+  int out[ 20 ];
+  ALWAYS_ASSERT( pop_n( &our_ring, out, 10 ) == 10 );
+  ALWAYS_ASSERT( pop_n( &our_ring, out + 10, 10 ) == 6 );
+  for( int i = 0; i < 16; ++i )
+    ALWAYS_ASSERT( out[ i ] == ( i < 12 ? i : i - 12 ) );
+
+  ALWAYS_ASSERT( pop_n( &our_ring, out, 10 ) == 0 );
+
+  cleanup( &our_ring );
+}
+
+// Since the head and tail are free-running, they must remain consistent when they wrap around SIZE_MAX.
+static void test_ring_index_overflow( void )
+{
+  ring( size_t ) our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 4 ) );
+
+  cc_ring_hdr( our_ring )->head = SIZE_MAX - 2;
+  cc_ring_hdr( our_ring )->cached_tail = SIZE_MAX - 2;
+  cc_ring_hdr( our_ring )->tail = SIZE_MAX - 2;
+  cc_ring_hdr( our_ring )->cached_head = SIZE_MAX - 2;
+
+  size_t els[ 4 ] = { 10, 11, 12, 13 };
+  ALWAYS_ASSERT( push_n( &our_ring, els, 4 ) );
+  ALWAYS_ASSERT( !push( &our_ring, 14 ) );
+  ALWAYS_ASSERT( size( &our_ring ) == 4 );
+
+  size_t el;
+  ALWAYS_ASSERT( pop( &our_ring, &el ) && el == 10 );
+  ALWAYS_ASSERT( push( &our_ring, 14 ) );
+
+  size_t out[ 4 ];
+  ALWAYS_ASSERT( pop_n( &our_ring, out, 4 ) == 4 );
+  for( size_t i = 0; i < 4; ++i )
+    ALWAYS_ASSERT( out[ i ] == 11 + i );
+
+  ALWAYS_ASSERT( size( &our_ring ) == 0 );
+
+  cleanup( &our_ring );
+}
+
+static void test_ring_clear( void )
+{
+  ring( int ) our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 8 ) );
+
+  for( int i = 0; i < 6; ++i )
+    ALWAYS_ASSERT( push( &our_ring, i ) );
+
+  clear( &our_ring );
+  ALWAYS_ASSERT( size( &our_ring ) == 0 );
+
+  int el;
+  ALWAYS_ASSERT( !pop( &our_ring, &el ) );
+
+  // Test that the ring is still usable after clearing.
+  for( int i = 0; i < 8; ++i )
+    ALWAYS_ASSERT( push( &our_ring, i ) );
+
+  ALWAYS_ASSERT( pop( &our_ring, &el ) && el == 0 );
+
+  cleanup( &our_ring );
+}
+
+static void test_ring_memory_usage( void )
+{
+  ring( int ) our_ring;
+  init( &our_ring );
+  check_memory_usage( memory_usage( &our_ring ), 0, 0 );
+
+  // The capacity is rounded up to 16.
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 10 ) );
+  size_t allocated = CC_RING_LINE_SIZE - 1 + sizeof( cc_ring_hdr_ty ) + sizeof( int ) * 16;
+  check_memory_usage( memory_usage( &our_ring ), allocated, 0 );
+
+  for( int i = 0; i < 5; ++i )
+    ALWAYS_ASSERT( push( &our_ring, i ) );
+
+  check_memory_usage( memory_usage( &our_ring ), allocated, sizeof( int ) * 5 );
+
+  int el;
+  ALWAYS_ASSERT( pop( &our_ring, &el ) );
+  check_memory_usage( memory_usage( &our_ring ), allocated, sizeof( int ) * 4 );
+
+  cleanup( &our_ring );
+  check_memory_usage( memory_usage( &our_ring ), 0, 0 );
+}
+
+static void test_ring_dtors( void )
+{
+  ring( custom_ty ) our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 64 ) );
+
+  // Test that popping hands the elements to the caller rather than destroying them.
+  for( int i = 0; i < 10; ++i )
+  {
+    custom_ty el = { i };
+    ALWAYS_ASSERT( push( &our_ring, el ) );
+  }
+
+  custom_ty out[ 10 ];
+  ALWAYS_ASSERT( pop_n( &our_ring, out, 10 ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( !dtor_called[ i ] && out[ i ].val == i );
+
+  // Test clear.
+  for( int i = 0; i < 60; ++i )
+  {
+    custom_ty el = { i };
+    ALWAYS_ASSERT( push( &our_ring, el ) );
+  }
+
+  clear( &our_ring );
+
+  // Test cleanup.
+  for( int i = 60; i < 100; ++i )
+  {
+    custom_ty el = { i };
+    ALWAYS_ASSERT( push( &our_ring, el ) );
+  }
+
+  cleanup( &our_ring );
+  check_dtors_arr();
+}
+
+#ifdef TEST_THREADS
+
+#define RING_THREADS_EL_COUNT 20000
+
+typedef ring( int ) ring_threads_ty;
+
+// Pushes the sequence of elements in batches of varying sizes, retrying each batch until the ring has room for it.
+// Both threads yield while waiting so that the test also progresses on a single processor.
+static void *ring_threads_producer( void *cntr_ )
+{
+  ring_threads_ty *cntr = (ring_threads_ty *)cntr_;
+
+  int next = 0;
+  int batch = 1;
+  while( next < RING_THREADS_EL_COUNT )
+  {
+    int els[ 16 ];
+    int n = RING_THREADS_EL_COUNT - next < batch ? RING_THREADS_EL_COUNT - next : batch;
+    for( int i = 0; i < n; ++i )
+      els[ i ] = next + i;
+
+    while( !push_n( cntr, els, n ) )
+      sched_yield();
+
+    next += n;
+    batch = batch % 16 + 1;
+  }
+
+  return NULL;
+}
+
+static void test_ring_threads( void )
+{
+  ring_threads_ty our_ring;
+  UNTIL_SUCCESS( init_with_cap( &our_ring, 16 ) );
+
+  pthread_t producer;
+  ALWAYS_ASSERT( pthread_create( &producer, NULL, ring_threads_producer, &our_ring ) == 0 );
+
+  // Pop in batches of a size unrelated to the producer's and check that the sequence arrives intact and in order.
+  int next = 0;
+  while( next < RING_THREADS_EL_COUNT )
+  {
+    int out[ 7 ];
+    size_t n = pop_n( &our_ring, out, 7 );
+    if( n == 0 )
+      sched_yield();
+
+    for( size_t i = 0; i < n; ++i )
+      ALWAYS_ASSERT( out[ i ] == next++ );
+  }
+
+  ALWAYS_ASSERT( pthread_join( producer, NULL ) == 0 );
+  ALWAYS_ASSERT( size( &our_ring ) == 0 );
+
+  cleanup( &our_ring );
+}
+
+#endif
+
+#endif
+
+// Unordered map tests.
+#ifdef TEST_OMAP
+
+static void test_omap_insert( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Sequential input.
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_omap, i, i + 1 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 1 );
+  }
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_omap, i, i + 2 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 2 );
+  }
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 2 );
+
+  clear( &our_omap );
+
+  // Nonsequential input (alternating positive and negative integers).
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 1 );
+  }
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el;
+    UNTIL_SUCCESS( el = insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 2 ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 2 );
+  }
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 2 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_insert_sorted_n( void )
+{
+  // Because nodes may be allocated individually, the input must be small for the insertion to succeed despite the
+  // simulated allocation failures.
+  // Keys 0, 0, 1, 1, 2, 2, ... test that the last of a run of equal keys wins.
+  int keys[ 16 ];
+  size_t els[ 16 ];
+  for( int i = 0; i < 16; ++i )
+  {
+    keys[ i ] = i / 2;
+    els[ i ] = i;
+  }
+
+  omap( int, size_t ) our_omap;
+  UNTIL_SUCCESS( init_from_sorted( &our_omap, keys, els, 16 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 8 );
+
+  int expected_key = 0;
+  for_each( &our_omap, key, el )
+  {
+    ALWAYS_ASSERT( *key == expected_key );
+    ALWAYS_ASSERT( *el == (size_t)expected_key * 2 + 1 );
+    ++expected_key;
+  }
+  ALWAYS_ASSERT( expected_key == 8 );
+
+  // Test that the tree remains valid under further insertions and erasures.
+  UNTIL_SUCCESS( insert( &our_omap, 8, 100 ) );
+  for( int i = 0; i < 8; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 5 );
+  for( int i = 1; i < 8; i += 2 )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i * 2 + 1 );
+
+  // Test insertion into a non-empty ordered map.
+  for( int i = 0; i < 16; ++i )
+    els[ i ] = i + 16;
+
+  UNTIL_SUCCESS( insert_sorted_n( &our_omap, keys, els, 16 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 9 );
+  for( int i = 0; i < 8; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i * 2 + 17 );
+
+  ALWAYS_ASSERT( *get( &our_omap, 8 ) == 100 );
+
+  // Test zero-length input.
+  cleanup( &our_omap );
+  ALWAYS_ASSERT( init_from_sorted( &our_omap, keys, els, 0 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  // Test arena, with which all nodes share one allocation.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  int arena_keys[ 1000 ];
+  size_t arena_els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+  {
+    arena_keys[ i ] = i;
+    arena_els[ i ] = i + 1;
+  }
+
+  UNTIL_SUCCESS( init_with_allocator( &our_omap, cc_arena_allocator( &arena ) ) );
+  UNTIL_SUCCESS( insert_sorted_n( &our_omap, arena_keys, arena_els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 1000 );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 500 );
+  for( int i = 1; i < 1000; i += 2 )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  cleanup( &our_omap );
+  cc_arena_cleanup( &arena );
+}
+
+static void test_omap_insert_n( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Test insertion into an empty ordered map, with keys in scrambled order and repeated keys, of which the last wins.
+  int keys[ 1000 ];
+  size_t els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+  {
+    keys[ i ] = i * 337 % 500;
+    els[ i ] = i;
+  }
+
+  UNTIL_SUCCESS( insert_n( &our_omap, keys, els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 500 );
+
+  int expected_key = 0;
+  for_each( &our_omap, key, el )
+  {
+    ALWAYS_ASSERT( *key == expected_key );
+    ALWAYS_ASSERT( keys[ *el ] == expected_key && *el >= 500 );
+    ++expected_key;
+  }
+  ALWAYS_ASSERT( expected_key == 500 );
+
+  // Test insertion into a non-empty ordered map, with keys in descending order and some keys already present.
+  for( int i = 0; i < 100; ++i )
+  {
+    keys[ i ] = 549 - i;
+    els[ i ] = keys[ i ] + 1;
+  }
+
+  UNTIL_SUCCESS( insert_n( &our_omap, keys, els, 100 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 550 );
+  for( int i = 450; i < 550; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  // Test insertion of keys already in ascending order.
+  for( int i = 0; i < 100; ++i )
+  {
+    keys[ i ] = 500 + i;
+    els[ i ] = keys[ i ] + 2;
+  }
+
+  UNTIL_SUCCESS( insert_n( &our_omap, keys, els, 100 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 600 );
+  for( int i = 500; i < 600; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 2 );
+
+  // Test that the tree remains valid under further erasures.
+  for( int i = 0; i < 600; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 300 );
+  expected_key = 1;
+  for_each( &our_omap, key, el )
+  {
+    ALWAYS_ASSERT( *key == expected_key );
+    expected_key += 2;
+  }
+
+  ALWAYS_ASSERT( expected_key == 601 );
+
+  // Test zero keys.
+  UNTIL_SUCCESS( insert_n( &our_omap, keys, els, 0 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 300 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_get_or_insert( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Test insert.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el;
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, i, i + 1 ) ) );
+    ALWAYS_ASSERT( *el == (size_t)i + 1 );
+  }
+
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  // Test get.
+  for( int i = 0; i < 100; ++i )
+  {
+    size_t *el_1 = get( &our_omap, i );
+    size_t *el_2;
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_omap, i, i + 1 ) ) );
+    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == (size_t)i + 1 );
+  }
+
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_get( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Test empty.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_omap, i ) );
+
+  // Test get existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  // Test get non-existing.
+  for( int i = 100; i < 200; ++i )
+    ALWAYS_ASSERT( !get( &our_omap, i ) );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_get_n( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  int keys[ 200 ];
+  size_t *itrs[ 200 ];
+  for( int i = 0; i < 200; ++i )
+    keys[ i ] = i;
+
+  // Test empty.
+  ALWAYS_ASSERT( get_n( &our_omap, keys, 200, itrs ) == 0 );
+  for( int i = 0; i < 200; ++i )
+    ALWAYS_ASSERT( !itrs[ i ] );
+
+  // Test mix of existing and non-existing, with a count that is not a multiple of the batch size.
+  for( int i = 0; i < 200; i += 2 )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  ALWAYS_ASSERT( get_n( &our_omap, keys, 199, itrs ) == 100 );
+  for( int i = 0; i < 199; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( itrs[ i ] == get( &our_omap, i ) && *itrs[ i ] == (size_t)i + 1 );
+    else
+      ALWAYS_ASSERT( !itrs[ i ] );
+  }
+
+  // Test zero keys.
+  ALWAYS_ASSERT( get_n( &our_omap, keys, 0, itrs ) == 0 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_erase( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Sequential input.
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_omap, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_omap, i ) );
+    else
+      ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+  }
+
+  clear( &our_omap );
+
+  // Nonsequential input (alternating positive and negative integers).
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+    else
+      ALWAYS_ASSERT( *get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 1 );
+  }
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_erase_n( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  // Test mix of existing, non-existing, and repeated keys, with a count that is not a multiple of the batch size.
+  // Repeats occur both within and across batches.
+  int keys[ 150 ];
+  for( int i = 0; i < 100; ++i )
+    keys[ i ] = i * 2;
+
+  for( int i = 100; i < 150; ++i )
+    keys[ i ] = ( i - 100 ) / 2 * 2 + 1;
+
+  ALWAYS_ASSERT( erase_n( &our_omap, keys, 150 ) == 75 );
+  ALWAYS_ASSERT( size( &our_omap ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_omap, i ) == ( i % 2 == 0 || i < 50 ) );
+
+  // Test zero keys.
+  ALWAYS_ASSERT( erase_n( &our_omap, keys, 0 ) == 0 );
+  ALWAYS_ASSERT( size( &our_omap ) == 25 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_erase_itr( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+
+  // Test with iterator from get.
+  for( int i = 0; i < 100; i += 4 )
+    erase_itr( &our_omap, get( &our_omap, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_omap ) == 75 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 4 == 0 )
+      ALWAYS_ASSERT( !get( &our_omap, i ) );
+    else
+    {
+      size_t *el = get( &our_omap, i );
+      ALWAYS_ASSERT( el && *el == i + 1 );
+    }
+  }
+
+  // Test deletion while iterating.
+
+  size_t *el = first( &our_omap );
+  size_t n_iterations = 0;
+  while( el != end( &our_omap ) )
+  {
+    ++n_iterations;
+
+    if( *key_for( &our_omap, el ) % 2 == 0 )
+      el = erase_itr( &our_omap, el );
+    else
+      el = next( &our_omap, el );
+  }
+
+  ALWAYS_ASSERT( n_iterations == 75 );
+  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_omap, i ) );
+    else
+    {
+      el = get( &our_omap, i );
+      ALWAYS_ASSERT( el && *el == i + 1 );
+    }
+  }
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_erase_range( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Empty range in a placeholder.
+  ALWAYS_ASSERT( erase_range( &our_omap, first( &our_omap ), end( &our_omap ) ) == end( &our_omap ) );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  // Range in the middle.
+  size_t *el = erase_range( &our_omap, first( &our_omap, 100 ), first( &our_omap, 900 ) );
+  ALWAYS_ASSERT( *key_for( &our_omap, el ) == 900 );
+  ALWAYS_ASSERT( size( &our_omap ) == 200 );
+
+  // Empty range.
+  el = erase_range( &our_omap, first( &our_omap, 50 ), first( &our_omap, 50 ) );
+  ALWAYS_ASSERT( *key_for( &our_omap, el ) == 50 );
+  ALWAYS_ASSERT( size( &our_omap ) == 200 );
+
+  // Range at the beginning.
+  el = erase_range( &our_omap, first( &our_omap ), first( &our_omap, 10 ) );
+  ALWAYS_ASSERT( el == first( &our_omap ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 190 );
+
+  // Range at the end.
+  el = erase_range( &our_omap, first( &our_omap, 990 ), end( &our_omap ) );
+  ALWAYS_ASSERT( el == end( &our_omap ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 180 );
+
+  // Check.
+  for( int i = 0; i < 1000; ++i )
+  {
+    if( i < 10 || ( i >= 100 && i < 900 ) || i >= 990 )
+      ALWAYS_ASSERT( !get( &our_omap, i ) );
+    else
+    {
+      el = get( &our_omap, i );
+      ALWAYS_ASSERT( el && *el == (size_t)i + 1 );
+    }
+  }
+
+  // The tree remains usable.
+  // Of the 500 even keys, 90 remain from before.
+  for( int i = 0; i < 1000; i += 2 )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 180 + 500 - 90 );
+
+  // Whole tree.
+  ALWAYS_ASSERT( erase_range( &our_omap, first( &our_omap ), end( &our_omap ) ) == end( &our_omap ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  ALWAYS_ASSERT( first( &our_omap ) == end( &our_omap ) );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_erase_if( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  size_t divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_omap, is_size_t_multiple, &divisor ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i ) );
+
+  // Pointer-iterators to the remaining elements remain valid.
+  size_t *el_2 = get( &our_omap, 2 );
+
+  divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_omap, is_size_t_multiple, &divisor ) == 334 );
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_omap, is_size_t_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_omap ) == 333 );
+
+  ALWAYS_ASSERT( get( &our_omap, 2 ) == el_2 && first( &our_omap ) == el_2 );
+  ALWAYS_ASSERT( get( &our_omap, 998 ) == last( &our_omap ) );
+
+  int expected_key = 2;
+  for_each( &our_omap, key, el )
+  {
+    ALWAYS_ASSERT( *key == expected_key && *el == (size_t)expected_key );
+    expected_key += expected_key % 6 == 2 ? 2 : 4;
+  }
+  ALWAYS_ASSERT( expected_key == 1000 );
+
+  divisor = 2;
+  ALWAYS_ASSERT( erase_if( &our_omap, is_size_t_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  ALWAYS_ASSERT( first( &our_omap ) == end( &our_omap ) );
+
+  // The tree remains usable.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i ) );
+
+  divisor = 7;
+  ALWAYS_ASSERT( filter( &our_omap, is_size_t_multiple, &divisor ) == 857 );
+  ALWAYS_ASSERT( erase_if( &our_omap, is_size_t_multiple, &divisor ) == 143 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i ) );
+
+  divisor = 5;
+  ALWAYS_ASSERT( erase_if( &our_omap, is_size_t_multiple, &divisor ) == 200 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( erase( &our_omap, i ) == ( i % 5 != 0 ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  cleanup( &our_omap );
+
+  // Test that erase_if calls the destructors for each erased key and element.
+  omap( custom_ty, custom_ty ) our_custom_omap;
+  init( &our_custom_omap );
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_custom_omap, key, el ) );
+  }
+
+  ALWAYS_ASSERT( erase_if( &our_custom_omap, is_custom_ty_even, NULL ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( dtor_called[ i ] == ( i % 2 == 0 ) );
+
+  cleanup( &our_custom_omap );
+  check_dtors_arr();
+}
+
+static void test_omap_split_at_and_join( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+  omap( int, size_t ) upper;
+  init( &upper );
+
+  // Placeholders.
+  UNTIL_SUCCESS( split_at( &our_omap, 0, &upper ) );
+  UNTIL_SUCCESS( join( &our_omap, &upper ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  ALWAYS_ASSERT( size( &upper ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  // Split at a key that exists.
+  UNTIL_SUCCESS( split_at( &our_omap, 600, &upper ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 600 );
+  ALWAYS_ASSERT( size( &upper ) == 400 );
+  ALWAYS_ASSERT( *key_for( &our_omap, last( &our_omap ) ) == 599 );
+  ALWAYS_ASSERT( *key_for( &upper, first( &upper ) ) == 600 );
+
+  // Split at a key that does not exist, moving the pairs into a non-empty container.
+  UNTIL_SUCCESS( erase( &our_omap, 300 ) );
+  UNTIL_SUCCESS( split_at( &our_omap, 300, &upper ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 300 );
+  ALWAYS_ASSERT( size( &upper ) == 699 );
+
+  // Split beyond the last key.
+  UNTIL_SUCCESS( split_at( &our_omap, 1000, &upper ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 300 );
+  ALWAYS_ASSERT( size( &upper ) == 699 );
+
+  // Check.
+  for( int i = 0; i < 1000; ++i )
+  {
+    size_t *el = get( i < 300 ? &our_omap : &upper, i );
+    if( i == 300 )
+      ALWAYS_ASSERT( !el );
+    else
+      ALWAYS_ASSERT( el && *el == (size_t)i + 1 );
+
+    ALWAYS_ASSERT( !get( i < 300 ? &upper : &our_omap, i ) );
+  }
+
+  // Join in both directions.
+  UNTIL_SUCCESS( join( &upper, &our_omap ) );
+  ALWAYS_ASSERT( size( &upper ) == 999 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  UNTIL_SUCCESS( split_at( &upper, 500, &our_omap ) );
+  UNTIL_SUCCESS( join( &upper, &our_omap ) );
+  ALWAYS_ASSERT( size( &upper ) == 999 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  // Join overlapping containers, whose shared keys take the source's elements.
+  for( int i = 0; i < 1100; i += 10 )
+    UNTIL_SUCCESS( insert( &our_omap, i, 0 ) );
+
+  UNTIL_SUCCESS( join( &upper, &our_omap ) );
+  ALWAYS_ASSERT( size( &upper ) == 1000 + 10 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  size_t expected_key = 0;
+  for_each( &upper, key, el )
+  {
+    ALWAYS_ASSERT( (size_t)*key == expected_key );
+    ALWAYS_ASSERT( *el == ( *key % 10 == 0 ? 0 : (size_t)*key + 1 ) );
+    expected_key += expected_key < 1000 ? 1 : 10;
+  }
+
+  cleanup( &our_omap );
+  cleanup( &upper );
+}
+
+static void test_omap_clear( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Test empty.
+  clear( &our_omap );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  // Test non-empty;
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  clear( &our_omap );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_omap, i ) );
+
+  // Test reuse.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_cleanup( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Empty.
+  cleanup( &our_omap );
+  ALWAYS_ASSERT( (void *)our_omap == (void *)&cc_omap_placeholder );
+
+  // Non-empty.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  cleanup( &our_omap );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  ALWAYS_ASSERT( (void *)our_omap == (void *)&cc_omap_placeholder );
+
+  // Test use.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_init_clone( void )
+{
+  omap( int, size_t ) src_omap;
+  init( &src_omap );
+
+  // Test init_clone placeholder.
+  omap( int, size_t ) empty_omap;
+  UNTIL_SUCCESS( init_clone( &empty_omap, &src_omap ) );
+  ALWAYS_ASSERT( (void *)empty_omap == (void *)&cc_omap_placeholder );
+
+  // Test init_clone non-placeholder.
+  omap( int, size_t ) our_omap;
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &src_omap, i, i + 1 ) );
+  UNTIL_SUCCESS( init_clone( &our_omap, &src_omap ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_omap ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  cleanup( &src_omap );
+  cleanup( &empty_omap );
+  cleanup( &our_omap );
+}
+
+static void test_omap_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  omap( int, size_t ) our_omap;
+  UNTIL_SUCCESS( init_with_allocator( &our_omap, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+
+  // Test that clones share the allocator.
+  // Because nodes are allocated individually, the ordered map must be small for the clone to succeed despite the
+  // simulated allocation failures.
+  size_t allocs_before_clone = allocs;
+  omap( int, size_t ) our_omap_clone;
+  UNTIL_SUCCESS( init_clone( &our_omap_clone, &our_omap ) );
+  ALWAYS_ASSERT( allocs > allocs_before_clone );
+  ALWAYS_ASSERT( size( &our_omap_clone ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_omap_clone, i ) == (size_t)i + 1 );
+
+  // Test that clones of empty ordered maps share the allocator.
+  omap( int, size_t ) empty_omap;
+  omap( int, size_t ) empty_omap_clone;
+  UNTIL_SUCCESS( init_with_allocator( &empty_omap, &allocator ) );
+  UNTIL_SUCCESS( init_clone( &empty_omap_clone, &empty_omap ) );
+  ALWAYS_ASSERT( (void *)empty_omap_clone != (void *)&cc_omap_placeholder );
+
+  cleanup( &our_omap );
+  cleanup( &our_omap_clone );
+  cleanup( &empty_omap );
+  cleanup( &empty_omap_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_omap, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 500 );
+  for( int i = 1; i < 1000; i += 2 )
+    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+
+  cleanup( &our_omap );
+  cc_arena_cleanup( &arena );
+}
+
+#ifdef CC_STATS
+static void test_omap_stats( void )
+{
+  omap( int, int ) our_omap;
+  init( &our_omap );
+
+  cc_stats stats;
+  get_stats( &our_omap, &stats );
+  ALWAYS_ASSERT( stats.size == 0 );
+  ALWAYS_ASSERT( stats.height == 0 );
+
+  for( int i = 0; i < 1023; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, i, i ) );
+
+  // A red-black tree with n nodes has a height of at least log2( n + 1 ) and at most twice that.
+  get_stats( &our_omap, &stats );
+  ALWAYS_ASSERT( stats.size == 1023 );
+  ALWAYS_ASSERT( stats.height >= 10 && stats.height <= 20 );
+
+  cleanup( &our_omap );
+}
+#endif
+
+// This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
+// from placeholder to non-placeholder.
+static void test_omap_iteration_and_get_key( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  size_t *r_end = r_end( &our_omap );
+  size_t *end = end( &our_omap );
+
+  // Empty.
+
+  // Test first and last.
+  ALWAYS_ASSERT( first( &our_omap ) == end( &our_omap ) );
+  ALWAYS_ASSERT( last( &our_omap ) == r_end( &our_omap ) );
+
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_omap, r_end( &our_omap ) ) == first( &our_omap ) );
+  ALWAYS_ASSERT( prev( &our_omap, end( &our_omap ) ) == last( &our_omap ) );
+
+  size_t n_iterations = 0;
+  for( size_t *i = first( &our_omap ); i != end( &our_omap ); i = next( &our_omap, i ) )
+    ++n_iterations;
+  for( size_t *i = last( &our_omap ); i != r_end( &our_omap ); i = prev( &our_omap, i ) )
+    ++n_iterations;
+  for_each( &our_omap, i )
+    ++n_iterations;
+  r_for_each( &our_omap, i )
+    ++n_iterations;
+  for_each( &our_omap, k, i )
+    ++n_iterations;
+  r_for_each( &our_omap, k, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  // Insert keys in random order.
+
+  const int keys[ 100 ] = {
+    12, 10, 29, 8, 27, 9, 14, 23, 18, 19, 11, 20, 24, 1, 0, 5, 2, 3, 6, 13, 28, 25, 22, 21, 15, 4, 7, 16, 26, 17
+  };
+
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, keys[ i ], keys[ i ] + 1 ) );
+
+  size_t *last_iteration = NULL;
+  for( size_t *i = first( &our_omap ); i != end( &our_omap ); i = next( &our_omap, i ) )
+  {
+    ALWAYS_ASSERT( (size_t)*key_for( &our_omap, i ) == *i - 1 );
+    ALWAYS_ASSERT( !last_iteration || *key_for( &our_omap, i ) > *key_for( &our_omap, last_iteration ) );
+    ++n_iterations;
+    last_iteration = i;
+  }
+
+  last_iteration = NULL;
+  for( size_t *i = last( &our_omap ); i != r_end( &our_omap ); i = prev( &our_omap, i ) )
+  {
+    ALWAYS_ASSERT( (size_t)*key_for( &our_omap, i ) == *i - 1 );
+    ALWAYS_ASSERT( !last_iteration || *key_for( &our_omap, i ) < *key_for( &our_omap, last_iteration ) );
+    ++n_iterations;
+    last_iteration = i;
+  }
+
+  for_each( &our_omap, i )
+    ++n_iterations;
+  r_for_each( &our_omap, i )
+    ++n_iterations;
+
+  for_each( &our_omap, k, i )
+  {
+    ALWAYS_ASSERT( (size_t)*k == *i - 1 );
+    ++n_iterations;
+  }
+  r_for_each( &our_omap, k, i )
+  {
+    ALWAYS_ASSERT( (size_t)*k == *i - 1 );
+    ++n_iterations;
+  }
+
+  ALWAYS_ASSERT( n_iterations == 180 );
+
+  // Test iterator stability.
+  ALWAYS_ASSERT( r_end( &our_omap ) == r_end );
+  ALWAYS_ASSERT( end( &our_omap ) == end );
+
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_omap, r_end( &our_omap ) ) == first( &our_omap ) );
+  ALWAYS_ASSERT( prev( &our_omap, end( &our_omap ) ) == last( &our_omap ) );
+
+  // Iteration over empty, non-placeholder ordered map.
+
+  clear( &our_omap );
+
+  n_iterations = 0;
+
+  for_each( &our_omap, i )
+    ++n_iterations;
+
+  r_for_each( &our_omap, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_iteration_over_range( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Empty.
+
+  size_t n_iterations = 0;
+  for(
+    size_t *i = first( &our_omap, 25 ), *range_end = first( &our_omap, 75 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+    ++n_iterations;
+
+  for(
+    size_t *i = last( &our_omap, 74 ), *range_end = last( &our_omap, 24 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  // Insert keys in random order.
+
+  const int keys[ 100 ] = {
+    44, 13, 39, 68, 33, 88, 87, 58, 73, 28, 95, 56, 93, 8, 50, 92, 78, 80, 97, 53,
+    27, 77, 35, 38, 91, 45, 3, 37, 98, 81, 63, 65, 32, 90, 72, 5, 36, 99, 17, 6,
+    16, 11, 67, 47, 48, 71, 1, 82, 69, 21, 54, 15, 61, 9, 19, 84, 60, 26, 42, 70,
+    64, 18, 34, 23, 75, 52, 89, 83, 86, 10, 94, 24, 57, 59, 41, 20, 25, 12, 85, 96,
+    66, 55, 7, 2, 76, 46, 14, 31, 43, 4, 22, 30, 40, 29, 0, 74, 51, 49, 62, 79
+  };
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, keys[ i ], 0 ) );
+
+  // Test ranges that do not include r_end or end.
+
+  for(
+    size_t *i = first( &our_omap, 25 ), *range_end = first( &our_omap, 75 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+  {
+    const int *key = key_for( &our_omap, i );
+    ALWAYS_ASSERT( *key >= 25 && *key < 75 );
+    ++n_iterations;
+  }
+
+  for(
+    size_t *i = last( &our_omap, 75 ), *range_end = last( &our_omap, 25 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+  {
+    const int *key = key_for( &our_omap, i );
+    ALWAYS_ASSERT( *key > 25 && *key <= 75 );
+    ++n_iterations;
+  }
+
+  ALWAYS_ASSERT( n_iterations == 100 );
+
+  // Test ranges that overlap r_end or end.
+
+  for(
+    size_t *i = first( &our_omap, -1 ), *range_end = first( &our_omap, 50 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+  {
+    ALWAYS_ASSERT( *key_for( &our_omap, i ) < 50 );
+    ++n_iterations;
+  }
+
+  for(
+    size_t *i = first( &our_omap, 50 ), *range_end = first( &our_omap, 100 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+  {
+    ALWAYS_ASSERT( *key_for( &our_omap, i ) >= 50 );
+    ++n_iterations;
+  }
+
+  for(
+    size_t *i = last( &our_omap, 100 ), *range_end = last( &our_omap, 49 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+  {
+    ALWAYS_ASSERT( *key_for( &our_omap, i ) >= 50 );
+    ++n_iterations;
+  }
+
+  for(
+    size_t *i = last( &our_omap, 49 ), *range_end = last( &our_omap, -1 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+  {
+    ALWAYS_ASSERT( *key_for( &our_omap, i ) <= 49 );
+    ++n_iterations;
+  }
+
+  for(
+    size_t *i = first( &our_omap, -1 ), *range_end = first( &our_omap, 100 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+    ++n_iterations;
+
+  for(
+    size_t *i = last( &our_omap, 100 ), *range_end = last( &our_omap, -1 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 500 );
+
+  // Test ranges with no keys.
+
+  for(
+    size_t *i = first( &our_omap, 100 ), *range_end = first( &our_omap, 200 );
+    i != range_end;
+    i = next( &our_omap, i )
+  )
+    ++n_iterations;
+
+  for(
+    size_t *i = last( &our_omap, -1 ), *range_end = last( &our_omap, -100 );
+    i != range_end;
+    i = prev( &our_omap, i )
+  )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 500 );
+
+  cleanup( &our_omap );
+}
+
+// Checks that nth and rank agree with the order in which iteration visits the keys.
+static void check_omap_order_statistics( omap( int, size_t ) *our_omap )
+{
+  size_t position = 0;
+  for_each( our_omap, key, el )
+  {
+    ALWAYS_ASSERT( nth( our_omap, position ) == el );
+    ALWAYS_ASSERT( rank( our_omap, *key ) == position );
+    ++position;
+  }
+  ALWAYS_ASSERT( position == size( our_omap ) );
+  ALWAYS_ASSERT( nth( our_omap, position ) == end( our_omap ) );
+}
+
+static void test_omap_order_statistics( void )
+{
+  omap( int, size_t ) our_omap;
+  init( &our_omap );
+
+  // Empty.
+  ALWAYS_ASSERT( nth( &our_omap, 0 ) == end( &our_omap ) );
+  ALWAYS_ASSERT( rank( &our_omap, 10 ) == 0 );
+  ALWAYS_ASSERT( count_range( &our_omap, 0, 10 ) == 0 );
+
+  // Insert the even keys from 0 to 198 in random order.
+  const int keys[ 100 ] = {
+    44, 13, 39, 68, 33, 88, 87, 58, 73, 28, 95, 56, 93, 8, 50, 92, 78, 80, 97, 53,
+    27, 77, 35, 38, 91, 45, 3, 37, 98, 81, 63, 65, 32, 90, 72, 5, 36, 99, 17, 6,
+    16, 11, 67, 47, 48, 71, 1, 82, 69, 21, 54, 15, 61, 9, 19, 84, 60, 26, 42, 70,
+    64, 18, 34, 23, 75, 52, 89, 83, 86, 10, 94, 24, 57, 59, 41, 20, 25, 12, 85, 96,
+    66, 55, 7, 2, 76, 46, 14, 31, 43, 4, 22, 30, 40, 29, 0, 74, 51, 49, 62, 79
+  };
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, keys[ i ] * 2, keys[ i ] ) );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    ALWAYS_ASSERT( *key_for( &our_omap, nth( &our_omap, i ) ) == i * 2 );
+    ALWAYS_ASSERT( rank( &our_omap, i * 2 ) == (size_t)i );
+    ALWAYS_ASSERT( rank( &our_omap, i * 2 + 1 ) == (size_t)i + 1 );
+  }
+  ALWAYS_ASSERT( rank( &our_omap, -1 ) == 0 );
+  check_omap_order_statistics( &our_omap );
+
+  // Ranges whose bounds are and are not keys.
+  ALWAYS_ASSERT( count_range( &our_omap, 10, 20 ) == 6 );
+  ALWAYS_ASSERT( count_range( &our_omap, 11, 19 ) == 4 );
+  ALWAYS_ASSERT( count_range( &our_omap, 11, 11 ) == 0 );
+  ALWAYS_ASSERT( count_range( &our_omap, 20, 10 ) == 0 );
+  ALWAYS_ASSERT( count_range( &our_omap, -100, 1000 ) == 100 );
+  ALWAYS_ASSERT( count_range( &our_omap, 198, 1000 ) == 1 );
+
+  // Erase via keys and pointer-iterators.
+  for( int i = 0; i < 100; ++i )
+    if( keys[ i ] % 3 == 0 )
+      ALWAYS_ASSERT( erase( &our_omap, keys[ i ] * 2 ) );
+
+  for( size_t *i = first( &our_omap ); i != end( &our_omap ); )
+  {
+    if( *key_for( &our_omap, i ) % 5 == 1 )
+      i = erase_itr( &our_omap, i );
+    else
+      i = next( &our_omap, i );
+  }
+  check_omap_order_statistics( &our_omap );
+  ALWAYS_ASSERT( count_range( &our_omap, 0, 198 ) == size( &our_omap ) );
+
+  // erase_if rebuilds the tree, so it must also recompute every node's count.
+  size_t divisor = 4;
+  erase_if( &our_omap, is_size_t_multiple, &divisor );
+  check_omap_order_statistics( &our_omap );
+  ALWAYS_ASSERT( count_range( &our_omap, 0, 198 ) == size( &our_omap ) );
+
+  // Clone.
+  omap( int, size_t ) small_omap;
+  init( &small_omap );
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &small_omap, keys[ i ], 0 ) );
+
+  omap( int, size_t ) clone;
+  UNTIL_SUCCESS( init_clone( &clone, &small_omap ) );
+  check_omap_order_statistics( &clone );
+
+  // Build from sorted keys.
+  int sorted_keys[ 50 ];
+  size_t els[ 50 ];
+  for( int i = 0; i < 50; ++i )
+  {
+    sorted_keys[ i ] = i * 3;
+    els[ i ] = i;
+  }
+
+  clear( &small_omap );
+  UNTIL_SUCCESS( insert_sorted_n( &small_omap, sorted_keys, els, 50 ) );
+  check_omap_order_statistics( &small_omap );
+  ALWAYS_ASSERT( count_range( &small_omap, 30, 60 ) == 11 );
+
+  cleanup( &our_omap );
+  cleanup( &small_omap );
+  cleanup( &clone );
+}
+
+static void test_omap_memory_usage( void )
+{
+  omap( int, short ) our_omap;
+  init( &our_omap );
+  check_memory_usage( memory_usage( &our_omap ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_omap, &allocator ) );
+  check_memory_usage( memory_usage( &our_omap ), bytes, 0 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_omap, i, (short)i ) );
+    check_memory_usage( memory_usage( &our_omap ), bytes, ( sizeof( int ) + sizeof( short ) ) * (size_t)( i + 1 ) );
+  }
+
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_omap, i ) );
+
+  check_memory_usage( memory_usage( &our_omap ), bytes, ( sizeof( int ) + sizeof( short ) ) * 100 );
+
+  cleanup( &our_omap );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_omap ), 0, 0 );
+}
+
+static void test_omap_dtors( void )
+{
+  omap( custom_ty, custom_ty ) our_omap;
+  init( &our_omap );
+
+  // Test erase and clear.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+
+  for( int i = 0; i < 50; i += 2 )
+  {
+    custom_ty key = { i };
+    erase( &our_omap, key );
+  }
+
+  clear( &our_omap );
+
+  check_dtors_arr();
+
+  // Test replace.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+
+  check_dtors_arr();
+  clear( &our_omap );
+
+  // Test cleanup.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+
+  // Test erase_range, split_at, and join.
+
+  for( int i = 0; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+
+  omap( custom_ty, custom_ty ) other;
+  init( &other );
+
+  custom_ty bound = { 10 };
+  custom_ty split_key = { 30 };
+  erase_range( &our_omap, first( &our_omap ), first( &our_omap, bound ) );
+  UNTIL_SUCCESS( split_at( &our_omap, split_key, &other ) );
+
+  // Joining overlapping ordered maps replaces the destination's pairs that share keys with the source.
+  for( int i = 40; i < 50; ++i )
+  {
+    custom_ty key = { i };
+    custom_ty el = { i + 50 };
+    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+  }
+
+  UNTIL_SUCCESS( join( &other, &our_omap ) );
+  cleanup( &our_omap );
+  cleanup( &other );
+  check_dtors_arr();
+}
+
+// Strings are a special case that warrant seperate testing.
+static void test_omap_strings( void )
+{
+  omap( char *, char * ) our_omap;
+  init( &our_omap );
+
+  char **el;
+
+  // String literals.
+  UNTIL_SUCCESS( ( el = insert( &our_omap, "This", "is" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, "a", "test" ) ) );
+  ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
+
+  // Other strings.
+  char str_1[] = "of";
+  char str_2[] = "maps";
+  char str_3[] = "with";
+  char str_4[] = "strings.";
+
+  UNTIL_SUCCESS( ( el = insert( &our_omap, str_1, str_2 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, str_3, str_4 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_omap ) == 4 );
+  ALWAYS_ASSERT( strcmp( *get( &our_omap, "This" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_omap, "a" ), "test" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_omap, str_1, str_2 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_omap, str_3, str_4 ) ) );
+  ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
+  ALWAYS_ASSERT( size( &our_omap ) == 4 );
+
+  // Erase.
+  erase( &our_omap, "This" );
+  erase( &our_omap, str_1 );
+  ALWAYS_ASSERT( size( &our_omap ) == 2 );
+
+  // Iteration.
+  for_each( &our_omap, i )
+    ALWAYS_ASSERT( strcmp( *i, "test" ) == 0 || strcmp( *i, str_4 ) == 0 );
+
+  cleanup( &our_omap );
+}
+
+static void test_omap_str( void )
+{
+  omap( cc_str, int ) our_omap;
+  init( &our_omap );
+
+  char chars[] = "abc\0abd";
+  cc_str strs[] = {
+    { chars + 4, 3 }, // "abd".
+    { chars, 4 },     // "abc\0".
+    { chars, 3 },     // "abc".
+    { chars, 0 },     // Empty.
+    { chars, 2 }      // "ab".
+  };
+
+  for( int i = 0; i < 5; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, strs[ i ], i ) );
+
+  ALWAYS_ASSERT( size( &our_omap ) == 5 );
+
+  // Shorter strings precede the longer strings that they prefix.
+  int expected[] = { 3, 4, 2, 1, 0 };
+  int n = 0;
+  for_each( &our_omap, el )
+    ALWAYS_ASSERT( *el == expected[ n++ ] );
+
+  ALWAYS_ASSERT( n == 5 );
+
+  cleanup( &our_omap );
+}
+
+// Nodes are only padded as much as the element and key types require, so this tests that over-aligned elements and
+// keys are still suitably aligned.
+static void test_omap_alignment( void )
+{
+  omap( char, long double ) our_omap;
+  init( &our_omap );
+
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &our_omap, (char)i, (long double)i ) );
+
+  for( int i = 0; i < 10; ++i )
+  {
+    long double *el = get( &our_omap, (char)i );
+    ALWAYS_ASSERT( (uintptr_t)el % alignof( long double ) == 0 );
+    ALWAYS_ASSERT( *el == (long double)i );
+  }
+
+  // Because nodes are allocated individually, the ordered map must be small for the clone to succeed despite the
+  // simulated allocation failures.
+  omap( char, long double ) our_omap_clone;
+  UNTIL_SUCCESS( init_clone( &our_omap_clone, &our_omap ) );
+  for_each( &our_omap_clone, el )
+    ALWAYS_ASSERT( (uintptr_t)el % alignof( long double ) == 0 );
+
+  for( int i = 0; i < 10; i += 2 )
+    ALWAYS_ASSERT( erase( &our_omap, (char)i ) );
+  ALWAYS_ASSERT( size( &our_omap ) == 5 );
+
+  cleanup( &our_omap );
+  cleanup( &our_omap_clone );
+}
+
+#define TEST_OMAP_DEFAULT_INTEGER_TYPE( ty )    \
+{                                               \
+  omap( ty, int ) our_omap;                     \
+  init( &our_omap );                            \
+                                                \
+  for( int i = 0; i < 100; ++i )                \
+    UNTIL_SUCCESS( insert( &our_omap, i, i ) ); \
+                                                \
+  for( int i = 0; i < 100; ++i )                \
+    ALWAYS_ASSERT( *get( &our_omap, i ) == i ); \
+                                                \
+  cleanup( &our_omap );                         \
+}                                               \
+
+static void test_omap_default_integer_types( void )
+{
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( char );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( short );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( int );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_OMAP_DEFAULT_INTEGER_TYPE( size_t );
+}
+
+#endif
+
+// Unordered set tests.
+#ifdef TEST_OSET
+
+static void test_oset_insert( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Sequential input.
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_oset, i ) );
+    ALWAYS_ASSERT( *el == i );
+  }
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_oset, i ) );
+    ALWAYS_ASSERT( *el == i );
+  }
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  clear( &our_oset );
+
+  // Nonsequential input (alternating positive and negative integers).
+
+  // Insert new.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( *el == i * ( i % 2 ? 1 : -1 ) );
+  }
+
+  // Insert existing.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( el = insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( *el == i * ( i % 2 ? 1 : -1 ) );
+  }
+
+  // Check.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_insert_sorted_n( void )
+{
+  // Because nodes may be allocated individually, the input must be small for the insertion to succeed despite the
+  // simulated allocation failures.
+  int els[ 16 ];
+  for( int i = 0; i < 16; ++i )
+    els[ i ] = i / 2;
+
+  oset( int ) our_oset;
+  UNTIL_SUCCESS( init_from_sorted( &our_oset, els, 16 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 8 );
+
+  int expected_el = 0;
+  for_each( &our_oset, el )
+    ALWAYS_ASSERT( *el == expected_el++ );
+
+  ALWAYS_ASSERT( expected_el == 8 );
+
+  // Test that the tree remains valid under further insertions and erasures.
+  UNTIL_SUCCESS( insert( &our_oset, 8 ) );
+  for( int i = 0; i < 8; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 5 );
+  for( int i = 0; i <= 8; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) == !( i % 2 == 1 || i == 8 ) );
+
+  // Test insertion into a non-empty ordered set.
+  UNTIL_SUCCESS( insert_sorted_n( &our_oset, els, 16 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 9 );
+
+  // Test arena, with which all nodes share one allocation.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  int arena_els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+    arena_els[ i ] = i;
+
+  cleanup( &our_oset );
+  UNTIL_SUCCESS( init_with_allocator( &our_oset, cc_arena_allocator( &arena ) ) );
+  UNTIL_SUCCESS( insert_sorted_n( &our_oset, arena_els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 1000 );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 500 );
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) == !( i % 2 ) );
+
+  cleanup( &our_oset );
+  cc_arena_cleanup( &arena );
+}
+
+static void test_oset_insert_n( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Test insertion into an empty ordered set, with elements in scrambled order and repeated elements.
+  int els[ 1000 ];
+  for( int i = 0; i < 1000; ++i )
+    els[ i ] = i * 337 % 500;
+
+  UNTIL_SUCCESS( insert_n( &our_oset, els, 1000 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 500 );
+
+  int expected_el = 0;
+  for_each( &our_oset, el )
+    ALWAYS_ASSERT( *el == expected_el++ );
+
+  ALWAYS_ASSERT( expected_el == 500 );
+
+  // Test insertion into a non-empty ordered set, with elements in descending order and some elements already present.
+  for( int i = 0; i < 100; ++i )
+    els[ i ] = 549 - i;
+
+  UNTIL_SUCCESS( insert_n( &our_oset, els, 100 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 550 );
+
+  expected_el = 0;
+  for_each( &our_oset, el )
+    ALWAYS_ASSERT( *el == expected_el++ );
+
+  ALWAYS_ASSERT( expected_el == 550 );
+
+  // Test zero elements.
+  UNTIL_SUCCESS( insert_n( &our_oset, els, 0 ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 550 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_get_or_insert( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Test insert.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el;
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_oset, i ) ) );
+    ALWAYS_ASSERT( *el == i );
+  }
+
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  // Test get.
+  for( int i = 0; i < 100; ++i )
+  {
+    int *el_1 = get( &our_oset, i );
+    int *el_2;
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_oset, i ) ) );
+    ALWAYS_ASSERT( el_2 == el_1 && *el_2 == i );
+  }
+
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_get( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Test empty.
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) );
+
+  // Test get existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  // Test get non-existing.
+  for( int i = 100; i < 200; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_get_n( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  int keys[ 200 ];
+  int *itrs[ 200 ];
+  for( int i = 0; i < 200; ++i )
+    keys[ i ] = i;
+
+  // Test empty.
+  ALWAYS_ASSERT( get_n( &our_oset, keys, 200, itrs ) == 0 );
+  for( int i = 0; i < 200; ++i )
+    ALWAYS_ASSERT( !itrs[ i ] );
+
+  // Test mix of existing and non-existing, with a count that is not a multiple of the batch size.
+  for( int i = 0; i < 200; i += 2 )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  ALWAYS_ASSERT( get_n( &our_oset, keys, 199, itrs ) == 100 );
+  for( int i = 0; i < 199; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( itrs[ i ] == get( &our_oset, i ) && *itrs[ i ] == i );
+    else
+      ALWAYS_ASSERT( !itrs[ i ] );
+  }
+
+  // Test zero keys.
+  ALWAYS_ASSERT( get_n( &our_oset, keys, 0, itrs ) == 0 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_erase( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Sequential input.
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_oset, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_oset, i ) );
+    else
+      ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+  }
+
+  clear( &our_oset );
+
+  // Nonsequential input (alternating positive and negative integers).
+
+  // Test erase existing.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+
+  // Test erase non-existing.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( !erase( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    else
+      ALWAYS_ASSERT( *get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
+  }
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_erase_n( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  // Test mix of existing, non-existing, and repeated elements, with a count that is not a multiple of the batch size.
+  int els[ 150 ];
+  for( int i = 0; i < 100; ++i )
+    els[ i ] = i * 2;
+
+  for( int i = 100; i < 150; ++i )
+    els[ i ] = ( i - 100 ) / 2 * 2 + 1;
+
+  ALWAYS_ASSERT( erase_n( &our_oset, els, 150 ) == 75 );
+  ALWAYS_ASSERT( size( &our_oset ) == 25 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) == ( i % 2 == 0 || i < 50 ) );
+
+  // Test zero elements.
+  ALWAYS_ASSERT( erase_n( &our_oset, els, 0 ) == 0 );
+  ALWAYS_ASSERT( size( &our_oset ) == 25 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_erase_itr( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+
+  // Test with iterator from get.
+  for( int i = 0; i < 100; i += 4 )
+    erase_itr( &our_oset, get( &our_oset, i ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_oset ) == 75 );
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 4 == 0 )
+      ALWAYS_ASSERT( !get( &our_oset, i ) );
+    else
+    {
+      int *el = get( &our_oset, i );
+      ALWAYS_ASSERT( el && *el == i );
+    }
+  }
+
+  // Test deletion while iterating.
+
+  int *el = first( &our_oset );
+  size_t n_iterations = 0;
+  while( el != end( &our_oset ) )
+  {
+    ++n_iterations;
+
+    if( *el % 2 == 0 )
+      el = erase_itr( &our_oset, el );
+    else
+      el = next( &our_oset, el );
+  }
+
+  ALWAYS_ASSERT( n_iterations == 75 );
+  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    if( i % 2 == 0 )
+      ALWAYS_ASSERT( !get( &our_oset, i ) );
+    else
+    {
+      el = get( &our_oset, i );
+      ALWAYS_ASSERT( el && *el == i  );
+    }
+  }
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_erase_range_split_at_and_join( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+  oset( int ) upper;
+  init( &upper );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  int *el = erase_range( &our_oset, first( &our_oset, 100 ), first( &our_oset, 900 ) );
+  ALWAYS_ASSERT( *el == 900 );
+  ALWAYS_ASSERT( size( &our_oset ) == 200 );
+
+  UNTIL_SUCCESS( split_at( &our_oset, 50, &upper ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  ALWAYS_ASSERT( size( &upper ) == 150 );
+  ALWAYS_ASSERT( *last( &our_oset ) == 49 );
+  ALWAYS_ASSERT( *first( &upper ) == 50 );
+
+  UNTIL_SUCCESS( join( &our_oset, &upper ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 200 );
+  ALWAYS_ASSERT( size( &upper ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( (bool)get( &our_oset, i ) == ( i < 100 || i >= 900 ) );
+
+  cleanup( &our_oset );
+  cleanup( &upper );
+}
+
+static void test_oset_erase_if( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  int divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_oset, is_int_multiple, &divisor ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  int *el_2 = get( &our_oset, 2 );
+
+  divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_oset, is_int_multiple, &divisor ) == 334 );
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_oset, is_int_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_oset ) == 333 );
+  ALWAYS_ASSERT( first( &our_oset ) == el_2 );
+  ALWAYS_ASSERT( *last( &our_oset ) == 998 );
+
+  int expected_el = 2;
+  for_each( &our_oset, i )
+  {
+    ALWAYS_ASSERT( *i == expected_el );
+    expected_el += expected_el % 6 == 2 ? 2 : 4;
+  }
+  ALWAYS_ASSERT( expected_el == 1000 );
+
+  // The tree remains usable.
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_clear( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Test empty.
+  clear( &our_oset );
+  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+
+  // Test non-empty;
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  clear( &our_oset );
+  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( !get( &our_oset, i ) );
+
+  // Test reuse.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_cleanup( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Empty.
+  cleanup( &our_oset );
+  ALWAYS_ASSERT( (void *)our_oset == (void *)&cc_omap_placeholder );
+
+  // Non-empty.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  cleanup( &our_oset );
+  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+  ALWAYS_ASSERT( (void *)our_oset == (void *)&cc_omap_placeholder );
+
+  // Test use.
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+  for( int i = 0; i < 100; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_init_clone( void )
+{
+  oset( int ) src_oset;
+  init( &src_oset );
+
+  // Test init_clone placeholder.
+  oset( int ) empty_oset;
+  UNTIL_SUCCESS( init_clone( &empty_oset, &src_oset ) );
+  ALWAYS_ASSERT( (void *)empty_oset == (void *)&cc_omap_placeholder );
+
+  // Test init_clone non-placeholder.
+  oset( int ) our_oset;
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &src_oset, i ) );
+  UNTIL_SUCCESS( init_clone( &our_oset, &src_oset ) );
+
+  // Check.
+  ALWAYS_ASSERT( size( &our_oset ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  cleanup( &src_oset );
+  cleanup( &empty_oset );
+  cleanup( &our_oset );
+}
+
+static void test_oset_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  oset( int ) our_oset;
+  UNTIL_SUCCESS( init_with_allocator( &our_oset, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+
+  // Test that clones share the allocator.
+  // Because nodes are allocated individually, the ordered set must be small for the clone to succeed despite the
+  // simulated allocation failures.
+  size_t allocs_before_clone = allocs;
+  oset( int ) our_oset_clone;
+  UNTIL_SUCCESS( init_clone( &our_oset_clone, &our_oset ) );
+  ALWAYS_ASSERT( allocs > allocs_before_clone );
+  ALWAYS_ASSERT( size( &our_oset_clone ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_oset_clone, i ) == i );
+
+  // Test that clones of empty ordered sets share the allocator.
+  oset( int ) empty_oset;
+  oset( int ) empty_oset_clone;
+  UNTIL_SUCCESS( init_with_allocator( &empty_oset, &allocator ) );
+  UNTIL_SUCCESS( init_clone( &empty_oset_clone, &empty_oset ) );
+  ALWAYS_ASSERT( (void *)empty_oset_clone != (void *)&cc_omap_placeholder );
+
+  cleanup( &our_oset );
+  cleanup( &our_oset_clone );
+  cleanup( &empty_oset );
+  cleanup( &empty_oset_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_oset, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
+
+  ALWAYS_ASSERT( size( &our_oset ) == 500 );
+  for( int i = 1; i < 1000; i += 2 )
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+
+  cleanup( &our_oset );
+  cc_arena_cleanup( &arena );
+}
+
+// This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
+// from placeholder to non-placeholder.
+static void test_oset_iteration( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  int *r_end = r_end( &our_oset );
+  int *end = end( &our_oset );
+
+  // Empty.
+
+  // Test first and last.
+  ALWAYS_ASSERT( first( &our_oset ) == end( &our_oset ) );
+  ALWAYS_ASSERT( last( &our_oset ) == r_end( &our_oset ) );
+
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_oset, r_end( &our_oset ) ) == first( &our_oset ) );
+  ALWAYS_ASSERT( prev( &our_oset, end( &our_oset ) ) == last( &our_oset ) );
+
+  size_t n_iterations = 0;
+  for( int *i = first( &our_oset ); i != end( &our_oset ); i = next( &our_oset, i ) )
+    ++n_iterations;
+  for( int *i = last( &our_oset ); i != r_end( &our_oset ); i = prev( &our_oset, i ) )
+    ++n_iterations;
+  for_each( &our_oset, i )
+    ++n_iterations;
+  r_for_each( &our_oset, i )
+    ++n_iterations;
+  for_each( &our_oset, i )
+    ++n_iterations;
+  r_for_each( &our_oset, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  // Insert keys in random order.
+
+  const int keys[ 100 ] = {
+    12, 10, 29, 8, 27, 9, 14, 23, 18, 19, 11, 20, 24, 1, 0, 5, 2, 3, 6, 13, 28, 25, 22, 21, 15, 4, 7, 16, 26, 17
+  };
+
+  for( int i = 0; i < 30; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, keys[ i ] ) );
+
+  int *last_iteration = NULL;
+  for( int *i = first( &our_oset ); i != end( &our_oset ); i = next( &our_oset, i ) )
+  {
+    ALWAYS_ASSERT( !last_iteration || *i > *last_iteration );
+    ++n_iterations;
+    last_iteration = i;
+  }
+
+  last_iteration = NULL;
+  for( int *i = last( &our_oset ); i != r_end( &our_oset ); i = prev( &our_oset, i ) )
+  {
+    ALWAYS_ASSERT( !last_iteration || *i < *last_iteration );
+    ++n_iterations;
+    last_iteration = i;
+  }
+
+  for_each( &our_oset, i )
+    ++n_iterations;
+  r_for_each( &our_oset, i )
+    ++n_iterations;
+
+  for_each( &our_oset, i )
+    ++n_iterations;
+  r_for_each( &our_oset, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 180 );
+
+  // Test iterator stability.
+  ALWAYS_ASSERT( r_end( &our_oset ) == r_end );
+  ALWAYS_ASSERT( end( &our_oset ) == end );
+
+  // Test iteration from r_end and end.
+  ALWAYS_ASSERT( next( &our_oset, r_end( &our_oset ) ) == first( &our_oset ) );
+  ALWAYS_ASSERT( prev( &our_oset, end( &our_oset ) ) == last( &our_oset ) );
+
+  // Iteration over empty, non-placeholder ordered map.
+
+  clear( &our_oset );
+
+  n_iterations = 0;
+
+  for_each( &our_oset, i )
+    ++n_iterations;
+
+  r_for_each( &our_oset, i )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  cleanup( &our_oset );
+}
+
+static void test_oset_iteration_over_range( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+
+  // Empty.
+
+  size_t n_iterations = 0;
+  for(
+    int *i = first( &our_oset, 25 ), *range_end = first( &our_oset, 75 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+    ++n_iterations;
+
+  for(
+    int *i = last( &our_oset, 74 ), *range_end = last( &our_oset, 24 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+    ++n_iterations;
+
+  ALWAYS_ASSERT( n_iterations == 0 );
+
+  // Non-empty.
+
+  // Insert keys in random order.
+
+  const int keys[ 100 ] = {
+    44, 13, 39, 68, 33, 88, 87, 58, 73, 28, 95, 56, 93, 8, 50, 92, 78, 80, 97, 53,
+    27, 77, 35, 38, 91, 45, 3, 37, 98, 81, 63, 65, 32, 90, 72, 5, 36, 99, 17, 6,
+    16, 11, 67, 47, 48, 71, 1, 82, 69, 21, 54, 15, 61, 9, 19, 84, 60, 26, 42, 70,
+    64, 18, 34, 23, 75, 52, 89, 83, 86, 10, 94, 24, 57, 59, 41, 20, 25, 12, 85, 96,
+    66, 55, 7, 2, 76, 46, 14, 31, 43, 4, 22, 30, 40, 29, 0, 74, 51, 49, 62, 79
+  };
+
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, keys[ i ] ) );
+
+  // Test ranges that do not include r_end or end.
+
+  for(
+    int *i = first( &our_oset, 25 ), *range_end = first( &our_oset, 75 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i >= 25 && *i < 75 );
+    ++n_iterations;
+  }
+
+  for(
+    int *i = last( &our_oset, 75 ), *range_end = last( &our_oset, 25 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i > 25 && *i <= 75 );
+    ++n_iterations;
+  }
+
+  ALWAYS_ASSERT( n_iterations == 100 );
+
+  // Test ranges that overlap r_end or end.
+
+  for(
+    int *i = first( &our_oset, -1 ), *range_end = first( &our_oset, 50 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i < 50 );
+    ++n_iterations;
+  }
+
+  for(
+    int *i = first( &our_oset, 50 ), *range_end = first( &our_oset, 100 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i >= 50 );
+    ++n_iterations;
+  }
+
+  for(
+    int *i = last( &our_oset, 100 ), *range_end = last( &our_oset, 49 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i >= 50 );
+    ++n_iterations;
+  }
+
+  for(
+    int *i = last( &our_oset, 49 ), *range_end = last( &our_oset, -1 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+  {
+    ALWAYS_ASSERT( *i <= 49 );
+    ++n_iterations;
+  }
+
+  for(
+    int *i = first( &our_oset, -1 ), *range_end = first( &our_oset, 100 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+    ++n_iterations;
 
-  // Test use.
-  for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
-  for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+  for(
+    int *i = last( &our_oset, 100 ), *range_end = last( &our_oset, -1 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+    ++n_iterations;
 
-  cleanup( &our_set );
-}
+  ALWAYS_ASSERT( n_iterations == 500 );
 
-static void test_set_init_clone( void )
-{
-  set( int ) src_set;
-  init( &src_set );
+  // Test ranges with no keys.
 
-  // Test init_clone placeholder.
-  set( int ) empty_set;
-  UNTIL_SUCCESS( init_clone( &empty_set, &src_set ) );
-  ALWAYS_ASSERT( (void *)empty_set == (void *)&cc_map_placeholder );
+  for(
+    int *i = first( &our_oset, 100 ), *range_end = first( &our_oset, 200 );
+    i != range_end;
+    i = next( &our_oset, i )
+  )
+    ++n_iterations;
 
-  // Test init_clone non-placeholder.
-  set( int ) our_set = NULL;
-  for( int i = 0; i < 10; ++i )
-    UNTIL_SUCCESS( insert( &src_set, i ) );
-  UNTIL_SUCCESS( init_clone( &our_set, &src_set ) );
+  for(
+    int *i = last( &our_oset, -1 ), *range_end = last( &our_oset, -100 );
+    i != range_end;
+    i = prev( &our_oset, i )
+  )
+    ++n_iterations;
 
-  // Check
-  ALWAYS_ASSERT( size( &our_set ) == 10 );
-  for( int i = 0; i < 10; ++i )
-    ALWAYS_ASSERT( *get( &our_set, i ) == i );
+  ALWAYS_ASSERT( n_iterations == 500 );
 
-  cleanup( &src_set );
-  cleanup( &empty_set );
-  cleanup( &our_set );
+  cleanup( &our_oset );
 }
 
-static void test_set_iteration( void )
+static void test_oset_order_statistics( void )
 {
-  set( int ) our_set;
-  init( &our_set );
-
-  // Empty.
-
-  // Test first and last.
-  ALWAYS_ASSERT( first( &our_set ) == end( &our_set ) );
-
-  size_t n_iterations = 0;
+  oset( int ) our_oset;
+  init( &our_oset );
 
-  for( int *i = first( &our_set ); i != end( &our_set ); i = next( &our_set, i ) )
-    ++n_iterations;
+  // Insert the even elements from 0 to 198 in random order.
+  const int keys[ 100 ] = {
+    44, 13, 39, 68, 33, 88, 87, 58, 73, 28, 95, 56, 93, 8, 50, 92, 78, 80, 97, 53,
+    27, 77, 35, 38, 91, 45, 3, 37, 98, 81, 63, 65, 32, 90, 72, 5, 36, 99, 17, 6,
+    16, 11, 67, 47, 48, 71, 1, 82, 69, 21, 54, 15, 61, 9, 19, 84, 60, 26, 42, 70,
+    64, 18, 34, 23, 75, 52, 89, 83, 86, 10, 94, 24, 57, 59, 41, 20, 25, 12, 85, 96,
+    66, 55, 7, 2, 76, 46, 14, 31, 43, 4, 22, 30, 40, 29, 0, 74, 51, 49, 62, 79
+  };
 
-  for_each( &our_set, i )
-    ++n_iterations;
+  for( int i = 0; i < 100; ++i )
+    UNTIL_SUCCESS( insert( &our_oset, keys[ i ] * 2 ) );
 
-  ALWAYS_ASSERT( n_iterations == 0 );
+  for( int i = 0; i < 100; ++i )
+  {
+    ALWAYS_ASSERT( *nth( &our_oset, i ) == i * 2 );
+    ALWAYS_ASSERT( rank( &our_oset, i * 2 ) == (size_t)i );
+    ALWAYS_ASSERT( rank( &our_oset, i * 2 + 1 ) == (size_t)i + 1 );
+  }
+  ALWAYS_ASSERT( nth( &our_oset, 100 ) == end( &our_oset ) );
 
-  // Non-empty.
+  ALWAYS_ASSERT( count_range( &our_oset, 10, 20 ) == 6 );
+  ALWAYS_ASSERT( count_range( &our_oset, 11, 19 ) == 4 );
+  ALWAYS_ASSERT( count_range( &our_oset, 20, 10 ) == 0 );
 
-  for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( insert( &our_set, i ) );
-  
-  for( int *i = first( &our_set ); i != end( &our_set ); i = next( &our_set, i ) )
-    ++n_iterations;
+  // Erase every other element and check again.
+  for( int i = 0; i < 100; i += 2 )
+    ALWAYS_ASSERT( erase( &our_oset, i * 2 ) );
 
-  for_each( &our_set, i )
-    ++n_iterations;
+  for( int i = 0; i < 50; ++i )
+  {
+    ALWAYS_ASSERT( *nth( &our_oset, i ) == i * 4 + 2 );
+    ALWAYS_ASSERT( rank( &our_oset, i * 4 + 2 ) == (size_t)i );
+  }
+  ALWAYS_ASSERT( count_range( &our_oset, 0, 198 ) == 50 );
 
-  ALWAYS_ASSERT( n_iterations == 60 );
+  cleanup( &our_oset );
+}
 
-  // Iteration over empty, non-placeholder set.
+static void test_oset_memory_usage( void )
+{
+  oset( int ) our_oset;
+  init( &our_oset );
+  check_memory_usage( memory_usage( &our_oset ), 0, 0 );
 
-  clear( &our_set );
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_oset, &allocator ) );
+  check_memory_usage( memory_usage( &our_oset ), bytes, 0 );
 
-  n_iterations = 0;
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    check_memory_usage( memory_usage( &our_oset ), bytes, sizeof( int ) * (size_t)( i + 1 ) );
+  }
 
-  for_each( &our_set, i )
-    ++n_iterations;
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_oset, i ) );
 
-  ALWAYS_ASSERT( n_iterations == 0 );
+  check_memory_usage( memory_usage( &our_oset ), bytes, sizeof( int ) * 100 );
 
-  cleanup( &our_set );
+  cleanup( &our_oset );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_oset ), 0, 0 );
 }
 
-static void test_set_dtors( void )
+static void test_oset_dtors( void )
 {
-  set( custom_ty ) our_set;
-  init( &our_set );
+  oset( custom_ty ) our_oset;
+  init( &our_oset );
 
   // Test erase and clear.
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_set, el ) );
+    UNTIL_SUCCESS( insert( &our_oset, el ) );
   }
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    erase( &our_set, el );
+    erase( &our_oset, el );
   }
 
-  clear( &our_set );
+  clear( &our_oset );
 
   check_dtors_arr();
 
@@ -1959,44 +7568,45 @@ static void test_set_dtors( void )
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_set, el ) );
+    UNTIL_SUCCESS( insert( &our_oset, el ) );
   }
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_set, el ) );
+    UNTIL_SUCCESS( insert( &our_oset, el ) );
   }
 
   check_dtors_arr();
-  clear( &our_set );
+  clear( &our_oset );
 
   // Test cleanup.
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_set, el ) );
+    UNTIL_SUCCESS( insert( &our_oset, el ) );
   }
 
-  cleanup( &our_set );
+  cleanup( &our_oset );
   check_dtors_arr();
 }
 
-static void test_set_strings( void )
+// Strings are a special case that warrant seperate testing.
+static void test_oset_strings( void )
 {
-  set( char * ) our_set;
-  init( &our_set );
+  oset( char * ) our_oset;
+  init( &our_oset );
 
   char **el;
 
   // String literals.
-  UNTIL_SUCCESS( ( el = insert( &our_set, "This" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, "This" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "This" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, "is" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, "is" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, "a" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, "a" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "a" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, "test" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, "test" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
 
   // Other strings.
@@ -2005,68 +7615,68 @@ static void test_set_strings( void )
   char str_3[] = "with";
   char str_4[] = "strings";
 
-  UNTIL_SUCCESS( ( el = insert( &our_set, str_1 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, str_1 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_1 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, str_2 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, str_2 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, str_3 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, str_3 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_3 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_set, str_4 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_oset, str_4 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_set ) == 8 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "This" ), "This" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "is" ), "is" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "a" ), "a" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "test" ), "test" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "of" ), str_1 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "sets" ), str_2 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "with" ), str_3 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_set, "strings" ), str_4 ) == 0 );
+  ALWAYS_ASSERT( size( &our_oset ) == 8 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "This" ), "This" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "is" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "a" ), "a" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "test" ), "test" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "of" ), str_1 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "sets" ), str_2 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "with" ), str_3 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_oset, "strings" ), str_4 ) == 0 );
 
-  cleanup( &our_set );
+  cleanup( &our_oset );
 }
 
-#define TEST_SET_DEFAULT_INTEGER_TYPE( ty )    \
-{                                              \
-  set( ty ) our_set;                           \
-  init( &our_set );                            \
-                                               \
-  for( ty i = 0; i < 100; ++i )                \
-    UNTIL_SUCCESS( insert( &our_set, i ) );    \
-                                               \
-  for( ty i = 0; i < 100; ++i )                \
-    ALWAYS_ASSERT( *get( &our_set, i ) == i ); \
-                                               \
-  cleanup( &our_set );                         \
-}                                              \
+#define TEST_OSET_DEFAULT_INTEGER_TYPE( ty )    \
+{                                               \
+  oset( ty ) our_oset;                          \
+  init( &our_oset );                            \
+                                                \
+  for( int i = 0; i < 100; ++i )                \
+    UNTIL_SUCCESS( insert( &our_oset, i ) );    \
+                                                \
+  for( int i = 0; i < 100; ++i )                \
+    ALWAYS_ASSERT( *get( &our_oset, i ) == i ); \
+                                                \
+  cleanup( &our_oset );                         \
+}                                               \
 
-static void test_set_default_integer_types( void )
+static void test_oset_default_integer_types( void )
 {
-  TEST_SET_DEFAULT_INTEGER_TYPE( char );
-  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned char );
-  TEST_SET_DEFAULT_INTEGER_TYPE( signed char );
-  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned short );
-  TEST_SET_DEFAULT_INTEGER_TYPE( short );
-  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned int );
-  TEST_SET_DEFAULT_INTEGER_TYPE( int );
-  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned long );
-  TEST_SET_DEFAULT_INTEGER_TYPE( long );
-  TEST_SET_DEFAULT_INTEGER_TYPE( unsigned long long );
-  TEST_SET_DEFAULT_INTEGER_TYPE( long );
-  TEST_SET_DEFAULT_INTEGER_TYPE( size_t );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( char );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( short );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( int );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( long );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( long );
+  TEST_OSET_DEFAULT_INTEGER_TYPE( size_t );
 }
 
 #endif
 
-// Unordered map tests.
-#ifdef TEST_OMAP
+// B-tree map tests.
+#ifdef TEST_BMAP
 
-static void test_omap_insert( void )
+static void test_bmap_insert( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Sequential input.
 
@@ -2074,7 +7684,7 @@ static void test_omap_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( el = insert( &our_bmap, i, i + 1 ) );
     ALWAYS_ASSERT( *el == (size_t)i + 1 );
   }
 
@@ -2082,15 +7692,15 @@ static void test_omap_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_omap, i, i + 2 ) );
+    UNTIL_SUCCESS( el = insert( &our_bmap, i, i + 2 ) );
     ALWAYS_ASSERT( *el == (size_t)i + 2 );
   }
 
   // Check.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 2 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 2 );
 
-  clear( &our_omap );
+  clear( &our_bmap );
 
   // Nonsequential input (alternating positive and negative integers).
 
@@ -2098,7 +7708,7 @@ static void test_omap_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
+    UNTIL_SUCCESS( el = insert( &our_bmap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
     ALWAYS_ASSERT( *el == (size_t)i + 1 );
   }
 
@@ -2106,301 +7716,409 @@ static void test_omap_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     size_t *el;
-    UNTIL_SUCCESS( el = insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 2 ) );
+    UNTIL_SUCCESS( el = insert( &our_bmap, i * ( i % 2 ? 1 : -1 ), i + 2 ) );
     ALWAYS_ASSERT( *el == (size_t)i + 2 );
   }
 
   // Check.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 2 );
+    ALWAYS_ASSERT( *get( &our_bmap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 2 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_get_or_insert( void )
+static void test_bmap_get_or_insert( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Test insert.
   for( int i = 0; i < 100; ++i )
   {
     size_t *el;
-    UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, i, i + 1 ) ) );
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_bmap, i, i + 1 ) ) );
     ALWAYS_ASSERT( *el == (size_t)i + 1 );
   }
 
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
 
   // Test get.
   for( int i = 0; i < 100; ++i )
   {
-    size_t *el_1 = get( &our_omap, i );
+    size_t *el_1 = get( &our_bmap, i );
     size_t *el_2;
-    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_omap, i, i + 1 ) ) );
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_bmap, i, i + 1 ) ) );
     ALWAYS_ASSERT( el_2 == el_1 && *el_2 == (size_t)i + 1 );
   }
 
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_get( void )
+static void test_bmap_get( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Test empty.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_omap, i ) );
+    ALWAYS_ASSERT( !get( &our_bmap, i ) );
 
   // Test get existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
 
   // Test get non-existing.
   for( int i = 100; i < 200; ++i )
-    ALWAYS_ASSERT( !get( &our_omap, i ) );
+    ALWAYS_ASSERT( !get( &our_bmap, i ) );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_erase( void )
+static void test_bmap_erase( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Sequential input.
 
   // Test erase existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
 
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
 
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_omap, i ) );
+    ALWAYS_ASSERT( erase( &our_bmap, i ) );
 
   // Test erase non-existing.
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_omap, i ) );
+    ALWAYS_ASSERT( !erase( &our_bmap, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 50 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_omap, i ) );
+      ALWAYS_ASSERT( !get( &our_bmap, i ) );
     else
-      ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+      ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
   }
 
-  clear( &our_omap );
+  clear( &our_bmap );
 
   // Nonsequential input (alternating positive and negative integers).
 
   // Test erase existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i * ( i % 2 ? 1 : -1 ), i + 1 ) );
 
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
 
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( erase( &our_bmap, i * ( i % 2 ? 1 : -1 ) ) );
 
   // Test erase non-existing.
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( !erase( &our_bmap, i * ( i % 2 ? 1 : -1 ) ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 50 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) );
+      ALWAYS_ASSERT( !get( &our_bmap, i * ( i % 2 ? 1 : -1 ) ) );
     else
-      ALWAYS_ASSERT( *get( &our_omap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 1 );
+      ALWAYS_ASSERT( *get( &our_bmap, i * ( i % 2 ? 1 : -1 ) ) == (size_t)i + 1 );
   }
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_erase_itr( void )
+static void test_bmap_erase_itr( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
 
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
 
   // Test with iterator from get.
   for( int i = 0; i < 100; i += 4 )
-    erase_itr( &our_omap, get( &our_omap, i ) );
+    erase_itr( &our_bmap, get( &our_bmap, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_omap ) == 75 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 75 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 4 == 0 )
-      ALWAYS_ASSERT( !get( &our_omap, i ) );
+      ALWAYS_ASSERT( !get( &our_bmap, i ) );
     else
     {
-      size_t *el = get( &our_omap, i );
+      size_t *el = get( &our_bmap, i );
       ALWAYS_ASSERT( el && *el == i + 1 );
     }
   }
 
   // Test deletion while iterating.
 
-  size_t *el = first( &our_omap );
+  size_t *el = first( &our_bmap );
   size_t n_iterations = 0;
-  while( el != end( &our_omap ) )
+  while( el != end( &our_bmap ) )
   {
     ++n_iterations;
 
-    if( *key_for( &our_omap, el ) % 2 == 0 )
-      el = erase_itr( &our_omap, el );
+    if( *key_for( &our_bmap, el ) % 2 == 0 )
+      el = erase_itr( &our_bmap, el );
     else
-      el = next( &our_omap, el );
+      el = next( &our_bmap, el );
   }
 
   ALWAYS_ASSERT( n_iterations == 75 );
-  ALWAYS_ASSERT( size( &our_omap ) == 50 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 50 );
 
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_omap, i ) );
+      ALWAYS_ASSERT( !get( &our_bmap, i ) );
     else
     {
-      el = get( &our_omap, i );
+      el = get( &our_bmap, i );
       ALWAYS_ASSERT( el && *el == i + 1 );
     }
   }
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_clear( void )
+static void test_bmap_erase_if( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
+
+  size_t divisor = 1;
+  ALWAYS_ASSERT( erase_if( &our_bmap, is_size_t_multiple, &divisor ) == 0 );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_bmap, i, i ) );
+
+  divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_bmap, is_size_t_multiple, &divisor ) == 334 );
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_bmap, is_size_t_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 333 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    size_t *el = get( &our_bmap, i );
+    if( i % 2 == 0 && i % 3 != 0 )
+      ALWAYS_ASSERT( el && *el == (size_t)i );
+    else
+      ALWAYS_ASSERT( !el );
+  }
+
+  cleanup( &our_bmap );
+}
+
+static void test_bmap_clear( void )
+{
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Test empty.
-  clear( &our_omap );
-  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  clear( &our_bmap );
+  ALWAYS_ASSERT( size( &our_bmap ) == 0 );
 
   // Test non-empty;
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
 
-  clear( &our_omap );
-  ALWAYS_ASSERT( size( &our_omap ) == 0 );
+  clear( &our_bmap );
+  ALWAYS_ASSERT( size( &our_bmap ) == 0 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_omap, i ) );
+    ALWAYS_ASSERT( !get( &our_bmap, i ) );
 
   // Test reuse.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_cleanup( void )
+static void test_bmap_cleanup( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Empty.
-  cleanup( &our_omap );
-  ALWAYS_ASSERT( (void *)our_omap == (void *)&cc_omap_placeholder );
+  cleanup( &our_bmap );
+  ALWAYS_ASSERT( (void *)our_bmap == (void *)&cc_bmap_placeholder );
 
   // Non-empty.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
-  ALWAYS_ASSERT( size( &our_omap ) == 100 );
-  cleanup( &our_omap );
-  ALWAYS_ASSERT( size( &our_omap ) == 0 );
-  ALWAYS_ASSERT( (void *)our_omap == (void *)&cc_omap_placeholder );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
+  ALWAYS_ASSERT( size( &our_bmap ) == 100 );
+  cleanup( &our_bmap );
+  ALWAYS_ASSERT( size( &our_bmap ) == 0 );
+  ALWAYS_ASSERT( (void *)our_bmap == (void *)&cc_bmap_placeholder );
 
   // Test use.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, i, i + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_init_clone( void )
+static void test_bmap_init_clone( void )
 {
-  omap( int, size_t ) src_omap;
-  init( &src_omap );
+  bmap( int, size_t ) src_bmap;
+  init( &src_bmap );
 
   // Test init_clone placeholder.
-  omap( int, size_t ) empty_omap;
-  UNTIL_SUCCESS( init_clone( &empty_omap, &src_omap ) );
-  ALWAYS_ASSERT( (void *)empty_omap == (void *)&cc_omap_placeholder );
+  bmap( int, size_t ) empty_bmap;
+  UNTIL_SUCCESS( init_clone( &empty_bmap, &src_bmap ) );
+  ALWAYS_ASSERT( (void *)empty_bmap == (void *)&cc_bmap_placeholder );
 
   // Test init_clone non-placeholder.
-  omap( int, size_t ) our_omap;
+  bmap( int, size_t ) our_bmap;
   for( int i = 0; i < 10; ++i )
-    UNTIL_SUCCESS( insert( &src_omap, i, i + 1 ) );
-  UNTIL_SUCCESS( init_clone( &our_omap, &src_omap ) );
+    UNTIL_SUCCESS( insert( &src_bmap, i, i + 1 ) );
+  UNTIL_SUCCESS( init_clone( &our_bmap, &src_bmap ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_omap ) == 10 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 10 );
   for( int i = 0; i < 10; ++i )
-    ALWAYS_ASSERT( *get( &our_omap, i ) == (size_t)i + 1 );
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
 
-  cleanup( &src_omap );
-  cleanup( &empty_omap );
-  cleanup( &our_omap );
+  cleanup( &src_bmap );
+  cleanup( &empty_bmap );
+  cleanup( &our_bmap );
+}
+
+static void test_bmap_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  bmap( int, size_t ) our_bmap;
+  UNTIL_SUCCESS( init_with_allocator( &our_bmap, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 0 );
+
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
+
+  // Test that clones share the allocator.
+  // Because nodes are allocated in several slabs, the B-tree map must be small for the clone to succeed despite the
+  // simulated allocation failures.
+  size_t allocs_before_clone = allocs;
+  bmap( int, size_t ) our_bmap_clone;
+  UNTIL_SUCCESS( init_clone( &our_bmap_clone, &our_bmap ) );
+  ALWAYS_ASSERT( allocs > allocs_before_clone );
+  ALWAYS_ASSERT( size( &our_bmap_clone ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_bmap_clone, i ) == (size_t)i + 1 );
+
+  // Test that clones of empty B-tree maps share the allocator.
+  bmap( int, size_t ) empty_bmap;
+  bmap( int, size_t ) empty_bmap_clone;
+  UNTIL_SUCCESS( init_with_allocator( &empty_bmap, &allocator ) );
+  UNTIL_SUCCESS( init_clone( &empty_bmap_clone, &empty_bmap ) );
+  ALWAYS_ASSERT( (void *)empty_bmap_clone != (void *)&cc_bmap_placeholder );
+
+  cleanup( &our_bmap );
+  cleanup( &our_bmap_clone );
+  cleanup( &empty_bmap );
+  cleanup( &empty_bmap_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_bmap, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_bmap, i, i + 1 ) );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_bmap, i ) );
+
+  ALWAYS_ASSERT( size( &our_bmap ) == 500 );
+  for( int i = 1; i < 1000; i += 2 )
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == (size_t)i + 1 );
+
+  cleanup( &our_bmap );
+  cc_arena_cleanup( &arena );
+}
+
+#ifdef CC_STATS
+static void test_bmap_stats( void )
+{
+  bmap( int, int ) our_bmap;
+  init( &our_bmap );
+
+  cc_stats stats;
+  get_stats( &our_bmap, &stats );
+  ALWAYS_ASSERT( stats.size == 0 );
+  ALWAYS_ASSERT( stats.height == 0 );
+
+  for( int i = 0; i < 1023; ++i )
+    UNTIL_SUCCESS( insert( &our_bmap, i, i ) );
+
+  // Each node holds many keys, so the tree is far shallower than a red-black tree of the same size.
+  get_stats( &our_bmap, &stats );
+  ALWAYS_ASSERT( stats.size == 1023 );
+  ALWAYS_ASSERT( stats.height >= 2 && stats.height <= 4 );
+
+  cleanup( &our_bmap );
 }
+#endif
 
 // This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
 // from placeholder to non-placeholder.
-static void test_omap_iteration_and_get_key( void )
+static void test_bmap_iteration_and_get_key( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
-  size_t *r_end = r_end( &our_omap );
-  size_t *end = end( &our_omap );
+  size_t *r_end = r_end( &our_bmap );
+  size_t *end = end( &our_bmap );
 
   // Empty.
 
   // Test first and last.
-  ALWAYS_ASSERT( first( &our_omap ) == end( &our_omap ) );
-  ALWAYS_ASSERT( last( &our_omap ) == r_end( &our_omap ) );
+  ALWAYS_ASSERT( first( &our_bmap ) == end( &our_bmap ) );
+  ALWAYS_ASSERT( last( &our_bmap ) == r_end( &our_bmap ) );
 
   // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_omap, r_end( &our_omap ) ) == first( &our_omap ) );
-  ALWAYS_ASSERT( prev( &our_omap, end( &our_omap ) ) == last( &our_omap ) );
+  ALWAYS_ASSERT( next( &our_bmap, r_end( &our_bmap ) ) == first( &our_bmap ) );
+  ALWAYS_ASSERT( prev( &our_bmap, end( &our_bmap ) ) == last( &our_bmap ) );
 
   size_t n_iterations = 0;
-  for( size_t *i = first( &our_omap ); i != end( &our_omap ); i = next( &our_omap, i ) )
+  for( size_t *i = first( &our_bmap ); i != end( &our_bmap ); i = next( &our_bmap, i ) )
     ++n_iterations;
-  for( size_t *i = last( &our_omap ); i != r_end( &our_omap ); i = prev( &our_omap, i ) )
+  for( size_t *i = last( &our_bmap ); i != r_end( &our_bmap ); i = prev( &our_bmap, i ) )
     ++n_iterations;
-  for_each( &our_omap, i )
+  for_each( &our_bmap, i )
     ++n_iterations;
-  r_for_each( &our_omap, i )
+  r_for_each( &our_bmap, i )
     ++n_iterations;
-  for_each( &our_omap, k, i )
+  for_each( &our_bmap, k, i )
     ++n_iterations;
-  r_for_each( &our_omap, k, i )
+  r_for_each( &our_bmap, k, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 0 );
@@ -2414,37 +8132,37 @@ static void test_omap_iteration_and_get_key( void )
   };
 
   for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, keys[ i ], keys[ i ] + 1 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, keys[ i ], keys[ i ] + 1 ) );
 
   size_t *last_iteration = NULL;
-  for( size_t *i = first( &our_omap ); i != end( &our_omap ); i = next( &our_omap, i ) )
+  for( size_t *i = first( &our_bmap ); i != end( &our_bmap ); i = next( &our_bmap, i ) )
   {
-    ALWAYS_ASSERT( (size_t)*key_for( &our_omap, i ) == *i - 1 );
-    ALWAYS_ASSERT( !last_iteration || *key_for( &our_omap, i ) > *key_for( &our_omap, last_iteration ) );
+    ALWAYS_ASSERT( (size_t)*key_for( &our_bmap, i ) == *i - 1 );
+    ALWAYS_ASSERT( !last_iteration || *key_for( &our_bmap, i ) > *key_for( &our_bmap, last_iteration ) );
     ++n_iterations;
     last_iteration = i;
   }
 
   last_iteration = NULL;
-  for( size_t *i = last( &our_omap ); i != r_end( &our_omap ); i = prev( &our_omap, i ) )
+  for( size_t *i = last( &our_bmap ); i != r_end( &our_bmap ); i = prev( &our_bmap, i ) )
   {
-    ALWAYS_ASSERT( (size_t)*key_for( &our_omap, i ) == *i - 1 );
-    ALWAYS_ASSERT( !last_iteration || *key_for( &our_omap, i ) < *key_for( &our_omap, last_iteration ) );
+    ALWAYS_ASSERT( (size_t)*key_for( &our_bmap, i ) == *i - 1 );
+    ALWAYS_ASSERT( !last_iteration || *key_for( &our_bmap, i ) < *key_for( &our_bmap, last_iteration ) );
     ++n_iterations;
     last_iteration = i;
   }
 
-  for_each( &our_omap, i )
+  for_each( &our_bmap, i )
     ++n_iterations;
-  r_for_each( &our_omap, i )
+  r_for_each( &our_bmap, i )
     ++n_iterations;
 
-  for_each( &our_omap, k, i )
+  for_each( &our_bmap, k, i )
   {
     ALWAYS_ASSERT( (size_t)*k == *i - 1 );
     ++n_iterations;
   }
-  r_for_each( &our_omap, k, i )
+  r_for_each( &our_bmap, k, i )
   {
     ALWAYS_ASSERT( (size_t)*k == *i - 1 );
     ++n_iterations;
@@ -2453,49 +8171,49 @@ static void test_omap_iteration_and_get_key( void )
   ALWAYS_ASSERT( n_iterations == 180 );
 
   // Test iterator stability.
-  ALWAYS_ASSERT( r_end( &our_omap ) == r_end );
-  ALWAYS_ASSERT( end( &our_omap ) == end );
+  ALWAYS_ASSERT( r_end( &our_bmap ) == r_end );
+  ALWAYS_ASSERT( end( &our_bmap ) == end );
 
   // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_omap, r_end( &our_omap ) ) == first( &our_omap ) );
-  ALWAYS_ASSERT( prev( &our_omap, end( &our_omap ) ) == last( &our_omap ) );
+  ALWAYS_ASSERT( next( &our_bmap, r_end( &our_bmap ) ) == first( &our_bmap ) );
+  ALWAYS_ASSERT( prev( &our_bmap, end( &our_bmap ) ) == last( &our_bmap ) );
 
-  // Iteration over empty, non-placeholder ordered map.
+  // Iteration over empty, non-placeholder B-tree map.
 
-  clear( &our_omap );
+  clear( &our_bmap );
 
   n_iterations = 0;
 
-  for_each( &our_omap, i )
+  for_each( &our_bmap, i )
     ++n_iterations;
 
-  r_for_each( &our_omap, i )
+  r_for_each( &our_bmap, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 0 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_iteration_over_range( void )
+static void test_bmap_iteration_over_range( void )
 {
-  omap( int, size_t ) our_omap;
-  init( &our_omap );
+  bmap( int, size_t ) our_bmap;
+  init( &our_bmap );
 
   // Empty.
 
   size_t n_iterations = 0;
   for(
-    size_t *i = first( &our_omap, 25 ), *range_end = first( &our_omap, 75 );
+    size_t *i = first( &our_bmap, 25 ), *range_end = first( &our_bmap, 75 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
     ++n_iterations;
 
   for(
-    size_t *i = last( &our_omap, 74 ), *range_end = last( &our_omap, 24 );
+    size_t *i = last( &our_bmap, 74 ), *range_end = last( &our_bmap, 24 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
     ++n_iterations;
 
@@ -2514,28 +8232,28 @@ static void test_omap_iteration_over_range( void )
   };
 
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_omap, keys[ i ], 0 ) );
+    UNTIL_SUCCESS( insert( &our_bmap, keys[ i ], 0 ) );
 
   // Test ranges that do not include r_end or end.
 
   for(
-    size_t *i = first( &our_omap, 25 ), *range_end = first( &our_omap, 75 );
+    size_t *i = first( &our_bmap, 25 ), *range_end = first( &our_bmap, 75 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
   {
-    const int *key = key_for( &our_omap, i );
+    const int *key = key_for( &our_bmap, i );
     ALWAYS_ASSERT( *key >= 25 && *key < 75 );
     ++n_iterations;
   }
 
   for(
-    size_t *i = last( &our_omap, 75 ), *range_end = last( &our_omap, 25 );
+    size_t *i = last( &our_bmap, 75 ), *range_end = last( &our_bmap, 25 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
   {
-    const int *key = key_for( &our_omap, i );
+    const int *key = key_for( &our_bmap, i );
     ALWAYS_ASSERT( *key > 25 && *key <= 75 );
     ++n_iterations;
   }
@@ -2545,56 +8263,56 @@ static void test_omap_iteration_over_range( void )
   // Test ranges that overlap r_end or end.
 
   for(
-    size_t *i = first( &our_omap, -1 ), *range_end = first( &our_omap, 50 );
+    size_t *i = first( &our_bmap, -1 ), *range_end = first( &our_bmap, 50 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
   {
-    ALWAYS_ASSERT( *key_for( &our_omap, i ) < 50 );
+    ALWAYS_ASSERT( *key_for( &our_bmap, i ) < 50 );
     ++n_iterations;
   }
 
   for(
-    size_t *i = first( &our_omap, 50 ), *range_end = first( &our_omap, 100 );
+    size_t *i = first( &our_bmap, 50 ), *range_end = first( &our_bmap, 100 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
   {
-    ALWAYS_ASSERT( *key_for( &our_omap, i ) >= 50 );
+    ALWAYS_ASSERT( *key_for( &our_bmap, i ) >= 50 );
     ++n_iterations;
   }
 
   for(
-    size_t *i = last( &our_omap, 100 ), *range_end = last( &our_omap, 49 );
+    size_t *i = last( &our_bmap, 100 ), *range_end = last( &our_bmap, 49 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
   {
-    ALWAYS_ASSERT( *key_for( &our_omap, i ) >= 50 );
+    ALWAYS_ASSERT( *key_for( &our_bmap, i ) >= 50 );
     ++n_iterations;
   }
 
   for(
-    size_t *i = last( &our_omap, 49 ), *range_end = last( &our_omap, -1 );
+    size_t *i = last( &our_bmap, 49 ), *range_end = last( &our_bmap, -1 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
   {
-    ALWAYS_ASSERT( *key_for( &our_omap, i ) <= 49 );
+    ALWAYS_ASSERT( *key_for( &our_bmap, i ) <= 49 );
     ++n_iterations;
   }
 
   for(
-    size_t *i = first( &our_omap, -1 ), *range_end = first( &our_omap, 100 );
+    size_t *i = first( &our_bmap, -1 ), *range_end = first( &our_bmap, 100 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
     ++n_iterations;
 
   for(
-    size_t *i = last( &our_omap, 100 ), *range_end = last( &our_omap, -1 );
+    size_t *i = last( &our_bmap, 100 ), *range_end = last( &our_bmap, -1 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
     ++n_iterations;
 
@@ -2603,28 +8321,55 @@ static void test_omap_iteration_over_range( void )
   // Test ranges with no keys.
 
   for(
-    size_t *i = first( &our_omap, 100 ), *range_end = first( &our_omap, 200 );
+    size_t *i = first( &our_bmap, 100 ), *range_end = first( &our_bmap, 200 );
     i != range_end;
-    i = next( &our_omap, i )
+    i = next( &our_bmap, i )
   )
     ++n_iterations;
 
   for(
-    size_t *i = last( &our_omap, -1 ), *range_end = last( &our_omap, -100 );
+    size_t *i = last( &our_bmap, -1 ), *range_end = last( &our_bmap, -100 );
     i != range_end;
-    i = prev( &our_omap, i )
+    i = prev( &our_bmap, i )
   )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 500 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-static void test_omap_dtors( void )
+static void test_bmap_memory_usage( void )
 {
-  omap( custom_ty, custom_ty ) our_omap;
-  init( &our_omap );
+  bmap( int, short ) our_bmap;
+  init( &our_bmap );
+  check_memory_usage( memory_usage( &our_bmap ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_bmap, &allocator ) );
+  check_memory_usage( memory_usage( &our_bmap ), bytes, 0 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_bmap, i, (short)i ) );
+    check_memory_usage( memory_usage( &our_bmap ), bytes, ( sizeof( int ) + sizeof( short ) ) * (size_t)( i + 1 ) );
+  }
+
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_bmap, i ) );
+
+  check_memory_usage( memory_usage( &our_bmap ), bytes, ( sizeof( int ) + sizeof( short ) ) * 100 );
+
+  cleanup( &our_bmap );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_bmap ), 0, 0 );
+}
+
+static void test_bmap_dtors( void )
+{
+  bmap( custom_ty, custom_ty ) our_bmap;
+  init( &our_bmap );
 
   // Test erase and clear.
 
@@ -2632,16 +8377,16 @@ static void test_omap_dtors( void )
   {
     custom_ty key = { i };
     custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+    UNTIL_SUCCESS( insert( &our_bmap, key, el ) );
   }
 
   for( int i = 0; i < 50; i += 2 )
   {
     custom_ty key = { i };
-    erase( &our_omap, key );
+    erase( &our_bmap, key );
   }
 
-  clear( &our_omap );
+  clear( &our_bmap );
 
   check_dtors_arr();
 
@@ -2651,17 +8396,17 @@ static void test_omap_dtors( void )
   {
     custom_ty key = { i };
     custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+    UNTIL_SUCCESS( insert( &our_bmap, key, el ) );
   }
   for( int i = 0; i < 50; ++i )
   {
     custom_ty key = { i };
     custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+    UNTIL_SUCCESS( insert( &our_bmap, key, el ) );
   }
 
   check_dtors_arr();
-  clear( &our_omap );
+  clear( &our_bmap );
 
   // Test cleanup.
 
@@ -2669,25 +8414,25 @@ static void test_omap_dtors( void )
   {
     custom_ty key = { i };
     custom_ty el = { i + 50 };
-    UNTIL_SUCCESS( insert( &our_omap, key, el ) );
+    UNTIL_SUCCESS( insert( &our_bmap, key, el ) );
   }
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
   check_dtors_arr();
 }
 
 // Strings are a special case that warrant seperate testing.
-static void test_omap_strings( void )
+static void test_bmap_strings( void )
 {
-  omap( char *, char * ) our_omap;
-  init( &our_omap );
+  bmap( char *, char * ) our_bmap;
+  init( &our_bmap );
 
   char **el;
 
   // String literals.
-  UNTIL_SUCCESS( ( el = insert( &our_omap, "This", "is" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bmap, "This", "is" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
-  UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, "a", "test" ) ) );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_bmap, "a", "test" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
 
   // Other strings.
@@ -2696,72 +8441,102 @@ static void test_omap_strings( void )
   char str_3[] = "with";
   char str_4[] = "strings.";
 
-  UNTIL_SUCCESS( ( el = insert( &our_omap, str_1, str_2 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bmap, str_1, str_2 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = get_or_insert( &our_omap, str_3, str_4 ) ) );
+  UNTIL_SUCCESS( ( el = get_or_insert( &our_bmap, str_3, str_4 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_omap ) == 4 );
-  ALWAYS_ASSERT( strcmp( *get( &our_omap, "This" ), "is" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_omap, "a" ), "test" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_omap, str_1, str_2 ) ) );
+  ALWAYS_ASSERT( size( &our_bmap ) == 4 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bmap, "This" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bmap, "a" ), "test" ) == 0 );
+  UNTIL_SUCCESS( ( el = insert( &our_bmap, str_1, str_2 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_omap, str_3, str_4 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bmap, str_3, str_4 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
-  ALWAYS_ASSERT( size( &our_omap ) == 4 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 4 );
 
   // Erase.
-  erase( &our_omap, "This" );
-  erase( &our_omap, str_1 );
-  ALWAYS_ASSERT( size( &our_omap ) == 2 );
+  erase( &our_bmap, "This" );
+  erase( &our_bmap, str_1 );
+  ALWAYS_ASSERT( size( &our_bmap ) == 2 );
 
   // Iteration.
-  for_each( &our_omap, i )
+  for_each( &our_bmap, i )
     ALWAYS_ASSERT( strcmp( *i, "test" ) == 0 || strcmp( *i, str_4 ) == 0 );
 
-  cleanup( &our_omap );
+  cleanup( &our_bmap );
 }
 
-#define TEST_OMAP_DEFAULT_INTEGER_TYPE( ty )    \
+static void test_bmap_str( void )
+{
+  bmap( cc_str, int ) our_bmap;
+  init( &our_bmap );
+
+  char chars[] = "abc\0abd";
+  cc_str strs[] = {
+    { chars + 4, 3 }, // "abd".
+    { chars, 4 },     // "abc\0".
+    { chars, 3 },     // "abc".
+    { chars, 0 },     // Empty.
+    { chars, 2 }      // "ab".
+  };
+
+  for( int i = 0; i < 5; ++i )
+    UNTIL_SUCCESS( insert( &our_bmap, strs[ i ], i ) );
+
+  ALWAYS_ASSERT( size( &our_bmap ) == 5 );
+
+  // Shorter strings precede the longer strings that they prefix.
+  int expected[] = { 3, 4, 2, 1, 0 };
+  int n = 0;
+  for_each( &our_bmap, el )
+    ALWAYS_ASSERT( *el == expected[ n++ ] );
+
+  ALWAYS_ASSERT( n == 5 );
+
+  cleanup( &our_bmap );
+}
+
+#define TEST_BMAP_DEFAULT_INTEGER_TYPE( ty )    \
 {                                               \
-  omap( ty, int ) our_omap;                     \
-  init( &our_omap );                            \
+  bmap( ty, int ) our_bmap;                     \
+  init( &our_bmap );                            \
                                                 \
   for( int i = 0; i < 100; ++i )                \
-    UNTIL_SUCCESS( insert( &our_omap, i, i ) ); \
+    UNTIL_SUCCESS( insert( &our_bmap, i, i ) ); \
                                                 \
   for( int i = 0; i < 100; ++i )                \
-    ALWAYS_ASSERT( *get( &our_omap, i ) == i ); \
+    ALWAYS_ASSERT( *get( &our_bmap, i ) == i ); \
                                                 \
-  cleanup( &our_omap );                         \
+  cleanup( &our_bmap );                         \
 }                                               \
 
-static void test_omap_default_integer_types( void )
+static void test_bmap_default_integer_types( void )
 {
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( char );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned char );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( signed char );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned short );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( short );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned int );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( int );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned long );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( long );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( unsigned long long );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( long );
-  TEST_OMAP_DEFAULT_INTEGER_TYPE( size_t );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( char );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( short );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( int );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( long );
+  TEST_BMAP_DEFAULT_INTEGER_TYPE( size_t );
 }
 
 #endif
 
-// Unordered set tests.
-#ifdef TEST_OSET
+// B-tree set tests.
+#ifdef TEST_BSET
 
-static void test_oset_insert( void )
+static void test_bset_insert( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Sequential input.
 
@@ -2769,7 +8544,7 @@ static void test_oset_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     int *el;
-    UNTIL_SUCCESS( el = insert( &our_oset, i ) );
+    UNTIL_SUCCESS( el = insert( &our_bset, i ) );
     ALWAYS_ASSERT( *el == i );
   }
 
@@ -2777,15 +8552,15 @@ static void test_oset_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     int *el;
-    UNTIL_SUCCESS( el = insert( &our_oset, i ) );
+    UNTIL_SUCCESS( el = insert( &our_bset, i ) );
     ALWAYS_ASSERT( *el == i );
   }
 
   // Check.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
-  clear( &our_oset );
+  clear( &our_bset );
 
   // Nonsequential input (alternating positive and negative integers).
 
@@ -2793,7 +8568,7 @@ static void test_oset_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     int *el;
-    UNTIL_SUCCESS( el = insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    UNTIL_SUCCESS( el = insert( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
     ALWAYS_ASSERT( *el == i * ( i % 2 ? 1 : -1 ) );
   }
 
@@ -2801,301 +8576,377 @@ static void test_oset_insert( void )
   for( int i = 0; i < 100; ++i )
   {
     int *el;
-    UNTIL_SUCCESS( el = insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    UNTIL_SUCCESS( el = insert( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
     ALWAYS_ASSERT( *el == i * ( i % 2 ? 1 : -1 ) );
   }
 
   // Check.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
+    ALWAYS_ASSERT( *get( &our_bset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_get_or_insert( void )
+static void test_bset_get_or_insert( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Test insert.
   for( int i = 0; i < 100; ++i )
   {
     int *el;
-    UNTIL_SUCCESS( ( el = get_or_insert( &our_oset, i ) ) );
+    UNTIL_SUCCESS( ( el = get_or_insert( &our_bset, i ) ) );
     ALWAYS_ASSERT( *el == i );
   }
 
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
   // Test get.
   for( int i = 0; i < 100; ++i )
   {
-    int *el_1 = get( &our_oset, i );
+    int *el_1 = get( &our_bset, i );
     int *el_2;
-    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_oset, i ) ) );
+    UNTIL_SUCCESS( ( el_2 = get_or_insert( &our_bset, i ) ) );
     ALWAYS_ASSERT( el_2 == el_1 && *el_2 == i );
   }
 
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_get( void )
+static void test_bset_get( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Test empty.
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_oset, i ) );
+    ALWAYS_ASSERT( !get( &our_bset, i ) );
 
   // Test get existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
   // Test get non-existing.
   for( int i = 100; i < 200; ++i )
-    ALWAYS_ASSERT( !get( &our_oset, i ) );
+    ALWAYS_ASSERT( !get( &our_bset, i ) );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_erase( void )
+static void test_bset_erase( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Sequential input.
 
   // Test erase existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
 
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
 
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_oset, i ) );
+    ALWAYS_ASSERT( erase( &our_bset, i ) );
 
   // Test erase non-existing.
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_oset, i ) );
+    ALWAYS_ASSERT( !erase( &our_bset, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  ALWAYS_ASSERT( size( &our_bset ) == 50 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_oset, i ) );
+      ALWAYS_ASSERT( !get( &our_bset, i ) );
     else
-      ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+      ALWAYS_ASSERT( *get( &our_bset, i ) == i );
   }
 
-  clear( &our_oset );
+  clear( &our_bset );
 
   // Nonsequential input (alternating positive and negative integers).
 
   // Test erase existing.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    UNTIL_SUCCESS( insert( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
 
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
 
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( erase( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( erase( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
 
   // Test erase non-existing.
   for( int i = 0; i < 100; i += 2 )
-    ALWAYS_ASSERT( !erase( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+    ALWAYS_ASSERT( !erase( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  ALWAYS_ASSERT( size( &our_bset ) == 50 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) );
+      ALWAYS_ASSERT( !get( &our_bset, i * ( i % 2 ? 1 : -1 ) ) );
     else
-      ALWAYS_ASSERT( *get( &our_oset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
+      ALWAYS_ASSERT( *get( &our_bset, i * ( i % 2 ? 1 : -1 ) ) == i * ( i % 2 ? 1 : -1 ) );
   }
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_erase_itr( void )
+static void test_bset_erase_itr( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
 
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
 
   // Test with iterator from get.
   for( int i = 0; i < 100; i += 4 )
-    erase_itr( &our_oset, get( &our_oset, i ) );
+    erase_itr( &our_bset, get( &our_bset, i ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_oset ) == 75 );
+  ALWAYS_ASSERT( size( &our_bset ) == 75 );
   for( int i = 0; i < 100; ++i )
   {
     if( i % 4 == 0 )
-      ALWAYS_ASSERT( !get( &our_oset, i ) );
+      ALWAYS_ASSERT( !get( &our_bset, i ) );
     else
     {
-      int *el = get( &our_oset, i );
+      int *el = get( &our_bset, i );
       ALWAYS_ASSERT( el && *el == i );
     }
   }
 
   // Test deletion while iterating.
 
-  int *el = first( &our_oset );
+  int *el = first( &our_bset );
   size_t n_iterations = 0;
-  while( el != end( &our_oset ) )
+  while( el != end( &our_bset ) )
   {
     ++n_iterations;
 
     if( *el % 2 == 0 )
-      el = erase_itr( &our_oset, el );
+      el = erase_itr( &our_bset, el );
     else
-      el = next( &our_oset, el );
+      el = next( &our_bset, el );
   }
 
   ALWAYS_ASSERT( n_iterations == 75 );
-  ALWAYS_ASSERT( size( &our_oset ) == 50 );
+  ALWAYS_ASSERT( size( &our_bset ) == 50 );
 
   for( int i = 0; i < 100; ++i )
   {
     if( i % 2 == 0 )
-      ALWAYS_ASSERT( !get( &our_oset, i ) );
+      ALWAYS_ASSERT( !get( &our_bset, i ) );
     else
     {
-      el = get( &our_oset, i );
+      el = get( &our_bset, i );
       ALWAYS_ASSERT( el && *el == i  );
     }
   }
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_clear( void )
+static void test_bset_erase_if( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
+
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
+
+  int divisor = 3;
+  ALWAYS_ASSERT( erase_if( &our_bset, is_int_multiple, &divisor ) == 334 );
+  divisor = 2;
+  ALWAYS_ASSERT( filter( &our_bset, is_int_multiple, &divisor ) == 333 );
+  ALWAYS_ASSERT( size( &our_bset ) == 333 );
+
+  for( int i = 0; i < 1000; ++i )
+    ALWAYS_ASSERT( !get( &our_bset, i ) == ( i % 2 != 0 || i % 3 == 0 ) );
+
+  cleanup( &our_bset );
+}
+
+static void test_bset_clear( void )
+{
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Test empty.
-  clear( &our_oset );
-  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+  clear( &our_bset );
+  ALWAYS_ASSERT( size( &our_bset ) == 0 );
 
   // Test non-empty;
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
 
-  clear( &our_oset );
-  ALWAYS_ASSERT( size( &our_oset ) == 0 );
+  clear( &our_bset );
+  ALWAYS_ASSERT( size( &our_bset ) == 0 );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( !get( &our_oset, i ) );
+    ALWAYS_ASSERT( !get( &our_bset, i ) );
 
   // Test reuse.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
 
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_cleanup( void )
+static void test_bset_cleanup( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Empty.
-  cleanup( &our_oset );
-  ALWAYS_ASSERT( (void *)our_oset == (void *)&cc_omap_placeholder );
+  cleanup( &our_bset );
+  ALWAYS_ASSERT( (void *)our_bset == (void *)&cc_bmap_placeholder );
 
   // Non-empty.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
-  ALWAYS_ASSERT( size( &our_oset ) == 100 );
-  cleanup( &our_oset );
-  ALWAYS_ASSERT( size( &our_oset ) == 0 );
-  ALWAYS_ASSERT( (void *)our_oset == (void *)&cc_omap_placeholder );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
+  ALWAYS_ASSERT( size( &our_bset ) == 100 );
+  cleanup( &our_bset );
+  ALWAYS_ASSERT( size( &our_bset ) == 0 );
+  ALWAYS_ASSERT( (void *)our_bset == (void *)&cc_bmap_placeholder );
 
   // Test use.
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, i ) );
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
   for( int i = 0; i < 100; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_init_clone( void )
+static void test_bset_init_clone( void )
 {
-  oset( int ) src_oset;
-  init( &src_oset );
+  bset( int ) src_bset;
+  init( &src_bset );
 
   // Test init_clone placeholder.
-  oset( int ) empty_oset;
-  UNTIL_SUCCESS( init_clone( &empty_oset, &src_oset ) );
-  ALWAYS_ASSERT( (void *)empty_oset == (void *)&cc_omap_placeholder );
+  bset( int ) empty_bset;
+  UNTIL_SUCCESS( init_clone( &empty_bset, &src_bset ) );
+  ALWAYS_ASSERT( (void *)empty_bset == (void *)&cc_bmap_placeholder );
 
   // Test init_clone non-placeholder.
-  oset( int ) our_oset;
+  bset( int ) our_bset;
   for( int i = 0; i < 10; ++i )
-    UNTIL_SUCCESS( insert( &src_oset, i ) );
-  UNTIL_SUCCESS( init_clone( &our_oset, &src_oset ) );
+    UNTIL_SUCCESS( insert( &src_bset, i ) );
+  UNTIL_SUCCESS( init_clone( &our_bset, &src_bset ) );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_oset ) == 10 );
+  ALWAYS_ASSERT( size( &our_bset ) == 10 );
   for( int i = 0; i < 10; ++i )
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i );
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
 
-  cleanup( &src_oset );
-  cleanup( &empty_oset );
-  cleanup( &our_oset );
+  cleanup( &src_bset );
+  cleanup( &empty_bset );
+  cleanup( &our_bset );
+}
+
+static void test_bset_init_with_allocator( void )
+{
+  // Test stateful allocator.
+  size_t allocs = 0;
+  cc_allocator allocator = { counting_realloc, counting_free, &allocs };
+
+  bset( int ) our_bset;
+  UNTIL_SUCCESS( init_with_allocator( &our_bset, &allocator ) );
+  ALWAYS_ASSERT( allocs == 1 );
+  ALWAYS_ASSERT( size( &our_bset ) == 0 );
+
+  for( int i = 0; i < 10; ++i )
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
+
+  // Test that clones share the allocator.
+  // Because nodes are allocated in several slabs, the B-tree set must be small for the clone to succeed despite the
+  // simulated allocation failures.
+  size_t allocs_before_clone = allocs;
+  bset( int ) our_bset_clone;
+  UNTIL_SUCCESS( init_clone( &our_bset_clone, &our_bset ) );
+  ALWAYS_ASSERT( allocs > allocs_before_clone );
+  ALWAYS_ASSERT( size( &our_bset_clone ) == 10 );
+  for( int i = 0; i < 10; ++i )
+    ALWAYS_ASSERT( *get( &our_bset_clone, i ) == i );
+
+  // Test that clones of empty B-tree sets share the allocator.
+  bset( int ) empty_bset;
+  bset( int ) empty_bset_clone;
+  UNTIL_SUCCESS( init_with_allocator( &empty_bset, &allocator ) );
+  UNTIL_SUCCESS( init_clone( &empty_bset_clone, &empty_bset ) );
+  ALWAYS_ASSERT( (void *)empty_bset_clone != (void *)&cc_bmap_placeholder );
+
+  cleanup( &our_bset );
+  cleanup( &our_bset_clone );
+  cleanup( &empty_bset );
+  cleanup( &empty_bset_clone );
+  ALWAYS_ASSERT( allocs == 0 );
+
+  // Test arena.
+  cc_arena arena;
+  cc_arena_init( &arena );
+
+  UNTIL_SUCCESS( init_with_allocator( &our_bset, cc_arena_allocator( &arena ) ) );
+  for( int i = 0; i < 1000; ++i )
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
+  for( int i = 0; i < 1000; i += 2 )
+    ALWAYS_ASSERT( erase( &our_bset, i ) );
+
+  ALWAYS_ASSERT( size( &our_bset ) == 500 );
+  for( int i = 1; i < 1000; i += 2 )
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i );
+
+  cleanup( &our_bset );
+  cc_arena_cleanup( &arena );
 }
 
 // This needs to test, in particular, that r_end and end iterator-pointers are stable, especially during the transition
 // from placeholder to non-placeholder.
-static void test_oset_iteration( void )
+static void test_bset_iteration( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
-  int *r_end = r_end( &our_oset );
-  int *end = end( &our_oset );
+  int *r_end = r_end( &our_bset );
+  int *end = end( &our_bset );
 
   // Empty.
 
   // Test first and last.
-  ALWAYS_ASSERT( first( &our_oset ) == end( &our_oset ) );
-  ALWAYS_ASSERT( last( &our_oset ) == r_end( &our_oset ) );
+  ALWAYS_ASSERT( first( &our_bset ) == end( &our_bset ) );
+  ALWAYS_ASSERT( last( &our_bset ) == r_end( &our_bset ) );
 
   // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_oset, r_end( &our_oset ) ) == first( &our_oset ) );
-  ALWAYS_ASSERT( prev( &our_oset, end( &our_oset ) ) == last( &our_oset ) );
+  ALWAYS_ASSERT( next( &our_bset, r_end( &our_bset ) ) == first( &our_bset ) );
+  ALWAYS_ASSERT( prev( &our_bset, end( &our_bset ) ) == last( &our_bset ) );
 
   size_t n_iterations = 0;
-  for( int *i = first( &our_oset ); i != end( &our_oset ); i = next( &our_oset, i ) )
+  for( int *i = first( &our_bset ); i != end( &our_bset ); i = next( &our_bset, i ) )
     ++n_iterations;
-  for( int *i = last( &our_oset ); i != r_end( &our_oset ); i = prev( &our_oset, i ) )
+  for( int *i = last( &our_bset ); i != r_end( &our_bset ); i = prev( &our_bset, i ) )
     ++n_iterations;
-  for_each( &our_oset, i )
+  for_each( &our_bset, i )
     ++n_iterations;
-  r_for_each( &our_oset, i )
+  r_for_each( &our_bset, i )
     ++n_iterations;
-  for_each( &our_oset, i )
+  for_each( &our_bset, i )
     ++n_iterations;
-  r_for_each( &our_oset, i )
+  r_for_each( &our_bset, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 0 );
@@ -3109,10 +8960,10 @@ static void test_oset_iteration( void )
   };
 
   for( int i = 0; i < 30; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, keys[ i ] ) );
+    UNTIL_SUCCESS( insert( &our_bset, keys[ i ] ) );
 
   int *last_iteration = NULL;
-  for( int *i = first( &our_oset ); i != end( &our_oset ); i = next( &our_oset, i ) )
+  for( int *i = first( &our_bset ); i != end( &our_bset ); i = next( &our_bset, i ) )
   {
     ALWAYS_ASSERT( !last_iteration || *i > *last_iteration );
     ++n_iterations;
@@ -3120,69 +8971,69 @@ static void test_oset_iteration( void )
   }
 
   last_iteration = NULL;
-  for( int *i = last( &our_oset ); i != r_end( &our_oset ); i = prev( &our_oset, i ) )
+  for( int *i = last( &our_bset ); i != r_end( &our_bset ); i = prev( &our_bset, i ) )
   {
     ALWAYS_ASSERT( !last_iteration || *i < *last_iteration );
     ++n_iterations;
     last_iteration = i;
   }
 
-  for_each( &our_oset, i )
+  for_each( &our_bset, i )
     ++n_iterations;
-  r_for_each( &our_oset, i )
+  r_for_each( &our_bset, i )
     ++n_iterations;
 
-  for_each( &our_oset, i )
+  for_each( &our_bset, i )
     ++n_iterations;
-  r_for_each( &our_oset, i )
+  r_for_each( &our_bset, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 180 );
 
   // Test iterator stability.
-  ALWAYS_ASSERT( r_end( &our_oset ) == r_end );
-  ALWAYS_ASSERT( end( &our_oset ) == end );
+  ALWAYS_ASSERT( r_end( &our_bset ) == r_end );
+  ALWAYS_ASSERT( end( &our_bset ) == end );
 
   // Test iteration from r_end and end.
-  ALWAYS_ASSERT( next( &our_oset, r_end( &our_oset ) ) == first( &our_oset ) );
-  ALWAYS_ASSERT( prev( &our_oset, end( &our_oset ) ) == last( &our_oset ) );
+  ALWAYS_ASSERT( next( &our_bset, r_end( &our_bset ) ) == first( &our_bset ) );
+  ALWAYS_ASSERT( prev( &our_bset, end( &our_bset ) ) == last( &our_bset ) );
 
-  // Iteration over empty, non-placeholder ordered map.
+  // Iteration over empty, non-placeholder B-tree set.
 
-  clear( &our_oset );
+  clear( &our_bset );
 
   n_iterations = 0;
 
-  for_each( &our_oset, i )
+  for_each( &our_bset, i )
     ++n_iterations;
 
-  r_for_each( &our_oset, i )
+  r_for_each( &our_bset, i )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 0 );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_iteration_over_range( void )
+static void test_bset_iteration_over_range( void )
 {
-  oset( int ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
 
   // Empty.
 
   size_t n_iterations = 0;
   for(
-    int *i = first( &our_oset, 25 ), *range_end = first( &our_oset, 75 );
+    int *i = first( &our_bset, 25 ), *range_end = first( &our_bset, 75 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
     ++n_iterations;
 
   for(
-    int *i = last( &our_oset, 74 ), *range_end = last( &our_oset, 24 );
+    int *i = last( &our_bset, 74 ), *range_end = last( &our_bset, 24 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
     ++n_iterations;
 
@@ -3201,14 +9052,14 @@ static void test_oset_iteration_over_range( void )
   };
 
   for( int i = 0; i < 100; ++i )
-    UNTIL_SUCCESS( insert( &our_oset, keys[ i ] ) );
+    UNTIL_SUCCESS( insert( &our_bset, keys[ i ] ) );
 
   // Test ranges that do not include r_end or end.
 
   for(
-    int *i = first( &our_oset, 25 ), *range_end = first( &our_oset, 75 );
+    int *i = first( &our_bset, 25 ), *range_end = first( &our_bset, 75 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i >= 25 && *i < 75 );
@@ -3216,9 +9067,9 @@ static void test_oset_iteration_over_range( void )
   }
 
   for(
-    int *i = last( &our_oset, 75 ), *range_end = last( &our_oset, 25 );
+    int *i = last( &our_bset, 75 ), *range_end = last( &our_bset, 25 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i > 25 && *i <= 75 );
@@ -3230,9 +9081,9 @@ static void test_oset_iteration_over_range( void )
   // Test ranges that overlap r_end or end.
 
   for(
-    int *i = first( &our_oset, -1 ), *range_end = first( &our_oset, 50 );
+    int *i = first( &our_bset, -1 ), *range_end = first( &our_bset, 50 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i < 50 );
@@ -3240,9 +9091,9 @@ static void test_oset_iteration_over_range( void )
   }
 
   for(
-    int *i = first( &our_oset, 50 ), *range_end = first( &our_oset, 100 );
+    int *i = first( &our_bset, 50 ), *range_end = first( &our_bset, 100 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i >= 50 );
@@ -3250,9 +9101,9 @@ static void test_oset_iteration_over_range( void )
   }
 
   for(
-    int *i = last( &our_oset, 100 ), *range_end = last( &our_oset, 49 );
+    int *i = last( &our_bset, 100 ), *range_end = last( &our_bset, 49 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i >= 50 );
@@ -3260,9 +9111,9 @@ static void test_oset_iteration_over_range( void )
   }
 
   for(
-    int *i = last( &our_oset, 49 ), *range_end = last( &our_oset, -1 );
+    int *i = last( &our_bset, 49 ), *range_end = last( &our_bset, -1 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
   {
     ALWAYS_ASSERT( *i <= 49 );
@@ -3270,16 +9121,16 @@ static void test_oset_iteration_over_range( void )
   }
 
   for(
-    int *i = first( &our_oset, -1 ), *range_end = first( &our_oset, 100 );
+    int *i = first( &our_bset, -1 ), *range_end = first( &our_bset, 100 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
     ++n_iterations;
 
   for(
-    int *i = last( &our_oset, 100 ), *range_end = last( &our_oset, -1 );
+    int *i = last( &our_bset, 100 ), *range_end = last( &our_bset, -1 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
     ++n_iterations;
 
@@ -3288,44 +9139,71 @@ static void test_oset_iteration_over_range( void )
   // Test ranges with no keys.
 
   for(
-    int *i = first( &our_oset, 100 ), *range_end = first( &our_oset, 200 );
+    int *i = first( &our_bset, 100 ), *range_end = first( &our_bset, 200 );
     i != range_end;
-    i = next( &our_oset, i )
+    i = next( &our_bset, i )
   )
     ++n_iterations;
 
   for(
-    int *i = last( &our_oset, -1 ), *range_end = last( &our_oset, -100 );
+    int *i = last( &our_bset, -1 ), *range_end = last( &our_bset, -100 );
     i != range_end;
-    i = prev( &our_oset, i )
+    i = prev( &our_bset, i )
   )
     ++n_iterations;
 
   ALWAYS_ASSERT( n_iterations == 500 );
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
 }
 
-static void test_oset_dtors( void )
+static void test_bset_memory_usage( void )
 {
-  oset( custom_ty ) our_oset;
-  init( &our_oset );
+  bset( int ) our_bset;
+  init( &our_bset );
+  check_memory_usage( memory_usage( &our_bset ), 0, 0 );
+
+  size_t bytes = 0;
+  cc_allocator allocator = { byte_counting_realloc, byte_counting_free, &bytes };
+  UNTIL_SUCCESS( init_with_allocator( &our_bset, &allocator ) );
+  check_memory_usage( memory_usage( &our_bset ), bytes, 0 );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    UNTIL_SUCCESS( insert( &our_bset, i ) );
+    check_memory_usage( memory_usage( &our_bset ), bytes, sizeof( int ) * (size_t)( i + 1 ) );
+  }
+
+  for( int i = 0; i < 900; ++i )
+    ALWAYS_ASSERT( erase( &our_bset, i ) );
+
+  check_memory_usage( memory_usage( &our_bset ), bytes, sizeof( int ) * 100 );
+
+  cleanup( &our_bset );
+  ALWAYS_ASSERT( bytes == 0 );
+  check_memory_usage( memory_usage( &our_bset ), 0, 0 );
+}
+
+static void test_bset_dtors( void )
+{
+  bset( custom_ty ) our_bset;
+  init( &our_bset );
 
   // Test erase and clear.
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_oset, el ) );
+    UNTIL_SUCCESS( insert( &our_bset, el ) );
   }
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    erase( &our_oset, el );
+    erase( &our_bset, el );
   }
 
-  clear( &our_oset );
+  clear( &our_bset );
 
   check_dtors_arr();
 
@@ -3334,45 +9212,45 @@ static void test_oset_dtors( void )
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_oset, el ) );
+    UNTIL_SUCCESS( insert( &our_bset, el ) );
   }
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_oset, el ) );
+    UNTIL_SUCCESS( insert( &our_bset, el ) );
   }
 
   check_dtors_arr();
-  clear( &our_oset );
+  clear( &our_bset );
 
   // Test cleanup.
 
   for( int i = 0; i < 100; ++i )
   {
     custom_ty el = { i };
-    UNTIL_SUCCESS( insert( &our_oset, el ) );
+    UNTIL_SUCCESS( insert( &our_bset, el ) );
   }
 
-  cleanup( &our_oset );
+  cleanup( &our_bset );
   check_dtors_arr();
 }
 
 // Strings are a special case that warrant seperate testing.
-static void test_oset_strings( void )
+static void test_bset_strings( void )
 {
-  oset( char * ) our_oset;
-  init( &our_oset );
+  bset( char * ) our_bset;
+  init( &our_bset );
 
   char **el;
 
   // String literals.
-  UNTIL_SUCCESS( ( el = insert( &our_oset, "This" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, "This" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "This" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, "is" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, "is" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "is" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, "a" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, "a" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "a" ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, "test" ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, "test" ) ) );
   ALWAYS_ASSERT( strcmp( *el, "test" ) == 0 );
 
   // Other strings.
@@ -3381,57 +9259,57 @@ static void test_oset_strings( void )
   char str_3[] = "with";
   char str_4[] = "strings";
 
-  UNTIL_SUCCESS( ( el = insert( &our_oset, str_1 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, str_1 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_1 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, str_2 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, str_2 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_2 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, str_3 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, str_3 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_3 ) == 0 );
-  UNTIL_SUCCESS( ( el = insert( &our_oset, str_4 ) ) );
+  UNTIL_SUCCESS( ( el = insert( &our_bset, str_4 ) ) );
   ALWAYS_ASSERT( strcmp( *el, str_4 ) == 0 );
 
   // Check.
-  ALWAYS_ASSERT( size( &our_oset ) == 8 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "This" ), "This" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "is" ), "is" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "a" ), "a" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "test" ), "test" ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "of" ), str_1 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "sets" ), str_2 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "with" ), str_3 ) == 0 );
-  ALWAYS_ASSERT( strcmp( *get( &our_oset, "strings" ), str_4 ) == 0 );
-
-  cleanup( &our_oset );
+  ALWAYS_ASSERT( size( &our_bset ) == 8 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "This" ), "This" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "is" ), "is" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "a" ), "a" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "test" ), "test" ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "of" ), str_1 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "sets" ), str_2 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "with" ), str_3 ) == 0 );
+  ALWAYS_ASSERT( strcmp( *get( &our_bset, "strings" ), str_4 ) == 0 );
+
+  cleanup( &our_bset );
 }
 
-#define TEST_OSET_DEFAULT_INTEGER_TYPE( ty )    \
+#define TEST_BSET_DEFAULT_INTEGER_TYPE( ty )    \
 {                                               \
-  oset( ty ) our_oset;                          \
-  init( &our_oset );                            \
+  bset( ty ) our_bset;                          \
+  init( &our_bset );                            \
                                                 \
   for( int i = 0; i < 100; ++i )                \
-    UNTIL_SUCCESS( insert( &our_oset, i ) );    \
+    UNTIL_SUCCESS( insert( &our_bset, i ) );    \
                                                 \
   for( int i = 0; i < 100; ++i )                \
-    ALWAYS_ASSERT( *get( &our_oset, i ) == i ); \
+    ALWAYS_ASSERT( *get( &our_bset, i ) == i ); \
                                                 \
-  cleanup( &our_oset );                         \
+  cleanup( &our_bset );                         \
 }                                               \
 
-static void test_oset_default_integer_types( void )
+static void test_bset_default_integer_types( void )
 {
-  TEST_OSET_DEFAULT_INTEGER_TYPE( char );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned char );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( signed char );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned short );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( short );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned int );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( int );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned long );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( long );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( unsigned long long );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( long );
-  TEST_OSET_DEFAULT_INTEGER_TYPE( size_t );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( char );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( unsigned char );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( signed char );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( unsigned short );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( short );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( unsigned int );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( int );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( unsigned long );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( long );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( unsigned long long );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( long );
+  TEST_BSET_DEFAULT_INTEGER_TYPE( size_t );
 }
 
 #endif
@@ -3458,7 +9336,22 @@ int main( void )
     test_vec_cleanup();
     test_vec_iteration();
     test_vec_init_clone();
+    test_vec_init_with_allocator();
+    test_vec_init_with_buffer();
+    test_vec_init_with_fixed_buffer();
+    test_vec_growth();
+    test_vec_snapshot();
+#ifdef CC_STATS
+    test_vec_stats();
+#endif
+    test_vec_memory_usage();
     test_vec_dtors();
+    test_vec_sort();
+#ifdef CC_PARALLEL_REHASH
+    test_vec_parallel_sort();
+#endif
+    test_vec_binary_search_and_unique();
+    test_vec_filter();
     #endif
 
     #ifdef TEST_LIST
@@ -3471,7 +9364,12 @@ int main( void )
     test_list_cleanup();
     test_list_iteration();
     test_list_init_clone();
+    test_list_init_with_allocator();
+    test_list_memory_usage();
     test_list_dtors();
+#ifdef CC_POOL_NODES
+    test_list_pool();
+#endif
     #endif
 
     #ifdef TEST_MAP
@@ -3479,16 +9377,45 @@ int main( void )
     test_map_reserve();
     test_map_shrink();
     test_map_insert();
+    test_map_insert_n();
+    test_map_growth();
     test_map_get_or_insert();
     test_map_get();
+    test_map_get_n();
     test_map_erase();
+    test_map_erase_n();
     test_map_erase_itr();
+    test_map_cursor();
+    test_map_erase_if();
     test_map_clear();
     test_map_cleanup();
     test_map_init_clone();
+    test_map_init_with_allocator();
+    test_map_init_with_fixed_buffer();
     test_map_iteration_and_get_key();
+    test_map_memory_usage();
     test_map_dtors();
+    test_map_key_and_el_dtors();
     test_map_strings();
+    test_map_strings_unaligned();
+    test_map_str();
+    test_map_separate_keys();
+    test_map_with_hash();
+    test_map_cached_hash();
+#ifdef CC_FLAT_SMALL_MAPS
+    test_map_flat();
+    test_map_flat_shrink();
+#endif
+    test_map_snapshot();
+#ifdef CC_INCREMENTAL_REHASH
+    test_map_snapshot_view_during_migration();
+#endif
+#ifdef CC_STATS
+    test_map_stats();
+#endif
+#ifdef CC_PARALLEL_REHASH
+    test_map_parallel_rehash();
+#endif
     test_map_default_integer_types();
     #endif
 
@@ -3497,52 +9424,161 @@ int main( void )
     test_set_reserve();
     test_set_shrink();
     test_set_insert();
+    test_set_insert_n();
     test_set_get_or_insert();
     test_set_get();
+    test_set_get_n();
     test_set_erase();
+    test_set_erase_n();
     test_set_erase_itr();
+    test_set_cursor();
+    test_set_erase_if();
     test_set_clear();
     test_set_cleanup();
     test_set_init_clone();
+    test_set_init_with_allocator();
+    test_set_init_with_fixed_buffer();
     test_set_iteration();
+    test_set_memory_usage();
     test_set_dtors();
     test_set_strings();
+    test_set_cached_hash();
+    test_set_with_hash();
+    test_set_snapshot();
     test_set_default_integer_types();
     #endif
 
+    #ifdef TEST_CMAP
+    // cmap and init are tested implicitly.
+    test_cmap_init_sharded();
+    test_cmap_insert();
+    test_cmap_get_or_insert();
+    test_cmap_get();
+    test_cmap_erase();
+    test_cmap_clear();
+    test_cmap_memory_usage();
+    test_cmap_dtors();
+    test_cmap_strings();
+#ifdef TEST_THREADS
+    test_cmap_threads();
+#endif
+    #endif
+
+    #ifdef TEST_RING
+    // ring and init are tested implicitly.
+    test_ring_init_with_cap();
+    test_ring_push_and_pop();
+    test_ring_push_n_and_pop_n();
+    test_ring_index_overflow();
+    test_ring_clear();
+    test_ring_memory_usage();
+    test_ring_dtors();
+#ifdef TEST_THREADS
+    test_ring_threads();
+#endif
+    #endif
+
     #ifdef TEST_OMAP
     // omap, init, and size are tested implicitly.
     test_omap_insert();
+    test_omap_insert_sorted_n();
+    test_omap_insert_n();
     test_omap_get_or_insert();
     test_omap_get();
+    test_omap_get_n();
     test_omap_erase();
+    test_omap_erase_n();
     test_omap_erase_itr();
+    test_omap_erase_range();
+    test_omap_erase_if();
+    test_omap_split_at_and_join();
     test_omap_clear();
     test_omap_cleanup();
     test_omap_init_clone();
+    test_omap_init_with_allocator();
+#ifdef CC_STATS
+    test_omap_stats();
+#endif
     test_omap_iteration_and_get_key();
     test_omap_iteration_over_range();
+    test_omap_order_statistics();
+    test_omap_memory_usage();
     test_omap_dtors();
     test_omap_strings();
+    test_omap_str();
+    test_omap_alignment();
     test_omap_default_integer_types();
     #endif
 
     #ifdef TEST_OSET
     // oset, init, and size are tested implicitly.
     test_oset_insert();
+    test_oset_insert_sorted_n();
+    test_oset_insert_n();
     test_oset_get_or_insert();
     test_oset_get();
+    test_oset_get_n();
     test_oset_erase();
+    test_oset_erase_n();
     test_oset_erase_itr();
+    test_oset_erase_range_split_at_and_join();
+    test_oset_erase_if();
     test_oset_clear();
     test_oset_cleanup();
     test_oset_init_clone();
+    test_oset_init_with_allocator();
     test_oset_iteration();
     test_oset_iteration_over_range();
+    test_oset_order_statistics();
+    test_oset_memory_usage();
     test_oset_dtors();
     test_oset_strings();
     test_oset_default_integer_types();
     #endif
+
+    #ifdef TEST_BMAP
+    // bmap, init, and size are tested implicitly.
+    test_bmap_insert();
+    test_bmap_get_or_insert();
+    test_bmap_get();
+    test_bmap_erase();
+    test_bmap_erase_itr();
+    test_bmap_erase_if();
+    test_bmap_clear();
+    test_bmap_cleanup();
+    test_bmap_init_clone();
+    test_bmap_init_with_allocator();
+#ifdef CC_STATS
+    test_bmap_stats();
+#endif
+    test_bmap_iteration_and_get_key();
+    test_bmap_iteration_over_range();
+    test_bmap_memory_usage();
+    test_bmap_dtors();
+    test_bmap_strings();
+    test_bmap_str();
+    test_bmap_default_integer_types();
+    #endif
+
+    #ifdef TEST_BSET
+    // bset, init, and size are tested implicitly.
+    test_bset_insert();
+    test_bset_get_or_insert();
+    test_bset_get();
+    test_bset_erase();
+    test_bset_erase_itr();
+    test_bset_erase_if();
+    test_bset_clear();
+    test_bset_cleanup();
+    test_bset_init_clone();
+    test_bset_init_with_allocator();
+    test_bset_iteration();
+    test_bset_iteration_over_range();
+    test_bset_memory_usage();
+    test_bset_dtors();
+    test_bset_strings();
+    test_bset_default_integer_types();
+    #endif
   }
 
   ALWAYS_ASSERT( oustanding_allocs == 0 );